@@ -83,6 +83,22 @@ void USGBlueprintMessageEndpoint::Unsubscribe(
 	}
 }
 
+void USGBlueprintMessageEndpoint::Retain(MESSAGE_TAG_PARAM_SIGNATURE, const int32 InHistorySize)
+{
+	if (MessageEndpoint.IsValid())
+	{
+		MessageEndpoint->Retain(MESSAGE_TAG_PARAM_VALUE, InHistorySize);
+	}
+}
+
+void USGBlueprintMessageEndpoint::Unretain(MESSAGE_TAG_PARAM_SIGNATURE)
+{
+	if (MessageEndpoint.IsValid())
+	{
+		MessageEndpoint->Unretain(MESSAGE_TAG_PARAM_VALUE);
+	}
+}
+
 FSGBlueprintMessageAddress USGBlueprintMessageEndpoint::GetAddress() const
 {
 	if (MessageEndpoint.IsValid())
@@ -0,0 +1,903 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Bridge/SGMessageAttachmentTransfer.h"
+#include "Core/Bus/SGMessageContext.h"
+#include "Core/Common/SGFileMessageAttachment.h"
+#include "Core/Interface/ISGMessageAttachment.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Interface/ISGMessageTransport.h"
+#include "Core/Message/SGMessage.h"
+#include "Core/Message/SGMessageBuilder.h"
+#include "Core/Settings/SGMessagingSettings.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+
+
+namespace SGMessageAttachmentTransfer
+{
+	/** The message tag of chunks. */
+	const FName ChunkTag(TEXT("SGMessaging.Chunk"));
+
+	/** The message tag of chunk acknowledgements. */
+	const FName ChunkAckTag(TEXT("SGMessaging.ChunkAck"));
+
+	/** The annotation that holds the identifier of a transfer. */
+	const FName TransferKey(TEXT("SG.Att"));
+
+	/** The annotation that holds the size of an attachment. */
+	const FName SizeKey(TEXT("SG.AttSize"));
+
+	/** The annotation of a chunk that holds its offset, or of an acknowledgement that holds the bytes received. */
+	const FName OffsetKey(TEXT("SG.Off"));
+
+	/** The time without progress after which a transfer is resumed from the acknowledged offset. */
+	constexpr double ResumeTimeout = 0.5;
+
+	/** The number of resumptions without progress after which a transfer is given up. */
+	constexpr int32 MaxResumes = 20;
+
+	/** The number of acknowledgements that did not advance after which a transfer is resumed early. */
+	constexpr int32 ResumeAfterDuplicateAcks = 3;
+
+	/** The time after which incomplete inbound transfers are discarded. */
+	constexpr double InboundTimeout = 60.0;
+
+	/** The interval at which the timer thread runs. */
+	constexpr uint32 TimerIntervalMs = 2;
+
+
+	/** Parses a numeric annotation value. */
+	int64 ParseAnnotation(const ISGMessageContext& Context, const FName& Key, const int64 DefaultValue = 0)
+	{
+		int64 Result = DefaultValue;
+
+		if (const FString* Value = Context.GetAnnotations().Find(Key))
+		{
+			LexFromString(Result, **Value);
+		}
+
+		return Result;
+	}
+
+	/** Gets the name of a new temporary file for received attachment data. */
+	FString CreateTempFilename()
+	{
+		return FPaths::CreateTempFilename(*(FPaths::ProjectSavedDir() / TEXT("SGMessaging") / TEXT("Attachments")),
+		                                  TEXT("Attachment"), TEXT(".tmp"));
+	}
+
+
+	/**
+	 * Implements the attachment of a chunk, which references the sender's current chunk without copying it.
+	 *
+	 * The view is only valid until the next ReadChunk, which relies on transports encoding messages before
+	 * ISGMessageTransport::TransportMessage returns.
+	 */
+	class FChunkAttachment final
+		: public ISGMessageAttachment
+	{
+	public:
+		explicit FChunkAttachment(const FMemoryView InView)
+			: View(InView)
+		{
+		}
+
+	public:
+		//~ ISGMessageAttachment interface
+
+		virtual FArchive* CreateReader() override
+		{
+			return new FMemoryReaderView(View);
+		}
+
+		virtual FCompositeBuffer GetMemoryBuffer() const override
+		{
+			return FCompositeBuffer(FSharedBuffer::MakeView(View));
+		}
+
+	private:
+		/** Holds the chunk data. */
+		FMemoryView View;
+	};
+
+
+	/**
+	 * Implements a message context that replaces the attachment of another context and adds annotations.
+	 */
+	class FTransferMessageContext final
+		: public ISGMessageContext
+	{
+	public:
+		FTransferMessageContext(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& InContext,
+		                        const TMap<FName, FString>& InAnnotations,
+		                        const TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe>& InAttachment)
+			: Annotations(InContext->GetAnnotations())
+			  , Attachment(InAttachment)
+			  , Inner(InContext)
+		{
+			Annotations.Append(InAnnotations);
+		}
+
+	public:
+		//~ ISGMessageContext interface
+
+		virtual const TMap<FName, FString>& GetAnnotations() const override
+		{
+			return Annotations;
+		}
+
+		virtual TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe> GetAttachment() const override
+		{
+			return Attachment;
+		}
+
+		virtual const FDateTime& GetExpiration() const override
+		{
+			return Inner->GetExpiration();
+		}
+
+		virtual const void* GetMessage() const override
+		{
+			return Inner->GetMessage();
+		}
+
+		virtual TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> GetOriginalContext() const override
+		{
+			return Inner->GetOriginalContext();
+		}
+
+		virtual const TArray<FSGMessageAddress>& GetRecipients() const override
+		{
+			return Inner->GetRecipients();
+		}
+
+		virtual ESGMessageScope GetScope() const override
+		{
+			return Inner->GetScope();
+		}
+
+		virtual ESGMessageFlags GetFlags() const override
+		{
+			return Inner->GetFlags();
+		}
+
+		virtual const FSGMessageAddress& GetSender() const override
+		{
+			return Inner->GetSender();
+		}
+
+		virtual const FSGMessageAddress& GetForwarder() const override
+		{
+			return Inner->GetForwarder();
+		}
+
+		virtual ENamedThreads::Type GetSenderThread() const override
+		{
+			return Inner->GetSenderThread();
+		}
+
+		virtual const FDateTime& GetTimeForwarded() const override
+		{
+			return Inner->GetTimeForwarded();
+		}
+
+		virtual const FDateTime& GetTimeSent() const override
+		{
+			return Inner->GetTimeSent();
+		}
+
+		virtual FName GetMessageTag() const override
+		{
+			return Inner->GetMessageTag();
+		}
+
+	private:
+		/** Holds the annotations of the wrapped context and the transfer annotations. */
+		TMap<FName, FString> Annotations;
+
+		/** Holds the attachment. */
+		TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe> Attachment;
+
+		/** Holds the wrapped context. */
+		TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Inner;
+	};
+}
+
+
+/* FSGMessageAttachmentTransfer structors
+ *****************************************************************************/
+
+FSGMessageAttachmentTransfer::FSGMessageAttachmentTransfer(
+	const TSharedRef<ISGMessageTransport, ESPMode::ThreadSafe>& InTransport, const FSGMessageAddress& InAddress)
+	: Address(InAddress)
+	  , MessageTransport(InTransport)
+	  , ChunkSize(FMath::Max(GetDefault<USGMessagingSettings>()->AttachmentChunkSize, 1024))
+	  , WindowSize(FMath::Max(GetDefault<USGMessagingSettings>()->AttachmentWindowSize, 1))
+	  , NextId(1)
+	  , NumSent(0)
+	  , NumChunksSent(0)
+	  , NumResumed(0)
+	  , NumCompleted(0)
+	  , NumFailed(0)
+	  , NumChunksDropped(0)
+	  , NumReceived(0)
+	  , NumDiscarded(0)
+	  , WorkEvent(FPlatformProcess::GetSynchEventFromPool())
+	  , Thread(nullptr)
+	  , Stopping(false)
+{
+}
+
+
+FSGMessageAttachmentTransfer::~FSGMessageAttachmentTransfer()
+{
+	StopTransfers();
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
+
+/* FSGMessageAttachmentTransfer interface
+ *****************************************************************************/
+
+void FSGMessageAttachmentTransfer::Start()
+{
+	if (Thread != nullptr)
+	{
+		return;
+	}
+
+	Stopping = false;
+	Thread = FRunnableThread::Create(this, TEXT("FSGMessageAttachmentTransfer"), 64 * 1024, TPri_Normal);
+}
+
+
+void FSGMessageAttachmentTransfer::StopTransfers()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	{
+		FScopeLock Lock(&OutboundLock);
+
+		Nodes.Reset();
+		Outbounds.Reset();
+	}
+
+	FScopeLock Lock(&InboundLock);
+
+	for (const auto& InboundPair : Inbounds)
+	{
+		const auto& Inbound = InboundPair.Value;
+
+		if (Inbound->Writer.IsValid())
+		{
+			Inbound->Writer.Reset();
+			IFileManager::Get().Delete(*Inbound->Filename);
+		}
+
+		++NumDiscarded;
+	}
+
+	Inbounds.Reset();
+	Completed.Reset();
+}
+
+
+void FSGMessageAttachmentTransfer::AddNode(const FGuid& NodeId)
+{
+	FScopeLock Lock(&OutboundLock);
+
+	Nodes.Add(NodeId);
+}
+
+
+void FSGMessageAttachmentTransfer::RemoveNode(const FGuid& NodeId)
+{
+	FScopeLock Lock(&OutboundLock);
+
+	Nodes.Remove(NodeId);
+}
+
+
+bool FSGMessageAttachmentTransfer::NeedsTransfer(const ISGMessageContext& Context) const
+{
+	const auto Attachment = Context.GetAttachment();
+
+	if (!Attachment.IsValid())
+	{
+		return false;
+	}
+
+	// in-memory attachments up to a chunk are encoded with their message
+	const auto Buffer = Attachment->GetMemoryBuffer();
+
+	return Buffer.IsNull() || (static_cast<int64>(Buffer.GetSize()) > ChunkSize);
+}
+
+
+TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> FSGMessageAttachmentTransfer::Send(
+	const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context, TArrayView<const FGuid> InNodes)
+{
+	const auto Attachment = Context->GetAttachment();
+	auto Reader = Attachment.IsValid() ? Attachment->CreateChunkReader() : nullptr;
+
+	if (!Reader.IsValid())
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("Cannot read the attachment of a %s message, sending it without"),
+		       *Context->GetMessageTag().ToString());
+
+		return Context;
+	}
+
+	const uint64 Id = NextId++;
+	const auto Size = Reader->GetSize();
+	const auto Now = FPlatformTime::Seconds();
+
+	{
+		FScopeLock Lock(&OutboundLock);
+
+		TArray<FGuid, TInlineAllocator<4>> Targets;
+
+		if (InNodes.Num() > 0)
+		{
+			Targets.Append(InNodes.GetData(), InNodes.Num());
+		}
+		else
+		{
+			Targets.Append(Nodes.Array());
+		}
+
+		for (const auto& NodeId : Targets)
+		{
+			const auto Outbound = MakeShared<FOutbound, ESPMode::ThreadSafe>();
+
+			Outbound->Id = Id;
+			Outbound->NodeId = NodeId;
+			Outbound->Attachment = Attachment;
+			Outbound->Size = Size;
+			Outbound->LastProgressTime = Now;
+			Outbound->Expiration = Context->GetExpiration();
+
+			// the first transfer reuses the reader that was opened to get the size
+			if (Reader.IsValid())
+			{
+				Outbound->Reader = MoveTemp(Reader);
+			}
+
+			Outbounds.Add(Outbound);
+		}
+
+		NumSent += Targets.Num();
+	}
+
+	WorkEvent->Trigger();
+
+	TMap<FName, FString> Annotations;
+
+	Annotations.Add(SGMessageAttachmentTransfer::TransferKey, LexToString(Id));
+	Annotations.Add(SGMessageAttachmentTransfer::SizeKey, LexToString(Size));
+
+	return MakeShared<SGMessageAttachmentTransfer::FTransferMessageContext, ESPMode::ThreadSafe>(
+		Context, Annotations, nullptr);
+}
+
+
+bool FSGMessageAttachmentTransfer::Receive(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                           const FGuid& NodeId)
+{
+	const auto MessageTag = Context->GetMessageTag();
+
+	if (MessageTag == SGMessageAttachmentTransfer::ChunkTag)
+	{
+		HandleChunk(*Context, NodeId);
+
+		return false;
+	}
+
+	if (MessageTag == SGMessageAttachmentTransfer::ChunkAckTag)
+	{
+		HandleChunkAck(*Context, NodeId);
+
+		return false;
+	}
+
+	if (!Context->GetAnnotations().Contains(SGMessageAttachmentTransfer::TransferKey))
+	{
+		return true;
+	}
+
+	HandleMessage(Context, NodeId);
+
+	return false;
+}
+
+
+FSGMessageAttachmentStats FSGMessageAttachmentTransfer::GetStats() const
+{
+	FSGMessageAttachmentStats Stats;
+
+	Stats.NumSent = NumSent;
+	Stats.NumChunksSent = NumChunksSent;
+	Stats.NumResumed = NumResumed;
+	Stats.NumCompleted = NumCompleted;
+	Stats.NumFailed = NumFailed;
+	Stats.NumChunksDropped = NumChunksDropped;
+	Stats.NumReceived = NumReceived;
+	Stats.NumDiscarded = NumDiscarded;
+
+	return Stats;
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+bool FSGMessageAttachmentTransfer::Init()
+{
+	return true;
+}
+
+
+uint32 FSGMessageAttachmentTransfer::Run()
+{
+	while (!Stopping)
+	{
+		WorkEvent->Wait(SGMessageAttachmentTransfer::TimerIntervalMs);
+
+		ProcessTimers();
+	}
+
+	return 0;
+}
+
+
+void FSGMessageAttachmentTransfer::Stop()
+{
+	Stopping = true;
+
+	WorkEvent->Trigger();
+}
+
+
+/* FSGMessageAttachmentTransfer implementation
+ *****************************************************************************/
+
+void FSGMessageAttachmentTransfer::HandleChunk(const ISGMessageContext& Chunk, const FGuid& NodeId)
+{
+	const uint64 Id = SGMessageAttachmentTransfer::ParseAnnotation(Chunk, SGMessageAttachmentTransfer::TransferKey);
+	const auto Offset = SGMessageAttachmentTransfer::ParseAnnotation(Chunk, SGMessageAttachmentTransfer::OffsetKey);
+	const auto Size = SGMessageAttachmentTransfer::ParseAnnotation(Chunk, SGMessageAttachmentTransfer::SizeKey, -1);
+	const auto ChunkAttachment = Chunk.GetAttachment();
+	const auto Data = ChunkAttachment.IsValid() ? ChunkAttachment->GetMemoryBuffer() : FCompositeBuffer();
+	const FInboundKey Key(NodeId, Id);
+
+	int64 Received;
+	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> CompletedContext;
+	{
+		FScopeLock Lock(&InboundLock);
+
+		// late duplicates of finished transfers only need to be acknowledged again
+		if (Completed.Contains(Key))
+		{
+			Received = Size;
+		}
+		else
+		{
+			const auto Inbound = FindOrAddInbound(Key);
+
+			Inbound->LastActivityTime = FPlatformTime::Seconds();
+
+			if (Inbound->Size < 0)
+			{
+				Inbound->Size = Size;
+			}
+
+			// chunks beyond a gap are dropped, the sender resumes from the acknowledged offset
+			const auto bInOrder = (Offset == Inbound->Received) && (Data.GetSize() > 0) &&
+				(Offset + static_cast<int64>(Data.GetSize()) <= Inbound->Size);
+
+			if (bInOrder)
+			{
+				if (!Inbound->Writer.IsValid())
+				{
+					Inbound->Filename = SGMessageAttachmentTransfer::CreateTempFilename();
+					Inbound->Writer.Reset(IFileManager::Get().CreateFileWriter(*Inbound->Filename));
+				}
+
+				if (Inbound->Writer.IsValid())
+				{
+					for (const FSharedBuffer& Segment : Data.GetSegments())
+					{
+						Inbound->Writer->Serialize(const_cast<void*>(Segment.GetData()),
+						                           static_cast<int64>(Segment.GetSize()));
+					}
+					Inbound->Received += static_cast<int64>(Data.GetSize());
+				}
+				else
+				{
+					UE_LOG(LogSGMessaging, Error, TEXT("Failed to create %s for a message attachment"),
+					       *Inbound->Filename);
+				}
+			}
+			else
+			{
+				++NumChunksDropped;
+			}
+
+			Received = Inbound->Received;
+			CompletedContext = CompleteInbound(Key, *Inbound);
+		}
+	}
+
+	SendAck(NodeId, Id, Received);
+
+	if (CompletedContext.IsValid())
+	{
+		MessageReceivedDelegate.ExecuteIfBound(CompletedContext.ToSharedRef(), NodeId);
+	}
+}
+
+
+void FSGMessageAttachmentTransfer::HandleChunkAck(const ISGMessageContext& Ack, const FGuid& NodeId)
+{
+	const uint64 Id = SGMessageAttachmentTransfer::ParseAnnotation(Ack, SGMessageAttachmentTransfer::TransferKey);
+	const auto Received = SGMessageAttachmentTransfer::ParseAnnotation(Ack, SGMessageAttachmentTransfer::OffsetKey);
+
+	FOutboundPtr Outbound;
+	{
+		FScopeLock Lock(&OutboundLock);
+
+		for (const auto& Candidate : Outbounds)
+		{
+			if ((Candidate->Id == Id) && (Candidate->NodeId == NodeId))
+			{
+				Outbound = Candidate;
+
+				break;
+			}
+		}
+	}
+
+	if (!Outbound.IsValid())
+	{
+		return;
+	}
+
+	{
+		FScopeLock Lock(&Outbound->CriticalSection);
+
+		if (Received > Outbound->Acknowledged)
+		{
+			Outbound->Acknowledged = FMath::Min(Received, Outbound->Size);
+			Outbound->LastProgressTime = FPlatformTime::Seconds();
+			Outbound->NumDuplicateAcks = 0;
+			Outbound->NumResumes = 0;
+		}
+		else
+		{
+			++Outbound->NumDuplicateAcks;
+		}
+	}
+
+	// the window moved, or chunks were lost
+	WorkEvent->Trigger();
+}
+
+
+void FSGMessageAttachmentTransfer::HandleMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                                 const FGuid& NodeId)
+{
+	const uint64 Id = SGMessageAttachmentTransfer::ParseAnnotation(*Context, SGMessageAttachmentTransfer::TransferKey);
+	const auto Size = SGMessageAttachmentTransfer::ParseAnnotation(*Context, SGMessageAttachmentTransfer::SizeKey);
+	const FInboundKey Key(NodeId, Id);
+
+	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> CompletedContext;
+	{
+		FScopeLock Lock(&InboundLock);
+
+		if (Completed.Contains(Key))
+		{
+			return;
+		}
+
+		const auto Inbound = FindOrAddInbound(Key);
+
+		if (Inbound->Context.IsValid())
+		{
+			return;
+		}
+
+		Inbound->Context = Context;
+		Inbound->LastActivityTime = FPlatformTime::Seconds();
+
+		if (Inbound->Size < 0)
+		{
+			Inbound->Size = Size;
+		}
+
+		CompletedContext = CompleteInbound(Key, *Inbound);
+	}
+
+	if (CompletedContext.IsValid())
+	{
+		MessageReceivedDelegate.ExecuteIfBound(CompletedContext.ToSharedRef(), NodeId);
+	}
+}
+
+
+TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> FSGMessageAttachmentTransfer::CompleteInbound(
+	const FInboundKey& Key, FInbound& Inbound)
+{
+	if (!Inbound.Context.IsValid() || (Inbound.Size < 0) || (Inbound.Received < Inbound.Size))
+	{
+		return nullptr;
+	}
+
+	// empty attachments do not have any chunks
+	if (!Inbound.Writer.IsValid())
+	{
+		Inbound.Filename = SGMessageAttachmentTransfer::CreateTempFilename();
+		Inbound.Writer.Reset(IFileManager::Get().CreateFileWriter(*Inbound.Filename));
+	}
+
+	const auto bWritten = Inbound.Writer.IsValid() && Inbound.Writer->Close();
+
+	Inbound.Writer.Reset();
+
+	TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe> Attachment;
+
+	if (bWritten)
+	{
+		Attachment = MakeShared<FSGFileMessageAttachment, ESPMode::ThreadSafe>(Inbound.Filename, true);
+	}
+	else
+	{
+		UE_LOG(LogSGMessaging, Error, TEXT("Failed to write the attachment of a %s message, delivering it without"),
+		       *Inbound.Context->GetMessageTag().ToString());
+
+		IFileManager::Get().Delete(*Inbound.Filename);
+	}
+
+	const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Context =
+		MakeShared<SGMessageAttachmentTransfer::FTransferMessageContext, ESPMode::ThreadSafe>(
+			Inbound.Context.ToSharedRef(), TMap<FName, FString>(), Attachment);
+
+	Completed.Add(Key, FPlatformTime::Seconds());
+	Inbounds.Remove(Key);
+
+	++NumReceived;
+
+	return Context;
+}
+
+
+FSGMessageAttachmentTransfer::FInboundPtr FSGMessageAttachmentTransfer::FindOrAddInbound(const FInboundKey& Key)
+{
+	auto& Inbound = Inbounds.FindOrAdd(Key);
+
+	if (!Inbound.IsValid())
+	{
+		Inbound = MakeShared<FInbound, ESPMode::ThreadSafe>();
+		Inbound->NodeId = Key.Key;
+	}
+
+	return Inbound;
+}
+
+
+bool FSGMessageAttachmentTransfer::PumpOutbound(FOutbound& Outbound, const double Now)
+{
+	int64 Acknowledged;
+	{
+		FScopeLock Lock(&Outbound.CriticalSection);
+
+		if (Outbound.Acknowledged >= Outbound.Size)
+		{
+			++NumCompleted;
+
+			return false;
+		}
+
+		const auto bStalled = (Now - Outbound.LastProgressTime) > SGMessageAttachmentTransfer::ResumeTimeout;
+		const auto bLost = (Outbound.NumDuplicateAcks >= SGMessageAttachmentTransfer::ResumeAfterDuplicateAcks) &&
+			(Outbound.NextOffset > Outbound.Acknowledged);
+
+		if (bStalled || bLost)
+		{
+			if (bStalled && (++Outbound.NumResumes > SGMessageAttachmentTransfer::MaxResumes))
+			{
+				UE_LOG(LogSGMessaging, Warning, TEXT("Giving up attachment transfer %llu to node %s at %lld of %lld bytes"),
+				       Outbound.Id, *Outbound.NodeId.ToString(), Outbound.Acknowledged, Outbound.Size);
+
+				++NumFailed;
+
+				return false;
+			}
+
+			Outbound.NextOffset = Outbound.Acknowledged;
+			Outbound.NumDuplicateAcks = 0;
+			Outbound.LastProgressTime = Now;
+
+			++NumResumed;
+		}
+
+		Acknowledged = Outbound.Acknowledged;
+	}
+
+	if (Outbound.Expiration < FDateTime::UtcNow())
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("Attachment transfer %llu to node %s expired"), Outbound.Id,
+		       *Outbound.NodeId.ToString());
+
+		++NumFailed;
+
+		return false;
+	}
+
+	if (!Outbound.Reader.IsValid())
+	{
+		Outbound.Reader = Outbound.Attachment->CreateChunkReader();
+
+		if (!Outbound.Reader.IsValid())
+		{
+			UE_LOG(LogSGMessaging, Error, TEXT("Cannot read the attachment of transfer %llu"), Outbound.Id);
+
+			++NumFailed;
+
+			return false;
+		}
+	}
+
+	const auto WindowEnd = FMath::Min(Outbound.Size, Acknowledged + ChunkSize * WindowSize);
+
+	while (Outbound.NextOffset < WindowEnd)
+	{
+		const auto Data = Outbound.Reader->ReadChunk(Outbound.NextOffset, ChunkSize);
+
+		if (Data.IsEmpty())
+		{
+			UE_LOG(LogSGMessaging, Error, TEXT("Failed to read the attachment of transfer %llu at %lld"), Outbound.Id,
+			       Outbound.NextOffset);
+
+			++NumFailed;
+
+			return false;
+		}
+
+		// let the next chunk load while this one is being sent
+		Outbound.Reader->Prefetch(Outbound.NextOffset + static_cast<int64>(Data.GetSize()), ChunkSize);
+
+		TMap<FName, FString> Annotations;
+
+		Annotations.Add(SGMessageAttachmentTransfer::TransferKey, LexToString(Outbound.Id));
+		Annotations.Add(SGMessageAttachmentTransfer::OffsetKey, LexToString(Outbound.NextOffset));
+		Annotations.Add(SGMessageAttachmentTransfer::SizeKey, LexToString(Outbound.Size));
+
+		const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Chunk = MakeShared<FSGMessageContext, ESPMode::ThreadSafe>(
+			SGMessageAttachmentTransfer::ChunkTag,
+			FSGMessageBuilder::Builder<FSGMessage>(),
+			Annotations,
+			MakeShared<SGMessageAttachmentTransfer::FChunkAttachment, ESPMode::ThreadSafe>(Data),
+			Address,
+			TArray<FSGMessageAddress>(),
+			ESGMessageScope::Network,
+			ESGMessageFlags::None,
+			FDateTime::UtcNow(),
+			Outbound.Expiration,
+			ENamedThreads::AnyThread
+		);
+
+		// the transport is busy or the node is gone, try again later
+		if (!MessageTransport->TransportMessage(Chunk, MakeArrayView(&Outbound.NodeId, 1)))
+		{
+			break;
+		}
+
+		Outbound.NextOffset += Data.GetSize();
+		++NumChunksSent;
+	}
+
+	return true;
+}
+
+
+void FSGMessageAttachmentTransfer::SendAck(const FGuid& NodeId, const uint64 Id, const int64 Received)
+{
+	TMap<FName, FString> Annotations;
+
+	Annotations.Add(SGMessageAttachmentTransfer::TransferKey, LexToString(Id));
+	Annotations.Add(SGMessageAttachmentTransfer::OffsetKey, LexToString(Received));
+
+	const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Ack = MakeShared<FSGMessageContext, ESPMode::ThreadSafe>(
+		SGMessageAttachmentTransfer::ChunkAckTag,
+		FSGMessageBuilder::Builder<FSGMessage>(),
+		Annotations,
+		nullptr,
+		Address,
+		TArray<FSGMessageAddress>(),
+		ESGMessageScope::Network,
+		ESGMessageFlags::None,
+		FDateTime::UtcNow(),
+		FDateTime::MaxValue(),
+		ENamedThreads::AnyThread
+	);
+
+	MessageTransport->TransportMessage(Ack, MakeArrayView(&NodeId, 1));
+}
+
+
+void FSGMessageAttachmentTransfer::ProcessTimers()
+{
+	const auto Now = FPlatformTime::Seconds();
+
+	// send chunks
+	TArray<FOutboundPtr> CurrentOutbounds;
+	{
+		FScopeLock Lock(&OutboundLock);
+		CurrentOutbounds = Outbounds;
+	}
+
+	TArray<FOutboundPtr> FinishedOutbounds;
+
+	for (const auto& Outbound : CurrentOutbounds)
+	{
+		if (!PumpOutbound(*Outbound, Now))
+		{
+			FinishedOutbounds.Add(Outbound);
+		}
+	}
+
+	if (FinishedOutbounds.Num() > 0)
+	{
+		FScopeLock Lock(&OutboundLock);
+
+		Outbounds.RemoveAll([&FinishedOutbounds](const FOutboundPtr& Outbound)
+		{
+			return FinishedOutbounds.Contains(Outbound);
+		});
+	}
+
+	// discard abandoned inbound transfers
+	FScopeLock Lock(&InboundLock);
+
+	for (auto It = Inbounds.CreateIterator(); It; ++It)
+	{
+		const auto& Inbound = It.Value();
+
+		if (Now - Inbound->LastActivityTime < SGMessageAttachmentTransfer::InboundTimeout)
+		{
+			continue;
+		}
+
+		UE_LOG(LogSGMessaging, Warning, TEXT("Discarding incomplete attachment from node %s after %lld of %lld bytes"),
+		       *Inbound->NodeId.ToString(), Inbound->Received, Inbound->Size);
+
+		if (Inbound->Writer.IsValid())
+		{
+			Inbound->Writer.Reset();
+			IFileManager::Get().Delete(*Inbound->Filename);
+		}
+
+		++NumDiscarded;
+		It.RemoveCurrent();
+	}
+
+	for (auto It = Completed.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value() >= SGMessageAttachmentTransfer::InboundTimeout)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
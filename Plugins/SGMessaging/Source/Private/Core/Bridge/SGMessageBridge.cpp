@@ -1,10 +1,30 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Core/Bridge/SGMessageBridge.h"
+#include "Core/Bus/SGMessageContext.h"
 #include "Core/Interface/ISGMessagingModule.h"
 #include "Core/Interface/ISGMessageBus.h"
 #include "Core/Interface/ISGMessageSubscription.h"
 #include "Core/Interface/ISGMessageTransport.h"
+#include "Core/Message/SGMessage.h"
+#include "Core/Message/SGMessageBuilder.h"
+#include "Misc/ScopeLock.h"
+
+
+namespace SGMessageBridge
+{
+	/** The message tag of interest reports. */
+	const FName InterestTag(TEXT("SGMessaging.Interest"));
+
+	/** The annotation of an interest report that holds its version. */
+	const FName InterestVersionKey(TEXT("SG.Version"));
+
+	/** The annotation of an interest report that holds the message tags. */
+	const FName InterestTagsKey(TEXT("SG.Tags"));
+
+	/** The separator of the message tags in an interest report. */
+	const TCHAR* InterestTagsSeparator = TEXT("\n");
+}
 
 
 /* FSGMessageBridge structors
@@ -19,9 +39,19 @@ FSGMessageBridge::FSGMessageBridge(
 	  , Bus(InBus)
 	  , Enabled(false)
 	  , Id(FGuid::NewGuid())
+	  , LocalInterestVersion(0)
+	  , InterestUpdatePending(false)
 	  , Transport(InTransport)
 {
 	Bus->OnShutdown().AddRaw(this, &FSGMessageBridge::HandleMessageBusShutdown);
+
+	if (!Transport->IsReliable())
+	{
+		Reliability = MakeUnique<FSGMessageReliability>(InTransport, Address);
+	}
+
+	AttachmentTransfer = MakeUnique<FSGMessageAttachmentTransfer>(InTransport, Address);
+	AttachmentTransfer->OnMessageReceived().BindRaw(this, &FSGMessageBridge::DeliverTransportMessage);
 }
 
 
@@ -61,11 +91,20 @@ void FSGMessageBridge::Disable()
 		MessageSubscription->Disable();
 	}
 
+	if (Reliability.IsValid())
+	{
+		Reliability->StopReliability();
+	}
+
+	AttachmentTransfer->StopTransfers();
+
 	if (Transport.IsValid())
 	{
 		Transport->StopTransport();
 	}
 
+	InterestTable.Clear();
+
 	Enabled = false;
 }
 
@@ -83,6 +122,13 @@ void FSGMessageBridge::Enable()
 		return;
 	}
 
+	if (Reliability.IsValid())
+	{
+		Reliability->Start();
+	}
+
+	AttachmentTransfer->Start();
+
 	Bus->Register(Address, AsShared());
 
 	if (MessageSubscription.IsValid())
@@ -93,9 +139,14 @@ void FSGMessageBridge::Enable()
 	{
 		MessageSubscription = Bus->Subscribe(AsShared(), NAME_All,
 		                                     FSGMessageScopeRange::AtLeast(ESGMessageScope::Network));
+
+		// the local interest is tracked for the lifetime of the bridge, the bus drops the listener when it goes away
+		Bus->AddNotificationListener(AsShared());
 	}
 
 	Enabled = true;
+
+	SendInterest(TArrayView<const FGuid>());
 }
 
 
@@ -105,6 +156,18 @@ bool FSGMessageBridge::IsEnabled() const
 }
 
 
+FSGMessageReliabilityStats FSGMessageBridge::GetReliabilityStats() const
+{
+	return Reliability.IsValid() ? Reliability->GetStats() : FSGMessageReliabilityStats();
+}
+
+
+FSGMessageAttachmentStats FSGMessageBridge::GetAttachmentStats() const
+{
+	return AttachmentTransfer->GetStats();
+}
+
+
 /* ISGMessageReceiver interface
  *****************************************************************************/
 
@@ -143,20 +206,50 @@ void FSGMessageBridge::ReceiveMessage(const TSharedRef<ISGMessageContext, ESPMod
 	}
 
 	// get remote nodes
-	TArray<FGuid> RemoteNodes;
+	const auto& Recipients = Context->GetRecipients();
+
+	FSGMessageAddressBook::FNodeArray RemoteNodes;
 
-	if (Context->GetRecipients().Num() > 0)
+	if (Recipients.Num() == 1)
 	{
-		RemoteNodes = AddressBook.GetNodesFor(Context->GetRecipients());
+		FGuid NodeId;
+
+		if (!AddressBook.FindNode(Recipients[0], NodeId))
+		{
+			return;
+		}
+
+		RemoteNodes.Add(NodeId);
+	}
+	else if (Recipients.Num() > 1)
+	{
+		AddressBook.GetNodesFor(Recipients, RemoteNodes);
 
 		if (RemoteNodes.Num() == 0)
 		{
 			return;
 		}
 	}
+	else if (!InterestTable.GetInterestedNodes(Context->GetMessageTag(), RemoteNodes))
+	{
+		// published message that no remote node subscribed to
+		return;
+	}
+
+	// stream attachments separately
+	const auto TransportContext = AttachmentTransfer->NeedsTransfer(*Context)
+		                              ? AttachmentTransfer->Send(Context, RemoteNodes)
+		                              : Context;
 
 	// forward message to remote nodes
-	Transport->TransportMessage(Context, RemoteNodes);
+	if (Reliability.IsValid() && EnumHasAnyFlags(Context->GetFlags(), ESGMessageFlags::Reliable))
+	{
+		Reliability->Send(TransportContext, RemoteNodes);
+	}
+	else
+	{
+		Transport->TransportMessage(TransportContext, RemoteNodes);
+	}
 }
 
 
@@ -176,12 +269,73 @@ void FSGMessageBridge::NotifyMessageError(const TSharedRef<ISGMessageContext, ES
 }
 
 
+/* ISGBusListener interface
+ *****************************************************************************/
+
+ENamedThreads::Type FSGMessageBridge::GetListenerThread() const
+{
+	return ENamedThreads::AnyThread;
+}
+
+
+void FSGMessageBridge::NotifyRegistration(const FSGMessageAddress& InAddress, ESGMessageBusNotification Notification)
+{
+	// remote endpoints are registered and unregistered by the bridge itself
+}
+
+
+void FSGMessageBridge::NotifySubscription(const FName& MessageTag, ESGMessageBusNotification Notification)
+{
+	{
+		FScopeLock Lock(&LocalInterestLock);
+
+		if (Notification == ESGMessageBusNotification::Registered)
+		{
+			LocalInterest.Add(MessageTag);
+		}
+		else
+		{
+			LocalInterest.Remove(MessageTag);
+		}
+
+		++LocalInterestVersion;
+	}
+
+	// subscriptions often change in bursts, so coalesce them into a single report
+	if (InterestUpdatePending.Exchange(true))
+	{
+		return;
+	}
+
+	const TWeakPtr<FSGMessageBridge, ESPMode::ThreadSafe> BridgePtr = AsShared();
+
+	FFunctionGraphTask::CreateAndDispatchWhenReady([BridgePtr]()
+	{
+		if (const auto Bridge = BridgePtr.Pin())
+		{
+			Bridge->InterestUpdatePending = false;
+			Bridge->SendInterest(TArrayView<const FGuid>());
+		}
+	}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+}
+
+
 /* ISGMessageTransportHandler interface
  *****************************************************************************/
 
 void FSGMessageBridge::DiscoverTransportNode(const FGuid& NodeId)
 {
-	// do nothing (address book is updated in ReceiveTransportMessage)
+	// address book is updated in ReceiveTransportMessage
+	FSGMessageAddress::AddNode(NodeId);
+
+	if (Reliability.IsValid())
+	{
+		Reliability->AddNode(NodeId);
+	}
+
+	AttachmentTransfer->AddNode(NodeId);
+	InterestTable.AddNode(NodeId);
+	SendInterest(MakeArrayView(&NodeId, 1));
 }
 
 
@@ -191,6 +345,16 @@ void FSGMessageBridge::ForgetTransportNode(const FGuid& NodeId)
 
 	// update address book
 	AddressBook.RemoveNode(NodeId, RemovedAddresses);
+	InterestTable.RemoveNode(NodeId);
+
+	if (Reliability.IsValid())
+	{
+		Reliability->RemoveNode(NodeId);
+	}
+
+	AttachmentTransfer->RemoveNode(NodeId);
+
+	FSGMessageAddress::RemoveNode(NodeId);
 
 	// unregister endpoints
 	if (Bus.IsValid())
@@ -220,6 +384,65 @@ void FSGMessageBridge::ReceiveTransportMessage(const TSharedRef<ISGMessageContex
 		return;
 	}
 
+	// discard messages from nodes that were not discovered
+	if (!Context->GetSender().IsValid())
+	{
+		UE_LOG(LogSGMessaging, Verbose,
+		       TEXT("FSGMessageBridge::ReceiveTransportMessage: Unknown sender on node %s. Discarding"),
+		       *NodeId.ToString());
+		return;
+	}
+
+	// consume acknowledgements and duplicates, and hold back ordered messages that arrived beyond a gap
+	if (Reliability.IsValid())
+	{
+		FSGMessageReliability::FReceivedArray Received;
+		Reliability->Receive(Context, NodeId, Received);
+
+		for (const auto& ReceivedContext : Received)
+		{
+			ProcessTransportMessage(ReceivedContext, NodeId);
+		}
+
+		return;
+	}
+
+	ProcessTransportMessage(Context, NodeId);
+}
+
+
+/* FSGMessageBridge implementation
+ *****************************************************************************/
+
+void FSGMessageBridge::ProcessTransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                               const FGuid& NodeId)
+{
+	// consume interest reports
+	if (Context->GetMessageTag() == SGMessageBridge::InterestTag)
+	{
+		ProcessInterest(*Context, NodeId);
+
+		return;
+	}
+
+	// consume attachment chunks and hold back messages until their attachments arrived
+	if (!AttachmentTransfer->Receive(Context, NodeId))
+	{
+		return;
+	}
+
+	DeliverTransportMessage(Context, NodeId);
+}
+
+
+void FSGMessageBridge::DeliverTransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                               const FGuid& NodeId)
+{
+	if (!Enabled || !Bus.IsValid())
+	{
+		return;
+	}
+
 	// discard expired messages
 	if (Context->GetExpiration() < FDateTime::UtcNow())
 	{
@@ -242,6 +465,100 @@ void FSGMessageBridge::ReceiveTransportMessage(const TSharedRef<ISGMessageContex
 }
 
 
+void FSGMessageBridge::ProcessInterest(const ISGMessageContext& Context, const FGuid& NodeId)
+{
+	const FString* VersionString = Context.GetAnnotations().Find(SGMessageBridge::InterestVersionKey);
+
+	if (VersionString == nullptr)
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("Ignoring interest report without version from node %s"),
+		       *NodeId.ToString());
+
+		return;
+	}
+
+	uint64 Version = 0;
+	LexFromString(Version, **VersionString);
+
+	TSet<FName> MessageTags;
+
+	if (const FString* TagsString = Context.GetAnnotations().Find(SGMessageBridge::InterestTagsKey))
+	{
+		TArray<FString> TagStrings;
+		TagsString->ParseIntoArray(TagStrings, SGMessageBridge::InterestTagsSeparator);
+
+		MessageTags.Reserve(TagStrings.Num());
+
+		for (const auto& TagString : TagStrings)
+		{
+			MessageTags.Add(FName(*TagString));
+		}
+	}
+
+	const auto NumTags = MessageTags.Num();
+
+	if (InterestTable.SetInterest(NodeId, Version, MoveTemp(MessageTags)))
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("Node %s is interested in %d message tags (version %llu)"),
+		       *NodeId.ToString(), NumTags, Version);
+	}
+}
+
+
+void FSGMessageBridge::SendInterest(TArrayView<const FGuid> Nodes)
+{
+	if (!Enabled || !Transport.IsValid())
+	{
+		return;
+	}
+
+	TMap<FName, FString> Annotations;
+
+	{
+		FScopeLock Lock(&LocalInterestLock);
+
+		FString TagsString;
+
+		for (const auto& MessageTag : LocalInterest)
+		{
+			if (!TagsString.IsEmpty())
+			{
+				TagsString.Append(SGMessageBridge::InterestTagsSeparator);
+			}
+
+			TagsString.Append(MessageTag.ToString());
+		}
+
+		Annotations.Add(SGMessageBridge::InterestVersionKey, LexToString(LocalInterestVersion));
+		Annotations.Add(SGMessageBridge::InterestTagsKey, MoveTemp(TagsString));
+	}
+
+	const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Context = MakeShared<FSGMessageContext, ESPMode::ThreadSafe>(
+		SGMessageBridge::InterestTag,
+		FSGMessageBuilder::Builder<FSGMessage>(),
+		Annotations,
+		nullptr,
+		Address,
+		TArray<FSGMessageAddress>(),
+		ESGMessageScope::Network,
+		ESGMessageFlags::None,
+		FDateTime::UtcNow(),
+		FDateTime::MaxValue(),
+		ENamedThreads::AnyThread
+	);
+
+	// reports must not get lost, or the other nodes would withhold messages from this one
+	if (Reliability.IsValid())
+	{
+		Reliability->Send(Context, Nodes);
+	}
+	else
+	{
+		Transport->TransportMessage(Context, Nodes);
+	}
+}
+
+
 /* FSGMessageBridge callbacks
  *****************************************************************************/
 
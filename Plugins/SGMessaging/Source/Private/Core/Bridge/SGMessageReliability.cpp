@@ -0,0 +1,796 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Bridge/SGMessageReliability.h"
+#include "Core/Bus/SGMessageContext.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Interface/ISGMessageTransport.h"
+#include "Core/Message/SGMessage.h"
+#include "Core/Message/SGMessageBuilder.h"
+#include "HAL/Event.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
+
+
+namespace SGMessageReliability
+{
+	/** The message tag of acknowledgements. */
+	const FName AckTag(TEXT("SGMessaging.Ack"));
+
+	/** The annotation that holds a message's sequence number. */
+	const FName SequenceKey(TEXT("SG.Seq"));
+
+	/** The annotation that holds the lowest sequence number that the sender still tracks. */
+	const FName BaseKey(TEXT("SG.Base"));
+
+	/** The annotation of an acknowledgement that holds the cumulative sequence number. */
+	const FName CumulativeKey(TEXT("SG.Ack"));
+
+	/** The annotation of an acknowledgement that holds the selectively acknowledged sequence numbers. */
+	const FName SelectiveKey(TEXT("SG.Sack"));
+
+	/** The maximum number of unacknowledged messages per node. */
+	constexpr int32 WindowSize = 256;
+
+	/** The maximum number of selectively acknowledged sequence numbers per acknowledgement. */
+	constexpr int32 MaxSelectiveAcks = 32;
+
+	/** The number of received messages after which an acknowledgement is sent immediately. */
+	constexpr int32 AckEvery = 16;
+
+	/** The time by which acknowledgements may be delayed. */
+	constexpr double AckDelay = 0.005;
+
+	/** The number of acknowledgements that have to report later messages before a message is retransmitted. */
+	constexpr int32 FastRetransmitReports = 3;
+
+	/** The number of retransmissions after which a message is given up. */
+	constexpr int32 MaxRetransmits = 10;
+
+	/** The retransmission timeout before a round-trip time was measured. */
+	constexpr double InitialRetransmitTimeout = 0.2;
+
+	/** The lower bound of the retransmission timeout. */
+	constexpr double MinRetransmitTimeout = 0.02;
+
+	/** The upper bound of the retransmission timeout. */
+	constexpr double MaxRetransmitTimeout = 2.0;
+
+	/** The interval at which the timer thread runs. */
+	constexpr uint32 TimerIntervalMs = 2;
+
+
+	/** Parses an unsigned annotation value. */
+	uint64 ParseSequence(const FString* Value)
+	{
+		uint64 Result = 0;
+
+		if (Value != nullptr)
+		{
+			LexFromString(Result, **Value);
+		}
+
+		return Result;
+	}
+
+
+	/**
+	 * Implements a message context that adds sequencing annotations to another context.
+	 */
+	class FSequencedMessageContext final
+		: public ISGMessageContext
+	{
+	public:
+		FSequencedMessageContext(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& InContext,
+		                         const uint64 Sequence)
+			: Annotations(InContext->GetAnnotations())
+			  , Inner(InContext)
+		{
+			Annotations.Add(SequenceKey, LexToString(Sequence));
+		}
+
+		/** Sets the lowest sequence number that the sender still tracks. */
+		void SetBase(const uint64 Base)
+		{
+			Annotations.Add(BaseKey, LexToString(Base));
+		}
+
+	public:
+		//~ ISGMessageContext interface
+
+		virtual const TMap<FName, FString>& GetAnnotations() const override
+		{
+			return Annotations;
+		}
+
+		virtual TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe> GetAttachment() const override
+		{
+			return Inner->GetAttachment();
+		}
+
+		virtual const FDateTime& GetExpiration() const override
+		{
+			return Inner->GetExpiration();
+		}
+
+		virtual const void* GetMessage() const override
+		{
+			return Inner->GetMessage();
+		}
+
+		virtual TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> GetOriginalContext() const override
+		{
+			return Inner->GetOriginalContext();
+		}
+
+		virtual const TArray<FSGMessageAddress>& GetRecipients() const override
+		{
+			return Inner->GetRecipients();
+		}
+
+		virtual ESGMessageScope GetScope() const override
+		{
+			return Inner->GetScope();
+		}
+
+		virtual ESGMessageFlags GetFlags() const override
+		{
+			return Inner->GetFlags();
+		}
+
+		virtual const FSGMessageAddress& GetSender() const override
+		{
+			return Inner->GetSender();
+		}
+
+		virtual const FSGMessageAddress& GetForwarder() const override
+		{
+			return Inner->GetForwarder();
+		}
+
+		virtual ENamedThreads::Type GetSenderThread() const override
+		{
+			return Inner->GetSenderThread();
+		}
+
+		virtual const FDateTime& GetTimeForwarded() const override
+		{
+			return Inner->GetTimeForwarded();
+		}
+
+		virtual const FDateTime& GetTimeSent() const override
+		{
+			return Inner->GetTimeSent();
+		}
+
+		virtual FName GetMessageTag() const override
+		{
+			return Inner->GetMessageTag();
+		}
+
+	private:
+		/** Holds the annotations of the wrapped context and the sequencing annotations. */
+		TMap<FName, FString> Annotations;
+
+		/** Holds the wrapped context. */
+		TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Inner;
+	};
+}
+
+
+/* FSGMessageReliability structors
+ *****************************************************************************/
+
+FSGMessageReliability::FSGMessageReliability(const TSharedRef<ISGMessageTransport, ESPMode::ThreadSafe>& InTransport,
+                                             const FSGMessageAddress& InAddress)
+	: Address(InAddress)
+	  , MessageTransport(InTransport)
+	  , NumSent(0)
+	  , NumRetransmitted(0)
+	  , NumFastRetransmitted(0)
+	  , NumAcknowledged(0)
+	  , NumFailed(0)
+	  , NumOutOfOrder(0)
+	  , NumDuplicates(0)
+	  , NumHeldBack(0)
+	  , NumAcksSent(0)
+	  , MinRttMicroseconds(0)
+	  , SmoothedRttMicroseconds(0)
+	  , WorkEvent(FPlatformProcess::GetSynchEventFromPool())
+	  , Thread(nullptr)
+	  , Stopping(false)
+{
+}
+
+
+FSGMessageReliability::~FSGMessageReliability()
+{
+	StopReliability();
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
+
+/* FSGMessageReliability interface
+ *****************************************************************************/
+
+void FSGMessageReliability::Start()
+{
+	if (Thread != nullptr)
+	{
+		return;
+	}
+
+	Stopping = false;
+	Thread = FRunnableThread::Create(this, TEXT("FSGMessageReliability"), 64 * 1024, TPri_AboveNormal);
+}
+
+
+void FSGMessageReliability::StopReliability()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	FWriteScopeLock Lock(ChannelsLock);
+	Channels.Reset();
+}
+
+
+void FSGMessageReliability::AddNode(const FGuid& NodeId)
+{
+	FindOrAddChannel(NodeId);
+}
+
+
+void FSGMessageReliability::RemoveNode(const FGuid& NodeId)
+{
+	FChannelPtr Channel;
+	{
+		FWriteScopeLock Lock(ChannelsLock);
+		Channels.RemoveAndCopyValue(NodeId, Channel);
+	}
+
+	if (Channel.IsValid())
+	{
+		FScopeLock Lock(&Channel->CriticalSection);
+		NumFailed += Channel->InFlight.Num() + Channel->Backlog.Num();
+	}
+}
+
+
+bool FSGMessageReliability::Send(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                 TArrayView<const FGuid> Nodes)
+{
+	TArray<FChannelPtr, TInlineAllocator<4>> Targets;
+
+	if (Nodes.Num() == 0)
+	{
+		FReadScopeLock Lock(ChannelsLock);
+
+		for (const auto& ChannelPair : Channels)
+		{
+			Targets.Add(ChannelPair.Value);
+		}
+	}
+	else
+	{
+		for (const auto& NodeId : Nodes)
+		{
+			Targets.Add(FindOrAddChannel(NodeId));
+		}
+	}
+
+	if (Targets.Num() == 0)
+	{
+		return false;
+	}
+
+	const auto Now = FPlatformTime::Seconds();
+
+	FOutboundArray Messages;
+
+	for (const auto& Channel : Targets)
+	{
+		FScopeLock Lock(&Channel->CriticalSection);
+
+		const auto Sequence = Channel->NextSequence++;
+
+		Channel->Backlog.Emplace(Sequence, MakeShared<SGMessageReliability::FSequencedMessageContext,
+		                                                ESPMode::ThreadSafe>(Context, Sequence));
+
+		FillWindow(*Channel, Now, Messages);
+	}
+
+	NumSent += Targets.Num();
+
+	TransportMessages(Messages);
+
+	return true;
+}
+
+
+void FSGMessageReliability::Receive(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                    const FGuid& NodeId, FReceivedArray& OutReceived)
+{
+	const auto& Annotations = Context->GetAnnotations();
+	const auto bAck = Context->GetMessageTag() == SGMessageReliability::AckTag;
+	const auto Sequence = SGMessageReliability::ParseSequence(Annotations.Find(SGMessageReliability::SequenceKey));
+
+	// unsequenced messages are passed through
+	if (!bAck && Sequence == 0)
+	{
+		OutReceived.Add(Context);
+
+		return;
+	}
+
+	const auto Channel = FindOrAddChannel(NodeId);
+	const auto Now = FPlatformTime::Seconds();
+
+	FOutboundArray Messages;
+	{
+		FScopeLock Lock(&Channel->CriticalSection);
+
+		if (bAck)
+		{
+			HandleAck(*Channel, *Context, Now, Messages);
+		}
+		else
+		{
+			const auto Base = SGMessageReliability::ParseSequence(Annotations.Find(SGMessageReliability::BaseKey));
+
+			HandleSequenced(*Channel, Context, Sequence, Base, Now, Messages, OutReceived);
+		}
+	}
+
+	TransportMessages(Messages);
+}
+
+
+FSGMessageReliabilityStats FSGMessageReliability::GetStats() const
+{
+	FSGMessageReliabilityStats Stats;
+
+	Stats.NumSent = NumSent;
+	Stats.NumRetransmitted = NumRetransmitted;
+	Stats.NumFastRetransmitted = NumFastRetransmitted;
+	Stats.NumAcknowledged = NumAcknowledged;
+	Stats.NumFailed = NumFailed;
+	Stats.NumOutOfOrder = NumOutOfOrder;
+	Stats.NumDuplicates = NumDuplicates;
+	Stats.NumHeldBack = NumHeldBack;
+	Stats.NumAcksSent = NumAcksSent;
+	Stats.SmoothedRtt = SmoothedRttMicroseconds / 1000000.0;
+	Stats.MinRtt = MinRttMicroseconds / 1000000.0;
+
+	return Stats;
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+bool FSGMessageReliability::Init()
+{
+	return true;
+}
+
+
+uint32 FSGMessageReliability::Run()
+{
+	while (!Stopping)
+	{
+		WorkEvent->Wait(SGMessageReliability::TimerIntervalMs);
+
+		ProcessTimers();
+	}
+
+	return 0;
+}
+
+
+void FSGMessageReliability::Stop()
+{
+	Stopping = true;
+
+	WorkEvent->Trigger();
+}
+
+
+/* FSGMessageReliability implementation
+ *****************************************************************************/
+
+FSGMessageReliability::FChannelPtr FSGMessageReliability::FindOrAddChannel(const FGuid& NodeId)
+{
+	{
+		FReadScopeLock Lock(ChannelsLock);
+
+		if (const auto Channel = Channels.Find(NodeId))
+		{
+			return *Channel;
+		}
+	}
+
+	FWriteScopeLock Lock(ChannelsLock);
+
+	auto& Channel = Channels.FindOrAdd(NodeId);
+
+	if (!Channel.IsValid())
+	{
+		Channel = MakeShared<FChannel, ESPMode::ThreadSafe>();
+		Channel->NodeId = NodeId;
+		Channel->RetransmitTimeout = SGMessageReliability::InitialRetransmitTimeout;
+	}
+
+	return Channel;
+}
+
+
+TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> FSGMessageReliability::CreateAck(FChannel& Channel)
+{
+	TArray<uint64, TInlineAllocator<SGMessageReliability::MaxSelectiveAcks>> Selective;
+
+	for (const auto Sequence : Channel.ReceivedBeyondGap)
+	{
+		Selective.Add(Sequence);
+	}
+
+	Selective.Sort();
+
+	FString SelectiveString;
+
+	for (auto Index = 0; Index < FMath::Min(Selective.Num(), SGMessageReliability::MaxSelectiveAcks); ++Index)
+	{
+		if (Index > 0)
+		{
+			SelectiveString.AppendChar(TEXT(','));
+		}
+
+		SelectiveString.Append(LexToString(Selective[Index]));
+	}
+
+	TMap<FName, FString> Annotations;
+
+	Annotations.Add(SGMessageReliability::CumulativeKey, LexToString(Channel.ReceivedCumulative));
+
+	if (!SelectiveString.IsEmpty())
+	{
+		Annotations.Add(SGMessageReliability::SelectiveKey, MoveTemp(SelectiveString));
+	}
+
+	Channel.NumUnacknowledged = 0;
+	Channel.AckDueTime = 0.0;
+
+	++NumAcksSent;
+
+	return MakeShared<FSGMessageContext, ESPMode::ThreadSafe>(
+		SGMessageReliability::AckTag,
+		FSGMessageBuilder::Builder<FSGMessage>(),
+		Annotations,
+		nullptr,
+		Address,
+		TArray<FSGMessageAddress>(),
+		ESGMessageScope::Network,
+		ESGMessageFlags::None,
+		FDateTime::UtcNow(),
+		FDateTime::MaxValue(),
+		ENamedThreads::AnyThread
+	);
+}
+
+
+void FSGMessageReliability::HandleAck(FChannel& Channel, const ISGMessageContext& Ack, const double Now,
+                                      FOutboundArray& OutMessages)
+{
+	const auto& Annotations = Ack.GetAnnotations();
+	const auto Cumulative = SGMessageReliability::ParseSequence(Annotations.Find(SGMessageReliability::CumulativeKey));
+
+	TArray<uint64, TInlineAllocator<SGMessageReliability::MaxSelectiveAcks>> Selective;
+
+	if (const auto SelectiveString = Annotations.Find(SGMessageReliability::SelectiveKey))
+	{
+		TArray<FString> Parts;
+		SelectiveString->ParseIntoArray(Parts, TEXT(","));
+
+		for (const auto& Part : Parts)
+		{
+			Selective.Add(SGMessageReliability::ParseSequence(&Part));
+		}
+	}
+
+	const auto HighestReported = Selective.Num() > 0 ? FMath::Max(Cumulative, Selective.Last()) : Cumulative;
+
+	for (auto It = Channel.InFlight.CreateIterator(); It; ++It)
+	{
+		const auto Sequence = It.Key();
+		auto& Pending = It.Value();
+
+		if (Sequence <= Cumulative || Selective.Contains(Sequence))
+		{
+			// only messages that were not retransmitted give unambiguous round-trip times
+			if (Pending.NumRetransmits == 0)
+			{
+				UpdateRtt(Channel, Now - Pending.FirstSendTime);
+			}
+
+			++NumAcknowledged;
+			It.RemoveCurrent();
+		}
+		else if (Sequence < HighestReported && ++Pending.NumMissingReports == SGMessageReliability::FastRetransmitReports)
+		{
+			// later messages keep arriving, so this one was most likely lost
+			++Pending.NumRetransmits;
+			Pending.LastSendTime = Now;
+			++NumRetransmitted;
+			++NumFastRetransmitted;
+
+			OutMessages.Add(FOutboundMessage{Pending.Context, Channel.NodeId});
+		}
+	}
+
+	FillWindow(Channel, Now, OutMessages);
+}
+
+
+void FSGMessageReliability::HandleSequenced(FChannel& Channel,
+                                            const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                            const uint64 Sequence, const uint64 Base, const double Now,
+                                            FOutboundArray& OutMessages, FReceivedArray& OutReceived)
+{
+	// the sender gave up on everything below its base, so there is no point in waiting for it
+	if (Base > Channel.ReceivedCumulative + 1)
+	{
+		TArray<uint64, TInlineAllocator<8>> Released;
+
+		for (auto It = Channel.ReceivedBeyondGap.CreateIterator(); It; ++It)
+		{
+			if (*It < Base)
+			{
+				Released.Add(*It);
+				It.RemoveCurrent();
+			}
+		}
+
+		// held back messages before the base no longer wait for the messages that were given up
+		Released.Sort();
+
+		for (const auto ReleasedSequence : Released)
+		{
+			TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> HeldBack;
+
+			if (Channel.HeldBack.RemoveAndCopyValue(ReleasedSequence, HeldBack))
+			{
+				OutReceived.Add(HeldBack.ToSharedRef());
+			}
+		}
+
+		Channel.ReceivedCumulative = Base - 1;
+
+		AdvanceCumulative(Channel, OutReceived);
+	}
+
+	auto bDeliver = true;
+
+	if (Sequence <= Channel.ReceivedCumulative || Channel.ReceivedBeyondGap.Contains(Sequence))
+	{
+		// the sender did not get our acknowledgement
+		++NumDuplicates;
+		bDeliver = false;
+
+		Channel.AckDueTime = Now;
+	}
+	else if (Sequence == Channel.ReceivedCumulative + 1)
+	{
+		++Channel.ReceivedCumulative;
+		OutReceived.Add(Context);
+
+		AdvanceCumulative(Channel, OutReceived);
+	}
+	else
+	{
+		Channel.ReceivedBeyondGap.Add(Sequence);
+		++NumOutOfOrder;
+
+		if (EnumHasAnyFlags(Context->GetFlags(), ESGMessageFlags::Ordered))
+		{
+			Channel.HeldBack.Add(Sequence, Context);
+			++NumHeldBack;
+		}
+		else
+		{
+			OutReceived.Add(Context);
+		}
+
+		// report the gap right away
+		Channel.AckDueTime = Now;
+	}
+
+	if (bDeliver)
+	{
+		++Channel.NumUnacknowledged;
+
+		if (Channel.AckDueTime == 0.0)
+		{
+			Channel.AckDueTime = Now + SGMessageReliability::AckDelay;
+		}
+	}
+
+	if (Channel.NumUnacknowledged >= SGMessageReliability::AckEvery || (Channel.AckDueTime > 0.0 && Channel.AckDueTime <= Now))
+	{
+		OutMessages.Add(FOutboundMessage{CreateAck(Channel), Channel.NodeId});
+	}
+}
+
+
+void FSGMessageReliability::AdvanceCumulative(FChannel& Channel, FReceivedArray& OutReceived)
+{
+	while (Channel.ReceivedBeyondGap.Remove(Channel.ReceivedCumulative + 1) > 0)
+	{
+		++Channel.ReceivedCumulative;
+
+		TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> HeldBack;
+
+		if (Channel.HeldBack.RemoveAndCopyValue(Channel.ReceivedCumulative, HeldBack))
+		{
+			OutReceived.Add(HeldBack.ToSharedRef());
+		}
+	}
+}
+
+
+void FSGMessageReliability::FillWindow(FChannel& Channel, const double Now, FOutboundArray& OutMessages)
+{
+	const auto NumToSend = FMath::Min(Channel.Backlog.Num(), SGMessageReliability::WindowSize - Channel.InFlight.Num());
+
+	if (NumToSend <= 0)
+	{
+		return;
+	}
+
+	// every message tells the receiver which sequence numbers it may stop waiting for
+	const auto Base = GetBase(Channel);
+
+	for (auto Index = 0; Index < NumToSend; ++Index)
+	{
+		auto& Entry = Channel.Backlog[Index];
+
+		StaticCastSharedPtr<SGMessageReliability::FSequencedMessageContext>(Entry.Value)->SetBase(Base);
+
+		auto& Pending = Channel.InFlight.Add(Entry.Key);
+		Pending.Context = Entry.Value;
+		Pending.FirstSendTime = Now;
+		Pending.LastSendTime = Now;
+
+		OutMessages.Add(FOutboundMessage{Entry.Value, Channel.NodeId});
+	}
+
+	Channel.Backlog.RemoveAt(0, NumToSend, false);
+}
+
+
+uint64 FSGMessageReliability::GetBase(const FChannel& Channel)
+{
+	auto Base = Channel.Backlog.Num() > 0 ? Channel.Backlog[0].Key : Channel.NextSequence;
+
+	for (const auto& PendingPair : Channel.InFlight)
+	{
+		Base = FMath::Min(Base, PendingPair.Key);
+	}
+
+	return Base;
+}
+
+
+void FSGMessageReliability::UpdateRtt(FChannel& Channel, const double Sample)
+{
+	// RFC 6298
+	if (Channel.SmoothedRtt == 0.0)
+	{
+		Channel.SmoothedRtt = Sample;
+		Channel.RttVariance = Sample / 2.0;
+	}
+	else
+	{
+		Channel.RttVariance = 0.75 * Channel.RttVariance + 0.25 * FMath::Abs(Channel.SmoothedRtt - Sample);
+		Channel.SmoothedRtt = 0.875 * Channel.SmoothedRtt + 0.125 * Sample;
+	}
+
+	Channel.RetransmitTimeout = FMath::Clamp(Channel.SmoothedRtt + 4.0 * Channel.RttVariance,
+	                                         SGMessageReliability::MinRetransmitTimeout,
+	                                         SGMessageReliability::MaxRetransmitTimeout);
+
+	const auto SampleMicroseconds = static_cast<int64>(Sample * 1000000.0);
+	const auto MinRtt = MinRttMicroseconds.Load();
+
+	if (MinRtt == 0 || SampleMicroseconds < MinRtt)
+	{
+		MinRttMicroseconds = SampleMicroseconds;
+	}
+
+	SmoothedRttMicroseconds = static_cast<int64>(Channel.SmoothedRtt * 1000000.0);
+}
+
+
+void FSGMessageReliability::TransportMessages(const FOutboundArray& Messages)
+{
+	for (const auto& Message : Messages)
+	{
+		MessageTransport->TransportMessage(Message.Context.ToSharedRef(), MakeArrayView(&Message.NodeId, 1));
+	}
+}
+
+
+void FSGMessageReliability::ProcessTimers()
+{
+	TArray<FChannelPtr, TInlineAllocator<8>> CurrentChannels;
+	{
+		FReadScopeLock Lock(ChannelsLock);
+
+		for (const auto& ChannelPair : Channels)
+		{
+			CurrentChannels.Add(ChannelPair.Value);
+		}
+	}
+
+	const auto Now = FPlatformTime::Seconds();
+	const auto UtcNow = FDateTime::UtcNow();
+
+	FOutboundArray Messages;
+
+	for (const auto& Channel : CurrentChannels)
+	{
+		FScopeLock Lock(&Channel->CriticalSection);
+
+		auto bGaveUp = false;
+
+		for (auto It = Channel->InFlight.CreateIterator(); It; ++It)
+		{
+			auto& Pending = It.Value();
+
+			// back off exponentially while retransmissions go unanswered
+			const auto Timeout = Channel->RetransmitTimeout * (1 << FMath::Min(Pending.NumRetransmits, 6));
+
+			if (Now - Pending.LastSendTime < Timeout)
+			{
+				continue;
+			}
+
+			if (Pending.NumRetransmits >= SGMessageReliability::MaxRetransmits ||
+				Pending.Context->GetExpiration() < UtcNow)
+			{
+				UE_LOG(LogSGMessaging, Verbose, TEXT("FSGMessageReliability: Gave up on %s message %llu to %s"),
+				       *Pending.Context->GetMessageTag().ToString(), It.Key(), *Channel->NodeId.ToString());
+
+				++NumFailed;
+				It.RemoveCurrent();
+
+				bGaveUp = true;
+
+				continue;
+			}
+
+			++Pending.NumRetransmits;
+			Pending.LastSendTime = Now;
+			++NumRetransmitted;
+
+			Messages.Add(FOutboundMessage{Pending.Context, Channel->NodeId});
+		}
+
+		if (bGaveUp)
+		{
+			FillWindow(*Channel, Now, Messages);
+		}
+
+		if (Channel->AckDueTime > 0.0 && Channel->AckDueTime <= Now)
+		{
+			Messages.Add(FOutboundMessage{CreateAck(*Channel), Channel->NodeId});
+		}
+	}
+
+	TransportMessages(Messages);
+}
@@ -36,6 +36,16 @@ FSGMessageBus::~FSGMessageBus()
 /* ISGMessageBus interface
  *****************************************************************************/
 
+void FSGMessageBus::Conflate(const FName& MessageTag, const FSGMessageConflation& Conflation)
+{
+	if (MessageTag != NAME_None)
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("Conflating %s"), *MessageTag.ToString());
+		Router->SetConflation(MessageTag, Conflation);
+	}
+}
+
+
 void FSGMessageBus::Forward(
 	const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
 	const TArray<FSGMessageAddress>& Recipients,
@@ -63,6 +73,15 @@ void FSGMessageBus::Forward(
 }
 
 
+void FSGMessageBus::Inject(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+{
+	UE_LOG(LogSGMessaging, Verbose, TEXT("Injecting %s from %s"), *Context->GetMessageTag().ToString(),
+	       *Context->GetSender().ToString());
+
+	Router->RouteMessage(Context);
+}
+
+
 TSharedRef<ISGMessageTracer, ESPMode::ThreadSafe> FSGMessageBus::GetTracer()
 {
 	return Router->GetTracer();
@@ -115,6 +134,47 @@ void FSGMessageBus::Publish(
 	));
 }
 
+void FSGMessageBus::PublishBatch(
+	const TArray<FSGMessageBatchEntry>& Messages,
+	ESGMessageScope Scope,
+	const TMap<FName, FString>& Annotations,
+	const FTimespan& Delay,
+	const FDateTime& Expiration,
+	const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Publisher)
+{
+	if (Messages.Num() == 0)
+	{
+		return;
+	}
+
+	const FSGMessageAddress SenderAddress = Publisher->GetSenderAddress();
+	const FDateTime TimeSent = FDateTime::UtcNow() + Delay;
+	const ENamedThreads::Type SenderThread = FTaskGraphInterface::Get().GetCurrentThreadIfKnown();
+
+	TArray<TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>> Contexts;
+	Contexts.Reserve(Messages.Num());
+
+	for (const FSGMessageBatchEntry& Entry : Messages)
+	{
+		Contexts.Add(MakeShared<FSGMessageContext, ESPMode::ThreadSafe>(
+			Entry.MessageTag,
+			Entry.Message,
+			Annotations,
+			nullptr,
+			SenderAddress,
+			TArray<FSGMessageAddress>(),
+			Scope,
+			ESGMessageFlags::None,
+			TimeSent,
+			Expiration,
+			SenderThread
+		));
+	}
+
+	Router->RouteMessages(MoveTemp(Contexts));
+}
+
+
 void FSGMessageBus::Register(const FSGMessageAddress& Address,
                              const TSharedRef<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient)
 {
@@ -123,6 +183,22 @@ void FSGMessageBus::Register(const FSGMessageAddress& Address,
 }
 
 
+void FSGMessageBus::Retain(const FName& MessageTag, const int32 HistorySize)
+{
+	if ((MessageTag != NAME_None) && (MessageTag != NAME_All) && (HistorySize > 0))
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("Retaining %d %s messages"), HistorySize, *MessageTag.ToString());
+
+		{
+			FWriteScopeLock Lock(RetainedTagsLock);
+			RetainedTags.Add(MessageTag);
+		}
+
+		Router->SetRetention(MessageTag, HistorySize);
+	}
+}
+
+
 void FSGMessageBus::Send(
 	const FName& MessageTag,
 	void* Message,
@@ -150,6 +226,71 @@ void FSGMessageBus::Send(
 }
 
 
+void FSGMessageBus::SendBatch(
+	const TArray<FSGMessageBatchEntry>& Messages,
+	const TArray<FSGMessageAddress>& Recipients,
+	ESGMessageFlags Flags,
+	const TMap<FName, FString>& Annotations,
+	const FTimespan& Delay,
+	const FDateTime& Expiration,
+	const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Sender)
+{
+	if (Messages.Num() == 0)
+	{
+		return;
+	}
+
+	const FSGMessageAddress SenderAddress = Sender->GetSenderAddress();
+	const FDateTime TimeSent = FDateTime::UtcNow() + Delay;
+	const ENamedThreads::Type SenderThread = FTaskGraphInterface::Get().GetCurrentThreadIfKnown();
+
+	TArray<TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>> Contexts;
+	Contexts.Reserve(Messages.Num());
+
+	for (const FSGMessageBatchEntry& Entry : Messages)
+	{
+		Contexts.Add(MakeShared<FSGMessageContext, ESPMode::ThreadSafe>(
+			Entry.MessageTag,
+			Entry.Message,
+			Annotations,
+			nullptr,
+			SenderAddress,
+			Recipients,
+			ESGMessageScope::Network,
+			Flags,
+			TimeSent,
+			Expiration,
+			SenderThread
+		));
+	}
+
+	Router->RouteMessages(MoveTemp(Contexts));
+}
+
+
+bool FSGMessageBus::StartRecording(const FString& Filename)
+{
+	const TSharedRef<FSGMessageRecorder, ESPMode::ThreadSafe> Recorder =
+		MakeShared<FSGMessageRecorder, ESPMode::ThreadSafe>(Filename);
+
+	if (!Recorder->IsValid())
+	{
+		return false;
+	}
+
+	UE_LOG(LogSGMessaging, Display, TEXT("Recording the messages of %s to %s"), *Name, *Filename);
+	Router->SetRecorder(Recorder);
+
+	return true;
+}
+
+
+void FSGMessageBus::StopRecording()
+{
+	Router->SetRecorder(nullptr);
+}
+
+
 void FSGMessageBus::Shutdown()
 {
 	if (RouterThread != nullptr)
@@ -186,6 +327,32 @@ TSharedPtr<ISGMessageSubscription, ESPMode::ThreadSafe> FSGMessageBus::Subscribe
 }
 
 
+void FSGMessageBus::Unconflate(const FName& MessageTag)
+{
+	if (MessageTag != NAME_None)
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("Unconflating %s"), *MessageTag.ToString());
+		Router->ClearConflation(MessageTag);
+	}
+}
+
+
+void FSGMessageBus::Unretain(const FName& MessageTag)
+{
+	if (MessageTag != NAME_None)
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("Unretaining %s"), *MessageTag.ToString());
+
+		{
+			FWriteScopeLock Lock(RetainedTagsLock);
+			RetainedTags.Remove(MessageTag);
+		}
+
+		Router->ClearRetention(MessageTag);
+	}
+}
+
+
 void FSGMessageBus::Unintercept(const TSharedRef<ISGMessageInterceptor, ESPMode::ThreadSafe>& Interceptor,
                                 const FName& MessageTag)
 {
@@ -235,3 +402,22 @@ const FString& FSGMessageBus::GetName() const
 {
 	return Name;
 }
+
+FSGMessageBusStats FSGMessageBus::GetStats() const
+{
+	return Router->GetStats();
+}
+
+
+bool FSGMessageBus::IsRetained(const FName& MessageTag) const
+{
+	FReadScopeLock Lock(RetainedTagsLock);
+
+	return RetainedTags.Contains(MessageTag);
+}
+
+
+TFuture<FSGMessageBusSnapshot> FSGMessageBus::TakeSnapshot()
+{
+	return Router->TakeSnapshot();
+}
@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Core/Bus/SGMessageContext.h"
+#include "Core/Interface/ISGMessage.h"
 
 
 /* FSGMessageContext structors
@@ -10,6 +11,8 @@ FSGMessageContext::~FSGMessageContext()
 {
 	if (Message != nullptr)
 	{
+		static_cast<ISGMessage*>(Message)->~ISGMessage();
+
 		FMemory::Free(Message);
 	}
 }
@@ -2,6 +2,50 @@
 
 #include "Core/Bus/SGMessageDispatchTask.h"
 #include "Core/Interface/ISGMessageReceiver.h"
+#include "Core/Bus/SGMessagingTrace.h"
+
+
+namespace SGMessageDispatchTask
+{
+	/** Delivers a message to a recipient on the current thread, and records how long it took. */
+	void Deliver(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	             const TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& RecipientPtr,
+	             const TSharedPtr<FSGMessageTracer, ESPMode::ThreadSafe>& Tracer,
+	             const ENamedThreads::Type Thread, const uint64 RouteCycles)
+	{
+		const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe> Recipient = RecipientPtr.Pin();
+
+		if (!Recipient.IsValid())
+		{
+			return;
+		}
+
+#if SG_MESSAGING_WITH_TRACER
+		if (Tracer.IsValid())
+		{
+			Tracer->TraceDispatchedMessage(Context, Recipient.ToSharedRef(), true);
+		}
+#endif
+
+		const uint64 DispatchCycles = FPlatformTime::Cycles64();
+		{
+			TRACE_SGMESSAGING_HANDLE_SCOPE(*Context, *Recipient);
+			Recipient->ReceiveMessage(Context);
+		}
+
+		if (Tracer.IsValid())
+		{
+			Tracer->GetLatencyStats()->RecordHandled(
+				Context->GetMessageTag(), Thread,
+				FSGMessageLatencyStats::CyclesToMicroseconds(DispatchCycles - RouteCycles),
+				FSGMessageLatencyStats::CyclesToMicroseconds(FPlatformTime::Cycles64() - DispatchCycles));
+
+#if SG_MESSAGING_WITH_TRACER
+			Tracer->TraceHandledMessage(Context, Recipient.ToSharedRef());
+#endif
+		}
+	}
+}
 
 
 /* FSGMessageDispatchTask structors
@@ -11,10 +55,12 @@ FSGMessageDispatchTask::FSGMessageDispatchTask(
 	const ENamedThreads::Type InThread,
 	const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> InContext,
 	const TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe> InRecipient,
-	const TSharedPtr<FSGMessageTracer, ESPMode::ThreadSafe> InTracer
+	const TSharedPtr<FSGMessageTracer, ESPMode::ThreadSafe> InTracer,
+	const uint64 InRouteCycles
 )
 	: Context(InContext)
 	  , RecipientPtr(InRecipient)
+	  , RouteCycles(InRouteCycles)
 	  , Thread(InThread)
 	  , TracerPtr(InTracer)
 {
@@ -27,31 +73,84 @@ FSGMessageDispatchTask::FSGMessageDispatchTask(
 void FSGMessageDispatchTask::DoTask(ENamedThreads::Type CurrentThread,
                                     const FGraphEventRef& MyCompletionGraphEvent) const
 {
-	const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe> Recipient = RecipientPtr.Pin();
+	SGMessageDispatchTask::Deliver(Context, RecipientPtr, TracerPtr.Pin(), Thread, RouteCycles);
+}
 
-	if (!Recipient.IsValid())
-	{
-		return;
-	}
+TStatId FSGMessageDispatchTask::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FSGMessageDispatchTask, STATGROUP_TaskGraphTasks);
+}
+
+/* FSGMessageBatchDispatchTask structors
+ *****************************************************************************/
+
+FSGMessageBatchDispatchTask::FSGMessageBatchDispatchTask(
+	const ENamedThreads::Type InThread,
+	TArray<FSGMessageDelivery>&& InDeliveries,
+	const TSharedPtr<FSGMessageTracer, ESPMode::ThreadSafe> InTracer,
+	const uint64 InRouteCycles
+)
+	: Deliveries(MoveTemp(InDeliveries))
+	  , RouteCycles(InRouteCycles)
+	  , Thread(InThread)
+	  , TracerPtr(InTracer)
+{
+}
 
+
+/* FSGMessageBatchDispatchTask interface
+ *****************************************************************************/
+
+void FSGMessageBatchDispatchTask::DoTask(ENamedThreads::Type CurrentThread,
+                                         const FGraphEventRef& MyCompletionGraphEvent) const
+{
 	const auto Tracer = TracerPtr.Pin();
 
-	if (Tracer.IsValid())
+	for (const FSGMessageDelivery& Delivery : Deliveries)
 	{
-		Tracer->TraceDispatchedMessage(Context, Recipient.ToSharedRef(), true);
+		SGMessageDispatchTask::Deliver(Delivery.Context, Delivery.RecipientPtr, Tracer, Thread, RouteCycles);
 	}
+}
+
+TStatId FSGMessageBatchDispatchTask::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FSGMessageBatchDispatchTask, STATGROUP_TaskGraphTasks);
+}
+
+/* FSGMessageConflatedDispatchTask structors
+ *****************************************************************************/
+
+FSGMessageConflatedDispatchTask::FSGMessageConflatedDispatchTask(
+	const ENamedThreads::Type InThread,
+	const TSharedRef<FSGMessageConflationSlot, ESPMode::ThreadSafe> InSlot,
+	const TSharedPtr<FSGMessageTracer, ESPMode::ThreadSafe> InTracer
+)
+	: Slot(InSlot)
+	  , Thread(InThread)
+	  , TracerPtr(InTracer)
+{
+}
 
-	Recipient->ReceiveMessage(Context);
 
-	if (TracerPtr.IsValid())
+/* FSGMessageConflatedDispatchTask interface
+ *****************************************************************************/
+
+void FSGMessageConflatedDispatchTask::DoTask(ENamedThreads::Type CurrentThread,
+                                             const FGraphEventRef& MyCompletionGraphEvent) const
+{
+	uint64 RouteCycles = 0;
+	const TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Context = Slot->Take(RouteCycles);
+
+	if (Context.IsValid())
 	{
-		Tracer->TraceHandledMessage(Context, Recipient.ToSharedRef());
+		SGMessageDispatchTask::Deliver(Context.ToSharedRef(), Slot->GetRecipient(), TracerPtr.Pin(), Thread,
+		                               RouteCycles);
 	}
 }
 
-TStatId FSGMessageDispatchTask::GetStatId() const
+TStatId FSGMessageConflatedDispatchTask::GetStatId() const
 {
-	RETURN_QUICK_DECLARE_CYCLE_STAT(FSGMessageDispatchTask, STATGROUP_TaskGraphTasks);
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FSGMessageConflatedDispatchTask, STATGROUP_TaskGraphTasks);
 }
 
 /* FSGBusNotificationDispatchTask interface
@@ -0,0 +1,127 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Bus/SGMessageLatencyHistogram.h"
+
+
+/* FSGMessageLatencyHistogram structors
+ *****************************************************************************/
+
+FSGMessageLatencyHistogram::FSGMessageLatencyHistogram()
+{
+	Reset();
+}
+
+
+/* FSGMessageLatencyHistogram interface
+ *****************************************************************************/
+
+void FSGMessageLatencyHistogram::Record(const uint64 Microseconds)
+{
+	Counts[GetBucket(Microseconds)].IncrementExchange();
+	TotalCount.IncrementExchange();
+	TotalSum.AddExchange(Microseconds);
+
+	uint64 Max = MaxValue.Load(EMemoryOrder::Relaxed);
+
+	while ((Microseconds > Max) && !MaxValue.CompareExchange(Max, Microseconds))
+	{
+	}
+}
+
+
+void FSGMessageLatencyHistogram::Reset()
+{
+	for (auto& Count : Counts)
+	{
+		Count = 0;
+	}
+
+	TotalCount = 0;
+	TotalSum = 0;
+	MaxValue = 0;
+}
+
+
+FSGMessageTracerLatencySummary FSGMessageLatencyHistogram::GetSummary() const
+{
+	FSGMessageTracerLatencySummary Summary;
+
+	// take a snapshot, so that the percentiles agree with the count
+	uint64 Snapshot[NumBuckets];
+	uint64 Count = 0;
+
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		Snapshot[Bucket] = Counts[Bucket].Load(EMemoryOrder::Relaxed);
+		Count += Snapshot[Bucket];
+	}
+
+	if (Count == 0)
+	{
+		return Summary;
+	}
+
+	const uint64 Max = MaxValue.Load(EMemoryOrder::Relaxed);
+
+	Summary.Count = Count;
+	Summary.Max = Max;
+	Summary.Mean = static_cast<double>(TotalSum.Load(EMemoryOrder::Relaxed)) /
+		static_cast<double>(FMath::Max(TotalCount.Load(EMemoryOrder::Relaxed), uint64(1)));
+
+	const auto GetPercentile = [&Snapshot, Count, Max](const double Percentile)
+	{
+		const uint64 Rank = FMath::Max(static_cast<uint64>(FMath::CeilToDouble(Percentile * Count)), uint64(1));
+		uint64 Cumulative = 0;
+
+		for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+		{
+			Cumulative += Snapshot[Bucket];
+
+			if (Cumulative >= Rank)
+			{
+				return FMath::Min(GetBucketValue(Bucket), Max);
+			}
+		}
+
+		return Max;
+	};
+
+	Summary.P50 = GetPercentile(0.5);
+	Summary.P99 = GetPercentile(0.99);
+	Summary.P999 = GetPercentile(0.999);
+
+	return Summary;
+}
+
+
+/* FSGMessageLatencyHistogram implementation
+ *****************************************************************************/
+
+int32 FSGMessageLatencyHistogram::GetBucket(const uint64 Value)
+{
+	// values below the first power of two that is split into buckets are counted exactly
+	if (Value < SubBucketCount)
+	{
+		return static_cast<int32>(Value);
+	}
+
+	const int32 HighestBit = FMath::Min(static_cast<int32>(FMath::FloorLog2_64(Value)), ValueBits - 1);
+	const int32 Shift = HighestBit - SubBucketBits;
+	const uint64 SubBucket = FMath::Min(Value >> Shift, (uint64(SubBucketCount) << 1) - 1) & (SubBucketCount - 1);
+
+	return (Shift + 1) * SubBucketCount + static_cast<int32>(SubBucket);
+}
+
+
+uint64 FSGMessageLatencyHistogram::GetBucketValue(const int32 Bucket)
+{
+	if (Bucket < SubBucketCount)
+	{
+		return static_cast<uint64>(Bucket);
+	}
+
+	const int32 Shift = Bucket / SubBucketCount - 1;
+	const uint64 SubBucket = Bucket % SubBucketCount;
+
+	return ((SubBucketCount + SubBucket + 1) << Shift) - 1;
+}
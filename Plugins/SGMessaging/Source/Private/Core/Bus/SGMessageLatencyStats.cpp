@@ -0,0 +1,142 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Bus/SGMessageLatencyStats.h"
+
+
+/* FSGMessageLatencyStats interface
+ *****************************************************************************/
+
+void FSGMessageLatencyStats::RecordRouted(const FName& MessageTag, const uint64 SendToRoute)
+{
+	FindOrAddTagHistogram(MessageTag).Record(SendToRoute);
+}
+
+
+void FSGMessageLatencyStats::RecordHandled(const FName& MessageTag, const ENamedThreads::Type RecipientThread,
+                                           const uint64 RouteToDispatch, const uint64 DispatchToHandled)
+{
+	FThreadHistograms& Histograms = FindOrAddThreadHistograms(FThreadKey(MessageTag, RecipientThread));
+
+	Histograms.RouteToDispatch.Record(RouteToDispatch);
+	Histograms.DispatchToHandled.Record(DispatchToHandled);
+
+	++NumHandled;
+	TotalRouteToDispatch += RouteToDispatch;
+}
+
+
+int32 FSGMessageLatencyStats::GetLatencies(TArray<FSGMessageTracerLatencyInfo>& OutLatencies) const
+{
+	OutLatencies.Reset();
+
+	TMap<FName, int32> Indices;
+	{
+		FReadScopeLock Lock(HistogramsLock);
+
+		for (const auto& HistogramPair : TagHistograms)
+		{
+			Indices.Add(HistogramPair.Key, OutLatencies.Num());
+
+			FSGMessageTracerLatencyInfo& LatencyInfo = OutLatencies.AddDefaulted_GetRef();
+			{
+				LatencyInfo.MessageTag = HistogramPair.Key;
+				LatencyInfo.SendToRoute = HistogramPair.Value->GetSummary();
+			}
+		}
+
+		for (const auto& HistogramsPair : ThreadHistograms)
+		{
+			const FName& MessageTag = HistogramsPair.Key.Key;
+			int32* Index = Indices.Find(MessageTag);
+
+			// messages that were dispatched before their routing was recorded
+			if (Index == nullptr)
+			{
+				Index = &Indices.Add(MessageTag, OutLatencies.Num());
+				OutLatencies.AddDefaulted_GetRef().MessageTag = MessageTag;
+			}
+
+			FSGMessageTracerThreadLatencyInfo& ThreadInfo = OutLatencies[*Index].Threads.AddDefaulted_GetRef();
+			{
+				ThreadInfo.RecipientThread = HistogramsPair.Key.Value;
+				ThreadInfo.RouteToDispatch = HistogramsPair.Value->RouteToDispatch.GetSummary();
+				ThreadInfo.DispatchToHandled = HistogramsPair.Value->DispatchToHandled.GetSummary();
+			}
+		}
+	}
+
+	OutLatencies.Sort([](const FSGMessageTracerLatencyInfo& A, const FSGMessageTracerLatencyInfo& B)
+	{
+		return A.MessageTag.LexicalLess(B.MessageTag);
+	});
+
+	return OutLatencies.Num();
+}
+
+
+void FSGMessageLatencyStats::Reset()
+{
+	FReadScopeLock Lock(HistogramsLock);
+
+	for (const auto& HistogramPair : TagHistograms)
+	{
+		HistogramPair.Value->Reset();
+	}
+
+	for (const auto& HistogramsPair : ThreadHistograms)
+	{
+		HistogramsPair.Value->RouteToDispatch.Reset();
+		HistogramsPair.Value->DispatchToHandled.Reset();
+	}
+}
+
+
+/* FSGMessageLatencyStats implementation
+ *****************************************************************************/
+
+FSGMessageLatencyHistogram& FSGMessageLatencyStats::FindOrAddTagHistogram(const FName& MessageTag)
+{
+	{
+		FReadScopeLock Lock(HistogramsLock);
+
+		if (const auto Histogram = TagHistograms.Find(MessageTag))
+		{
+			return **Histogram;
+		}
+	}
+
+	FWriteScopeLock Lock(HistogramsLock);
+
+	auto& Histogram = TagHistograms.FindOrAdd(MessageTag);
+
+	if (!Histogram.IsValid())
+	{
+		Histogram = MakeUnique<FSGMessageLatencyHistogram>();
+	}
+
+	return *Histogram;
+}
+
+
+FSGMessageLatencyStats::FThreadHistograms& FSGMessageLatencyStats::FindOrAddThreadHistograms(const FThreadKey& Key)
+{
+	{
+		FReadScopeLock Lock(HistogramsLock);
+
+		if (const auto Histograms = ThreadHistograms.Find(Key))
+		{
+			return **Histograms;
+		}
+	}
+
+	FWriteScopeLock Lock(HistogramsLock);
+
+	auto& Histograms = ThreadHistograms.FindOrAdd(Key);
+
+	if (!Histograms.IsValid())
+	{
+		Histograms = MakeUnique<FThreadHistograms>();
+	}
+
+	return *Histograms;
+}
@@ -0,0 +1,354 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Bus/SGMessageRecording.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Compression.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Serialization/SGMessageWireFormat.h"
+
+namespace SGMessageRecording
+{
+	/** The magic bytes at the start of a recording. */
+	constexpr uint8 Magic[] = {'S', 'G', 'R', 'C'};
+}
+
+
+/* FSGMessageRecorder structors
+ *****************************************************************************/
+
+FSGMessageRecorder::FSGMessageRecorder(const FString& InFilename)
+	: WorkEvent(nullptr)
+	  , Stopping(false)
+	  , Thread(nullptr)
+	  , Filename(InFilename)
+	  , NumRecorded(0)
+	  , NumSkipped(0)
+{
+	Archive.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+
+	if (!Archive.IsValid())
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("Failed to create the message recording %s"), *Filename);
+
+		return;
+	}
+
+	uint8 Magic[UE_ARRAY_COUNT(SGMessageRecording::Magic)];
+	FMemory::Memcpy(Magic, SGMessageRecording::Magic, sizeof(Magic));
+
+	uint8 Version = FSGMessageRecordingFormat::Version;
+	int64 StartTicks = FDateTime::UtcNow().GetTicks();
+	FGuid NodeId = FSGMessageAddress::NewNodeId();
+
+	Archive->Serialize(Magic, sizeof(Magic));
+	*Archive << Version;
+	*Archive << StartTicks;
+	*Archive << NodeId;
+
+	Chunk.Reserve(FSGMessageRecordingFormat::ChunkSize * 2);
+	SubmittedChunk.Reserve(FSGMessageRecordingFormat::ChunkSize * 2);
+
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("FSGMessageRecorder"), 128 * 1024, TPri_BelowNormal);
+}
+
+
+FSGMessageRecorder::~FSGMessageRecorder()
+{
+	if (Thread != nullptr)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (WorkEvent != nullptr)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+		WorkEvent = nullptr;
+	}
+
+	if (!Archive.IsValid())
+	{
+		return;
+	}
+
+	// the writer thread is gone, so the remaining chunks are written here
+	Write(SubmittedChunk);
+	Write(Chunk);
+
+	const bool bError = !Archive->Close();
+
+	if (bError)
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("Failed to write the message recording %s"), *Filename);
+	}
+	else
+	{
+		UE_LOG(LogSGMessaging, Display, TEXT("Recorded %lld messages to %s (%lld skipped)"), GetNumRecorded(),
+		       *Filename, GetNumSkipped());
+	}
+}
+
+
+/* FSGMessageRecorder interface
+ *****************************************************************************/
+
+void FSGMessageRecorder::Record(const ISGMessageContext& Context, const FDateTime& RouteTime)
+{
+	if (!Archive.IsValid())
+	{
+		return;
+	}
+
+	const int32 Start = Chunk.Num();
+	const int64 RouteTicks = RouteTime.GetTicks();
+
+	Chunk.Append(reinterpret_cast<const uint8*>(&RouteTicks), FSGMessageRecordingFormat::RecordHeaderSize);
+
+	if (!FSGMessageWireFormat::Encode(Context, Chunk))
+	{
+		Chunk.SetNum(Start, false);
+		++NumSkipped;
+
+		return;
+	}
+
+	++NumRecorded;
+
+	if (Chunk.Num() >= FSGMessageRecordingFormat::ChunkSize)
+	{
+		Submit();
+	}
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+uint32 FSGMessageRecorder::Run()
+{
+	while (!Stopping)
+	{
+		WorkEvent->Wait();
+
+		bool bSubmitted;
+		{
+			FScopeLock Lock(&SubmittedCS);
+			bSubmitted = (SubmittedChunk.Num() > 0);
+		}
+
+		// the router does not touch the submitted chunk until it is empty again
+		if (bSubmitted)
+		{
+			Write(SubmittedChunk);
+
+			FScopeLock Lock(&SubmittedCS);
+			SubmittedChunk.Reset();
+		}
+	}
+
+	return 0;
+}
+
+
+void FSGMessageRecorder::Stop()
+{
+	Stopping = true;
+	WorkEvent->Trigger();
+}
+
+
+/* FSGMessageRecorder implementation
+ *****************************************************************************/
+
+void FSGMessageRecorder::Submit()
+{
+	{
+		FScopeLock Lock(&SubmittedCS);
+
+		if (SubmittedChunk.Num() > 0)
+		{
+			return;
+		}
+
+		// swapping keeps the allocations of both buffers
+		Swap(Chunk, SubmittedChunk);
+	}
+
+	WorkEvent->Trigger();
+}
+
+
+void FSGMessageRecorder::Write(const TArray<uint8>& Records)
+{
+	if (Records.Num() == 0)
+	{
+		return;
+	}
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_LZ4, Records.Num());
+	CompressedChunk.SetNumUninitialized(CompressedSize, false);
+
+	// keep the chunk as it is if compression does not pay off
+	const bool bCompressed = FCompression::CompressMemory(NAME_LZ4, CompressedChunk.GetData(), CompressedSize,
+	                                                      Records.GetData(), Records.Num()) &&
+		(CompressedSize < Records.Num());
+
+	uint32 Size = Records.Num();
+	uint32 StoredSize = bCompressed ? CompressedSize : Size;
+
+	*Archive << Size;
+	*Archive << StoredSize;
+	Archive->Serialize(bCompressed ? CompressedChunk.GetData() : const_cast<uint8*>(Records.GetData()), StoredSize);
+}
+
+
+/* FSGMessageRecordingReader structors
+ *****************************************************************************/
+
+FSGMessageRecordingReader::FSGMessageRecordingReader(const FString& Filename)
+	: ChunkOffset(0)
+{
+	Archive.Reset(IFileManager::Get().CreateFileReader(*Filename));
+
+	if (!Archive.IsValid())
+	{
+		return;
+	}
+
+	uint8 Magic[UE_ARRAY_COUNT(SGMessageRecording::Magic)] = {};
+	uint8 Version = 0;
+	int64 StartTicks = 0;
+
+	if (Archive->TotalSize() >= FSGMessageRecordingFormat::HeaderSize)
+	{
+		Archive->Serialize(Magic, sizeof(Magic));
+		*Archive << Version;
+		*Archive << StartTicks;
+		*Archive << NodeId;
+	}
+
+	if (Archive->IsError() || (FMemory::Memcmp(Magic, SGMessageRecording::Magic, sizeof(Magic)) != 0) ||
+		(Version != FSGMessageRecordingFormat::Version))
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("%s is not a message recording of version %d"), *Filename,
+		       FSGMessageRecordingFormat::Version);
+
+		Archive.Reset();
+
+		return;
+	}
+
+	StartTime = FDateTime(StartTicks);
+}
+
+
+/* FSGMessageRecordingReader interface
+ *****************************************************************************/
+
+bool FSGMessageRecordingReader::Next(FDateTime& OutRouteTime, FSharedBuffer& OutMessage)
+{
+	if (!Archive.IsValid())
+	{
+		return false;
+	}
+
+	while (ChunkOffset >= static_cast<int32>(Chunk.GetSize()))
+	{
+		if (!ReadChunk())
+		{
+			Archive.Reset();
+
+			return false;
+		}
+	}
+
+	const uint8* Data = static_cast<const uint8*>(Chunk.GetData()) + ChunkOffset;
+	const int32 Remaining = static_cast<int32>(Chunk.GetSize()) - ChunkOffset;
+
+	// the size of a message is part of its wire header
+	int64 RouteTicks = 0;
+	uint32 MessageSize = 0;
+
+	if (Remaining >= FSGMessageRecordingFormat::RecordHeaderSize + FSGMessageWireFormat::HeaderSize)
+	{
+		FMemory::Memcpy(&RouteTicks, Data, sizeof(int64));
+		FMemory::Memcpy(&MessageSize, Data + FSGMessageRecordingFormat::RecordHeaderSize + 8, sizeof(uint32));
+	}
+
+	if ((MessageSize < static_cast<uint32>(FSGMessageWireFormat::HeaderSize)) ||
+		(MessageSize > static_cast<uint32>(Remaining - FSGMessageRecordingFormat::RecordHeaderSize)))
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("Message recording is damaged, stopping at offset %lld"),
+		       Archive->Tell());
+
+		Archive.Reset();
+
+		return false;
+	}
+
+	OutRouteTime = FDateTime(RouteTicks);
+	OutMessage = FSharedBuffer::MakeView(Data + FSGMessageRecordingFormat::RecordHeaderSize, MessageSize, Chunk);
+
+	ChunkOffset += FSGMessageRecordingFormat::RecordHeaderSize + MessageSize;
+
+	return true;
+}
+
+
+/* FSGMessageRecordingReader implementation
+ *****************************************************************************/
+
+bool FSGMessageRecordingReader::ReadChunk()
+{
+	if (Archive->AtEnd())
+	{
+		return false;
+	}
+
+	uint32 Size = 0;
+	uint32 StoredSize = 0;
+
+	*Archive << Size;
+	*Archive << StoredSize;
+
+	// recordings that were cut short end with a partial chunk
+	if (Archive->IsError() || (Size == 0) || (Size > static_cast<uint32>(MAX_int32)) || (StoredSize > Size) ||
+		(StoredSize > Archive->TotalSize() - Archive->Tell()))
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("Message recording ends with an incomplete chunk at offset %lld"),
+		       Archive->Tell());
+
+		return false;
+	}
+
+	FUniqueBuffer Buffer = FUniqueBuffer::Alloc(Size);
+
+	if (StoredSize == Size)
+	{
+		Archive->Serialize(Buffer.GetData(), Size);
+	}
+	else
+	{
+		TArray<uint8> Stored;
+		Stored.SetNumUninitialized(StoredSize);
+
+		Archive->Serialize(Stored.GetData(), StoredSize);
+
+		if (!FCompression::UncompressMemory(NAME_LZ4, Buffer.GetData(), Size, Stored.GetData(), StoredSize))
+		{
+			UE_LOG(LogSGMessaging, Warning, TEXT("Failed to decompress a chunk of the message recording"));
+
+			return false;
+		}
+	}
+
+	Chunk = Buffer.MoveToShared();
+	ChunkOffset = 0;
+
+	return !Archive->IsError();
+}
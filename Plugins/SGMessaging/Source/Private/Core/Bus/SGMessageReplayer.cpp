@@ -0,0 +1,172 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Bus/SGMessageReplayer.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Serialization/SGMessageWireFormat.h"
+
+namespace SGMessageReplayer
+{
+	/** The longest time to sleep at once while waiting for the next message, so that stopping stays responsive. */
+	constexpr double MaxSleepTime = 0.01;
+
+	/** Checks whether two GUIDs belong to the same node. */
+	bool IsSameNode(const FGuid& X, const FGuid& Y)
+	{
+		return (X.A == Y.A) && (X.B == Y.B) && (X.C == Y.C);
+	}
+}
+
+
+/* FSGMessageReplayer structors
+ *****************************************************************************/
+
+FSGMessageReplayer::FSGMessageReplayer(const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& InBus,
+                                       const FString& InFilename, const double InRate)
+	: Bus(InBus)
+	  , Filename(InFilename)
+	  , Rate(FMath::Max(0.0, InRate))
+	  , LocalNodeId(FSGMessageAddress::NewNodeId())
+	  , NumReplayed(0)
+	  , NumSkipped(0)
+	  , Done(false)
+	  , Stopping(false)
+	  , Thread(nullptr)
+{
+}
+
+
+FSGMessageReplayer::~FSGMessageReplayer()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+
+/* FSGMessageReplayer interface
+ *****************************************************************************/
+
+bool FSGMessageReplayer::Start()
+{
+	check(Thread == nullptr);
+
+	Reader = MakeUnique<FSGMessageRecordingReader>(Filename);
+
+	if (!Reader->IsValid())
+	{
+		Done = true;
+
+		return false;
+	}
+
+	Thread = FRunnableThread::Create(this, TEXT("FSGMessageReplayer"), 128 * 1024, TPri_Normal);
+
+	return Thread != nullptr;
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+uint32 FSGMessageReplayer::Run()
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	FDateTime FirstRouteTime;
+	FDateTime RouteTime;
+	FSharedBuffer Buffer;
+
+	while (!Stopping && Reader->Next(RouteTime, Buffer))
+	{
+		if (FirstRouteTime == FDateTime())
+		{
+			FirstRouteTime = RouteTime;
+		}
+
+		if (Rate > 0.0)
+		{
+			const double DueSeconds = StartSeconds + (RouteTime - FirstRouteTime).GetTotalSeconds() / Rate;
+
+			for (double WaitTime = DueSeconds - FPlatformTime::Seconds(); !Stopping && (WaitTime > 0.0);
+			     WaitTime = DueSeconds - FPlatformTime::Seconds())
+			{
+				FPlatformProcess::SleepNoStats(static_cast<float>(FMath::Min(WaitTime, SGMessageReplayer::MaxSleepTime)));
+			}
+		}
+
+		const TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> PinnedBus = Bus.Pin();
+
+		if (!PinnedBus.IsValid())
+		{
+			break;
+		}
+
+		// the message is sent again now, as if it was just routed
+		const auto Context = FSGMessageWireFormat::Decode(Buffer, FDateTime::UtcNow() - RouteTime,
+		                                                  [this](const FGuid& Guid) { return ResolveAddress(Guid); });
+
+		if (Context.IsValid())
+		{
+			PinnedBus->Inject(Context.ToSharedRef());
+			++NumReplayed;
+		}
+		else
+		{
+			++NumSkipped;
+		}
+	}
+
+	for (const FGuid& NodeId : AddedNodes)
+	{
+		FSGMessageAddress::RemoveNode(NodeId);
+	}
+
+	AddedNodes.Empty();
+
+	UE_LOG(LogSGMessaging, Display, TEXT("Replayed %lld messages from %s in %.2f s (%lld skipped)"), GetNumReplayed(),
+	       *Filename, FPlatformTime::Seconds() - StartSeconds, NumSkipped.Load(EMemoryOrder::Relaxed));
+
+	Done = true;
+
+	return 0;
+}
+
+
+void FSGMessageReplayer::Stop()
+{
+	Stopping = true;
+}
+
+
+/* FSGMessageReplayer implementation
+ *****************************************************************************/
+
+FSGMessageAddress FSGMessageReplayer::ResolveAddress(const FGuid& Guid)
+{
+	if (SGMessageReplayer::IsSameNode(Guid, Reader->GetNodeId()))
+	{
+		return FSGMessageAddress::FromGuid(FGuid(LocalNodeId.A, LocalNodeId.B, LocalNodeId.C, Guid.D));
+	}
+
+	// the invalid address and the addresses of known nodes, including the ones added before, resolve as they are
+	const FSGMessageAddress Address = FSGMessageAddress::FromGuid(Guid);
+
+	if (Address.IsValid() || SGMessageReplayer::IsSameNode(Guid, FGuid()))
+	{
+		return Address;
+	}
+
+	if (!FSGMessageAddress::AddNode(Guid))
+	{
+		return FSGMessageAddress();
+	}
+
+	AddedNodes.Add(Guid);
+
+	return FSGMessageAddress::FromGuid(Guid);
+}
@@ -8,14 +8,30 @@
 #include "Core/Interface/ISGMessageReceiver.h"
 #include "Core/Interface/ISGMessageInterceptor.h"
 #include "Core/Interface/ISGMessageBusListener.h"
+#include "Core/Message/SGMessage.h"
 #include "Core/Settings/SGMessagingSettings.h"
 
 
+namespace SGMessageRouter
+{
+	/** Defines the smallest number of conflation slots at which idle ones are pruned. */
+	constexpr int32 MinConflationPrune = 64;
+}
+
+
 /* FSGMessageRouter structors
  *****************************************************************************/
 
 FSGMessageRouter::FSGMessageRouter()
-	: DelayedMessagesSequence(0)
+	: NumConflationSlots(0)
+	  , NextConflationPrune(SGMessageRouter::MinConflationPrune)
+	  , DelayedMessagesSequence(0)
+	  , NumQueuedCommands(0)
+	  , NumDelayedMessages(0)
+	  , NumSentMessages(0)
+	  , NumRoutedMessages(0)
+	  , NumInterceptedMessages(0)
+	  , NumConflatedMessages(0)
 	  , Stopping(false)
 	  , Tracer(MakeShared<FSGMessageTracer, ESPMode::ThreadSafe>())
 	  , bAllowDelayedMessaging(false)
@@ -37,6 +53,32 @@ FSGMessageRouter::~FSGMessageRouter()
 }
 
 
+/* FSGMessageRouter interface
+ *****************************************************************************/
+
+FSGMessageBusStats FSGMessageRouter::GetStats() const
+{
+	FSGMessageBusStats Stats;
+	{
+		Stats.NumSent = NumSentMessages.Load(EMemoryOrder::Relaxed);
+		Stats.NumRouted = NumRoutedMessages.Load(EMemoryOrder::Relaxed);
+		Stats.NumIntercepted = NumInterceptedMessages.Load(EMemoryOrder::Relaxed);
+		Stats.NumConflated = NumConflatedMessages.Load(EMemoryOrder::Relaxed);
+		Stats.NumQueuedCommands = NumQueuedCommands.Load(EMemoryOrder::Relaxed);
+		Stats.NumDelayed = NumDelayedMessages.Load(EMemoryOrder::Relaxed);
+	}
+
+	uint64 NumHandled = 0;
+	uint64 TotalDispatchLatency = 0;
+	Tracer->GetLatencyStats()->GetTotals(NumHandled, TotalDispatchLatency);
+
+	Stats.NumHandled = static_cast<int64>(NumHandled);
+	Stats.TotalDispatchLatency = static_cast<int64>(TotalDispatchLatency);
+
+	return Stats;
+}
+
+
 /* FSGRunnable interface
  *****************************************************************************/
 
@@ -81,7 +123,15 @@ void FSGMessageRouter::Exit()
 	TArray<TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe>> Recipients;
 
 	// gather all subscribed and registered recipients
-	for (const auto& RecipientPair : ActiveRecipients)
+	for (const auto& LocalRecipient : LocalRecipients)
+	{
+		if (LocalRecipient.Address.IsValid())
+		{
+			Recipients.AddUnique(LocalRecipient.Recipient);
+		}
+	}
+
+	for (const auto& RecipientPair : RemoteRecipients)
 	{
 		Recipients.AddUnique(RecipientPair.Value);
 	}
@@ -117,66 +167,264 @@ FTimespan FSGMessageRouter::CalculateWaitTime()
 }
 
 
+void FSGMessageRouter::ResolveRecipients(
+	const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	TArray<TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>>& OutRecipients)
+{
+	const int32 RecipientCount = Context->GetRecipients().Num();
+
+	// get recipients, either from the context...
+	if (RecipientCount > 0)
+	{
+		if (UE_GET_LOG_VERBOSITY(LogSGMessaging) >= ELogVerbosity::Verbose)
+		{
+			const FString RecipientStr = FString::JoinBy(Context->GetRecipients(), TEXT("+"),
+			                                             &FSGMessageAddress::ToString);
+			UE_LOG(LogSGMessaging, Verbose, TEXT("Dispatching %s from %s to %s"),
+			       *Context->GetMessageTag().ToString(), *Context->GetSender().ToString(), *RecipientStr);
+		}
+
+		FilterRecipients(Context, OutRecipients);
+
+		if (OutRecipients.Num() < RecipientCount)
+		{
+			UE_LOG(LogSGMessaging, Verbose, TEXT("%d recipients were filtered out"),
+			       RecipientCount - OutRecipients.Num());
+		}
+	}
+	// ... or from subscriptions
+	else
+	{
+		FilterSubscriptions(ActiveSubscriptions.FindOrAdd(Context->GetMessageTag()), Context, OutRecipients);
+		FilterSubscriptions(ActiveSubscriptions.FindOrAdd(NAME_All), Context, OutRecipients);
+
+		if (UE_GET_LOG_VERBOSITY(LogSGMessaging) >= ELogVerbosity::Verbose)
+		{
+			const FString RecipientStr = FString::JoinBy(Context->GetRecipients(), TEXT("+"),
+			                                             &FSGMessageAddress::ToString);
+			UE_LOG(LogSGMessaging, Verbose, TEXT("Dispatching %s from %s to %s subscribers"),
+			       *Context->GetMessageTag().ToString(), *Context->GetSender().ToString(), *RecipientStr);
+		}
+	}
+}
+
+
 void FSGMessageRouter::DispatchMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
 {
+	SCOPE_CYCLE_COUNTER(STAT_SGMessaging_DispatchMessage);
+
 	if (Context->IsValid())
 	{
 		TArray<TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>> Recipients;
+		ResolveRecipients(Context, Recipients);
+
+		if (Context->GetRecipients().Num() == 0)
+		{
+			RetainMessage(Context);
+		}
 
-		const int32 RecipientCount = Context->GetRecipients().Num();
+		// dispatch the message
+		const FSGMessageConflation* Conflation = Conflations.Find(Context->GetMessageTag());
+		const uint64 RouteCycles = FPlatformTime::Cycles64();
 
-		// get recipients, either from the context...
-		if (RecipientCount > 0)
+		for (auto& Recipient : Recipients)
 		{
-			if (UE_GET_LOG_VERBOSITY(LogSGMessaging) >= ELogVerbosity::Verbose)
-			{
-				const FString RecipientStr = FString::JoinBy(Context->GetRecipients(), TEXT("+"),
-				                                             &FSGMessageAddress::ToString);
-				UE_LOG(LogSGMessaging, Verbose, TEXT("Dispatching %s from %s to %s"),
-				       *Context->GetMessageTag().ToString(), *Context->GetSender().ToString(), *RecipientStr);
-			}
+			DispatchToRecipient(Context, Recipient, Conflation, RouteCycles);
+		}
+	}
+}
 
-			FilterRecipients(Context, Recipients);
 
-			if (Recipients.Num() < RecipientCount)
-			{
-				UE_LOG(LogSGMessaging, Verbose, TEXT("%d recipients were filtered out"),
-				       RecipientCount - Recipients.Num());
-			}
+void FSGMessageRouter::DispatchMessages(const FContextBatch& Contexts)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SGMessaging_DispatchMessage);
+
+	// the messages of a batch only differ in their tags, so recipients are resolved once per tag
+	TMap<FName, TArray<TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>>> RecipientsByTag;
+	TMap<ENamedThreads::Type, TArray<FSGMessageDelivery>> DeliveriesByThread;
+
+	const uint64 RouteCycles = FPlatformTime::Cycles64();
+
+	for (const auto& Context : Contexts)
+	{
+		if (!Context->IsValid())
+		{
+			continue;
 		}
-		// ... or from subscriptions
-		else
+
+		const FName MessageTag = Context->GetMessageTag();
+		TArray<TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>>* Recipients = RecipientsByTag.Find(MessageTag);
+
+		if (Recipients == nullptr)
 		{
-			FilterSubscriptions(ActiveSubscriptions.FindOrAdd(Context->GetMessageTag()), Context, Recipients);
-			FilterSubscriptions(ActiveSubscriptions.FindOrAdd(NAME_All), Context, Recipients);
+			Recipients = &RecipientsByTag.Add(MessageTag);
+			ResolveRecipients(Context, *Recipients);
+		}
 
-			if (UE_GET_LOG_VERBOSITY(LogSGMessaging) >= ELogVerbosity::Verbose)
-			{
-				const FString RecipientStr = FString::JoinBy(Context->GetRecipients(), TEXT("+"),
-				                                             &FSGMessageAddress::ToString);
-				UE_LOG(LogSGMessaging, Verbose, TEXT("Dispatching %s from %s to %s subscribers"),
-				       *Context->GetMessageTag().ToString(), *Context->GetSender().ToString(), *RecipientStr);
-			}
+		if (Context->GetRecipients().Num() == 0)
+		{
+			RetainMessage(Context);
 		}
 
-		// dispatch the message
-		for (auto& Recipient : Recipients)
+		const FSGMessageConflation* Conflation = Conflations.Find(MessageTag);
+
+		for (const auto& Recipient : *Recipients)
 		{
-			ENamedThreads::Type RecipientThread = Recipient->GetRecipientThread();
+			const ENamedThreads::Type RecipientThread = Recipient->GetRecipientThread();
 
 			if (RecipientThread == ENamedThreads::AnyThread)
 			{
-				Tracer->TraceDispatchedMessage(Context, Recipient.ToSharedRef(), false);
-				Recipient->ReceiveMessage(Context);
-				Tracer->TraceHandledMessage(Context, Recipient.ToSharedRef());
+				DispatchInline(Context, Recipient, RouteCycles);
+			}
+			else if (Conflation != nullptr)
+			{
+				DispatchConflated(Context, Recipient, *Conflation, RouteCycles);
 			}
 			else
 			{
-				TGraphTask<FSGMessageDispatchTask>::CreateTask().ConstructAndDispatchWhenReady(
-					RecipientThread, Context, Recipient, Tracer);
+				TRACE_SGMESSAGING_DISPATCH(*Context, *Recipient, true);
+				DeliveriesByThread.FindOrAdd(RecipientThread).Emplace(Context, Recipient);
 			}
 		}
 	}
+
+	// one task per thread drains the messages in the order of the batch
+	for (auto& DeliveriesPair : DeliveriesByThread)
+	{
+		TGraphTask<FSGMessageBatchDispatchTask>::CreateTask().ConstructAndDispatchWhenReady(
+			DeliveriesPair.Key, MoveTemp(DeliveriesPair.Value), Tracer, RouteCycles);
+	}
+}
+
+
+void FSGMessageRouter::DispatchRetained(const TSharedRef<ISGMessageSubscription, ESPMode::ThreadSafe>& Subscription,
+                                        const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Subscriber)
+{
+	FSGRetainedMessages* Retained = RetainedMessages.Find(Subscription->GetMessageTag());
+
+	if (Retained == nullptr)
+	{
+		return;
+	}
+
+	RemoveExpiredMessages(*Retained);
+
+	if (!Subscription->IsEnabled() || (Retained->Contexts.Num() == 0))
+	{
+		return;
+	}
+
+	UE_LOG(LogSGMessaging, Verbose, TEXT("Dispatching %d retained %s messages to %s"), Retained->Contexts.Num(),
+	       *Subscription->GetMessageTag().ToString(), *Subscriber->GetDebugName().ToString());
+
+	const FSGMessageConflation* Conflation = Conflations.Find(Subscription->GetMessageTag());
+	const uint64 RouteCycles = FPlatformTime::Cycles64();
+
+	for (const auto& Context : Retained->Contexts)
+	{
+		const ESGMessageScope MessageScope = Context->GetScope();
+
+		if (!Context->IsValid() || !Subscription->GetScopeRange().Contains(MessageScope))
+		{
+			continue;
+		}
+
+		if ((MessageScope == ESGMessageScope::Thread) &&
+			(Subscriber->GetRecipientThread() != Context->GetSenderThread()))
+		{
+			continue;
+		}
+
+		DispatchToRecipient(Context, Subscriber, Conflation, RouteCycles);
+	}
+}
+
+
+void FSGMessageRouter::DispatchToRecipient(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                           const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient,
+                                           const FSGMessageConflation* Conflation, const uint64 RouteCycles)
+{
+	const ENamedThreads::Type RecipientThread = Recipient->GetRecipientThread();
+
+	if (RecipientThread == ENamedThreads::AnyThread)
+	{
+		DispatchInline(Context, Recipient, RouteCycles);
+	}
+	else if (Conflation != nullptr)
+	{
+		DispatchConflated(Context, Recipient, *Conflation, RouteCycles);
+	}
+	else
+	{
+		TRACE_SGMESSAGING_DISPATCH(*Context, *Recipient, true);
+		TGraphTask<FSGMessageDispatchTask>::CreateTask().ConstructAndDispatchWhenReady(
+			RecipientThread, Context, Recipient, Tracer, RouteCycles);
+	}
+}
+
+
+void FSGMessageRouter::DispatchConflated(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                         const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient,
+                                         const FSGMessageConflation& Conflation, const uint64 RouteCycles)
+{
+	const FSGConflationKey Key(*Context, Conflation, Recipient.Get());
+	auto* RecipientSlots = ConflationSlots.Find(Recipient.Get());
+	TSharedRef<FSGMessageConflationSlot, ESPMode::ThreadSafe>* Slot = (RecipientSlots != nullptr)
+		                                                                  ? RecipientSlots->Find(Key)
+		                                                                  : nullptr;
+
+	if (Slot == nullptr)
+	{
+		if (NumConflationSlots >= NextConflationPrune)
+		{
+			PruneConflationSlots();
+		}
+
+		Slot = &ConflationSlots.FindOrAdd(Recipient.Get()).Add(
+			Key, MakeShared<FSGMessageConflationSlot, ESPMode::ThreadSafe>(Recipient));
+		++NumConflationSlots;
+	}
+	else if ((*Slot)->GetRecipient().Pin() != Recipient)
+	{
+		// a new recipient may have been allocated where a removed one used to be
+		*Slot = MakeShared<FSGMessageConflationSlot, ESPMode::ThreadSafe>(Recipient);
+	}
+
+	if ((*Slot)->Replace(Context, RouteCycles))
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("Replaced pending %s message for %s"),
+		       *Context->GetMessageTag().ToString(), *Recipient->GetDebugName().ToString());
+
+		++NumConflatedMessages;
+
+		return;
+	}
+
+	TRACE_SGMESSAGING_DISPATCH(*Context, *Recipient, true);
+	TGraphTask<FSGMessageConflatedDispatchTask>::CreateTask().ConstructAndDispatchWhenReady(
+		Recipient->GetRecipientThread(), *Slot, Tracer);
+}
+
+
+void FSGMessageRouter::DispatchInline(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                      const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient,
+                                      const uint64 RouteCycles)
+{
+	TRACE_SGMESSAGING_DISPATCH(*Context, *Recipient, false);
+	SG_MESSAGING_TRACE(Tracer->TraceDispatchedMessage(Context, Recipient.ToSharedRef(), false));
+
+	const uint64 DispatchCycles = FPlatformTime::Cycles64();
+	{
+		TRACE_SGMESSAGING_HANDLE_SCOPE(*Context, *Recipient);
+		Recipient->ReceiveMessage(Context);
+	}
+
+	Tracer->GetLatencyStats()->RecordHandled(
+		Context->GetMessageTag(), ENamedThreads::AnyThread,
+		FSGMessageLatencyStats::CyclesToMicroseconds(DispatchCycles - RouteCycles),
+		FSGMessageLatencyStats::CyclesToMicroseconds(FPlatformTime::Cycles64() - DispatchCycles));
+
+	SG_MESSAGING_TRACE(Tracer->TraceHandledMessage(Context, Recipient.ToSharedRef()));
 }
 
 
@@ -186,6 +434,8 @@ void FSGMessageRouter::FilterSubscriptions(
 	TArray<TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>>& OutRecipients
 )
 {
+	SCOPE_CYCLE_COUNTER(STAT_SGMessaging_FilterSubscriptions);
+
 	const ESGMessageScope MessageScope = Context->GetScope();
 
 	for (int32 SubscriptionIndex = 0; SubscriptionIndex < Subscriptions.Num(); ++SubscriptionIndex)
@@ -214,6 +464,7 @@ void FSGMessageRouter::FilterSubscriptions(
 		}
 		else
 		{
+			RemoveNetworkInterest(Subscription);
 			Subscriptions.RemoveAtSwap(SubscriptionIndex);
 			--SubscriptionIndex;
 		}
@@ -229,7 +480,7 @@ void FSGMessageRouter::FilterRecipients(
 	const TArray<FSGMessageAddress>& RecipientList = Context->GetRecipients();
 	for (const auto& RecipientAddress : RecipientList)
 	{
-		if (auto Recipient = ActiveRecipients.FindRef(RecipientAddress).Pin())
+		if (auto Recipient = FindRecipient(RecipientAddress).Pin())
 		{
 			// if the recipient is not local and the scope does not include network, filter it out of the recipient list
 			if (Recipient->IsLocal() || IncludeNetwork.Contains(Context->GetScope()))
@@ -239,18 +490,290 @@ void FSGMessageRouter::FilterRecipients(
 		}
 		else
 		{
-			ActiveRecipients.Remove(RecipientAddress);
+			ResetRecipient(RecipientAddress);
+		}
+	}
+}
+
+
+TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe> FSGMessageRouter::FindRecipient(
+	const FSGMessageAddress& Address) const
+{
+	if (Address.IsLocal())
+	{
+		const auto Slot = static_cast<int32>(Address.GetSlot());
+
+		if (LocalRecipients.IsValidIndex(Slot) && (LocalRecipients[Slot].Address == Address))
+		{
+			return LocalRecipients[Slot].Recipient;
+		}
+
+		return nullptr;
+	}
+
+	return RemoteRecipients.FindRef(Address);
+}
+
+
+void FSGMessageRouter::SetRecipient(const FSGMessageAddress& Address,
+                                    const TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient)
+{
+	if (Address.IsLocal())
+	{
+		const auto Slot = static_cast<int32>(Address.GetSlot());
+
+		if (Slot >= LocalRecipients.Num())
+		{
+			LocalRecipients.SetNum(Slot + 1);
 		}
+
+		LocalRecipients[Slot].Address = Address;
+		LocalRecipients[Slot].Recipient = Recipient;
+	}
+	else
+	{
+		RemoteRecipients.FindOrAdd(Address) = Recipient;
 	}
 }
 
 
+void FSGMessageRouter::ResetRecipient(const FSGMessageAddress& Address)
+{
+	if (Address.IsLocal())
+	{
+		const auto Slot = static_cast<int32>(Address.GetSlot());
+
+		if (LocalRecipients.IsValidIndex(Slot) && (LocalRecipients[Slot].Address == Address))
+		{
+			LocalRecipients[Slot] = FLocalRecipient();
+		}
+	}
+	else
+	{
+		RemoteRecipients.Remove(Address);
+	}
+}
+
+
+bool FSGMessageRouter::PrepareDispatch(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                       const FDateTime& RouteTime)
+{
+	UE_LOG(LogSGMessaging, Verbose, TEXT("Routing %s message from %s"), *Context->GetMessageTag().ToString(),
+	       *Context->GetSender().ToString());
+
+	TRACE_SGMESSAGING_ROUTE(*Context, NumQueuedCommands.Load(EMemoryOrder::Relaxed), CurrentTime);
+	SG_MESSAGING_TRACE(Tracer->TraceRoutedMessage(Context));
+	++NumRoutedMessages;
+
+	// delayed messages were sent with a time in the future
+	if (Context->GetTimeSent() <= RouteTime)
+	{
+		Tracer->GetLatencyStats()->RecordRouted(
+			Context->GetMessageTag(),
+			static_cast<uint64>((RouteTime - Context->GetTimeSent()).GetTotalMicroseconds()));
+	}
+
+	// record before interceptors, so that recordings hold the complete stream
+	if (Recorder.IsValid())
+	{
+		Recorder->Record(*Context, RouteTime);
+	}
+
+	// intercept routing
+	auto& Interceptors = ActiveInterceptors.FindOrAdd(Context->GetMessageTag());
+
+	for (const auto& Interceptor : Interceptors)
+	{
+		if (Interceptor->InterceptMessage(Context))
+		{
+			UE_LOG(LogSGMessaging, Verbose, TEXT("Message was intercepted by %s"),
+			       *Interceptor->GetDebugName().ToString());
+
+			TRACE_SGMESSAGING_INTERCEPT(*Context, Interceptor->GetDebugName());
+			SG_MESSAGING_TRACE(Tracer->TraceInterceptedMessage(Context, Interceptor.ToSharedRef()));
+			++NumInterceptedMessages;
+
+			return false;
+		}
+	}
+
+	// delay the message
+	if (bAllowDelayedMessaging && (Context->GetTimeSent() > CurrentTime))
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("Queued message for dispatch"));
+
+		const int64 Sequence = ++DelayedMessagesSequence;
+
+		// newer delayed messages of conflated types supersede pending ones with the same key
+		if (const FSGMessageConflation* Conflation = Conflations.Find(Context->GetMessageTag()))
+		{
+			DelayedConflations.FindOrAdd(FSGConflationKey(*Context, *Conflation, nullptr)) = Sequence;
+		}
+
+		DelayedMessages.HeapPush(FSGDelayedMessage(Context, Sequence));
+		NumDelayedMessages = DelayedMessages.Num();
+
+		return false;
+	}
+
+	return true;
+}
+
+
+bool FSGMessageRouter::IsConflated(const FSGDelayedMessage& DelayedMessage)
+{
+	if (DelayedConflations.Num() == 0)
+	{
+		return false;
+	}
+
+	const FSGMessageConflation* Conflation = Conflations.Find(DelayedMessage.Context->GetMessageTag());
+
+	if (Conflation == nullptr)
+	{
+		return false;
+	}
+
+	const FSGConflationKey Key(*DelayedMessage.Context, *Conflation, nullptr);
+	const int64* LatestSequence = DelayedConflations.Find(Key);
+
+	if (LatestSequence == nullptr)
+	{
+		return false;
+	}
+
+	if (*LatestSequence == DelayedMessage.Sequence)
+	{
+		DelayedConflations.Remove(Key);
+
+		return false;
+	}
+
+	UE_LOG(LogSGMessaging, Verbose, TEXT("Dropped delayed %s message that was replaced by a newer one"),
+	       *DelayedMessage.Context->GetMessageTag().ToString());
+
+	++NumConflatedMessages;
+
+	return true;
+}
+
+
+void FSGMessageRouter::RetainMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+{
+	if (RetainedMessages.Num() == 0)
+	{
+		return;
+	}
+
+	FSGRetainedMessages* Retained = RetainedMessages.Find(Context->GetMessageTag());
+
+	if (Retained == nullptr)
+	{
+		return;
+	}
+
+	// messages that still point into their publisher's memory must not outlive the publish call
+	const FSGMessage* Message = static_cast<const FSGMessage*>(Context->GetMessage());
+
+	if ((Message == nullptr) || !(Message->IsSnapshot() || Message->IsWire()))
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("Not retaining a %s message that was published without a snapshot"),
+		       *Context->GetMessageTag().ToString());
+
+		return;
+	}
+
+	RemoveExpiredMessages(*Retained);
+
+	const int32 NumExcess = Retained->Contexts.Num() - Retained->HistorySize + 1;
+
+	if (NumExcess > 0)
+	{
+		Retained->Contexts.RemoveAt(0, NumExcess);
+	}
+
+	Retained->Contexts.Add(Context);
+}
+
+
+void FSGMessageRouter::RemoveExpiredMessages(FSGRetainedMessages& Retained) const
+{
+	const FDateTime Now = FDateTime::UtcNow();
+
+	Retained.Contexts.RemoveAll([&Now](const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+	{
+		return Context->GetExpiration() <= Now;
+	});
+}
+
+
+void FSGMessageRouter::RemoveConflationSlots(const ISGMessageReceiver* Recipient, const FName& MessageTag)
+{
+	auto* RecipientSlots = ConflationSlots.Find(Recipient);
+
+	if (RecipientSlots == nullptr)
+	{
+		return;
+	}
+
+	if (MessageTag == NAME_All)
+	{
+		NumConflationSlots -= RecipientSlots->Num();
+		ConflationSlots.Remove(Recipient);
+
+		return;
+	}
+
+	for (auto It = RecipientSlots->CreateIterator(); It; ++It)
+	{
+		if (It.Key().MessageTag == MessageTag)
+		{
+			It.RemoveCurrent();
+			--NumConflationSlots;
+		}
+	}
+
+	if (RecipientSlots->Num() == 0)
+	{
+		ConflationSlots.Remove(Recipient);
+	}
+}
+
+
+void FSGMessageRouter::PruneConflationSlots()
+{
+	// only the router fills slots, so a slot that is not pending stays empty until it is pruned
+	for (auto RecipientIt = ConflationSlots.CreateIterator(); RecipientIt; ++RecipientIt)
+	{
+		for (auto It = RecipientIt.Value().CreateIterator(); It; ++It)
+		{
+			if (!It.Value()->IsPending())
+			{
+				It.RemoveCurrent();
+				--NumConflationSlots;
+			}
+		}
+
+		if (RecipientIt.Value().Num() == 0)
+		{
+			RecipientIt.RemoveCurrent();
+		}
+	}
+
+	// pruning again once the pending slots doubled keeps the cost per slot constant
+	NextConflationPrune = FMath::Max(SGMessageRouter::MinConflationPrune, 2 * NumConflationSlots);
+}
+
+
 void FSGMessageRouter::ProcessCommands()
 {
+	SCOPE_CYCLE_COUNTER(STAT_SGMessaging_ProcessCommands);
+
 	FCommandDelegate Command;
 
 	while (Commands.Dequeue(Command))
 	{
+		--NumQueuedCommands;
 		Command.Execute();
 	}
 }
@@ -263,7 +786,12 @@ void FSGMessageRouter::ProcessDelayedMessages()
 	while ((DelayedMessages.Num() > 0) && (DelayedMessages.HeapTop().Context->GetTimeSent() <= CurrentTime))
 	{
 		DelayedMessages.HeapPop(DelayedMessage);
-		DispatchMessage(DelayedMessage.Context.ToSharedRef());
+		NumDelayedMessages = DelayedMessages.Num();
+
+		if (!IsConflated(DelayedMessage))
+		{
+			DispatchMessage(DelayedMessage.Context.ToSharedRef());
+		}
 	}
 }
 
@@ -290,7 +818,49 @@ void FSGMessageRouter::HandleAddInterceptor(TSharedRef<ISGMessageInterceptor, ES
 	       *Interceptor->GetDebugName().ToString(), *MessageTag.ToString());
 
 	ActiveInterceptors.FindOrAdd(MessageTag).AddUnique(Interceptor);
-	Tracer->TraceAddedInterceptor(Interceptor, MessageTag);
+	SG_MESSAGING_TRACE(Tracer->TraceAddedInterceptor(Interceptor, MessageTag));
+}
+
+
+void FSGMessageRouter::HandleClearConflation(FName MessageTag)
+{
+	UE_LOG(LogSGMessaging, Verbose, TEXT("Clearing the conflation of %s messages"), *MessageTag.ToString());
+
+	Conflations.Remove(MessageTag);
+
+	// pending deliveries still complete, but no longer replace each other
+	for (auto RecipientIt = ConflationSlots.CreateIterator(); RecipientIt; ++RecipientIt)
+	{
+		for (auto It = RecipientIt.Value().CreateIterator(); It; ++It)
+		{
+			if (It.Key().MessageTag == MessageTag)
+			{
+				It.RemoveCurrent();
+				--NumConflationSlots;
+			}
+		}
+
+		if (RecipientIt.Value().Num() == 0)
+		{
+			RecipientIt.RemoveCurrent();
+		}
+	}
+
+	for (auto It = DelayedConflations.CreateIterator(); It; ++It)
+	{
+		if (It.Key().MessageTag == MessageTag)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+
+void FSGMessageRouter::HandleClearRetention(FName MessageTag)
+{
+	UE_LOG(LogSGMessaging, Verbose, TEXT("Clearing the retention of %s messages"), *MessageTag.ToString());
+
+	RetainedMessages.Remove(MessageTag);
 }
 
 
@@ -302,8 +872,8 @@ void FSGMessageRouter::HandleAddRecipient(FSGMessageAddress Address,
 		UE_LOG(LogSGMessaging, Verbose, TEXT("Adding %s on %s as recipient"), *Recipient->GetDebugName().ToString(),
 		       *Address.ToString());
 
-		ActiveRecipients.FindOrAdd(Address) = Recipient;
-		Tracer->TraceAddedRecipient(Address, Recipient.ToSharedRef());
+		SetRecipient(Address, Recipient);
+		SG_MESSAGING_TRACE(Tracer->TraceAddedRecipient(Address, Recipient.ToSharedRef()));
 		NotifyRegistration(Address, ESGMessageBusNotification::Registered);
 	}
 }
@@ -311,14 +881,24 @@ void FSGMessageRouter::HandleAddRecipient(FSGMessageAddress Address,
 
 void FSGMessageRouter::HandleAddSubscriber(TSharedRef<ISGMessageSubscription, ESPMode::ThreadSafe> Subscription)
 {
-	if (const auto Subscriber = Subscription->GetSubscriber().Pin())
+	const auto Subscriber = Subscription->GetSubscriber().Pin();
+
+	if (Subscriber.IsValid())
 	{
 		UE_LOG(LogSGMessaging, Verbose, TEXT("Adding %s as a subscriber for %s messages"),
 		       *Subscriber->GetDebugName().ToString(), *Subscription->GetMessageTag().ToString());
 	}
 
 	ActiveSubscriptions.FindOrAdd(Subscription->GetMessageTag()).AddUnique(Subscription);
-	Tracer->TraceAddedSubscription(Subscription);
+	SG_MESSAGING_TRACE(Tracer->TraceAddedSubscription(Subscription));
+
+	if (Subscriber.IsValid())
+	{
+		AddNetworkInterest(Subscription, *Subscriber);
+
+		// late joiners catch up with the retained messages
+		DispatchRetained(Subscription, Subscriber);
+	}
 }
 
 
@@ -341,18 +921,19 @@ void FSGMessageRouter::HandleRemoveInterceptor(TSharedRef<ISGMessageInterceptor,
 		Interceptors.Remove(Interceptor);
 	}
 
-	Tracer->TraceRemovedInterceptor(Interceptor, MessageTag);
+	SG_MESSAGING_TRACE(Tracer->TraceRemovedInterceptor(Interceptor, MessageTag));
 }
 
 void FSGMessageRouter::HandleRemoveRecipient(FSGMessageAddress Address)
 {
-	if (const auto Recipient = ActiveRecipients.FindRef(Address).Pin())
+	if (const auto Recipient = FindRecipient(Address).Pin())
 	{
 		UE_LOG(LogSGMessaging, Verbose, TEXT("Removing %s on %s as recipient"), *Recipient->GetDebugName().ToString(),
 		       *Address.ToString());
 
-		ActiveRecipients.Remove(Address);
-		Tracer->TraceRemovedRecipient(Address);
+		ResetRecipient(Address);
+		RemoveConflationSlots(Recipient.Get(), NAME_All);
+		SG_MESSAGING_TRACE(Tracer->TraceRemovedRecipient(Address));
 		NotifyRegistration(Address, ESGMessageBusNotification::Unregistered);
 	}
 }
@@ -368,6 +949,8 @@ void FSGMessageRouter::HandleRemoveSubscriber(TWeakPtr<ISGMessageReceiver, ESPMo
 		return;
 	}
 
+	RemoveConflationSlots(Subscriber.Get(), MessageTag);
+
 	for (auto& SubscriptionsPair : ActiveSubscriptions)
 	{
 		if ((MessageTag != NAME_All) && (MessageTag != SubscriptionsPair.Key))
@@ -386,8 +969,9 @@ void FSGMessageRouter::HandleRemoveSubscriber(TWeakPtr<ISGMessageReceiver, ESPMo
 				UE_LOG(LogSGMessaging, Verbose, TEXT("Removing %s as a subscriber for %s messages"),
 				       *Subscriber->GetDebugName().ToString(), *Subscription->GetMessageTag().ToString());
 
+				RemoveNetworkInterest(Subscription);
 				Subscriptions.RemoveAtSwap(SubscriptionIndex);
-				Tracer->TraceRemovedSubscription(Subscription.ToSharedRef(), MessageTag);
+				SG_MESSAGING_TRACE(Tracer->TraceRemovedSubscription(Subscription.ToSharedRef(), MessageTag));
 
 				break;
 			}
@@ -398,43 +982,183 @@ void FSGMessageRouter::HandleRemoveSubscriber(TWeakPtr<ISGMessageReceiver, ESPMo
 
 void FSGMessageRouter::HandleRouteMessage(TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Context)
 {
-	UE_LOG(LogSGMessaging, Verbose, TEXT("Routing %s message from %s"), *Context->GetMessageTag().ToString(),
-	       *Context->GetSender().ToString());
+	if (PrepareDispatch(Context, FDateTime::UtcNow()))
+	{
+		DispatchMessage(Context);
+	}
+}
 
-	Tracer->TraceRoutedMessage(Context);
+void FSGMessageRouter::HandleRouteMessages(TSharedRef<FContextBatch, ESPMode::ThreadSafe> Contexts)
+{
+	const FDateTime RouteTime = FDateTime::UtcNow();
 
-	// intercept routing
-	auto& Interceptors = ActiveInterceptors.FindOrAdd(Context->GetMessageTag());
+	FContextBatch DispatchContexts;
+	DispatchContexts.Reserve(Contexts->Num());
 
-	for (const auto& Interceptor : Interceptors)
+	for (const auto& Context : *Contexts)
 	{
-		if (Interceptor->InterceptMessage(Context))
+		if (PrepareDispatch(Context, RouteTime))
 		{
-			UE_LOG(LogSGMessaging, Verbose, TEXT("Message was intercepted by %s"),
-			       *Interceptor->GetDebugName().ToString());
+			DispatchContexts.Add(Context);
+		}
+	}
 
-			Tracer->TraceInterceptedMessage(Context, Interceptor.ToSharedRef());
+	if (DispatchContexts.Num() > 0)
+	{
+		DispatchMessages(DispatchContexts);
+	}
+}
+
+void FSGMessageRouter::HandleSetConflation(FName MessageTag, FSGMessageConflation Conflation)
+{
+	UE_LOG(LogSGMessaging, Verbose, TEXT("Conflating %s messages"), *MessageTag.ToString());
+
+	// deliveries that are pending under the previous mode complete as they are
+	HandleClearConflation(MessageTag);
+	Conflations.Add(MessageTag, Conflation);
+}
+
+void FSGMessageRouter::HandleSetRetention(FName MessageTag, int32 HistorySize)
+{
+	FSGRetainedMessages& Retained = RetainedMessages.FindOrAdd(MessageTag);
+	Retained.HistorySize = HistorySize;
 
-			return;
+	const int32 NumExcess = Retained.Contexts.Num() - HistorySize;
+
+	if (NumExcess > 0)
+	{
+		Retained.Contexts.RemoveAt(0, NumExcess);
+	}
+}
+
+void FSGMessageRouter::HandleSetRecorder(TSharedPtr<FSGMessageRecorder, ESPMode::ThreadSafe> InRecorder)
+{
+	Recorder = InRecorder;
+}
+
+void FSGMessageRouter::HandleTakeSnapshot(TSharedRef<TPromise<FSGMessageBusSnapshot>, ESPMode::ThreadSafe> Promise)
+{
+	FSGMessageBusSnapshot Snapshot;
+	{
+		Snapshot.Stats = GetStats();
+		Snapshot.NumListeners = ActiveRegistrationListeners.Num();
+	}
+
+	TMap<const ISGMessageReceiver*, int32> NumSubscriptions;
+
+	for (const auto& SubscriptionsPair : ActiveSubscriptions)
+	{
+		FSGMessageBusTagSnapshot TagSnapshot;
+		{
+			TagSnapshot.MessageTag = SubscriptionsPair.Key;
+			TagSnapshot.NumNetworkSubscriptions = NetworkInterest.FindRef(SubscriptionsPair.Key);
+		}
+
+		for (const auto& Subscription : SubscriptionsPair.Value)
+		{
+			if (const auto Subscriber = Subscription->GetSubscriber().Pin())
+			{
+				++TagSnapshot.NumSubscriptions;
+				++NumSubscriptions.FindOrAdd(Subscriber.Get());
+			}
+			else
+			{
+				++TagSnapshot.NumStaleSubscriptions;
+			}
+		}
+
+		if (const auto Interceptors = ActiveInterceptors.Find(SubscriptionsPair.Key))
+		{
+			TagSnapshot.NumInterceptors = Interceptors->Num();
+		}
+
+		if (const auto Retained = RetainedMessages.Find(SubscriptionsPair.Key))
+		{
+			TagSnapshot.NumRetained = Retained->Contexts.Num();
+		}
+
+		// routing adds empty entries for every tag that was sent
+		if ((TagSnapshot.NumSubscriptions > 0) || (TagSnapshot.NumStaleSubscriptions > 0) ||
+			(TagSnapshot.NumInterceptors > 0) || (TagSnapshot.NumRetained > 0))
+		{
+			Snapshot.Tags.Add(TagSnapshot);
 		}
 	}
 
-	// dispatch the message
-	if (bAllowDelayedMessaging && (Context->GetTimeSent() > CurrentTime))
+	for (const auto& InterceptorsPair : ActiveInterceptors)
 	{
-		UE_LOG(LogSGMessaging, Verbose, TEXT("Queued message for dispatch"));
+		if ((InterceptorsPair.Value.Num() > 0) && !ActiveSubscriptions.Contains(InterceptorsPair.Key))
+		{
+			FSGMessageBusTagSnapshot& TagSnapshot = Snapshot.Tags.AddDefaulted_GetRef();
+			{
+				TagSnapshot.MessageTag = InterceptorsPair.Key;
+				TagSnapshot.NumInterceptors = InterceptorsPair.Value.Num();
+				TagSnapshot.NumRetained = RetainedMessages.Contains(InterceptorsPair.Key)
+					                          ? RetainedMessages[InterceptorsPair.Key].Contexts.Num()
+					                          : 0;
+			}
+		}
+	}
+
+	for (const auto& RetainedPair : RetainedMessages)
+	{
+		const bool bListed = ActiveSubscriptions.Contains(RetainedPair.Key) ||
+			(ActiveInterceptors.Contains(RetainedPair.Key) && (ActiveInterceptors[RetainedPair.Key].Num() > 0));
+
+		if ((RetainedPair.Value.Contexts.Num() > 0) && !bListed)
+		{
+			FSGMessageBusTagSnapshot& TagSnapshot = Snapshot.Tags.AddDefaulted_GetRef();
+			{
+				TagSnapshot.MessageTag = RetainedPair.Key;
+				TagSnapshot.NumRetained = RetainedPair.Value.Contexts.Num();
+			}
+		}
+	}
+
+	const auto AddRecipient = [&Snapshot, &NumSubscriptions](const FSGMessageAddress& Address,
+	                                                         const ISGMessageReceiver& Recipient)
+	{
+		FSGMessageBusRecipientSnapshot& RecipientSnapshot = Snapshot.Recipients.AddDefaulted_GetRef();
+		{
+			RecipientSnapshot.Address = Address;
+			RecipientSnapshot.DebugName = Recipient.GetDebugName();
+			RecipientSnapshot.bLocal = Recipient.IsLocal();
+			RecipientSnapshot.NumSubscriptions = NumSubscriptions.FindRef(&Recipient);
+			RecipientSnapshot.NumInboxMessages = Recipient.GetNumInboxMessages();
+		}
+	};
 
-		DelayedMessages.HeapPush(FSGDelayedMessage(Context, ++DelayedMessagesSequence));
+	for (const auto& LocalRecipient : LocalRecipients)
+	{
+		if (const auto Recipient = LocalRecipient.Recipient.Pin())
+		{
+			AddRecipient(LocalRecipient.Address, *Recipient);
+		}
 	}
-	else
+
+	for (const auto& RecipientPair : RemoteRecipients)
 	{
-		DispatchMessage(Context);
+		if (const auto Recipient = RecipientPair.Value.Pin())
+		{
+			AddRecipient(RecipientPair.Key, *Recipient);
+		}
 	}
+
+	Promise->SetValue(MoveTemp(Snapshot));
 }
 
 void FSGMessageRouter::HandleAddListener(TWeakPtr<ISGBusListener, ESPMode::ThreadSafe> ListenerPtr)
 {
 	ActiveRegistrationListeners.AddUnique(ListenerPtr);
+
+	// bring the new listener up to date with the current network interest
+	if (const auto Listener = ListenerPtr.Pin())
+	{
+		for (const auto& InterestPair : NetworkInterest)
+		{
+			NotifySubscription(Listener, InterestPair.Key, ESGMessageBusNotification::Registered);
+		}
+	}
 }
 
 void FSGMessageRouter::HandleRemoveListener(TWeakPtr<ISGBusListener, ESPMode::ThreadSafe> ListenerPtr)
@@ -466,3 +1190,86 @@ void FSGMessageRouter::NotifyRegistration(const FSGMessageAddress& Address, ESGM
 		}
 	}
 }
+
+
+void FSGMessageRouter::NotifySubscription(const FName& MessageTag, ESGMessageBusNotification Notification)
+{
+	for (auto It = ActiveRegistrationListeners.CreateIterator(); It; ++It)
+	{
+		if (auto Listener = It->Pin())
+		{
+			NotifySubscription(Listener, MessageTag, Notification);
+		}
+		else
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+
+void FSGMessageRouter::NotifySubscription(const TSharedPtr<ISGBusListener, ESPMode::ThreadSafe>& Listener,
+                                          const FName& MessageTag, ESGMessageBusNotification Notification)
+{
+	const ENamedThreads::Type ListenerThread = Listener->GetListenerThread();
+
+	if (ListenerThread == ENamedThreads::AnyThread)
+	{
+		Listener->NotifySubscription(MessageTag, Notification);
+	}
+	else
+	{
+		const TWeakPtr<ISGBusListener, ESPMode::ThreadSafe> ListenerPtr = Listener;
+
+		FFunctionGraphTask::CreateAndDispatchWhenReady([ListenerPtr, MessageTag, Notification]()
+		{
+			if (const auto PinnedListener = ListenerPtr.Pin())
+			{
+				PinnedListener->NotifySubscription(MessageTag, Notification);
+			}
+		}, TStatId(), nullptr, ListenerThread);
+	}
+}
+
+
+void FSGMessageRouter::AddNetworkInterest(const TSharedPtr<ISGMessageSubscription, ESPMode::ThreadSafe>& Subscription,
+                                          const ISGMessageReceiver& Subscriber)
+{
+	// bridges subscribe at network scope themselves, but only local endpoints make messages interesting to other nodes
+	if (!Subscriber.IsLocal() || !Subscription->GetScopeRange().Contains(ESGMessageScope::Network))
+	{
+		return;
+	}
+
+	bool bAlreadyCounted = false;
+	NetworkSubscriptions.Add(Subscription.Get(), &bAlreadyCounted);
+
+	if (bAlreadyCounted)
+	{
+		return;
+	}
+
+	if (++NetworkInterest.FindOrAdd(Subscription->GetMessageTag()) == 1)
+	{
+		NotifySubscription(Subscription->GetMessageTag(), ESGMessageBusNotification::Registered);
+	}
+}
+
+
+void FSGMessageRouter::RemoveNetworkInterest(const TSharedPtr<ISGMessageSubscription, ESPMode::ThreadSafe>& Subscription)
+{
+	if (NetworkSubscriptions.Remove(Subscription.Get()) == 0)
+	{
+		return;
+	}
+
+	const FName MessageTag = Subscription->GetMessageTag();
+	int32* Count = NetworkInterest.Find(MessageTag);
+
+	if ((Count != nullptr) && (--*Count <= 0))
+	{
+		NetworkInterest.Remove(MessageTag);
+		NotifySubscription(MessageTag, ESGMessageBusNotification::Unregistered);
+	}
+}
+
@@ -1,29 +1,75 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Core/Bus/SGMessageTracer.h"
-#include "Containers/Ticker.h"
+#include "HAL/Event.h"
 #include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeLock.h"
 #include "Core/Interface/ISGMessageInterceptor.h"
 #include "Core/Interface/ISGMessageReceiver.h"
 #include "Core/Interface/ISGMessageTracerBreakpoint.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Settings/SGMessagingSettings.h"
+
+
+namespace SGMessageTracer
+{
+	/** The interval at which the tracer thread merges records. */
+	constexpr uint32 ProcessIntervalMs = 10;
+
+	/** The interval at which expired messages are removed (in seconds). */
+	constexpr double EvictionInterval = 1.0;
+
+	/** The smallest number of records per thread ring. */
+	constexpr int32 MinRingCapacity = 64;
+
+	/** Holds the number of tracers that were created, which provides their serial numbers. */
+	TAtomic<uint64> NumTracers(0);
+}
+
 
 /* FSGMessageTracer structors
  *****************************************************************************/
 
 FSGMessageTracer::FSGMessageTracer()
-	: Breaking(false)
+	: LatencyStats(MakeShared<FSGMessageLatencyStats, ESPMode::ThreadSafe>())
+	  , Breaking(false)
 	  , ResetPending(false)
 	  , Running(false)
+	  , LastEvictionTime(0.0)
+	  , NumDroppedRecords(0)
+	  , RingCapacity(FMath::RoundUpToPowerOfTwo(FMath::Max(GetDefault<USGMessagingSettings>()->TracerRingCapacity,
+	                                                       SGMessageTracer::MinRingCapacity)))
+	  , RetentionTime(FMath::Max(GetDefault<USGMessagingSettings>()->TracerRetentionTime, 1.0f))
+	  , Serial(++SGMessageTracer::NumTracers)
+	  , Stopping(false)
+	  , Thread(nullptr)
 {
 	ContinueEvent = FPlatformProcess::GetSynchEventFromPool();
-	TickDelegateHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FSGMessageTracer::Tick),
-	                                                          0.0f);
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+
+#if SG_MESSAGING_WITH_TRACER
+	Processor = MakeUnique<FProcessor>(*this);
+	Thread = FRunnableThread::Create(Processor.Get(), TEXT("FSGMessageTracer"), 128 * 1024, TPri_BelowNormal);
+#endif
 }
 
 
 FSGMessageTracer::~FSGMessageTracer()
 {
-	FTSTicker::GetCoreTicker().RemoveTicker(TickDelegateHandle);
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	Processor.Reset();
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+
 	FPlatformProcess::ReturnSynchEventToPool(ContinueEvent);
 	ContinueEvent = nullptr;
 }
@@ -32,77 +78,41 @@ FSGMessageTracer::~FSGMessageTracer()
 /* FSGMessageTracer interface
  *****************************************************************************/
 
+#if SG_MESSAGING_WITH_TRACER
+
 void FSGMessageTracer::TraceAddedInterceptor(const TSharedRef<ISGMessageInterceptor, ESPMode::ThreadSafe>& Interceptor,
                                              const FName& MessageTag)
 {
-	const double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
+	FRecord Record = MakeRecord(ERecordType::AddedInterceptor);
 	{
-		// create interceptor information
-		auto& InterceptorInfo = Interceptors.FindOrAdd(Interceptor->GetInterceptorId());
-
-		if (!InterceptorInfo.IsValid())
-		{
-			InterceptorInfo = MakeShareable(new FSGMessageTracerInterceptorInfo());
-		}
+		Record.Id = Interceptor->GetInterceptorId();
+		Record.MessageTag = MessageTag;
+		Record.Name = Interceptor->GetDebugName();
+	}
 
-		// initialize interceptor information
-		InterceptorInfo->Name = Interceptor->GetDebugName();
-		InterceptorInfo->TimeRegistered = Timestamp;
-		InterceptorInfo->TimeUnregistered = 0;
-	});
+	AddRecord(Record);
 }
 
 
 void FSGMessageTracer::TraceAddedRecipient(const FSGMessageAddress& Address,
                                            const TSharedRef<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient)
 {
-	const double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
+	FRecord Record = MakeRecord(ERecordType::AddedRecipient);
 	{
-		// create endpoint information
-		TSharedPtr<FSGMessageTracerEndpointInfo>& EndpointInfo = RecipientsToEndpointInfos.FindOrAdd(
-			Recipient->GetRecipientId());
-
-		if (!EndpointInfo.IsValid())
-		{
-			EndpointInfo = MakeShareable(new FSGMessageTracerEndpointInfo());
-		}
-
-		// initialize endpoint information
-		const TSharedRef<FSGMessageTracerAddressInfo> AddressInfo = MakeShareable(new FSGMessageTracerAddressInfo());
-		{
-			AddressInfo->Address = Address;
-			AddressInfo->TimeRegistered = Timestamp;
-			AddressInfo->TimeUnregistered = 0;
-		}
-
-		EndpointInfo->AddressInfos.Add(Address, AddressInfo);
-		EndpointInfo->Name = Recipient->GetDebugName();
-		EndpointInfo->Remote = Recipient->IsRemote();
+		Record.Address = Address;
+		Record.Id = Recipient->GetRecipientId();
+		Record.Name = Recipient->GetDebugName();
+		Record.bFlag = Recipient->IsRemote();
+	}
 
-		// add to address table
-		AddressesToEndpointInfos.Add(Address, EndpointInfo);
-	});
+	AddRecord(Record);
 }
 
 
 void FSGMessageTracer::TraceAddedSubscription(
 	const TSharedRef<ISGMessageSubscription, ESPMode::ThreadSafe>& Subscription)
 {
-	if (!Running)
-	{
-		return;
-	}
-
-	double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
-	{
-		// @todo gmp: trace added subscriptions
-	});
+	// @todo gmp: trace added subscriptions
 }
 
 
@@ -115,45 +125,15 @@ void FSGMessageTracer::TraceDispatchedMessage(const TSharedRef<ISGMessageContext
 		return;
 	}
 
-	const double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
+	FRecord Record = MakeRecord(ERecordType::DispatchedMessage);
 	{
-		// look up message & endpoint info
-		const TSharedPtr<FSGMessageTracerMessageInfo> MessageInfo = MessageInfos.FindRef(Context);
-
-		if (!MessageInfo.IsValid())
-		{
-			return;
-		}
-
-		const TSharedPtr<FSGMessageTracerEndpointInfo>& EndpointInfo = RecipientsToEndpointInfos.FindOrAdd(
-			Recipient->GetRecipientId());
-
-		if (!EndpointInfo.IsValid())
-		{
-			return;
-		}
-
-		// update message information
-		const TSharedRef<FSGMessageTracerDispatchState> DispatchState = MakeShareable(
-			new FSGMessageTracerDispatchState());
-		{
-			DispatchState->DispatchLatency = Timestamp - MessageInfo->TimeSent;
-			DispatchState->DispatchType = Async
-				                              ? ESGMessageTracerDispatchTypes::TaskGraph
-				                              : ESGMessageTracerDispatchTypes::Direct;
-			DispatchState->EndpointInfo = EndpointInfo;
-			DispatchState->RecipientThread = Recipient->GetRecipientThread();
-			DispatchState->TimeDispatched = Timestamp;
-			DispatchState->TimeHandled = 0.0;
-		}
-
-		MessageInfo->DispatchStates.Add(EndpointInfo, DispatchState);
+		Record.MessageId = reinterpret_cast<UPTRINT>(&Context.Get());
+		Record.Id = Recipient->GetRecipientId();
+		Record.RecipientThread = Recipient->GetRecipientThread();
+		Record.bFlag = Async;
+	}
 
-		// update database
-		EndpointInfo->ReceivedMessages.Add(MessageInfo);
-	});
+	AddRecord(Record);
 }
 
 
@@ -165,35 +145,13 @@ void FSGMessageTracer::TraceHandledMessage(const TSharedRef<ISGMessageContext, E
 		return;
 	}
 
-	const double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
+	FRecord Record = MakeRecord(ERecordType::HandledMessage);
 	{
-		// look up message & endpoint info
-		const TSharedPtr<FSGMessageTracerMessageInfo> MessageInfo = MessageInfos.FindRef(Context);
-
-		if (!MessageInfo.IsValid())
-		{
-			return;
-		}
-
-		const TSharedPtr<FSGMessageTracerEndpointInfo> EndpointInfo = RecipientsToEndpointInfos.FindRef(
-			Recipient->GetRecipientId());
-
-		if (!EndpointInfo.IsValid())
-		{
-			return;
-		}
-
-		// update message information
-		const TSharedPtr<FSGMessageTracerDispatchState> DispatchState = MessageInfo->DispatchStates.FindRef(
-			EndpointInfo);
+		Record.MessageId = reinterpret_cast<UPTRINT>(&Context.Get());
+		Record.Id = Recipient->GetRecipientId();
+	}
 
-		if (DispatchState.IsValid())
-		{
-			DispatchState->TimeHandled = Timestamp;
-		}
-	});
+	AddRecord(Record);
 }
 
 
@@ -206,91 +164,44 @@ void FSGMessageTracer::TraceInterceptedMessage(const TSharedRef<ISGMessageContex
 		return;
 	}
 
-	double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
+	FRecord Record = MakeRecord(ERecordType::InterceptedMessage);
 	{
-		// look up message & interceptor info
-		const auto MessageInfo = MessageInfos.FindRef(Context);
-
-		if (!MessageInfo.IsValid())
-		{
-			return;
-		}
-
-		MessageInfo->Intercepted = true;
-
-		const auto InterceptorInfo = Interceptors.FindRef(Interceptor->GetInterceptorId());
-
-		if (!InterceptorInfo.IsValid())
-		{
-			return;
-		}
+		Record.MessageId = reinterpret_cast<UPTRINT>(&Context.Get());
+		Record.Id = Interceptor->GetInterceptorId();
+	}
 
-		// update interceptor information
-		InterceptorInfo->InterceptedMessages.Add(MessageInfo);
-	});
+	AddRecord(Record);
 }
 
 
 void FSGMessageTracer::TraceRemovedInterceptor(
 	const TSharedRef<ISGMessageInterceptor, ESPMode::ThreadSafe>& Interceptor, const FName& MessageTag)
 {
-	const double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
+	FRecord Record = MakeRecord(ERecordType::RemovedInterceptor);
 	{
-		const auto InterceptorInfo = Interceptors.FindRef(Interceptor->GetInterceptorId());
-
-		if (!InterceptorInfo.IsValid())
-		{
-			return;
-		}
+		Record.Id = Interceptor->GetInterceptorId();
+		Record.MessageTag = MessageTag;
+	}
 
-		// update interceptor information
-		InterceptorInfo->TimeUnregistered = Timestamp;
-	});
+	AddRecord(Record);
 }
 
 
 void FSGMessageTracer::TraceRemovedRecipient(const FSGMessageAddress& Address)
 {
-	const double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
+	FRecord Record = MakeRecord(ERecordType::RemovedRecipient);
 	{
-		const TSharedPtr<FSGMessageTracerEndpointInfo> EndpointInfo = AddressesToEndpointInfos.FindRef(Address);
-
-		if (!EndpointInfo.IsValid())
-		{
-			return;
-		}
-
-		// update endpoint information
-		const TSharedPtr<FSGMessageTracerAddressInfo> AddressInfo = EndpointInfo->AddressInfos.FindRef(Address);
+		Record.Address = Address;
+	}
 
-		if (AddressInfo.IsValid())
-		{
-			AddressInfo->TimeUnregistered = Timestamp;
-		}
-	});
+	AddRecord(Record);
 }
 
 
 void FSGMessageTracer::TraceRemovedSubscription(
 	const TSharedRef<ISGMessageSubscription, ESPMode::ThreadSafe>& Subscription, const FName& MessageTag)
 {
-	if (!Running)
-	{
-		return;
-	}
-
-	double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
-	{
-		// @todo gmp: trace removed message subscriptions
-	});
+	// @todo gmp: trace removed message subscriptions
 }
 
 
@@ -307,18 +218,12 @@ void FSGMessageTracer::TraceRoutedMessage(const TSharedRef<ISGMessageContext, ES
 		ContinueEvent->Wait();
 	}
 
-	const double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
+	FRecord Record = MakeRecord(ERecordType::RoutedMessage);
 	{
-		// update message information
-		const TSharedPtr<FSGMessageTracerMessageInfo> MessageInfo = MessageInfos.FindRef(Context);
+		Record.MessageId = reinterpret_cast<UPTRINT>(&Context.Get());
+	}
 
-		if (MessageInfo.IsValid())
-		{
-			MessageInfo->TimeRouted = Timestamp;
-		}
-	});
+	AddRecord(Record);
 }
 
 
@@ -329,51 +234,18 @@ void FSGMessageTracer::TraceSentMessage(const TSharedRef<ISGMessageContext, ESPM
 		return;
 	}
 
-	const double Timestamp = FPlatformTime::Seconds();
-
-	Traces.Enqueue([=]()
+	FRecord Record = MakeRecord(ERecordType::SentMessage);
 	{
-		// look up endpoint info
-		const TSharedPtr<FSGMessageTracerEndpointInfo> EndpointInfo = AddressesToEndpointInfos.FindRef(
-			Context->GetSender());
-
-		if (!EndpointInfo.IsValid())
-		{
-			return;
-		}
-
-		// create message info
-		const TSharedRef<FSGMessageTracerMessageInfo> MessageInfo = MakeShareable(new FSGMessageTracerMessageInfo());
-		{
-			MessageInfo->Context = Context;
-			MessageInfo->Intercepted = false;
-			MessageInfo->SenderInfo = EndpointInfo;
-			MessageInfo->TimeRouted = 0.0;
-			MessageInfo->TimeSent = Timestamp;
-			MessageInfos.Add(Context, MessageInfo);
-		}
-
-		// add message type
-		TSharedPtr<FSGMessageTracerTypeInfo>& TypeInfo = MessageTags.FindOrAdd(Context->GetMessageTag());
-
-		if (!TypeInfo.IsValid())
-		{
-			TypeInfo = MakeShareable(new FSGMessageTracerTypeInfo());
-			TypeInfo->TypeName = Context->GetMessageTag();
-
-			TypeAddedDelegate.Broadcast(TypeInfo.ToSharedRef());
-		}
-
-		TypeInfo->Messages.Add(MessageInfo);
-
-		// update database
-		EndpointInfo->SentMessages.Add(MessageInfo);
-		MessageInfo->TypeInfo = TypeInfo;
+		Record.MessageId = reinterpret_cast<UPTRINT>(&Context.Get());
+		Record.MessageTag = Context->GetMessageTag();
+		Record.Address = Context->GetSender();
+	}
 
-		MessagesAddedDelegate.Broadcast(MessageInfo);
-	});
+	AddRecord(Record);
 }
 
+#endif
+
 
 /* ISGMessageTracer interface
  *****************************************************************************/
@@ -400,14 +272,24 @@ void FSGMessageTracer::Continue()
 
 int32 FSGMessageTracer::GetEndpoints(TArray<TSharedPtr<FSGMessageTracerEndpointInfo>>& OutEndpoints) const
 {
+	FReadScopeLock Lock(DatabaseLock);
+
 	RecipientsToEndpointInfos.GenerateValueArray(OutEndpoints);
 
 	return OutEndpoints.Num();
 }
 
 
+int32 FSGMessageTracer::GetLatencies(TArray<FSGMessageTracerLatencyInfo>& OutLatencies) const
+{
+	return LatencyStats->GetLatencies(OutLatencies);
+}
+
+
 int32 FSGMessageTracer::GetMessages(TArray<TSharedPtr<FSGMessageTracerMessageInfo>>& OutMessages) const
 {
+	FReadScopeLock Lock(DatabaseLock);
+
 	MessageInfos.GenerateValueArray(OutMessages);
 
 	return OutMessages.Num();
@@ -416,6 +298,8 @@ int32 FSGMessageTracer::GetMessages(TArray<TSharedPtr<FSGMessageTracerMessageInf
 
 int32 FSGMessageTracer::GetMessageTags(TArray<TSharedPtr<FSGMessageTracerTypeInfo>>& OutTypes) const
 {
+	FReadScopeLock Lock(DatabaseLock);
+
 	MessageTags.GenerateValueArray(OutTypes);
 
 	return OutTypes.Num();
@@ -424,6 +308,8 @@ int32 FSGMessageTracer::GetMessageTags(TArray<TSharedPtr<FSGMessageTracerTypeInf
 
 bool FSGMessageTracer::HasMessages() const
 {
+	FReadScopeLock Lock(DatabaseLock);
+
 	return (MessageInfos.Num() > 0);
 }
 
@@ -446,6 +332,12 @@ void FSGMessageTracer::Reset()
 }
 
 
+void FSGMessageTracer::ResetLatencies()
+{
+	LatencyStats->Reset();
+}
+
+
 void FSGMessageTracer::Step()
 {
 	if (!Breaking)
@@ -478,33 +370,457 @@ bool FSGMessageTracer::Tick(float DeltaTime)
 {
 	QUICK_SCOPE_CYCLE_COUNTER(STAT_FSGMessageTracer_Tick);
 
-	if (ResetPending)
+	return ProcessRecords();
+}
+
+
+/* FSGMessageTracer::FProcessor interface
+ *****************************************************************************/
+
+uint32 FSGMessageTracer::FProcessor::Run()
+{
+	while (!Tracer.Stopping)
+	{
+		Tracer.WorkEvent->Wait(SGMessageTracer::ProcessIntervalMs);
+		Tracer.ProcessRecords();
+	}
+
+	return 0;
+}
+
+
+void FSGMessageTracer::FProcessor::Stop()
+{
+	Tracer.Stopping = true;
+	Tracer.WorkEvent->Trigger();
+}
+
+
+/* FSGMessageTracer implementation
+ *****************************************************************************/
+
+void FSGMessageTracer::AddRecord(const FRecord& Record)
+{
+	FRing& Ring = GetThreadRing();
+
+	const uint32 Head = Ring.Head.Load(EMemoryOrder::Relaxed);
+
+	// the oldest unread records are kept, new ones are dropped
+	if (Head - Ring.Tail.Load() >= RingCapacity)
+	{
+		++Ring.NumDropped;
+
+		return;
+	}
+
+	Ring.Records[Head & (RingCapacity - 1)] = Record;
+	Ring.Head = Head + 1;
+}
+
+
+void FSGMessageTracer::ApplyRecord(const FRecord& Record, TArray<FSGMessageTracerMessageInfoRef>& OutMessages,
+                                   TArray<FSGMessageTracerTypeInfoRef>& OutTypes)
+{
+	switch (Record.Type)
+	{
+	case ERecordType::AddedInterceptor:
+		{
+			// create interceptor information
+			auto& InterceptorInfo = Interceptors.FindOrAdd(Record.Id);
+
+			if (!InterceptorInfo.IsValid())
+			{
+				InterceptorInfo = MakeShareable(new FSGMessageTracerInterceptorInfo());
+			}
+
+			// initialize interceptor information
+			InterceptorInfo->Name = Record.Name;
+			InterceptorInfo->TimeRegistered = Record.Timestamp;
+			InterceptorInfo->TimeUnregistered = 0;
+		}
+		break;
+
+	case ERecordType::AddedRecipient:
+		{
+			// create endpoint information
+			TSharedPtr<FSGMessageTracerEndpointInfo>& EndpointInfo = RecipientsToEndpointInfos.FindOrAdd(Record.Id);
+
+			if (!EndpointInfo.IsValid())
+			{
+				EndpointInfo = MakeShareable(new FSGMessageTracerEndpointInfo());
+			}
+
+			// initialize endpoint information
+			const TSharedRef<FSGMessageTracerAddressInfo> AddressInfo = MakeShareable(new FSGMessageTracerAddressInfo());
+			{
+				AddressInfo->Address = Record.Address;
+				AddressInfo->TimeRegistered = Record.Timestamp;
+				AddressInfo->TimeUnregistered = 0;
+			}
+
+			EndpointInfo->AddressInfos.Add(Record.Address, AddressInfo);
+			EndpointInfo->Name = Record.Name;
+			EndpointInfo->Remote = Record.bFlag;
+
+			// add to address table
+			AddressesToEndpointInfos.Add(Record.Address, EndpointInfo);
+		}
+		break;
+
+	case ERecordType::DispatchedMessage:
+		{
+			// look up message & endpoint info
+			const TSharedPtr<FSGMessageTracerMessageInfo> MessageInfo = MessageInfos.FindRef(Record.MessageId);
+			const TSharedPtr<FSGMessageTracerEndpointInfo> EndpointInfo = RecipientsToEndpointInfos.FindRef(Record.Id);
+
+			if (!MessageInfo.IsValid() || !EndpointInfo.IsValid())
+			{
+				break;
+			}
+
+			// update message information
+			const TSharedRef<FSGMessageTracerDispatchState> DispatchState = MakeShareable(
+				new FSGMessageTracerDispatchState());
+			{
+				DispatchState->DispatchLatency = Record.Timestamp - MessageInfo->TimeSent;
+				DispatchState->DispatchType = Record.bFlag
+					                              ? ESGMessageTracerDispatchTypes::TaskGraph
+					                              : ESGMessageTracerDispatchTypes::Direct;
+				DispatchState->EndpointInfo = EndpointInfo;
+				DispatchState->RecipientThread = Record.RecipientThread;
+				DispatchState->TimeDispatched = Record.Timestamp;
+				DispatchState->TimeHandled = 0.0;
+			}
+
+			MessageInfo->DispatchStates.Add(EndpointInfo, DispatchState);
+
+			// update database
+			EndpointInfo->ReceivedMessages.Add(MessageInfo);
+		}
+		break;
+
+	case ERecordType::HandledMessage:
+		{
+			// look up message & endpoint info
+			const TSharedPtr<FSGMessageTracerMessageInfo> MessageInfo = MessageInfos.FindRef(Record.MessageId);
+			const TSharedPtr<FSGMessageTracerEndpointInfo> EndpointInfo = RecipientsToEndpointInfos.FindRef(Record.Id);
+
+			if (!MessageInfo.IsValid() || !EndpointInfo.IsValid())
+			{
+				break;
+			}
+
+			// update message information
+			const TSharedPtr<FSGMessageTracerDispatchState> DispatchState = MessageInfo->DispatchStates.FindRef(
+				EndpointInfo);
+
+			if (DispatchState.IsValid())
+			{
+				DispatchState->TimeHandled = Record.Timestamp;
+			}
+		}
+		break;
+
+	case ERecordType::InterceptedMessage:
+		{
+			// look up message & interceptor info
+			const auto MessageInfo = MessageInfos.FindRef(Record.MessageId);
+
+			if (!MessageInfo.IsValid())
+			{
+				break;
+			}
+
+			MessageInfo->Intercepted = true;
+
+			const auto InterceptorInfo = Interceptors.FindRef(Record.Id);
+
+			if (InterceptorInfo.IsValid())
+			{
+				InterceptorInfo->InterceptedMessages.Add(MessageInfo);
+			}
+		}
+		break;
+
+	case ERecordType::RemovedInterceptor:
+		{
+			const auto InterceptorInfo = Interceptors.FindRef(Record.Id);
+
+			if (InterceptorInfo.IsValid())
+			{
+				InterceptorInfo->TimeUnregistered = Record.Timestamp;
+			}
+		}
+		break;
+
+	case ERecordType::RemovedRecipient:
+		{
+			const TSharedPtr<FSGMessageTracerEndpointInfo> EndpointInfo = AddressesToEndpointInfos.FindRef(
+				Record.Address);
+
+			if (!EndpointInfo.IsValid())
+			{
+				break;
+			}
+
+			// update endpoint information
+			const TSharedPtr<FSGMessageTracerAddressInfo> AddressInfo = EndpointInfo->AddressInfos.FindRef(
+				Record.Address);
+
+			if (AddressInfo.IsValid())
+			{
+				AddressInfo->TimeUnregistered = Record.Timestamp;
+			}
+		}
+		break;
+
+	case ERecordType::RoutedMessage:
+		{
+			// update message information
+			const TSharedPtr<FSGMessageTracerMessageInfo> MessageInfo = MessageInfos.FindRef(Record.MessageId);
+
+			if (MessageInfo.IsValid())
+			{
+				MessageInfo->TimeRouted = Record.Timestamp;
+			}
+		}
+		break;
+
+	case ERecordType::SentMessage:
+		{
+			// look up endpoint info
+			const TSharedPtr<FSGMessageTracerEndpointInfo> EndpointInfo = AddressesToEndpointInfos.FindRef(
+				Record.Address);
+
+			if (!EndpointInfo.IsValid())
+			{
+				break;
+			}
+
+			// create message info, replacing a message whose context was released and whose memory was reused
+			const TSharedRef<FSGMessageTracerMessageInfo> MessageInfo = MakeShareable(
+				new FSGMessageTracerMessageInfo());
+			{
+				MessageInfo->Intercepted = false;
+				MessageInfo->SenderInfo = EndpointInfo;
+				MessageInfo->TimeRouted = 0.0;
+				MessageInfo->TimeSent = Record.Timestamp;
+				MessageInfos.Add(Record.MessageId, MessageInfo);
+				MessageOrder.Emplace(Record.MessageId, MessageInfo);
+			}
+
+			// add message type
+			TSharedPtr<FSGMessageTracerTypeInfo>& TypeInfo = MessageTags.FindOrAdd(Record.MessageTag);
+
+			if (!TypeInfo.IsValid())
+			{
+				TypeInfo = MakeShareable(new FSGMessageTracerTypeInfo());
+				TypeInfo->TypeName = Record.MessageTag;
+
+				OutTypes.Add(TypeInfo.ToSharedRef());
+			}
+
+			TypeInfo->Messages.Add(MessageInfo);
+
+			// update database
+			EndpointInfo->SentMessages.Add(MessageInfo);
+			MessageInfo->TypeInfo = TypeInfo;
+
+			OutMessages.Add(MessageInfo);
+		}
+		break;
+	}
+}
+
+
+void FSGMessageTracer::EvictMessages(const double Now)
+{
+	const double Cutoff = Now - RetentionTime;
+
+	// messages are ordered by the time they were sent
+	int32 NumExpired = 0;
+
+	while ((NumExpired < MessageOrder.Num()) && (MessageOrder[NumExpired].Value->TimeSent < Cutoff))
 	{
-		ResetMessages();
-		ResetPending = false;
+		const auto& MessagePair = MessageOrder[NumExpired];
+
+		if (MessageInfos.FindRef(MessagePair.Key) == MessagePair.Value)
+		{
+			MessageInfos.Remove(MessagePair.Key);
+		}
+
+		++NumExpired;
+	}
+
+	if (NumExpired == 0)
+	{
+		return;
+	}
+
+	MessageOrder.RemoveAt(0, NumExpired);
+
+	// remove the expired messages from the other collections
+	const auto IsExpired = [Cutoff](const TSharedPtr<FSGMessageTracerMessageInfo>& MessageInfo)
+	{
+		return (MessageInfo->TimeSent < Cutoff);
+	};
+
+	for (const auto& EndpointInfoPair : RecipientsToEndpointInfos)
+	{
+		EndpointInfoPair.Value->ReceivedMessages.RemoveAll(IsExpired);
+		EndpointInfoPair.Value->SentMessages.RemoveAll(IsExpired);
+	}
+
+	for (const auto& InterceptorInfoPair : Interceptors)
+	{
+		InterceptorInfoPair.Value->InterceptedMessages.RemoveAll(IsExpired);
+	}
+
+	for (const auto& TypeInfoPair : MessageTags)
+	{
+		TypeInfoPair.Value->Messages.RemoveAll(IsExpired);
+	}
+}
+
+
+FSGMessageTracer::FRing& FSGMessageTracer::GetThreadRing()
+{
+	// the ring that this thread last wrote to, tagged with the serial number of its tracer
+	static thread_local TPair<uint64, FRing*> CachedRing(0, nullptr);
+
+	if (CachedRing.Key == Serial)
+	{
+		return *CachedRing.Value;
 	}
 
-	// process new traces
-	if (!Traces.IsEmpty())
+	const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+	FRing* Ring = nullptr;
 	{
-		TFunction<void()> Trace;
+		FReadScopeLock Lock(RingsLock);
 
-		while (Traces.Dequeue(Trace))
+		if (const auto FoundRing = Rings.Find(ThreadId))
 		{
-			Trace();
+			Ring = FoundRing->Get();
 		}
 	}
 
-	return true;
+	if (Ring == nullptr)
+	{
+		auto NewRing = MakeUnique<FRing>(RingCapacity);
+		Ring = NewRing.Get();
+
+		FWriteScopeLock Lock(RingsLock);
+		Rings.Add(ThreadId, MoveTemp(NewRing));
+	}
+
+	CachedRing = MakeTuple(Serial, Ring);
+
+	return *Ring;
 }
 
 
-/* FSGMessageTracer implementation
- *****************************************************************************/
+FSGMessageTracer::FRecord FSGMessageTracer::MakeRecord(const ERecordType Type)
+{
+	FRecord Record{};
+	{
+		Record.Timestamp = FPlatformTime::Seconds();
+		Record.Type = Type;
+	}
+
+	return Record;
+}
+
+
+bool FSGMessageTracer::ProcessRecords()
+{
+	FScopeLock ProcessScope(&ProcessLock);
+
+	const bool bReset = ResetPending.Exchange(false);
+
+	// collect the records of all threads
+	Batch.Reset();
+	{
+		FReadScopeLock Lock(RingsLock);
+
+		for (const auto& RingPair : Rings)
+		{
+			FRing& Ring = *RingPair.Value;
+
+			const uint32 Tail = Ring.Tail.Load(EMemoryOrder::Relaxed);
+			const uint32 Head = Ring.Head.Load();
+
+			for (uint32 Index = Tail; Index != Head; ++Index)
+			{
+				Batch.Add(Ring.Records[Index & (RingCapacity - 1)]);
+			}
+
+			Ring.Tail = Head;
+			NumDroppedRecords += Ring.NumDropped.Exchange(0);
+		}
+	}
+
+	// the records of different threads are merged by time
+	Batch.StableSort([](const FRecord& A, const FRecord& B)
+	{
+		return (A.Timestamp < B.Timestamp);
+	});
+
+	TArray<FSGMessageTracerMessageInfoRef> AddedMessages;
+	TArray<FSGMessageTracerTypeInfoRef> AddedTypes;
+	const double Now = FPlatformTime::Seconds();
+	const bool bEvict = (Now - LastEvictionTime >= SGMessageTracer::EvictionInterval);
+	{
+		FWriteScopeLock Lock(DatabaseLock);
+
+		if (bReset)
+		{
+			ResetMessages();
+		}
+
+		for (const FRecord& Record : Batch)
+		{
+			ApplyRecord(Record, AddedMessages, AddedTypes);
+		}
+
+		if (bEvict)
+		{
+			EvictMessages(Now);
+			LastEvictionTime = Now;
+		}
+	}
+
+	if (bEvict && (NumDroppedRecords > 0))
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("Message tracer dropped %u records, because a thread ring was full"),
+		       NumDroppedRecords);
+
+		NumDroppedRecords = 0;
+	}
+
+	// delegates are executed without holding the database lock
+	if (bReset)
+	{
+		MessagesResetDelegate.Broadcast();
+	}
+
+	for (const auto& TypeInfo : AddedTypes)
+	{
+		TypeAddedDelegate.Broadcast(TypeInfo);
+	}
+
+	for (const auto& MessageInfo : AddedMessages)
+	{
+		MessagesAddedDelegate.Broadcast(MessageInfo);
+	}
+
+	return (Batch.Num() > 0);
+}
+
 
 void FSGMessageTracer::ResetMessages()
 {
 	MessageInfos.Reset();
+	MessageOrder.Reset();
 	MessageTags.Reset();
 
 	for (auto& EndpointInfoPair : AddressesToEndpointInfos)
@@ -516,7 +832,10 @@ void FSGMessageTracer::ResetMessages()
 		}
 	}
 
-	MessagesResetDelegate.Broadcast();
+	for (auto& InterceptorInfoPair : Interceptors)
+	{
+		InterceptorInfoPair.Value->InterceptedMessages.Reset();
+	}
 }
 
 
@@ -0,0 +1,166 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Bus/SGMessagingStats.h"
+
+DEFINE_STAT(STAT_SGMessaging_ProcessCommands);
+DEFINE_STAT(STAT_SGMessaging_DispatchMessage);
+DEFINE_STAT(STAT_SGMessaging_FilterSubscriptions);
+DEFINE_STAT(STAT_SGMessaging_ProcessInbox);
+DEFINE_STAT(STAT_SGMessaging_MessagesSent);
+DEFINE_STAT(STAT_SGMessaging_MessagesDispatched);
+DEFINE_STAT(STAT_SGMessaging_DispatchLatency);
+DEFINE_STAT(STAT_SGMessaging_RouterQueueDepth);
+DEFINE_STAT(STAT_SGMessaging_DelayedMessages);
+DEFINE_STAT(STAT_SGMessaging_InboxMessages);
+
+CSV_DEFINE_CATEGORY_MODULE(SGMESSAGING_API, SGMessaging, true);
+
+
+namespace SGMessagingStats
+{
+	/** Structure for the receivers whose inboxes are sampled. */
+	struct FInboxes
+	{
+		/** Holds the receivers. */
+		TSet<const ISGMessageReceiver*> Receivers;
+
+		/** Protects the receivers. */
+		FCriticalSection Lock;
+
+		/** Gets the process-wide instance. */
+		static FInboxes& Get()
+		{
+			static FInboxes Inboxes;
+
+			return Inboxes;
+		}
+	};
+}
+
+
+/* FSGMessagingStats static interface
+ *****************************************************************************/
+
+void FSGMessagingStats::AddInbox(const ISGMessageReceiver& Receiver)
+{
+	auto& Inboxes = SGMessagingStats::FInboxes::Get();
+	FScopeLock Lock(&Inboxes.Lock);
+
+	Inboxes.Receivers.Add(&Receiver);
+}
+
+
+void FSGMessagingStats::RemoveInbox(const ISGMessageReceiver& Receiver)
+{
+	auto& Inboxes = SGMessagingStats::FInboxes::Get();
+	FScopeLock Lock(&Inboxes.Lock);
+
+	Inboxes.Receivers.Remove(&Receiver);
+}
+
+
+/* FSGMessagingStats interface
+ *****************************************************************************/
+
+void FSGMessagingStats::Update(const TArray<TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>>& Buses)
+{
+	const double CurrentTime = FPlatformTime::Seconds();
+	const double ElapsedTime = CurrentTime - LastUpdateTime;
+	const bool bHasRates = (LastUpdateTime > 0.0) && (ElapsedTime > 0.0);
+
+	LastUpdateTime = CurrentTime;
+
+	TMap<FString, FBusSample> NewSamples;
+	NewSamples.Reserve(Buses.Num());
+
+	double TotalSentRate = 0.0;
+	double TotalHandledRate = 0.0;
+	int64 TotalHandled = 0;
+	int64 TotalDispatchLatency = 0;
+	int32 TotalQueuedCommands = 0;
+	int32 TotalDelayed = 0;
+
+	for (const auto& Bus : Buses)
+	{
+		const FString& BusName = Bus->GetName();
+		FBusSample Sample;
+
+		// buses that were not sampled before only get rates from the next update on
+		if (FBusSample* PreviousSample = Samples.Find(BusName))
+		{
+			Sample = MoveTemp(*PreviousSample);
+		}
+		else
+		{
+			Sample.SentStatName = FName(*FString::Printf(TEXT("%s_SentPerSecond"), *BusName));
+			Sample.DispatchedStatName = FName(*FString::Printf(TEXT("%s_DispatchedPerSecond"), *BusName));
+			Sample.LatencyStatName = FName(*FString::Printf(TEXT("%s_DispatchLatencyUs"), *BusName));
+			Sample.QueueDepthStatName = FName(*FString::Printf(TEXT("%s_RouterQueueDepth"), *BusName));
+			Sample.DelayedStatName = FName(*FString::Printf(TEXT("%s_DelayedMessages"), *BusName));
+			Sample.Stats = Bus->GetStats();
+		}
+
+		const FSGMessageBusStats Stats = Bus->GetStats();
+		const int64 NumSent = Stats.NumSent - Sample.Stats.NumSent;
+		const int64 NumHandled = Stats.NumHandled - Sample.Stats.NumHandled;
+		const int64 DispatchLatency = Stats.TotalDispatchLatency - Sample.Stats.TotalDispatchLatency;
+
+		const double SentRate = bHasRates ? (NumSent / ElapsedTime) : 0.0;
+		const double HandledRate = bHasRates ? (NumHandled / ElapsedTime) : 0.0;
+
+		TotalSentRate += SentRate;
+		TotalHandledRate += HandledRate;
+		TotalHandled += NumHandled;
+		TotalDispatchLatency += DispatchLatency;
+		TotalQueuedCommands += Stats.NumQueuedCommands;
+		TotalDelayed += Stats.NumDelayed;
+
+#if CSV_PROFILER
+		const uint32 CategoryIndex = CSV_CATEGORY_INDEX(SGMessaging);
+
+		FCsvProfiler::RecordCustomStat(Sample.SentStatName, CategoryIndex, static_cast<float>(SentRate),
+		                               ECsvCustomStatOp::Set);
+		FCsvProfiler::RecordCustomStat(Sample.DispatchedStatName, CategoryIndex, static_cast<float>(HandledRate),
+		                               ECsvCustomStatOp::Set);
+		FCsvProfiler::RecordCustomStat(Sample.LatencyStatName, CategoryIndex,
+		                               (NumHandled > 0) ? static_cast<float>(DispatchLatency) / NumHandled : 0.0f,
+		                               ECsvCustomStatOp::Set);
+		FCsvProfiler::RecordCustomStat(Sample.QueueDepthStatName, CategoryIndex, Stats.NumQueuedCommands,
+		                               ECsvCustomStatOp::Set);
+		FCsvProfiler::RecordCustomStat(Sample.DelayedStatName, CategoryIndex, Stats.NumDelayed,
+		                               ECsvCustomStatOp::Set);
+#endif
+
+		Sample.Stats = Stats;
+		NewSamples.Add(BusName, MoveTemp(Sample));
+	}
+
+	// forget buses that were shut down
+	Samples = MoveTemp(NewSamples);
+
+	const float DispatchLatency = (TotalHandled > 0) ? static_cast<float>(TotalDispatchLatency) / TotalHandled : 0.0f;
+	int32 NumInbox = 0;
+	{
+		auto& Inboxes = SGMessagingStats::FInboxes::Get();
+		FScopeLock Lock(&Inboxes.Lock);
+
+		for (const ISGMessageReceiver* Receiver : Inboxes.Receivers)
+		{
+			NumInbox += FMath::Max(0, Receiver->GetNumInboxMessages());
+		}
+	}
+
+	SET_FLOAT_STAT(STAT_SGMessaging_MessagesSent, TotalSentRate);
+	SET_FLOAT_STAT(STAT_SGMessaging_MessagesDispatched, TotalHandledRate);
+	SET_FLOAT_STAT(STAT_SGMessaging_DispatchLatency, DispatchLatency);
+	SET_DWORD_STAT(STAT_SGMessaging_RouterQueueDepth, TotalQueuedCommands);
+	SET_DWORD_STAT(STAT_SGMessaging_DelayedMessages, TotalDelayed);
+	SET_DWORD_STAT(STAT_SGMessaging_InboxMessages, NumInbox);
+
+	CSV_CUSTOM_STAT(SGMessaging, SentPerSecond, static_cast<float>(TotalSentRate), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(SGMessaging, DispatchedPerSecond, static_cast<float>(TotalHandledRate), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(SGMessaging, DispatchLatencyUs, DispatchLatency, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(SGMessaging, RouterQueueDepth, TotalQueuedCommands, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(SGMessaging, DelayedMessages, TotalDelayed, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(SGMessaging, InboxMessages, NumInbox, ECsvCustomStatOp::Set);
+}
@@ -0,0 +1,207 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Bus/SGMessagingTrace.h"
+
+#if SG_MESSAGING_INSIGHTS_ENABLED
+
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "UObject/NameTypes.h"
+#include "Core/Interface/ISGMessageContext.h"
+#include "Core/Interface/ISGMessageReceiver.h"
+
+
+UE_TRACE_CHANNEL_DEFINE(SGMessagingChannel)
+
+UE_TRACE_EVENT_BEGIN(SGMessaging, MessageSent)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, MessageId)
+	UE_TRACE_EVENT_FIELD(uint64, Sender)
+	UE_TRACE_EVENT_FIELD(uint32, NumRecipients)
+	UE_TRACE_EVENT_FIELD(uint32, QueueDepth)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, MessageTag)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(SGMessaging, MessageRouted)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, MessageId)
+	UE_TRACE_EVENT_FIELD(uint64, Sender)
+	UE_TRACE_EVENT_FIELD(uint32, QueueDepth)
+	UE_TRACE_EVENT_FIELD(int64, LatencyUs)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, MessageTag)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(SGMessaging, MessageIntercepted)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, MessageId)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, MessageTag)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Interceptor)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(SGMessaging, MessageDispatched)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, MessageId)
+	UE_TRACE_EVENT_FIELD(bool, Async)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, MessageTag)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Recipient)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(SGMessaging, MessageHandled)
+	UE_TRACE_EVENT_FIELD(uint64, StartCycle)
+	UE_TRACE_EVENT_FIELD(uint64, EndCycle)
+	UE_TRACE_EVENT_FIELD(uint64, MessageId)
+	UE_TRACE_EVENT_FIELD(int64, LatencyUs)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, MessageTag)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Recipient)
+UE_TRACE_EVENT_END()
+
+
+namespace SGMessagingTrace
+{
+	/** Implements a name that is converted to a string on the stack. */
+	struct FNameString
+	{
+		explicit FNameString(const FName& Name)
+		{
+			Length = Name.ToString(Buffer, NAME_SIZE);
+		}
+
+		TCHAR Buffer[NAME_SIZE];
+		uint32 Length;
+	};
+
+	/** Gets the identifier of a message, which is the address of its context. */
+	uint64 GetMessageId(const ISGMessageContext& Context)
+	{
+		return static_cast<uint64>(reinterpret_cast<UPTRINT>(&Context));
+	}
+
+	/** Gets the 64-bit handle of a message address. */
+	uint64 GetAddressHandle(const FSGMessageAddress& Address)
+	{
+		return (static_cast<uint64>(Address.GetNode()) << 32) | Address.GetIndex();
+	}
+
+	/** Gets the time that passed since a message was sent, in microseconds. */
+	int64 GetLatencyUs(const ISGMessageContext& Context, const FDateTime& CurrentTime)
+	{
+		return static_cast<int64>((CurrentTime - Context.GetTimeSent()).GetTotalMicroseconds());
+	}
+}
+
+
+/* FSGMessagingTrace interface
+ *****************************************************************************/
+
+void FSGMessagingTrace::OutputSend(const ISGMessageContext& Context, const int32 QueueDepth)
+{
+	const SGMessagingTrace::FNameString MessageTag(Context.GetMessageTag());
+
+	UE_TRACE_LOG(SGMessaging, MessageSent, SGMessagingChannel)
+		<< MessageSent.Cycle(FPlatformTime::Cycles64())
+		<< MessageSent.MessageId(SGMessagingTrace::GetMessageId(Context))
+		<< MessageSent.Sender(SGMessagingTrace::GetAddressHandle(Context.GetSender()))
+		<< MessageSent.NumRecipients(Context.GetRecipients().Num())
+		<< MessageSent.QueueDepth(QueueDepth)
+		<< MessageSent.MessageTag(MessageTag.Buffer, MessageTag.Length);
+}
+
+
+void FSGMessagingTrace::OutputRoute(const ISGMessageContext& Context, const int32 QueueDepth,
+                                    const FDateTime& CurrentTime)
+{
+	const SGMessagingTrace::FNameString MessageTag(Context.GetMessageTag());
+
+	UE_TRACE_LOG(SGMessaging, MessageRouted, SGMessagingChannel)
+		<< MessageRouted.Cycle(FPlatformTime::Cycles64())
+		<< MessageRouted.MessageId(SGMessagingTrace::GetMessageId(Context))
+		<< MessageRouted.Sender(SGMessagingTrace::GetAddressHandle(Context.GetSender()))
+		<< MessageRouted.QueueDepth(QueueDepth)
+		<< MessageRouted.LatencyUs(SGMessagingTrace::GetLatencyUs(Context, CurrentTime))
+		<< MessageRouted.MessageTag(MessageTag.Buffer, MessageTag.Length);
+}
+
+
+void FSGMessagingTrace::OutputIntercept(const ISGMessageContext& Context, const FName& InterceptorName)
+{
+	const SGMessagingTrace::FNameString MessageTag(Context.GetMessageTag());
+	const SGMessagingTrace::FNameString Interceptor(InterceptorName);
+
+	UE_TRACE_LOG(SGMessaging, MessageIntercepted, SGMessagingChannel)
+		<< MessageIntercepted.Cycle(FPlatformTime::Cycles64())
+		<< MessageIntercepted.MessageId(SGMessagingTrace::GetMessageId(Context))
+		<< MessageIntercepted.MessageTag(MessageTag.Buffer, MessageTag.Length)
+		<< MessageIntercepted.Interceptor(Interceptor.Buffer, Interceptor.Length);
+}
+
+
+void FSGMessagingTrace::OutputDispatch(const ISGMessageContext& Context, const ISGMessageReceiver& Recipient,
+                                       const bool bAsync)
+{
+	const SGMessagingTrace::FNameString MessageTag(Context.GetMessageTag());
+	const SGMessagingTrace::FNameString RecipientName(Recipient.GetDebugName());
+
+	UE_TRACE_LOG(SGMessaging, MessageDispatched, SGMessagingChannel)
+		<< MessageDispatched.Cycle(FPlatformTime::Cycles64())
+		<< MessageDispatched.MessageId(SGMessagingTrace::GetMessageId(Context))
+		<< MessageDispatched.Async(bAsync)
+		<< MessageDispatched.MessageTag(MessageTag.Buffer, MessageTag.Length)
+		<< MessageDispatched.Recipient(RecipientName.Buffer, RecipientName.Length);
+}
+
+
+/* FSGMessagingTrace::FHandleScope structors
+ *****************************************************************************/
+
+FSGMessagingTrace::FHandleScope::FHandleScope(const ISGMessageContext& InContext,
+                                              const ISGMessageReceiver& InRecipient)
+	: Context(nullptr)
+	  , Recipient(&InRecipient)
+	  , StartCycle(0)
+	  , bCpuScope(false)
+{
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(SGMessagingChannel))
+	{
+		return;
+	}
+
+	Context = &InContext;
+	StartCycle = FPlatformTime::Cycles64();
+
+	// name the CPU scope after the message tag, so handlers line up with frame timing in the timeline
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel))
+	{
+		const SGMessagingTrace::FNameString MessageTag(InContext.GetMessageTag());
+
+		FCpuProfilerTrace::OutputBeginDynamicEvent(MessageTag.Buffer);
+		bCpuScope = true;
+	}
+}
+
+
+FSGMessagingTrace::FHandleScope::~FHandleScope()
+{
+	if (bCpuScope)
+	{
+		FCpuProfilerTrace::OutputEndEvent();
+	}
+
+	if (Context == nullptr)
+	{
+		return;
+	}
+
+	const SGMessagingTrace::FNameString MessageTag(Context->GetMessageTag());
+	const SGMessagingTrace::FNameString RecipientName(Recipient->GetDebugName());
+
+	UE_TRACE_LOG(SGMessaging, MessageHandled, SGMessagingChannel)
+		<< MessageHandled.StartCycle(StartCycle)
+		<< MessageHandled.EndCycle(FPlatformTime::Cycles64())
+		<< MessageHandled.MessageId(SGMessagingTrace::GetMessageId(*Context))
+		<< MessageHandled.LatencyUs(SGMessagingTrace::GetLatencyUs(*Context, FDateTime::UtcNow()))
+		<< MessageHandled.MessageTag(MessageTag.Buffer, MessageTag.Length)
+		<< MessageHandled.Recipient(RecipientName.Buffer, RecipientName.Length);
+}
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Common/SGArchiveAttachmentReader.h"
+#include "Serialization/Archive.h"
+
+
+/* FSGArchiveAttachmentReader structors
+ *****************************************************************************/
+
+FSGArchiveAttachmentReader::FSGArchiveAttachmentReader(TUniquePtr<FArchive>&& InArchive)
+	: Archive(MoveTemp(InArchive))
+	  , TotalSize(Archive.IsValid() ? Archive->TotalSize() : 0)
+{
+}
+
+
+/* ISGMessageAttachmentReader interface
+ *****************************************************************************/
+
+int64 FSGArchiveAttachmentReader::GetSize() const
+{
+	return TotalSize;
+}
+
+
+FMemoryView FSGArchiveAttachmentReader::ReadChunk(const int64 Offset, const int64 Size)
+{
+	const auto ChunkSize = FMath::Min(Size, TotalSize - Offset);
+
+	if (!Archive.IsValid() || (Offset < 0) || (ChunkSize <= 0) || (ChunkSize > MAX_int32))
+	{
+		return FMemoryView();
+	}
+
+	Buffer.SetNumUninitialized(static_cast<int32>(ChunkSize), false);
+
+	if (Archive->Tell() != Offset)
+	{
+		Archive->Seek(Offset);
+	}
+
+	Archive->Serialize(Buffer.GetData(), ChunkSize);
+
+	if (Archive->IsError())
+	{
+		return FMemoryView();
+	}
+
+	return MakeMemoryView(Buffer);
+}
+
+
+void FSGArchiveAttachmentReader::Prefetch(const int64 Offset, const int64 Size)
+{
+	const auto ChunkSize = FMath::Min(Size, TotalSize - Offset);
+
+	if (Archive.IsValid() && (Offset >= 0) && (ChunkSize > 0))
+	{
+		Archive->Precache(Offset, ChunkSize);
+	}
+}
+
+
+/* ISGMessageAttachment interface
+ *****************************************************************************/
+
+TUniquePtr<ISGMessageAttachmentReader> ISGMessageAttachment::CreateChunkReader()
+{
+	TUniquePtr<FArchive> Archive(CreateReader());
+
+	if (!Archive.IsValid())
+	{
+		return nullptr;
+	}
+
+	return MakeUnique<FSGArchiveAttachmentReader>(MoveTemp(Archive));
+}
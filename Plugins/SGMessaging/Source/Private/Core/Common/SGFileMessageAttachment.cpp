@@ -0,0 +1,19 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Common/SGFileMessageAttachment.h"
+#include "Core/Common/SGMappedFileAttachmentReader.h"
+
+
+/* ISGMessageAttachment interface
+ *****************************************************************************/
+
+TUniquePtr<ISGMessageAttachmentReader> FSGFileMessageAttachment::CreateChunkReader()
+{
+	if (auto MappedReader = FSGMappedFileAttachmentReader::Open(Filename))
+	{
+		return MoveTemp(MappedReader);
+	}
+
+	// fall back to file reads on platforms that cannot map files
+	return ISGMessageAttachment::CreateChunkReader();
+}
@@ -0,0 +1,104 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Common/SGMappedFileAttachmentReader.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+
+
+/* FSGMappedFileAttachmentReader structors
+ *****************************************************************************/
+
+FSGMappedFileAttachmentReader::FSGMappedFileAttachmentReader(IMappedFileHandle* InHandle)
+	: Handle(InHandle)
+	  , Region(nullptr)
+	  , PrefetchRegion(nullptr)
+	  , PrefetchOffset(0)
+	  , PrefetchSize(0)
+{
+}
+
+
+FSGMappedFileAttachmentReader::~FSGMappedFileAttachmentReader()
+{
+	// regions must be released before their file
+	delete Region;
+	delete PrefetchRegion;
+	delete Handle;
+}
+
+
+TUniquePtr<FSGMappedFileAttachmentReader> FSGMappedFileAttachmentReader::Open(const FString& Filename)
+{
+	IMappedFileHandle* Handle = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename);
+
+	if (Handle == nullptr)
+	{
+		return nullptr;
+	}
+
+	return TUniquePtr<FSGMappedFileAttachmentReader>(new FSGMappedFileAttachmentReader(Handle));
+}
+
+
+/* ISGMessageAttachmentReader interface
+ *****************************************************************************/
+
+int64 FSGMappedFileAttachmentReader::GetSize() const
+{
+	return Handle->GetFileSize();
+}
+
+
+FMemoryView FSGMappedFileAttachmentReader::ReadChunk(const int64 Offset, const int64 Size)
+{
+	const auto ChunkSize = FMath::Min(Size, GetSize() - Offset);
+
+	if ((Offset < 0) || (ChunkSize <= 0))
+	{
+		return FMemoryView();
+	}
+
+	delete Region;
+	Region = nullptr;
+
+	// take over the prefetched region if it is the one being read
+	if ((PrefetchRegion != nullptr) && (PrefetchOffset == Offset) && (PrefetchSize == ChunkSize))
+	{
+		Region = PrefetchRegion;
+		PrefetchRegion = nullptr;
+	}
+	else
+	{
+		Region = Handle->MapRegion(Offset, ChunkSize, false);
+	}
+
+	if (Region == nullptr)
+	{
+		return FMemoryView();
+	}
+
+	return FMemoryView(Region->GetMappedPtr(), Region->GetMappedSize());
+}
+
+
+void FSGMappedFileAttachmentReader::Prefetch(const int64 Offset, const int64 Size)
+{
+	const auto ChunkSize = FMath::Min(Size, GetSize() - Offset);
+
+	if ((Offset < 0) || (ChunkSize <= 0))
+	{
+		return;
+	}
+
+	if ((PrefetchRegion != nullptr) && (PrefetchOffset == Offset) && (PrefetchSize == ChunkSize))
+	{
+		return;
+	}
+
+	delete PrefetchRegion;
+
+	PrefetchRegion = Handle->MapRegion(Offset, ChunkSize, true);
+	PrefetchOffset = Offset;
+	PrefetchSize = ChunkSize;
+}
+
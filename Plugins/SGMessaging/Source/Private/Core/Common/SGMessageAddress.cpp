@@ -0,0 +1,333 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Common/SGMessageAddress.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Containers/Map.h"
+#include "Containers/Queue.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+#include "Templates/Atomic.h"
+
+
+namespace SGMessageAddress
+{
+	/** Structure for the upper 96 bits of an address GUID, which identify its node. */
+	struct FNodePrefix
+	{
+		uint32 A;
+		uint32 B;
+		uint32 C;
+
+		friend bool operator==(const FNodePrefix& X, const FNodePrefix& Y)
+		{
+			return (X.A == Y.A) && (X.B == Y.B) && (X.C == Y.C);
+		}
+
+		friend uint32 GetTypeHash(const FNodePrefix& Prefix)
+		{
+			return HashCombineFast(HashCombineFast(Prefix.A, Prefix.B), Prefix.C);
+		}
+	};
+
+	/** The number of node prefixes per chunk of the node table. */
+	constexpr uint32 NodesPerChunk = 1024;
+
+	/** The maximum number of chunks in the node table. */
+	constexpr uint32 MaxChunks = 64;
+
+	/** The mask of the slot bits of an index. */
+	constexpr uint32 SlotMask = (1u << FSGMessageAddress::SlotBits) - 1;
+
+
+	/** Structure for a node in the node table. */
+	struct FNodeEntry
+	{
+		/** Holds the node number. */
+		uint32 Node;
+
+		/** Holds the number of times that the node was added and not removed yet. */
+		int32 NumReferences;
+	};
+
+
+	/**
+	 * Implements the process-wide table of node prefixes and the allocator of local address slots.
+	 *
+	 * Node 0 is the all-zero prefix, so that the invalid GUID maps to the invalid address, and node 1 is this
+	 * process. Other prefixes are only resolved while their node is added. Removed nodes keep their entry, so
+	 * that existing copies of their addresses still convert to the right GUID and nodes that are added again
+	 * get their old number back. The table is therefore append-only and stored in chunks that do not move,
+	 * which allows converting addresses to GUIDs without a lock.
+	 *
+	 * Released slots are reused in FIFO order with a new generation. A slot whose generation is exhausted is
+	 * retired instead of wrapping around, so that stale copies of an address never match a later owner.
+	 */
+	class FRegistry
+	{
+	public:
+		/** Gets the process-wide registry. */
+		static FRegistry& Get()
+		{
+			static FRegistry Registry;
+
+			return Registry;
+		}
+
+		/** Default constructor. */
+		FRegistry()
+			: NumNodes(0)
+			  , NextSlot(0)
+		{
+			for (auto& Chunk : Chunks)
+			{
+				Chunk = nullptr;
+			}
+
+			const auto ProcessId = FGuid::NewGuid();
+
+			LocalPrefix = FNodePrefix{ProcessId.A, ProcessId.B, ProcessId.C};
+
+			AppendNode(FNodePrefix{0, 0, 0});
+			AppendNode(LocalPrefix);
+		}
+
+		/** Destructor. */
+		~FRegistry()
+		{
+			for (auto& Chunk : Chunks)
+			{
+				delete[] Chunk.Load();
+			}
+		}
+
+	public:
+		/** Gets the node number of a prefix, or 0 if the node was not added. */
+		uint32 FindNode(const FNodePrefix& Prefix)
+		{
+			if (Prefix == LocalPrefix)
+			{
+				return FSGMessageAddress::LocalNode;
+			}
+
+			FReadScopeLock Lock(NodesLock);
+
+			const auto Entry = Nodes.Find(Prefix);
+
+			return (Entry != nullptr) && (Entry->NumReferences > 0) ? Entry->Node : 0;
+		}
+
+		/** Adds a reference to the node of a prefix. */
+		bool AddNode(const FNodePrefix& Prefix)
+		{
+			if ((Prefix == LocalPrefix) || (Prefix == FNodePrefix{0, 0, 0}))
+			{
+				return true;
+			}
+
+			FWriteScopeLock Lock(NodesLock);
+
+			if (const auto Entry = Nodes.Find(Prefix))
+			{
+				++Entry->NumReferences;
+
+				return true;
+			}
+
+			const auto Node = AppendNode(Prefix);
+
+			if (Node == 0)
+			{
+				return false;
+			}
+
+			Nodes.Add(Prefix, FNodeEntry{Node, 1});
+
+			return true;
+		}
+
+		/** Removes a reference to the node of a prefix. */
+		void RemoveNode(const FNodePrefix& Prefix)
+		{
+			FWriteScopeLock Lock(NodesLock);
+
+			if (const auto Entry = Nodes.Find(Prefix))
+			{
+				Entry->NumReferences = FMath::Max(Entry->NumReferences - 1, 0);
+			}
+		}
+
+		/** Creates a transport node identifier whose prefix is the prefix of this process. */
+		FGuid NewNodeId() const
+		{
+			return FGuid(LocalPrefix.A, LocalPrefix.B, LocalPrefix.C, FGuid::NewGuid().D);
+		}
+
+		/** Gets the prefix of a node number. */
+		FNodePrefix GetPrefix(const uint32 Node) const
+		{
+			if (Node >= static_cast<uint32>(NumNodes))
+			{
+				return FNodePrefix{0, 0, 0};
+			}
+
+			return Chunks[Node / NodesPerChunk].Load()[Node % NodesPerChunk];
+		}
+
+		/** Allocates the index of a new local address. */
+		uint32 AllocateIndex()
+		{
+			FScopeLock Lock(&SlotsLock);
+
+			uint32 Slot;
+
+			if (!FreeSlots.Dequeue(Slot))
+			{
+				checkf(NextSlot <= SlotMask, TEXT("Too many message addresses were created or are in use"));
+
+				Slot = NextSlot++;
+				Generations.Add(0);
+			}
+
+			return (static_cast<uint32>(Generations[Slot]) << FSGMessageAddress::SlotBits) | Slot;
+		}
+
+		/** Releases the index of a local address. */
+		void ReleaseIndex(const uint32 Index)
+		{
+			const auto Slot = Index & SlotMask;
+			const auto Generation = static_cast<uint8>(Index >> FSGMessageAddress::SlotBits);
+
+			FScopeLock Lock(&SlotsLock);
+
+			// ignore addresses that were already released
+			if ((Slot < NextSlot) && (Generations[Slot] == Generation) && (Generation != MAX_uint8))
+			{
+				++Generations[Slot];
+				FreeSlots.Enqueue(Slot);
+			}
+		}
+
+	private:
+		/**
+		 * Appends a prefix to the node table. Must be called with the write lock held, or from the constructor.
+		 *
+		 * @return The node number, or 0 if the table is full.
+		 */
+		uint32 AppendNode(const FNodePrefix& Prefix)
+		{
+			const uint32 Node = NumNodes;
+			const auto ChunkIndex = Node / NodesPerChunk;
+
+			if (ChunkIndex >= MaxChunks)
+			{
+				UE_LOG(LogSGMessaging, Error, TEXT("Too many message nodes, ignoring node %08X%08X%08X"), Prefix.A,
+				       Prefix.B, Prefix.C);
+
+				return 0;
+			}
+
+			if (Chunks[ChunkIndex].Load() == nullptr)
+			{
+				Chunks[ChunkIndex] = new FNodePrefix[NodesPerChunk];
+			}
+
+			Chunks[ChunkIndex].Load()[Node % NodesPerChunk] = Prefix;
+
+			// publish the prefix only after it was written
+			NumNodes = Node + 1;
+
+			return Node;
+		}
+
+	private:
+		/** Holds the prefix of this process. */
+		FNodePrefix LocalPrefix;
+
+		/** Holds the chunks of the node table. */
+		TAtomic<FNodePrefix*> Chunks[MaxChunks];
+
+		/** Holds the number of nodes in the table. */
+		TAtomic<int32> NumNodes;
+
+		/** Maps prefixes to the nodes that were added. */
+		TMap<FNodePrefix, FNodeEntry> Nodes;
+
+		/** Protects the nodes. */
+		FRWLock NodesLock;
+
+		/** Holds the current generation of each local slot. */
+		TArray<uint8> Generations;
+
+		/** Holds the released slots. */
+		TQueue<uint32> FreeSlots;
+
+		/** Holds the next slot that was never used. */
+		uint32 NextSlot;
+
+		/** Protects the slot allocator. */
+		FCriticalSection SlotsLock;
+	};
+}
+
+
+/* FSGMessageAddress interface
+ *****************************************************************************/
+
+FGuid FSGMessageAddress::ToGuid() const
+{
+	const auto Prefix = SGMessageAddress::FRegistry::Get().GetPrefix(GetNode());
+
+	return FGuid(Prefix.A, Prefix.B, Prefix.C, GetIndex());
+}
+
+
+FSGMessageAddress FSGMessageAddress::NewAddress()
+{
+	FSGMessageAddress Result;
+	Result.Value = (static_cast<uint64>(LocalNode) << 32) | SGMessageAddress::FRegistry::Get().AllocateIndex();
+
+	return Result;
+}
+
+
+void FSGMessageAddress::Release(const FSGMessageAddress& Address)
+{
+	if (Address.IsLocal())
+	{
+		SGMessageAddress::FRegistry::Get().ReleaseIndex(Address.GetIndex());
+	}
+}
+
+
+FSGMessageAddress FSGMessageAddress::FromGuid(const FGuid& Guid)
+{
+	const auto Node = SGMessageAddress::FRegistry::Get().FindNode(
+		SGMessageAddress::FNodePrefix{Guid.A, Guid.B, Guid.C});
+
+	FSGMessageAddress Result;
+
+	if (Node != 0)
+	{
+		Result.Value = (static_cast<uint64>(Node) << 32) | Guid.D;
+	}
+
+	return Result;
+}
+
+
+FGuid FSGMessageAddress::NewNodeId()
+{
+	return SGMessageAddress::FRegistry::Get().NewNodeId();
+}
+
+
+bool FSGMessageAddress::AddNode(const FGuid& NodeId)
+{
+	return SGMessageAddress::FRegistry::Get().AddNode(SGMessageAddress::FNodePrefix{NodeId.A, NodeId.B, NodeId.C});
+}
+
+
+void FSGMessageAddress::RemoveNode(const FGuid& NodeId)
+{
+	SGMessageAddress::FRegistry::Get().RemoveNode(SGMessageAddress::FNodePrefix{NodeId.A, NodeId.B, NodeId.C});
+}
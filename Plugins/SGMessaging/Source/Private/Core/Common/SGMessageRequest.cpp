@@ -0,0 +1,213 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Common/SGMessageRequest.h"
+#include "Misc/ScopeLock.h"
+
+
+const FName FSGMessageRequestTable::RequestIdKey(TEXT("SG.RequestId"));
+const FName FSGMessageRequestTable::ReplyIdKey(TEXT("SG.ReplyId"));
+const FName FSGMessageRequestTable::TimeoutTag(TEXT("SGMessaging.RequestTimeout"));
+
+
+/* FSGMessageRequestTable structors
+ *****************************************************************************/
+
+FSGMessageRequestTable::FSGMessageRequestTable()
+	: NumPending(0)
+{
+}
+
+
+FSGMessageRequestTable::~FSGMessageRequestTable()
+{
+	CompleteAll(ESGMessageRequestResult::Cancelled);
+}
+
+
+/* FSGMessageRequestTable interface
+ *****************************************************************************/
+
+uint64 FSGMessageRequestTable::Add(TFuture<FSGMessageReply>& OutFuture)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	const uint64 RequestId = AddSlot();
+	FSlot* Slot = FindSlot(RequestId);
+
+	Slot->Promise = TPromise<FSGMessageReply>();
+	OutFuture = Slot->Promise.GetFuture();
+
+	return RequestId;
+}
+
+
+uint64 FSGMessageRequestTable::Add(FSGMessageWaiter& Waiter)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	const uint64 RequestId = AddSlot();
+	FindSlot(RequestId)->Waiter = &Waiter;
+	Waiter.RequestId = RequestId;
+
+	return RequestId;
+}
+
+
+bool FSGMessageRequestTable::Complete(const uint64 RequestId, const ESGMessageRequestResult Result,
+                                      const TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+{
+	TPromise<FSGMessageReply> Promise;
+	FSGMessageWaiter* Waiter;
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		FSlot* Slot = FindSlot(RequestId);
+
+		if (Slot == nullptr)
+		{
+			return false;
+		}
+
+		Waiter = Slot->Waiter;
+
+		if (Waiter == nullptr)
+		{
+			Promise = MoveTemp(Slot->Promise);
+		}
+
+		FreeSlot(RequestId);
+	}
+
+	if (Waiter != nullptr)
+	{
+		Waiter->Complete(FSGMessageReply(Result, Context));
+	}
+	else
+	{
+		Promise.SetValue(FSGMessageReply(Result, Context));
+	}
+
+	return true;
+}
+
+
+void FSGMessageRequestTable::CompleteAll(const ESGMessageRequestResult Result)
+{
+	TArray<TPromise<FSGMessageReply>> Promises;
+	TArray<FSGMessageWaiter*> Waiters;
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
+		{
+			FSlot& Slot = Slots[SlotIndex];
+
+			if (!Slot.bPending)
+			{
+				continue;
+			}
+
+			if (Slot.Waiter != nullptr)
+			{
+				Waiters.Add(Slot.Waiter);
+			}
+			else
+			{
+				Promises.Add(MoveTemp(Slot.Promise));
+			}
+
+			FreeSlot((static_cast<uint64>(Slot.Serial) << 32) | static_cast<uint32>(SlotIndex));
+		}
+	}
+
+	for (TPromise<FSGMessageReply>& Promise : Promises)
+	{
+		Promise.SetValue(FSGMessageReply(Result));
+	}
+
+	for (FSGMessageWaiter* Waiter : Waiters)
+	{
+		Waiter->Complete(FSGMessageReply(Result));
+	}
+}
+
+
+bool FSGMessageRequestTable::RemoveWaiter(const uint64 RequestId)
+{
+	FScopeLock Lock(&CriticalSection);
+
+	const FSlot* Slot = FindSlot(RequestId);
+
+	if ((Slot == nullptr) || (Slot->Waiter == nullptr))
+	{
+		return false;
+	}
+
+	FreeSlot(RequestId);
+
+	return true;
+}
+
+
+uint64 FSGMessageRequestTable::FromAnnotation(const FString& Annotation)
+{
+	uint64 RequestId = 0;
+
+	if (!Annotation.IsNumeric())
+	{
+		return 0;
+	}
+
+	LexFromString(RequestId, *Annotation);
+
+	return RequestId;
+}
+
+
+/* FSGMessageRequestTable implementation
+ *****************************************************************************/
+
+uint64 FSGMessageRequestTable::AddSlot()
+{
+	const int32 SlotIndex = (FreeSlots.Num() > 0) ? FreeSlots.Pop(false) : Slots.AddDefaulted();
+	FSlot& Slot = Slots[SlotIndex];
+
+	// serial 0 is skipped, so that no identifier is 0
+	if (++Slot.Serial == 0)
+	{
+		++Slot.Serial;
+	}
+
+	Slot.bPending = true;
+
+	++NumPending;
+
+	return (static_cast<uint64>(Slot.Serial) << 32) | static_cast<uint32>(SlotIndex);
+}
+
+
+FSGMessageRequestTable::FSlot* FSGMessageRequestTable::FindSlot(const uint64 RequestId)
+{
+	const int32 SlotIndex = static_cast<int32>(RequestId & MAX_uint32);
+	const uint32 Serial = static_cast<uint32>(RequestId >> 32);
+
+	if (!Slots.IsValidIndex(SlotIndex) || !Slots[SlotIndex].bPending || (Slots[SlotIndex].Serial != Serial))
+	{
+		return nullptr;
+	}
+
+	return &Slots[SlotIndex];
+}
+
+
+void FSGMessageRequestTable::FreeSlot(const uint64 RequestId)
+{
+	const int32 SlotIndex = static_cast<int32>(RequestId & MAX_uint32);
+	FSlot& Slot = Slots[SlotIndex];
+
+	Slot.Waiter = nullptr;
+	Slot.bPending = false;
+	FreeSlots.Push(SlotIndex);
+
+	--NumPending;
+}
@@ -0,0 +1,86 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Common/SGSharedBufferMessageAttachment.h"
+#include "Memory/UniqueBuffer.h"
+#include "Serialization/MemoryReader.h"
+
+
+namespace SGSharedBufferMessageAttachment
+{
+	/**
+	 * Implements an archive reader that keeps the buffer it reads from alive.
+	 */
+	class FBufferReader final
+		: public FMemoryReaderView
+	{
+	public:
+		explicit FBufferReader(FSharedBuffer InBuffer)
+			: FMemoryReaderView(InBuffer.GetView())
+			  , Buffer(MoveTemp(InBuffer))
+		{
+		}
+
+	private:
+		/** Holds the buffer. */
+		FSharedBuffer Buffer;
+	};
+
+
+	/**
+	 * Implements a chunk reader for composite buffers.
+	 *
+	 * Chunks are returned as views of the buffers. Only chunks that span buffer boundaries are copied.
+	 */
+	class FBufferChunkReader final
+		: public ISGMessageAttachmentReader
+	{
+	public:
+		explicit FBufferChunkReader(const FCompositeBuffer& InBuffer)
+			: Buffer(InBuffer)
+		{
+		}
+
+	public:
+		//~ ISGMessageAttachmentReader interface
+
+		virtual int64 GetSize() const override
+		{
+			return static_cast<int64>(Buffer.GetSize());
+		}
+
+		virtual FMemoryView ReadChunk(const int64 Offset, const int64 Size) override
+		{
+			const auto ChunkSize = FMath::Min(Size, GetSize() - Offset);
+
+			if ((Offset < 0) || (ChunkSize <= 0))
+			{
+				return FMemoryView();
+			}
+
+			return Buffer.ViewOrCopyRange(Offset, ChunkSize, CopyBuffer);
+		}
+
+	private:
+		/** Holds the data. */
+		FCompositeBuffer Buffer;
+
+		/** Holds the copy of the last chunk that spanned buffer boundaries. */
+		FUniqueBuffer CopyBuffer;
+	};
+}
+
+
+/* ISGMessageAttachment interface
+ *****************************************************************************/
+
+FArchive* FSGSharedBufferMessageAttachment::CreateReader()
+{
+	// a single buffer is read in place, several are joined first
+	return new SGSharedBufferMessageAttachment::FBufferReader(Buffer.ToShared());
+}
+
+
+TUniquePtr<ISGMessageAttachmentReader> FSGSharedBufferMessageAttachment::CreateChunkReader()
+{
+	return MakeUnique<SGSharedBufferMessageAttachment::FBufferChunkReader>(Buffer);
+}
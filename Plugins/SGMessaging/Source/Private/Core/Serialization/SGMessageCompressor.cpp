@@ -0,0 +1,363 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Serialization/SGMessageCompressor.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Serialization/SGMessageWireFormat.h"
+#include "Core/Settings/SGMessagingSettings.h"
+#include "Misc/Compression.h"
+#include "Misc/ScopeLock.h"
+
+
+namespace SGMessageCompressor
+{
+	/** The compression formats that can appear in an envelope, indexed by their format byte. */
+	const FName& GetFormatName(const uint8 Index)
+	{
+		static const FName Formats[] = {NAME_Zlib, NAME_Gzip, NAME_LZ4, NAME_Oodle};
+
+		return Index < UE_ARRAY_COUNT(Formats) ? Formats[Index] : NAME_None;
+	}
+
+	/** Gets the format byte of a compression format. */
+	uint8 GetFormatIndex(const FName& Format)
+	{
+		for (uint8 Index = 0; !GetFormatName(Index).IsNone(); ++Index)
+		{
+			if (GetFormatName(Index) == Format)
+			{
+				return Index;
+			}
+		}
+
+		return MAX_uint8;
+	}
+
+	/** The size of a compressed envelope's header and format byte. */
+	constexpr int32 EnvelopeHeaderSize = FSGMessageWireFormat::HeaderSize + 1;
+
+	/** The largest message that is accepted after decompression. */
+	constexpr uint32 MaxUncompressedSize = 256 * 1024 * 1024;
+
+
+	/**
+	 * Implements a pool of buffers for received messages.
+	 *
+	 * Buffers are grouped into power-of-two size classes. Decoded messages keep their buffer alive, and the
+	 * buffer goes back into the pool when the last message referencing it is released. Each class retains a
+	 * bounded number of free buffers; larger buffers are not pooled.
+	 */
+	class FBufferPool
+		: public TSharedFromThis<FBufferPool, ESPMode::ThreadSafe>
+	{
+	public:
+		/** Gets the process-wide pool. */
+		static FBufferPool& Get()
+		{
+			static const TSharedRef<FBufferPool, ESPMode::ThreadSafe> Pool = MakeShared<
+				FBufferPool, ESPMode::ThreadSafe>();
+
+			return *Pool;
+		}
+
+		/** Destructor. */
+		~FBufferPool()
+		{
+			for (auto& Blocks : FreeBlocks)
+			{
+				for (const auto Block : Blocks)
+				{
+					FMemory::Free(Block);
+				}
+			}
+		}
+
+	public:
+		/** Acquires a buffer of at least the given size. */
+		uint8* Acquire(const int32 Size)
+		{
+			const auto Class = GetClass(Size);
+
+			if (Class != INDEX_NONE)
+			{
+				FScopeLock Lock(&CriticalSection);
+
+				if (FreeBlocks[Class].Num() > 0)
+				{
+					return FreeBlocks[Class].Pop(false);
+				}
+			}
+
+			return static_cast<uint8*>(FMemory::Malloc(Class != INDEX_NONE ? GetClassSize(Class) : Size));
+		}
+
+		/** Returns a buffer that was not shared. */
+		void Release(uint8* Block, const int32 Size)
+		{
+			const auto Class = GetClass(Size);
+
+			if (Class != INDEX_NONE)
+			{
+				FScopeLock Lock(&CriticalSection);
+
+				if (FreeBlocks[Class].Num() < MaxFreeBlocks)
+				{
+					FreeBlocks[Class].Add(Block);
+
+					return;
+				}
+			}
+
+			FMemory::Free(Block);
+		}
+
+		/** Wraps a filled buffer into a shared buffer that returns it to the pool when released. */
+		FSharedBuffer Share(uint8* Block, const int32 Size)
+		{
+			return FSharedBuffer::TakeOwnership(Block, Size, [Pool = AsShared(), Size](void* Data)
+			{
+				Pool->Release(static_cast<uint8*>(Data), Size);
+			});
+		}
+
+	private:
+		/** Gets the size class of a buffer size, or INDEX_NONE if buffers of that size are not pooled. */
+		static int32 GetClass(const int32 Size)
+		{
+			const auto Class = static_cast<int32>(FMath::CeilLogTwo(FMath::Max<uint32>(Size, 1u << MinClassShift))) -
+				MinClassShift;
+
+			return Class < NumClasses ? Class : INDEX_NONE;
+		}
+
+		/** Gets the buffer size of a size class. */
+		static int32 GetClassSize(const int32 Class)
+		{
+			return 1 << (Class + MinClassShift);
+		}
+
+	private:
+		/** The size of the smallest class is 4 KB. */
+		static constexpr int32 MinClassShift = 12;
+
+		/** The size of the largest class is 16 MB. */
+		static constexpr int32 NumClasses = 13;
+
+		/** The number of free buffers that each class retains. */
+		static constexpr int32 MaxFreeBlocks = 32;
+
+		/** Holds the free buffers of each class. */
+		TArray<uint8*> FreeBlocks[NumClasses];
+
+		/** Protects the free lists. */
+		FCriticalSection CriticalSection;
+	};
+}
+
+
+/* FSGMessageCompressor structors
+ *****************************************************************************/
+
+FSGMessageCompressor::FSGMessageCompressor()
+	: FSGMessageCompressor(GetDefault<USGMessagingSettings>()->CompressionFormat,
+	                       GetDefault<USGMessagingSettings>()->CompressionThreshold)
+{
+}
+
+
+FSGMessageCompressor::FSGMessageCompressor(const FName& InFormat, const int32 InThreshold)
+	: Threshold(0)
+	  , NumCompressed(0)
+	  , NumUncompressed(0)
+	  , NumDecompressed(0)
+	  , BytesBeforeCompression(0)
+	  , BytesAfterCompression(0)
+	  , CompressCycles(0)
+	  , DecompressCycles(0)
+{
+	Configure(InFormat, InThreshold);
+}
+
+
+/* FSGMessageCompressor interface
+ *****************************************************************************/
+
+void FSGMessageCompressor::Configure(const FName& InFormat, const int32 InThreshold)
+{
+	Format = InFormat;
+	Threshold = FMath::Max(InThreshold, 0);
+
+	if (Format.IsNone())
+	{
+		return;
+	}
+
+	if (SGMessageCompressor::GetFormatIndex(Format) == MAX_uint8 || !FCompression::IsFormatValid(Format))
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("FSGMessageCompressor: Compression format %s is not available, using LZ4"),
+		       *Format.ToString());
+
+		Format = NAME_LZ4;
+	}
+}
+
+
+bool FSGMessageCompressor::Encode(const ISGMessageContext& Context, TArray<uint8>& OutBuffer)
+{
+	const auto Start = OutBuffer.Num();
+
+	if (!FSGMessageWireFormat::Encode(Context, OutBuffer))
+	{
+		return false;
+	}
+
+	const auto Size = OutBuffer.Num() - Start;
+
+	if (Format.IsNone() || Size <= Threshold)
+	{
+		++NumUncompressed;
+
+		return true;
+	}
+
+	const auto StartCycles = FPlatformTime::Cycles64();
+
+	auto& Pool = SGMessageCompressor::FBufferPool::Get();
+	auto CompressedSize = FCompression::CompressMemoryBound(Format, Size);
+	const auto Scratch = Pool.Acquire(CompressedSize);
+	const auto ScratchSize = CompressedSize;
+
+	auto bCompressed = FCompression::CompressMemory(Format, Scratch, CompressedSize, OutBuffer.GetData() + Start, Size);
+
+	// only keep the compressed envelope if it is actually smaller
+	bCompressed = bCompressed && SGMessageCompressor::EnvelopeHeaderSize + CompressedSize < Size;
+
+	if (bCompressed)
+	{
+		const auto EnvelopeSize = static_cast<uint32>(SGMessageCompressor::EnvelopeHeaderSize + CompressedSize);
+		const auto UncompressedSize = static_cast<uint32>(Size);
+
+		auto Envelope = OutBuffer.GetData() + Start;
+
+		Envelope[3] = FSGMessageWireFormat::CompressedFlag;
+		FMemory::Memcpy(Envelope + 4, &UncompressedSize, sizeof(uint32));
+		FMemory::Memcpy(Envelope + 8, &EnvelopeSize, sizeof(uint32));
+		Envelope[FSGMessageWireFormat::HeaderSize] = SGMessageCompressor::GetFormatIndex(Format);
+		FMemory::Memcpy(Envelope + SGMessageCompressor::EnvelopeHeaderSize, Scratch, CompressedSize);
+
+		OutBuffer.SetNum(Start + EnvelopeSize, false);
+
+		++NumCompressed;
+		BytesBeforeCompression += Size;
+		BytesAfterCompression += EnvelopeSize;
+	}
+	else
+	{
+		++NumUncompressed;
+	}
+
+	Pool.Release(Scratch, ScratchSize);
+
+	CompressCycles += FPlatformTime::Cycles64() - StartCycles;
+
+	return true;
+}
+
+
+TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> FSGMessageCompressor::Decode(const uint8* Data, const int32 Size)
+{
+	if (Size >= FSGMessageWireFormat::HeaderSize && (Data[3] & FSGMessageWireFormat::CompressedFlag) != 0)
+	{
+		return DecodeCompressed(Data, Size);
+	}
+
+	auto& Pool = SGMessageCompressor::FBufferPool::Get();
+	const auto Block = Pool.Acquire(Size);
+
+	FMemory::Memcpy(Block, Data, Size);
+
+	return FSGMessageWireFormat::Decode(Pool.Share(Block, Size));
+}
+
+
+TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> FSGMessageCompressor::Decode(const FSharedBuffer& Buffer)
+{
+	const auto Data = static_cast<const uint8*>(Buffer.GetData());
+	const auto Size = static_cast<int32>(Buffer.GetSize());
+
+	if (Size >= FSGMessageWireFormat::HeaderSize && (Data[3] & FSGMessageWireFormat::CompressedFlag) != 0)
+	{
+		return DecodeCompressed(Data, Size);
+	}
+
+	return FSGMessageWireFormat::Decode(Buffer);
+}
+
+
+FSGMessageCompressionStats FSGMessageCompressor::GetStats() const
+{
+	FSGMessageCompressionStats Stats;
+
+	Stats.NumCompressed = NumCompressed;
+	Stats.NumUncompressed = NumUncompressed;
+	Stats.NumDecompressed = NumDecompressed;
+	Stats.BytesBeforeCompression = BytesBeforeCompression;
+	Stats.BytesAfterCompression = BytesAfterCompression;
+	Stats.CompressSeconds = FPlatformTime::ToSeconds64(CompressCycles);
+	Stats.DecompressSeconds = FPlatformTime::ToSeconds64(DecompressCycles);
+
+	return Stats;
+}
+
+
+/* FSGMessageCompressor implementation
+ *****************************************************************************/
+
+TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> FSGMessageCompressor::DecodeCompressed(
+	const uint8* Data, const int32 Size)
+{
+	if (Size < SGMessageCompressor::EnvelopeHeaderSize || Data[0] != 'S' || Data[1] != 'G' ||
+		Data[2] != FSGMessageWireFormat::Version)
+	{
+		return nullptr;
+	}
+
+	uint32 UncompressedSize;
+	uint32 EnvelopeSize;
+
+	FMemory::Memcpy(&UncompressedSize, Data + 4, sizeof(uint32));
+	FMemory::Memcpy(&EnvelopeSize, Data + 8, sizeof(uint32));
+
+	const auto& EnvelopeFormat = SGMessageCompressor::GetFormatName(Data[FSGMessageWireFormat::HeaderSize]);
+
+	if (EnvelopeFormat.IsNone() || EnvelopeSize > static_cast<uint32>(Size) ||
+		EnvelopeSize < static_cast<uint32>(SGMessageCompressor::EnvelopeHeaderSize) ||
+		UncompressedSize > SGMessageCompressor::MaxUncompressedSize)
+	{
+		return nullptr;
+	}
+
+	const auto StartCycles = FPlatformTime::Cycles64();
+
+	auto& Pool = SGMessageCompressor::FBufferPool::Get();
+	const auto Block = Pool.Acquire(UncompressedSize);
+
+	const auto bDecompressed = FCompression::UncompressMemory(EnvelopeFormat, Block, UncompressedSize,
+	                                                          Data + SGMessageCompressor::EnvelopeHeaderSize,
+	                                                          EnvelopeSize - SGMessageCompressor::EnvelopeHeaderSize);
+
+	DecompressCycles += FPlatformTime::Cycles64() - StartCycles;
+
+	if (!bDecompressed)
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("FSGMessageCompressor: Failed to decompress a %s message (%u bytes)"),
+		       *EnvelopeFormat.ToString(), EnvelopeSize);
+
+		Pool.Release(Block, UncompressedSize);
+
+		return nullptr;
+	}
+
+	++NumDecompressed;
+
+	return FSGMessageWireFormat::Decode(Pool.Share(Block, UncompressedSize));
+}
@@ -0,0 +1,531 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Serialization/SGMessageWireFormat.h"
+#include "Core/Bus/SGMessageContext.h"
+#include "Core/Common/SGSharedBufferMessageAttachment.h"
+#include "Core/Message/SGMessage.h"
+#include "Core/Message/SGMessageBuilder.h"
+
+
+/* FSGMessageWireReader structors
+ *****************************************************************************/
+
+FSGMessageWireReader::FSGMessageWireReader(const uint8* InData, const int32 InSize)
+	: Data(InData)
+	  , Size(InSize)
+	  , bValid(false)
+	  , DictionaryOffset(0)
+	  , RecipientsOffset(0)
+	  , NumRecipients(0)
+	  , ScalarsOffset(0)
+	  , AnnotationsOffset(0)
+	  , NumAnnotations(0)
+	  , ParamsOffset(0)
+	  , NumParams(0)
+	  , PayloadOffset(0)
+{
+	bValid = Parse();
+}
+
+
+/* FSGMessageWireReader interface
+ *****************************************************************************/
+
+FName FSGMessageWireReader::GetMessageTag() const
+{
+	return CreateReader(FSGMessageWireFormat::HeaderSize).ReadName();
+}
+
+
+FSGMessageAddress FSGMessageWireReader::GetSender() const
+{
+	return FSGMessageAddress::FromGuid(GetSenderGuid());
+}
+
+
+FGuid FSGMessageWireReader::GetSenderGuid() const
+{
+	auto Reader = CreateReader(FSGMessageWireFormat::HeaderSize);
+
+	Reader.ReadVarint();
+
+	return Reader.ReadGuid();
+}
+
+
+FSGMessageAddress FSGMessageWireReader::GetRecipient(const int32 Index) const
+{
+	return FSGMessageAddress::FromGuid(GetRecipientGuid(Index));
+}
+
+
+FGuid FSGMessageWireReader::GetRecipientGuid(const int32 Index) const
+{
+	check(Index >= 0 && Index < NumRecipients);
+
+	return CreateReader(RecipientsOffset + Index * static_cast<int32>(sizeof(FGuid))).ReadGuid();
+}
+
+
+ESGMessageScope FSGMessageWireReader::GetScope() const
+{
+	return static_cast<ESGMessageScope>(CreateReader(ScalarsOffset).ReadByte());
+}
+
+
+ESGMessageFlags FSGMessageWireReader::GetFlags() const
+{
+	auto Reader = CreateReader(ScalarsOffset);
+
+	Reader.ReadByte();
+
+	return static_cast<ESGMessageFlags>(Reader.ReadVarint());
+}
+
+
+FDateTime FSGMessageWireReader::GetTimeSent() const
+{
+	auto Reader = CreateReader(ScalarsOffset);
+
+	Reader.ReadByte();
+
+	Reader.ReadVarint();
+
+	return FDateTime(Reader.ReadInt64());
+}
+
+
+FDateTime FSGMessageWireReader::GetExpiration() const
+{
+	auto Reader = CreateReader(ScalarsOffset);
+
+	Reader.ReadByte();
+
+	Reader.ReadVarint();
+
+	Reader.ReadInt64();
+
+	return FDateTime(Reader.ReadInt64());
+}
+
+
+bool FSGMessageWireReader::FindAnnotation(const FName& Key, FString& OutValue) const
+{
+	auto Reader = CreateReader(AnnotationsOffset);
+
+	for (auto i = 0; i < NumAnnotations; ++i)
+	{
+		if (Reader.ReadName() == Key)
+		{
+			OutValue = Reader.ReadString();
+
+			return true;
+		}
+
+		Reader.ReadUtf8();
+	}
+
+	return false;
+}
+
+
+bool FSGMessageWireReader::FindParameter(const FString& Key, FSGWireValue& OutValue) const
+{
+	const FTCHARToUTF8 Utf8Key(*Key, Key.Len());
+
+	auto Reader = CreateReader(ParamsOffset);
+
+	for (auto i = 0; i < NumParams; ++i)
+	{
+		const auto ParamKey = Reader.ReadUtf8();
+
+		const auto bMatch = ParamKey.Num() == Utf8Key.Length() &&
+			FMemory::Memcmp(ParamKey.GetData(), Utf8Key.Get(), ParamKey.Num()) == 0;
+
+		if (bMatch)
+		{
+			OutValue = ReadParameterValue(Reader);
+
+			return true;
+		}
+
+		Reader.ReadType();
+
+		Reader.ReadSized();
+	}
+
+	return false;
+}
+
+
+/* FSGMessageWireReader implementation
+ *****************************************************************************/
+
+FSGWireValue FSGMessageWireReader::ReadParameterValue(FSGWireReader& Reader) const
+{
+	const auto Type = Reader.ReadType();
+
+	const auto Bytes = Reader.ReadBytes(static_cast<int32>(Reader.ReadVarint()));
+
+	return FSGWireValue{Type, Bytes.GetData(), Bytes.Num(), Names};
+}
+
+
+bool FSGMessageWireReader::Parse()
+{
+	if (Data == nullptr || Size < FSGMessageWireFormat::HeaderSize)
+	{
+		return false;
+	}
+
+	if (Data[0] != 'S' || Data[1] != 'G' || Data[2] != FSGMessageWireFormat::Version)
+	{
+		return false;
+	}
+
+	// compressed messages must be decompressed first
+	if ((Data[3] & FSGMessageWireFormat::CompressedFlag) != 0)
+	{
+		return false;
+	}
+
+	uint32 EncodedDictionaryOffset;
+
+	uint32 EncodedSize;
+
+	FMemory::Memcpy(&EncodedDictionaryOffset, Data + 4, sizeof(uint32));
+
+	FMemory::Memcpy(&EncodedSize, Data + 8, sizeof(uint32));
+
+	if (EncodedSize > static_cast<uint32>(Size) || EncodedDictionaryOffset > EncodedSize ||
+		EncodedDictionaryOffset < static_cast<uint32>(FSGMessageWireFormat::HeaderSize))
+	{
+		return false;
+	}
+
+	Size = EncodedSize;
+
+	DictionaryOffset = EncodedDictionaryOffset;
+
+	// materialize the name dictionary
+	auto DictionaryReader = FSGWireReader(Data + DictionaryOffset, Size - DictionaryOffset);
+
+	const auto NumNames = DictionaryReader.ReadCount();
+
+	Names.Reserve(NumNames);
+
+	for (auto i = 0; i < NumNames && !DictionaryReader.IsError(); ++i)
+	{
+		const auto Utf8 = DictionaryReader.ReadUtf8();
+
+		const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Utf8.GetData()), Utf8.Num());
+
+		Names.Add(FName(Converter.Length(), Converter.Get()));
+	}
+
+	if (DictionaryReader.IsError())
+	{
+		return false;
+	}
+
+	// the payload follows the dictionary
+	PayloadOffset = (Data[3] & FSGMessageWireFormat::PayloadFlag) != 0 ? DictionaryOffset + DictionaryReader.Tell() : Size;
+
+	// validate the body layout and remember where its sections start
+	auto Reader = CreateReader(FSGMessageWireFormat::HeaderSize);
+
+	Reader.ReadName();
+
+	Reader.ReadGuid();
+
+	NumRecipients = static_cast<int32>(Reader.ReadVarint());
+
+	RecipientsOffset = Reader.Tell();
+
+	if (NumRecipients < 0 || NumRecipients > Reader.GetRemaining() / static_cast<int32>(sizeof(FGuid)))
+	{
+		return false;
+	}
+
+	Reader.ReadBytes(NumRecipients * static_cast<int32>(sizeof(FGuid)));
+
+	ScalarsOffset = Reader.Tell();
+
+	Reader.ReadByte();
+
+	Reader.ReadVarint();
+
+	Reader.ReadInt64();
+
+	Reader.ReadInt64();
+
+	NumAnnotations = Reader.ReadCount();
+
+	AnnotationsOffset = Reader.Tell();
+
+	for (auto i = 0; i < NumAnnotations && !Reader.IsError(); ++i)
+	{
+		Reader.ReadName();
+
+		Reader.ReadUtf8();
+	}
+
+	NumParams = Reader.ReadCount();
+
+	ParamsOffset = Reader.Tell();
+
+	for (auto i = 0; i < NumParams && !Reader.IsError(); ++i)
+	{
+		Reader.ReadUtf8();
+
+		ReadParameterValue(Reader);
+	}
+
+	return !Reader.IsError();
+}
+
+
+/* FSGMessageWireFormat interface
+ *****************************************************************************/
+
+int32 FSGMessageWireFormat::Encode(const ISGMessageContext& Context, uint8* Buffer, const int32 Capacity)
+{
+	FSGWireWriter Writer(Buffer, Capacity);
+
+	if (!Encode(Context, Writer) || Writer.IsOverflowed())
+	{
+		return INDEX_NONE;
+	}
+
+	return Writer.Tell();
+}
+
+
+bool FSGMessageWireFormat::Encode(const ISGMessageContext& Context, TArray<uint8>& OutBuffer)
+{
+	const auto Start = OutBuffer.Num();
+
+	auto bEncoded = false;
+
+	{
+		FSGWireWriter Writer(OutBuffer);
+
+		bEncoded = Encode(Context, Writer);
+	}
+
+	if (!bEncoded)
+	{
+		OutBuffer.SetNum(Start, false);
+	}
+
+	return bEncoded;
+}
+
+
+TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> FSGMessageWireFormat::Decode(const FSharedBuffer& Buffer)
+{
+	return Decode(Buffer, FTimespan::Zero());
+}
+
+
+TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> FSGMessageWireFormat::Decode(const FSharedBuffer& Buffer,
+                                                                                const FTimespan& TimeShift)
+{
+	return Decode(Buffer, TimeShift, &FSGMessageAddress::FromGuid);
+}
+
+
+TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> FSGMessageWireFormat::Decode(const FSharedBuffer& Buffer,
+                                                                                const FTimespan& TimeShift,
+                                                                                const FResolveAddress ResolveAddress)
+{
+	const auto OwnedBuffer = Buffer.MakeOwned();
+
+	const FSGMessageWireReader Reader(static_cast<const uint8*>(OwnedBuffer.GetData()),
+	                                  static_cast<int32>(OwnedBuffer.GetSize()));
+
+	if (!Reader.IsValid())
+	{
+		return nullptr;
+	}
+
+	auto Message = FSGMessageBuilder::Builder<FSGMessage>();
+
+	Message->WireBuffer = OwnedBuffer;
+
+	// parameters share the buffer and the dictionary, so that copies of them may outlive the message
+	const TSharedRef<const TArray<FName>, ESPMode::ThreadSafe> Names =
+		MakeShared<TArray<FName>, ESPMode::ThreadSafe>(Reader.GetNames().GetData(), Reader.GetNames().Num());
+
+	Message->Params.Reserve(Reader.GetNumParameters());
+
+	Reader.ForEachParameter([Message, &OwnedBuffer, &Names](const TArrayView<const uint8>& Key, FSGWireValue Value)
+	{
+		const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Key.GetData()), Key.Num());
+
+		Value.Names = *Names;
+
+		Value.Buffer = OwnedBuffer;
+
+		Value.NameTable = Names;
+
+		Message->Params.Add(FString(Converter.Length(), Converter.Get()), FSGAny(MoveTemp(Value)));
+	});
+
+	TMap<FName, FString> Annotations;
+
+	Annotations.Reserve(Reader.GetNumAnnotations());
+
+	Reader.ForEachAnnotation([&Annotations](const FName& Key, FString&& Value)
+	{
+		Annotations.Add(Key, MoveTemp(Value));
+	});
+
+	TArray<FSGMessageAddress> Recipients;
+
+	Recipients.Reserve(Reader.GetNumRecipients());
+
+	for (auto i = 0; i < Reader.GetNumRecipients(); ++i)
+	{
+		Recipients.Add(ResolveAddress(Reader.GetRecipientGuid(i)));
+	}
+
+	// attachment data is referenced, not copied
+	TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe> Attachment;
+
+	if (Reader.GetPayload().Num() > 0)
+	{
+		Attachment = MakeShared<FSGSharedBufferMessageAttachment, ESPMode::ThreadSafe>(
+			FSharedBuffer::MakeView(MakeMemoryView(Reader.GetPayload()), OwnedBuffer));
+	}
+
+	// messages that never expire must not overflow
+	FDateTime Expiration = Reader.GetExpiration();
+
+	if ((Expiration != FDateTime::MaxValue()) && (TimeShift < FDateTime::MaxValue() - Expiration))
+	{
+		Expiration += TimeShift;
+	}
+
+	return MakeShared<FSGMessageContext, ESPMode::ThreadSafe>(
+		Reader.GetMessageTag(),
+		Message,
+		Annotations,
+		Attachment,
+		ResolveAddress(Reader.GetSenderGuid()),
+		Recipients,
+		Reader.GetScope(),
+		Reader.GetFlags(),
+		Reader.GetTimeSent() + TimeShift,
+		Expiration,
+		ENamedThreads::AnyThread
+	);
+}
+
+
+/* FSGMessageWireFormat implementation
+ *****************************************************************************/
+
+bool FSGMessageWireFormat::Encode(const ISGMessageContext& Context, FSGWireWriter& Writer)
+{
+	const auto MessageBase = static_cast<const ISGMessage*>(Context.GetMessage());
+
+	if (MessageBase == nullptr || MessageBase->GetFName() != FName(TEXT("FSGMessage")))
+	{
+		return false;
+	}
+
+	const auto Message = static_cast<const FSGMessage*>(MessageBase);
+
+	const auto Start = Writer.Tell();
+
+	// header
+	Writer.WriteByte('S');
+
+	Writer.WriteByte('G');
+
+	Writer.WriteByte(Version);
+
+	Writer.WriteByte(0);
+
+	Writer.WriteInt64(0);
+
+	// body
+	Writer.WriteName(Context.GetMessageTag());
+
+	Writer.WriteGuid(Context.GetSender().ToGuid());
+
+	const auto& Recipients = Context.GetRecipients();
+
+	Writer.WriteVarint(Recipients.Num());
+
+	for (const auto& Recipient : Recipients)
+	{
+		Writer.WriteGuid(Recipient.ToGuid());
+	}
+
+	Writer.WriteByte(static_cast<uint8>(Context.GetScope()));
+
+	Writer.WriteVarint(static_cast<uint32>(Context.GetFlags()));
+
+	Writer.WriteInt64(Context.GetTimeSent().GetTicks());
+
+	Writer.WriteInt64(Context.GetExpiration().GetTicks());
+
+	const auto& Annotations = Context.GetAnnotations();
+
+	Writer.WriteVarint(Annotations.Num());
+
+	for (const auto& Annotation : Annotations)
+	{
+		Writer.WriteName(Annotation.Key);
+
+		Writer.WriteString(Annotation.Value);
+	}
+
+	Writer.WriteVarint(Message->Params.Num());
+
+	for (const auto& Param : Message->Params)
+	{
+		Writer.WriteString(Param.Key);
+
+		Writer.WriteType(Param.Value.GetWireType());
+
+		const auto Marker = Writer.BeginSize();
+
+		Param.Value.WriteWire(Writer);
+
+		Writer.EndSize(Marker);
+	}
+
+	// dictionary
+	const auto DictionaryOffset = Writer.Tell() - Start;
+
+	Writer.WriteDictionary();
+
+	Writer.PatchUInt32(Start + 4, DictionaryOffset);
+
+	// payload
+	const auto Attachment = Context.GetAttachment();
+	const auto Payload = Attachment.IsValid() ? Attachment->GetMemoryBuffer() : FCompositeBuffer();
+
+	if (Payload.GetSize() > 0)
+	{
+		if (Payload.GetSize() > MAX_int32 - (Writer.Tell() - Start))
+		{
+			return false;
+		}
+
+		// segments are written straight from the shared buffers
+		for (const FSharedBuffer& Segment : Payload.GetSegments())
+		{
+			Writer.Write(Segment.GetData(), static_cast<int32>(Segment.GetSize()));
+		}
+
+		Writer.PatchByte(Start + 3, PayloadFlag);
+	}
+
+	Writer.PatchUInt32(Start + 8, Writer.Tell() - Start);
+
+	return !Writer.IsError();
+}
@@ -0,0 +1,336 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Serialization/SGWireArchive.h"
+
+
+/* FSGWireWriter interface
+ *****************************************************************************/
+
+void FSGWireWriter::WriteDictionary()
+{
+	WriteVarint(Names.Num());
+
+	for (const auto& Name : Names)
+	{
+		TCHAR Buffer[NAME_SIZE];
+
+		const auto Len = Name.ToString(Buffer);
+
+		WriteString(Buffer, Len);
+	}
+}
+
+
+void FSGWireWriter::Transcode(FSGWireReader& Reader, const ESGAnyTypes Type)
+{
+	if (!Reader.EnterNested())
+	{
+		bError = true;
+
+		return;
+	}
+
+	switch (Type)
+	{
+	case ESGAnyTypes::FName:
+		{
+			WriteName(Reader.ReadName());
+
+			break;
+		}
+
+	case ESGAnyTypes::TArray:
+	case ESGAnyTypes::TSet:
+		{
+			const auto Num = Reader.ReadCount();
+
+			const auto ElementType = Reader.ReadType();
+
+			WriteVarint(Num);
+
+			WriteType(ElementType);
+
+			for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+			{
+				Transcode(Reader, ElementType);
+			}
+
+			break;
+		}
+
+	case ESGAnyTypes::TMap:
+		{
+			const auto Num = Reader.ReadCount();
+
+			const auto KeyType = Reader.ReadType();
+
+			const auto ValueType = Reader.ReadType();
+
+			WriteVarint(Num);
+
+			WriteType(KeyType);
+
+			WriteType(ValueType);
+
+			for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+			{
+				Transcode(Reader, KeyType);
+
+				Transcode(Reader, ValueType);
+			}
+
+			break;
+		}
+
+	case ESGAnyTypes::UStruct:
+		{
+			WriteName(Reader.ReadName());
+
+			const auto Num = Reader.ReadCount();
+
+			WriteVarint(Num);
+
+			for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+			{
+				WriteName(Reader.ReadName());
+
+				const auto FieldType = Reader.ReadType();
+
+				WriteType(FieldType);
+
+				auto FieldReader = Reader.ReadSized();
+
+				const auto Marker = BeginSize();
+
+				Transcode(FieldReader, FieldType);
+
+				EndSize(Marker);
+
+				if (FieldReader.IsError())
+				{
+					Reader.SetError();
+				}
+			}
+
+			break;
+		}
+
+	default:
+		{
+			// values without names are copied verbatim
+			const auto Start = Reader.Tell();
+
+			Reader.Skip(Type);
+
+			const auto End = Reader.Tell();
+
+			Reader.Seek(Start);
+
+			const auto Bytes = Reader.ReadBytes(End - Start);
+
+			Write(Bytes.GetData(), Bytes.Num());
+
+			break;
+		}
+	}
+
+	Reader.LeaveNested();
+
+	if (Reader.IsError())
+	{
+		bError = true;
+	}
+}
+
+
+/* FSGWireReader interface
+ *****************************************************************************/
+
+FString FSGWireReader::ReadString()
+{
+	const auto Utf8 = ReadUtf8();
+
+	if (Utf8.Num() == 0)
+	{
+		return FString();
+	}
+
+	const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Utf8.GetData()), Utf8.Num());
+
+	return FString(Converter.Length(), Converter.Get());
+}
+
+
+int64 FSGWireReader::ReadInteger(const ESGAnyTypes Type)
+{
+	if (IsSignedType(Type))
+	{
+		return ReadSignedVarint();
+	}
+
+	if (IsUnsignedType(Type))
+	{
+		return static_cast<int64>(ReadVarint());
+	}
+
+	switch (Type)
+	{
+	case ESGAnyTypes::Bool:
+		return ReadByte();
+
+	case ESGAnyTypes::Float:
+		return static_cast<int64>(ReadFloat());
+
+	case ESGAnyTypes::Double:
+		return static_cast<int64>(ReadDouble());
+
+	default:
+		Skip(Type);
+
+		return 0;
+	}
+}
+
+
+uint64 FSGWireReader::ReadUnsignedInteger(const ESGAnyTypes Type)
+{
+	if (IsUnsignedType(Type))
+	{
+		return ReadVarint();
+	}
+
+	return static_cast<uint64>(ReadInteger(Type));
+}
+
+
+double FSGWireReader::ReadReal(const ESGAnyTypes Type)
+{
+	switch (Type)
+	{
+	case ESGAnyTypes::Float:
+		return ReadFloat();
+
+	case ESGAnyTypes::Double:
+		return ReadDouble();
+
+	default:
+		return IsUnsignedType(Type)
+			       ? static_cast<double>(ReadVarint())
+			       : static_cast<double>(ReadInteger(Type));
+	}
+}
+
+
+void FSGWireReader::Skip(const ESGAnyTypes Type)
+{
+	if (IsSignedType(Type) || IsUnsignedType(Type))
+	{
+		ReadVarint();
+
+		return;
+	}
+
+	if (IsObjectType(Type))
+	{
+		ReadUtf8();
+
+		return;
+	}
+
+	switch (Type)
+	{
+	case ESGAnyTypes::Empty:
+		break;
+
+	case ESGAnyTypes::Bool:
+		ReadByte();
+		break;
+
+	case ESGAnyTypes::Float:
+		ReadBytes(sizeof(float));
+		break;
+
+	case ESGAnyTypes::Double:
+		ReadBytes(sizeof(double));
+		break;
+
+	case ESGAnyTypes::FName:
+		ReadVarint();
+		break;
+
+	case ESGAnyTypes::FString:
+	case ESGAnyTypes::FText:
+		ReadUtf8();
+		break;
+
+	case ESGAnyTypes::TArray:
+	case ESGAnyTypes::TSet:
+		{
+			if (!EnterNested())
+			{
+				break;
+			}
+
+			const auto Num = ReadCount();
+
+			const auto ElementType = ReadType();
+
+			for (auto i = 0; i < Num && !bError; ++i)
+			{
+				Skip(ElementType);
+			}
+
+			LeaveNested();
+
+			break;
+		}
+
+	case ESGAnyTypes::TMap:
+		{
+			if (!EnterNested())
+			{
+				break;
+			}
+
+			const auto Num = ReadCount();
+
+			const auto KeyType = ReadType();
+
+			const auto ValueType = ReadType();
+
+			for (auto i = 0; i < Num && !bError; ++i)
+			{
+				Skip(KeyType);
+
+				Skip(ValueType);
+			}
+
+			LeaveNested();
+
+			break;
+		}
+
+	case ESGAnyTypes::UStruct:
+		{
+			ReadVarint();
+
+			const auto Num = ReadCount();
+
+			for (auto i = 0; i < Num && !bError; ++i)
+			{
+				ReadVarint();
+
+				ReadType();
+
+				ReadSized();
+			}
+
+			break;
+		}
+
+	default:
+		// types that are never encoded
+		bError = true;
+		break;
+	}
+}
@@ -0,0 +1,561 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Serialization/SGWireTraits.h"
+#include "UObject/TextProperty.h"
+#include "UObject/UnrealType.h"
+
+
+/* FSGWireProperty interface
+ *****************************************************************************/
+
+ESGAnyTypes FSGWireProperty::GetType(const FProperty* Property)
+{
+	if (const auto ByteProperty = CastField<FByteProperty>(Property))
+	{
+		return ByteProperty->Enum != nullptr ? ESGAnyTypes::TEnumAsByte : ESGAnyTypes::UInt8;
+	}
+
+	if (Property->IsA<FInt8Property>())
+	{
+		return ESGAnyTypes::Int8;
+	}
+
+	if (Property->IsA<FInt16Property>())
+	{
+		return ESGAnyTypes::Int16;
+	}
+
+	if (Property->IsA<FUInt16Property>())
+	{
+		return ESGAnyTypes::UInt16;
+	}
+
+	if (Property->IsA<FIntProperty>())
+	{
+		return ESGAnyTypes::Int32;
+	}
+
+	if (Property->IsA<FUInt32Property>())
+	{
+		return ESGAnyTypes::UInt32;
+	}
+
+	if (Property->IsA<FInt64Property>())
+	{
+		return ESGAnyTypes::Int64;
+	}
+
+	if (Property->IsA<FUInt64Property>())
+	{
+		return ESGAnyTypes::UInt64;
+	}
+
+	if (Property->IsA<FFloatProperty>())
+	{
+		return ESGAnyTypes::Float;
+	}
+
+	if (Property->IsA<FDoubleProperty>())
+	{
+		return ESGAnyTypes::Double;
+	}
+
+	if (Property->IsA<FEnumProperty>())
+	{
+		return ESGAnyTypes::EnumClass;
+	}
+
+	if (Property->IsA<FBoolProperty>())
+	{
+		return ESGAnyTypes::Bool;
+	}
+
+	if (Property->IsA<FNameProperty>())
+	{
+		return ESGAnyTypes::FName;
+	}
+
+	if (Property->IsA<FStrProperty>())
+	{
+		return ESGAnyTypes::FString;
+	}
+
+	if (Property->IsA<FTextProperty>())
+	{
+		return ESGAnyTypes::FText;
+	}
+
+	if (Property->IsA<FArrayProperty>())
+	{
+		return ESGAnyTypes::TArray;
+	}
+
+	if (Property->IsA<FMapProperty>())
+	{
+		return ESGAnyTypes::TMap;
+	}
+
+	if (Property->IsA<FSetProperty>())
+	{
+		return ESGAnyTypes::TSet;
+	}
+
+	if (Property->IsA<FStructProperty>())
+	{
+		return ESGAnyTypes::UStruct;
+	}
+
+	if (Property->IsA<FSoftClassProperty>())
+	{
+		return ESGAnyTypes::TSoftClass;
+	}
+
+	if (Property->IsA<FSoftObjectProperty>())
+	{
+		return ESGAnyTypes::TSoftObject;
+	}
+
+	if (Property->IsA<FClassProperty>())
+	{
+		return ESGAnyTypes::Class;
+	}
+
+	if (Property->IsA<FWeakObjectProperty>())
+	{
+		return ESGAnyTypes::TWeakObject;
+	}
+
+	if (Property->IsA<FLazyObjectProperty>())
+	{
+		return ESGAnyTypes::TLazyObject;
+	}
+
+	if (Property->IsA<FObjectPropertyBase>())
+	{
+		return ESGAnyTypes::UObject;
+	}
+
+	if (Property->IsA<FInterfaceProperty>())
+	{
+		return ESGAnyTypes::TScriptInterface;
+	}
+
+	return ESGAnyTypes::Empty;
+}
+
+
+void FSGWireProperty::Write(FSGWireWriter& Writer, const FProperty* Property, const void* Address)
+{
+	if (const auto NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		if (NumericProperty->IsFloatingPoint())
+		{
+			if (Property->IsA<FFloatProperty>())
+			{
+				Writer.WriteFloat(CastFieldChecked<FFloatProperty>(Property)->GetPropertyValue(Address));
+			}
+			else
+			{
+				Writer.WriteDouble(NumericProperty->GetFloatingPointPropertyValue(Address));
+			}
+		}
+		else if (FSGWireReader::IsSignedType(GetType(Property)))
+		{
+			Writer.WriteSignedVarint(NumericProperty->GetSignedIntPropertyValue(Address));
+		}
+		else
+		{
+			Writer.WriteVarint(NumericProperty->GetUnsignedIntPropertyValue(Address));
+		}
+	}
+	else if (const auto EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		Writer.WriteSignedVarint(EnumProperty->GetUnderlyingProperty()->GetSignedIntPropertyValue(Address));
+	}
+	else if (const auto BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		Writer.WriteByte(BoolProperty->GetPropertyValue(Address) ? 1 : 0);
+	}
+	else if (const auto NameProperty = CastField<FNameProperty>(Property))
+	{
+		Writer.WriteName(NameProperty->GetPropertyValue(Address));
+	}
+	else if (const auto StrProperty = CastField<FStrProperty>(Property))
+	{
+		Writer.WriteString(StrProperty->GetPropertyValue(Address));
+	}
+	else if (const auto TextProperty = CastField<FTextProperty>(Property))
+	{
+		WriteText(Writer, TextProperty->GetPropertyValue(Address));
+	}
+	else if (const auto ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		const auto ElementType = GetType(ArrayProperty->Inner);
+
+		const FScriptArrayHelper Helper(ArrayProperty, Address);
+
+		const auto Num = ElementType != ESGAnyTypes::Empty ? Helper.Num() : 0;
+
+		Writer.WriteVarint(Num);
+
+		Writer.WriteType(ElementType);
+
+		for (auto i = 0; i < Num; ++i)
+		{
+			Write(Writer, ArrayProperty->Inner, Helper.GetRawPtr(i));
+		}
+	}
+	else if (const auto MapProperty = CastField<FMapProperty>(Property))
+	{
+		const auto KeyType = GetType(MapProperty->KeyProp);
+
+		const auto ValueType = GetType(MapProperty->ValueProp);
+
+		const auto bSupported = KeyType != ESGAnyTypes::Empty && ValueType != ESGAnyTypes::Empty;
+
+		const FScriptMapHelper Helper(MapProperty, Address);
+
+		Writer.WriteVarint(bSupported ? Helper.Num() : 0);
+
+		Writer.WriteType(KeyType);
+
+		Writer.WriteType(ValueType);
+
+		for (auto i = 0; bSupported && i < Helper.GetMaxIndex(); ++i)
+		{
+			if (Helper.IsValidIndex(i))
+			{
+				Write(Writer, MapProperty->KeyProp, Helper.GetKeyPtr(i));
+
+				Write(Writer, MapProperty->ValueProp, Helper.GetValuePtr(i));
+			}
+		}
+	}
+	else if (const auto SetProperty = CastField<FSetProperty>(Property))
+	{
+		const auto ElementType = GetType(SetProperty->ElementProp);
+
+		const FScriptSetHelper Helper(SetProperty, Address);
+
+		Writer.WriteVarint(ElementType != ESGAnyTypes::Empty ? Helper.Num() : 0);
+
+		Writer.WriteType(ElementType);
+
+		for (auto i = 0; ElementType != ESGAnyTypes::Empty && i < Helper.GetMaxIndex(); ++i)
+		{
+			if (Helper.IsValidIndex(i))
+			{
+				Write(Writer, SetProperty->ElementProp, Helper.GetElementPtr(i));
+			}
+		}
+	}
+	else if (const auto StructProperty = CastField<FStructProperty>(Property))
+	{
+		WriteStruct(Writer, StructProperty->Struct, Address);
+	}
+	else if (const auto SoftObjectProperty = CastField<FSoftObjectProperty>(Property))
+	{
+		Writer.WriteString(SoftObjectProperty->GetPropertyValue(Address).ToString());
+	}
+	else if (const auto ObjectProperty = CastField<FObjectPropertyBase>(Property))
+	{
+		WriteObject(Writer, ObjectProperty->GetObjectPropertyValue(Address));
+	}
+	else if (const auto InterfaceProperty = CastField<FInterfaceProperty>(Property))
+	{
+		WriteObject(Writer, InterfaceProperty->GetPropertyValue(Address).GetObject());
+	}
+}
+
+
+void FSGWireProperty::Read(FSGWireReader& Reader, const ESGAnyTypes Type, const FProperty* Property, void* Address)
+{
+	if (const auto NumericProperty = CastField<FNumericProperty>(Property))
+	{
+		if (NumericProperty->IsFloatingPoint())
+		{
+			NumericProperty->SetFloatingPointPropertyValue(Address, Reader.ReadReal(Type));
+		}
+		else if (FSGWireReader::IsUnsignedType(GetType(Property)))
+		{
+			NumericProperty->SetIntPropertyValue(Address, Reader.ReadUnsignedInteger(Type));
+		}
+		else
+		{
+			NumericProperty->SetIntPropertyValue(Address, Reader.ReadInteger(Type));
+		}
+	}
+	else if (const auto EnumProperty = CastField<FEnumProperty>(Property))
+	{
+		EnumProperty->GetUnderlyingProperty()->SetIntPropertyValue(Address, Reader.ReadInteger(Type));
+	}
+	else if (const auto BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		BoolProperty->SetPropertyValue(Address, Reader.ReadInteger(Type) != 0);
+	}
+	else if (const auto NameProperty = CastField<FNameProperty>(Property))
+	{
+		NameProperty->SetPropertyValue(Address, TSGWireTraits<FName>::Read(Reader, Type));
+	}
+	else if (const auto StrProperty = CastField<FStrProperty>(Property))
+	{
+		StrProperty->SetPropertyValue(Address, TSGWireTraits<FString>::Read(Reader, Type));
+	}
+	else if (const auto TextProperty = CastField<FTextProperty>(Property))
+	{
+		TextProperty->SetPropertyValue(Address, ReadText(Reader, Type));
+	}
+	else if (const auto ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		if (Type != ESGAnyTypes::TArray && Type != ESGAnyTypes::TSet)
+		{
+			Reader.Skip(Type);
+
+			return;
+		}
+
+		const auto Num = Reader.ReadCount();
+
+		const auto ElementType = Reader.ReadType();
+
+		FScriptArrayHelper Helper(ArrayProperty, Address);
+
+		Helper.EmptyAndAddValues(Num);
+
+		for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+		{
+			Read(Reader, ElementType, ArrayProperty->Inner, Helper.GetRawPtr(i));
+		}
+	}
+	else if (const auto MapProperty = CastField<FMapProperty>(Property))
+	{
+		if (Type != ESGAnyTypes::TMap)
+		{
+			Reader.Skip(Type);
+
+			return;
+		}
+
+		const auto Num = Reader.ReadCount();
+
+		const auto KeyType = Reader.ReadType();
+
+		const auto ValueType = Reader.ReadType();
+
+		FScriptMapHelper Helper(MapProperty, Address);
+
+		Helper.EmptyValues(Num);
+
+		for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+		{
+			const auto Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+
+			Read(Reader, KeyType, MapProperty->KeyProp, Helper.GetKeyPtr(Index));
+
+			Read(Reader, ValueType, MapProperty->ValueProp, Helper.GetValuePtr(Index));
+		}
+
+		Helper.Rehash();
+	}
+	else if (const auto SetProperty = CastField<FSetProperty>(Property))
+	{
+		if (Type != ESGAnyTypes::TSet && Type != ESGAnyTypes::TArray)
+		{
+			Reader.Skip(Type);
+
+			return;
+		}
+
+		const auto Num = Reader.ReadCount();
+
+		const auto ElementType = Reader.ReadType();
+
+		FScriptSetHelper Helper(SetProperty, Address);
+
+		Helper.EmptyElements(Num);
+
+		for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+		{
+			const auto Index = Helper.AddDefaultValue_Invalid_NeedsRehash();
+
+			Read(Reader, ElementType, SetProperty->ElementProp, Helper.GetElementPtr(Index));
+		}
+
+		Helper.Rehash();
+	}
+	else if (const auto StructProperty = CastField<FStructProperty>(Property))
+	{
+		if (Type != ESGAnyTypes::UStruct)
+		{
+			Reader.Skip(Type);
+
+			return;
+		}
+
+		ReadStruct(Reader, StructProperty->Struct, Address);
+	}
+	else if (const auto SoftObjectProperty = CastField<FSoftObjectProperty>(Property))
+	{
+		SoftObjectProperty->SetPropertyValue(Address, FSoftObjectPtr(ReadObjectPath(Reader, Type)));
+	}
+	else if (const auto ObjectProperty = CastField<FObjectPropertyBase>(Property))
+	{
+		auto Object = ReadObject(Reader, Type);
+
+		if (Object != nullptr && !Object->IsA(ObjectProperty->PropertyClass))
+		{
+			Object = nullptr;
+		}
+
+		ObjectProperty->SetObjectPropertyValue(Address, Object);
+	}
+	else if (const auto InterfaceProperty = CastField<FInterfaceProperty>(Property))
+	{
+		const auto Object = ReadObject(Reader, Type);
+
+		const auto Interface = Object != nullptr ? Object->GetInterfaceAddress(InterfaceProperty->InterfaceClass) : nullptr;
+
+		InterfaceProperty->SetPropertyValue(Address, FScriptInterface(Interface != nullptr ? Object : nullptr, Interface));
+	}
+	else
+	{
+		Reader.Skip(Type);
+	}
+}
+
+
+void FSGWireProperty::WriteStruct(FSGWireWriter& Writer, const UStruct* Struct, const void* Address)
+{
+	Writer.WriteName(Struct->GetFName());
+
+	auto Num = 0;
+
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		if (GetType(*It) != ESGAnyTypes::Empty)
+		{
+			++Num;
+		}
+	}
+
+	Writer.WriteVarint(Num);
+
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		const auto Type = GetType(*It);
+
+		if (Type == ESGAnyTypes::Empty)
+		{
+			continue;
+		}
+
+		// only the first element of static arrays is transferred
+		Writer.WriteName(It->GetFName());
+
+		Writer.WriteType(Type);
+
+		const auto Marker = Writer.BeginSize();
+
+		Write(Writer, *It, It->ContainerPtrToValuePtr<void>(Address));
+
+		Writer.EndSize(Marker);
+	}
+}
+
+
+void FSGWireProperty::ReadStruct(FSGWireReader& Reader, const UStruct* Struct, void* Address)
+{
+	Reader.ReadName();
+
+	const auto Num = Reader.ReadCount();
+
+	for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+	{
+		const auto Name = Reader.ReadName();
+
+		const auto Type = Reader.ReadType();
+
+		auto FieldReader = Reader.ReadSized();
+
+		if (const auto Property = Struct->FindPropertyByName(Name))
+		{
+			Read(FieldReader, Type, Property, Property->ContainerPtrToValuePtr<void>(Address));
+		}
+
+		if (FieldReader.IsError())
+		{
+			Reader.SetError();
+		}
+	}
+}
+
+
+void FSGWireProperty::WriteObject(FSGWireWriter& Writer, const UObject* Object)
+{
+	if (Object != nullptr)
+	{
+		Writer.WriteString(Object->GetPathName());
+	}
+	else
+	{
+		Writer.WriteVarint(0);
+	}
+}
+
+
+UObject* FSGWireProperty::ReadObject(FSGWireReader& Reader, const ESGAnyTypes Type)
+{
+	const auto Path = ReadObjectPath(Reader, Type);
+
+	return Path.IsValid() ? Path.ResolveObject() : nullptr;
+}
+
+
+FSoftObjectPath FSGWireProperty::ReadObjectPath(FSGWireReader& Reader, const ESGAnyTypes Type)
+{
+	if (!FSGWireReader::IsObjectType(Type) && Type != ESGAnyTypes::FString)
+	{
+		Reader.Skip(Type);
+
+		return FSoftObjectPath();
+	}
+
+	return FSoftObjectPath(Reader.ReadString());
+}
+
+
+void FSGWireProperty::WriteText(FSGWireWriter& Writer, const FText& Text)
+{
+	FString String;
+
+	FTextStringHelper::WriteToBuffer(String, Text);
+
+	Writer.WriteString(String);
+}
+
+
+FText FSGWireProperty::ReadText(FSGWireReader& Reader, const ESGAnyTypes Type)
+{
+	if (Type == ESGAnyTypes::FString)
+	{
+		return FText::FromString(Reader.ReadString());
+	}
+
+	FText Result;
+
+	if (Type != ESGAnyTypes::FText)
+	{
+		Reader.Skip(Type);
+
+		return Result;
+	}
+
+	const auto String = Reader.ReadString();
+
+	if (!FTextStringHelper::ReadFromBuffer(*String, Result))
+	{
+		Result = FText::FromString(String);
+	}
+
+	return Result;
+}
@@ -0,0 +1,351 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Transport/SGLoopbackTransport.h"
+#include "Core/Common/SGMessageAddress.h"
+#include "Core/Interface/ISGMessageTransportHandler.h"
+#include "HAL/Event.h"
+#include "HAL/RunnableThread.h"
+#include "Memory/SharedBuffer.h"
+#include "Misc/ScopeLock.h"
+
+
+namespace SGLoopbackTransport
+{
+	/** The maximum time that the delivery thread sleeps. */
+	constexpr uint32 MaxWaitMs = 100;
+
+	/** The maximum time that the delivery thread sleeps while packets are held back. */
+	constexpr uint32 HeldWaitMs = 1;
+}
+
+
+/* FSGLoopbackTransport structors
+ *****************************************************************************/
+
+FSGLoopbackTransport::FSGLoopbackTransport(const FTimespan& InLatency, const double InBandwidth)
+	: Latency(InLatency)
+	  , Bandwidth(InBandwidth)
+	  , NodeId(FSGMessageAddress::NewNodeId())
+	  , LinkFreeTime(0.0)
+	  , bFaulty(false)
+	  , TransportHandler(nullptr)
+	  , Started(false)
+	  , NumMessagesTransported(0)
+	  , NumBytesTransported(0)
+	  , WorkEvent(FPlatformProcess::GetSynchEventFromPool())
+	  , Thread(nullptr)
+	  , Stopping(false)
+{
+}
+
+
+FSGLoopbackTransport::~FSGLoopbackTransport()
+{
+	StopTransport();
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
+
+/* FSGLoopbackTransport interface
+ *****************************************************************************/
+
+void FSGLoopbackTransport::SetFaults(const FSGLoopbackFaults& InFaults)
+{
+	FScopeLock Lock(&FaultsLock);
+
+	Faults = InFaults;
+	FaultStream.Initialize(InFaults.Seed);
+	bFaulty = true;
+}
+
+
+void FSGLoopbackTransport::CreatePair(const FTimespan& Latency, const double Bandwidth,
+                                      TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe>& OutFirst,
+                                      TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe>& OutSecond)
+{
+	OutFirst = MakeShared<FSGLoopbackTransport, ESPMode::ThreadSafe>(Latency, Bandwidth);
+	OutSecond = MakeShared<FSGLoopbackTransport, ESPMode::ThreadSafe>(Latency, Bandwidth);
+
+	OutFirst->Peer = OutSecond;
+	OutFirst->PeerNodeId = OutSecond->NodeId;
+
+	OutSecond->Peer = OutFirst;
+	OutSecond->PeerNodeId = OutFirst->NodeId;
+}
+
+
+/* ISGMessageTransport interface
+ *****************************************************************************/
+
+FName FSGLoopbackTransport::GetDebugName() const
+{
+	return "LoopbackTransport";
+}
+
+
+bool FSGLoopbackTransport::IsReliable() const
+{
+	return !bFaulty;
+}
+
+
+bool FSGLoopbackTransport::StartTransport(ISGMessageTransportHandler& Handler)
+{
+	if (Thread != nullptr)
+	{
+		return true;
+	}
+
+	{
+		FScopeLock Lock(&HandlerLock);
+		TransportHandler = &Handler;
+	}
+
+	Stopping = false;
+	Thread = FRunnableThread::Create(this, TEXT("FSGLoopbackTransport"), 128 * 1024, TPri_AboveNormal);
+
+	if (Thread == nullptr)
+	{
+		FScopeLock Lock(&HandlerLock);
+		TransportHandler = nullptr;
+
+		return false;
+	}
+
+	Started = true;
+
+	// the nodes discover each other once both sides are running
+	if (const auto PeerTransport = Peer.Pin())
+	{
+		if (PeerTransport->Started)
+		{
+			HandlePeerStarted();
+			PeerTransport->HandlePeerStarted();
+		}
+	}
+
+	return true;
+}
+
+
+void FSGLoopbackTransport::StopTransport()
+{
+	if (Thread == nullptr)
+	{
+		return;
+	}
+
+	Started = false;
+
+	if (const auto PeerTransport = Peer.Pin())
+	{
+		PeerTransport->HandlePeerStopped();
+	}
+
+	Thread->Kill(true);
+
+	delete Thread;
+	Thread = nullptr;
+
+	Inbound.Empty();
+	HeldPackets.Empty();
+
+	FScopeLock Lock(&HandlerLock);
+	TransportHandler = nullptr;
+}
+
+
+bool FSGLoopbackTransport::TransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                            TArrayView<const FGuid> Recipients)
+{
+	const auto PeerTransport = Peer.Pin();
+
+	if (!PeerTransport.IsValid() || !PeerTransport->Started)
+	{
+		return false;
+	}
+
+	if (Recipients.Num() > 0 && !Recipients.Contains(PeerNodeId))
+	{
+		return false;
+	}
+
+	FPacket Packet;
+
+	if (!Compressor.Encode(*Context, Packet.Data))
+	{
+		return false;
+	}
+
+	const auto Size = Packet.Data.Num();
+	{
+		FScopeLock Lock(&LinkLock);
+
+		// packets queue up behind each other on a link with limited bandwidth
+		const auto SendTime = FMath::Max(FPlatformTime::Seconds(), LinkFreeTime);
+
+		LinkFreeTime = SendTime + (Bandwidth > 0.0 ? Size / Bandwidth : 0.0);
+		Packet.DeliveryTime = LinkFreeTime + Latency.GetTotalSeconds();
+
+		PeerTransport->Inbound.Enqueue(MoveTemp(Packet));
+	}
+
+	NumMessagesTransported += 1;
+	NumBytesTransported += Size;
+
+	PeerTransport->WorkEvent->Trigger();
+
+	return true;
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+bool FSGLoopbackTransport::Init()
+{
+	return true;
+}
+
+
+uint32 FSGLoopbackTransport::Run()
+{
+	while (!Stopping)
+	{
+		// held back packets arrive after the packets that overtook them
+		for (auto Index = 0; Index < HeldPackets.Num();)
+		{
+			if (HeldPackets[Index].DeliveryTime <= FPlatformTime::Seconds())
+			{
+				DeliverPacket(MoveTemp(HeldPackets[Index].Data));
+				HeldPackets.RemoveAt(Index);
+			}
+			else
+			{
+				++Index;
+			}
+		}
+
+		auto Packet = Inbound.Peek();
+
+		if (Packet == nullptr)
+		{
+			WorkEvent->Wait(HeldPackets.Num() > 0 ? SGLoopbackTransport::HeldWaitMs : SGLoopbackTransport::MaxWaitMs);
+
+			continue;
+		}
+
+		const auto Remaining = Packet->DeliveryTime - FPlatformTime::Seconds();
+
+		if (Remaining > 0.0)
+		{
+			if (Remaining >= 0.001)
+			{
+				WorkEvent->Wait(static_cast<uint32>(Remaining * 1000.0));
+			}
+			else
+			{
+				FPlatformProcess::YieldThread();
+			}
+
+			continue;
+		}
+
+		FPacket DuePacket;
+		Inbound.Dequeue(DuePacket);
+
+		ReceivePacket(MoveTemp(DuePacket));
+	}
+
+	return 0;
+}
+
+
+void FSGLoopbackTransport::Stop()
+{
+	Stopping = true;
+
+	WorkEvent->Trigger();
+}
+
+
+/* FSGLoopbackTransport implementation
+ *****************************************************************************/
+
+void FSGLoopbackTransport::ReceivePacket(FPacket&& Packet)
+{
+	if (!bFaulty)
+	{
+		DeliverPacket(MoveTemp(Packet.Data));
+
+		return;
+	}
+
+	bool bDrop;
+	bool bDuplicate;
+	bool bReorder;
+	FTimespan ReorderDelay;
+	{
+		FScopeLock Lock(&FaultsLock);
+
+		bDrop = FaultStream.GetFraction() < Faults.DropRate;
+		bDuplicate = FaultStream.GetFraction() < Faults.DuplicateRate;
+		bReorder = FaultStream.GetFraction() < Faults.ReorderRate;
+		ReorderDelay = Faults.ReorderDelay;
+	}
+
+	if (bDrop)
+	{
+		return;
+	}
+
+	if (bReorder)
+	{
+		Packet.DeliveryTime = FPlatformTime::Seconds() + ReorderDelay.GetTotalSeconds();
+		HeldPackets.Add(MoveTemp(Packet));
+
+		return;
+	}
+
+	if (bDuplicate)
+	{
+		DeliverPacket(CopyTemp(Packet.Data));
+	}
+
+	DeliverPacket(MoveTemp(Packet.Data));
+}
+
+
+void FSGLoopbackTransport::DeliverPacket(TArray<uint8>&& Data)
+{
+	const auto Context = Compressor.Decode(MakeSharedBufferFromArray(MoveTemp(Data)));
+
+	if (Context.IsValid())
+	{
+		TransportHandler->ReceiveTransportMessage(Context.ToSharedRef(), PeerNodeId);
+	}
+}
+
+
+void FSGLoopbackTransport::HandlePeerStarted()
+{
+	FScopeLock Lock(&HandlerLock);
+
+	if (TransportHandler != nullptr)
+	{
+		TransportHandler->DiscoverTransportNode(PeerNodeId);
+	}
+}
+
+
+void FSGLoopbackTransport::HandlePeerStopped()
+{
+	FScopeLock Lock(&HandlerLock);
+
+	if (TransportHandler != nullptr)
+	{
+		TransportHandler->ForgetTransportNode(PeerNodeId);
+	}
+}
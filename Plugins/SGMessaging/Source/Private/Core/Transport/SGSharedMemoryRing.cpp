@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Transport/SGSharedMemoryRing.h"
+#include "Core/Interface/ISGMessagingModule.h"
+
+#if PLATFORM_UNIX
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+namespace SGSharedMemoryRing
+{
+#if PLATFORM_UNIX
+	/** Gets the name that the engine opens a named region under. */
+	FString GetPosixName(const FString& Name)
+	{
+		return TEXT("/") + Name;
+	}
+#endif
+}
+
+
+/* FSGSharedMemoryRing interface
+ *****************************************************************************/
+
+FPlatformMemory::FSharedMemoryRegion* FSGSharedMemoryRing::MapRegion(const FString& Name, const SIZE_T Size)
+{
+	const auto Access = FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write;
+
+#if PLATFORM_UNIX
+	const FTCHARToUTF8 PosixName(*SGSharedMemoryRing::GetPosixName(Name));
+
+	// opens the region if it exists and creates it otherwise
+	const auto Descriptor = shm_open(PosixName.Get(), O_RDWR | O_CREAT, 0666);
+
+	if (Descriptor == -1)
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("FSGSharedMemoryRing: Failed to open region %s (errno %d)"), *Name, errno);
+
+		return nullptr;
+	}
+
+	// the engine maps whole pages; regions that already exist keep their size and contents
+	const auto MappedSize = static_cast<off_t>(Align(Size, FPlatformMemory::GetConstants().PageSize));
+
+	struct stat Stat;
+
+	const auto bSized = fstat(Descriptor, &Stat) == 0 &&
+		(Stat.st_size >= MappedSize || ftruncate(Descriptor, MappedSize) == 0);
+	const auto Error = errno;
+
+	close(Descriptor);
+
+	if (!bSized)
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("FSGSharedMemoryRing: Failed to size region %s (errno %d)"), *Name, Error);
+
+		return nullptr;
+	}
+
+	return FPlatformMemory::MapNamedSharedMemoryRegion(Name, false, Access, Size);
+#else
+	return FPlatformMemory::MapNamedSharedMemoryRegion(Name, true, Access, Size);
+#endif
+}
+
+
+void FSGSharedMemoryRing::UnlinkRegion(const FString& Name)
+{
+#if PLATFORM_UNIX
+	shm_unlink(TCHAR_TO_UTF8(*SGSharedMemoryRing::GetPosixName(Name)));
+#endif
+}
@@ -0,0 +1,591 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Transport/SGSharedMemoryTransport.h"
+#include "Core/Common/SGMessageAddress.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Interface/ISGMessageTransportHandler.h"
+#include "HAL/RunnableThread.h"
+
+#if PLATFORM_LINUX
+	#include <linux/futex.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+
+namespace SGSharedMemoryTransport
+{
+	/** Identifies the registry layout; changes whenever FSlot changes. */
+	constexpr int32 RegistryMagic = 0x53474d31;
+
+	/** The interval at which the registry is scanned for new and lost peers. */
+	constexpr double PeerUpdateInterval = 0.25;
+
+	/** The maximum time that the receive thread sleeps. */
+	constexpr uint32 MaxWaitMs = 100;
+}
+
+
+/* FSGSharedMemoryTransport structors
+ *****************************************************************************/
+
+FSGSharedMemoryTransport::FSGSharedMemoryTransport(const FString& InChannel, const uint32 InRingSize)
+	: Channel(InChannel)
+	  , RingSize(FMath::RoundUpToPowerOfTwo(FMath::Max<uint32>(InRingSize, 64 * 1024)))
+	  , Registry(nullptr)
+	  , SlotIndex(INDEX_NONE)
+	  , Wakeup(nullptr)
+	  , TransportHandler(nullptr)
+	  , Thread(nullptr)
+	  , Stopping(false)
+	  , LastPeerUpdateTime(0.0)
+{
+}
+
+
+FSGSharedMemoryTransport::~FSGSharedMemoryTransport()
+{
+	StopTransport();
+}
+
+
+/* ISGMessageTransport interface
+ *****************************************************************************/
+
+FName FSGSharedMemoryTransport::GetDebugName() const
+{
+	return "SharedMemoryTransport";
+}
+
+
+bool FSGSharedMemoryTransport::StartTransport(ISGMessageTransportHandler& Handler)
+{
+	if (Thread != nullptr)
+	{
+		return true;
+	}
+
+	Registry = FSGSharedMemoryRing::MapRegion(GetRegistryName(), sizeof(FRegistryHeader) + MaxSlots * sizeof(FSlot));
+
+	if (Registry == nullptr)
+	{
+		UE_LOG(LogSGMessaging, Error, TEXT("FSGSharedMemoryTransport: Failed to map the registry for channel %s"),
+		       *Channel);
+
+		return false;
+	}
+
+	const auto Header = static_cast<FRegistryHeader*>(Registry->GetAddress());
+
+	FPlatformAtomics::InterlockedCompareExchange(&Header->Magic, SGSharedMemoryTransport::RegistryMagic, 0);
+
+	if (Header->Magic != SGSharedMemoryTransport::RegistryMagic)
+	{
+		UE_LOG(LogSGMessaging, Error,
+		       TEXT("FSGSharedMemoryTransport: Channel %s is in use by an incompatible version of the transport"),
+		       *Channel);
+
+		StopTransport();
+
+		return false;
+	}
+
+	NodeId = FSGMessageAddress::NewNodeId();
+
+#if !PLATFORM_LINUX
+	Wakeup = FPlatformProcess::NewInterprocessSynchObject(GetWakeupName(NodeId), true);
+#endif
+
+	if (!ClaimSlot())
+	{
+		UE_LOG(LogSGMessaging, Error, TEXT("FSGSharedMemoryTransport: All %d slots of channel %s are in use"), MaxSlots,
+		       *Channel);
+
+		StopTransport();
+
+		return false;
+	}
+
+	TransportHandler = &Handler;
+	Stopping = false;
+	Thread = FRunnableThread::Create(this, TEXT("FSGSharedMemoryTransport"), 128 * 1024, TPri_AboveNormal);
+
+	return Thread != nullptr;
+}
+
+
+void FSGSharedMemoryTransport::StopTransport()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	{
+		FScopeLock Lock(&PeersLock);
+
+		Peers.Empty();
+	}
+
+	CorruptNodes.Empty();
+
+	ReleaseSlot();
+
+	if (Wakeup != nullptr)
+	{
+		FPlatformProcess::DeleteInterprocessSynchObject(Wakeup);
+		Wakeup = nullptr;
+	}
+
+	if (Registry != nullptr)
+	{
+		// the last process to leave the channel removes the registry
+		if (!IsRegistryInUse())
+		{
+			FSGSharedMemoryRing::UnlinkRegion(GetRegistryName());
+		}
+
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(Registry);
+		Registry = nullptr;
+	}
+
+	TransportHandler = nullptr;
+}
+
+
+bool FSGSharedMemoryTransport::TransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                                TArrayView<const FGuid> Recipients)
+{
+	TArray<TSharedPtr<FPeer, ESPMode::ThreadSafe>> Targets;
+	{
+		FScopeLock Lock(&PeersLock);
+
+		for (const auto& Peer : Peers)
+		{
+			if (Recipients.Num() == 0 || Recipients.Contains(Peer->NodeId))
+			{
+				Targets.Add(Peer);
+			}
+		}
+	}
+
+	if (Targets.Num() == 0)
+	{
+		return false;
+	}
+
+	// encode once for all recipients
+	TArray<uint8> Buffer;
+
+	if (!Compressor.Encode(*Context, Buffer))
+	{
+		return false;
+	}
+
+	auto bTransported = false;
+
+	for (const auto& Peer : Targets)
+	{
+		auto bWritten = false;
+		{
+			FScopeLock Lock(&Peer->OutboundLock);
+			bWritten = Peer->Outbound.Write(Buffer.GetData(), Buffer.Num());
+		}
+
+		if (bWritten)
+		{
+			RingDoorbell(*Peer);
+
+			bTransported = true;
+		}
+		else
+		{
+			UE_LOG(LogSGMessaging, Warning,
+			       TEXT("FSGSharedMemoryTransport: Dropped %s message (%d bytes) to %s, ring is full or too small"),
+			       *Context->GetMessageTag().ToString(), Buffer.Num(), *Peer->NodeId.ToString());
+		}
+	}
+
+	return bTransported;
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+bool FSGSharedMemoryTransport::Init()
+{
+	return true;
+}
+
+
+uint32 FSGSharedMemoryTransport::Run()
+{
+	auto& Slot = GetSlot(SlotIndex);
+
+	while (!Stopping)
+	{
+		const auto Doorbell = FPlatformAtomics::AtomicRead(&Slot.Doorbell);
+
+		FPlatformAtomics::InterlockedIncrement(&Slot.Heartbeat);
+
+		const auto Now = FPlatformTime::Seconds();
+
+		if (Now - LastPeerUpdateTime >= SGSharedMemoryTransport::PeerUpdateInterval)
+		{
+			UpdatePeers();
+
+			LastPeerUpdateTime = Now;
+		}
+
+		if (!ReceiveMessages())
+		{
+			WaitForDoorbell(Doorbell, SGSharedMemoryTransport::MaxWaitMs);
+		}
+	}
+
+	return 0;
+}
+
+
+void FSGSharedMemoryTransport::Stop()
+{
+	Stopping = true;
+
+	if (SlotIndex != INDEX_NONE)
+	{
+		auto& Slot = GetSlot(SlotIndex);
+
+		FPlatformAtomics::InterlockedIncrement(&Slot.Doorbell);
+
+#if PLATFORM_LINUX
+		syscall(SYS_futex, &Slot.Doorbell, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+		if (Wakeup != nullptr)
+		{
+			Wakeup->Unlock();
+		}
+#endif
+	}
+}
+
+
+/* FSGSharedMemoryTransport implementation
+ *****************************************************************************/
+
+bool FSGSharedMemoryTransport::ClaimSlot()
+{
+	const auto ProcessId = FPlatformProcess::GetCurrentProcessId();
+
+	for (auto Pass = 0; Pass < 2 && SlotIndex == INDEX_NONE; ++Pass)
+	{
+		for (auto Index = 0; Index < MaxSlots; ++Index)
+		{
+			auto& Slot = GetSlot(Index);
+
+			// first pass claims free slots, second pass reclaims slots of crashed processes
+			const auto Expected = Pass == 0 ? Free : Active;
+
+			if (Pass == 1 && FPlatformProcess::IsApplicationRunning(Slot.ProcessId))
+			{
+				continue;
+			}
+
+			if (FPlatformAtomics::InterlockedCompareExchange(&Slot.State, Claiming, Expected) == Expected)
+			{
+				SlotIndex = Index;
+
+				break;
+			}
+		}
+	}
+
+	if (SlotIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	auto& Slot = GetSlot(SlotIndex);
+
+	Slot.RingSize = RingSize;
+	Slot.ProcessId = ProcessId;
+	Slot.NodeId = NodeId;
+	FPlatformAtomics::AtomicStore(&Slot.Waiting, 0);
+	FPlatformAtomics::InterlockedExchange(&Slot.State, Active);
+
+	return true;
+}
+
+
+void FSGSharedMemoryTransport::ReleaseSlot()
+{
+	if (SlotIndex == INDEX_NONE || Registry == nullptr)
+	{
+		return;
+	}
+
+	auto& Slot = GetSlot(SlotIndex);
+
+	Slot.NodeId.Invalidate();
+	FPlatformAtomics::InterlockedExchange(&Slot.State, Free);
+
+	SlotIndex = INDEX_NONE;
+}
+
+
+bool FSGSharedMemoryTransport::IsRegistryInUse() const
+{
+	const auto Header = static_cast<const FRegistryHeader*>(Registry->GetAddress());
+
+	// registries of other versions of the transport are never removed
+	if (FPlatformAtomics::AtomicRead(&Header->Magic) != SGSharedMemoryTransport::RegistryMagic)
+	{
+		return true;
+	}
+
+	for (auto Index = 0; Index < MaxSlots; ++Index)
+	{
+		const auto& Slot = GetSlot(Index);
+		const auto State = FPlatformAtomics::AtomicRead(&Slot.State);
+
+		// slots of crashed processes do not keep the registry alive
+		if (State == Claiming || (State == Active && FPlatformProcess::IsApplicationRunning(Slot.ProcessId)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void FSGSharedMemoryTransport::UpdatePeers()
+{
+	const auto Now = FPlatformTime::Seconds();
+
+	TArray<FGuid> LostNodes;
+	TArray<FGuid> DiscoveredNodes;
+
+	// forget peers whose slot was released, whose process is gone, or that corrupted their ring
+	for (auto PeerIndex = Peers.Num() - 1; PeerIndex >= 0; --PeerIndex)
+	{
+		const auto& Peer = Peers[PeerIndex];
+		auto& Slot = GetSlot(Peer->Slot);
+
+		auto bLost = FPlatformAtomics::AtomicRead(&Slot.State) != Active || Slot.NodeId != Peer->NodeId;
+
+		if (Peer->Inbound.IsCorrupt())
+		{
+			UE_LOG(LogSGMessaging, Warning, TEXT("FSGSharedMemoryTransport: Dropping node %s, its ring is corrupt"),
+			       *Peer->NodeId.ToString());
+
+			CorruptNodes.Add(Peer->NodeId);
+
+			bLost = true;
+		}
+
+		if (!bLost)
+		{
+			const auto Heartbeat = FPlatformAtomics::AtomicRead(&Slot.Heartbeat);
+
+			if (Heartbeat != Peer->LastHeartbeat)
+			{
+				Peer->LastHeartbeat = Heartbeat;
+				Peer->LastHeartbeatTime = Now;
+			}
+			else if (Now - Peer->LastHeartbeatTime > HeartbeatTimeout)
+			{
+				bLost = !FPlatformProcess::IsApplicationRunning(Peer->ProcessId);
+			}
+		}
+
+		if (bLost)
+		{
+			LostNodes.Add(Peer->NodeId);
+
+			FScopeLock Lock(&PeersLock);
+			Peers.RemoveAt(PeerIndex);
+		}
+	}
+
+	// discover processes that joined the channel
+	for (auto Index = 0; Index < MaxSlots; ++Index)
+	{
+		if (Index == SlotIndex)
+		{
+			continue;
+		}
+
+		auto& Slot = GetSlot(Index);
+
+		if (FPlatformAtomics::AtomicRead(&Slot.State) != Active)
+		{
+			continue;
+		}
+
+		const auto PeerNodeId = Slot.NodeId;
+
+		if (!PeerNodeId.IsValid() || CorruptNodes.Contains(PeerNodeId) ||
+			Peers.ContainsByPredicate([&PeerNodeId](const TSharedPtr<FPeer, ESPMode::ThreadSafe>& Peer)
+			{
+				return Peer->NodeId == PeerNodeId;
+			}))
+		{
+			continue;
+		}
+
+		auto Peer = MakeShared<FPeer, ESPMode::ThreadSafe>();
+
+		Peer->NodeId = PeerNodeId;
+		Peer->Slot = Index;
+		Peer->ProcessId = Slot.ProcessId;
+		Peer->LastHeartbeat = FPlatformAtomics::AtomicRead(&Slot.Heartbeat);
+		Peer->LastHeartbeatTime = Now;
+
+		if (!Peer->Outbound.Map(GetRingName(NodeId, PeerNodeId), Slot.RingSize) ||
+			!Peer->Inbound.Map(GetRingName(PeerNodeId, NodeId), RingSize))
+		{
+			UE_LOG(LogSGMessaging, Warning, TEXT("FSGSharedMemoryTransport: Failed to map rings for node %s"),
+			       *PeerNodeId.ToString());
+
+			continue;
+		}
+
+#if !PLATFORM_LINUX
+		Peer->Wakeup = FPlatformProcess::NewInterprocessSynchObject(GetWakeupName(PeerNodeId), false);
+#endif
+
+		DiscoveredNodes.Add(PeerNodeId);
+
+		FScopeLock Lock(&PeersLock);
+		Peers.Add(Peer);
+	}
+
+	for (const auto& LostNode : LostNodes)
+	{
+		TransportHandler->ForgetTransportNode(LostNode);
+	}
+
+	for (const auto& DiscoveredNode : DiscoveredNodes)
+	{
+		TransportHandler->DiscoverTransportNode(DiscoveredNode);
+	}
+}
+
+
+bool FSGSharedMemoryTransport::ReceiveMessages()
+{
+	auto NumReceived = 0;
+
+	// the peer list is only modified on this thread, so it can be iterated without locking
+	for (const auto& Peer : Peers)
+	{
+		NumReceived += Peer->Inbound.Read([this, &Peer](const uint8* Data, const int32 Size)
+		{
+			const auto Context = Compressor.Decode(Data, Size);
+
+			if (Context.IsValid())
+			{
+				TransportHandler->ReceiveTransportMessage(Context.ToSharedRef(), Peer->NodeId);
+			}
+			else
+			{
+				UE_LOG(LogSGMessaging, Warning, TEXT("FSGSharedMemoryTransport: Discarded malformed message from %s"),
+				       *Peer->NodeId.ToString());
+			}
+		});
+	}
+
+	return NumReceived > 0;
+}
+
+
+void FSGSharedMemoryTransport::WaitForDoorbell(const int32 Doorbell, const uint32 TimeoutMs)
+{
+	auto& Slot = GetSlot(SlotIndex);
+
+	FPlatformAtomics::InterlockedExchange(&Slot.Waiting, 1);
+
+	// re-check after announcing the wait, a writer may have missed the flag
+	auto bPending = FPlatformAtomics::AtomicRead(&Slot.Doorbell) != Doorbell;
+
+	for (const auto& Peer : Peers)
+	{
+		bPending |= !Peer->Inbound.IsEmpty();
+	}
+
+	if (!bPending)
+	{
+#if PLATFORM_LINUX
+		timespec Timeout;
+		Timeout.tv_sec = TimeoutMs / 1000;
+		Timeout.tv_nsec = (TimeoutMs % 1000) * 1000000;
+
+		syscall(SYS_futex, &Slot.Doorbell, FUTEX_WAIT, Doorbell, &Timeout, nullptr, 0);
+#else
+		if (Wakeup != nullptr)
+		{
+			Wakeup->TryLock(static_cast<uint64>(TimeoutMs) * 1000000);
+		}
+		else
+		{
+			FPlatformProcess::SleepNoStats(0.001f);
+		}
+#endif
+	}
+
+	FPlatformAtomics::InterlockedExchange(&Slot.Waiting, 0);
+}
+
+
+void FSGSharedMemoryTransport::RingDoorbell(FPeer& Peer)
+{
+	auto& Slot = GetSlot(Peer.Slot);
+
+	FPlatformAtomics::InterlockedIncrement(&Slot.Doorbell);
+
+	if (FPlatformAtomics::AtomicRead(&Slot.Waiting) == 0)
+	{
+		return;
+	}
+
+#if PLATFORM_LINUX
+	syscall(SYS_futex, &Slot.Doorbell, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+	if (Peer.Wakeup != nullptr)
+	{
+		Peer.Wakeup->Unlock();
+	}
+#endif
+}
+
+
+FSGSharedMemoryTransport::FSlot& FSGSharedMemoryTransport::GetSlot(const int32 Index) const
+{
+	check(Registry != nullptr && Index >= 0 && Index < MaxSlots);
+
+	const auto Slots = reinterpret_cast<FSlot*>(static_cast<uint8*>(Registry->GetAddress()) + sizeof(FRegistryHeader));
+
+	return Slots[Index];
+}
+
+
+FString FSGSharedMemoryTransport::GetRegistryName() const
+{
+	return FString::Printf(TEXT("SGMessaging_%s"), *Channel);
+}
+
+
+FString FSGSharedMemoryTransport::GetRingName(const FGuid& From, const FGuid& To) const
+{
+	return FString::Printf(TEXT("SGMessaging_%s_%s_%s"), *Channel, *From.ToString(), *To.ToString());
+}
+
+
+FString FSGSharedMemoryTransport::GetWakeupName(const FGuid& InNodeId) const
+{
+	return FString::Printf(TEXT("SGMessaging_%s_%s"), *Channel, *InNodeId.ToString());
+}
@@ -0,0 +1,929 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Core/Transport/SGSocketTransport.h"
+#include "Core/Common/SGMessageAddress.h"
+#include "Common/TcpSocketBuilder.h"
+#include "Common/UdpSocketBuilder.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Interface/ISGMessageTransportHandler.h"
+#include "HAL/Event.h"
+#include "HAL/RunnableThread.h"
+#include "IPAddress.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+
+namespace SGSocketTransport
+{
+	/** Identifies hello frames and datagrams of this protocol version. */
+	constexpr uint32 ProtocolMagic = 0x31534753;
+
+	/** The size of a frame's size and type fields. */
+	constexpr int32 FrameHeaderSize = sizeof(uint32) + sizeof(uint8);
+
+	/** The size of a hello frame's payload. */
+	constexpr int32 HelloSize = sizeof(uint32) + sizeof(FGuid) + sizeof(uint16);
+
+	/** The size of a datagram's header. */
+	constexpr int32 DatagramHeaderSize = sizeof(uint32) + sizeof(FGuid);
+
+	/** The largest datagram that is sent; larger messages go over the stream. */
+	constexpr int32 MaxDatagramSize = 60 * 1024;
+
+	/** The largest frame that is accepted from a stream. */
+	constexpr uint32 MaxFrameSize = 64 * 1024 * 1024;
+
+	/** The number of stream bytes that are sent to a connection before the other connections get their turn. */
+	constexpr int32 MaxBatchSize = 256 * 1024;
+
+	/** The number of bytes that may be queued for a connection before further frames are dropped. */
+	constexpr int64 MaxQueuedBytes = 16 * 1024 * 1024;
+
+	/** The size of the socket send and receive buffers. */
+	constexpr int32 SocketBufferSize = 4 * 1024 * 1024;
+
+	/** The time after which pending outbound connections are abandoned. */
+	constexpr double ConnectTimeout = 5.0;
+
+	/** The time between connection attempts to a static endpoint. */
+	constexpr double ReconnectInterval = 1.0;
+
+	/** The time that the I/O thread keeps polling after the last activity before it sleeps. */
+	constexpr double SpinTime = 0.0002;
+
+	/** The maximum time that the I/O thread sleeps. */
+	constexpr uint32 MaxWaitMs = 1;
+
+	/** Appends a frame header to a buffer. */
+	void WriteFrameHeader(uint8* Dest, const int32 PayloadSize, const uint8 Type)
+	{
+		const uint32 Size = PayloadSize + sizeof(uint8);
+
+		FMemory::Memcpy(Dest, &Size, sizeof(uint32));
+
+		Dest[sizeof(uint32)] = Type;
+	}
+
+	/** Sends as much of a buffer as the socket accepts, and returns false if the socket failed. */
+	bool SendSome(FSocket& Socket, const uint8* Data, const int32 Count, int32& OutBytesSent)
+	{
+		if (Socket.Send(Data, Count, OutBytesSent))
+		{
+			return true;
+		}
+
+		OutBytesSent = 0;
+
+		return ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() == SE_EWOULDBLOCK;
+	}
+}
+
+
+/* FSGSocketTransport structors
+ *****************************************************************************/
+
+FSGSocketTransport::FSGSocketTransport(const FIPv4Endpoint& InListenEndpoint,
+                                       const TArray<FIPv4Endpoint>& InStaticEndpoints)
+	: ListenEndpoint(InListenEndpoint)
+	  , ListenSocket(nullptr)
+	  , DatagramSocket(nullptr)
+	  , TransportHandler(nullptr)
+	  , WorkEvent(FPlatformProcess::GetSynchEventFromPool())
+	  , Thread(nullptr)
+	  , Stopping(false)
+	  , NumMessagesDropped(0)
+{
+	for (const auto& Endpoint : InStaticEndpoints)
+	{
+		StaticEndpoints.Add({Endpoint, nullptr, FGuid(), 0.0});
+	}
+}
+
+
+FSGSocketTransport::~FSGSocketTransport()
+{
+	StopTransport();
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
+
+/* FSGSocketTransport interface
+ *****************************************************************************/
+
+FIPv4Endpoint FSGSocketTransport::GetListenEndpoint() const
+{
+	if (ListenSocket != nullptr)
+	{
+		return FIPv4Endpoint(ListenEndpoint.Address, ListenSocket->GetPortNo());
+	}
+
+	return ListenEndpoint;
+}
+
+
+int32 FSGSocketTransport::GetNumPeers() const
+{
+	FScopeLock Lock(&NodesLock);
+
+	return Nodes.Num();
+}
+
+
+/* ISGMessageTransport interface
+ *****************************************************************************/
+
+FName FSGSocketTransport::GetDebugName() const
+{
+	return "SocketTransport";
+}
+
+
+bool FSGSocketTransport::StartTransport(ISGMessageTransportHandler& Handler)
+{
+	if (Thread != nullptr)
+	{
+		return true;
+	}
+
+	ListenSocket = FTcpSocketBuilder(TEXT("FSGSocketTransport.Listen"))
+	               .AsReusable()
+	               .AsNonBlocking()
+	               .BoundToEndpoint(ListenEndpoint)
+	               .Listening(16)
+	               .WithReceiveBufferSize(SGSocketTransport::SocketBufferSize)
+	               .Build();
+
+	if (ListenSocket == nullptr)
+	{
+		UE_LOG(LogSGMessaging, Error, TEXT("FSGSocketTransport: Failed to listen on %s"), *ListenEndpoint.ToString());
+
+		return false;
+	}
+
+	DatagramSocket = FUdpSocketBuilder(TEXT("FSGSocketTransport.Datagram"))
+	                 .AsNonBlocking()
+	                 .AsReusable()
+	                 .BoundToEndpoint(FIPv4Endpoint(ListenEndpoint.Address, 0))
+	                 .WithReceiveBufferSize(SGSocketTransport::SocketBufferSize)
+	                 .WithSendBufferSize(SGSocketTransport::SocketBufferSize)
+	                 .Build();
+
+	if (DatagramSocket == nullptr)
+	{
+		UE_LOG(LogSGMessaging, Error, TEXT("FSGSocketTransport: Failed to create the datagram socket on %s"),
+		       *ListenEndpoint.Address.ToString());
+
+		StopTransport();
+
+		return false;
+	}
+
+	NodeId = FSGMessageAddress::NewNodeId();
+	ReceiveScratch.SetNumUninitialized(64 * 1024);
+	DatagramScratch.Reset(SGSocketTransport::MaxDatagramSize);
+
+	TransportHandler = &Handler;
+	Stopping = false;
+	Thread = FRunnableThread::Create(this, TEXT("FSGSocketTransport"), 128 * 1024, TPri_AboveNormal);
+
+	return Thread != nullptr;
+}
+
+
+void FSGSocketTransport::StopTransport()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	auto& SocketSubsystem = *ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+
+	for (const auto& Connection : Connections)
+	{
+		Connection->Socket->Close();
+		SocketSubsystem.DestroySocket(Connection->Socket);
+	}
+
+	Connections.Empty();
+
+	for (auto& StaticEndpoint : StaticEndpoints)
+	{
+		StaticEndpoint.Connection.Reset();
+		StaticEndpoint.NextConnectTime = 0.0;
+	}
+
+	{
+		FScopeLock Lock(&NodesLock);
+		Nodes.Empty();
+	}
+
+	if (DatagramSocket != nullptr)
+	{
+		DatagramSocket->Close();
+		SocketSubsystem.DestroySocket(DatagramSocket);
+		DatagramSocket = nullptr;
+	}
+
+	if (ListenSocket != nullptr)
+	{
+		ListenSocket->Close();
+		SocketSubsystem.DestroySocket(ListenSocket);
+		ListenSocket = nullptr;
+	}
+
+	TransportHandler = nullptr;
+}
+
+
+bool FSGSocketTransport::TransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+                                          TArrayView<const FGuid> Recipients)
+{
+	TArray<FConnectionPtr, TInlineAllocator<8>> Targets;
+	{
+		FScopeLock Lock(&NodesLock);
+
+		if (Recipients.Num() == 0)
+		{
+			for (const auto& Node : Nodes)
+			{
+				Targets.Add(Node.Value);
+			}
+		}
+		else
+		{
+			for (const auto& Recipient : Recipients)
+			{
+				if (const auto Connection = Nodes.Find(Recipient))
+				{
+					Targets.Add(*Connection);
+				}
+			}
+		}
+	}
+
+	if (Targets.Num() == 0)
+	{
+		return false;
+	}
+
+	// encode once for all recipients, leaving room for the frame header
+	const FFramePtr Frame = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+
+	Frame->AddUninitialized(SGSocketTransport::FrameHeaderSize);
+
+	if (!Compressor.Encode(*Context, *Frame))
+	{
+		return false;
+	}
+
+	SGSocketTransport::WriteFrameHeader(Frame->GetData(), Frame->Num() - SGSocketTransport::FrameHeaderSize,
+	                                    static_cast<uint8>(EFrameType::Message));
+
+	// reliable messages are acknowledged by the bridge, so only messages that do not fit are streamed
+	const auto bStream = Frame->Num() > SGSocketTransport::MaxDatagramSize - SGSocketTransport::DatagramHeaderSize;
+
+	auto bQueued = false;
+
+	for (const auto& Connection : Targets)
+	{
+		// the limit is checked before adding, so concurrent senders may exceed it by a frame each
+		if (Connection->QueuedBytes.Load(EMemoryOrder::Relaxed) + Frame->Num() > SGSocketTransport::MaxQueuedBytes)
+		{
+			NumMessagesDropped.IncrementExchange();
+
+			continue;
+		}
+
+		Connection->QueuedBytes.AddExchange(Frame->Num());
+
+		if (bStream)
+		{
+			Connection->StreamFrames.Enqueue(Frame);
+		}
+		else
+		{
+			Connection->DatagramFrames.Enqueue(Frame);
+		}
+
+		bQueued = true;
+	}
+
+	if (bQueued)
+	{
+		WorkEvent->Trigger();
+	}
+
+	return bQueued;
+}
+
+
+/* FRunnable interface
+ *****************************************************************************/
+
+bool FSGSocketTransport::Init()
+{
+	return true;
+}
+
+
+uint32 FSGSocketTransport::Run()
+{
+	auto LastActiveTime = FPlatformTime::Seconds();
+
+	while (!Stopping)
+	{
+		const auto Now = FPlatformTime::Seconds();
+
+		AcceptConnections();
+
+		ConnectStaticEndpoints(Now);
+
+		auto bActive = ReceiveStreams();
+
+		bActive |= ReceiveDatagrams();
+
+		bActive |= SendFrames();
+
+		if (bActive)
+		{
+			LastActiveTime = Now;
+		}
+		else if (Now - LastActiveTime < SGSocketTransport::SpinTime)
+		{
+			FPlatformProcess::YieldThread();
+		}
+		else
+		{
+			WorkEvent->Wait(SGSocketTransport::MaxWaitMs);
+		}
+	}
+
+	return 0;
+}
+
+
+void FSGSocketTransport::Stop()
+{
+	Stopping = true;
+
+	WorkEvent->Trigger();
+}
+
+
+/* FSGSocketTransport implementation
+ *****************************************************************************/
+
+void FSGSocketTransport::AcceptConnections()
+{
+	auto bPending = false;
+
+	while (ListenSocket->HasPendingConnection(bPending) && bPending)
+	{
+		const auto Socket = ListenSocket->Accept(TEXT("FSGSocketTransport.Inbound"));
+
+		if (Socket == nullptr)
+		{
+			break;
+		}
+
+		int32 ActualSize;
+		Socket->SetNonBlocking(true);
+		Socket->SetNoDelay(true);
+		Socket->SetSendBufferSize(SGSocketTransport::SocketBufferSize, ActualSize);
+		Socket->SetReceiveBufferSize(SGSocketTransport::SocketBufferSize, ActualSize);
+
+		const auto Connection = MakeShared<FConnection, ESPMode::ThreadSafe>();
+
+		Connection->Socket = Socket;
+		Connection->bOutbound = false;
+		Connection->bConnected = true;
+		Connection->bClose = false;
+		Connection->ConnectTime = FPlatformTime::Seconds();
+		Connection->SendOffset = 0;
+
+		AddConnection(Connection);
+	}
+}
+
+
+void FSGSocketTransport::ConnectStaticEndpoints(const double Now)
+{
+	for (auto& StaticEndpoint : StaticEndpoints)
+	{
+		if (StaticEndpoint.Connection.IsValid() || Now < StaticEndpoint.NextConnectTime)
+		{
+			continue;
+		}
+
+		// the node may already be connected through its own connection to this node
+		if (StaticEndpoint.NodeId.IsValid() && Nodes.Contains(StaticEndpoint.NodeId))
+		{
+			continue;
+		}
+
+		StaticEndpoint.NextConnectTime = Now + SGSocketTransport::ReconnectInterval;
+
+		const auto Socket = FTcpSocketBuilder(TEXT("FSGSocketTransport.Outbound"))
+		                    .AsNonBlocking()
+		                    .WithSendBufferSize(SGSocketTransport::SocketBufferSize)
+		                    .WithReceiveBufferSize(SGSocketTransport::SocketBufferSize)
+		                    .Build();
+
+		if (Socket == nullptr)
+		{
+			continue;
+		}
+
+		Socket->SetNoDelay(true);
+
+		if (!Socket->Connect(*StaticEndpoint.Endpoint.ToInternetAddr()))
+		{
+			ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+
+			continue;
+		}
+
+		const auto Connection = MakeShared<FConnection, ESPMode::ThreadSafe>();
+
+		Connection->Socket = Socket;
+		Connection->Endpoint = StaticEndpoint.Endpoint;
+		Connection->bOutbound = true;
+		Connection->bConnected = false;
+		Connection->bClose = false;
+		Connection->ConnectTime = Now;
+		Connection->SendOffset = 0;
+
+		StaticEndpoint.Connection = Connection;
+
+		AddConnection(Connection);
+	}
+}
+
+
+void FSGSocketTransport::AddConnection(const FConnectionPtr& Connection)
+{
+	// both sides introduce themselves first; nothing else can be queued before the peer is known
+	const FFramePtr Hello = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+
+	Hello->AddUninitialized(SGSocketTransport::FrameHeaderSize + SGSocketTransport::HelloSize);
+
+	auto Dest = Hello->GetData();
+
+	SGSocketTransport::WriteFrameHeader(Dest, SGSocketTransport::HelloSize, static_cast<uint8>(EFrameType::Hello));
+
+	Dest += SGSocketTransport::FrameHeaderSize;
+
+	const auto Magic = SGSocketTransport::ProtocolMagic;
+	const auto DatagramPort = static_cast<uint16>(DatagramSocket->GetPortNo());
+
+	FMemory::Memcpy(Dest, &Magic, sizeof(uint32));
+	FMemory::Memcpy(Dest + sizeof(uint32), &NodeId, sizeof(FGuid));
+	FMemory::Memcpy(Dest + sizeof(uint32) + sizeof(FGuid), &DatagramPort, sizeof(uint16));
+
+	Connection->QueuedBytes.AddExchange(Hello->Num());
+	Connection->StreamFrames.Enqueue(Hello);
+
+	Connections.Add(Connection);
+}
+
+
+void FSGSocketTransport::CloseConnection(const FConnectionPtr& Connection)
+{
+	auto bForget = false;
+
+	if (Connection->NodeId.IsValid())
+	{
+		FScopeLock Lock(&NodesLock);
+
+		if (Nodes.FindRef(Connection->NodeId) == Connection)
+		{
+			Nodes.Remove(Connection->NodeId);
+
+			bForget = true;
+		}
+	}
+
+	if (bForget)
+	{
+		UE_LOG(LogSGMessaging, Verbose, TEXT("FSGSocketTransport: Lost node %s"), *Connection->NodeId.ToString());
+
+		TransportHandler->ForgetTransportNode(Connection->NodeId);
+	}
+
+	for (auto& StaticEndpoint : StaticEndpoints)
+	{
+		if (StaticEndpoint.Connection == Connection)
+		{
+			StaticEndpoint.Connection.Reset();
+		}
+	}
+
+	Connection->Socket->Close();
+	ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Connection->Socket);
+	Connection->Socket = nullptr;
+
+	Connections.RemoveSingleSwap(Connection);
+}
+
+
+bool FSGSocketTransport::ReceiveStreams()
+{
+	auto bActive = false;
+
+	for (auto Index = Connections.Num() - 1; Index >= 0; --Index)
+	{
+		const auto Connection = Connections[Index];
+
+		if (Connection->bClose)
+		{
+			CloseConnection(Connection);
+
+			continue;
+		}
+
+		if (!Connection->bConnected)
+		{
+			const auto State = Connection->Socket->GetConnectionState();
+
+			if (State == SCS_Connected)
+			{
+				Connection->bConnected = true;
+			}
+			else if (State == SCS_ConnectionError ||
+				FPlatformTime::Seconds() - Connection->ConnectTime > SGSocketTransport::ConnectTimeout)
+			{
+				CloseConnection(Connection);
+			}
+
+			continue;
+		}
+
+		auto bFailed = false;
+
+		while (true)
+		{
+			int32 BytesRead = 0;
+
+			if (!Connection->Socket->Recv(ReceiveScratch.GetData(), ReceiveScratch.Num(), BytesRead))
+			{
+				bFailed = true;
+
+				break;
+			}
+
+			if (BytesRead == 0)
+			{
+				break;
+			}
+
+			bActive = true;
+
+			// parse straight from the scratch buffer unless a partial frame is pending
+			auto& Pending = Connection->ReceiveBuffer;
+
+			if (Pending.Num() > 0)
+			{
+				Pending.Append(ReceiveScratch.GetData(), BytesRead);
+
+				const auto Consumed = HandleFrames(Connection, Pending.GetData(), Pending.Num());
+
+				if (Consumed == INDEX_NONE)
+				{
+					bFailed = true;
+
+					break;
+				}
+
+				Pending.RemoveAt(0, Consumed, false);
+			}
+			else
+			{
+				const auto Consumed = HandleFrames(Connection, ReceiveScratch.GetData(), BytesRead);
+
+				if (Consumed == INDEX_NONE)
+				{
+					bFailed = true;
+
+					break;
+				}
+
+				Pending.Append(ReceiveScratch.GetData() + Consumed, BytesRead - Consumed);
+			}
+
+			if (BytesRead < ReceiveScratch.Num())
+			{
+				break;
+			}
+		}
+
+		if (bFailed)
+		{
+			CloseConnection(Connection);
+		}
+	}
+
+	return bActive;
+}
+
+
+bool FSGSocketTransport::ReceiveDatagrams()
+{
+	const auto Sender = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+
+	auto bActive = false;
+	int32 BytesRead = 0;
+
+	while (DatagramSocket->RecvFrom(ReceiveScratch.GetData(), ReceiveScratch.Num(), BytesRead, *Sender) && BytesRead > 0)
+	{
+		bActive = true;
+
+		if (BytesRead < SGSocketTransport::DatagramHeaderSize)
+		{
+			continue;
+		}
+
+		uint32 Magic;
+		FGuid SenderId;
+
+		FMemory::Memcpy(&Magic, ReceiveScratch.GetData(), sizeof(uint32));
+		FMemory::Memcpy(&SenderId, ReceiveScratch.GetData() + sizeof(uint32), sizeof(FGuid));
+
+		// the I/O thread is the only writer of the node table, so it can read it without locking
+		const auto Connection = Nodes.FindRef(SenderId);
+
+		if (Magic != SGSocketTransport::ProtocolMagic || !Connection.IsValid())
+		{
+			continue;
+		}
+
+		HandleFrames(Connection, ReceiveScratch.GetData() + SGSocketTransport::DatagramHeaderSize,
+		             BytesRead - SGSocketTransport::DatagramHeaderSize);
+	}
+
+	return bActive;
+}
+
+
+bool FSGSocketTransport::SendFrames()
+{
+	auto bActive = false;
+
+	for (auto Index = Connections.Num() - 1; Index >= 0; --Index)
+	{
+		const auto Connection = Connections[Index];
+
+		if (!Connection->bConnected || Connection->bClose)
+		{
+			continue;
+		}
+
+		if (!SendStreamFrames(*Connection, bActive))
+		{
+			CloseConnection(Connection);
+
+			continue;
+		}
+
+		bActive |= SendDatagramFrames(*Connection);
+	}
+
+	return bActive;
+}
+
+
+bool FSGSocketTransport::SendStreamFrames(FConnection& Connection, bool& bOutActive)
+{
+	// FSocket has no vectored send, and streamed frames are larger than a datagram anyway, so every frame is
+	// sent straight from its encoded buffer rather than being copied into a coalescing buffer first
+	int32 BatchSize = 0;
+
+	while (BatchSize < SGSocketTransport::MaxBatchSize)
+	{
+		if (!Connection.SendFrame.IsValid() && !Connection.StreamFrames.Dequeue(Connection.SendFrame))
+		{
+			break;
+		}
+
+		const auto& Frame = *Connection.SendFrame;
+		int32 BytesSent = 0;
+
+		if (!SGSocketTransport::SendSome(*Connection.Socket, Frame.GetData() + Connection.SendOffset,
+		                                 Frame.Num() - Connection.SendOffset, BytesSent))
+		{
+			return false;
+		}
+
+		if (BytesSent == 0)
+		{
+			break;
+		}
+
+		bOutActive = true;
+		BatchSize += BytesSent;
+		Connection.SendOffset += BytesSent;
+
+		// the socket buffer is full, so the rest of the frame has to wait
+		if (Connection.SendOffset < Frame.Num())
+		{
+			break;
+		}
+
+		Connection.QueuedBytes.SubExchange(Frame.Num());
+		Connection.SendFrame.Reset();
+		Connection.SendOffset = 0;
+	}
+
+	return true;
+}
+
+
+bool FSGSocketTransport::SendDatagramFrames(FConnection& Connection)
+{
+	if (!Connection.DatagramAddress.IsValid() || Connection.DatagramFrames.IsEmpty())
+	{
+		return false;
+	}
+
+	const auto Magic = SGSocketTransport::ProtocolMagic;
+
+	auto& Datagram = DatagramScratch;
+
+	Datagram.Reset();
+
+	FFramePtr* Frame;
+
+	while ((Frame = Connection.DatagramFrames.Peek()) != nullptr)
+	{
+		// start a new datagram if the next frame does not fit
+		if (Datagram.Num() > 0 && Datagram.Num() + (*Frame)->Num() > SGSocketTransport::MaxDatagramSize)
+		{
+			int32 BytesSent;
+			DatagramSocket->SendTo(Datagram.GetData(), Datagram.Num(), BytesSent, *Connection.DatagramAddress);
+
+			Datagram.Reset();
+		}
+
+		if (Datagram.Num() == 0)
+		{
+			Datagram.Append(reinterpret_cast<const uint8*>(&Magic), sizeof(uint32));
+			Datagram.Append(reinterpret_cast<const uint8*>(&NodeId), sizeof(FGuid));
+		}
+
+		Datagram.Append(**Frame);
+
+		Connection.QueuedBytes.SubExchange((*Frame)->Num());
+		Connection.DatagramFrames.Pop();
+	}
+
+	if (Datagram.Num() > 0)
+	{
+		int32 BytesSent;
+		DatagramSocket->SendTo(Datagram.GetData(), Datagram.Num(), BytesSent, *Connection.DatagramAddress);
+	}
+
+	return true;
+}
+
+
+int32 FSGSocketTransport::HandleFrames(const FConnectionPtr& Connection, const uint8* Data, const int32 Size)
+{
+	auto Offset = 0;
+
+	while (Size - Offset >= SGSocketTransport::FrameHeaderSize)
+	{
+		uint32 FrameSize;
+
+		FMemory::Memcpy(&FrameSize, Data + Offset, sizeof(uint32));
+
+		if (FrameSize == 0 || FrameSize > SGSocketTransport::MaxFrameSize)
+		{
+			UE_LOG(LogSGMessaging, Warning, TEXT("FSGSocketTransport: Invalid frame of %u bytes from %s"), FrameSize,
+			       *Connection->NodeId.ToString());
+
+			return INDEX_NONE;
+		}
+
+		if (static_cast<uint32>(Size - Offset) - sizeof(uint32) < FrameSize)
+		{
+			break;
+		}
+
+		const auto Type = static_cast<EFrameType>(Data[Offset + sizeof(uint32)]);
+		const auto Payload = Data + Offset + SGSocketTransport::FrameHeaderSize;
+		const auto PayloadSize = static_cast<int32>(FrameSize) - 1;
+
+		if (Type == EFrameType::Hello && !Connection->NodeId.IsValid())
+		{
+			if (!HandleHello(Connection, Payload, PayloadSize))
+			{
+				return INDEX_NONE;
+			}
+		}
+		else if (Type == EFrameType::Message && Connection->NodeId.IsValid())
+		{
+			HandleMessage(Connection->NodeId, Payload, PayloadSize);
+		}
+
+		Offset += sizeof(uint32) + FrameSize;
+	}
+
+	return Offset;
+}
+
+
+bool FSGSocketTransport::HandleHello(const FConnectionPtr& Connection, const uint8* Data, const int32 Size)
+{
+	uint32 Magic = 0;
+
+	if (Size >= SGSocketTransport::HelloSize)
+	{
+		FMemory::Memcpy(&Magic, Data, sizeof(uint32));
+	}
+
+	if (Magic != SGSocketTransport::ProtocolMagic)
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("FSGSocketTransport: Incompatible hello, closing connection"));
+
+		return false;
+	}
+
+	FGuid PeerId;
+	uint16 DatagramPort;
+
+	FMemory::Memcpy(&PeerId, Data + sizeof(uint32), sizeof(FGuid));
+	FMemory::Memcpy(&DatagramPort, Data + sizeof(uint32) + sizeof(FGuid), sizeof(uint16));
+
+	if (!PeerId.IsValid() || PeerId == NodeId)
+	{
+		return false;
+	}
+
+	Connection->NodeId = PeerId;
+	Connection->DatagramAddress = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+	Connection->Socket->GetPeerAddress(*Connection->DatagramAddress);
+	Connection->DatagramAddress->SetPort(DatagramPort);
+
+	for (auto& StaticEndpoint : StaticEndpoints)
+	{
+		if (StaticEndpoint.Connection == Connection)
+		{
+			StaticEndpoint.NodeId = PeerId;
+		}
+	}
+
+	// if both nodes connected to each other, both keep the connection initiated by the smaller node identifier
+	const auto Existing = Nodes.FindRef(PeerId);
+
+	if (Existing.IsValid())
+	{
+		const auto& ExistingInitiator = Existing->bOutbound ? NodeId : PeerId;
+		const auto& NewInitiator = Connection->bOutbound ? NodeId : PeerId;
+
+		if (ExistingInitiator < NewInitiator)
+		{
+			return false;
+		}
+
+		{
+			FScopeLock Lock(&NodesLock);
+			Nodes.Add(PeerId, Connection);
+		}
+
+		Existing->bClose = true;
+
+		return true;
+	}
+
+	{
+		FScopeLock Lock(&NodesLock);
+		Nodes.Add(PeerId, Connection);
+	}
+
+	UE_LOG(LogSGMessaging, Verbose, TEXT("FSGSocketTransport: Discovered node %s"), *PeerId.ToString());
+
+	TransportHandler->DiscoverTransportNode(PeerId);
+
+	return true;
+}
+
+
+void FSGSocketTransport::HandleMessage(const FGuid& InNodeId, const uint8* Data, const int32 Size)
+{
+	const auto Context = Compressor.Decode(Data, Size);
+
+	if (!Context.IsValid())
+	{
+		UE_LOG(LogSGMessaging, Warning, TEXT("FSGSocketTransport: Discarded malformed message (%d bytes) from %s"),
+		       Size, *InNodeId.ToString());
+
+		return;
+	}
+
+	TransportHandler->ReceiveTransportMessage(Context.ToSharedRef(), InNodeId);
+}
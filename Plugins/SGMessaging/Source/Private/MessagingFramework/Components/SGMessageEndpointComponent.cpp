@@ -81,6 +81,22 @@ void USGMessageEndpointComponent::Unsubscribe(
 	}
 }
 
+void USGMessageEndpointComponent::Retain(MESSAGE_TAG_PARAM_SIGNATURE, const int32 InHistorySize)
+{
+	if (IsValid(MessageEndpoint))
+	{
+		MessageEndpoint->Retain(MESSAGE_TAG_PARAM_VALUE, InHistorySize);
+	}
+}
+
+void USGMessageEndpointComponent::Unretain(MESSAGE_TAG_PARAM_SIGNATURE)
+{
+	if (IsValid(MessageEndpoint))
+	{
+		MessageEndpoint->Unretain(MESSAGE_TAG_PARAM_VALUE);
+	}
+}
+
 FSGBlueprintMessageAddress USGMessageEndpointComponent::GetAddress() const
 {
 	if (IsValid(MessageEndpoint))
@@ -1,13 +1,19 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
 #include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 #include "Modules/ModuleManager.h"
 #include "Settings/Public/ISettingsModule.h"
 #include "Core/Interface/ISGMessageBus.h"
 #include "Core/Bus/SGMessageBus.h"
+#include "Core/Bus/SGMessageReplayer.h"
+#include "Core/Bus/SGMessagingStats.h"
 #include "Core/Bridge/SGMessageBridge.h"
 #include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Interface/ISGMessageTracer.h"
 #include "Core/Interface/ISGNetworkMessagingExtension.h"
 #include "Core/Settings/SGMessagingSettings.h"
 
@@ -18,6 +24,21 @@
 
 DEFINE_LOG_CATEGORY(LogSGMessaging);
 
+namespace SGMessagingModule
+{
+	/** Holds the number of seconds to wait for the router of a bus to take a snapshot. */
+	constexpr double SnapshotTimeout = 1.0;
+
+	/** Holds the file extension of message recordings. */
+	const TCHAR* const RecordingExtension = TEXT(".sgrec");
+
+	/** Gets the directory that relative recording filenames are resolved against. */
+	FString GetRecordingDir()
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SGMessaging"), TEXT("Recordings"));
+	}
+}
+
 #define LOCTEXT_NAMESPACE "FSGMessagingModule"
 
 /**
@@ -89,6 +110,10 @@ public:
 		FCoreDelegates::OnPreExit.AddRaw(this, &FSGMessagingModule::HandleCorePreExit);
 #endif	//PLATFORM_SUPPORTS_MESSAGEBUS
 
+#if STATS || CSV_PROFILER
+		FCoreDelegates::OnEndFrame.AddRaw(this, &FSGMessagingModule::HandleEndFrame);
+#endif
+
 		if (const auto SettingsModule = FModuleManager::GetModulePtr<ISettingsModule>("Settings"))
 		{
 			SettingsModule->RegisterSettings("Project",
@@ -100,16 +125,74 @@ public:
 			                                 GetMutableDefault<USGMessagingSettings>()
 			);
 		}
+
+		LatencyCommand = IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("SGMessaging.Latency"),
+			TEXT("Prints the p50, p99 and p999 message latencies of all buses in microseconds.\n")
+			TEXT("Usage: SGMessaging.Latency [MessageTag|Reset]"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FSGMessagingModule::HandleLatencyCommand),
+			ECVF_Default);
+
+		DumpCommand = IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("SGMessaging.Dump"),
+			TEXT("Prints a snapshot of the routing tables and endpoint inboxes of all buses, sorted by cost.\n")
+			TEXT("Usage: SGMessaging.Dump [Bus=Name] [Top=N] [File=Filename]"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FSGMessagingModule::HandleDumpCommand),
+			ECVF_Default);
+
+		RecordCommand = IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("SGMessaging.Record"),
+			TEXT("Starts or stops recording the messages routed by all buses to Saved/SGMessaging/Recordings.\n")
+			TEXT("Usage: SGMessaging.Record Start|Stop [Bus=Name] [File=Filename]"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FSGMessagingModule::HandleRecordCommand),
+			ECVF_Default);
+
+		ReplayCommand = IConsoleManager::Get().RegisterConsoleCommand(
+			TEXT("SGMessaging.Replay"),
+			TEXT("Replays a message recording against a bus, at the recorded rate times Rate (0 = max speed).\n")
+			TEXT("Usage: SGMessaging.Replay File=Filename [Bus=Name] [Rate=1] | SGMessaging.Replay Stop"),
+			FConsoleCommandWithArgsDelegate::CreateRaw(this, &FSGMessagingModule::HandleReplayCommand),
+			ECVF_Default);
 	}
 
 	virtual void ShutdownModule() override
 	{
 		ShutdownDefaultBus();
 
+		if (LatencyCommand != nullptr)
+		{
+			IConsoleManager::Get().UnregisterConsoleObject(LatencyCommand);
+			LatencyCommand = nullptr;
+		}
+
+		if (DumpCommand != nullptr)
+		{
+			IConsoleManager::Get().UnregisterConsoleObject(DumpCommand);
+			DumpCommand = nullptr;
+		}
+
+		if (RecordCommand != nullptr)
+		{
+			IConsoleManager::Get().UnregisterConsoleObject(RecordCommand);
+			RecordCommand = nullptr;
+		}
+
+		if (ReplayCommand != nullptr)
+		{
+			IConsoleManager::Get().UnregisterConsoleObject(ReplayCommand);
+			ReplayCommand = nullptr;
+		}
+
+		Replayers.Reset();
+
 #if PLATFORM_SUPPORTS_SGMESSAGEBUS
 		FCoreDelegates::OnPreExit.RemoveAll(this);
 #endif	//PLATFORM_SUPPORTS_MESSAGEBUS
 
+#if STATS || CSV_PROFILER
+		FCoreDelegates::OnEndFrame.RemoveAll(this);
+#endif
+
 		if (const auto SettingsModule = FModuleManager::GetModulePtr<ISettingsModule>("Settings"))
 		{
 			SettingsModule->UnregisterSettings("Project", "Plugins", "SGMessaging");
@@ -144,6 +227,344 @@ private:
 		ShutdownDefaultBus();
 	}
 
+	/** Callback for the end of a frame. */
+	void HandleEndFrame()
+	{
+		Stats.Update(GetAllBuses());
+	}
+
+	/** Handles the SGMessaging.Dump console command. */
+	void HandleDumpCommand(const TArray<FString>& Args)
+	{
+		const FString Params = FString::Join(Args, TEXT(" "));
+
+		FString BusFilter;
+		FParse::Value(*Params, TEXT("Bus="), BusFilter);
+
+		int32 TopCount = 20;
+		FParse::Value(*Params, TEXT("Top="), TopCount);
+		TopCount = FMath::Max(1, TopCount);
+
+		FString Filename;
+		FParse::Value(*Params, TEXT("File="), Filename);
+
+		// request all snapshots first, so that the routers work on them in parallel
+		TArray<TPair<TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>, TFuture<FSGMessageBusSnapshot>>> Snapshots;
+
+		for (const auto& Bus : GetAllBuses())
+		{
+			if (BusFilter.IsEmpty() || (Bus->GetName() == BusFilter))
+			{
+				Snapshots.Emplace(Bus, Bus->TakeSnapshot());
+			}
+		}
+
+		TArray<FString> Lines;
+
+		for (auto& SnapshotPair : Snapshots)
+		{
+			DumpBus(*SnapshotPair.Key, SnapshotPair.Value, TopCount, Lines);
+		}
+
+		for (const FString& Line : Lines)
+		{
+			UE_LOG(LogSGMessaging, Display, TEXT("%s"), *Line);
+		}
+
+		if (!Filename.IsEmpty())
+		{
+			if (FPaths::IsRelative(Filename))
+			{
+				Filename = FPaths::Combine(FPaths::ProjectLogDir(), Filename);
+			}
+
+			if (FFileHelper::SaveStringArrayToFile(Lines, *Filename))
+			{
+				UE_LOG(LogSGMessaging, Display, TEXT("Wrote bus snapshots to %s"), *Filename);
+			}
+			else
+			{
+				UE_LOG(LogSGMessaging, Warning, TEXT("Failed to write bus snapshots to %s"), *Filename);
+			}
+		}
+	}
+
+	/** Handles the SGMessaging.Record console command. */
+	void HandleRecordCommand(const TArray<FString>& Args)
+	{
+		const FString Params = FString::Join(Args, TEXT(" "));
+		const bool bStart = FParse::Command(*Params, TEXT("Start"));
+
+		if (!bStart && !FParse::Command(*Params, TEXT("Stop")))
+		{
+			UE_LOG(LogSGMessaging, Warning, TEXT("Usage: SGMessaging.Record Start|Stop [Bus=Name] [File=Filename]"));
+
+			return;
+		}
+
+		FString BusFilter;
+		FParse::Value(*Params, TEXT("Bus="), BusFilter);
+
+		FString Filename;
+		FParse::Value(*Params, TEXT("File="), Filename);
+
+		TArray<TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>> Buses = GetAllBuses();
+		Buses.RemoveAll([&BusFilter](const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& Bus)
+		{
+			return !BusFilter.IsEmpty() && (Bus->GetName() != BusFilter);
+		});
+
+		const FString Timestamp = FDateTime::Now().ToString();
+
+		for (const auto& Bus : Buses)
+		{
+			if (!bStart)
+			{
+				Bus->StopRecording();
+
+				continue;
+			}
+
+			// every bus records to its own file
+			FString BusFilename;
+
+			if (Filename.IsEmpty())
+			{
+				BusFilename = FString::Printf(TEXT("%s-%s%s"), *Bus->GetName(), *Timestamp,
+				                              SGMessagingModule::RecordingExtension);
+			}
+			else if (Buses.Num() > 1)
+			{
+				BusFilename = FPaths::Combine(FPaths::GetPath(Filename), FString::Printf(
+					                              TEXT("%s-%s%s"), *FPaths::GetBaseFilename(Filename),
+					                              *Bus->GetName(), *FPaths::GetExtension(Filename, true)));
+			}
+			else
+			{
+				BusFilename = Filename;
+			}
+
+			if (FPaths::IsRelative(BusFilename))
+			{
+				BusFilename = FPaths::Combine(SGMessagingModule::GetRecordingDir(), BusFilename);
+			}
+
+			if (!Bus->StartRecording(BusFilename))
+			{
+				UE_LOG(LogSGMessaging, Warning, TEXT("Failed to start recording %s to %s"), *Bus->GetName(),
+				       *BusFilename);
+			}
+		}
+	}
+
+	/** Handles the SGMessaging.Replay console command. */
+	void HandleReplayCommand(const TArray<FString>& Args)
+	{
+		const FString Params = FString::Join(Args, TEXT(" "));
+
+		// forget replays that are done
+		Replayers.RemoveAll([](const TUniquePtr<FSGMessageReplayer>& Replayer)
+		{
+			return Replayer->IsDone();
+		});
+
+		if (FParse::Command(*Params, TEXT("Stop")))
+		{
+			Replayers.Reset();
+
+			return;
+		}
+
+		FString Filename;
+
+		if (!FParse::Value(*Params, TEXT("File="), Filename))
+		{
+			UE_LOG(LogSGMessaging, Warning,
+			       TEXT("Usage: SGMessaging.Replay File=Filename [Bus=Name] [Rate=1] | SGMessaging.Replay Stop"));
+
+			return;
+		}
+
+		if (FPaths::IsRelative(Filename))
+		{
+			Filename = FPaths::Combine(SGMessagingModule::GetRecordingDir(), Filename);
+		}
+
+		FString BusName;
+		FParse::Value(*Params, TEXT("Bus="), BusName);
+
+		double Rate = 1.0;
+		FParse::Value(*Params, TEXT("Rate="), Rate);
+
+		// replay into the named bus, or the only one
+		TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> TargetBus;
+		const TArray<TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>> Buses = GetAllBuses();
+
+		for (const auto& Bus : Buses)
+		{
+			if (BusName.IsEmpty() ? (Buses.Num() == 1) : (Bus->GetName() == BusName))
+			{
+				TargetBus = Bus;
+			}
+		}
+
+		if (!TargetBus.IsValid())
+		{
+			UE_LOG(LogSGMessaging, Warning, TEXT("SGMessaging.Replay: Bus=%s does not name one of %d buses"), *BusName,
+			       Buses.Num());
+
+			return;
+		}
+
+		TUniquePtr<FSGMessageReplayer> Replayer = MakeUnique<FSGMessageReplayer>(
+			TargetBus.ToSharedRef(), Filename, Rate);
+
+		if (Replayer->Start())
+		{
+			UE_LOG(LogSGMessaging, Display, TEXT("Replaying %s against %s at rate %g"), *Filename,
+			       *TargetBus->GetName(), Rate);
+
+			Replayers.Add(MoveTemp(Replayer));
+		}
+		else
+		{
+			UE_LOG(LogSGMessaging, Warning, TEXT("Failed to replay %s"), *Filename);
+		}
+	}
+
+	/** Formats the snapshot of a bus, with tags and recipients sorted by cost. */
+	static void DumpBus(ISGMessageBus& Bus, TFuture<FSGMessageBusSnapshot>& Future, const int32 TopCount,
+	                    TArray<FString>& OutLines)
+	{
+		// the router may be stuck, which is worth reporting in itself
+		if (!Future.WaitFor(FTimespan::FromSeconds(SGMessagingModule::SnapshotTimeout)))
+		{
+			OutLines.Add(FString::Printf(TEXT("Bus %s: router did not respond within %.1f seconds"), *Bus.GetName(),
+			                             SGMessagingModule::SnapshotTimeout));
+
+			return;
+		}
+
+		FSGMessageBusSnapshot Snapshot = Future.Get();
+
+		OutLines.Add(FString::Printf(
+			TEXT("Bus %s: %d tags, %d recipients, %d listeners, %d queued commands, %d delayed messages"),
+			*Bus.GetName(), Snapshot.Tags.Num(), Snapshot.Recipients.Num(), Snapshot.NumListeners,
+			Snapshot.Stats.NumQueuedCommands, Snapshot.Stats.NumDelayed));
+
+		// tags cost the number of deliveries they caused
+		TArray<FSGMessageTracerLatencyInfo> Latencies;
+		Bus.GetTracer()->GetLatencies(Latencies);
+
+		TMap<FName, uint64> NumRouted;
+
+		for (const auto& LatencyInfo : Latencies)
+		{
+			NumRouted.Add(LatencyInfo.MessageTag, LatencyInfo.SendToRoute.Count);
+		}
+
+		const auto TagCost = [&NumRouted](const FSGMessageBusTagSnapshot& Tag)
+		{
+			return NumRouted.FindRef(Tag.MessageTag) * FMath::Max(1, Tag.NumSubscriptions + Tag.NumInterceptors);
+		};
+
+		Snapshot.Tags.Sort([&TagCost](const FSGMessageBusTagSnapshot& A, const FSGMessageBusTagSnapshot& B)
+		{
+			const uint64 CostA = TagCost(A);
+			const uint64 CostB = TagCost(B);
+
+			if (CostA != CostB)
+			{
+				return CostA > CostB;
+			}
+
+			return (A.NumSubscriptions + A.NumStaleSubscriptions) > (B.NumSubscriptions + B.NumStaleSubscriptions);
+		});
+
+		OutLines.Add(FString::Printf(TEXT("  Top %d of %d tags by deliveries:"),
+		                             FMath::Min(TopCount, Snapshot.Tags.Num()), Snapshot.Tags.Num()));
+
+		for (int32 Index = 0; Index < FMath::Min(TopCount, Snapshot.Tags.Num()); ++Index)
+		{
+			const FSGMessageBusTagSnapshot& Tag = Snapshot.Tags[Index];
+
+			OutLines.Add(FString::Printf(
+				TEXT("    %s routed=%llu subscriptions=%d stale=%d network=%d interceptors=%d"),
+				*Tag.MessageTag.ToString(), NumRouted.FindRef(Tag.MessageTag), Tag.NumSubscriptions,
+				Tag.NumStaleSubscriptions, Tag.NumNetworkSubscriptions, Tag.NumInterceptors));
+		}
+
+		// recipients cost their backlog first, then their subscriptions
+		Snapshot.Recipients.Sort([](const FSGMessageBusRecipientSnapshot& A, const FSGMessageBusRecipientSnapshot& B)
+		{
+			if (A.NumInboxMessages != B.NumInboxMessages)
+			{
+				return A.NumInboxMessages > B.NumInboxMessages;
+			}
+
+			return A.NumSubscriptions > B.NumSubscriptions;
+		});
+
+		OutLines.Add(FString::Printf(TEXT("  Top %d of %d recipients by inbox and subscriptions:"),
+		                             FMath::Min(TopCount, Snapshot.Recipients.Num()), Snapshot.Recipients.Num()));
+
+		for (int32 Index = 0; Index < FMath::Min(TopCount, Snapshot.Recipients.Num()); ++Index)
+		{
+			const FSGMessageBusRecipientSnapshot& Recipient = Snapshot.Recipients[Index];
+
+			OutLines.Add(FString::Printf(TEXT("    %s %s %s inbox=%d subscriptions=%d"),
+			                             *Recipient.DebugName.ToString(), *Recipient.Address.ToString(),
+			                             Recipient.bLocal ? TEXT("local") : TEXT("remote"), Recipient.NumInboxMessages,
+			                             Recipient.NumSubscriptions));
+		}
+	}
+
+	/** Handles the SGMessaging.Latency console command. */
+	void HandleLatencyCommand(const TArray<FString>& Args)
+	{
+		const bool bReset = (Args.Num() > 0) && Args[0].Equals(TEXT("Reset"), ESearchCase::IgnoreCase);
+		const FName TagFilter = ((Args.Num() > 0) && !bReset) ? FName(*Args[0]) : NAME_None;
+
+		const auto FormatSummary = [](const FSGMessageTracerLatencySummary& Summary)
+		{
+			return FString::Printf(TEXT("n=%llu p50=%llu p99=%llu p999=%llu max=%llu"), Summary.Count, Summary.P50,
+			                       Summary.P99, Summary.P999, Summary.Max);
+		};
+
+		for (const auto& Bus : GetAllBuses())
+		{
+			if (bReset)
+			{
+				Bus->GetTracer()->ResetLatencies();
+
+				continue;
+			}
+
+			TArray<FSGMessageTracerLatencyInfo> Latencies;
+			Bus->GetTracer()->GetLatencies(Latencies);
+
+			UE_LOG(LogSGMessaging, Display, TEXT("Latencies of bus %s (microseconds):"), *Bus->GetName());
+
+			for (const auto& LatencyInfo : Latencies)
+			{
+				if (!TagFilter.IsNone() && (LatencyInfo.MessageTag != TagFilter))
+				{
+					continue;
+				}
+
+				UE_LOG(LogSGMessaging, Display, TEXT("  %s send->route %s"), *LatencyInfo.MessageTag.ToString(),
+				       *FormatSummary(LatencyInfo.SendToRoute));
+
+				for (const auto& ThreadInfo : LatencyInfo.Threads)
+				{
+					UE_LOG(LogSGMessaging, Display, TEXT("    thread %d route->dispatch %s dispatch->handled %s"),
+					       static_cast<int32>(ThreadInfo.RecipientThread), *FormatSummary(ThreadInfo.RouteToDispatch),
+					       *FormatSummary(ThreadInfo.DispatchToHandled));
+				}
+			}
+		}
+	}
+
 private:
 	/** All buses that were created through this module including the default one. */
 	TMap<FName, TWeakPtr<ISGMessageBus, ESPMode::ThreadSafe>> WeakBuses;
@@ -153,6 +574,24 @@ private:
 
 	/** The delegate fired when a message bus instance is shutdown. */
 	FOnMessageBusStartupOrShutdown OnMessageBusShutdownDelegate;
+
+	/** The SGMessaging.Latency console command. */
+	IConsoleObject* LatencyCommand = nullptr;
+
+	/** The SGMessaging.Dump console command. */
+	IConsoleObject* DumpCommand = nullptr;
+
+	/** The SGMessaging.Record console command. */
+	IConsoleObject* RecordCommand = nullptr;
+
+	/** The SGMessaging.Replay console command. */
+	IConsoleObject* ReplayCommand = nullptr;
+
+	/** The replays started by the SGMessaging.Replay console command. */
+	TArray<TUniquePtr<FSGMessageReplayer>> Replayers;
+
+	/** Samples the statistics of all buses once per frame. */
+	FSGMessagingStats Stats;
 };
 
 FName ISGNetworkMessagingExtension::ModularFeatureName("SGNetworkMessaging");
@@ -0,0 +1,379 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Runs microbenchmarks and compares their results against stored baselines.
+ *
+ * Every case is warmed up, then timed over a number of iterations that each perform a batch of operations, so
+ * that the timer resolution does not dominate cheap operations. Percentiles are taken over the per-operation
+ * times of the iterations. The results of a suite are written as JSON to Saved/Benchmarks/SGMessaging, and
+ * compared against the file of the same name in Benchmarks/SGMessaging/Baselines of the project, which can be
+ * overridden with -SGBenchmarkBaselineDir=. A case whose median is slower than its baseline by more than the
+ * tolerance is reported as a warning, or as an error when running with -SGBenchmarkStrict.
+ *
+ * To update a baseline, copy the results of a run on the reference machine over it.
+ */
+class FSGBenchmarkRunner
+{
+public:
+	/** Structure for the results of a benchmark case, in nanoseconds per operation. */
+	struct FResult
+	{
+		/** Holds the name of the case. */
+		FString Name;
+
+		/** Holds the number of timed iterations. */
+		int32 NumIterations = 0;
+
+		/** Holds the number of operations per iteration. */
+		int32 NumOperations = 0;
+
+		/** Holds the fastest iteration. */
+		double Min = 0.0;
+
+		/** Holds the mean of all iterations. */
+		double Mean = 0.0;
+
+		/** Holds the median. */
+		double P50 = 0.0;
+
+		/** Holds the 90th percentile. */
+		double P90 = 0.0;
+
+		/** Holds the 99th percentile. */
+		double P99 = 0.0;
+
+		/** Holds the slowest iteration. */
+		double Max = 0.0;
+
+		/** Gets a human readable summary. */
+		FString ToString() const
+		{
+			return FString::Printf(
+				TEXT("%s: %d x %d ops, min %.1f ns, mean %.1f ns, p50 %.1f ns, p90 %.1f ns, p99 %.1f ns, max %.1f ns"),
+				*Name, NumIterations, NumOperations, Min, Mean, P50, P90, P99, Max);
+		}
+	};
+
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InTest The test to report to.
+	 * @param InSuiteName The name of the suite, which names the result and baseline files.
+	 * @param InTolerance The relative slowdown of the median that counts as a regression.
+	 */
+	FSGBenchmarkRunner(FAutomationTestBase& InTest, const FString& InSuiteName, const double InTolerance = 0.2)
+		: SuiteName(InSuiteName)
+		  , Test(InTest)
+		  , Tolerance(InTolerance)
+	{
+	}
+
+public:
+	/**
+	 * Measures a benchmark case.
+	 *
+	 * @param Name The name of the case.
+	 * @param NumWarmups The number of iterations to run before timing.
+	 * @param NumIterations The number of timed iterations.
+	 * @param NumOperations The number of operations that each iteration performs.
+	 * @param Iteration The function that performs one iteration.
+	 * @return The results.
+	 */
+	const FResult& Measure(const FString& Name, const int32 NumWarmups, const int32 NumIterations,
+	                       const int32 NumOperations, TFunctionRef<void()> Iteration)
+	{
+		for (int32 Index = 0; Index < NumWarmups; ++Index)
+		{
+			Iteration();
+		}
+
+		TArray<double> Samples;
+		Samples.Reserve(NumIterations);
+
+		for (int32 Index = 0; Index < NumIterations; ++Index)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			Iteration();
+			const uint64 EndCycles = FPlatformTime::Cycles64();
+
+			Samples.Add(FPlatformTime::ToSeconds64(EndCycles - StartCycles) * 1e9 / NumOperations);
+		}
+
+		return AddResult(Name, NumOperations, MoveTemp(Samples));
+	}
+
+	/**
+	 * Measures a benchmark case whose iterations can fail.
+	 *
+	 * Measuring stops at the first failed iteration, and the case is not recorded, so that a failure neither waits
+	 * out the remaining iterations nor reports the timings of work that did not complete.
+	 *
+	 * @param Name The name of the case.
+	 * @param NumWarmups The number of iterations to run before timing.
+	 * @param NumIterations The number of timed iterations.
+	 * @param NumOperations The number of operations that each iteration performs.
+	 * @param Iteration The function that performs one iteration, and returns whether it succeeded.
+	 * @return The results, or nullptr if an iteration failed.
+	 */
+	const FResult* MeasureUntilFailure(const FString& Name, const int32 NumWarmups, const int32 NumIterations,
+	                                   const int32 NumOperations, TFunctionRef<bool()> Iteration)
+	{
+		for (int32 Index = 0; Index < NumWarmups; ++Index)
+		{
+			if (!Iteration())
+			{
+				return nullptr;
+			}
+		}
+
+		TArray<double> Samples;
+		Samples.Reserve(NumIterations);
+
+		for (int32 Index = 0; Index < NumIterations; ++Index)
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			const bool bSucceeded = Iteration();
+			const uint64 EndCycles = FPlatformTime::Cycles64();
+
+			if (!bSucceeded)
+			{
+				return nullptr;
+			}
+
+			Samples.Add(FPlatformTime::ToSeconds64(EndCycles - StartCycles) * 1e9 / NumOperations);
+		}
+
+		return &AddResult(Name, NumOperations, MoveTemp(Samples));
+	}
+
+	/**
+	 * Adds a benchmark case that was timed by the caller.
+	 *
+	 * @param Name The name of the case.
+	 * @param NumOperations The number of operations per sample.
+	 * @param Samples The nanoseconds per operation of each sample.
+	 * @return The results.
+	 */
+	const FResult& AddResult(const FString& Name, const int32 NumOperations, TArray<double>&& Samples)
+	{
+		Samples.Sort();
+
+		FResult& Result = Results.AddDefaulted_GetRef();
+		{
+			Result.Name = Name;
+			Result.NumIterations = Samples.Num();
+			Result.NumOperations = NumOperations;
+
+			if (Samples.Num() > 0)
+			{
+				double Sum = 0.0;
+
+				for (const double Sample : Samples)
+				{
+					Sum += Sample;
+				}
+
+				Result.Min = Samples[0];
+				Result.Mean = Sum / Samples.Num();
+				Result.P50 = GetPercentile(Samples, 50.0);
+				Result.P90 = GetPercentile(Samples, 90.0);
+				Result.P99 = GetPercentile(Samples, 99.0);
+				Result.Max = Samples.Last();
+			}
+		}
+
+		Test.AddInfo(Result.ToString());
+
+		return Result;
+	}
+
+	/**
+	 * Writes the results and compares them against the baseline.
+	 *
+	 * @return false if a case regressed in strict mode, true otherwise.
+	 */
+	bool Finish()
+	{
+		WriteResults();
+
+		return CompareWithBaseline();
+	}
+
+private:
+	/** Gets the value at the given percentile of sorted samples. */
+	static double GetPercentile(const TArray<double>& Samples, const double Percentile)
+	{
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile / 100.0 * Samples.Num()) - 1, 0,
+		                                 Samples.Num() - 1);
+
+		return Samples[Index];
+	}
+
+	/** Gets the name of the result and baseline files. */
+	FString GetFilename() const
+	{
+		return SuiteName + TEXT(".json");
+	}
+
+	/** Writes the results to the saved directory. */
+	void WriteResults() const
+	{
+		TArray<TSharedPtr<FJsonValue>> Cases;
+
+		for (const FResult& Result : Results)
+		{
+			const TSharedRef<FJsonObject> Case = MakeShared<FJsonObject>();
+			{
+				Case->SetStringField(TEXT("name"), Result.Name);
+				Case->SetNumberField(TEXT("iterations"), Result.NumIterations);
+				Case->SetNumberField(TEXT("operations"), Result.NumOperations);
+				Case->SetNumberField(TEXT("min"), Result.Min);
+				Case->SetNumberField(TEXT("mean"), Result.Mean);
+				Case->SetNumberField(TEXT("p50"), Result.P50);
+				Case->SetNumberField(TEXT("p90"), Result.P90);
+				Case->SetNumberField(TEXT("p99"), Result.P99);
+				Case->SetNumberField(TEXT("max"), Result.Max);
+			}
+
+			Cases.Add(MakeShared<FJsonValueObject>(Case));
+		}
+
+		const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		{
+			Root->SetStringField(TEXT("suite"), SuiteName);
+			Root->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+			Root->SetStringField(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+			Root->SetNumberField(TEXT("cores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+			Root->SetStringField(TEXT("time"), FDateTime::UtcNow().ToIso8601());
+			Root->SetStringField(TEXT("unit"), TEXT("ns/op"));
+			Root->SetArrayField(TEXT("cases"), Cases);
+		}
+
+		FString Json;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Root, Writer);
+
+		const FString Filename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"), TEXT("SGMessaging"),
+		                                         GetFilename());
+
+		if (FFileHelper::SaveStringToFile(Json, *Filename))
+		{
+			Test.AddInfo(FString::Printf(TEXT("Wrote benchmark results to %s"), *Filename));
+		}
+		else
+		{
+			Test.AddWarning(FString::Printf(TEXT("Failed to write benchmark results to %s"), *Filename));
+		}
+	}
+
+	/** Compares the medians against the baseline, if there is one. */
+	bool CompareWithBaseline() const
+	{
+		FString BaselineDir = FPaths::Combine(FPaths::ProjectDir(), TEXT("Benchmarks"), TEXT("SGMessaging"),
+		                                      TEXT("Baselines"));
+		FParse::Value(FCommandLine::Get(), TEXT("SGBenchmarkBaselineDir="), BaselineDir);
+
+		const FString Filename = FPaths::Combine(BaselineDir, GetFilename());
+
+		FString Json;
+
+		if (!FFileHelper::LoadFileToString(Json, *Filename))
+		{
+			Test.AddInfo(FString::Printf(TEXT("No baseline found at %s"), *Filename));
+
+			return true;
+		}
+
+		TSharedPtr<FJsonObject> Root;
+
+		if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root) || !Root.IsValid())
+		{
+			Test.AddWarning(FString::Printf(TEXT("Failed to parse the baseline %s"), *Filename));
+
+			return true;
+		}
+
+		TMap<FString, double> Baselines;
+		const TArray<TSharedPtr<FJsonValue>>* Cases = nullptr;
+
+		if (Root->TryGetArrayField(TEXT("cases"), Cases))
+		{
+			for (const auto& Case : *Cases)
+			{
+				const TSharedPtr<FJsonObject>* CaseObject = nullptr;
+
+				if (Case->TryGetObject(CaseObject))
+				{
+					Baselines.Add((*CaseObject)->GetStringField(TEXT("name")),
+					              (*CaseObject)->GetNumberField(TEXT("p50")));
+				}
+			}
+		}
+
+		const bool bStrict = FParse::Param(FCommandLine::Get(), TEXT("SGBenchmarkStrict"));
+		bool bPassed = true;
+
+		for (const FResult& Result : Results)
+		{
+			const double* Baseline = Baselines.Find(Result.Name);
+
+			if ((Baseline == nullptr) || (*Baseline <= 0.0))
+			{
+				continue;
+			}
+
+			const double Ratio = Result.P50 / *Baseline;
+
+			if (Ratio <= 1.0 + Tolerance)
+			{
+				continue;
+			}
+
+			const FString Message = FString::Printf(TEXT("%s regressed: p50 %.1f ns against a baseline of %.1f ns (%+.0f%%)"),
+			                                        *Result.Name, Result.P50, *Baseline, (Ratio - 1.0) * 100.0);
+
+			if (bStrict)
+			{
+				Test.AddError(Message);
+				bPassed = false;
+			}
+			else
+			{
+				Test.AddWarning(Message);
+			}
+		}
+
+		return bPassed;
+	}
+
+private:
+	/** Holds the name of the suite. */
+	FString SuiteName;
+
+	/** Holds the results of all cases. */
+	TArray<FResult> Results;
+
+	/** Holds the test to report to. */
+	FAutomationTestBase& Test;
+
+	/** Holds the relative slowdown that counts as a regression. */
+	double Tolerance;
+};
+
+#endif
@@ -0,0 +1,117 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Core/Interface/ISGMessageBridge.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Transport/SGLoopbackTransport.h"
+#include "Tests/SGTransportBenchmark.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGLoopbackTransportTest
+{
+	/** Runs the benchmark over a pair of buses bridged by loopback transports with the given link properties. */
+	FSGTransportBenchmark::FResult RunBridged(FAutomationTestBase& Test, const TCHAR* Name, const FTimespan& Latency,
+	                                          const double Bandwidth, const int32 NumMessages, const int32 PayloadSize)
+	{
+		auto& MessagingModule = ISGMessagingModule::Get();
+
+		const auto FirstBus = MessagingModule.CreateBus(FString::Printf(TEXT("SGLoopbackTransportTest.%s.First"), Name));
+		const auto SecondBus = MessagingModule.CreateBus(FString::Printf(TEXT("SGLoopbackTransportTest.%s.Second"), Name));
+
+		TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe> FirstTransport;
+		TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe> SecondTransport;
+
+		FSGLoopbackTransport::CreatePair(Latency, Bandwidth, FirstTransport, SecondTransport);
+
+		const auto FirstBridge = MessagingModule.CreateBridge(FSGMessageAddress::NewAddress(), FirstBus.ToSharedRef(),
+		                                                      FirstTransport.ToSharedRef());
+		const auto SecondBridge = MessagingModule.CreateBridge(FSGMessageAddress::NewAddress(), SecondBus.ToSharedRef(),
+		                                                       SecondTransport.ToSharedRef());
+
+		FirstBridge->Enable();
+		SecondBridge->Enable();
+
+		FSGTransportBenchmark::FResult Result;
+		{
+			FSGTransportBenchmark Benchmark(FirstBus.ToSharedRef(), SecondBus.ToSharedRef());
+
+			if (Test.TestTrue(FString::Printf(TEXT("%s connects"), Name), Benchmark.Connect(10.0)))
+			{
+				Result = Benchmark.Run(NumMessages, PayloadSize, true, 30.0);
+
+				Test.AddInfo(Result.ToString(Name));
+				Test.AddInfo(FString::Printf(TEXT("%s: %lld messages, %lld bytes encoded"), Name,
+				                             FirstTransport->GetNumMessagesTransported(),
+				                             FirstTransport->GetNumBytesTransported()));
+			}
+		}
+
+		FirstBridge->Disable();
+		SecondBridge->Disable();
+		FirstBus->Shutdown();
+		SecondBus->Shutdown();
+
+		return Result;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGLoopbackTransportBenchmarkTest, "SGMessaging.Transport.Loopback.Benchmark",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::PerfFilter)
+
+
+bool FSGLoopbackTransportBenchmarkTest::RunTest(const FString& Parameters)
+{
+	constexpr auto NumMessages = 20000;
+	constexpr auto PayloadSize = 64;
+
+	// in-process baseline
+	{
+		const auto Bus = ISGMessagingModule::Get().CreateBus(TEXT("SGLoopbackTransportTest.Local"));
+		{
+			FSGTransportBenchmark Benchmark(Bus.ToSharedRef(), Bus.ToSharedRef());
+
+			TestTrue(TEXT("In-process path connects"), Benchmark.Connect(10.0));
+			AddInfo(Benchmark.Run(NumMessages, PayloadSize, true, 30.0).ToString(TEXT("In-process")));
+		}
+		Bus->Shutdown();
+	}
+
+	// bridge and serialization overhead on an ideal link
+	const auto Ideal = SGLoopbackTransportTest::RunBridged(*this, TEXT("Bridged"), FTimespan::Zero(), 0.0,
+	                                                       NumMessages, PayloadSize);
+
+	TestEqual(TEXT("All messages arrive over an ideal link"), Ideal.NumReceived, NumMessages);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGLoopbackTransportLinkTest, "SGMessaging.Transport.Loopback.Link",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGLoopbackTransportLinkTest::RunTest(const FString& Parameters)
+{
+	constexpr auto NumMessages = 200;
+	constexpr auto PayloadSize = 10 * 1024;
+	constexpr auto Bandwidth = 10.0 * 1024 * 1024;
+
+	const auto Latency = FTimespan::FromMilliseconds(5.0);
+
+	const auto Result = SGLoopbackTransportTest::RunBridged(*this, TEXT("Link"), Latency, Bandwidth, NumMessages,
+	                                                        PayloadSize);
+
+	TestEqual(TEXT("All messages arrive"), Result.NumReceived, NumMessages);
+	TestTrue(TEXT("No message arrives before the link latency"),
+	         Result.GetPercentile(0.0) >= Latency.GetTotalMicroseconds());
+	TestTrue(TEXT("Throughput is limited by the link bandwidth"),
+	         Result.Seconds >= NumMessages * PayloadSize / Bandwidth);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,242 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Core/Common/SGSharedBufferMessageAttachment.h"
+#include "Core/Settings/SGMessagingSettings.h"
+#include "SGMessageTestLink.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGMessageAttachmentTransferTest
+{
+	/** The message topic of the test. */
+	constexpr int32 TopicId = 10000;
+
+	/** The message identifier of the message that the receiver publishes to announce itself. */
+	constexpr int32 ReadyId = 1;
+
+	/** The message identifier of the messages that carry attachments. */
+	constexpr int32 SampleId = 2;
+
+	/** The number of seconds to wait for a transfer to give up, which takes a number of resumption timeouts. */
+	constexpr double GiveUpTimeout = 30.0;
+
+	/** Creates attachment data of the given number of chunks and some extra bytes, so that the last chunk is short. */
+	TArray<uint8> MakeData(const int32 NumChunks)
+	{
+		const int32 ChunkSize = FMath::Max(GetDefault<USGMessagingSettings>()->AttachmentChunkSize, 1024);
+
+		TArray<uint8> Data;
+		Data.SetNumUninitialized(NumChunks * ChunkSize + 100);
+
+		for (int32 Index = 0; Index < Data.Num(); ++Index)
+		{
+			Data[Index] = static_cast<uint8>(Index * 31 + Index / 251);
+		}
+
+		return Data;
+	}
+
+	/** Reads all data of an attachment. */
+	TArray<uint8> ReadAttachment(ISGMessageAttachment& Attachment)
+	{
+		TArray<uint8> Data;
+		const TUniquePtr<FArchive> Reader(Attachment.CreateReader());
+
+		if (Reader.IsValid())
+		{
+			Data.SetNumUninitialized(Reader->TotalSize());
+			Reader->Serialize(Data.GetData(), Data.Num());
+		}
+
+		return Data;
+	}
+
+	/** Gets the temporary files that bridges write received attachments to. */
+	TSet<FString> FindTempFiles()
+	{
+		const FString Directory = FPaths::ProjectSavedDir() / TEXT("SGMessaging") / TEXT("Attachments");
+
+		TArray<FString> Filenames;
+		IFileManager::Get().FindFiles(Filenames, *(Directory / TEXT("*.tmp")), true, false);
+
+		return TSet<FString>(MoveTemp(Filenames));
+	}
+
+	/** Gets the number of temporary files that were created since the given ones were found. */
+	int32 CountNewTempFiles(const TSet<FString>& TempFilesBefore)
+	{
+		return FindTempFiles().Difference(TempFilesBefore).Num();
+	}
+
+	/** Sends a message with the given attachment data. */
+	void SendAttachment(const FSGMessageTestReceiver& Sender, const FSGMessageAddress& Recipient,
+	                    const TArray<uint8>& Data)
+	{
+		// the message itself travels through the reliability layer, its attachment is streamed separately
+		const FSGMessageParameter::FSendParameter SendParameter(
+			ESGMessageFlags::Reliable, TMapBuilder<FName, FString>(),
+			MakeShared<FSGSharedBufferMessageAttachment, ESPMode::ThreadSafe>(
+				FSharedBuffer::Clone(Data.GetData(), Data.Num())));
+
+		Sender.GetEndpoint().Send(TopicId, SampleId, Recipient, SendParameter, TEXT("Value"), Data.Num());
+	}
+
+	/** Waits until the stats of a bridge satisfy the given predicate. */
+	template <typename PredicateType>
+	bool WaitForStats(const ISGMessageBridge& Bridge, const double Timeout, PredicateType&& Predicate)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		while (!Predicate(Bridge.GetAttachmentStats()))
+		{
+			if (FPlatformTime::Seconds() - StartTime > Timeout)
+			{
+				return false;
+			}
+
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		return true;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageAttachmentTransferLossyTest, "SGMessaging.Bridge.Attachments.Lossy",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageAttachmentTransferLossyTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageAttachmentTransferTest;
+
+	constexpr int32 NumChunks = 48;
+
+	const TArray<uint8> Data = MakeData(NumChunks);
+	const TSet<FString> TempFilesBefore = FindTempFiles();
+
+	FSGLoopbackFaults Faults;
+	Faults.DropRate = 0.05f;
+	Faults.DuplicateRate = 0.05f;
+	Faults.ReorderRate = 0.05f;
+	Faults.Seed = 3;
+
+	FSGMessageTestLink Link(TEXT("SGMessageAttachmentTransferTest.Lossy"), Faults);
+	{
+		FSGMessageTestReceiver Sender(Link.SenderBus.ToSharedRef(), "SGMessageAttachmentTransferTest.Lossy.Sender",
+		                              ENamedThreads::AnyThread);
+		Sender.Subscribe(TopicId, ReadyId);
+
+		FSGMessageTestReceiver Receiver(Link.ReceiverBus.ToSharedRef(),
+		                                "SGMessageAttachmentTransferTest.Lossy.Receiver", ENamedThreads::AnyThread);
+		Receiver.Subscribe(TopicId, SampleId);
+
+		const auto Recipient = FSGMessageTestLink::Connect(Sender, Receiver, TopicId, ReadyId);
+
+		if (TestTrue(TEXT("The link connects"), Recipient.IsValid()))
+		{
+			SendAttachment(Sender, Recipient, Data);
+
+			TestTrue(TEXT("The message arrives once its attachment is complete"), Receiver.WaitFor(1));
+			TestTrue(TEXT("The sender sees the attachment acknowledged"),
+			         WaitForStats(*Link.SenderBridge, FSGMessageTestReceiver::Timeout,
+			                      [](const FSGMessageAttachmentStats& Stats)
+			                      {
+				                      return Stats.NumCompleted > 0;
+			                      }));
+
+			TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe> Attachment = Receiver.TakeLastAttachment();
+
+			if (TestTrue(TEXT("The message carries its attachment"), Attachment.IsValid()))
+			{
+				TestTrue(TEXT("The chunks are reassembled in order"), ReadAttachment(*Attachment) == Data);
+				TestEqual(TEXT("The attachment is held in a temporary file"), CountNewTempFiles(TempFilesBefore), 1);
+
+				Attachment.Reset();
+
+				TestEqual(TEXT("The temporary file is deleted with the attachment"),
+				          CountNewTempFiles(TempFilesBefore), 0);
+			}
+
+			const auto SenderStats = Link.SenderBridge->GetAttachmentStats();
+			const auto ReceiverStats = Link.ReceiverBridge->GetAttachmentStats();
+
+			TestTrue(TEXT("The attachment is streamed"), SenderStats.NumSent == 1);
+			TestTrue(TEXT("Lost chunks are sent again"), SenderStats.NumChunksSent > NumChunks + 1);
+			TestTrue(TEXT("Transfers resume after lost chunks"), SenderStats.NumResumed > 0);
+			TestTrue(TEXT("The transfer is not given up"), SenderStats.NumFailed == 0);
+			TestTrue(TEXT("Chunks beyond a gap are dropped"), ReceiverStats.NumChunksDropped > 0);
+			TestTrue(TEXT("The attachment is received once"), ReceiverStats.NumReceived == 1);
+		}
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageAttachmentTransferGiveUpTest, "SGMessaging.Bridge.Attachments.GiveUp",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageAttachmentTransferGiveUpTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageAttachmentTransferTest;
+
+	// more chunks than fit into the window, so that the receiver is left with a partial file
+	const TArray<uint8> Data = MakeData(4 * GetDefault<USGMessagingSettings>()->AttachmentWindowSize);
+	const TSet<FString> TempFilesBefore = FindTempFiles();
+
+	FSGMessageTestLink Link(TEXT("SGMessageAttachmentTransferTest.GiveUp"), FSGLoopbackFaults());
+	{
+		FSGMessageTestReceiver Sender(Link.SenderBus.ToSharedRef(), "SGMessageAttachmentTransferTest.GiveUp.Sender",
+		                              ENamedThreads::AnyThread);
+		Sender.Subscribe(TopicId, ReadyId);
+
+		FSGMessageTestReceiver Receiver(Link.ReceiverBus.ToSharedRef(),
+		                                "SGMessageAttachmentTransferTest.GiveUp.Receiver", ENamedThreads::AnyThread);
+		Receiver.Subscribe(TopicId, SampleId);
+
+		const auto Recipient = FSGMessageTestLink::Connect(Sender, Receiver, TopicId, ReadyId);
+
+		if (TestTrue(TEXT("The link connects"), Recipient.IsValid()))
+		{
+			// cut the link towards the sender, so that chunks arrive but are never acknowledged
+			FSGLoopbackFaults Cut;
+			Cut.DropRate = 1.0f;
+
+			Link.SenderTransport->SetFaults(Cut);
+
+			SendAttachment(Sender, Recipient, Data);
+
+			TestTrue(TEXT("The transfer is given up after the maximum number of resumptions"),
+			         WaitForStats(*Link.SenderBridge, GiveUpTimeout, [](const FSGMessageAttachmentStats& Stats)
+			         {
+				         return Stats.NumFailed > 0;
+			         }));
+
+			const auto SenderStats = Link.SenderBridge->GetAttachmentStats();
+
+			TestTrue(TEXT("The stalled transfer is resumed before it is given up"), SenderStats.NumResumed > 0);
+			TestTrue(TEXT("The transfer does not complete"), SenderStats.NumCompleted == 0);
+			TestEqual(TEXT("The message is held back without its attachment"), Receiver.GetNumReceived(), 0);
+			TestEqual(TEXT("The partial attachment is held in a temporary file"),
+			          CountNewTempFiles(TempFilesBefore), 1);
+
+			// incomplete transfers are discarded when the bridge stops
+			Link.ReceiverBridge->Disable();
+
+			TestEqual(TEXT("The partial temporary file is deleted"), CountNewTempFiles(TempFilesBefore), 0);
+			TestTrue(TEXT("The incomplete attachment is discarded"),
+			         Link.ReceiverBridge->GetAttachmentStats().NumDiscarded == 1);
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,404 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformProcess.h"
+#include "Core/Common/SGMessageAwaitables.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "SGMessageTestReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && SG_MESSAGING_WITH_COROUTINES
+
+namespace SGMessageAwaitablesTest
+{
+	/** The message topic of the test. */
+	constexpr int32 TopicId = 9400;
+
+	/** The message identifier of the message that starts the coroutine. */
+	constexpr int32 TriggerId = 1;
+
+	/** The message identifier of requests. */
+	constexpr int32 RequestId = 2;
+
+	/** The message identifier of replies. */
+	constexpr int32 ReplyId = 3;
+
+	/** The message identifier of requests that are never answered. */
+	constexpr int32 IgnoredId = 4;
+
+	/** The number of seconds to wait for the coroutine before giving up. */
+	constexpr double Timeout = 10.0;
+
+	/** Implements a coroutine that starts immediately and that nobody awaits. */
+	struct FDetachedCoroutine
+	{
+		struct promise_type
+		{
+			FDetachedCoroutine get_return_object()
+			{
+				return FDetachedCoroutine();
+			}
+
+			std::suspend_never initial_suspend()
+			{
+				return {};
+			}
+
+			std::suspend_never final_suspend() noexcept
+			{
+				return {};
+			}
+
+			void return_void()
+			{
+			}
+
+			void unhandled_exception()
+			{
+			}
+		};
+	};
+
+	/** Implements a coroutine that starts immediately and that its owner destroys, even while it is suspended. */
+	class FOwnedCoroutine
+	{
+	public:
+		struct promise_type
+		{
+			FOwnedCoroutine get_return_object()
+			{
+				return FOwnedCoroutine(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+
+			std::suspend_never initial_suspend()
+			{
+				return {};
+			}
+
+			std::suspend_always final_suspend() noexcept
+			{
+				return {};
+			}
+
+			void return_void()
+			{
+			}
+
+			void unhandled_exception()
+			{
+			}
+		};
+
+	public:
+		/** Creates and initializes a new instance. */
+		explicit FOwnedCoroutine(const std::coroutine_handle<promise_type> InHandle)
+			: Handle(InHandle)
+		{
+		}
+
+		/** Move constructor. */
+		FOwnedCoroutine(FOwnedCoroutine&& Other)
+			: Handle(Other.Handle)
+		{
+			Other.Handle = nullptr;
+		}
+
+		/** Destructor. */
+		~FOwnedCoroutine()
+		{
+			Destroy();
+		}
+
+	public:
+		/** Destroys the coroutine, wherever it is suspended. */
+		void Destroy()
+		{
+			if (Handle)
+			{
+				Handle.destroy();
+				Handle = nullptr;
+			}
+		}
+
+	private:
+		/** Holds the handle of the coroutine. */
+		std::coroutine_handle<promise_type> Handle;
+	};
+
+	/** Holds what the coroutine observed, which is complete once it is done. */
+	struct FResults
+	{
+		/** Holds the value of the trigger. */
+		int32 TriggerValue = -1;
+
+		/** Holds the value of the reply. */
+		int32 ReplyValue = -1;
+
+		/** Holds the seconds that the delay took. */
+		double DelaySeconds = 0.0;
+
+		/** Holds a flag indicating whether the delay completed as timed out. */
+		bool bDelayElapsed = false;
+
+		/** Holds a flag indicating whether the coroutine finished. */
+		TAtomic<bool> bDone{false};
+	};
+
+	/** Holds where a coroutine resumed, which is complete once it is done. */
+	struct FResumeResults
+	{
+		/** Holds a flag indicating whether the coroutine received the trigger. */
+		bool bTriggered = false;
+
+		/** Holds a flag indicating whether the coroutine resumed on the game thread. */
+		bool bOnGameThread = false;
+
+		/** Holds a flag indicating whether the coroutine finished. */
+		TAtomic<bool> bDone{false};
+	};
+
+	/** Gets the number of subscriptions to a message on the bus, or -1 if the bus did not answer in time. */
+	int32 GetNumSubscriptions(ISGMessageBus& Bus, const int32 MessageId)
+	{
+		TFuture<FSGMessageBusSnapshot> Snapshot = Bus.TakeSnapshot();
+		const FName MessageTag = FSGMessageTagBuilder::Builder(TopicId, MessageId);
+
+		if (!Snapshot.WaitFor(FTimespan::FromSeconds(Timeout)))
+		{
+			return -1;
+		}
+
+		for (const FSGMessageBusTagSnapshot& TagSnapshot : Snapshot.Get().Tags)
+		{
+			if (TagSnapshot.MessageTag == MessageTag)
+			{
+				return TagSnapshot.NumSubscriptions;
+			}
+		}
+
+		return 0;
+	}
+
+	/** Waits for a trigger and resumes on the game thread. */
+	FDetachedCoroutine ResumeOnGameThread(TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe> Endpoint,
+	                                      FResumeResults& Results)
+	{
+		const FSGMessageReply Trigger = co_await FSGMessageAwait::NextMessage(
+			Endpoint, ENamedThreads::GameThread, TopicId, TriggerId);
+
+		Results.bTriggered = Trigger.IsReplied();
+		Results.bOnGameThread = IsInGameThread();
+		Results.bDone = true;
+	}
+
+	/** Waits for a trigger, which never resumes the coroutine if it is destroyed first. */
+	FOwnedCoroutine AwaitTrigger(TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe> Endpoint,
+	                             TAtomic<bool>& bResumed)
+	{
+		co_await FSGMessageAwait::NextMessage(Endpoint, ENamedThreads::AnyThread, TopicId, TriggerId);
+
+		bResumed = true;
+	}
+
+	/** Waits for the reply to a request that is never answered. */
+	FOwnedCoroutine AwaitIgnored(TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe> Endpoint,
+	                             FSGMessageAddress Responder, TAtomic<bool>& bResumed)
+	{
+		co_await FSGMessageAwait::Request(Endpoint, ENamedThreads::AnyThread, TopicId, IgnoredId, Responder,
+		                                  FTimespan::FromSeconds(Timeout), DEFAULT_SEND_PARAMETER);
+
+		bResumed = true;
+	}
+
+	/** Waits for a trigger, requests twice its value and then waits for a while. */
+	FDetachedCoroutine RunSequence(TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe> Endpoint,
+	                               FSGMessageAddress Responder, FResults& Results)
+	{
+		const FSGMessageReply Trigger = co_await FSGMessageAwait::NextMessage(
+			Endpoint, ENamedThreads::AnyThread, TopicId, TriggerId);
+
+		if (const FSGMessage* Message = Trigger.GetMessage())
+		{
+			Results.TriggerValue = Message->Get<int32>(TEXT("Value"));
+
+			const FSGMessageReply Reply = co_await FSGMessageAwait::Request(
+				Endpoint, ENamedThreads::AnyThread, TopicId, RequestId, Responder, FTimespan::FromSeconds(Timeout),
+				DEFAULT_SEND_PARAMETER, TEXT("Value"), Results.TriggerValue);
+
+			if (const FSGMessage* ReplyMessage = Reply.GetMessage())
+			{
+				Results.ReplyValue = ReplyMessage->Get<int32>(TEXT("Value"));
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			const FSGMessageReply Delay = co_await FSGMessageAwait::Delay(
+				Endpoint, ENamedThreads::AnyThread, FTimespan::FromMilliseconds(50));
+
+			Results.DelaySeconds = FPlatformTime::Seconds() - StartTime;
+			Results.bDelayElapsed = Delay.Result == ESGMessageRequestResult::TimedOut;
+		}
+
+		Results.bDone = true;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageAwaitablesTest, "SGMessaging.Endpoint.Awaitables",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageAwaitablesTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageAwaitablesTest;
+
+	const auto Bus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageAwaitablesTest"));
+	{
+		FSGMessageTestResponder Responder(Bus.ToSharedRef(), "SGMessageAwaitablesTest.Responder", TopicId, RequestId,
+		                                  ReplyId);
+		FResults Results;
+
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Awaiting =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageAwaitablesTest.Awaiting",
+			                                                    Bus.ToSharedRef(), FOnBusNotification());
+		Bus->Register(Awaiting->GetAddress(), Awaiting.ToSharedRef());
+		Awaiting->SetRecipientThread(ENamedThreads::AnyThread);
+
+		RunSequence(Awaiting.ToSharedRef(), Responder.GetAddress(), Results);
+
+		// the coroutine subscribed to the trigger when it suspended
+		TestTrue(TEXT("The coroutine subscribes"), Bus->TakeSnapshot().WaitFor(FTimespan::FromSeconds(Timeout)));
+
+		Awaiting->Publish(TopicId, TriggerId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), 21);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		while (!Results.bDone && (FPlatformTime::Seconds() - StartTime < Timeout))
+		{
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		TestTrue(TEXT("The coroutine finishes"), Results.bDone.Load());
+		TestEqual(TEXT("The coroutine receives the trigger"), Results.TriggerValue, 21);
+		TestEqual(TEXT("The coroutine receives the reply"), Results.ReplyValue, 42);
+		TestTrue(TEXT("The delay elapses"), Results.bDelayElapsed);
+		TestTrue(TEXT("The delay takes about as long as requested"), Results.DelaySeconds >= 0.04);
+		TestEqual(TEXT("No waits are left pending"), Awaiting->GetNumPendingRequests(), 0);
+
+		// the subscription for the trigger only lasted as long as the wait
+		TestEqual(TEXT("Waits do not leave subscriptions behind"), GetNumSubscriptions(*Bus, TriggerId), 0);
+
+		FSGMessageEndpoint::SafeRelease(Awaiting);
+	}
+	Bus->Shutdown();
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageAwaitablesResumeThreadTest, "SGMessaging.Endpoint.Awaitables.ResumeThread",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageAwaitablesResumeThreadTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageAwaitablesTest;
+
+	// the game thread only resumes the coroutine once the test processes its tasks
+	if (!TestTrue(TEXT("The test runs on the game thread"), IsInGameThread()))
+	{
+		return true;
+	}
+
+	const auto Bus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageAwaitablesTest.ResumeThread"));
+	{
+		FResumeResults Results;
+
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Awaiting =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageAwaitablesTest.ResumeThread.Awaiting",
+			                                                    Bus.ToSharedRef(), FOnBusNotification());
+		Bus->Register(Awaiting->GetAddress(), Awaiting.ToSharedRef());
+		Awaiting->SetRecipientThread(ENamedThreads::AnyThread);
+
+		ResumeOnGameThread(Awaiting.ToSharedRef(), Results);
+
+		TestTrue(TEXT("The coroutine subscribes"), Bus->TakeSnapshot().WaitFor(FTimespan::FromSeconds(Timeout)));
+
+		Awaiting->Publish(TopicId, TriggerId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), 1);
+
+		// the router completes the awaiter on its own thread, which hands the coroutine to a game thread task
+		TestTrue(TEXT("The router dispatches the trigger"),
+		         Bus->TakeSnapshot().WaitFor(FTimespan::FromSeconds(Timeout)));
+		TestFalse(TEXT("The coroutine does not resume on the completing thread"), Results.bDone.Load());
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		while (!Results.bDone && (FPlatformTime::Seconds() - StartTime < Timeout))
+		{
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		}
+
+		TestTrue(TEXT("The coroutine resumes in a game thread task"), Results.bDone.Load());
+		TestTrue(TEXT("The coroutine receives the trigger"), Results.bTriggered);
+		TestTrue(TEXT("The coroutine resumes on the game thread"), Results.bOnGameThread);
+
+		FSGMessageEndpoint::SafeRelease(Awaiting);
+	}
+	Bus->Shutdown();
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageAwaitablesWithdrawTest, "SGMessaging.Endpoint.Awaitables.Withdraw",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageAwaitablesWithdrawTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageAwaitablesTest;
+
+	const auto Bus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageAwaitablesTest.Withdraw"));
+	{
+		FSGMessageTestResponder Responder(Bus.ToSharedRef(), "SGMessageAwaitablesTest.Withdraw.Responder", TopicId,
+		                                  RequestId, ReplyId);
+		Responder.Ignore(IgnoredId);
+
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Awaiting =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageAwaitablesTest.Withdraw.Awaiting",
+			                                                    Bus.ToSharedRef(), FOnBusNotification());
+		Bus->Register(Awaiting->GetAddress(), Awaiting.ToSharedRef());
+		Awaiting->SetRecipientThread(ENamedThreads::AnyThread);
+
+		TAtomic<bool> bTriggerResumed(false);
+		TAtomic<bool> bRequestResumed(false);
+
+		FOwnedCoroutine TriggerWait = AwaitTrigger(Awaiting.ToSharedRef(), bTriggerResumed);
+		FOwnedCoroutine RequestWait = AwaitIgnored(Awaiting.ToSharedRef(), Responder.GetAddress(), bRequestResumed);
+
+		TestEqual(TEXT("The trigger wait subscribes"), GetNumSubscriptions(*Bus, TriggerId), 1);
+		TestEqual(TEXT("The request waits for a reply"), Awaiting->GetNumPendingRequests(), 1);
+
+		// destroying the suspended coroutines withdraws their awaiters from the endpoint
+		TriggerWait.Destroy();
+		RequestWait.Destroy();
+
+		TestEqual(TEXT("The withdrawn request is no longer pending"), Awaiting->GetNumPendingRequests(), 0);
+		TestEqual(TEXT("The withdrawn wait unsubscribes"), GetNumSubscriptions(*Bus, TriggerId), 0);
+
+		Awaiting->Publish(TopicId, TriggerId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), 1);
+
+		TestTrue(TEXT("The router dispatches the trigger"),
+		         Bus->TakeSnapshot().WaitFor(FTimespan::FromSeconds(Timeout)));
+		TestFalse(TEXT("A withdrawn wait does not resume"), bTriggerResumed.Load());
+		TestFalse(TEXT("A withdrawn request does not resume"), bRequestResumed.Load());
+
+		FSGMessageEndpoint::SafeRelease(Awaiting);
+	}
+	Bus->Shutdown();
+
+	return true;
+}
+
+#endif
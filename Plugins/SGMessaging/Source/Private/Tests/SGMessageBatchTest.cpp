@@ -0,0 +1,138 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "SGMessageTestReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGMessageBatchTest
+{
+	/** The message topic of the test. */
+	constexpr int32 TopicId = 9500;
+
+	/** The number of message identifiers that a batch cycles through. */
+	constexpr int32 NumMessageIds = 3;
+
+	/** Builds a batch of messages whose values count up from the given value. */
+	void BuildBatch(FSGMessageBatch& Batch, const int32 FirstValue, const int32 Number)
+	{
+		Batch.Reserve(Number);
+
+		for (int32 Index = 0; Index < Number; ++Index)
+		{
+			Batch.Add(TopicId, Index % NumMessageIds, TEXT("Value"), FirstValue + Index);
+		}
+	}
+
+	/** Checks whether the values count up from the given value. */
+	bool IsSequence(const TArray<int32>& Values, const int32 Offset, const int32 FirstValue, const int32 Number)
+	{
+		for (int32 Index = 0; Index < Number; ++Index)
+		{
+			if (!Values.IsValidIndex(Offset + Index) || (Values[Offset + Index] != FirstValue + Index))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageBatchTest, "SGMessaging.Bus.Batch",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageBatchTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageBatchTest;
+
+	constexpr int32 NumMessages = 300;
+
+	const auto Bus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageBatchTest"));
+	{
+		FSGMessageTestReceiver Receiver(Bus.ToSharedRef(), "SGMessageBatchTest.Receiver", ENamedThreads::AnyThread);
+
+		// the test runs on the game thread, so messages stay queued up until it processes the game thread tasks
+		FSGMessageTestReceiver GameThreadReceiver(Bus.ToSharedRef(), "SGMessageBatchTest.GameThreadReceiver",
+		                                          ENamedThreads::GameThread);
+
+		for (int32 MessageId = 0; MessageId < NumMessageIds; ++MessageId)
+		{
+			Receiver.Subscribe(TopicId, MessageId);
+			GameThreadReceiver.Subscribe(TopicId, MessageId);
+		}
+
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Sender =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageBatchTest.Sender", Bus.ToSharedRef(),
+			                                                    FOnBusNotification());
+		Bus->Register(Sender->GetAddress(), Sender.ToSharedRef());
+
+		TestTrue(TEXT("The receiver subscribes"), FSGMessageTestReceiver::WaitForRouter(*Bus));
+
+		const int64 NumSentBefore = Bus->GetStats().NumSent;
+
+		// published batches reach the subscribers in the order of the batch
+		FSGMessageBatch Batch;
+		BuildBatch(Batch, 0, NumMessages);
+
+		Sender->PublishBatch(Batch, DEFAULT_PUBLISH_PARAMETER);
+
+		TestTrue(TEXT("The bus takes the messages of the batch"), Batch.IsEmpty());
+		TestTrue(TEXT("All published messages arrive"), Receiver.WaitFor(NumMessages));
+		TestTrue(TEXT("Published messages arrive in order"), IsSequence(Receiver.GetValues(), 0, 0, NumMessages));
+		TestEqual(TEXT("Every message of the batch counts as sent"), Bus->GetStats().NumSent - NumSentBefore,
+		          static_cast<int64>(NumMessages));
+
+		// recipients on a named thread drain the batch in one task
+		TestTrue(TEXT("The router routes the published batch"), FSGMessageTestReceiver::WaitForRouter(*Bus));
+		TestEqual(TEXT("The game thread handles no message before it processes its tasks"),
+		          GameThreadReceiver.GetNumReceived(), 0);
+
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+
+		TestEqual(TEXT("All published messages arrive on the game thread"), GameThreadReceiver.GetNumReceived(),
+		          NumMessages);
+		TestTrue(TEXT("Published messages arrive in order on the game thread"),
+		         IsSequence(GameThreadReceiver.GetValues(), 0, 0, NumMessages));
+
+		// sent batches reach their recipient in the order of the batch
+		BuildBatch(Batch, NumMessages, NumMessages);
+
+		Sender->SendBatch(Batch, Receiver.GetAddress(), DEFAULT_SEND_PARAMETER);
+
+		TestTrue(TEXT("All sent messages arrive"), Receiver.WaitFor(2 * NumMessages));
+		TestTrue(TEXT("Sent messages arrive in order"),
+		         IsSequence(Receiver.GetValues(), NumMessages, NumMessages, NumMessages));
+
+		BuildBatch(Batch, 2 * NumMessages, NumMessages);
+
+		Sender->SendBatch(Batch, GameThreadReceiver.GetAddress(), DEFAULT_SEND_PARAMETER);
+
+		TestTrue(TEXT("The router routes the sent batch"), FSGMessageTestReceiver::WaitForRouter(*Bus));
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+
+		TestEqual(TEXT("All sent messages arrive on the game thread"), GameThreadReceiver.GetNumReceived(),
+		          2 * NumMessages);
+		TestTrue(TEXT("Sent messages arrive in order on the game thread"),
+		         IsSequence(GameThreadReceiver.GetValues(), NumMessages, 2 * NumMessages, NumMessages));
+
+		// disabled endpoints keep their batches
+		BuildBatch(Batch, 0, NumMessageIds);
+
+		Sender->Disable();
+		Sender->PublishBatch(Batch, DEFAULT_PUBLISH_PARAMETER);
+
+		TestEqual(TEXT("Disabled endpoints keep their batches"), Batch.Num(), NumMessageIds);
+
+		FSGMessageEndpoint::SafeRelease(Sender);
+	}
+	Bus->Shutdown();
+
+	return true;
+}
+
+#endif
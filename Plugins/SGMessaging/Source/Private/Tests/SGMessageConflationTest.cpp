@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "SGMessageTestReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGMessageConflationTest
+{
+	/** The message topic of the test. */
+	constexpr int32 TopicId = 9600;
+
+	/** The message identifier of messages conflated by tag. */
+	constexpr int32 StateId = 1;
+
+	/** The message identifier of messages conflated by annotation. */
+	constexpr int32 EntityStateId = 2;
+
+	/** The message identifier of messages that are not conflated. */
+	constexpr int32 EventId = 3;
+
+	/** The name of the annotation that holds the entity of a message. */
+	const FName EntityKey(TEXT("Entity"));
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageConflationTest, "SGMessaging.Bus.Conflation",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageConflationTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageConflationTest;
+
+	constexpr int32 NumMessages = 100;
+	constexpr int32 NumEntities = 2;
+
+	const auto Bus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageConflationTest"));
+	{
+		// the test runs on the game thread, so messages stay queued up until it processes the game thread tasks
+		FSGMessageTestReceiver Receiver(Bus.ToSharedRef(), "SGMessageConflationTest.Receiver",
+		                                ENamedThreads::GameThread);
+		Receiver.Subscribe(TopicId, StateId);
+		Receiver.Subscribe(TopicId, EntityStateId);
+		Receiver.Subscribe(TopicId, EventId);
+
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Sender =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageConflationTest.Sender", Bus.ToSharedRef(),
+			                                                    FOnBusNotification());
+		Bus->Register(Sender->GetAddress(), Sender.ToSharedRef());
+
+		Sender->Conflate(TopicId, StateId, FSGMessageConflation::ByTag());
+		Sender->Conflate(TopicId, EntityStateId, FSGMessageConflation::ByAnnotation(EntityKey));
+
+		TestTrue(TEXT("The receiver subscribes"), FSGMessageTestReceiver::WaitForRouter(*Bus));
+
+		const int64 NumConflatedBefore = Bus->GetStats().NumConflated;
+
+		for (int32 Index = 0; Index < NumMessages; ++Index)
+		{
+			const FSGMessageParameter::FPublishParameter EntityParameter(
+				ESGMessageScope::Network,
+				TMapBuilder<FName, FString>().Add(EntityKey, LexToString(Index % NumEntities)));
+
+			Sender->Publish(TopicId, StateId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), Index);
+			Sender->Publish(TopicId, EntityStateId, EntityParameter, TEXT("Value"), Index);
+			Sender->Publish(TopicId, EventId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), Index);
+		}
+
+		// the game thread only handles the messages once the router dispatched all of them
+		TestTrue(TEXT("The router routes all messages"), FSGMessageTestReceiver::WaitForRouter(*Bus));
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+
+		const TArray<int32> States = Receiver.GetValues(TopicId, StateId);
+		const TArray<int32> EntityStates = Receiver.GetValues(TopicId, EntityStateId);
+
+		TestEqual(TEXT("Only the latest state is handled"), States.Num(), 1);
+		TestTrue(TEXT("The latest state wins"), (States.Num() > 0) && (States.Last() == NumMessages - 1));
+
+		TestEqual(TEXT("Only the latest state of each entity is handled"), EntityStates.Num(), NumEntities);
+		TestTrue(TEXT("The latest state of each entity wins"),
+		         (EntityStates.Num() == NumEntities) &&
+		         (EntityStates[0] == NumMessages - 2) && (EntityStates[1] == NumMessages - 1));
+
+		TestEqual(TEXT("Messages that are not conflated are all handled"),
+		          Receiver.GetValues(TopicId, EventId).Num(), NumMessages);
+		TestEqual(TEXT("Replaced messages are counted"), Bus->GetStats().NumConflated - NumConflatedBefore,
+		          static_cast<int64>(2 * NumMessages - 1 - NumEntities));
+
+		Sender->Unconflate(TopicId, StateId);
+		Sender->Unconflate(TopicId, EntityStateId);
+
+		FSGMessageEndpoint::SafeRelease(Sender);
+	}
+	Bus->Shutdown();
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,164 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Core/Interface/ISGMessageBridge.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Transport/SGLoopbackTransport.h"
+#include "SGMessageTestReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGMessageInterestTest
+{
+	/** The message topic of the test. */
+	constexpr int32 TopicId = 9900;
+
+	/** The message identifier of the messages whose forwarding is tested. */
+	constexpr int32 SampleId = 1;
+
+	/** The message identifier of the message that follows every sample, which the remote bus always subscribes to. */
+	constexpr int32 MarkerId = 2;
+
+	/**
+	 * Publishes a sample followed by a marker, and finds out whether the bridge transported the sample.
+	 *
+	 * The router hands both messages to the bridge in order, and the link delivers them in order. Once the marker
+	 * arrived on the remote bus, the bridge has therefore decided about the sample.
+	 *
+	 * @param Publisher The endpoint to publish from.
+	 * @param Transport The transport of the publishing bus.
+	 * @param Receiver The receiver of the markers on the remote bus.
+	 * @param bOutTransported Will be set to whether the sample was transported.
+	 * @return true if the marker arrived, false otherwise.
+	 */
+	bool PublishSample(FSGMessageEndpoint& Publisher, const FSGLoopbackTransport& Transport,
+	                   const FSGMessageTestReceiver& Receiver, bool& bOutTransported)
+	{
+		const int32 NumMarkers = Receiver.GetValues(TopicId, MarkerId).Num();
+		const int64 NumTransportedBefore = Transport.GetNumMessagesTransported();
+
+		Publisher.Publish(TopicId, SampleId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), 0);
+		Publisher.Publish(TopicId, MarkerId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), NumMarkers);
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		while (Receiver.GetValues(TopicId, MarkerId).Num() == NumMarkers)
+		{
+			if (FPlatformTime::Seconds() - StartTime > FSGMessageTestReceiver::Timeout)
+			{
+				return false;
+			}
+
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		// the marker itself was transported as well
+		bOutTransported = Transport.GetNumMessagesTransported() - NumTransportedBefore > 1;
+
+		return true;
+	}
+
+	/**
+	 * Publishes samples until the bridge transports them or not, as expected.
+	 *
+	 * Interest reports travel asynchronously, and nodes that did not report yet receive all messages, so the
+	 * bridge only settles after a while.
+	 *
+	 * @return true if the bridge settled as expected, false otherwise.
+	 */
+	bool WaitForForwarding(FSGMessageEndpoint& Publisher, const FSGLoopbackTransport& Transport,
+	                       const FSGMessageTestReceiver& Receiver, const bool bExpected)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		bool bTransported = !bExpected;
+
+		while (FPlatformTime::Seconds() - StartTime < FSGMessageTestReceiver::Timeout)
+		{
+			if (!PublishSample(Publisher, Transport, Receiver, bTransported))
+			{
+				return false;
+			}
+
+			if (bTransported == bExpected)
+			{
+				return true;
+			}
+
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		return false;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageInterestTest, "SGMessaging.Bridge.Interest",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageInterestTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageInterestTest;
+
+	auto& MessagingModule = ISGMessagingModule::Get();
+
+	const auto PublisherBus = MessagingModule.CreateBus(TEXT("SGMessageInterestTest.Publisher"));
+	const auto SubscriberBus = MessagingModule.CreateBus(TEXT("SGMessageInterestTest.Subscriber"));
+
+	TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe> PublisherTransport;
+	TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe> SubscriberTransport;
+
+	FSGLoopbackTransport::CreatePair(FTimespan::Zero(), 0.0, PublisherTransport, SubscriberTransport);
+
+	const auto PublisherBridge = MessagingModule.CreateBridge(FSGMessageAddress::NewAddress(),
+	                                                          PublisherBus.ToSharedRef(),
+	                                                          PublisherTransport.ToSharedRef());
+	const auto SubscriberBridge = MessagingModule.CreateBridge(FSGMessageAddress::NewAddress(),
+	                                                           SubscriberBus.ToSharedRef(),
+	                                                           SubscriberTransport.ToSharedRef());
+
+	PublisherBridge->Enable();
+	SubscriberBridge->Enable();
+	{
+		FSGMessageTestReceiver Receiver(SubscriberBus.ToSharedRef(), "SGMessageInterestTest.Receiver",
+		                                ENamedThreads::AnyThread);
+		Receiver.Subscribe(TopicId, MarkerId);
+
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Publisher =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageInterestTest.Publisher",
+			                                                    PublisherBus.ToSharedRef(), FOnBusNotification());
+		PublisherBus->Register(Publisher->GetAddress(), Publisher.ToSharedRef());
+
+		TestTrue(TEXT("Samples are not forwarded without a remote subscription"),
+		         WaitForForwarding(*Publisher, *PublisherTransport, Receiver, false));
+
+		Receiver.Subscribe(TopicId, SampleId);
+
+		TestTrue(TEXT("Samples are forwarded once the remote subscription is reported"),
+		         WaitForForwarding(*Publisher, *PublisherTransport, Receiver, true));
+		TestTrue(TEXT("Forwarded samples arrive"), Receiver.GetValues(TopicId, SampleId).Num() > 0);
+
+		Receiver.Unsubscribe(TopicId, SampleId);
+
+		TestTrue(TEXT("Samples are no longer forwarded once the remote subscription is withdrawn"),
+		         WaitForForwarding(*Publisher, *PublisherTransport, Receiver, false));
+
+		// the remote node stays settled, rather than flipping back to receiving everything
+		bool bTransported = true;
+
+		TestTrue(TEXT("The marker of a later sample arrives"),
+		         PublishSample(*Publisher, *PublisherTransport, Receiver, bTransported));
+		TestFalse(TEXT("Later samples are not forwarded either"), bTransported);
+
+		FSGMessageEndpoint::SafeRelease(Publisher);
+	}
+	PublisherBridge->Disable();
+	SubscriberBridge->Disable();
+	PublisherBus->Shutdown();
+	SubscriberBus->Shutdown();
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,291 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Core/Bus/SGMessageReplayer.h"
+#include "Core/Common/SGMessageEndpoint.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Serialization/SGMessageWireFormat.h"
+#include "SGMessageTestReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGMessageRecordingTest
+{
+	/** The message topic of the test. */
+	constexpr int32 TopicId = 9200;
+
+	/** The message identifier of samples. */
+	constexpr int32 SampleId = 1;
+
+	/**
+	 * Copies a recording as if another process had made it, by replacing the node of its addresses.
+	 *
+	 * The copy is written uncompressed as a single chunk.
+	 *
+	 * @param SourceFilename The name of the recording to copy.
+	 * @param TargetFilename The name of the copy.
+	 * @param NodeId The transport node identifier of the other process.
+	 * @return The number of copied messages, or INDEX_NONE if the recording could not be copied.
+	 */
+	int32 CopyAsForeign(const FString& SourceFilename, const FString& TargetFilename, const FGuid& NodeId)
+	{
+		FSGMessageRecordingReader Reader(SourceFilename);
+
+		if (!Reader.IsValid())
+		{
+			return INDEX_NONE;
+		}
+
+		// the node is the upper 96 bits of the GUID form of an address
+		constexpr int32 PrefixSize = 3 * sizeof(uint32);
+		const FGuid RecordedNodeId = Reader.GetNodeId();
+
+		TArray<uint8> Chunk;
+		int32 NumMessages = 0;
+		FDateTime RouteTime;
+		FSharedBuffer Buffer;
+
+		while (Reader.Next(RouteTime, Buffer))
+		{
+			const int64 RouteTicks = RouteTime.GetTicks();
+			Chunk.Append(reinterpret_cast<const uint8*>(&RouteTicks), FSGMessageRecordingFormat::RecordHeaderSize);
+
+			const int32 Start = Chunk.Num();
+			Chunk.Append(static_cast<const uint8*>(Buffer.GetData()), static_cast<int32>(Buffer.GetSize()));
+
+			for (int32 Offset = Start; Offset + PrefixSize <= Chunk.Num(); ++Offset)
+			{
+				if (FMemory::Memcmp(Chunk.GetData() + Offset, &RecordedNodeId, PrefixSize) == 0)
+				{
+					FMemory::Memcpy(Chunk.GetData() + Offset, &NodeId, PrefixSize);
+				}
+			}
+
+			++NumMessages;
+		}
+
+		const TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*TargetFilename));
+
+		if (!Archive.IsValid())
+		{
+			return INDEX_NONE;
+		}
+
+		uint8 Magic[] = {'S', 'G', 'R', 'C'};
+		uint8 Version = FSGMessageRecordingFormat::Version;
+		int64 StartTicks = Reader.GetStartTime().GetTicks();
+		FGuid ForeignNodeId = NodeId;
+		uint32 Size = Chunk.Num();
+		uint32 StoredSize = Size;
+
+		Archive->Serialize(Magic, sizeof(Magic));
+		*Archive << Version;
+		*Archive << StartTicks;
+		*Archive << ForeignNodeId;
+		*Archive << Size;
+		*Archive << StoredSize;
+		Archive->Serialize(Chunk.GetData(), Chunk.Num());
+
+		return Archive->Close() ? NumMessages : INDEX_NONE;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageRecordingTest, "SGMessaging.Bus.Recording",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageRecordingTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageRecordingTest;
+
+	constexpr int32 NumMessages = 1000;
+
+	const FString Filename = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("SGMessageRecordingTest.sgrec"));
+	const FName MessageTag = FSGMessageTagBuilder::Builder(TopicId, SampleId);
+
+	// record a stream of published messages
+	const auto RecordBus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageRecordingTest.Record"));
+	{
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Publisher =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageRecordingTest.Publisher",
+			                                                    RecordBus.ToSharedRef(), FOnBusNotification());
+		RecordBus->Register(Publisher->GetAddress(), Publisher.ToSharedRef());
+
+		TestTrue(TEXT("Recording starts"), RecordBus->StartRecording(Filename));
+
+		for (int32 Index = 0; Index < NumMessages; ++Index)
+		{
+			Publisher->Publish(TopicId, SampleId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), Index);
+		}
+
+		// the recording is completed once the router released the recorder
+		RecordBus->StopRecording();
+		TestTrue(TEXT("The router completes the recording"), FSGMessageTestReceiver::WaitForRouter(*RecordBus));
+
+		FSGMessageEndpoint::SafeRelease(Publisher);
+	}
+	RecordBus->Shutdown();
+
+	// read the recording back
+	{
+		FSGMessageRecordingReader Reader(Filename);
+
+		if (!TestTrue(TEXT("The recording is readable"), Reader.IsValid()))
+		{
+			return false;
+		}
+
+		int32 NumRecorded = 0;
+		bool bInOrder = true;
+		FDateTime PreviousRouteTime = Reader.GetStartTime();
+		FDateTime RouteTime;
+		FSharedBuffer Buffer;
+
+		while (Reader.Next(RouteTime, Buffer))
+		{
+			const FSGMessageWireReader WireReader(static_cast<const uint8*>(Buffer.GetData()),
+			                                      static_cast<int32>(Buffer.GetSize()));
+
+			bInOrder &= WireReader.IsValid() && (WireReader.GetMessageTag() == MessageTag) &&
+				(WireReader.Get<int32>(TEXT("Value")) == NumRecorded) && (RouteTime >= PreviousRouteTime);
+
+			PreviousRouteTime = RouteTime;
+			++NumRecorded;
+		}
+
+		TestEqual(TEXT("All messages are recorded"), NumRecorded, NumMessages);
+		TestTrue(TEXT("Messages are recorded in order with their tags and parameters"), bInOrder);
+	}
+
+	// replay it at max speed against a fresh bus
+	const auto ReplayBus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageRecordingTest.Replay"));
+	{
+		FSGMessageTestReceiver Receiver(ReplayBus.ToSharedRef(), TEXT("SGMessageRecordingTest.Receiver"),
+		                                ENamedThreads::AnyThread);
+		Receiver.Subscribe(TopicId, SampleId);
+		TestTrue(TEXT("The receiver subscribes"), FSGMessageTestReceiver::WaitForRouter(*ReplayBus));
+
+		FSGMessageReplayer Replayer(ReplayBus.ToSharedRef(), Filename, 0.0);
+
+		if (TestTrue(TEXT("The replay starts"), Replayer.Start()))
+		{
+			TestTrue(TEXT("All replayed messages are delivered"), Receiver.WaitFor(NumMessages));
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			while (!Replayer.IsDone() && (FPlatformTime::Seconds() - StartTime < FSGMessageTestReceiver::Timeout))
+			{
+				FPlatformProcess::Sleep(0.001f);
+			}
+
+			const TArray<int32> Values = Receiver.GetValues();
+			bool bReplayedInOrder = (Values.Num() == NumMessages);
+
+			for (int32 Index = 0; bReplayedInOrder && (Index < NumMessages); ++Index)
+			{
+				bReplayedInOrder = (Values[Index] == Index);
+			}
+
+			TestEqual(TEXT("All messages are replayed"), Replayer.GetNumReplayed(), static_cast<int64>(NumMessages));
+			TestTrue(TEXT("Replayed messages keep their order and parameters"), bReplayedInOrder);
+		}
+	}
+	ReplayBus->Shutdown();
+
+	IFileManager::Get().Delete(*Filename);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageForeignReplayTest, "SGMessaging.Bus.Recording.ForeignReplay",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageForeignReplayTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageRecordingTest;
+
+	constexpr int32 NumMessages = 100;
+
+	const FString Filename = FPaths::Combine(FPaths::AutomationTransientDir(),
+	                                         TEXT("SGMessageForeignReplayTest.sgrec"));
+	const FString ForeignFilename = FPaths::Combine(FPaths::AutomationTransientDir(),
+	                                                TEXT("SGMessageForeignReplayTest.Foreign.sgrec"));
+
+	const auto Bus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageForeignReplayTest"));
+	{
+		FSGMessageTestReceiver Receiver(Bus.ToSharedRef(), TEXT("SGMessageForeignReplayTest.Receiver"),
+		                                ENamedThreads::AnyThread);
+		Receiver.Subscribe(TopicId, SampleId);
+
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Sender =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageForeignReplayTest.Sender",
+			                                                    Bus.ToSharedRef(), FOnBusNotification());
+		Bus->Register(Sender->GetAddress(), Sender.ToSharedRef());
+
+		// record messages sent to the receiver, which it also receives right away
+		TestTrue(TEXT("Recording starts"), Bus->StartRecording(Filename));
+
+		for (int32 Index = 0; Index < NumMessages; ++Index)
+		{
+			Sender->Send(TopicId, SampleId, Receiver.GetAddress(), DEFAULT_SEND_PARAMETER, TEXT("Value"), Index);
+		}
+
+		Bus->StopRecording();
+		TestTrue(TEXT("The router completes the recording"), FSGMessageTestReceiver::WaitForRouter(*Bus));
+		TestTrue(TEXT("The sent messages are received"), Receiver.WaitFor(NumMessages));
+
+		// make the recording look like another process made it, whose node this process does not know
+		const FGuid ForeignNodeId = FGuid::NewGuid();
+
+		TestEqual(TEXT("The recording is copied"), CopyAsForeign(Filename, ForeignFilename, ForeignNodeId),
+		          NumMessages);
+		TestFalse(TEXT("The foreign node is unknown"),
+		          FSGMessageAddress::FromGuid(FGuid(ForeignNodeId.A, ForeignNodeId.B, ForeignNodeId.C, 1)).IsValid());
+
+		FSGMessageReplayer Replayer(Bus.ToSharedRef(), ForeignFilename, 0.0);
+
+		if (TestTrue(TEXT("The replay starts"), Replayer.Start()))
+		{
+			// the addresses of the recording process map to the local endpoints at the same slots
+			TestTrue(TEXT("The replayed messages reach their recipient"), Receiver.WaitFor(2 * NumMessages));
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			while (!Replayer.IsDone() && (FPlatformTime::Seconds() - StartTime < FSGMessageTestReceiver::Timeout))
+			{
+				FPlatformProcess::Sleep(0.001f);
+			}
+
+			TArray<int32> Expected;
+
+			for (int32 Pass = 0; Pass < 2; ++Pass)
+			{
+				for (int32 Index = 0; Index < NumMessages; ++Index)
+				{
+					Expected.Add(Index);
+				}
+			}
+
+			TestEqual(TEXT("All messages are replayed"), Replayer.GetNumReplayed(), static_cast<int64>(NumMessages));
+			TestTrue(TEXT("Replayed messages are received once and in order"), Receiver.GetValues() == Expected);
+		}
+
+		FSGMessageEndpoint::SafeRelease(Sender);
+	}
+	Bus->Shutdown();
+
+	IFileManager::Get().Delete(*Filename);
+	IFileManager::Get().Delete(*ForeignFilename);
+
+	return true;
+}
+
+#endif
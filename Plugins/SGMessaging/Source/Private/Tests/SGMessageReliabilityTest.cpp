@@ -0,0 +1,259 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "SGMessageTestLink.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGMessageReliabilityTest
+{
+	/** The message topic of the test. */
+	constexpr int32 TopicId = 9800;
+
+	/** The message identifier of the message that the receiver publishes to announce itself. */
+	constexpr int32 ReadyId = 1;
+
+	/** The message identifier of the messages that are sent reliably. */
+	constexpr int32 SampleId = 2;
+
+	/** The number of seconds to wait for the reliability layer to give up on lost messages. */
+	constexpr double GiveUpTimeout = 30.0;
+
+	/**
+	 * Sends a range of values to the receiver.
+	 *
+	 * @param Sender The endpoint on the sender bus.
+	 * @param Recipient The address of the receiver.
+	 * @param First The first value to send.
+	 * @param Num The number of values to send.
+	 * @param Flags The flags of the messages.
+	 */
+	void Send(const FSGMessageTestReceiver& Sender, const FSGMessageAddress& Recipient, const int32 First,
+	          const int32 Num, const ESGMessageFlags Flags)
+	{
+		const FSGMessageParameter::FSendParameter SendParameter(Flags);
+
+		for (int32 Value = First; Value < First + Num; ++Value)
+		{
+			Sender.GetEndpoint().Send(TopicId, SampleId, Recipient, SendParameter, TEXT("Value"), Value);
+		}
+	}
+
+	/** Waits until the sender's reliability layer acknowledged or gave up the specified number of messages. */
+	bool WaitForSender(const FSGMessageTestLink& Link, const int64 NumAcknowledged, const int64 NumFailed,
+	                   const double Timeout)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		while (FPlatformTime::Seconds() - StartTime < Timeout)
+		{
+			const auto Stats = Link.SenderBridge->GetReliabilityStats();
+
+			if (Stats.NumAcknowledged >= NumAcknowledged && Stats.NumFailed >= NumFailed)
+			{
+				return true;
+			}
+
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		return false;
+	}
+
+	/** Gets the values from First to First + Num - 1. */
+	TArray<int32> MakeRange(const int32 First, const int32 Num)
+	{
+		TArray<int32> Values;
+
+		for (int32 Value = First; Value < First + Num; ++Value)
+		{
+			Values.Add(Value);
+		}
+
+		return Values;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageReliabilityOrderedTest, "SGMessaging.Bridge.Reliability.Ordered",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageReliabilityOrderedTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageReliabilityTest;
+
+	constexpr int32 NumMessages = 500;
+
+	FSGLoopbackFaults Faults;
+	Faults.DropRate = 0.1f;
+	Faults.DuplicateRate = 0.1f;
+	Faults.ReorderRate = 0.1f;
+	Faults.Seed = 1;
+
+	FSGMessageTestLink Link(TEXT("SGMessageReliabilityTest.Ordered"), Faults);
+	{
+		FSGMessageTestReceiver Sender(Link.SenderBus.ToSharedRef(), "SGMessageReliabilityTest.Ordered.Sender",
+		                              ENamedThreads::AnyThread);
+		Sender.Subscribe(TopicId, ReadyId);
+
+		FSGMessageTestReceiver Receiver(Link.ReceiverBus.ToSharedRef(), "SGMessageReliabilityTest.Ordered.Receiver",
+		                                ENamedThreads::AnyThread);
+		Receiver.Subscribe(TopicId, SampleId);
+
+		const auto Recipient = FSGMessageTestLink::Connect(Sender, Receiver, TopicId, ReadyId);
+
+		if (TestTrue(TEXT("The link connects"), Recipient.IsValid()))
+		{
+			Send(Sender, Recipient, 0, NumMessages, ESGMessageFlags::Reliable | ESGMessageFlags::Ordered);
+
+			TestTrue(TEXT("All messages arrive"), Receiver.WaitFor(NumMessages));
+			TestTrue(TEXT("All messages are acknowledged"),
+			         WaitForSender(Link, NumMessages, 0, FSGMessageTestReceiver::Timeout));
+
+			// late duplicates of acknowledged messages must still be suppressed
+			TestTrue(TEXT("The receiver bus is idle"), FSGMessageTestReceiver::WaitForRouter(*Link.ReceiverBus));
+			TestTrue(TEXT("Every message arrives exactly once and in order"),
+			         Receiver.GetValues(TopicId, SampleId) == MakeRange(0, NumMessages));
+
+			const auto SenderStats = Link.SenderBridge->GetReliabilityStats();
+			const auto ReceiverStats = Link.ReceiverBridge->GetReliabilityStats();
+
+			TestTrue(TEXT("Lost messages are retransmitted"), SenderStats.NumRetransmitted > 0);
+			TestTrue(TEXT("No message is given up"), SenderStats.NumFailed == 0);
+			TestTrue(TEXT("Duplicates are suppressed"), ReceiverStats.NumDuplicates > 0);
+			TestTrue(TEXT("Gaps are detected"), ReceiverStats.NumOutOfOrder > 0);
+			TestTrue(TEXT("Messages after a gap are held back"), ReceiverStats.NumHeldBack > 0);
+		}
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageReliabilityUnorderedTest, "SGMessaging.Bridge.Reliability.Unordered",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageReliabilityUnorderedTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageReliabilityTest;
+
+	constexpr int32 NumMessages = 500;
+
+	FSGLoopbackFaults Faults;
+	Faults.DropRate = 0.1f;
+	Faults.DuplicateRate = 0.1f;
+	Faults.Seed = 2;
+
+	FSGMessageTestLink Link(TEXT("SGMessageReliabilityTest.Unordered"), Faults);
+	{
+		FSGMessageTestReceiver Sender(Link.SenderBus.ToSharedRef(), "SGMessageReliabilityTest.Unordered.Sender",
+		                              ENamedThreads::AnyThread);
+		Sender.Subscribe(TopicId, ReadyId);
+
+		FSGMessageTestReceiver Receiver(Link.ReceiverBus.ToSharedRef(),
+		                                "SGMessageReliabilityTest.Unordered.Receiver", ENamedThreads::AnyThread);
+		Receiver.Subscribe(TopicId, SampleId);
+
+		const auto Recipient = FSGMessageTestLink::Connect(Sender, Receiver, TopicId, ReadyId);
+
+		if (TestTrue(TEXT("The link connects"), Recipient.IsValid()))
+		{
+			Send(Sender, Recipient, 0, NumMessages, ESGMessageFlags::Reliable);
+
+			TestTrue(TEXT("All messages arrive"), Receiver.WaitFor(NumMessages));
+			TestTrue(TEXT("All messages are acknowledged"),
+			         WaitForSender(Link, NumMessages, 0, FSGMessageTestReceiver::Timeout));
+			TestTrue(TEXT("The receiver bus is idle"), FSGMessageTestReceiver::WaitForRouter(*Link.ReceiverBus));
+
+			// messages after a gap are delivered right away, so only the set of values is deterministic
+			TArray<int32> Values = Receiver.GetValues(TopicId, SampleId);
+			Values.Sort();
+
+			TestTrue(TEXT("Every message arrives exactly once"), Values == MakeRange(0, NumMessages));
+
+			const auto SenderStats = Link.SenderBridge->GetReliabilityStats();
+			const auto ReceiverStats = Link.ReceiverBridge->GetReliabilityStats();
+
+			TestTrue(TEXT("Selective acknowledgements trigger fast retransmits"),
+			         SenderStats.NumFastRetransmitted > 0);
+			TestTrue(TEXT("Duplicates are suppressed"), ReceiverStats.NumDuplicates > 0);
+			TestTrue(TEXT("Unordered messages are not held back"), ReceiverStats.NumHeldBack == 0);
+		}
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageReliabilityGiveUpTest, "SGMessaging.Bridge.Reliability.GiveUp",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageReliabilityGiveUpTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageReliabilityTest;
+
+	constexpr int32 NumWarmUp = 20;
+	constexpr int32 NumLost = 5;
+
+	// an unreliable link without faults yet, so that the round-trip time is measured before messages get lost
+	FSGMessageTestLink Link(TEXT("SGMessageReliabilityTest.GiveUp"), FSGLoopbackFaults());
+	{
+		FSGMessageTestReceiver Sender(Link.SenderBus.ToSharedRef(), "SGMessageReliabilityTest.GiveUp.Sender",
+		                              ENamedThreads::AnyThread);
+		Sender.Subscribe(TopicId, ReadyId);
+
+		FSGMessageTestReceiver Receiver(Link.ReceiverBus.ToSharedRef(), "SGMessageReliabilityTest.GiveUp.Receiver",
+		                                ENamedThreads::AnyThread);
+		Receiver.Subscribe(TopicId, SampleId);
+
+		const auto Recipient = FSGMessageTestLink::Connect(Sender, Receiver, TopicId, ReadyId);
+
+		if (TestTrue(TEXT("The link connects"), Recipient.IsValid()))
+		{
+			const auto Flags = ESGMessageFlags::Reliable | ESGMessageFlags::Ordered;
+
+			Send(Sender, Recipient, 0, NumWarmUp, Flags);
+
+			TestTrue(TEXT("Messages arrive over a healthy link"), Receiver.WaitFor(NumWarmUp));
+			TestTrue(TEXT("Messages are acknowledged over a healthy link"),
+			         WaitForSender(Link, NumWarmUp, 0, FSGMessageTestReceiver::Timeout));
+
+			const auto NumFailedBefore = Link.SenderBridge->GetReliabilityStats().NumFailed;
+
+			// cut the link towards the receiver
+			FSGLoopbackFaults Cut;
+			Cut.DropRate = 1.0f;
+
+			Link.ReceiverTransport->SetFaults(Cut);
+
+			Send(Sender, Recipient, NumWarmUp, NumLost, Flags);
+
+			TestTrue(TEXT("Lost messages are given up after the maximum number of retransmissions"),
+			         WaitForSender(Link, 0, NumFailedBefore + NumLost, GiveUpTimeout));
+
+			// the receiver must not wait for the given up messages before delivering later ones
+			Link.ReceiverTransport->SetFaults(FSGLoopbackFaults());
+
+			Send(Sender, Recipient, NumWarmUp + NumLost, 1, Flags);
+
+			TestTrue(TEXT("A message after the given up ones arrives"), Receiver.WaitFor(NumWarmUp + 1));
+
+			TArray<int32> Expected = MakeRange(0, NumWarmUp);
+			Expected.Add(NumWarmUp + NumLost);
+
+			TestTrue(TEXT("Given up messages are skipped"), Receiver.GetValues(TopicId, SampleId) == Expected);
+			TestTrue(TEXT("Lost messages are retransmitted before they are given up"),
+			         Link.SenderBridge->GetReliabilityStats().NumRetransmitted >= NumLost);
+		}
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Core/Common/SGMessageEndpoint.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "SGMessageTestReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGMessageRequestTest
+{
+	/** The message topic of the test. */
+	constexpr int32 TopicId = 9300;
+
+	/** The message identifier of requests. */
+	constexpr int32 RequestId = 1;
+
+	/** The message identifier of replies. */
+	constexpr int32 ReplyId = 2;
+
+	/** The message identifier of requests that are never answered. */
+	constexpr int32 IgnoredId = 3;
+
+	/** The number of seconds to wait for a reply before giving up. */
+	constexpr double Timeout = 10.0;
+
+	/** Waits for the reply to a request. */
+	bool WaitForReply(FSGMessageRequest& Request)
+	{
+		return Request.Future.WaitFor(FTimespan::FromSeconds(Timeout));
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageRequestTest, "SGMessaging.Endpoint.Request",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageRequestTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageRequestTest;
+
+	constexpr int32 NumRequests = 100;
+
+	const auto Bus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageRequestTest"));
+	{
+		FSGMessageTestResponder Responder(Bus.ToSharedRef(), "SGMessageRequestTest.Responder", TopicId, RequestId,
+		                                  ReplyId);
+		Responder.Ignore(IgnoredId);
+
+		// the requester never subscribes to the replies
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Requester =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageRequestTest.Requester", Bus.ToSharedRef(),
+			                                                    FOnBusNotification());
+		Bus->Register(Requester->GetAddress(), Requester.ToSharedRef());
+		Requester->SetRecipientThread(ENamedThreads::AnyThread);
+
+		TestTrue(TEXT("The responder subscribes"), Bus->TakeSnapshot().WaitFor(FTimespan::FromSeconds(Timeout)));
+
+		// replies complete their own requests, in any order
+		TArray<FSGMessageRequest> Requests;
+
+		for (int32 Index = 0; Index < NumRequests; ++Index)
+		{
+			Requests.Add(Requester->Request(TopicId, RequestId, Responder.GetAddress(), FTimespan::FromSeconds(Timeout),
+			                                DEFAULT_SEND_PARAMETER, TEXT("Value"), Index));
+		}
+
+		bool bAllReplied = true;
+		bool bAllCorrelated = true;
+
+		for (int32 Index = 0; Index < NumRequests; ++Index)
+		{
+			bAllReplied &= WaitForReply(Requests[Index]) && Requests[Index].Future.Get().IsReplied();
+
+			if (const FSGMessage* Message = Requests[Index].Future.Get().GetMessage())
+			{
+				bAllCorrelated &= Message->Get<int32>(TEXT("Value")) == Index * 2;
+			}
+		}
+
+		TestTrue(TEXT("All requests are replied"), bAllReplied);
+		TestTrue(TEXT("All replies complete their own request"), bAllCorrelated);
+
+		// requests without a reply time out
+		FSGMessageRequest Ignored = Requester->Request(TopicId, IgnoredId, Responder.GetAddress(),
+		                                               FTimespan::FromMilliseconds(50), DEFAULT_SEND_PARAMETER);
+
+		if (TestTrue(TEXT("The unanswered request completes"), WaitForReply(Ignored)))
+		{
+			TestTrue(TEXT("The unanswered request times out"),
+			         Ignored.Future.Get().Result == ESGMessageRequestResult::TimedOut);
+		}
+
+		// cancelled requests complete immediately
+		FSGMessageRequest Cancelled = Requester->Request(TopicId, IgnoredId, Responder.GetAddress(),
+		                                                 FTimespan::MaxValue(), DEFAULT_SEND_PARAMETER);
+
+		TestTrue(TEXT("The pending request is cancelled"), Requester->CancelRequest(Cancelled.Id));
+		TestFalse(TEXT("A request is cancelled only once"), Requester->CancelRequest(Cancelled.Id));
+		TestTrue(TEXT("The cancelled request completes"), Cancelled.Future.IsReady());
+		TestTrue(TEXT("The cancelled request reports it"),
+		         Cancelled.Future.Get().Result == ESGMessageRequestResult::Cancelled);
+
+		TestEqual(TEXT("No requests are left pending"), Requester->GetNumPendingRequests(), 0);
+
+		FSGMessageEndpoint::SafeRelease(Requester);
+	}
+	Bus->Shutdown();
+
+	return true;
+}
+
+#endif
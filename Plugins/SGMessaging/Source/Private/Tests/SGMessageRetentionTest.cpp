@@ -0,0 +1,134 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformProcess.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "SGMessageTestReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGMessageRetentionTest
+{
+	/** The message topic of the test. */
+	constexpr int32 TopicId = 9700;
+
+	/** The message identifier of messages that retain a history. */
+	constexpr int32 StateId = 1;
+
+	/** The message identifier of messages that expire. */
+	constexpr int32 ExpiringStateId = 2;
+
+	/** The message identifier of messages that are not retained. */
+	constexpr int32 EventId = 3;
+
+	/** The number of messages that the bus retains. */
+	constexpr int32 HistorySize = 2;
+
+	/** Gets the number of messages that the bus retains for the given message identifier. */
+	int32 GetNumRetained(const FSGMessageBusSnapshot& Snapshot, const int32 MessageId)
+	{
+		const FName MessageTag = FSGMessageTagBuilder::Builder(TopicId, MessageId);
+
+		for (const FSGMessageBusTagSnapshot& TagSnapshot : Snapshot.Tags)
+		{
+			if (TagSnapshot.MessageTag == MessageTag)
+			{
+				return TagSnapshot.NumRetained;
+			}
+		}
+
+		return 0;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessageRetentionTest, "SGMessaging.Bus.Retention",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::EngineFilter)
+
+
+bool FSGMessageRetentionTest::RunTest(const FString& Parameters)
+{
+	using namespace SGMessageRetentionTest;
+
+	constexpr int32 NumMessages = 10;
+	constexpr double Lifetime = 0.1;
+
+	const auto Bus = ISGMessagingModule::Get().CreateBus(TEXT("SGMessageRetentionTest"));
+	{
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Sender =
+			MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessageRetentionTest.Sender", Bus.ToSharedRef(),
+			                                                    FOnBusNotification());
+		Bus->Register(Sender->GetAddress(), Sender.ToSharedRef());
+
+		Sender->Retain(TopicId, StateId, HistorySize);
+		Sender->Retain(TopicId, ExpiringStateId);
+
+		TestTrue(TEXT("Publishers see retained tags right away"),
+		         Bus->IsRetained(FSGMessageTagBuilder::Builder(TopicId, StateId)));
+
+		const FSGMessageParameter::FPublishParameter ExpiringParameter(
+			ESGMessageScope::Network, TMapBuilder<FName, FString>(), FTimespan::Zero(),
+			FDateTime::UtcNow() + FTimespan::FromSeconds(Lifetime));
+
+		for (int32 Index = 0; Index < NumMessages; ++Index)
+		{
+			Sender->Publish(TopicId, StateId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), Index);
+			Sender->Publish(TopicId, EventId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), Index);
+		}
+
+		Sender->Publish(TopicId, ExpiringStateId, ExpiringParameter, TEXT("Value"), NumMessages);
+
+		TFuture<FSGMessageBusSnapshot> Snapshot = Bus->TakeSnapshot();
+
+		TestTrue(TEXT("The router routes all messages"),
+		         Snapshot.WaitFor(FTimespan::FromSeconds(FSGMessageTestReceiver::Timeout)));
+		TestEqual(TEXT("The history is bounded"), GetNumRetained(Snapshot.Get(), StateId), HistorySize);
+		TestEqual(TEXT("Messages that are not retained are dropped"), GetNumRetained(Snapshot.Get(), EventId), 0);
+
+		// let the expiring message expire before anybody subscribes to it
+		FPlatformProcess::Sleep(2.0f * Lifetime);
+
+		{
+			// retained messages are dispatched inline when the router adds the subscription
+			FSGMessageTestReceiver Receiver(Bus.ToSharedRef(), "SGMessageRetentionTest.Receiver",
+			                                ENamedThreads::AnyThread);
+			Receiver.Subscribe(TopicId, StateId);
+			Receiver.Subscribe(TopicId, ExpiringStateId);
+			Receiver.Subscribe(TopicId, EventId);
+
+			TestTrue(TEXT("The late receiver subscribes"), FSGMessageTestReceiver::WaitForRouter(*Bus));
+
+			const TArray<int32> States = Receiver.GetValues(TopicId, StateId);
+
+			TestEqual(TEXT("Late subscribers receive the retained history"), States.Num(), HistorySize);
+			TestTrue(TEXT("The retained history arrives oldest first"),
+			         (States.Num() == HistorySize) &&
+			         (States[0] == NumMessages - 2) && (States[1] == NumMessages - 1));
+
+			TestEqual(TEXT("Expired messages are not delivered"),
+			          Receiver.GetValues(TopicId, ExpiringStateId).Num(), 0);
+			TestEqual(TEXT("Messages that are not retained are not delivered"),
+			          Receiver.GetValues(TopicId, EventId).Num(), 0);
+		}
+
+		Sender->Unretain(TopicId, StateId);
+		Sender->Unretain(TopicId, ExpiringStateId);
+
+		TestFalse(TEXT("Publishers see unretained tags right away"),
+		          Bus->IsRetained(FSGMessageTagBuilder::Builder(TopicId, StateId)));
+
+		Snapshot = Bus->TakeSnapshot();
+
+		TestTrue(TEXT("The router stops retaining"),
+		         Snapshot.WaitFor(FTimespan::FromSeconds(FSGMessageTestReceiver::Timeout)));
+		TestEqual(TEXT("Unretaining drops the retained messages"), GetNumRetained(Snapshot.Get(), StateId), 0);
+
+		FSGMessageEndpoint::SafeRelease(Sender);
+	}
+	Bus->Shutdown();
+
+	return true;
+}
+
+#endif
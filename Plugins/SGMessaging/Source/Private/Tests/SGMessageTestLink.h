@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include "Core/Interface/ISGMessageBridge.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Transport/SGLoopbackTransport.h"
+#include "SGMessageTestReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Implements two buses that are bridged by a pair of faulty loopback transports.
+ *
+ * Faults apply to the packets that a transport receives, so that messages towards the receiver bus and the
+ * acknowledgements coming back are lost, duplicated and reordered alike. Faulty transports are unreliable, so the
+ * bridges add their reliability layer. The faults of each transport can be changed at any time.
+ */
+class FSGMessageTestLink
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param Name The name of the link, used to name the buses.
+	 * @param Faults The faults of the link.
+	 */
+	FSGMessageTestLink(const FString& Name, const FSGLoopbackFaults& Faults)
+	{
+		auto& MessagingModule = ISGMessagingModule::Get();
+
+		SenderBus = MessagingModule.CreateBus(Name + TEXT(".Sender"));
+		ReceiverBus = MessagingModule.CreateBus(Name + TEXT(".Receiver"));
+
+		FSGLoopbackTransport::CreatePair(FTimespan::Zero(), 0.0, SenderTransport, ReceiverTransport);
+
+		// faults must be set before the bridges are created, which only add reliability to unreliable transports
+		FSGLoopbackFaults ReverseFaults = Faults;
+		ReverseFaults.Seed = Faults.Seed + 1;
+
+		SenderTransport->SetFaults(ReverseFaults);
+		ReceiverTransport->SetFaults(Faults);
+
+		SenderBridge = MessagingModule.CreateBridge(FSGMessageAddress::NewAddress(), SenderBus.ToSharedRef(),
+		                                            SenderTransport.ToSharedRef());
+		ReceiverBridge = MessagingModule.CreateBridge(FSGMessageAddress::NewAddress(), ReceiverBus.ToSharedRef(),
+		                                              ReceiverTransport.ToSharedRef());
+
+		SenderBridge->Enable();
+		ReceiverBridge->Enable();
+	}
+
+	/** Destructor. */
+	~FSGMessageTestLink()
+	{
+		SenderBridge->Disable();
+		ReceiverBridge->Disable();
+		SenderBus->Shutdown();
+		ReceiverBus->Shutdown();
+	}
+
+public:
+	/**
+	 * Waits until an endpoint on the sender bus learned the address of an endpoint on the receiver bus.
+	 *
+	 * @param Sender The endpoint on the sender bus, subscribed to the ready message.
+	 * @param Receiver The endpoint on the receiver bus.
+	 * @param TopicId The topic of the ready message.
+	 * @param ReadyId The identifier of the ready message.
+	 * @return The address of the receiver, or an invalid address if the link did not connect in time.
+	 */
+	static FSGMessageAddress Connect(const FSGMessageTestReceiver& Sender, const FSGMessageTestReceiver& Receiver,
+	                                 const int32 TopicId, const int32 ReadyId)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		// published messages are not reliable, so keep announcing until one gets through
+		while (!Sender.GetLastSender().IsValid() &&
+		       FPlatformTime::Seconds() - StartTime < FSGMessageTestReceiver::Timeout)
+		{
+			Receiver.GetEndpoint().Publish(TopicId, ReadyId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), 0);
+
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		return Sender.GetLastSender();
+	}
+
+public:
+	/** Holds the bus that sends the messages under test. */
+	TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> SenderBus;
+
+	/** Holds the bus that receives the messages under test. */
+	TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> ReceiverBus;
+
+	/** Holds the transport of the sender bus. */
+	TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe> SenderTransport;
+
+	/** Holds the transport of the receiver bus. */
+	TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe> ReceiverTransport;
+
+	/** Holds the bridge of the sender bus. */
+	TSharedPtr<ISGMessageBridge, ESPMode::ThreadSafe> SenderBridge;
+
+	/** Holds the bridge of the receiver bus. */
+	TSharedPtr<ISGMessageBridge, ESPMode::ThreadSafe> ReceiverBridge;
+};
+
+#endif
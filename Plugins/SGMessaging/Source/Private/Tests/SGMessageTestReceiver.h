@@ -0,0 +1,263 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/ScopeLock.h"
+#include "Core/Common/SGMessageEndpoint.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Implements an endpoint that records the "Value" parameter of the messages it receives.
+ *
+ * Values are recorded per message tag and in the order of receipt. Recipients on any thread record their values as
+ * the router dispatches them, recipients on named threads once that thread processes its tasks.
+ */
+class FSGMessageTestReceiver
+{
+public:
+	/** The number of seconds that tests wait for the bus before giving up. */
+	static constexpr double Timeout = 10.0;
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param Bus The bus to register with.
+	 * @param Name The debug name of the endpoint.
+	 * @param RecipientThread The thread to receive messages on.
+	 */
+	FSGMessageTestReceiver(const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& Bus, const FName& Name,
+	                       const ENamedThreads::Type RecipientThread)
+		: NumReceived(0)
+	{
+		Endpoint = MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>(Name, Bus, FOnBusNotification());
+		Bus->Register(Endpoint->GetAddress(), Endpoint.ToSharedRef());
+
+		Endpoint->SetRecipientThread(RecipientThread);
+	}
+
+	/** Destructor. */
+	~FSGMessageTestReceiver()
+	{
+		FSGMessageEndpoint::SafeRelease(Endpoint);
+	}
+
+public:
+	/**
+	 * Subscribes to the specified messages at process scope.
+	 *
+	 * @param TopicId The topic of the messages.
+	 * @param MessageId The identifier of the messages.
+	 */
+	void Subscribe(const int32 TopicId, const int32 MessageId)
+	{
+		Endpoint->Subscribe(TopicId, MessageId, this, &FSGMessageTestReceiver::HandleMessage, ESGMessageScope::Process);
+	}
+
+	/**
+	 * Unsubscribes from the specified messages.
+	 *
+	 * @param TopicId The topic of the messages.
+	 * @param MessageId The identifier of the messages.
+	 */
+	void Unsubscribe(const int32 TopicId, const int32 MessageId)
+	{
+		Endpoint->Unsubscribe(TopicId, MessageId, this, &FSGMessageTestReceiver::HandleMessage);
+	}
+
+	/** Gets the address of the receiver. */
+	const FSGMessageAddress& GetAddress() const
+	{
+		return Endpoint->GetAddress();
+	}
+
+	/** Gets the endpoint of the receiver, which may also send and publish messages. */
+	FSGMessageEndpoint& GetEndpoint() const
+	{
+		return *Endpoint;
+	}
+
+	/** Gets the sender of the last received message. */
+	FSGMessageAddress GetLastSender() const
+	{
+		FScopeLock Lock(&ValuesCS);
+
+		return LastSender;
+	}
+
+	/** Takes the attachment of the last received message, so that the receiver no longer keeps it alive. */
+	TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe> TakeLastAttachment()
+	{
+		FScopeLock Lock(&ValuesCS);
+
+		return MoveTemp(LastAttachment);
+	}
+
+	/** Gets the values of all received messages, in the order of receipt. */
+	TArray<int32> GetValues() const
+	{
+		FScopeLock Lock(&ValuesCS);
+
+		return Values;
+	}
+
+	/** Gets the values of the received messages of the specified type, in the order of receipt. */
+	TArray<int32> GetValues(const int32 TopicId, const int32 MessageId) const
+	{
+		FScopeLock Lock(&ValuesCS);
+
+		return ValuesByTag.FindRef(FSGMessageTagBuilder::Builder(TopicId, MessageId));
+	}
+
+	/** Gets the number of received messages. */
+	int32 GetNumReceived() const
+	{
+		return NumReceived.Load(EMemoryOrder::Relaxed);
+	}
+
+	/** Waits until the specified number of messages was received. */
+	bool WaitFor(const int32 Number) const
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		while (NumReceived.Load() < Number)
+		{
+			if (FPlatformTime::Seconds() - StartTime > Timeout)
+			{
+				return false;
+			}
+
+			FPlatformProcess::Sleep(0.001f);
+		}
+
+		return true;
+	}
+
+	/** Waits until the bus processed all commands that were queued up before this call. */
+	static bool WaitForRouter(ISGMessageBus& Bus)
+	{
+		return Bus.TakeSnapshot().WaitFor(FTimespan::FromSeconds(Timeout));
+	}
+
+private:
+	/** Handles a message. */
+	void HandleMessage(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+	{
+		const int32 Value = Message.Get<int32>(TEXT("Value"));
+		{
+			FScopeLock Lock(&ValuesCS);
+
+			Values.Add(Value);
+			ValuesByTag.FindOrAdd(Context->GetMessageTag()).Add(Value);
+			LastSender = Context->GetSender();
+			LastAttachment = Context->GetAttachment();
+		}
+
+		++NumReceived;
+	}
+
+private:
+	/** Holds the endpoint. */
+	TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Endpoint;
+
+	/** Holds the number of received messages. */
+	TAtomic<int32> NumReceived;
+
+	/** Holds the values of all received messages. */
+	TArray<int32> Values;
+
+	/** Holds the values of the received messages per message tag. */
+	TMap<FName, TArray<int32>> ValuesByTag;
+
+	/** Holds the sender of the last received message. */
+	FSGMessageAddress LastSender;
+
+	/** Holds the attachment of the last received message. */
+	TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe> LastAttachment;
+
+	/** Holds a critical section that protects the values and the last message. */
+	mutable FCriticalSection ValuesCS;
+};
+
+
+/**
+ * Implements an endpoint that answers requests with twice their "Value" parameter.
+ *
+ * The responder receives on any thread, so it answers as soon as the router dispatches a request.
+ */
+class FSGMessageTestResponder
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param Bus The bus to register with.
+	 * @param Name The debug name of the endpoint.
+	 * @param InTopicId The topic of requests and replies.
+	 * @param RequestId The identifier of the requests to answer.
+	 * @param InReplyId The identifier of the replies.
+	 */
+	FSGMessageTestResponder(const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& Bus, const FName& Name,
+	                        const int32 InTopicId, const int32 RequestId, const int32 InReplyId)
+		: TopicId(InTopicId)
+		  , ReplyId(InReplyId)
+	{
+		Endpoint = MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>(Name, Bus, FOnBusNotification());
+		Bus->Register(Endpoint->GetAddress(), Endpoint.ToSharedRef());
+
+		Endpoint->SetRecipientThread(ENamedThreads::AnyThread);
+		Endpoint->Subscribe(TopicId, RequestId, this, &FSGMessageTestResponder::HandleRequest,
+		                    ESGMessageScope::Process);
+	}
+
+	/** Destructor. */
+	~FSGMessageTestResponder()
+	{
+		FSGMessageEndpoint::SafeRelease(Endpoint);
+	}
+
+public:
+	/**
+	 * Receives the specified requests without ever answering them.
+	 *
+	 * @param MessageId The identifier of the requests to ignore.
+	 */
+	void Ignore(const int32 MessageId)
+	{
+		Endpoint->Subscribe(TopicId, MessageId, this, &FSGMessageTestResponder::HandleIgnored,
+		                    ESGMessageScope::Process);
+	}
+
+	/** Gets the address of the responder. */
+	const FSGMessageAddress& GetAddress() const
+	{
+		return Endpoint->GetAddress();
+	}
+
+private:
+	/** Handles a request. */
+	void HandleRequest(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+	{
+		Endpoint->Reply(Context, TopicId, ReplyId, DEFAULT_SEND_PARAMETER, TEXT("Value"),
+		                Message.Get<int32>(TEXT("Value")) * 2);
+	}
+
+	/** Handles a request without answering it. */
+	void HandleIgnored(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+	{
+	}
+
+private:
+	/** Holds the endpoint. */
+	TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Endpoint;
+
+	/** Holds the topic of requests and replies. */
+	int32 TopicId;
+
+	/** Holds the identifier of the replies. */
+	int32 ReplyId;
+};
+
+#endif
@@ -0,0 +1,316 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Core/Common/SGMessageEndpoint.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Message/SGAny.h"
+#include "HAL/PlatformProcess.h"
+#include "MessagingFramework/Kismet/SGMessageFunctionLibrary.h"
+#include "Tests/SGBenchmarkRunner.h"
+#include "SGMessageTestReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace SGMessagingBenchmarkTest
+{
+	/** The message topic of the benchmarks. */
+	constexpr int32 TopicId = 9100;
+
+	/** The message identifier of samples. */
+	constexpr int32 SampleId = 1;
+
+	/** Waits until the receivers received the given number of samples in total. */
+	bool WaitForDeliveries(const TArray<TUniquePtr<FSGMessageTestReceiver>>& Receivers, const int32 NumExpected)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (;;)
+		{
+			int32 NumReceived = 0;
+
+			for (const auto& Receiver : Receivers)
+			{
+				NumReceived += Receiver->GetNumReceived();
+			}
+
+			if (NumReceived >= NumExpected)
+			{
+				return true;
+			}
+
+			if (FPlatformTime::Seconds() - StartTime > FSGMessageTestReceiver::Timeout)
+			{
+				return false;
+			}
+
+			FPlatformProcess::YieldThread();
+		}
+	}
+
+	/** Measures publishing to a number of subscribers, batched or one message at a time. */
+	void MeasurePublish(FAutomationTestBase& Test, FSGBenchmarkRunner& Runner, const TCHAR* Name,
+	                    const int32 NumSubscribers, const int32 BatchSize, const int32 NumIterations)
+	{
+		const auto Bus = ISGMessagingModule::Get().CreateBus(FString::Printf(TEXT("SGMessagingBenchmarkTest.%s"), Name));
+		{
+			TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Publisher =
+				MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGMessagingBenchmarkTest.Publisher",
+				                                                    Bus.ToSharedRef(), FOnBusNotification());
+			Bus->Register(Publisher->GetAddress(), Publisher.ToSharedRef());
+
+			TArray<TUniquePtr<FSGMessageTestReceiver>> Receivers;
+
+			for (int32 Index = 0; Index < NumSubscribers; ++Index)
+			{
+				Receivers.Add(MakeUnique<FSGMessageTestReceiver>(
+					Bus.ToSharedRef(), *FString::Printf(TEXT("SGMessagingBenchmarkTest.Receiver%d"), Index),
+					ENamedThreads::AnyThread));
+				Receivers.Last()->Subscribe(TopicId, SampleId);
+			}
+
+			Test.TestTrue(FString::Printf(TEXT("%s subscribes"), Name), FSGMessageTestReceiver::WaitForRouter(*Bus));
+
+			int32 NumExpected = 0;
+
+			// a failed delivery would otherwise wait out the timeout in every remaining iteration
+			const bool bDelivered = Runner.MeasureUntilFailure(Name, NumIterations / 10, NumIterations, BatchSize, [&]()
+			{
+				for (int32 Index = 0; Index < BatchSize; ++Index)
+				{
+					Publisher->Publish(TopicId, SampleId, DEFAULT_PUBLISH_PARAMETER, TEXT("Value"), Index);
+				}
+
+				NumExpected += BatchSize * NumSubscribers;
+
+				return WaitForDeliveries(Receivers, NumExpected);
+			}) != nullptr;
+
+			Test.TestTrue(FString::Printf(TEXT("%s delivers all messages"), Name), bDelivered);
+
+			Receivers.Reset();
+			FSGMessageEndpoint::SafeRelease(Publisher);
+		}
+		Bus->Shutdown();
+	}
+
+	/** Calls a Blueprint function of the message function library through its thunk. */
+	void CallThunk(UFunction* Function, FSGBlueprintMessage& Message, const FName& Key, int32& Variable)
+	{
+		uint8* Params = static_cast<uint8*>(FMemory_Alloca_Aligned(Function->ParmsSize, Function->GetMinAlignment()));
+		FMemory::Memzero(Params, Function->ParmsSize);
+
+		for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+		{
+			It->InitializeValue_InContainer(Params);
+
+			if (It->GetFName() == TEXT("Message"))
+			{
+				It->CopySingleValue(It->ContainerPtrToValuePtr<void>(Params), &Message);
+			}
+			else if (It->GetFName() == TEXT("Key"))
+			{
+				It->CopySingleValue(It->ContainerPtrToValuePtr<void>(Params), &Key);
+			}
+			else if (It->GetFName() == TEXT("Variable"))
+			{
+				It->CopySingleValue(It->ContainerPtrToValuePtr<void>(Params), &Variable);
+			}
+		}
+
+		USGMessageFunctionLibrary::StaticClass()->GetDefaultObject()->ProcessEvent(Function, Params);
+
+		for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+		{
+			It->DestroyValue_InContainer(Params);
+		}
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessagingBusBenchmarkTest, "SGMessaging.Benchmark.Bus",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::PerfFilter)
+
+
+bool FSGMessagingBusBenchmarkTest::RunTest(const FString& Parameters)
+{
+	FSGBenchmarkRunner Runner(*this, TEXT("Bus"));
+
+	// throughput, with the router and subscriber kept busy
+	SGMessagingBenchmarkTest::MeasurePublish(*this, Runner, TEXT("Publish.Throughput"), 1, 1000, 50);
+
+	// latency from publishing until the last of many subscribers handled the message
+	SGMessagingBenchmarkTest::MeasurePublish(*this, Runner, TEXT("Publish.FanOut.1"), 1, 1, 2000);
+	SGMessagingBenchmarkTest::MeasurePublish(*this, Runner, TEXT("Publish.FanOut.16"), 16, 1, 2000);
+	SGMessagingBenchmarkTest::MeasurePublish(*this, Runner, TEXT("Publish.FanOut.128"), 128, 1, 1000);
+
+	return Runner.Finish();
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessagingMessageBenchmarkTest, "SGMessaging.Benchmark.Message",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::PerfFilter)
+
+
+bool FSGMessagingMessageBenchmarkTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumWarmups = 20;
+	constexpr int32 NumIterations = 200;
+	constexpr int32 NumOperations = 1000;
+
+	FSGBenchmarkRunner Runner(*this, TEXT("Message"));
+
+	// keys are built once, so that only the message is measured
+	const FString IntKey = TEXT("Int");
+	const FString StringKey = TEXT("String");
+	const FString ArrayKey = TEXT("Array");
+
+	const FString StringValue = TEXT("The quick brown fox jumps over the lazy dog");
+
+	TArray<int32> ArrayValue;
+
+	for (int32 Index = 0; Index < 64; ++Index)
+	{
+		ArrayValue.Add(Index);
+	}
+
+	FSGMessage Message;
+	int64 Checksum = 0;
+
+	Runner.Measure(TEXT("Message.Set.Int32"), NumWarmups, NumIterations, NumOperations, [&]()
+	{
+		for (int32 Index = 0; Index < NumOperations; ++Index)
+		{
+			Message.Set(IntKey, Index);
+		}
+	});
+
+	Runner.Measure(TEXT("Message.Get.Int32"), NumWarmups, NumIterations, NumOperations, [&]()
+	{
+		for (int32 Index = 0; Index < NumOperations; ++Index)
+		{
+			Checksum += Message.Get<int32>(IntKey);
+		}
+	});
+
+	Runner.Measure(TEXT("Message.Set.String"), NumWarmups, NumIterations, NumOperations, [&]()
+	{
+		for (int32 Index = 0; Index < NumOperations; ++Index)
+		{
+			Message.Set(StringKey, StringValue);
+		}
+	});
+
+	Runner.Measure(TEXT("Message.Get.String"), NumWarmups, NumIterations, NumOperations, [&]()
+	{
+		for (int32 Index = 0; Index < NumOperations; ++Index)
+		{
+			Checksum += Message.Get<FString>(StringKey).Len();
+		}
+	});
+
+	Runner.Measure(TEXT("Message.Set.Array64"), NumWarmups, NumIterations, NumOperations, [&]()
+	{
+		for (int32 Index = 0; Index < NumOperations; ++Index)
+		{
+			Message.Set(ArrayKey, ArrayValue);
+		}
+	});
+
+	Runner.Measure(TEXT("Message.Get.Array64"), NumWarmups, NumIterations, NumOperations, [&]()
+	{
+		for (int32 Index = 0; Index < NumOperations; ++Index)
+		{
+			Checksum += Message.Get<TArray<int32>>(ArrayKey).Num();
+		}
+	});
+
+	// copies of type-erased values, as made when messages are snapshotted or forwarded
+	const FSGAny IntAny(42);
+	const FSGAny StringAny(StringValue);
+	const FSGAny ArrayAny(ArrayValue);
+
+	const auto MeasureCopy = [&](const TCHAR* Name, const FSGAny& Any)
+	{
+		Runner.Measure(Name, NumWarmups, NumIterations, NumOperations, [&]()
+		{
+			for (int32 Index = 0; Index < NumOperations; ++Index)
+			{
+				const FSGAny Copy(Any);
+				Checksum += Copy.IsValid() ? 1 : 0;
+			}
+		});
+	};
+
+	MeasureCopy(TEXT("Any.Copy.Int32"), IntAny);
+	MeasureCopy(TEXT("Any.Copy.String"), StringAny);
+	MeasureCopy(TEXT("Any.Copy.Array64"), ArrayAny);
+
+	TestTrue(TEXT("Values were read"), Checksum != 0);
+
+	return Runner.Finish();
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMessagingBlueprintBenchmarkTest, "SGMessaging.Benchmark.Blueprint",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::PerfFilter)
+
+
+bool FSGMessagingBlueprintBenchmarkTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumWarmups = 20;
+	constexpr int32 NumIterations = 200;
+	constexpr int32 NumOperations = 1000;
+
+	UFunction* SetFunction = USGMessageFunctionLibrary::StaticClass()->FindFunctionByName(TEXT("Set"));
+	UFunction* GetFunction = USGMessageFunctionLibrary::StaticClass()->FindFunctionByName(TEXT("Get"));
+
+	if (!TestNotNull(TEXT("Set is a Blueprint function"), SetFunction) ||
+		!TestNotNull(TEXT("Get is a Blueprint function"), GetFunction))
+	{
+		return false;
+	}
+
+	FSGBenchmarkRunner Runner(*this, TEXT("Blueprint"));
+
+	FSGMessage Message;
+	FSGBlueprintMessage BlueprintMessage(Message);
+
+	const FName Key(TEXT("Int"));
+	FIntProperty* IntProperty = CastField<FIntProperty>(SetFunction->FindPropertyByName(TEXT("Variable")));
+
+	int32 Value = 42;
+
+	// the native path, for comparison with the thunks
+	Runner.Measure(TEXT("Blueprint.ExecSet.Int32"), NumWarmups, NumIterations, NumOperations, [&]()
+	{
+		for (int32 Index = 0; Index < NumOperations; ++Index)
+		{
+			USGMessageFunctionLibrary::ExecSet(BlueprintMessage, Key, IntProperty, &Value);
+		}
+	});
+
+	Runner.Measure(TEXT("Blueprint.Thunk.Set.Int32"), NumWarmups, NumIterations, NumOperations, [&]()
+	{
+		for (int32 Index = 0; Index < NumOperations; ++Index)
+		{
+			SGMessagingBenchmarkTest::CallThunk(SetFunction, BlueprintMessage, Key, Value);
+		}
+	});
+
+	Runner.Measure(TEXT("Blueprint.Thunk.Get.Int32"), NumWarmups, NumIterations, NumOperations, [&]()
+	{
+		for (int32 Index = 0; Index < NumOperations; ++Index)
+		{
+			SGMessagingBenchmarkTest::CallThunk(GetFunction, BlueprintMessage, Key, Value);
+		}
+	});
+
+	TestEqual(TEXT("The thunks round-trip the value"), Message.Get<int32>(TEXT("Int")), 42);
+
+	return Runner.Finish();
+}
+
+#endif
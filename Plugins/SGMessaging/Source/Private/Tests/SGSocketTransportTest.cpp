@@ -0,0 +1,85 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Core/Interface/ISGMessageBridge.h"
+#include "Core/Interface/ISGMessagingModule.h"
+#include "Core/Transport/SGSocketTransport.h"
+#include "Tests/SGTransportBenchmark.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGSocketTransportBenchmarkTest, "SGMessaging.Transport.Socket.Benchmark",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext |
+                                 EAutomationTestFlags::PerfFilter)
+
+
+bool FSGSocketTransportBenchmarkTest::RunTest(const FString& Parameters)
+{
+	constexpr auto NumMessages = 20000;
+	constexpr auto PayloadSize = 64;
+	constexpr auto Timeout = 10.0;
+
+	auto& MessagingModule = ISGMessagingModule::Get();
+
+	// in-process baseline
+	{
+		const auto Bus = MessagingModule.CreateBus(TEXT("SGSocketTransportTest.Local"));
+		{
+			FSGTransportBenchmark Benchmark(Bus.ToSharedRef(), Bus.ToSharedRef());
+
+			TestTrue(TEXT("In-process path connects"), Benchmark.Connect(Timeout));
+			AddInfo(Benchmark.Run(NumMessages, PayloadSize, false, Timeout).ToString(TEXT("In-process")));
+		}
+		Bus->Shutdown();
+	}
+
+	// two buses bridged over loopback sockets
+	const auto ServerBus = MessagingModule.CreateBus(TEXT("SGSocketTransportTest.Server"));
+	const auto ClientBus = MessagingModule.CreateBus(TEXT("SGSocketTransportTest.Client"));
+
+	const auto ServerTransport = MakeShared<FSGSocketTransport, ESPMode::ThreadSafe>(
+		FIPv4Endpoint(FIPv4Address::InternalLoopback, 0), TArray<FIPv4Endpoint>());
+	const auto ServerBridge = MessagingModule.CreateBridge(FSGMessageAddress::NewAddress(), ServerBus.ToSharedRef(),
+	                                                       ServerTransport);
+	ServerBridge->Enable();
+
+	const auto ClientTransport = MakeShared<FSGSocketTransport, ESPMode::ThreadSafe>(
+		FIPv4Endpoint(FIPv4Address::InternalLoopback, 0), TArray<FIPv4Endpoint>{ServerTransport->GetListenEndpoint()});
+	const auto ClientBridge = MessagingModule.CreateBridge(FSGMessageAddress::NewAddress(), ClientBus.ToSharedRef(),
+	                                                       ClientTransport);
+	ClientBridge->Enable();
+
+	TestTrue(TEXT("Bridges are enabled"), ServerBridge->IsEnabled() && ClientBridge->IsEnabled());
+
+	{
+		FSGTransportBenchmark Benchmark(ClientBus.ToSharedRef(), ServerBus.ToSharedRef());
+
+		if (TestTrue(TEXT("Socket path connects"), Benchmark.Connect(Timeout)))
+		{
+			const auto Unreliable = Benchmark.Run(NumMessages, PayloadSize, false, Timeout);
+			AddInfo(Unreliable.ToString(TEXT("Socket (unreliable)")));
+
+			const auto Reliable = Benchmark.Run(NumMessages, PayloadSize, true, Timeout);
+			AddInfo(Reliable.ToString(TEXT("Socket (reliable)")));
+
+			const auto Stats = ClientBridge->GetReliabilityStats();
+			AddInfo(FString::Printf(TEXT("Reliability: %lld sent, %lld retransmitted, %lld failed, %lld acks, RTT %.3f ms (min %.3f ms)"),
+			                        Stats.NumSent, Stats.NumRetransmitted, Stats.NumFailed, Stats.NumAcksSent,
+			                        Stats.SmoothedRtt * 1000.0, Stats.MinRtt * 1000.0));
+
+			AddInfo(FString::Printf(TEXT("Socket: %lld messages dropped at full send queues"),
+			                        ClientTransport->GetNumMessagesDropped()));
+
+			TestEqual(TEXT("All reliable messages arrive"), Reliable.NumReceived, Reliable.NumSent);
+		}
+	}
+
+	ClientBridge->Disable();
+	ServerBridge->Disable();
+	ClientBus->Shutdown();
+	ServerBus->Shutdown();
+
+	return true;
+}
+
+#endif
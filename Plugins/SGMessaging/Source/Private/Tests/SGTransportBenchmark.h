@@ -0,0 +1,243 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Common/SGMessageEndpoint.h"
+#include "Core/Interface/ISGMessageBus.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Measures the throughput and latency of messages between two message buses.
+ *
+ * A source endpoint on one bus publishes or sends timestamped samples to a sink endpoint on the other bus.
+ * Passing the same bus twice measures the in-process path, which serves as the baseline for transports.
+ * Both endpoints receive on any thread, so the calling thread can block while waiting for samples.
+ */
+class FSGTransportBenchmark
+{
+public:
+	/** Structure for the results of a run. */
+	struct FResult
+	{
+		/** Holds the number of samples that were sent. */
+		int32 NumSent = 0;
+
+		/** Holds the number of samples that arrived before the timeout. */
+		int32 NumReceived = 0;
+
+		/** Holds the time from the first send to the last arrival, in seconds. */
+		double Seconds = 0.0;
+
+		/** Holds the sorted one-way latencies, in seconds. */
+		TArray<double> Latencies;
+
+		/** Gets the latency at the given percentile, in microseconds. */
+		double GetPercentile(const double Percentile) const
+		{
+			if (Latencies.Num() == 0)
+			{
+				return 0.0;
+			}
+
+			const auto Index = FMath::Clamp(FMath::CeilToInt(Percentile / 100.0 * Latencies.Num()) - 1, 0,
+			                                Latencies.Num() - 1);
+
+			return Latencies[Index] * 1000000.0;
+		}
+
+		/** Gets a human readable summary. */
+		FString ToString(const TCHAR* Name) const
+		{
+			return FString::Printf(
+				TEXT("%s: %d/%d messages in %.3f s, %.0f msg/s, latency p50 %.1f us, p99 %.1f us, max %.1f us"),
+				Name, NumReceived, NumSent, Seconds, Seconds > 0.0 ? NumReceived / Seconds : 0.0, GetPercentile(50.0),
+				GetPercentile(99.0), GetPercentile(100.0));
+		}
+	};
+
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param SourceBus The bus to send samples on.
+	 * @param SinkBus The bus to receive samples on.
+	 */
+	FSGTransportBenchmark(const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& SourceBus,
+	                      const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& SinkBus)
+		: NumReceived(0)
+		  , LastReceiveTime(0.0)
+	{
+		Source = MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGTransportBenchmark.Source", SourceBus,
+		                                                             FOnBusNotification());
+		Sink = MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>("SGTransportBenchmark.Sink", SinkBus,
+		                                                           FOnBusNotification());
+
+		SourceBus->Register(Source->GetAddress(), Source.ToSharedRef());
+		SinkBus->Register(Sink->GetAddress(), Sink.ToSharedRef());
+
+		Source->SetRecipientThread(ENamedThreads::AnyThread);
+		Sink->SetRecipientThread(ENamedThreads::AnyThread);
+
+		// forwarded messages arrive with process scope
+		Source->Subscribe(TopicId, ReadyId, this, &FSGTransportBenchmark::HandleReady, ESGMessageScope::Process);
+		Sink->Subscribe(TopicId, SampleId, this, &FSGTransportBenchmark::HandleSample, ESGMessageScope::Process);
+	}
+
+	/** Destructor. */
+	~FSGTransportBenchmark()
+	{
+		FSGMessageEndpoint::SafeRelease(Source);
+		FSGMessageEndpoint::SafeRelease(Sink);
+	}
+
+public:
+	/**
+	 * Waits until the source knows the sink's address.
+	 *
+	 * @param Timeout The maximum time to wait, in seconds.
+	 * @return true if connected, false if the timeout expired.
+	 */
+	bool Connect(const double Timeout)
+	{
+		const auto StartTime = FPlatformTime::Seconds();
+
+		while (!IsConnected() && FPlatformTime::Seconds() - StartTime < Timeout)
+		{
+			Sink->Publish(TopicId, ReadyId, DEFAULT_PUBLISH_PARAMETER, TEXT("Ready"), true);
+
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		return IsConnected();
+	}
+
+	/**
+	 * Sends samples and waits for them to arrive.
+	 *
+	 * @param NumMessages The number of samples to send.
+	 * @param PayloadSize The size of each sample's payload.
+	 * @param bReliable Whether to send reliable messages to the sink instead of publishing.
+	 * @param Timeout The maximum time to wait for arrivals, in seconds.
+	 * @return The results.
+	 */
+	FResult Run(const int32 NumMessages, const int32 PayloadSize, const bool bReliable, const double Timeout)
+	{
+		FSGMessageAddress Recipient;
+		{
+			FScopeLock Lock(&CriticalSection);
+
+			Recipient = SinkAddress;
+			Latencies.Reset(NumMessages);
+		}
+
+		NumReceived = 0;
+
+		TArray<uint8> Payload;
+		Payload.SetNumZeroed(PayloadSize);
+
+		const FSGMessageParameter::FSendParameter SendParameter(ESGMessageFlags::Reliable);
+		const auto StartTime = FPlatformTime::Seconds();
+
+		for (auto Index = 0; Index < NumMessages; ++Index)
+		{
+			const auto Time = FPlatformTime::Seconds();
+
+			if (bReliable)
+			{
+				Source->Send(TopicId, SampleId, Recipient, SendParameter, TEXT("Time"), Time, TEXT("Payload"),
+				             Payload);
+			}
+			else
+			{
+				Source->Publish(TopicId, SampleId, DEFAULT_PUBLISH_PARAMETER, TEXT("Time"), Time, TEXT("Payload"),
+				                Payload);
+			}
+		}
+
+		while (NumReceived < NumMessages && FPlatformTime::Seconds() - StartTime < Timeout)
+		{
+			FPlatformProcess::Sleep(0.0005f);
+		}
+
+		FResult Result;
+		{
+			FScopeLock Lock(&CriticalSection);
+
+			Result.NumSent = NumMessages;
+			Result.NumReceived = Latencies.Num();
+			Result.Seconds = Latencies.Num() > 0 ? LastReceiveTime - StartTime : 0.0;
+			Result.Latencies = Latencies;
+		}
+
+		Result.Latencies.Sort();
+
+		return Result;
+	}
+
+private:
+	/** Checks whether the sink's address is known. */
+	bool IsConnected() const
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		return SinkAddress.IsValid();
+	}
+
+	/** Handles the sink's ready message. */
+	void HandleReady(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		SinkAddress = Context->GetSender();
+	}
+
+	/** Handles a sample. */
+	void HandleSample(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+	{
+		const auto Now = FPlatformTime::Seconds();
+		const auto Latency = Now - Message.Get<double>(TEXT("Time"));
+
+		FScopeLock Lock(&CriticalSection);
+
+		Latencies.Add(Latency);
+		LastReceiveTime = Now;
+		++NumReceived;
+	}
+
+private:
+	/** The message topic of the benchmark. */
+	static constexpr int32 TopicId = 9000;
+
+	/** The message identifier of ready messages. */
+	static constexpr int32 ReadyId = 1;
+
+	/** The message identifier of samples. */
+	static constexpr int32 SampleId = 2;
+
+	/** Holds the endpoint that sends samples. */
+	TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Source;
+
+	/** Holds the endpoint that receives samples. */
+	TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Sink;
+
+	/** Holds the sink's address, as seen by the source. */
+	FSGMessageAddress SinkAddress;
+
+	/** Holds the number of samples received. */
+	TAtomic<int32> NumReceived;
+
+	/** Holds the time at which the last sample arrived. */
+	double LastReceiveTime;
+
+	/** Holds the latencies of the received samples. */
+	TArray<double> Latencies;
+
+	/** Protects the sink address and the latencies. */
+	mutable FCriticalSection CriticalSection;
+};
+
+#endif
@@ -36,6 +36,10 @@ enum class ESGBlueprintMessageFlags:uint8
 	/** Guarantee that this message is delivered */
 	Reliable = 1 << 0,
 	/** ESGMessageFlags::Reliable */
+
+	/** Deliver this reliable message only after the reliable messages that were sent before it to the same node */
+	Ordered = 1 << 1,
+	/** ESGMessageFlags::Ordered */
 };
 
 UENUM(BlueprintType)
@@ -83,6 +83,38 @@ public:
 		}
 	}
 
+	template <typename ...Args>
+	FSGMessageRequest Request(MESSAGE_TAG_PARAM_SIGNATURE, const FSGMessageAddress& InRecipient, const FTimespan& InTimeout,
+	                          CONST_SEND_PARAMETER_SIGNATURE, Args&&... Params) const
+	{
+		if (MessageEndpoint.IsValid())
+		{
+			return MessageEndpoint->Request(MESSAGE_TAG_PARAM_VALUE, InRecipient, InTimeout, MESSAGE_PARAMETER, Params...);
+		}
+
+		return FSGMessageRequest::Cancelled();
+	}
+
+	template <typename ...Args>
+	void Reply(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& InRequestContext, MESSAGE_TAG_PARAM_SIGNATURE,
+	           CONST_SEND_PARAMETER_SIGNATURE, Args&&... Params) const
+	{
+		if (MessageEndpoint.IsValid())
+		{
+			MessageEndpoint->Reply(InRequestContext, MESSAGE_TAG_PARAM_VALUE, MESSAGE_PARAMETER, Params...);
+		}
+	}
+
+	bool CancelRequest(const uint64 InRequestId) const
+	{
+		if (MessageEndpoint.IsValid())
+		{
+			return MessageEndpoint->CancelRequest(InRequestId);
+		}
+
+		return false;
+	}
+
 	UFUNCTION(BlueprintCallable)
 	void Forward(const FSGBlueprintMessageContext& InContext, const TArray<FSGBlueprintMessageAddress>& InRecipients,
 	             const FTimespan InDelay);
@@ -109,6 +141,12 @@ public:
 		}
 	}
 
+	UFUNCTION(BlueprintCallable)
+	void Retain(const int32 InTopicID, const int32 InMessageID, const int32 InHistorySize = 1);
+
+	UFUNCTION(BlueprintCallable)
+	void Unretain(const int32 InTopicID, const int32 InMessageID);
+
 public:
 	UFUNCTION(BlueprintCallable)
 	FSGBlueprintMessageAddress GetAddress() const;
@@ -5,24 +5,38 @@
 #include "CoreMinimal.h"
 #include "Misc/Guid.h"
 #include "Core/Interface/ISGMessageContext.h"
+#include "HAL/PlatformProcess.h"
 #include "Misc/ScopeLock.h"
+#include "Templates/Atomic.h"
 
 /**
  * Implements an address book that maps message addresses to remote nodes.
+ *
+ * The address book is read for every message that crosses the bridge, but only changes when a remote
+ * endpoint is seen for the first time or a node goes away. Readers therefore never lock: the entries are
+ * held in an immutable snapshot that writers replace as a whole (read-copy-update). Readers announce
+ * themselves in one of two epoch counters, and a writer only deletes a replaced snapshot once all readers
+ * of the previous epoch have left.
  */
 class FSGMessageAddressBook
 {
 public:
+	/** Type of the arrays that remote node identifiers are written to. */
+	typedef TArray<FGuid, TInlineAllocator<4>> FNodeArray;
+
 	/** Default constructor. */
 	FSGMessageAddressBook()
+		: Snapshot(new FSnapshot())
+		  , Epoch(0)
 	{
-		CriticalSection = new FCriticalSection();
+		Readers[0].Count = 0;
+		Readers[1].Count = 0;
 	}
 
 	/** Destructor. */
 	~FSGMessageAddressBook()
 	{
-		delete CriticalSection;
+		delete Snapshot.Load();
 	}
 
 public:
@@ -34,17 +48,28 @@ public:
 	 */
 	void Add(const FSGMessageAddress& Address, const FGuid& NodeId)
 	{
-		FScopeLock Lock(CriticalSection);
+		FScopeLock Lock(&WriterLock);
+
+		const FSnapshot* Current = Snapshot;
+		const FGuid* ExistingNodeId = Current->Find(Address);
+
+		if ((ExistingNodeId != nullptr) && (*ExistingNodeId == NodeId))
+		{
+			return;
+		}
+
+		FSnapshot* NewSnapshot = new FSnapshot(*Current);
+		NewSnapshot->Add(Address, NodeId);
 
-		Entries.FindOrAdd(Address) = NodeId;
+		Publish(NewSnapshot);
 	}
 
 	/** Clears the address book. */
 	void Clear()
 	{
-		FScopeLock Lock(CriticalSection);
+		FScopeLock Lock(&WriterLock);
 
-		Entries.Reset();
+		Publish(new FSnapshot());
 	}
 
 	/**
@@ -55,32 +80,56 @@ public:
 	 */
 	bool Contains(const FSGMessageAddress& Address) const
 	{
-		FScopeLock Lock(CriticalSection);
+		return Read([&Address](const FSnapshot& Entries)
+		{
+			return Entries.Contains(Address);
+		});
+	}
 
-		return Entries.Contains(Address);
+	/**
+	 * Finds the remote node identifier of a single message address.
+	 *
+	 * @param Address The address to look up.
+	 * @param OutNodeId Will hold the node identifier.
+	 * @return true if the address is known, false otherwise.
+	 */
+	bool FindNode(const FSGMessageAddress& Address, FGuid& OutNodeId) const
+	{
+		return Read([&Address, &OutNodeId](const FSnapshot& Entries)
+		{
+			if (const FGuid* NodeId = Entries.Find(Address))
+			{
+				OutNodeId = *NodeId;
+
+				return true;
+			}
+
+			return false;
+		});
 	}
 
 	/**
 	 * Gets the remote node identifiers for the specified list of message addresses.
 	 *
 	 * @param Addresses The address list to retrieve the node identifiers for.
-	 * @return The list of node identifiers.
+	 * @param OutNodes Will hold the list of distinct node identifiers.
 	 */
-	TArray<FGuid> GetNodesFor(const TArray<FSGMessageAddress>& Addresses)
+	void GetNodesFor(TArrayView<const FSGMessageAddress> Addresses, FNodeArray& OutNodes) const
 	{
-		TArray<FGuid> FoundNodes;
-
-		FScopeLock Lock(CriticalSection);
+		OutNodes.Reset();
 
-		for (const auto& Address : Addresses)
+		Read([Addresses, &OutNodes](const FSnapshot& Entries)
 		{
-			if (const FGuid* NodeId = Entries.Find(Address))
+			for (const auto& Address : Addresses)
 			{
-				FoundNodes.AddUnique(*NodeId);
+				if (const FGuid* NodeId = Entries.Find(Address))
+				{
+					OutNodes.AddUnique(*NodeId);
+				}
 			}
-		}
 
-		return FoundNodes;
+			return true;
+		});
 	}
 
 	/**
@@ -96,10 +145,11 @@ public:
 	{
 		OutRemovedAddresses.Reset();
 
-		FScopeLock Lock(CriticalSection);
+		FScopeLock Lock(&WriterLock);
 
-		Entries.GenerateKeyArray(OutRemovedAddresses);
-		Entries.Reset();
+		Snapshot.Load()->GenerateKeyArray(OutRemovedAddresses);
+
+		Publish(new FSnapshot());
 	}
 
 	/**
@@ -113,26 +163,106 @@ public:
 	{
 		OutRemovedAddresses.Reset();
 
-		FScopeLock Lock(CriticalSection);
+		FScopeLock Lock(&WriterLock);
+
+		FSnapshot* NewSnapshot = new FSnapshot();
 
-		for (const auto& EntryPair : Entries)
+		for (const auto& EntryPair : *Snapshot.Load())
 		{
 			if (EntryPair.Value == NodeId)
 			{
 				OutRemovedAddresses.Add(EntryPair.Key);
 			}
+			else
+			{
+				NewSnapshot->Add(EntryPair.Key, EntryPair.Value);
+			}
+		}
+
+		if (OutRemovedAddresses.Num() == 0)
+		{
+			delete NewSnapshot;
+
+			return;
+		}
+
+		Publish(NewSnapshot);
+	}
+
+private:
+	/** Type of the immutable snapshots of the address book entries. */
+	typedef TMap<FSGMessageAddress, FGuid> FSnapshot;
+
+	/** Structure for a reader counter on its own cache line. */
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FReaderCount
+	{
+		TAtomic<int32> Count;
+	};
+
+	/**
+	 * Calls the given function with the current snapshot, without taking a lock.
+	 *
+	 * @param Reader The function to call.
+	 * @return The function's return value.
+	 */
+	template <typename ReaderType>
+	bool Read(ReaderType&& Reader) const
+	{
+		for (;;)
+		{
+			const uint32 ReaderEpoch = Epoch;
+			FReaderCount& Count = Readers[ReaderEpoch & 1];
+
+			++Count.Count;
+
+			// a writer flipped the epoch in between and may not wait for us
+			if (Epoch != ReaderEpoch)
+			{
+				--Count.Count;
+
+				continue;
+			}
+
+			const bool Result = Reader(*Snapshot.Load());
+
+			--Count.Count;
+
+			return Result;
 		}
+	}
 
-		for (const auto& Address : OutRemovedAddresses)
+	/**
+	 * Replaces the current snapshot and deletes the old one once no reader can see it anymore.
+	 *
+	 * Must be called with the writer lock held.
+	 *
+	 * @param NewSnapshot The snapshot to publish.
+	 */
+	void Publish(FSnapshot* NewSnapshot)
+	{
+		FSnapshot* OldSnapshot = Snapshot.Exchange(NewSnapshot);
+
+		// readers that start from now on use the other counter and can only see the new snapshot
+		const uint32 OldEpoch = Epoch++;
+
+		while (Readers[OldEpoch & 1].Count != 0)
 		{
-			Entries.Remove(Address);
+			FPlatformProcess::YieldThread();
 		}
+
+		delete OldSnapshot;
 	}
 
 private:
-	/** Holds a critical section to serialize access to the address book entries. */
-	FCriticalSection* CriticalSection;
+	/** Holds the current snapshot of the address book entries. */
+	TAtomic<FSnapshot*> Snapshot;
+
+	/** Holds the current reader epoch. */
+	TAtomic<uint32> Epoch;
+
+	/** Holds the number of active readers of the current and the previous epoch. */
+	mutable FReaderCount Readers[2];
 
-	/** Holds the collection of known addresses and their remote node identifiers. */
-	TMap<FSGMessageAddress, FGuid> Entries;
+	/** Holds a critical section to serialize writers. */
+	FCriticalSection WriterLock;
 };
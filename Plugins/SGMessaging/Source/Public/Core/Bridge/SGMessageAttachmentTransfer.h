@@ -0,0 +1,304 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Templates/Atomic.h"
+#include "Core/Interface/ISGMessageBridge.h"
+#include "Core/Interface/ISGMessageContext.h"
+
+class FArchive;
+class FEvent;
+class FRunnableThread;
+class ISGMessageAttachment;
+class ISGMessageAttachmentReader;
+class ISGMessageTransport;
+
+
+/** Delegate that is executed when a message and its streamed attachment were received completely. */
+DECLARE_DELEGATE_TwoParams(FOnSGMessageAttachmentReceived, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>&,
+                           const FGuid&);
+
+
+/**
+ * Implements the chunked transfer of message attachments for a bridge.
+ *
+ * Attachments that are not held in memory, or are larger than a chunk, are not encoded with their message.
+ * Instead, the message carries an identifier and the size of the attachment in annotations, and the attachment
+ * is streamed to every remote node separately in chunks. The sender reads one chunk at a time through
+ * ISGMessageAttachmentReader and prefetches the next one while the current one is in flight. Transports encode
+ * messages before handing them on, so chunks are passed to them without being copied.
+ *
+ * Flow control is window based: at most a window of chunks may be unacknowledged per transfer. Receivers write
+ * chunks to a temporary file in order and acknowledge the number of bytes that they received contiguously. If
+ * a transfer stalls, because chunks were lost or the node went away for a while, the sender resumes it from the
+ * acknowledged offset. The message is delivered with a file attachment once both the message and all chunks
+ * arrived, so neither side ever holds more than a window of data in memory.
+ *
+ * Timers run on a dedicated thread. All other methods are thread-safe.
+ *
+ * @see FSGMessageBridge, ISGMessageAttachment
+ */
+class FSGMessageAttachmentTransfer final
+	: FRunnable
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InTransport The transport to send chunks and acknowledgements with.
+	 * @param InAddress The address of the bridge, used as the sender of chunks and acknowledgements.
+	 */
+	FSGMessageAttachmentTransfer(const TSharedRef<ISGMessageTransport, ESPMode::ThreadSafe>& InTransport,
+	                             const FSGMessageAddress& InAddress);
+
+	/** Virtual destructor. */
+	virtual ~FSGMessageAttachmentTransfer() override;
+
+public:
+	/** Starts the timer thread. */
+	void Start();
+
+	/** Stops the timer thread and cancels all transfers. */
+	void StopTransfers();
+
+	/**
+	 * Adds a remote node, which receives the attachments of messages that are sent to all nodes.
+	 *
+	 * @param NodeId The identifier of the node.
+	 * @see RemoveNode
+	 */
+	void AddNode(const FGuid& NodeId);
+
+	/**
+	 * Removes a remote node.
+	 *
+	 * Transfers to and from the node are kept for a while, so that they can resume if the node comes back.
+	 *
+	 * @param NodeId The identifier of the node.
+	 * @see AddNode
+	 */
+	void RemoveNode(const FGuid& NodeId);
+
+	/**
+	 * Checks whether the attachment of a message has to be streamed.
+	 *
+	 * @param Context The context of the message.
+	 * @return true if the message has an attachment that is not held in memory or is larger than a chunk.
+	 */
+	bool NeedsTransfer(const ISGMessageContext& Context) const;
+
+	/**
+	 * Starts streaming the attachment of a message.
+	 *
+	 * @param Context The context of the message.
+	 * @param InNodes The nodes to send the attachment to, or an empty array to send it to all nodes.
+	 * @return The context to transport in place of the message.
+	 */
+	TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Send(
+		const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context, TArrayView<const FGuid> InNodes);
+
+	/**
+	 * Processes a message received from a remote node.
+	 *
+	 * Messages whose attachment is still being transferred are held back and passed to the delegate
+	 * returned by OnMessageReceived once their attachment is complete.
+	 *
+	 * @param Context The context of the received message.
+	 * @param NodeId The identifier of the node that sent the message.
+	 * @return true if the message should be delivered, false if it was consumed.
+	 */
+	bool Receive(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context, const FGuid& NodeId);
+
+	/**
+	 * Gets a snapshot of the statistics.
+	 *
+	 * @return The statistics.
+	 */
+	FSGMessageAttachmentStats GetStats() const;
+
+	/**
+	 * Gets a delegate that is executed when a held back message can be delivered.
+	 *
+	 * @return The delegate.
+	 */
+	FOnSGMessageAttachmentReceived& OnMessageReceived()
+	{
+		return MessageReceivedDelegate;
+	}
+
+protected:
+	//~ FRunnable interface
+
+	virtual bool Init() override;
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/** Structure for the transfer of an attachment to a remote node. */
+	struct FOutbound
+	{
+		/** Holds the identifier of the transfer. */
+		uint64 Id = 0;
+
+		/** Holds the identifier of the receiving node. */
+		FGuid NodeId;
+
+		/** Holds the attachment. */
+		TSharedPtr<ISGMessageAttachment, ESPMode::ThreadSafe> Attachment;
+
+		/** Holds the chunk reader, which is only used by the timer thread. */
+		TUniquePtr<ISGMessageAttachmentReader> Reader;
+
+		/** Holds the size of the attachment. */
+		int64 Size = 0;
+
+		/** Holds the offset of the next chunk to send, which is only used by the timer thread. */
+		int64 NextOffset = 0;
+
+		/** Holds the number of bytes that the receiver acknowledged. */
+		int64 Acknowledged = 0;
+
+		/** Holds the number of acknowledgements that did not advance while chunks were outstanding. */
+		int32 NumDuplicateAcks = 0;
+
+		/** Holds the time at which the transfer last made progress. */
+		double LastProgressTime = 0.0;
+
+		/** Holds the number of times that the transfer was resumed after it stalled. */
+		int32 NumResumes = 0;
+
+		/** Holds the expiration of the message. */
+		FDateTime Expiration;
+
+		/** Protects the acknowledgement state. */
+		FCriticalSection CriticalSection;
+	};
+
+	/** Structure for the transfer of an attachment from a remote node. */
+	struct FInbound
+	{
+		/** Holds the identifier of the sending node. */
+		FGuid NodeId;
+
+		/** Holds the size of the attachment (-1 = not known yet). */
+		int64 Size = -1;
+
+		/** Holds the number of bytes received in order. */
+		int64 Received = 0;
+
+		/** Holds the name of the temporary file. */
+		FString Filename;
+
+		/** Holds the writer of the temporary file. */
+		TUniquePtr<FArchive> Writer;
+
+		/** Holds the message, once it arrived. */
+		TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Context;
+
+		/** Holds the time at which the last chunk arrived. */
+		double LastActivityTime = 0.0;
+	};
+
+	typedef TSharedPtr<FOutbound, ESPMode::ThreadSafe> FOutboundPtr;
+	typedef TSharedPtr<FInbound, ESPMode::ThreadSafe> FInboundPtr;
+
+	/** Type of the keys of inbound transfers, made of the sending node and the transfer identifier. */
+	typedef TPair<FGuid, uint64> FInboundKey;
+
+private:
+	/** Processes a chunk. */
+	void HandleChunk(const ISGMessageContext& Chunk, const FGuid& NodeId);
+
+	/** Processes a chunk acknowledgement. */
+	void HandleChunkAck(const ISGMessageContext& Ack, const FGuid& NodeId);
+
+	/** Holds back a message until its attachment arrived. */
+	void HandleMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context, const FGuid& NodeId);
+
+	/** Finishes an inbound transfer and returns its message if both arrived completely. Requires the inbound lock. */
+	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> CompleteInbound(const FInboundKey& Key, FInbound& Inbound);
+
+	/** Finds or adds an inbound transfer. Requires the inbound lock. */
+	FInboundPtr FindOrAddInbound(const FInboundKey& Key);
+
+	/** Sends the chunks that fit into the window of a transfer. Returns false if the transfer is finished. */
+	bool PumpOutbound(FOutbound& Outbound, double Now);
+
+	/** Sends an acknowledgement to a node. */
+	void SendAck(const FGuid& NodeId, uint64 Id, int64 Received);
+
+	/** Sends chunks, resumes stalled transfers and cleans up abandoned ones. */
+	void ProcessTimers();
+
+private:
+	/** Holds the bridge address. */
+	FSGMessageAddress Address;
+
+	/** Holds the transport. */
+	TSharedRef<ISGMessageTransport, ESPMode::ThreadSafe> MessageTransport;
+
+	/** Holds the size of chunks. */
+	int64 ChunkSize;
+
+	/** Holds the number of chunks that may be unacknowledged per transfer. */
+	int32 WindowSize;
+
+	/** Holds the remote nodes. */
+	TSet<FGuid> Nodes;
+
+	/** Holds the outbound transfers. */
+	TArray<FOutboundPtr> Outbounds;
+
+	/** Protects the nodes and the outbound transfers. */
+	FCriticalSection OutboundLock;
+
+	/** Holds the inbound transfers by sending node and transfer identifier. */
+	TMap<FInboundKey, FInboundPtr> Inbounds;
+
+	/** Holds the times at which recently finished inbound transfers completed. */
+	TMap<FInboundKey, double> Completed;
+
+	/** Protects the inbound transfers. */
+	FCriticalSection InboundLock;
+
+	/** Holds the identifier of the next outbound transfer. */
+	TAtomic<uint64> NextId;
+
+	/** Holds the number of attachments streamed. */
+	TAtomic<int64> NumSent;
+
+	/** Holds the number of chunks sent. */
+	TAtomic<int64> NumChunksSent;
+
+	/** Holds the number of resumed transfers. */
+	TAtomic<int64> NumResumed;
+
+	/** Holds the number of completely acknowledged attachments. */
+	TAtomic<int64> NumCompleted;
+
+	/** Holds the number of attachments that were given up. */
+	TAtomic<int64> NumFailed;
+
+	/** Holds the number of received chunks that were dropped. */
+	TAtomic<int64> NumChunksDropped;
+
+	/** Holds the number of completely received attachments. */
+	TAtomic<int64> NumReceived;
+
+	/** Holds the number of discarded incomplete attachments. */
+	TAtomic<int64> NumDiscarded;
+
+	/** Holds the delegate that is executed when a held back message can be delivered. */
+	FOnSGMessageAttachmentReceived MessageReceivedDelegate;
+
+	/** Holds an event that wakes the timer thread. */
+	FEvent* WorkEvent;
+
+	/** Holds the timer thread. */
+	FRunnableThread* Thread;
+
+	/** Holds a flag indicating that the thread is stopping. */
+	TAtomic<bool> Stopping;
+};
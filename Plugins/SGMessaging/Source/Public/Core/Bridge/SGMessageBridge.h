@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Core/Interface/ISGMessageBridge.h"
+#include "Core/Interface/ISGMessageBusListener.h"
 #include "Core/Interface/ISGMessageContext.h"
 #include "Core/Interface/ISGMessageReceiver.h"
 #include "Core/Interface/ISGMessageSender.h"
@@ -10,6 +11,9 @@
 #include "Misc/Guid.h"
 #include "Templates/SharedPointer.h"
 #include "Core/Bridge/SGMessageAddressBook.h"
+#include "Core/Bridge/SGMessageAttachmentTransfer.h"
+#include "Core/Bridge/SGMessageInterestTable.h"
+#include "Core/Bridge/SGMessageReliability.h"
 
 class ISGMessageBus;
 class ISGMessageSubscription;
@@ -28,6 +32,10 @@ class ISGMessageTransport;
  * sockets or shared memory to communicate with remote bridges. The bridge acts as a map
  * from message addresses to remote nodes and vice versa.
  *
+ * Bridges tell each other which message tags their local endpoints subscribed to, and only
+ * transport published messages to remote nodes that are interested in them. Attachments
+ * that are not held in memory are streamed separately from their messages.
+ *
  * @see ISGMessageBus, ISGMessageTransport
  */
 class FSGMessageBridge final
@@ -35,6 +43,7 @@ class FSGMessageBridge final
 	  , public ISGMessageBridge
 	  , public ISGMessageReceiver
 	  , public ISGMessageSender
+	  , public ISGBusListener
 	  , protected ISGMessageTransportHandler
 {
 public:
@@ -60,6 +69,8 @@ public:
 	virtual void Disable() override;
 	virtual void Enable() override;
 	virtual bool IsEnabled() const override;
+	virtual FSGMessageReliabilityStats GetReliabilityStats() const override;
+	virtual FSGMessageAttachmentStats GetAttachmentStats() const override;
 
 public:
 	//~ ISGMessageReceiver interface
@@ -77,6 +88,13 @@ public:
 	virtual void NotifyMessageError(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
 	                                const FString& Error) override;
 
+public:
+	//~ ISGBusListener interface
+
+	virtual ENamedThreads::Type GetListenerThread() const override;
+	virtual void NotifyRegistration(const FSGMessageAddress& InAddress, ESGMessageBusNotification Notification) override;
+	virtual void NotifySubscription(const FName& MessageTag, ESGMessageBusNotification Notification) override;
+
 protected:
 	//~ ISGMessageTransportHandler interface
 
@@ -85,6 +103,38 @@ protected:
 	virtual void ReceiveTransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
 	                                     const FGuid& NodeId) override;
 
+private:
+	/**
+	 * Processes a message from a remote node that passed the reliability layer.
+	 *
+	 * @param Context The context of the message.
+	 * @param NodeId The identifier of the node that sent the message.
+	 */
+	void ProcessTransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context, const FGuid& NodeId);
+
+	/**
+	 * Delivers a message from a remote node to the local bus.
+	 *
+	 * @param Context The context of the message.
+	 * @param NodeId The identifier of the node that sent the message.
+	 */
+	void DeliverTransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context, const FGuid& NodeId);
+
+	/**
+	 * Processes an interest report from a remote node.
+	 *
+	 * @param Context The context of the report.
+	 * @param NodeId The identifier of the node that sent the report.
+	 */
+	void ProcessInterest(const ISGMessageContext& Context, const FGuid& NodeId);
+
+	/**
+	 * Sends the interest of the local endpoints to remote nodes.
+	 *
+	 * @param Nodes The nodes to send the interest to, or an empty array to send it to all nodes.
+	 */
+	void SendInterest(TArrayView<const FGuid> Nodes);
+
 private:
 	/** Callback for message bus shutdowns. */
 	void HandleMessageBusShutdown();
@@ -108,6 +158,27 @@ private:
 	/** Holds the message subscription for outbound messages. */
 	TSharedPtr<ISGMessageSubscription, ESPMode::ThreadSafe> MessageSubscription;
 
+	/** Holds the message tags that remote nodes are interested in. */
+	FSGMessageInterestTable InterestTable;
+
+	/** Holds the message tags that local endpoints subscribed to at network scope. */
+	TSet<FName> LocalInterest;
+
+	/** Holds the version of the local interest. */
+	uint64 LocalInterestVersion;
+
+	/** Protects the local interest. */
+	FCriticalSection LocalInterestLock;
+
+	/** Holds a flag indicating that sending the local interest to all nodes is scheduled. */
+	TAtomic<bool> InterestUpdatePending;
+
 	/** Holds the message transport object. */
 	TSharedPtr<ISGMessageTransport, ESPMode::ThreadSafe> Transport;
+
+	/** Holds the acknowledgement and retransmission of reliable messages, if the transport may lose messages. */
+	TUniquePtr<FSGMessageReliability> Reliability;
+
+	/** Holds the chunked transfer of message attachments. */
+	TUniquePtr<FSGMessageAttachmentTransfer> AttachmentTransfer;
 };
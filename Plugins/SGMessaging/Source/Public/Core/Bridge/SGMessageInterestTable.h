@@ -0,0 +1,151 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+#include "Misc/ScopeRWLock.h"
+#include "Core/Bridge/SGMessageAddressBook.h"
+
+/**
+ * Implements a table of the message tags that remote nodes are interested in.
+ *
+ * Every node tells the other nodes which tags its local endpoints subscribed to at network scope, and the bridge
+ * only transports published messages to nodes that are interested in them. A node that did not report its
+ * interest yet, for example because the report is still in flight, is assumed to be interested in everything, so
+ * that messages are never withheld from a node that may want them. The same holds for nodes that subscribed to
+ * NAME_All.
+ *
+ * Each report carries the complete set of tags and a version number, so reports that arrive late or twice are
+ * simply ignored.
+ */
+class FSGMessageInterestTable
+{
+public:
+	/**
+	 * Adds a remote node whose interest is not known yet.
+	 *
+	 * @param NodeId The identifier of the node.
+	 * @see RemoveNode
+	 */
+	void AddNode(const FGuid& NodeId)
+	{
+		FWriteScopeLock Lock(NodesLock);
+
+		Nodes.FindOrAdd(NodeId);
+	}
+
+	/** Removes all nodes. */
+	void Clear()
+	{
+		FWriteScopeLock Lock(NodesLock);
+
+		Nodes.Empty();
+	}
+
+	/**
+	 * Gets the remote nodes that are interested in a message tag.
+	 *
+	 * @param MessageTag The tag of the message.
+	 * @param OutNodes Will hold the interested nodes, or be empty if all nodes are interested.
+	 * @return true if at least one node is interested, false otherwise.
+	 */
+	bool GetInterestedNodes(const FName& MessageTag, FSGMessageAddressBook::FNodeArray& OutNodes) const
+	{
+		OutNodes.Reset();
+
+		FReadScopeLock Lock(NodesLock);
+
+		if (Nodes.Num() == 0)
+		{
+			return true;
+		}
+
+		for (const auto& NodePair : Nodes)
+		{
+			if (NodePair.Value.IsInterestedIn(MessageTag))
+			{
+				OutNodes.Add(NodePair.Key);
+			}
+		}
+
+		if (OutNodes.Num() == Nodes.Num())
+		{
+			OutNodes.Reset();
+
+			return true;
+		}
+
+		return (OutNodes.Num() > 0);
+	}
+
+	/**
+	 * Removes a remote node.
+	 *
+	 * @param NodeId The identifier of the node.
+	 * @see AddNode
+	 */
+	void RemoveNode(const FGuid& NodeId)
+	{
+		FWriteScopeLock Lock(NodesLock);
+
+		Nodes.Remove(NodeId);
+	}
+
+	/**
+	 * Sets the interest that a remote node reported.
+	 *
+	 * @param NodeId The identifier of the node.
+	 * @param Version The version of the report.
+	 * @param MessageTags The tags that the node is interested in.
+	 * @return true if the report was applied, false if a newer one was applied before.
+	 */
+	bool SetInterest(const FGuid& NodeId, const uint64 Version, TSet<FName>&& MessageTags)
+	{
+		FWriteScopeLock Lock(NodesLock);
+
+		FNodeInterest& Interest = Nodes.FindOrAdd(NodeId);
+
+		if (Interest.bKnown && (Version <= Interest.Version))
+		{
+			return false;
+		}
+
+		Interest.bKnown = true;
+		Interest.Version = Version;
+		Interest.bAll = MessageTags.Contains(NAME_All);
+		Interest.MessageTags = MoveTemp(MessageTags);
+
+		return true;
+	}
+
+private:
+	/** Structure for the interest of a single remote node. */
+	struct FNodeInterest
+	{
+		/** Holds a flag indicating whether the node reported its interest. */
+		bool bKnown = false;
+
+		/** Holds a flag indicating whether the node is interested in all messages. */
+		bool bAll = false;
+
+		/** Holds the version of the last applied report. */
+		uint64 Version = 0;
+
+		/** Holds the tags that the node is interested in. */
+		TSet<FName> MessageTags;
+
+		/** Checks whether the node may be interested in a message tag. */
+		bool IsInterestedIn(const FName& MessageTag) const
+		{
+			return !bKnown || bAll || MessageTags.Contains(MessageTag);
+		}
+	};
+
+private:
+	/** Maps remote node identifiers to their interest. */
+	TMap<FGuid, FNodeInterest> Nodes;
+
+	/** Protects the nodes. */
+	mutable FRWLock NodesLock;
+};
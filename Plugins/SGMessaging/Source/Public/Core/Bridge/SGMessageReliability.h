@@ -0,0 +1,279 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Misc/ScopeRWLock.h"
+#include "Templates/Atomic.h"
+#include "Core/Interface/ISGMessageBridge.h"
+#include "Core/Interface/ISGMessageContext.h"
+
+class FEvent;
+class FRunnableThread;
+class ISGMessageTransport;
+
+
+/**
+ * Implements acknowledgement and retransmission of reliable messages for a bridge.
+ *
+ * Each remote node gets a channel with its own sequence numbers. Reliable messages are sent to every node
+ * individually, carrying their sequence number and the lowest sequence number that the sender still tracks
+ * in annotations. Up to a window of messages per node may be unacknowledged; messages beyond the window wait
+ * in a backlog.
+ *
+ * Receivers deliver messages as soon as they arrive, without waiting for earlier ones, and suppress
+ * duplicates. Only messages with the Ordered flag are held back until all messages before them arrived or were
+ * given up by the sender, so that they are delivered in the order in which they were sent, provided that the
+ * transport receives the messages of a node on a single thread. Receivers acknowledge cumulatively, together with a selective list of messages that arrived beyond
+ * a gap, either after a number of messages or after a short delay. Senders retransmit a message when its
+ * timeout, which is derived from the measured round-trip time, expires, or as soon as later messages were
+ * acknowledged several times while it was not. Messages are given up after too many retransmissions or when
+ * they expire.
+ *
+ * Timers run on a dedicated thread. All other methods are thread-safe.
+ *
+ * @see FSGMessageBridge
+ */
+class FSGMessageReliability final
+	: FRunnable
+{
+public:
+	/** Type definition for the received messages that are ready to be delivered. */
+	typedef TArray<TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>, TInlineAllocator<1>> FReceivedArray;
+
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InTransport The transport to send messages and acknowledgements with.
+	 * @param InAddress The address of the bridge, used as the sender of acknowledgements.
+	 */
+	FSGMessageReliability(const TSharedRef<ISGMessageTransport, ESPMode::ThreadSafe>& InTransport,
+	                      const FSGMessageAddress& InAddress);
+
+	/** Virtual destructor. */
+	virtual ~FSGMessageReliability() override;
+
+public:
+	/** Starts the timer thread. */
+	void Start();
+
+	/** Stops the timer thread and forgets all nodes. */
+	void StopReliability();
+
+	/**
+	 * Adds a remote node.
+	 *
+	 * @param NodeId The identifier of the node.
+	 * @see RemoveNode
+	 */
+	void AddNode(const FGuid& NodeId);
+
+	/**
+	 * Removes a remote node and discards its unacknowledged messages.
+	 *
+	 * @param NodeId The identifier of the node.
+	 * @see AddNode
+	 */
+	void RemoveNode(const FGuid& NodeId);
+
+	/**
+	 * Sends a reliable message.
+	 *
+	 * @param Context The context of the message to send.
+	 * @param Nodes The nodes to send the message to, or an empty array to send it to all nodes.
+	 * @return true if the message was accepted for at least one node, false otherwise.
+	 */
+	bool Send(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context, TArrayView<const FGuid> Nodes);
+
+	/**
+	 * Processes a message received from a remote node.
+	 *
+	 * Acknowledgements and duplicates are consumed, and ordered messages may be held back. Messages that were
+	 * held back are released together with the message that fills their gap.
+	 *
+	 * @param Context The context of the received message.
+	 * @param NodeId The identifier of the node that sent the message.
+	 * @param OutReceived Will hold the messages to deliver, in order.
+	 */
+	void Receive(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context, const FGuid& NodeId,
+	             FReceivedArray& OutReceived);
+
+	/**
+	 * Gets a snapshot of the statistics.
+	 *
+	 * @return The statistics.
+	 */
+	FSGMessageReliabilityStats GetStats() const;
+
+protected:
+	//~ FRunnable interface
+
+	virtual bool Init() override;
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/** Structure for a message that was not acknowledged yet. */
+	struct FPendingMessage
+	{
+		/** Holds the sequenced context. */
+		TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Context;
+
+		/** Holds the time of the first transmission. */
+		double FirstSendTime = 0.0;
+
+		/** Holds the time of the last transmission. */
+		double LastSendTime = 0.0;
+
+		/** Holds the number of retransmissions. */
+		int32 NumRetransmits = 0;
+
+		/** Holds the number of acknowledgements that reported later messages, but not this one. */
+		int32 NumMissingReports = 0;
+	};
+
+	/** Structure for the state of the communication with one remote node. */
+	struct FChannel
+	{
+		/** Holds the identifier of the node. */
+		FGuid NodeId;
+
+		/** Holds the sequence number of the next message. */
+		uint64 NextSequence = 1;
+
+		/** Holds the messages that were sent, but not acknowledged. */
+		TMap<uint64, FPendingMessage> InFlight;
+
+		/** Holds the messages that wait for room in the window, in sequence order. */
+		TArray<TPair<uint64, TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe>>> Backlog;
+
+		/** Holds the smoothed round-trip time (0 = no sample yet). */
+		double SmoothedRtt = 0.0;
+
+		/** Holds the round-trip time variance. */
+		double RttVariance = 0.0;
+
+		/** Holds the retransmission timeout. */
+		double RetransmitTimeout;
+
+		/** Holds the highest sequence number up to which all messages were received. */
+		uint64 ReceivedCumulative = 0;
+
+		/** Holds the sequence numbers received beyond a gap. */
+		TSet<uint64> ReceivedBeyondGap;
+
+		/** Holds the ordered messages received beyond a gap, which wait for the messages before them. */
+		TMap<uint64, TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe>> HeldBack;
+
+		/** Holds the number of messages received since the last acknowledgement. */
+		int32 NumUnacknowledged = 0;
+
+		/** Holds the time at which an acknowledgement is due (0 = none). */
+		double AckDueTime = 0.0;
+
+		/** Protects the channel. */
+		FCriticalSection CriticalSection;
+	};
+
+	typedef TSharedPtr<FChannel, ESPMode::ThreadSafe> FChannelPtr;
+
+	/** Structure for a message to hand to the transport after the channel lock was released. */
+	struct FOutboundMessage
+	{
+		TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Context;
+
+		FGuid NodeId;
+	};
+
+	typedef TArray<FOutboundMessage, TInlineAllocator<4>> FOutboundArray;
+
+private:
+	/** Finds or adds the channel of a node. */
+	FChannelPtr FindOrAddChannel(const FGuid& NodeId);
+
+	/** Creates the acknowledgement for a channel and resets its acknowledgement state. Requires the channel lock. */
+	TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> CreateAck(FChannel& Channel);
+
+	/** Processes an acknowledgement. Requires the channel lock. */
+	void HandleAck(FChannel& Channel, const ISGMessageContext& Ack, double Now, FOutboundArray& OutMessages);
+
+	/** Processes a sequenced message. Requires the channel lock. */
+	void HandleSequenced(FChannel& Channel, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	                     uint64 Sequence, uint64 Base, double Now, FOutboundArray& OutMessages,
+	                     FReceivedArray& OutReceived);
+
+	/** Advances over the messages received beyond the gap and releases held back ones. Requires the channel lock. */
+	void AdvanceCumulative(FChannel& Channel, FReceivedArray& OutReceived);
+
+	/** Moves backlogged messages into the window. Requires the channel lock. */
+	void FillWindow(FChannel& Channel, double Now, FOutboundArray& OutMessages);
+
+	/** Gets the lowest sequence number that a channel still tracks. Requires the channel lock. */
+	static uint64 GetBase(const FChannel& Channel);
+
+	/** Updates the round-trip time estimate of a channel. Requires the channel lock. */
+	void UpdateRtt(FChannel& Channel, double Sample);
+
+	/** Hands messages to the transport. */
+	void TransportMessages(const FOutboundArray& Messages);
+
+	/** Retransmits timed out messages and sends due acknowledgements. */
+	void ProcessTimers();
+
+private:
+	/** Holds the bridge address. */
+	FSGMessageAddress Address;
+
+	/** Holds the transport. */
+	TSharedRef<ISGMessageTransport, ESPMode::ThreadSafe> MessageTransport;
+
+	/** Holds the channels by node identifier. */
+	TMap<FGuid, FChannelPtr> Channels;
+
+	/** Protects the channel map. */
+	mutable FRWLock ChannelsLock;
+
+	/** Holds the number of reliable messages sent. */
+	TAtomic<int64> NumSent;
+
+	/** Holds the number of retransmissions. */
+	TAtomic<int64> NumRetransmitted;
+
+	/** Holds the number of fast retransmissions. */
+	TAtomic<int64> NumFastRetransmitted;
+
+	/** Holds the number of acknowledged messages. */
+	TAtomic<int64> NumAcknowledged;
+
+	/** Holds the number of messages that were given up. */
+	TAtomic<int64> NumFailed;
+
+	/** Holds the number of messages received beyond a gap. */
+	TAtomic<int64> NumOutOfOrder;
+
+	/** Holds the number of suppressed duplicates. */
+	TAtomic<int64> NumDuplicates;
+
+	/** Holds the number of ordered messages that were held back. */
+	TAtomic<int64> NumHeldBack;
+
+	/** Holds the number of acknowledgements sent. */
+	TAtomic<int64> NumAcksSent;
+
+	/** Holds the smallest round-trip time observed, in microseconds. */
+	TAtomic<int64> MinRttMicroseconds;
+
+	/** Holds the last smoothed round-trip time of any channel, in microseconds. */
+	TAtomic<int64> SmoothedRttMicroseconds;
+
+	/** Holds an event that wakes the timer thread. */
+	FEvent* WorkEvent;
+
+	/** Holds the timer thread. */
+	FRunnableThread* Thread;
+
+	/** Holds a flag indicating that the thread is stopping. */
+	TAtomic<bool> Stopping;
+};
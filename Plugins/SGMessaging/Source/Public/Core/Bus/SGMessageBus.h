@@ -37,9 +37,11 @@ public:
 public:
 	//~ ISGMessageBus interface
 
+	virtual void Conflate(const FName& MessageTag, const FSGMessageConflation& Conflation) override;
 	virtual void Forward(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
 	                     const TArray<FSGMessageAddress>& Recipients, const FTimespan& Delay,
 	                     const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Forwarder) override;
+	virtual void Inject(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context) override;
 	virtual TSharedRef<ISGMessageTracer, ESPMode::ThreadSafe> GetTracer() override;
 	virtual void Intercept(const TSharedRef<ISGMessageInterceptor, ESPMode::ThreadSafe>& Interceptor,
 	                       const FName& MessageTag) override;
@@ -47,8 +49,13 @@ public:
 	virtual void Publish(const FName& MessageTag, void* Message, ESGMessageScope Scope,
 	                     const TMap<FName, FString>& Annotations, const FTimespan& Delay, const FDateTime& Expiration,
 	                     const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Publisher) override;
+	virtual void PublishBatch(const TArray<FSGMessageBatchEntry>& Messages, ESGMessageScope Scope,
+	                          const TMap<FName, FString>& Annotations, const FTimespan& Delay,
+	                          const FDateTime& Expiration,
+	                          const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Publisher) override;
 	virtual void Register(const FSGMessageAddress& Address,
 	                      const TSharedRef<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient) override;
+	virtual void Retain(const FName& MessageTag, int32 HistorySize) override;
 	virtual void Send(const FName& MessageTag,
 	                  void* Message,
 	                  const TArray<FSGMessageAddress>& Recipients,
@@ -58,10 +65,21 @@ public:
 	                  const FTimespan& Delay,
 	                  const FDateTime& Expiration,
 	                  const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Sender) override;
+	virtual void SendBatch(const TArray<FSGMessageBatchEntry>& Messages,
+	                       const TArray<FSGMessageAddress>& Recipients,
+	                       ESGMessageFlags Flags,
+	                       const TMap<FName, FString>& Annotations,
+	                       const FTimespan& Delay,
+	                       const FDateTime& Expiration,
+	                       const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Sender) override;
+	virtual bool StartRecording(const FString& Filename) override;
+	virtual void StopRecording() override;
 	virtual void Shutdown() override;
 	virtual TSharedPtr<ISGMessageSubscription, ESPMode::ThreadSafe> Subscribe(
 		const TSharedRef<ISGMessageReceiver, ESPMode::ThreadSafe>& Subscriber, const FName& MessageTag,
 		const FSGMessageScopeRange& ScopeRange) override;
+	virtual void Unconflate(const FName& MessageTag) override;
+	virtual void Unretain(const FName& MessageTag) override;
 	virtual void Unintercept(const TSharedRef<ISGMessageInterceptor, ESPMode::ThreadSafe>& Interceptor,
 	                         const FName& MessageTag) override;
 	virtual void Unregister(const FSGMessageAddress& Address) override;
@@ -70,6 +88,9 @@ public:
 	virtual void AddNotificationListener(const TSharedRef<ISGBusListener, ESPMode::ThreadSafe>& Listener) override;
 	virtual void RemoveNotificationListener(const TSharedRef<ISGBusListener, ESPMode::ThreadSafe>& Listener) override;
 	virtual const FString& GetName() const override;
+	virtual FSGMessageBusStats GetStats() const override;
+	virtual bool IsRetained(const FName& MessageTag) const override;
+	virtual TFuture<FSGMessageBusSnapshot> TakeSnapshot() override;
 
 private:
 	/** The message bus debugging name. */
@@ -86,4 +107,10 @@ private:
 
 	/** Holds bus shutdown delegate. */
 	FOnMessageBusShutdown ShutdownDelegate;
+
+	/** Holds the retained message tags, which publishers query without waiting for the router. */
+	TSet<FName> RetainedTags;
+
+	/** Holds a lock that protects the retained message tags. */
+	mutable FRWLock RetainedTagsLock;
 };
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Stats/Stats.h"
+#include "Misc/ScopeLock.h"
 #include "Core/Interface/ISGMessageContext.h"
 #include "Core/Interface/ISGMessageBusListener.h"
 #include "Core/Bus/SGMessageTracer.h"
@@ -23,12 +24,14 @@ public:
 	 * @param InContext The context of the message to dispatch.
 	 * @param InRecipient The message recipient.
 	 * @param InTracer The message tracer to notify.
+	 * @param InRouteCycles The cycle counter at which the message was routed.
 	 */
 	FSGMessageDispatchTask(
 		ENamedThreads::Type InThread,
 		TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> InContext,
 		TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe> InRecipient,
-		TSharedPtr<FSGMessageTracer, ESPMode::ThreadSafe> InTracer);
+		TSharedPtr<FSGMessageTracer, ESPMode::ThreadSafe> InTracer,
+		uint64 InRouteCycles);
 
 public:
 	/**
@@ -73,6 +76,9 @@ private:
 	/** Holds a reference to the recipient. */
 	TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe> RecipientPtr;
 
+	/** Holds the cycle counter at which the message was routed. */
+	uint64 RouteCycles;
+
 	/** Holds the name of the thread that the router is running on. */
 	ENamedThreads::Type Thread;
 
@@ -81,6 +87,258 @@ private:
 };
 
 
+/**
+ * Structure for a message that is delivered to a recipient as part of a batch.
+ */
+struct FSGMessageDelivery
+{
+	/** Holds the message context. */
+	TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Context;
+
+	/** Holds a reference to the recipient. */
+	TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe> RecipientPtr;
+
+	/** Creates and initializes a new instance. */
+	FSGMessageDelivery(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& InContext,
+	                   const TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& InRecipient)
+		: Context(InContext)
+		  , RecipientPtr(InRecipient)
+	{
+	}
+};
+
+
+/**
+ * Implements an asynchronous task for dispatching a batch of messages to the recipients on one thread.
+ *
+ * The messages are delivered in the order in which they were routed, so that every recipient sees them in
+ * the order in which they were sent.
+ */
+class FSGMessageBatchDispatchTask
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InThread The name of the thread to dispatch the messages on.
+	 * @param InDeliveries The messages to dispatch, along with their recipients.
+	 * @param InTracer The message tracer to notify.
+	 * @param InRouteCycles The cycle counter at which the messages were routed.
+	 */
+	FSGMessageBatchDispatchTask(
+		ENamedThreads::Type InThread,
+		TArray<FSGMessageDelivery>&& InDeliveries,
+		TSharedPtr<FSGMessageTracer, ESPMode::ThreadSafe> InTracer,
+		uint64 InRouteCycles);
+
+public:
+	/**
+	 * Performs the actual task.
+	 *
+	 * @param CurrentThread The thread that this task is executing on.
+	 * @param MyCompletionGraphEvent The completion event.
+	 */
+	void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) const;
+
+	/**
+	 * Returns the name of the thread that this task should run on.
+	 *
+	 * @return Thread name.
+	 */
+	ENamedThreads::Type GetDesiredThread() const
+	{
+		return Thread;
+	}
+
+	/**
+	 * Gets the task's stats tracking identifier.
+	 *
+	 * @return Stats identifier.
+	 */
+	TStatId GetStatId() const;
+
+	/**
+	 * Gets the mode for tracking subsequent tasks.
+	 *
+	 * @return Always track subsequent tasks.
+	 */
+	static ESubsequentsMode::Type GetSubsequentsMode()
+	{
+		return ESubsequentsMode::TrackSubsequents;
+	}
+
+private:
+	/** Holds the messages to dispatch, along with their recipients. */
+	TArray<FSGMessageDelivery> Deliveries;
+
+	/** Holds the cycle counter at which the messages were routed. */
+	uint64 RouteCycles;
+
+	/** Holds the name of the thread to dispatch the messages on. */
+	ENamedThreads::Type Thread;
+
+	/** Holds a pointer to the message tracer. */
+	TWeakPtr<FSGMessageTracer, ESPMode::ThreadSafe> TracerPtr;
+};
+
+
+/**
+ * Implements the pending delivery of a conflated message to a recipient.
+ *
+ * The router replaces the message of a slot in place while a dispatch task for the slot is queued up, so
+ * that the task delivers the latest message only. The router and the recipient thread share the slot.
+ */
+class FSGMessageConflationSlot
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InRecipient The recipient of the slot.
+	 */
+	explicit FSGMessageConflationSlot(const TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& InRecipient)
+		: RecipientPtr(InRecipient)
+		  , RouteCycles(0)
+	{
+	}
+
+public:
+	/**
+	 * Gets the recipient of the slot.
+	 *
+	 * @return The recipient.
+	 */
+	const TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& GetRecipient() const
+	{
+		return RecipientPtr;
+	}
+
+	/**
+	 * Checks whether a message is pending, i.e. whether a dispatch task has yet to take it.
+	 *
+	 * @return true if a message is pending, false otherwise.
+	 */
+	bool IsPending()
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		return Context.IsValid();
+	}
+
+	/**
+	 * Sets the pending message, replacing the one that is pending already.
+	 *
+	 * @param InContext The context of the message.
+	 * @param InRouteCycles The cycle counter at which the message was routed.
+	 * @return true if a message was replaced, false if the slot needs a new dispatch task.
+	 */
+	bool Replace(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& InContext, const uint64 InRouteCycles)
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		const bool bReplaced = Context.IsValid();
+		Context = InContext;
+		RouteCycles = InRouteCycles;
+
+		return bReplaced;
+	}
+
+	/**
+	 * Takes the pending message, which leaves the slot empty.
+	 *
+	 * @param OutRouteCycles Will hold the cycle counter at which the message was routed.
+	 * @return The context of the message, or nullptr if none was pending.
+	 */
+	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Take(uint64& OutRouteCycles)
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		OutRouteCycles = RouteCycles;
+
+		return MoveTemp(Context);
+	}
+
+private:
+	/** Holds the context of the pending message, if any. */
+	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Context;
+
+	/** Holds a reference to the recipient. */
+	TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe> RecipientPtr;
+
+	/** Holds the cycle counter at which the pending message was routed. */
+	uint64 RouteCycles;
+
+	/** Guards the pending message. */
+	FCriticalSection CriticalSection;
+};
+
+
+/**
+ * Implements an asynchronous task for dispatching the latest message of a conflation slot.
+ */
+class FSGMessageConflatedDispatchTask
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InThread The name of the thread to dispatch the message on.
+	 * @param InSlot The slot that holds the message to dispatch.
+	 * @param InTracer The message tracer to notify.
+	 */
+	FSGMessageConflatedDispatchTask(
+		ENamedThreads::Type InThread,
+		TSharedRef<FSGMessageConflationSlot, ESPMode::ThreadSafe> InSlot,
+		TSharedPtr<FSGMessageTracer, ESPMode::ThreadSafe> InTracer);
+
+public:
+	/**
+	 * Performs the actual task.
+	 *
+	 * @param CurrentThread The thread that this task is executing on.
+	 * @param MyCompletionGraphEvent The completion event.
+	 */
+	void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) const;
+
+	/**
+	 * Returns the name of the thread that this task should run on.
+	 *
+	 * @return Thread name.
+	 */
+	ENamedThreads::Type GetDesiredThread() const
+	{
+		return Thread;
+	}
+
+	/**
+	 * Gets the task's stats tracking identifier.
+	 *
+	 * @return Stats identifier.
+	 */
+	TStatId GetStatId() const;
+
+	/**
+	 * Gets the mode for tracking subsequent tasks.
+	 *
+	 * @return Always track subsequent tasks.
+	 */
+	static ESubsequentsMode::Type GetSubsequentsMode()
+	{
+		return ESubsequentsMode::TrackSubsequents;
+	}
+
+private:
+	/** Holds the slot that holds the message to dispatch. */
+	TSharedRef<FSGMessageConflationSlot, ESPMode::ThreadSafe> Slot;
+
+	/** Holds the name of the thread to dispatch the message on. */
+	ENamedThreads::Type Thread;
+
+	/** Holds a pointer to the message tracer. */
+	TWeakPtr<FSGMessageTracer, ESPMode::ThreadSafe> TracerPtr;
+};
+
+
 /**
  * Implements an asynchronous task for dispatching a registration notification to a listener.
  */
@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+#include "Core/Interface/ISGMessageTracer.h"
+
+/**
+ * Implements a histogram of latencies with a fixed relative precision.
+ *
+ * Values are counted in buckets whose width grows with the value, similar to an HDR histogram: every power of two
+ * is split into 16 buckets, so percentiles are reported with a precision of about 6% over the whole range, while a
+ * histogram takes a few kilobytes at most. Latencies are recorded in microseconds and clamped to about 71 minutes.
+ *
+ * Recording is lock-free and may happen on any thread. Summaries that are taken while values are being recorded
+ * may be slightly off, but are never inconsistent.
+ */
+class SGMESSAGING_API FSGMessageLatencyHistogram
+{
+public:
+	/** Default constructor. */
+	FSGMessageLatencyHistogram();
+
+public:
+	/**
+	 * Records a latency.
+	 *
+	 * @param Microseconds The latency to record.
+	 */
+	void Record(uint64 Microseconds);
+
+	/** Removes all recorded latencies. */
+	void Reset();
+
+	/**
+	 * Gets a summary of the recorded latencies.
+	 *
+	 * @return The summary.
+	 */
+	FSGMessageTracerLatencySummary GetSummary() const;
+
+private:
+	/** Gets the bucket that counts a value. */
+	static int32 GetBucket(uint64 Value);
+
+	/** Gets the highest value that a bucket counts. */
+	static uint64 GetBucketValue(int32 Bucket);
+
+private:
+	/** The number of bits that select the bucket within a power of two. */
+	static constexpr int32 SubBucketBits = 4;
+
+	/** The number of buckets per power of two. */
+	static constexpr int32 SubBucketCount = 1 << SubBucketBits;
+
+	/** The number of bits of the largest value that can be recorded. */
+	static constexpr int32 ValueBits = 32;
+
+	/** The number of buckets. */
+	static constexpr int32 NumBuckets = (ValueBits - SubBucketBits + 1) * SubBucketCount;
+
+	/** Holds the number of values per bucket. */
+	TAtomic<uint64> Counts[NumBuckets];
+
+	/** Holds the number of recorded values. */
+	TAtomic<uint64> TotalCount;
+
+	/** Holds the sum of the recorded values. */
+	TAtomic<uint64> TotalSum;
+
+	/** Holds the largest recorded value. */
+	TAtomic<uint64> MaxValue;
+};
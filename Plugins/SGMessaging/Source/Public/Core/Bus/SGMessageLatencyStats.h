@@ -0,0 +1,115 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+#include "Core/Bus/SGMessageLatencyHistogram.h"
+#include "Core/Interface/ISGMessageTracer.h"
+
+/**
+ * Implements the latency histograms of a message bus.
+ *
+ * The time from sending to routing is tracked per message tag. The time from routing to the start of the handler
+ * and the time that the handler took are tracked per message tag and recipient thread. The histograms are always
+ * recorded, independent of whether the message tracer is running, and are only cleared by Reset.
+ *
+ * All methods are thread-safe.
+ *
+ * @see FSGMessageLatencyHistogram, ISGMessageTracer::GetLatencies
+ */
+class FSGMessageLatencyStats
+{
+public:
+	/**
+	 * Records the latency of a message from sending to routing.
+	 *
+	 * @param MessageTag The tag of the message.
+	 * @param SendToRoute The latency in microseconds.
+	 */
+	void RecordRouted(const FName& MessageTag, uint64 SendToRoute);
+
+	/**
+	 * Records the latencies of a message that a recipient handled.
+	 *
+	 * @param MessageTag The tag of the message.
+	 * @param RecipientThread The thread on which the recipient handled the message.
+	 * @param RouteToDispatch The latency from routing to the start of the handler, in microseconds.
+	 * @param DispatchToHandled The time that the handler took, in microseconds.
+	 */
+	void RecordHandled(const FName& MessageTag, ENamedThreads::Type RecipientThread, uint64 RouteToDispatch,
+	                   uint64 DispatchToHandled);
+
+	/**
+	 * Gets summaries of the latencies of all message tags.
+	 *
+	 * @param OutLatencies Will hold the latencies, sorted by message tag.
+	 * @return The number of message tags.
+	 */
+	int32 GetLatencies(TArray<FSGMessageTracerLatencyInfo>& OutLatencies) const;
+
+	/**
+	 * Gets the number of handled messages and the sum of their latencies from routing to the start of the handler.
+	 *
+	 * Unlike the histograms, the totals are not cleared by Reset, so that rates can be computed from two samples.
+	 *
+	 * @param OutNumHandled Will hold the number of handled messages.
+	 * @param OutTotalRouteToDispatch Will hold the sum of the latencies in microseconds.
+	 */
+	void GetTotals(uint64& OutNumHandled, uint64& OutTotalRouteToDispatch) const
+	{
+		OutNumHandled = NumHandled.Load(EMemoryOrder::Relaxed);
+		OutTotalRouteToDispatch = TotalRouteToDispatch.Load(EMemoryOrder::Relaxed);
+	}
+
+	/** Removes all recorded latencies. */
+	void Reset();
+
+public:
+	/**
+	 * Converts a number of cycles into microseconds.
+	 *
+	 * @param Cycles The number of cycles, as measured with FPlatformTime::Cycles64.
+	 * @return The number of microseconds.
+	 */
+	static uint64 CyclesToMicroseconds(const uint64 Cycles)
+	{
+		return static_cast<uint64>(FPlatformTime::ToSeconds64(Cycles) * 1000000.0);
+	}
+
+private:
+	/** Structure for the histograms of a message tag and recipient thread. */
+	struct FThreadHistograms
+	{
+		/** Holds the latencies from routing to the start of the handler. */
+		FSGMessageLatencyHistogram RouteToDispatch;
+
+		/** Holds the times that handlers took. */
+		FSGMessageLatencyHistogram DispatchToHandled;
+	};
+
+	/** Type of the keys of thread histograms. */
+	typedef TPair<FName, ENamedThreads::Type> FThreadKey;
+
+	/** Finds or adds the histogram of a message tag. */
+	FSGMessageLatencyHistogram& FindOrAddTagHistogram(const FName& MessageTag);
+
+	/** Finds or adds the histograms of a message tag and recipient thread. */
+	FThreadHistograms& FindOrAddThreadHistograms(const FThreadKey& Key);
+
+private:
+	/** Holds the latencies from sending to routing by message tag. */
+	TMap<FName, TUniquePtr<FSGMessageLatencyHistogram>> TagHistograms;
+
+	/** Holds the dispatch latencies by message tag and recipient thread. */
+	TMap<FThreadKey, TUniquePtr<FThreadHistograms>> ThreadHistograms;
+
+	/** Protects the histogram maps, but not the histograms, which are never removed. */
+	mutable FRWLock HistogramsLock;
+
+	/** Holds the number of handled messages. */
+	TAtomic<uint64> NumHandled{0};
+
+	/** Holds the sum of the latencies from routing to the start of the handler. */
+	TAtomic<uint64> TotalRouteToDispatch{0};
+};
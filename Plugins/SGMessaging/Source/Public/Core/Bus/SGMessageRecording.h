@@ -0,0 +1,254 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Memory/SharedBuffer.h"
+#include "Templates/Atomic.h"
+#include "Core/Interface/ISGMessageContext.h"
+
+class FEvent;
+class FRunnableThread;
+
+/**
+ * Implements the file format of message recordings.
+ *
+ * A recording consists of a header followed by chunks of records:
+ *
+ *		Header      'S' 'G' 'R' 'C' Version:uint8 StartTime:int64 NodeId:guid
+ *		Chunk       Size:uint32 StoredSize:uint32 byte*
+ *		Record      RouteTime:int64 Message
+ *
+ * Messages are encoded in the wire format (see FSGMessageWireFormat), so that a record holds the message tag,
+ * sender, recipients, scope, flags, times, annotations and parameters, and it knows its own size. Times are UTC
+ * ticks, and the route time is the time at which the router picked the message up. The node identifier is a
+ * transport node identifier of the recording process (see FSGMessageAddress::NewNodeId), which tells the addresses
+ * of that process apart from those of other nodes. Chunks are compressed with
+ * LZ4 unless that does not make them smaller, in which case the stored size equals the size. Multi-byte values
+ * are little-endian.
+ *
+ * @see FSGMessageRecorder, FSGMessageRecordingReader
+ */
+struct FSGMessageRecordingFormat
+{
+	/** The version of the format that is written. */
+	static constexpr uint8 Version = 2;
+
+	/** The size of the file header. */
+	static constexpr int32 HeaderSize = 29;
+
+	/** The size of a chunk header. */
+	static constexpr int32 ChunkHeaderSize = 8;
+
+	/** The size of a record header. */
+	static constexpr int32 RecordHeaderSize = 8;
+
+	/** The size at which chunks are written. */
+	static constexpr int32 ChunkSize = 256 * 1024;
+};
+
+
+/**
+ * Records the messages routed by a message bus to a file.
+ *
+ * Records are appended to a chunk by the router thread. Full chunks are handed to a writer thread, which compresses
+ * and writes them while the router fills the other buffer, so that the router never compresses or touches the disk.
+ * If the writer is still busy with the previous chunk, the router keeps appending to the current one. Messages that
+ * cannot be encoded, such as messages that are not of type FSGMessage, are skipped. Attachments are only recorded if
+ * they are kept in memory. The file is completed when the recorder is destroyed.
+ *
+ * @see ISGMessageBus::StartRecording, FSGMessageRecordingFormat
+ */
+class SGMESSAGING_API FSGMessageRecorder
+	: public FRunnable
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InFilename The name of the file to record to, which is replaced if it exists.
+	 */
+	explicit FSGMessageRecorder(const FString& InFilename);
+
+	/** Destructor. */
+	virtual ~FSGMessageRecorder() override;
+
+public:
+	/**
+	 * Checks whether the file was created.
+	 *
+	 * @return true if the recorder can record, false otherwise.
+	 */
+	bool IsValid() const
+	{
+		return Archive.IsValid();
+	}
+
+	/**
+	 * Gets the name of the file.
+	 *
+	 * @return Filename.
+	 */
+	const FString& GetFilename() const
+	{
+		return Filename;
+	}
+
+	/**
+	 * Gets the number of messages recorded so far.
+	 *
+	 * @return Number of messages.
+	 */
+	int64 GetNumRecorded() const
+	{
+		return NumRecorded.Load(EMemoryOrder::Relaxed);
+	}
+
+	/**
+	 * Gets the number of messages that could not be recorded.
+	 *
+	 * @return Number of messages.
+	 */
+	int64 GetNumSkipped() const
+	{
+		return NumSkipped.Load(EMemoryOrder::Relaxed);
+	}
+
+	/**
+	 * Records a message.
+	 *
+	 * Must be called from a single thread.
+	 *
+	 * @param Context The context of the message.
+	 * @param RouteTime The time at which the message is routed.
+	 */
+	void Record(const ISGMessageContext& Context, const FDateTime& RouteTime);
+
+public:
+	//~ FRunnable interface
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/** Hands the current chunk to the writer thread, unless it is still writing the previous one. */
+	void Submit();
+
+	/** Compresses and writes a chunk. */
+	void Write(const TArray<uint8>& Records);
+
+private:
+	/** Holds the archive that writes the file (writer thread only, until it is stopped). */
+	TUniquePtr<FArchive> Archive;
+
+	/** Holds the records that the router appends to. */
+	TArray<uint8> Chunk;
+
+	/** Holds the records that were handed to the writer thread, or nothing if it is idle. */
+	TArray<uint8> SubmittedChunk;
+
+	/** Holds the compressed chunk (writer thread only). */
+	TArray<uint8> CompressedChunk;
+
+	/** Protects the submitted chunk. */
+	FCriticalSection SubmittedCS;
+
+	/** Holds an event signaling that a chunk was submitted. */
+	FEvent* WorkEvent;
+
+	/** Holds a flag indicating that the writer thread is stopping. */
+	TAtomic<bool> Stopping;
+
+	/** Holds the writer thread. */
+	FRunnableThread* Thread;
+
+	/** Holds the name of the file. */
+	FString Filename;
+
+	/** Holds the number of recorded messages. */
+	TAtomic<int64> NumRecorded;
+
+	/** Holds the number of skipped messages. */
+	TAtomic<int64> NumSkipped;
+};
+
+
+/**
+ * Reads the messages of a recording in order.
+ *
+ * Chunks are read and decompressed one at a time. The returned messages reference their chunk, so decoding them
+ * does not copy them again.
+ *
+ * @see FSGMessageRecorder, FSGMessageReplayer
+ */
+class SGMESSAGING_API FSGMessageRecordingReader
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param Filename The name of the file to read.
+	 */
+	explicit FSGMessageRecordingReader(const FString& Filename);
+
+public:
+	/**
+	 * Checks whether the file holds a recording of a supported version.
+	 *
+	 * @return true if valid, false otherwise.
+	 */
+	bool IsValid() const
+	{
+		return Archive.IsValid();
+	}
+
+	/**
+	 * Gets the time at which the recording started.
+	 *
+	 * @return Start time (in UTC).
+	 */
+	const FDateTime& GetStartTime() const
+	{
+		return StartTime;
+	}
+
+	/**
+	 * Gets the transport node identifier of the process that made the recording.
+	 *
+	 * @return Node identifier.
+	 */
+	const FGuid& GetNodeId() const
+	{
+		return NodeId;
+	}
+
+	/**
+	 * Reads the next message.
+	 *
+	 * @param OutRouteTime Will hold the time at which the message was routed.
+	 * @param OutMessage Will hold the encoded message.
+	 * @return true if a message was read, false at the end of the recording or if it is damaged.
+	 */
+	bool Next(FDateTime& OutRouteTime, FSharedBuffer& OutMessage);
+
+private:
+	/** Reads and decompresses the next chunk. */
+	bool ReadChunk();
+
+private:
+	/** Holds the archive that reads the file. */
+	TUniquePtr<FArchive> Archive;
+
+	/** Holds the current chunk. */
+	FSharedBuffer Chunk;
+
+	/** Holds the read offset in the current chunk. */
+	int32 ChunkOffset;
+
+	/** Holds the time at which the recording started. */
+	FDateTime StartTime;
+
+	/** Holds the transport node identifier of the recording process. */
+	FGuid NodeId;
+};
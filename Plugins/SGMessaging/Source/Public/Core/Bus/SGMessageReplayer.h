@@ -0,0 +1,132 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Templates/Atomic.h"
+#include "Core/Bus/SGMessageRecording.h"
+#include "Core/Interface/ISGMessageBus.h"
+
+class FRunnableThread;
+
+/**
+ * Replays a message recording against a message bus.
+ *
+ * The replayer thread injects the recorded messages into the bus in their original order, with their original
+ * tags, senders, recipients, scopes and parameters. The rate scales the time between messages: 1 replays them as
+ * they were recorded, 10 replays them ten times as fast, and 0 replays them as fast as the bus takes them. Every
+ * message is sent again at the time it is injected, and keeps its delay and its time to live.
+ *
+ * Published messages reach the current subscribers of the bus. Recordings of other processes are replayed as if
+ * this process had made them: the addresses of the recording process are mapped to local addresses with the same
+ * index, so that sent messages reach the endpoints that hold the same address slots, such as the endpoints of a
+ * session that starts up the same way. The addresses of other nodes are resolved by adding their nodes for the
+ * duration of the replay.
+ *
+ * @see FSGMessageRecorder, ISGMessageBus::Inject
+ */
+class SGMESSAGING_API FSGMessageReplayer
+	: public FRunnable
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InBus The bus to replay into.
+	 * @param InFilename The name of the recording.
+	 * @param InRate The replay rate (0 = as fast as possible).
+	 */
+	FSGMessageReplayer(const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& InBus, const FString& InFilename,
+	                   double InRate);
+
+	/** Destructor. */
+	virtual ~FSGMessageReplayer() override;
+
+public:
+	/**
+	 * Opens the recording and starts replaying it.
+	 *
+	 * @return true if the replay started, false if the recording could not be read.
+	 */
+	bool Start();
+
+	/**
+	 * Checks whether the replay finished or was stopped.
+	 *
+	 * @return true if done, false otherwise.
+	 */
+	bool IsDone() const
+	{
+		return Done;
+	}
+
+	/**
+	 * Gets the name of the recording.
+	 *
+	 * @return Filename.
+	 */
+	const FString& GetFilename() const
+	{
+		return Filename;
+	}
+
+	/**
+	 * Gets the number of messages replayed so far.
+	 *
+	 * @return Number of messages.
+	 */
+	int64 GetNumReplayed() const
+	{
+		return NumReplayed.Load(EMemoryOrder::Relaxed);
+	}
+
+public:
+	//~ FRunnable interface
+
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/**
+	 * Converts the GUID form of a recorded address to an address in this process.
+	 *
+	 * @param Guid The recorded identifier.
+	 * @return The address, or an invalid address if its node cannot be added.
+	 */
+	FSGMessageAddress ResolveAddress(const FGuid& Guid);
+
+private:
+	/** Holds the bus to replay into. */
+	TWeakPtr<ISGMessageBus, ESPMode::ThreadSafe> Bus;
+
+	/** Holds the name of the recording. */
+	FString Filename;
+
+	/** Holds the replay rate. */
+	double Rate;
+
+	/** Holds the reader of the recording. */
+	TUniquePtr<FSGMessageRecordingReader> Reader;
+
+	/** Holds a transport node identifier of this process, whose node replaces the recording process. */
+	FGuid LocalNodeId;
+
+	/** Holds the identifiers of the nodes that were added for the replay (replay thread only). */
+	TArray<FGuid> AddedNodes;
+
+	/** Holds the number of replayed messages. */
+	TAtomic<int64> NumReplayed;
+
+	/** Holds the number of messages that could not be decoded. */
+	TAtomic<int64> NumSkipped;
+
+	/** Holds a flag indicating that the replay is done. */
+	TAtomic<bool> Done;
+
+	/** Holds a flag indicating that the thread is stopping. */
+	TAtomic<bool> Stopping;
+
+	/** Holds the replay thread. */
+	FRunnableThread* Thread;
+};
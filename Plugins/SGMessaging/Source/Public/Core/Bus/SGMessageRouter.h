@@ -3,13 +3,19 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Async/Future.h"
 #include "Containers/Queue.h"
 #include "HAL/Runnable.h"
 #include "Misc/SingleThreadRunnable.h"
 #include "Templates/Atomic.h"
 #include "Core/Interface/ISGMessageContext.h"
 #include "Core/Interface/ISGMessageTracer.h"
+#include "Core/Bus/SGMessageRecording.h"
 #include "Core/Bus/SGMessageTracer.h"
+#include "Core/Bus/SGMessagingStats.h"
+#include "Core/Bus/SGMessagingTrace.h"
+#include "Core/Bus/SGMessageDispatchTask.h"
+#include "Core/Interface/ISGMessageBus.h"
 
 class ISGMessageInterceptor;
 class ISGMessageReceiver;
@@ -27,6 +33,9 @@ class FSGMessageRouter final
 {
 	DECLARE_DELEGATE(FCommandDelegate)
 
+	/** Type of a batch of messages that is routed as a single command. */
+	typedef TArray<TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>> FContextBatch;
+
 public:
 	/** Default constructor. */
 	FSGMessageRouter();
@@ -71,6 +80,33 @@ public:
 		EnqueueCommand(FSimpleDelegate::CreateRaw(this, &FSGMessageRouter::HandleAddSubscriber, Subscription));
 	}
 
+	/**
+	 * Stops conflating messages of the specified type.
+	 *
+	 * @param MessageTag The type of messages to stop conflating.
+	 */
+	FORCEINLINE void ClearConflation(const FName& MessageTag)
+	{
+		EnqueueCommand(FSimpleDelegate::CreateRaw(this, &FSGMessageRouter::HandleClearConflation, MessageTag));
+	}
+
+	/**
+	 * Stops retaining messages of the specified type.
+	 *
+	 * @param MessageTag The type of messages to stop retaining.
+	 */
+	FORCEINLINE void ClearRetention(const FName& MessageTag)
+	{
+		EnqueueCommand(FSimpleDelegate::CreateRaw(this, &FSGMessageRouter::HandleClearRetention, MessageTag));
+	}
+
+	/**
+	 * Gets the statistics of the router.
+	 *
+	 * @return The statistics.
+	 */
+	FSGMessageBusStats GetStats() const;
+
 	/**
 	 * Gets the message tracer.
 	 *
@@ -125,10 +161,91 @@ public:
 	 */
 	FORCEINLINE void RouteMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
 	{
-		Tracer->TraceSentMessage(Context);
+		TRACE_SGMESSAGING_SEND(*Context, NumQueuedCommands.Load(EMemoryOrder::Relaxed));
+		SG_MESSAGING_TRACE(Tracer->TraceSentMessage(Context));
+		++NumSentMessages;
 		EnqueueCommand(FSimpleDelegate::CreateRaw(this, &FSGMessageRouter::HandleRouteMessage, Context));
 	}
 
+	/**
+	 * Routes a batch of messages as a single command.
+	 *
+	 * The messages of a batch must share their sender, recipients, scope and time sent, so that their
+	 * recipients are resolved once per distinct message tag.
+	 *
+	 * @param Contexts The contexts of the messages to route, in the order in which they are delivered.
+	 */
+	FORCEINLINE void RouteMessages(FContextBatch&& Contexts)
+	{
+		const int32 NumQueued = NumQueuedCommands.Load(EMemoryOrder::Relaxed);
+
+		for (const auto& Context : Contexts)
+		{
+			TRACE_SGMESSAGING_SEND(*Context, NumQueued);
+			SG_MESSAGING_TRACE(Tracer->TraceSentMessage(Context));
+		}
+
+		NumSentMessages += Contexts.Num();
+		EnqueueCommand(FSimpleDelegate::CreateRaw(this, &FSGMessageRouter::HandleRouteMessages,
+		                                          MakeShared<FContextBatch, ESPMode::ThreadSafe>(
+			                                          MoveTemp(Contexts))));
+	}
+
+	/**
+	 * Conflates messages of the specified type.
+	 *
+	 * @param MessageTag The type of messages to conflate.
+	 * @param Conflation The conflation mode.
+	 */
+	FORCEINLINE void SetConflation(const FName& MessageTag, const FSGMessageConflation& Conflation)
+	{
+		EnqueueCommand(FSimpleDelegate::CreateRaw(this, &FSGMessageRouter::HandleSetConflation, MessageTag,
+		                                          Conflation));
+	}
+
+	/**
+	 * Sets the recorder of routed messages.
+	 *
+	 * The previous recorder is released on the router thread, which completes its recording.
+	 *
+	 * @param InRecorder The recorder, or nullptr to stop recording.
+	 */
+	FORCEINLINE void SetRecorder(const TSharedPtr<FSGMessageRecorder, ESPMode::ThreadSafe>& InRecorder)
+	{
+		EnqueueCommand(FSimpleDelegate::CreateRaw(this, &FSGMessageRouter::HandleSetRecorder, InRecorder));
+	}
+
+	/**
+	 * Retains the latest published messages of the specified type for new subscribers.
+	 *
+	 * @param MessageTag The type of messages to retain.
+	 * @param HistorySize The maximum number of messages to retain.
+	 */
+	FORCEINLINE void SetRetention(const FName& MessageTag, const int32 HistorySize)
+	{
+		EnqueueCommand(FSimpleDelegate::CreateRaw(this, &FSGMessageRouter::HandleSetRetention, MessageTag,
+		                                          HistorySize));
+	}
+
+	/**
+	 * Takes a snapshot of the routing tables.
+	 *
+	 * @return The future snapshot, which is fulfilled on the router thread.
+	 */
+	FORCEINLINE TFuture<FSGMessageBusSnapshot> TakeSnapshot()
+	{
+		const TSharedRef<TPromise<FSGMessageBusSnapshot>, ESPMode::ThreadSafe> Promise =
+			MakeShared<TPromise<FSGMessageBusSnapshot>, ESPMode::ThreadSafe>();
+		TFuture<FSGMessageBusSnapshot> Future = Promise->GetFuture();
+
+		if (!EnqueueCommand(FSimpleDelegate::CreateRaw(this, &FSGMessageRouter::HandleTakeSnapshot, Promise)))
+		{
+			Promise->SetValue(FSGMessageBusSnapshot());
+		}
+
+		return Future;
+	}
+
 	/**
 	 * Add a listener to the bus registration events
 	 * 
@@ -176,8 +293,12 @@ protected:
 	 */
 	FORCEINLINE bool EnqueueCommand(const FCommandDelegate Command)
 	{
+		++NumQueuedCommands;
+
 		if (!Commands.Enqueue(Command))
 		{
+			--NumQueuedCommands;
+
 			return false;
 		}
 
@@ -208,6 +329,16 @@ protected:
 		const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
 		TArray<TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>>& OutRecipients);
 
+	/**
+	 * Gathers the recipients of a message, either from its context or from the subscriptions.
+	 *
+	 * @param Context The message context to gather the recipients for.
+	 * @param OutRecipients Will hold the collection of recipients.
+	 */
+	void ResolveRecipients(
+		const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+		TArray<TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>>& OutRecipients);
+
 	/**
 	 * Dispatches a single message to its recipients.
 	 *
@@ -215,6 +346,72 @@ protected:
 	 */
 	void DispatchMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context);
 
+	/**
+	 * Dispatches a batch of messages to their recipients.
+	 *
+	 * Recipients are resolved once per distinct message tag, and the messages for recipients on the same
+	 * thread are handed to a single dispatch task.
+	 *
+	 * @param Contexts The contexts to dispatch, which share their sender, recipients and scope.
+	 */
+	void DispatchMessages(const FContextBatch& Contexts);
+
+	/**
+	 * Dispatches a message of a conflated type to a recipient on a named thread.
+	 *
+	 * If a message with the same conflation key is still waiting for delivery to the recipient, it is replaced
+	 * in place, and no new dispatch task is needed.
+	 *
+	 * @param Context The context of the message to dispatch.
+	 * @param Recipient The recipient.
+	 * @param Conflation The conflation mode of the message type.
+	 * @param RouteCycles The cycle counter at which the message was routed.
+	 */
+	void DispatchConflated(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	                       const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient,
+	                       const FSGMessageConflation& Conflation, uint64 RouteCycles);
+
+	/**
+	 * Dispatches the retained messages of a message type to a new subscription.
+	 *
+	 * @param Subscription The subscription that was added.
+	 * @param Subscriber The subscriber of the subscription.
+	 */
+	void DispatchRetained(const TSharedRef<ISGMessageSubscription, ESPMode::ThreadSafe>& Subscription,
+	                      const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Subscriber);
+
+	/**
+	 * Dispatches a message to a single recipient, on the thread that the recipient receives messages on.
+	 *
+	 * @param Context The context of the message to dispatch.
+	 * @param Recipient The recipient.
+	 * @param Conflation The conflation mode of the message type, or nullptr if not conflated.
+	 * @param RouteCycles The cycle counter at which the message was routed.
+	 */
+	void DispatchToRecipient(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	                         const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient,
+	                         const FSGMessageConflation* Conflation, uint64 RouteCycles);
+
+	/**
+	 * Delivers a message to a recipient on the router thread.
+	 *
+	 * @param Context The context of the message to deliver.
+	 * @param Recipient The recipient, which receives on any thread.
+	 * @param RouteCycles The cycle counter at which the message was routed.
+	 */
+	void DispatchInline(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	                    const TSharedPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient, uint64 RouteCycles);
+
+	/**
+	 * Records, intercepts and delays a message that is being routed.
+	 *
+	 * @param Context The context of the message.
+	 * @param RouteTime The time at which the message is routed.
+	 * @return true if the message is to be dispatched now, false if it was intercepted or delayed.
+	 */
+	bool PrepareDispatch(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	                     const FDateTime& RouteTime);
+
 	/**
 	 * Process all queued commands.
 	 *
@@ -272,10 +469,107 @@ private:
 		}
 	};
 
+	/** Structure for the key by which conflated messages replace each other. */
+	struct FSGConflationKey
+	{
+		/** Holds the recipient of the message (nullptr = delayed message). */
+		const ISGMessageReceiver* Recipient;
+
+		/** Holds the message tag. */
+		FName MessageTag;
+
+		/** Holds the sender (sender keys only). */
+		FSGMessageAddress Sender;
+
+		/** Holds the value of the annotation (annotation keys only). */
+		FString Annotation;
+
+		/** Creates and initializes a new instance. */
+		FSGConflationKey(const ISGMessageContext& Context, const FSGMessageConflation& Conflation,
+		                 const ISGMessageReceiver* InRecipient)
+			: Recipient(InRecipient)
+			  , MessageTag(Context.GetMessageTag())
+		{
+			if (Conflation.Key == ESGMessageConflationKey::Sender)
+			{
+				Sender = Context.GetSender();
+			}
+			else if (Conflation.Key == ESGMessageConflationKey::Annotation)
+			{
+				Annotation = Context.GetAnnotations().FindRef(Conflation.AnnotationKey);
+			}
+		}
+
+		/** Compares two keys for equality. */
+		bool operator==(const FSGConflationKey& Other) const
+		{
+			return (Recipient == Other.Recipient) && (MessageTag == Other.MessageTag) && (Sender == Other.Sender) &&
+				(Annotation == Other.Annotation);
+		}
+
+		/** Gets the hash of a key. */
+		friend uint32 GetTypeHash(const FSGConflationKey& Key)
+		{
+			return HashCombine(HashCombine(PointerHash(Key.Recipient), GetTypeHash(Key.MessageTag)),
+			                   HashCombine(GetTypeHash(Key.Sender), GetTypeHash(Key.Annotation)));
+		}
+	};
+
+	/** Type definition for the conflation slots of a recipient, by conflation key. */
+	typedef TMap<FSGConflationKey, TSharedRef<FSGMessageConflationSlot, ESPMode::ThreadSafe>> FSGConflationSlots;
+
+	/** Structure for the retained messages of a message type. */
+	struct FSGRetainedMessages
+	{
+		/** Holds the retained messages, oldest first. */
+		TArray<TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>> Contexts;
+
+		/** Holds the maximum number of messages to retain. */
+		int32 HistorySize = 1;
+	};
+
+	/** Structure for a recipient registered at a local address. */
+	struct FLocalRecipient
+	{
+		/** Holds the address, which tells apart the generations of the slot. */
+		FSGMessageAddress Address;
+
+		/** Holds the recipient. */
+		TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe> Recipient;
+	};
+
+private:
+	/** Finds the recipient registered at an address. */
+	TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe> FindRecipient(const FSGMessageAddress& Address) const;
+
+	/** Registers a recipient at an address. */
+	void SetRecipient(const FSGMessageAddress& Address, const TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient);
+
+	/** Removes the recipient registered at an address. */
+	void ResetRecipient(const FSGMessageAddress& Address);
+
+	/** Checks whether a delayed message of a conflated type was replaced by a newer one. */
+	bool IsConflated(const FSGDelayedMessage& DelayedMessage);
+
+	/** Retains a published message if its type is retained. */
+	void RetainMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context);
+
+	/** Removes the retained messages that expired. */
+	void RemoveExpiredMessages(FSGRetainedMessages& Retained) const;
+
+	/** Removes the conflation slots of a recipient. */
+	void RemoveConflationSlots(const ISGMessageReceiver* Recipient, const FName& MessageTag);
+
+	/** Removes the conflation slots whose messages were taken by their dispatch tasks. */
+	void PruneConflationSlots();
+
 private:
 	/** Handles adding message interceptors. */
 	void HandleAddInterceptor(TSharedRef<ISGMessageInterceptor, ESPMode::ThreadSafe> Interceptor, FName MessageTag);
 
+	/** Handles clearing the conflation mode of a message type. */
+	void HandleClearConflation(FName MessageTag);
+
 	/** Handles adding message recipients. */
 	void HandleAddRecipient(FSGMessageAddress Address, TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe> RecipientPtr);
 
@@ -294,6 +588,24 @@ private:
 	/** Handles the routing of messages. */
 	void HandleRouteMessage(TSharedRef<ISGMessageContext, ESPMode::ThreadSafe> Context);
 
+	/** Handles the routing of batches of messages. */
+	void HandleRouteMessages(TSharedRef<FContextBatch, ESPMode::ThreadSafe> Contexts);
+
+	/** Handles setting the conflation mode of a message type. */
+	void HandleSetConflation(FName MessageTag, FSGMessageConflation Conflation);
+
+	/** Handles clearing the retention of a message type. */
+	void HandleClearRetention(FName MessageTag);
+
+	/** Handles setting the retention of a message type. */
+	void HandleSetRetention(FName MessageTag, int32 HistorySize);
+
+	/** Handles setting the recorder. */
+	void HandleSetRecorder(TSharedPtr<FSGMessageRecorder, ESPMode::ThreadSafe> InRecorder);
+
+	/** Handles taking snapshots of the routing tables. */
+	void HandleTakeSnapshot(TSharedRef<TPromise<FSGMessageBusSnapshot>, ESPMode::ThreadSafe> Promise);
+
 	/** Handles the addition of a listener. */
 	void HandleAddListener(TWeakPtr<ISGBusListener, ESPMode::ThreadSafe> ListenerPtr);
 
@@ -303,16 +615,57 @@ private:
 	/** Notify listeners about registration */
 	void NotifyRegistration(const FSGMessageAddress& Address, ESGMessageBusNotification Notification);
 
+	/** Notify listeners about a change of the tags that have network subscribers. */
+	void NotifySubscription(const FName& MessageTag, ESGMessageBusNotification Notification);
+
+	/** Notify a single listener about a change of the tags that have network subscribers. */
+	static void NotifySubscription(const TSharedPtr<ISGBusListener, ESPMode::ThreadSafe>& Listener,
+	                               const FName& MessageTag, ESGMessageBusNotification Notification);
+
+	/** Counts a new subscription towards the network interest if local endpoints subscribed at network scope. */
+	void AddNetworkInterest(const TSharedPtr<ISGMessageSubscription, ESPMode::ThreadSafe>& Subscription,
+	                        const ISGMessageReceiver& Subscriber);
+
+	/** Removes a subscription from the network interest if it was counted. */
+	void RemoveNetworkInterest(const TSharedPtr<ISGMessageSubscription, ESPMode::ThreadSafe>& Subscription);
+
 private:
 	/** Maps message types to interceptors. */
 	TMap<FName, TArray<TSharedPtr<ISGMessageInterceptor, ESPMode::ThreadSafe>>> ActiveInterceptors;
 
-	/** Maps message addresses to recipients. */
-	TMap<FSGMessageAddress, TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe>> ActiveRecipients;
+	/** Holds the recipients at local addresses, indexed by address slot. */
+	TArray<FLocalRecipient> LocalRecipients;
+
+	/** Maps other message addresses, such as remote endpoints registered by bridges, to recipients. */
+	TMap<FSGMessageAddress, TWeakPtr<ISGMessageReceiver, ESPMode::ThreadSafe>> RemoteRecipients;
 
 	/** Maps message types to subscriptions. */
 	TMap<FName, TArray<TSharedPtr<ISGMessageSubscription, ESPMode::ThreadSafe>>> ActiveSubscriptions;
 
+	/** Holds the subscriptions that count towards the network interest. */
+	TSet<const ISGMessageSubscription*> NetworkSubscriptions;
+
+	/** Maps message tags to the number of network subscriptions of local endpoints. */
+	TMap<FName, int32> NetworkInterest;
+
+	/** Maps conflated message types to their conflation modes. */
+	TMap<FName, FSGMessageConflation> Conflations;
+
+	/** Maps recipients to their conflation slots, so that removing a recipient only visits its own. */
+	TMap<const ISGMessageReceiver*, FSGConflationSlots> ConflationSlots;
+
+	/** Holds the total number of conflation slots. */
+	int32 NumConflationSlots;
+
+	/** Holds the number of conflation slots at which they are pruned next. */
+	int32 NextConflationPrune;
+
+	/** Maps conflation keys to the sequence number of the latest delayed message. */
+	TMap<FSGConflationKey, int64> DelayedConflations;
+
+	/** Maps retained message types to their retained messages. */
+	TMap<FName, FSGRetainedMessages> RetainedMessages;
+
 	/** Array of active registration listeners. */
 	TArray<TWeakPtr<ISGBusListener, ESPMode::ThreadSafe>> ActiveRegistrationListeners;
 
@@ -328,12 +681,33 @@ private:
 	/** Holds a sequence number for delayed messages. */
 	int64 DelayedMessagesSequence;
 
+	/** Holds the number of commands that were queued up, but not processed yet. */
+	TAtomic<int32> NumQueuedCommands;
+
+	/** Holds the number of delayed messages, for reading from other threads. */
+	TAtomic<int32> NumDelayedMessages;
+
+	/** Holds the number of messages that were sent. */
+	TAtomic<int64> NumSentMessages;
+
+	/** Holds the number of messages that were routed. */
+	TAtomic<int64> NumRoutedMessages;
+
+	/** Holds the number of messages that were intercepted. */
+	TAtomic<int64> NumInterceptedMessages;
+
+	/** Holds the number of messages that were replaced by newer conflated messages. */
+	TAtomic<int64> NumConflatedMessages;
+
 	/** Holds a flag indicating that the thread is stopping. */
 	TAtomic<bool> Stopping;
 
 	/** Holds the message tracer. */
 	TSharedRef<FSGMessageTracer, ESPMode::ThreadSafe> Tracer;
 
+	/** Holds the recorder of routed messages, if recording. */
+	TSharedPtr<FSGMessageRecorder, ESPMode::ThreadSafe> Recorder;
+
 	/** Holds an event signaling that work is available. */
 	FEvent* WorkEvent;
 
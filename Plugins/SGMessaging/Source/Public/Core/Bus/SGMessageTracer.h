@@ -3,19 +3,43 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HAL/Runnable.h"
 #include "Misc/Guid.h"
-#include "Containers/Queue.h"
+#include "Misc/ScopeRWLock.h"
+#include "Templates/Atomic.h"
 #include "Core/Interface/ISGMessageContext.h"
 #include "Core/Interface/ISGMessageTracer.h"
-#include "Containers/Ticker.h"
+#include "Core/Bus/SGMessageLatencyStats.h"
 
+class FEvent;
+class FRunnableThread;
 class ISGMessageInterceptor;
 class ISGMessageReceiver;
 class ISGMessageSubscription;
 class ISGMessageTracerBreakpoint;
 
+/** Whether message tracing is compiled in. */
+#ifndef SG_MESSAGING_WITH_TRACER
+	#define SG_MESSAGING_WITH_TRACER !UE_BUILD_SHIPPING
+#endif
+
+/** Evaluates a tracer call only if message tracing is compiled in. */
+#if SG_MESSAGING_WITH_TRACER
+	#define SG_MESSAGING_TRACE(Expression) Expression
+#else
+	#define SG_MESSAGING_TRACE(Expression)
+#endif
+
+
 /**
  * Implements a message bus tracers.
+ *
+ * Tracing a message bus event does not allocate memory. The event is written as a fixed-size record into a ring
+ * buffer that belongs to the calling thread, and the records of all threads are merged into the tracer's database
+ * on a dedicated thread. Records are dropped when a ring is full, and messages are removed from the database once
+ * they are older than the retention window (see USGMessagingSettings).
+ *
+ * Tracing is compiled out of Shipping builds (see SG_MESSAGING_WITH_TRACER), where the tracer never records anything.
  */
 class FSGMessageTracer final
 	: public ISGMessageTracer
@@ -28,6 +52,7 @@ public:
 	virtual ~FSGMessageTracer() override;
 
 public:
+#if SG_MESSAGING_WITH_TRACER
 	/**
 	 * Notifies the tracer that a message interceptor has been added to the message bus.
 	 *
@@ -119,6 +144,17 @@ public:
 	 * @param Context The context of the sent message.
 	 */
 	void TraceSentMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context);
+#endif
+
+	/**
+	 * Gets the latency histograms, which are recorded even if tracing is compiled out.
+	 *
+	 * @return The latency histograms.
+	 */
+	const TSharedRef<FSGMessageLatencyStats, ESPMode::ThreadSafe>& GetLatencyStats() const
+	{
+		return LatencyStats;
+	}
 
 public:
 	//~ ISGMessageTracer interface
@@ -126,6 +162,7 @@ public:
 	virtual void Break() override;
 	virtual void Continue() override;
 	virtual int32 GetEndpoints(TArray<TSharedPtr<FSGMessageTracerEndpointInfo>>& OutEndpoints) const override;
+	virtual int32 GetLatencies(TArray<FSGMessageTracerLatencyInfo>& OutLatencies) const override;
 	virtual int32 GetMessages(TArray<TSharedPtr<FSGMessageTracerMessageInfo>>& OutMessages) const override;
 	virtual int32 GetMessageTags(TArray<TSharedPtr<FSGMessageTracerTypeInfo>>& OutTypes) const override;
 	virtual bool HasMessages() const override;
@@ -154,12 +191,13 @@ public:
 	}
 
 	virtual void Reset() override;
+	virtual void ResetLatencies() override;
 	virtual void Step() override;
 	virtual void Stop() override;
 	virtual bool Tick(float DeltaTime) override;
 
 protected:
-	/** Resets traced messages. */
+	/** Resets traced messages. Requires the database lock. */
 	void ResetMessages();
 
 	/**
@@ -169,10 +207,123 @@ protected:
 	 */
 	bool ShouldBreak(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context) const;
 
+private:
+	/** Enumerates the types of trace records. */
+	enum class ERecordType : uint8
+	{
+		AddedInterceptor,
+		AddedRecipient,
+		DispatchedMessage,
+		HandledMessage,
+		InterceptedMessage,
+		RemovedInterceptor,
+		RemovedRecipient,
+		RoutedMessage,
+		SentMessage
+	};
+
+	/** Structure for a traced event, which must remain trivially copyable. */
+	struct FRecord
+	{
+		/** Holds the time at which the event occurred. */
+		double Timestamp;
+
+		/** Holds the identity of the message context (never dereferenced). */
+		UPTRINT MessageId;
+
+		/** Holds the message tag. */
+		FName MessageTag;
+
+		/** Holds the debug name of the recipient or interceptor. */
+		FName Name;
+
+		/** Holds the identifier of the recipient or interceptor. */
+		FGuid Id;
+
+		/** Holds the address of the sender or recipient. */
+		FSGMessageAddress Address;
+
+		/** Holds the thread on which the recipient receives messages. */
+		ENamedThreads::Type RecipientThread;
+
+		/** Holds the type of the event. */
+		ERecordType Type;
+
+		/** Holds a flag indicating an asynchronous dispatch or a remote recipient. */
+		bool bFlag;
+	};
+
+	/** Structure for the ring buffer of records that a single thread writes. */
+	struct FRing
+	{
+		explicit FRing(const uint32 Capacity)
+			: Head(0)
+			  , Tail(0)
+			  , NumDropped(0)
+		{
+			Records.SetNumZeroed(Capacity);
+		}
+
+		/** Holds the records, whose number is a power of two. */
+		TArray<FRecord> Records;
+
+		/** Holds the number of records written, which only the owning thread changes. */
+		TAtomic<uint32> Head;
+
+		/** Holds the number of records read, which only the tracer thread changes. */
+		TAtomic<uint32> Tail;
+
+		/** Holds the number of records dropped because the ring was full. */
+		TAtomic<uint32> NumDropped;
+	};
+
+	/** Implements the tracer thread. */
+	class FProcessor final
+		: public FRunnable
+	{
+	public:
+		explicit FProcessor(FSGMessageTracer& InTracer)
+			: Tracer(InTracer)
+		{
+		}
+
+	public:
+		//~ FRunnable interface
+
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+
+	private:
+		/** Holds the tracer that owns the thread. */
+		FSGMessageTracer& Tracer;
+	};
+
+	/** Writes a record into the ring of the calling thread. */
+	void AddRecord(const FRecord& Record);
+
+	/** Applies a record to the database and collects new messages and types. Requires the database lock. */
+	void ApplyRecord(const FRecord& Record, TArray<FSGMessageTracerMessageInfoRef>& OutMessages,
+	                 TArray<FSGMessageTracerTypeInfoRef>& OutTypes);
+
+	/** Removes messages that are older than the retention window. Requires the database lock. */
+	void EvictMessages(double Now);
+
+	/** Gets the ring of the calling thread. */
+	FRing& GetThreadRing();
+
+	/** Creates a record of the given type, stamped with the current time. */
+	static FRecord MakeRecord(ERecordType Type);
+
+	/** Merges the records of all threads into the database. Returns true if any records were processed. */
+	bool ProcessRecords();
+
 private:
 	/** Holds the collection of endpoints for known message addresses. */
 	TMap<FSGMessageAddress, TSharedPtr<FSGMessageTracerEndpointInfo>> AddressesToEndpointInfos;
 
+	/** Holds the latency histograms. */
+	TSharedRef<FSGMessageLatencyStats, ESPMode::ThreadSafe> LatencyStats;
+
 	/** Holds a flag indicating whether a breakpoint was hit. */
 	bool Breaking;
 
@@ -188,23 +339,62 @@ private:
 	/** Holds the collection of endpoints for known recipient identifiers. */
 	TMap<FGuid, TSharedPtr<FSGMessageTracerEndpointInfo>> RecipientsToEndpointInfos;
 
-	/** Holds the collection of known messages. */
-	TMap<TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe>, TSharedPtr<FSGMessageTracerMessageInfo>> MessageInfos;
+	/** Holds the collection of known messages by message identity. */
+	TMap<UPTRINT, TSharedPtr<FSGMessageTracerMessageInfo>> MessageInfos;
+
+	/** Holds the known messages and their identities in the order in which they were sent. */
+	TArray<TPair<UPTRINT, TSharedPtr<FSGMessageTracerMessageInfo>>> MessageOrder;
 
 	/** Holds the collection of known message types. */
 	TMap<FName, TSharedPtr<FSGMessageTracerTypeInfo>> MessageTags;
 
 	/** Holds a flag indicating whether a reset is pending. */
-	bool ResetPending;
+	TAtomic<bool> ResetPending;
 
 	/** Holds a flag indicating whether the tracer is running. */
-	bool Running;
+	TAtomic<bool> Running;
+
+	/** Protects the database of endpoints, interceptors, messages and types. */
+	mutable FRWLock DatabaseLock;
+
+	/** Holds the records that are being merged, which is reused between passes. */
+	TArray<FRecord> Batch;
+
+	/** Holds the time of the last eviction pass. */
+	double LastEvictionTime;
+
+	/** Holds the number of records dropped since the last eviction pass. */
+	uint32 NumDroppedRecords;
+
+	/** Serializes merging between the tracer thread and Tick. */
+	FCriticalSection ProcessLock;
+
+	/** Holds the number of records per thread ring. */
+	uint32 RingCapacity;
+
+	/** Holds the rings of all threads that traced events, by thread identifier. */
+	TMap<uint32, TUniquePtr<FRing>> Rings;
+
+	/** Protects the ring map. */
+	mutable FRWLock RingsLock;
+
+	/** Holds the time for which messages are kept (in seconds). */
+	double RetentionTime;
+
+	/** Holds a number that identifies this tracer in the per-thread ring caches. */
+	uint64 Serial;
+
+	/** Holds a flag indicating that the tracer thread is stopping. */
+	TAtomic<bool> Stopping;
+
+	/** Holds the tracer thread. */
+	FRunnableThread* Thread;
 
-	/** Handle to the registered TickDelegate. */
-	FTSTicker::FDelegateHandle TickDelegateHandle;
+	/** Holds the runnable of the tracer thread. */
+	TUniquePtr<FProcessor> Processor;
 
-	/** Holds the trace actions queue. */
-	TQueue<TFunction<void()>, EQueueMode::Mpsc> Traces;
+	/** Holds an event that wakes the tracer thread. */
+	FEvent* WorkEvent;
 
 private:
 	/** Holds a delegate that is executed when a new message has been added to the collection of known messages. */
@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+#include "Templates/Atomic.h"
+#include "Core/Interface/ISGMessageBus.h"
+#include "Core/Interface/ISGMessageReceiver.h"
+
+DECLARE_STATS_GROUP(TEXT("SGMessaging"), STATGROUP_SGMessaging, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Process Commands"), STAT_SGMessaging_ProcessCommands, STATGROUP_SGMessaging,
+                          SGMESSAGING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dispatch Message"), STAT_SGMessaging_DispatchMessage, STATGROUP_SGMessaging,
+                          SGMESSAGING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Filter Subscriptions"), STAT_SGMessaging_FilterSubscriptions, STATGROUP_SGMessaging,
+                          SGMESSAGING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Process Inbox"), STAT_SGMessaging_ProcessInbox, STATGROUP_SGMessaging,
+                          SGMESSAGING_API);
+
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Messages Sent/s"), STAT_SGMessaging_MessagesSent, STATGROUP_SGMessaging,
+                                      SGMESSAGING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Messages Dispatched/s"), STAT_SGMessaging_MessagesDispatched,
+                                      STATGROUP_SGMessaging, SGMESSAGING_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Dispatch Latency (us)"), STAT_SGMessaging_DispatchLatency,
+                                      STATGROUP_SGMessaging, SGMESSAGING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Router Queue Depth"), STAT_SGMessaging_RouterQueueDepth,
+                                      STATGROUP_SGMessaging, SGMESSAGING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Delayed Messages"), STAT_SGMessaging_DelayedMessages,
+                                      STATGROUP_SGMessaging, SGMESSAGING_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Inbox Messages"), STAT_SGMessaging_InboxMessages, STATGROUP_SGMessaging,
+                                      SGMESSAGING_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SGMESSAGING_API, SGMessaging);
+
+
+/**
+ * Implements the sampling of message bus statistics for the stats system and the CSV profiler.
+ *
+ * Cycle counters are scoped directly where the work happens. All other statistics are sampled once per frame by
+ * Update, which turns the counters of every bus into rates since the previous update. The stats system shows the
+ * totals of all buses, while CSV captures get the totals as well as columns for each bus, so that automated
+ * performance runs can chart the load of a bus next to the frame time.
+ *
+ * @see ISGMessageBus::GetStats
+ */
+class SGMESSAGING_API FSGMessagingStats
+{
+public:
+	/**
+	 * Samples the statistics of the given buses.
+	 *
+	 * Must be called once per frame from the same thread.
+	 *
+	 * @param Buses The buses to sample.
+	 */
+	void Update(const TArray<TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>>& Buses);
+
+public:
+	/**
+	 * Adds a receiver whose inbox is included in the statistics.
+	 *
+	 * Receivers count the messages in their own inbox, and the counts are only summed up by Update, so that
+	 * threads queuing up messages do not contend on a shared counter.
+	 *
+	 * @param Receiver The receiver to add.
+	 * @see RemoveInbox
+	 */
+	static void AddInbox(const ISGMessageReceiver& Receiver);
+
+	/**
+	 * Removes a receiver that was added before. Must be called before the receiver is destroyed.
+	 *
+	 * @param Receiver The receiver to remove.
+	 * @see AddInbox
+	 */
+	static void RemoveInbox(const ISGMessageReceiver& Receiver);
+
+private:
+	/** Structure for the previous sample of a bus. */
+	struct FBusSample
+	{
+		/** Holds the statistics at the time of the sample. */
+		FSGMessageBusStats Stats;
+
+		/** Holds the names of the CSV stats of the bus. */
+		FName SentStatName;
+		FName DispatchedStatName;
+		FName LatencyStatName;
+		FName QueueDepthStatName;
+		FName DelayedStatName;
+	};
+
+private:
+	/** Holds the previous samples by bus name. */
+	TMap<FString, FBusSample> Samples;
+
+	/** Holds the time of the previous update. */
+	double LastUpdateTime = 0.0;
+};
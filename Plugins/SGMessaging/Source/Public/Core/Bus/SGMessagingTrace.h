@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Trace/Config.h"
+#include "Trace/Trace.h"
+
+class ISGMessageContext;
+class ISGMessageReceiver;
+class FName;
+struct FDateTime;
+
+/** Whether message bus events are written to Unreal Insights. */
+#if !defined(SG_MESSAGING_INSIGHTS_ENABLED)
+	#if UE_TRACE_ENABLED && !UE_BUILD_SHIPPING
+		#define SG_MESSAGING_INSIGHTS_ENABLED 1
+	#else
+		#define SG_MESSAGING_INSIGHTS_ENABLED 0
+	#endif
+#endif
+
+#if SG_MESSAGING_INSIGHTS_ENABLED
+
+UE_TRACE_CHANNEL_EXTERN(SGMessagingChannel, SGMESSAGING_API)
+
+/**
+ * Implements the output of message bus events to Unreal Insights.
+ *
+ * Events are written to the SGMessaging trace channel, which is enabled with -trace=sgmessaging or at run-time
+ * with Trace.Enable SGMessaging. Every event carries the message tag and an identifier of the message, so that
+ * the send, route, intercept, dispatch and handle events of a message can be related to each other. Handlers
+ * are additionally wrapped in CPU scopes that are named after the message tag if the CPU channel is enabled.
+ *
+ * Use the TRACE_SGMESSAGING_* macros instead of calling this class directly.
+ */
+struct SGMESSAGING_API FSGMessagingTrace
+{
+	/** Outputs the event of a message that was handed to the router. */
+	static void OutputSend(const ISGMessageContext& Context, int32 QueueDepth);
+
+	/** Outputs the event of a message that the router started routing. */
+	static void OutputRoute(const ISGMessageContext& Context, int32 QueueDepth, const FDateTime& CurrentTime);
+
+	/** Outputs the event of a message that an interceptor consumed. */
+	static void OutputIntercept(const ISGMessageContext& Context, const FName& InterceptorName);
+
+	/** Outputs the event of a message that was dispatched to a recipient. */
+	static void OutputDispatch(const ISGMessageContext& Context, const ISGMessageReceiver& Recipient, bool bAsync);
+
+	/**
+	 * Implements a scope around the execution of a message handler.
+	 */
+	class SGMESSAGING_API FHandleScope
+	{
+	public:
+		FHandleScope(const ISGMessageContext& InContext, const ISGMessageReceiver& InRecipient);
+		~FHandleScope();
+
+	private:
+		/** Holds the context of the handled message, or nullptr if the channel was disabled. */
+		const ISGMessageContext* Context;
+
+		/** Holds the recipient that handles the message. */
+		const ISGMessageReceiver* Recipient;
+
+		/** Holds the cycle counter at which the handler started. */
+		uint64 StartCycle;
+
+		/** Holds a flag indicating whether a CPU scope was opened. */
+		bool bCpuScope;
+	};
+};
+
+#define TRACE_SGMESSAGING_SEND(Context, QueueDepth) \
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(SGMessagingChannel)) \
+	{ \
+		FSGMessagingTrace::OutputSend(Context, QueueDepth); \
+	}
+
+#define TRACE_SGMESSAGING_ROUTE(Context, QueueDepth, CurrentTime) \
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(SGMessagingChannel)) \
+	{ \
+		FSGMessagingTrace::OutputRoute(Context, QueueDepth, CurrentTime); \
+	}
+
+#define TRACE_SGMESSAGING_INTERCEPT(Context, InterceptorName) \
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(SGMessagingChannel)) \
+	{ \
+		FSGMessagingTrace::OutputIntercept(Context, InterceptorName); \
+	}
+
+#define TRACE_SGMESSAGING_DISPATCH(Context, Recipient, bAsync) \
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(SGMessagingChannel)) \
+	{ \
+		FSGMessagingTrace::OutputDispatch(Context, Recipient, bAsync); \
+	}
+
+#define TRACE_SGMESSAGING_HANDLE_SCOPE(Context, Recipient) \
+	FSGMessagingTrace::FHandleScope PREPROCESSOR_JOIN(SGMessagingHandleScope, __LINE__)(Context, Recipient);
+
+#else
+
+#define TRACE_SGMESSAGING_SEND(Context, QueueDepth)
+#define TRACE_SGMESSAGING_ROUTE(Context, QueueDepth, CurrentTime)
+#define TRACE_SGMESSAGING_INTERCEPT(Context, InterceptorName)
+#define TRACE_SGMESSAGING_DISPATCH(Context, Recipient, bAsync)
+#define TRACE_SGMESSAGING_HANDLE_SCOPE(Context, Recipient)
+
+#endif
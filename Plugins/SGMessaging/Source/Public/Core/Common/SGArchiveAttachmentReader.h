@@ -0,0 +1,41 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Interface/ISGMessageAttachment.h"
+
+/**
+ * Implements a chunked attachment reader on top of an archive.
+ *
+ * Chunks are copied into a buffer that is reused for every chunk, and prefetches are forwarded to the archive's
+ * precache, which lets file readers start the next read while the current chunk is being sent.
+ */
+class FSGArchiveAttachmentReader final
+	: public ISGMessageAttachmentReader
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InArchive The archive to read from.
+	 */
+	explicit FSGArchiveAttachmentReader(TUniquePtr<FArchive>&& InArchive);
+
+public:
+	//~ ISGMessageAttachmentReader interface
+
+	virtual int64 GetSize() const override;
+	virtual FMemoryView ReadChunk(int64 Offset, int64 Size) override;
+	virtual void Prefetch(int64 Offset, int64 Size) override;
+
+private:
+	/** Holds the archive. */
+	TUniquePtr<FArchive> Archive;
+
+	/** Holds the buffer of the last chunk. */
+	TArray<uint8> Buffer;
+
+	/** Holds the size of the data. */
+	int64 TotalSize;
+};
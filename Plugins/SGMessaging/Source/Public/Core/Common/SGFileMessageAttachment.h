@@ -9,9 +9,10 @@
 /**
  * Implements a message attachment whose data is held in a file.
  *
- * WARNING: Message attachments do not work yet for out of process messages.
+ * Chunks are read from a memory mapping of the file where the platform supports it, so that streaming the
+ * attachment to other processes neither loads the whole file nor copies it.
  */
-class FSGFileMessageAttachment final
+class SGMESSAGING_API FSGFileMessageAttachment final
 	: public ISGMessageAttachment
 {
 public:
@@ -55,6 +56,8 @@ public:
 		return IFileManager::Get().CreateFileReader(*Filename);
 	}
 
+	virtual TUniquePtr<ISGMessageAttachmentReader> CreateChunkReader() override;
+
 private:
 	/** Holds a flag indicating whether the file should be deleted. */
 	bool AutoDeleteFile;
@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Interface/ISGMessageAttachment.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Implements a chunked attachment reader for memory-mapped files.
+ *
+ * Only the chunk that is being read and the prefetched chunk are mapped, so reading a file of any size
+ * touches a bounded amount of address space. Chunks are returned straight from the mapping without being
+ * copied, and prefetched chunks are mapped with a preload hint, so that the operating system reads them
+ * ahead in the background.
+ */
+class FSGMappedFileAttachmentReader final
+	: public ISGMessageAttachmentReader
+{
+public:
+	/**
+	 * Opens a file for mapping.
+	 *
+	 * @param Filename The full name and path of the file.
+	 * @return The reader, or nullptr if the platform cannot map the file.
+	 */
+	static TUniquePtr<FSGMappedFileAttachmentReader> Open(const FString& Filename);
+
+	/** Destructor. */
+	virtual ~FSGMappedFileAttachmentReader() override;
+
+public:
+	//~ ISGMessageAttachmentReader interface
+
+	virtual int64 GetSize() const override;
+	virtual FMemoryView ReadChunk(int64 Offset, int64 Size) override;
+	virtual void Prefetch(int64 Offset, int64 Size) override;
+
+private:
+	/** Creates and initializes a new instance. */
+	explicit FSGMappedFileAttachmentReader(IMappedFileHandle* InHandle);
+
+private:
+	/** Holds the handle of the mapped file. */
+	IMappedFileHandle* Handle;
+
+	/** Holds the region of the last chunk that was read. */
+	IMappedFileRegion* Region;
+
+	/** Holds the region of the prefetched chunk. */
+	IMappedFileRegion* PrefetchRegion;
+
+	/** Holds the offset of the prefetched region. */
+	int64 PrefetchOffset;
+
+	/** Holds the size of the prefetched region. */
+	int64 PrefetchSize;
+};
@@ -0,0 +1,268 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreTypes.h"
+#include "Containers/UnrealString.h"
+#include "Misc/Guid.h"
+#include "Serialization/Archive.h"
+#include "Templates/TypeHash.h"
+
+
+/**
+ * Structure for message endpoint addresses.
+ *
+ * An address is a compact handle made of a 32-bit node number and a 32-bit index. Addresses created in this
+ * process share the local node number, and their index refers to a slot that is recycled with a new generation
+ * when the address is released, so that stale copies of an address never match the slot's new owner. Slots are
+ * retired after 256 generations, which limits a process to 2^32 addresses over its lifetime.
+ *
+ * Every address also has a GUID form, which is used on the wire and when addresses are persisted. The upper
+ * 96 bits of the GUID identify the node and are interned into a process-wide node table, the lower 32 bits are
+ * the index. Converting between the two forms therefore does not need to look up individual addresses. Only the
+ * GUIDs of this process and of the nodes that were added through AddNode() convert back to valid addresses, so
+ * that received data cannot grow the node table.
+ */
+struct FSGMessageAddress
+{
+public:
+	/** The node number of addresses created in this process. */
+	static constexpr uint32 LocalNode = 1;
+
+	/** The number of index bits that hold the slot of a local address; the remaining 8 bits hold its generation. */
+	static constexpr uint32 SlotBits = 24;
+
+	/** Default constructor (creates an invalid address). */
+	FSGMessageAddress()
+		: Value(0)
+	{
+	}
+
+public:
+	/**
+	 * Compares two message addresses for equality.
+	 *
+	 * @param X The first address to compare.
+	 * @param Y The second address to compare.
+	 * @return true if the addresses are equal, false otherwise.
+	 */
+	friend bool operator==(const FSGMessageAddress& X, const FSGMessageAddress& Y)
+	{
+		return (X.Value == Y.Value);
+	}
+
+	/**
+	 * Compares two message addresses for inequality.
+	 *
+	 * @param X The first address to compare.
+	 * @param Y The second address to compare.
+	 * @return true if the addresses are not equal, false otherwise.
+	 */
+	friend bool operator!=(const FSGMessageAddress& X, const FSGMessageAddress& Y)
+	{
+		return (X.Value != Y.Value);
+	}
+
+	/**
+	 * Serializes a message address from or into an archive.
+	 *
+	 * Addresses are serialized in their GUID form.
+	 *
+	 * @param Ar The archive to serialize from or into.
+	 * @param A The address to serialize.
+	 */
+	friend FArchive& operator<<(FArchive& Ar, FSGMessageAddress& A)
+	{
+		FGuid Guid = A.ToGuid();
+
+		Ar << Guid;
+
+		if (Ar.IsLoading())
+		{
+			A = FromGuid(Guid);
+		}
+
+		return Ar;
+	}
+
+public:
+	/**
+	 * Invalidates the address.
+	 *
+	 * @see IsValid
+	 */
+	void Invalidate()
+	{
+		Value = 0;
+	}
+
+	/**
+	 * Checks whether this message address is valid or not.
+	 *
+	 * @return true if valid, false otherwise.
+	 * @see Invalidate
+	 */
+	bool IsValid() const
+	{
+		return (Value != 0);
+	}
+
+	/**
+	 * Checks whether this address was created in this process.
+	 *
+	 * @return true if local, false otherwise.
+	 * @see GetSlot
+	 */
+	bool IsLocal() const
+	{
+		return (GetNode() == LocalNode);
+	}
+
+	/**
+	 * Gets the node number of this address.
+	 *
+	 * @return Node number.
+	 */
+	uint32 GetNode() const
+	{
+		return static_cast<uint32>(Value >> 32);
+	}
+
+	/**
+	 * Gets the index of this address within its node.
+	 *
+	 * @return Index.
+	 */
+	uint32 GetIndex() const
+	{
+		return static_cast<uint32>(Value);
+	}
+
+	/**
+	 * Gets the slot of a local address, which is suitable for indexing arrays.
+	 *
+	 * @return Slot number.
+	 * @see IsLocal
+	 */
+	uint32 GetSlot() const
+	{
+		return GetIndex() & ((1u << SlotBits) - 1);
+	}
+
+	/**
+	 * Converts this address to the string representation of its GUID.
+	 *
+	 * @return The string representation.
+	 * @see Parse
+	 */
+	FString ToString() const
+	{
+		return ToGuid().ToString();
+	}
+
+	/**
+	 * Gets the GUID form of this address.
+	 *
+	 * @return The identifier.
+	 * @see FromGuid
+	 */
+	SGMESSAGING_API FGuid ToGuid() const;
+
+public:
+	/**
+	 * Calculates the hash for a message address.
+	 *
+	 * @param Address The address to calculate the hash for.
+	 * @return The hash.
+	 */
+	friend uint32 GetTypeHash(const FSGMessageAddress& Address)
+	{
+		return ::GetTypeHash(Address.Value);
+	}
+
+public:
+	/**
+	 * Returns a new local message address.
+	 *
+	 * @return A new address.
+	 * @see Release
+	 */
+	static SGMESSAGING_API FSGMessageAddress NewAddress();
+
+	/**
+	 * Releases a local message address, so that its slot can be reused.
+	 *
+	 * Copies of the address that are still around do not match the slot's next owner.
+	 *
+	 * @param Address The address to release.
+	 * @see NewAddress
+	 */
+	static SGMESSAGING_API void Release(const FSGMessageAddress& Address);
+
+	/**
+	 * Creates a message address from its GUID form.
+	 *
+	 * @param Guid The identifier.
+	 * @return The address, or an invalid address if the GUID belongs to a node that is not added.
+	 * @see AddNode, ToGuid
+	 */
+	static SGMESSAGING_API FSGMessageAddress FromGuid(const FGuid& Guid);
+
+	/**
+	 * Creates a transport node identifier for this process.
+	 *
+	 * The upper 96 bits of the identifier are the node part of this process's addresses, so that processes
+	 * that discover the transport node can add it and resolve the addresses it sends from.
+	 *
+	 * @return A new identifier.
+	 * @see AddNode
+	 */
+	static SGMESSAGING_API FGuid NewNodeId();
+
+	/**
+	 * Adds the node of a discovered transport node, so that GUIDs of addresses on that node are resolved.
+	 *
+	 * Nodes are reference counted, every call must be matched by a call to RemoveNode().
+	 *
+	 * @param NodeId The transport node identifier.
+	 * @return true if the node was added, false if too many nodes are known.
+	 * @see NewNodeId, RemoveNode
+	 */
+	static SGMESSAGING_API bool AddNode(const FGuid& NodeId);
+
+	/**
+	 * Removes a node that was added before.
+	 *
+	 * Existing addresses on the node remain usable, but their GUIDs are no longer resolved.
+	 *
+	 * @param NodeId The transport node identifier.
+	 * @see AddNode
+	 */
+	static SGMESSAGING_API void RemoveNode(const FGuid& NodeId);
+
+	/**
+	 * Converts a string to a message address.
+	 *
+	 * @param String The string to convert.
+	 * @param OutAddress Will contain the parsed address.
+	 * @return true if the string was converted to a valid address, false if it is malformed or its node is not added.
+	 * @see AddNode, ToString
+	 */
+	static bool Parse(const FString& String, FSGMessageAddress& OutAddress)
+	{
+		FGuid Guid;
+
+		if (!FGuid::Parse(String, Guid))
+		{
+			return false;
+		}
+
+		OutAddress = FromGuid(Guid);
+
+		return OutAddress.IsValid();
+	}
+
+private:
+	/** Holds the node number and the index. */
+	uint64 Value;
+};
@@ -0,0 +1,514 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformProcess.h"
+#include "Templates/Atomic.h"
+#include "Core/Common/SGMessageEndpoint.h"
+
+/** Whether the awaitable bus operations are available, which requires C++20 coroutines. */
+#if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+#define SG_MESSAGING_WITH_COROUTINES 1
+#else
+#define SG_MESSAGING_WITH_COROUTINES 0
+#endif
+
+#if SG_MESSAGING_WITH_COROUTINES
+
+#include <coroutine>
+
+/**
+ * Implements the base of the awaitable bus operations.
+ *
+ * An awaiter lives in the frame of the awaiting coroutine and is linked into its endpoint as a waiter, so that
+ * awaiting allocates nothing beyond the coroutine frame. The endpoint completes it from its regular receive path,
+ * and the coroutine resumes on the chosen thread: inline if that is the completing thread or AnyThread, and in a
+ * task graph task otherwise. Endpoints that receive on the resume thread therefore resume without any task.
+ *
+ * Every operation resumes with an FSGMessageReply, which is cancelled if the endpoint was disabled or destroyed.
+ *
+ * The endpoint may complete an awaiter on another thread while its coroutine is still suspending. The awaiter and
+ * the completion therefore hand over through an atomic state: whichever of the two finishes last resumes the
+ * coroutine, so that it never resumes before it suspended. Destroying a suspended coroutine withdraws its awaiter,
+ * and waits for a completion that already took the awaiter from the endpoint.
+ *
+ * @see FSGMessageAwait
+ */
+class FSGMessageAwaiter
+	: public FSGMessageWaiter
+{
+	/** Enumerates the states of the hand-over between the awaiting coroutine and the completion. */
+	enum class EState : uint8
+	{
+		/** The awaiter does not wait. */
+		Idle,
+
+		/** The coroutine is suspending, and the endpoint may hold the awaiter. */
+		Suspending,
+
+		/** The coroutine is suspended, and the completion resumes it. */
+		Suspended,
+
+		/** The completion arrived, and the awaiter holds its reply. */
+		Completed,
+
+		/** The suspended coroutine is being destroyed, and waits for a completion in flight. */
+		Withdrawn,
+
+		/** The completion is done with the withdrawn awaiter. */
+		Released
+	};
+
+public:
+	FSGMessageAwaiter(const FSGMessageAwaiter&) = delete;
+	FSGMessageAwaiter& operator=(const FSGMessageAwaiter&) = delete;
+
+	bool await_ready() const
+	{
+		return false;
+	}
+
+	FSGMessageReply await_resume()
+	{
+		return MoveTemp(Reply);
+	}
+
+protected:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InEndpoint The endpoint to wait on.
+	 * @param InResumeThread The thread to resume the coroutine on.
+	 */
+	FSGMessageAwaiter(const TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe>& InEndpoint,
+	                  const ENamedThreads::Type InResumeThread)
+		: Endpoint(InEndpoint)
+		  , ResumeThread(InResumeThread)
+		  , State(EState::Idle)
+	{
+	}
+
+	/**
+	 * Prepares the wait, before the awaiter is handed to the endpoint.
+	 *
+	 * @param InHandle The handle of the awaiting coroutine.
+	 */
+	void BeginWait(const std::coroutine_handle<> InHandle)
+	{
+		Handle = InHandle;
+		State = EState::Suspending;
+	}
+
+	/**
+	 * Cancels the wait if the endpoint did not take the awaiter.
+	 *
+	 * @return false, so that the coroutine does not suspend.
+	 */
+	bool CancelWait()
+	{
+		State = EState::Idle;
+		Reply = FSGMessageReply(ESGMessageRequestResult::Cancelled);
+
+		return false;
+	}
+
+	/**
+	 * Finishes suspending, after the endpoint took the awaiter.
+	 *
+	 * @return true if the coroutine suspends, false if it continues right away.
+	 */
+	bool EndSuspend()
+	{
+		EState Expected = EState::Suspending;
+
+		if (State.CompareExchange(Expected, EState::Suspended))
+		{
+			return true;
+		}
+
+		// the completion arrived while suspending, and left resuming to us
+		return ResumeOrContinue(ResumeThread, Handle);
+	}
+
+	/**
+	 * Withdraws the awaiter from its endpoint, if it is still suspended.
+	 *
+	 * @param RemoveWaiter Removes the awaiter from the endpoint, and returns whether it was still waiting.
+	 */
+	template <typename RemoveWaiterType>
+	void Withdraw(RemoveWaiterType&& RemoveWaiter)
+	{
+		EState Expected = EState::Suspended;
+
+		if (!State.CompareExchange(Expected, EState::Withdrawn))
+		{
+			return;
+		}
+
+		const auto PinnedEndpoint = Endpoint.Pin();
+
+		if (PinnedEndpoint.IsValid() && RemoveWaiter(*PinnedEndpoint))
+		{
+			return;
+		}
+
+		// a completion took the awaiter already, and must be done with it before it goes away
+		while (State.Load() != EState::Released)
+		{
+			FPlatformProcess::Yield();
+		}
+	}
+
+protected:
+	//~ FSGMessageWaiter interface
+
+	virtual void Complete(FSGMessageReply&& InReply) override
+	{
+		// the awaiter may be gone as soon as the coroutine resumed
+		const ENamedThreads::Type LocalResumeThread = ResumeThread;
+		const std::coroutine_handle<> LocalHandle = Handle;
+
+		Reply = MoveTemp(InReply);
+
+		EState Expected = EState::Suspending;
+
+		if (State.CompareExchange(Expected, EState::Completed))
+		{
+			return;
+		}
+
+		if ((Expected == EState::Suspended) && State.CompareExchange(Expected, EState::Completed))
+		{
+			if (!ResumeOrContinue(LocalResumeThread, LocalHandle))
+			{
+				LocalHandle.resume();
+			}
+
+			return;
+		}
+
+		// the awaiter was withdrawn, and may be gone as soon as it is released
+		State = EState::Released;
+	}
+
+private:
+	/**
+	 * Resumes a coroutine in a task on the given thread, unless it may continue on the current thread.
+	 *
+	 * @param InResumeThread The thread to resume the coroutine on.
+	 * @param InHandle The handle of the coroutine.
+	 * @return true if a task resumes the coroutine, false if the caller continues it.
+	 */
+	static bool ResumeOrContinue(const ENamedThreads::Type InResumeThread, const std::coroutine_handle<> InHandle)
+	{
+		const ENamedThreads::Type CurrentThread = FTaskGraphInterface::Get().GetCurrentThreadIfKnown();
+
+		if ((InResumeThread == ENamedThreads::AnyThread) ||
+			(ENamedThreads::GetThreadIndex(InResumeThread) == ENamedThreads::GetThreadIndex(CurrentThread)))
+		{
+			return false;
+		}
+
+		FFunctionGraphTask::CreateAndDispatchWhenReady([InHandle]()
+		{
+			InHandle.resume();
+		}, TStatId(), nullptr, InResumeThread);
+
+		return true;
+	}
+
+protected:
+	/** Holds the endpoint to wait on. */
+	TWeakPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Endpoint;
+
+	/** Holds the thread to resume the coroutine on. */
+	ENamedThreads::Type ResumeThread;
+
+	/** Holds the handle of the awaiting coroutine. */
+	std::coroutine_handle<> Handle;
+
+	/** Holds the outcome of the wait. */
+	FSGMessageReply Reply;
+
+private:
+	/** Holds the state of the hand-over between the awaiting coroutine and the completion. */
+	TAtomic<EState> State;
+};
+
+
+/**
+ * Awaits the next message of a message tag that an endpoint receives.
+ *
+ * @see FSGMessageAwait::NextMessage
+ */
+class FSGNextMessageAwaiter final
+	: public FSGMessageAwaiter
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InEndpoint The endpoint to receive the message on.
+	 * @param InResumeThread The thread to resume the coroutine on.
+	 * @param InMessageTag The message tag to wait for.
+	 * @param InScope The lowest message scope to subscribe to.
+	 */
+	FSGNextMessageAwaiter(const TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe>& InEndpoint,
+	                      const ENamedThreads::Type InResumeThread, const FName& InMessageTag,
+	                      const ESGMessageScope InScope)
+		: FSGMessageAwaiter(InEndpoint, InResumeThread)
+		  , Scope(InScope)
+	{
+		MessageTag = InMessageTag;
+	}
+
+	/** Destructor. */
+	virtual ~FSGNextMessageAwaiter() override
+	{
+		Withdraw([this](FSGMessageEndpoint& PinnedEndpoint)
+		{
+			return PinnedEndpoint.RemoveMessageWaiter(*this);
+		});
+	}
+
+public:
+	bool await_suspend(const std::coroutine_handle<> InHandle)
+	{
+		const auto PinnedEndpoint = Endpoint.Pin();
+		const FSGMessageScopeRange ScopeRange = FSGMessageScopeRange::AtLeast(Scope);
+
+		BeginWait(InHandle);
+
+		if (!PinnedEndpoint.IsValid() || !PinnedEndpoint->WaitForMessage(*this, ScopeRange))
+		{
+			return CancelWait();
+		}
+
+		return EndSuspend();
+	}
+
+private:
+	/** Holds the lowest message scope to subscribe to. */
+	ESGMessageScope Scope;
+};
+
+
+/**
+ * Awaits the reply to a request.
+ *
+ * The request is sent when the coroutine suspends, so that its reply cannot arrive before the awaiter waits.
+ *
+ * @see FSGMessageAwait::Request
+ */
+class FSGRequestAwaiter final
+	: public FSGMessageAwaiter
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InEndpoint The endpoint to send the request from.
+	 * @param InResumeThread The thread to resume the coroutine on.
+	 * @param InMessageTag The tag of the request message.
+	 * @param InMessage The request message, which the awaiter takes ownership of.
+	 * @param InRecipient The address of the recipient.
+	 * @param InTimeout The time to wait for the reply.
+	 * @param InParameter The send parameters.
+	 */
+	FSGRequestAwaiter(const TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe>& InEndpoint,
+	                  const ENamedThreads::Type InResumeThread, const FName& InMessageTag, FSGMessage* InMessage,
+	                  const FSGMessageAddress& InRecipient, const FTimespan& InTimeout,
+	                  const FSGMessageParameter::FSendParameter& InParameter)
+		: FSGMessageAwaiter(InEndpoint, InResumeThread)
+		  , RequestTag(InMessageTag)
+		  , Message(InMessage)
+		  , Recipient(InRecipient)
+		  , Timeout(InTimeout)
+		  , Parameter(InParameter)
+	{
+	}
+
+	/** Destructor. */
+	virtual ~FSGRequestAwaiter() override
+	{
+		// the request was never awaited
+		if (Message != nullptr)
+		{
+			Message->~FSGMessage();
+			FMemory::Free(Message);
+		}
+
+		Withdraw([this](FSGMessageEndpoint& PinnedEndpoint)
+		{
+			return PinnedEndpoint.RemoveRequestWaiter(RequestId);
+		});
+	}
+
+public:
+	bool await_suspend(const std::coroutine_handle<> InHandle)
+	{
+		const auto PinnedEndpoint = Endpoint.Pin();
+
+		if (!PinnedEndpoint.IsValid())
+		{
+			return CancelWait();
+		}
+
+		// the endpoint still reads the request after it took the awaiter
+		const FName LocalTag = RequestTag;
+		const FSGMessageAddress LocalRecipient = Recipient;
+		const FTimespan LocalTimeout = Timeout;
+		const FSGMessageParameter::FSendParameter LocalParameter = Parameter;
+
+		FSGMessage* RequestMessage = Message;
+		Message = nullptr;
+
+		BeginWait(InHandle);
+
+		if (PinnedEndpoint->Request(*this, LocalTag, RequestMessage, LocalRecipient, LocalTimeout, LocalParameter) == 0)
+		{
+			return CancelWait();
+		}
+
+		return EndSuspend();
+	}
+
+private:
+	/** Holds the tag of the request message. */
+	FName RequestTag;
+
+	/** Holds the request message until it is sent. */
+	FSGMessage* Message;
+
+	/** Holds the address of the recipient. */
+	FSGMessageAddress Recipient;
+
+	/** Holds the time to wait for the reply. */
+	FTimespan Timeout;
+
+	/** Holds the send parameters. */
+	FSGMessageParameter::FSendParameter Parameter;
+};
+
+
+/**
+ * Awaits a delay, using the router's queue of delayed messages.
+ *
+ * @see FSGMessageAwait::Delay
+ */
+class FSGDelayAwaiter final
+	: public FSGMessageAwaiter
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InEndpoint The endpoint whose router schedules the delay.
+	 * @param InResumeThread The thread to resume the coroutine on.
+	 * @param InDelay The time delay.
+	 */
+	FSGDelayAwaiter(const TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe>& InEndpoint,
+	                const ENamedThreads::Type InResumeThread, const FTimespan& InDelay)
+		: FSGMessageAwaiter(InEndpoint, InResumeThread)
+		  , Delay(InDelay)
+	{
+	}
+
+	/** Destructor. */
+	virtual ~FSGDelayAwaiter() override
+	{
+		Withdraw([this](FSGMessageEndpoint& PinnedEndpoint)
+		{
+			return PinnedEndpoint.RemoveRequestWaiter(RequestId);
+		});
+	}
+
+public:
+	bool await_suspend(const std::coroutine_handle<> InHandle)
+	{
+		const auto PinnedEndpoint = Endpoint.Pin();
+
+		if (!PinnedEndpoint.IsValid())
+		{
+			return CancelWait();
+		}
+
+		// the endpoint still reads the delay after it took the awaiter
+		const FTimespan LocalDelay = Delay;
+
+		BeginWait(InHandle);
+
+		if (PinnedEndpoint->Delay(*this, LocalDelay) == 0)
+		{
+			return CancelWait();
+		}
+
+		return EndSuspend();
+	}
+
+private:
+	/** Holds the time delay. */
+	FTimespan Delay;
+};
+
+
+/**
+ * Creates awaitable bus operations for C++20 coroutines.
+ *
+ * Usage:
+ *
+ *		const FSGMessageReply Trigger = co_await FSGMessageAwait::NextMessage(Endpoint, ENamedThreads::GameThread,
+ *		                                                                      TopicId, TriggerId);
+ *		const FSGMessageReply Reply = co_await FSGMessageAwait::Request(Endpoint, ENamedThreads::GameThread, TopicId,
+ *		                                                                RequestId, Recipient, Timeout,
+ *		                                                                DEFAULT_SEND_PARAMETER, "Val", Value);
+ *		co_await FSGMessageAwait::Delay(Endpoint, ENamedThreads::GameThread, FTimespan::FromSeconds(1.0));
+ *
+ * The endpoint must be registered with its bus to receive replies and delays.
+ */
+class FSGMessageAwait
+{
+public:
+	/**
+	 * Awaits the next message of a message tag that the endpoint receives.
+	 *
+	 * Unless it is subscribed already, the endpoint subscribes to the message tag for as long as the wait lasts, so
+	 * that messages published before or after the wait are not received. The reply holds the context of the message.
+	 */
+	static FSGNextMessageAwaiter NextMessage(const TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe>& Endpoint,
+	                                         const ENamedThreads::Type ResumeThread, MESSAGE_TAG_PARAM_SIGNATURE,
+	                                         const ESGMessageScope Scope = ESGMessageScope::Process)
+	{
+		return FSGNextMessageAwaiter(Endpoint, ResumeThread, FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE),
+		                             Scope);
+	}
+
+	/**
+	 * Sends a request when awaited and awaits its reply.
+	 *
+	 * @see FSGMessageEndpoint::Request
+	 */
+	template <typename ...Args>
+	static FSGRequestAwaiter Request(const TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe>& Endpoint,
+	                                 const ENamedThreads::Type ResumeThread, MESSAGE_TAG_PARAM_SIGNATURE,
+	                                 const FSGMessageAddress& Recipient, const FTimespan& Timeout,
+	                                 CONST_SEND_PARAMETER_SIGNATURE, Args&&... Params)
+	{
+		return FSGRequestAwaiter(Endpoint, ResumeThread, FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE),
+		                         FSGMessageBuilder::Builder<FSGMessage>(Params...), Recipient, Timeout,
+		                         MESSAGE_PARAMETER);
+	}
+
+	/**
+	 * Awaits a delay, which completes as timed out once it elapsed.
+	 */
+	static FSGDelayAwaiter Delay(const TSharedRef<FSGMessageEndpoint, ESPMode::ThreadSafe>& Endpoint,
+	                             const ENamedThreads::Type ResumeThread, const FTimespan& Delay)
+	{
+		return FSGDelayAwaiter(Endpoint, ResumeThread, Delay);
+	}
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include "Containers/Array.h"
 #include "Containers/ArrayBuilder.h"
 #include "Containers/Queue.h"
+#include "Core/Bus/SGMessagingStats.h"
 #include "Core/Interface/ISGMessageBus.h"
 #include "Core/Interface/ISGMessageContext.h"
 #include "Core/Interface/ISGMessageHandler.h"
@@ -13,10 +14,13 @@
 #include "Core/Interface/ISGMessageSender.h"
 #include "Core/Interface/ISGMessageBusListener.h"
 #include "SGMessageHandlers.h"
+#include "SGMessageRequest.h"
 #include "Core/Message/SGMessage.h"
+#include "Core/Message/SGMessageBatch.h"
 #include "Core/Message/SGMessageBuilder.h"
 #include "Core/Message/SGMessageParameter.h"
 #include "Core/Message/SGMessageTagBuilder.h"
+#include "Core/Settings/SGMessagingSettings.h"
 #include "Misc/Guid.h"
 #include "Templates/SharedPointer.h"
 #include "UObject/NameTypes.h"
@@ -85,11 +89,16 @@ public:
 		  , BusPtr(InBus)
 		  , Enabled(true)
 		  , NotificationDelegate(InNotificationDelegate)
-		  , Id(FGuid::NewGuid())
+		  , Id(Address.ToGuid())
 		  , InboxEnabled(false)
+		  , NumInboxMessages(0)
 		  , Name(InName)
+		  , Waiters(nullptr)
+		  , NumWaiters(0)
 	{
 		SetRecipientThread(FTaskGraphInterface::Get().GetCurrentThreadIfKnown());
+
+		FSGMessagingStats::AddInbox(*this);
 	}
 
 	/** Destructor. */
@@ -99,6 +108,12 @@ public:
 		{
 			Bus->Unregister(Address);
 		}
+
+		FSGMessageAddress::Release(Address);
+
+		CompleteWaiters(nullptr);
+
+		FSGMessagingStats::RemoveInbox(*this);
 	}
 
 public:
@@ -215,6 +230,60 @@ public:
 		}
 	}
 
+	/**
+	 * Conflates the messages of the specified type on the bus, so that newer messages replace pending ones.
+	 *
+	 * @param Conflation The conflation mode.
+	 * @see ISGMessageBus::Conflate, Unconflate
+	 */
+	void Conflate(MESSAGE_TAG_PARAM_SIGNATURE, const FSGMessageConflation& Conflation)
+	{
+		if (const TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> Bus = GetBusIfEnabled())
+		{
+			Bus->Conflate(FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE), Conflation);
+		}
+	}
+
+	/**
+	 * Stops conflating the messages of the specified type on the bus.
+	 *
+	 * @see Conflate
+	 */
+	void Unconflate(MESSAGE_TAG_PARAM_SIGNATURE)
+	{
+		if (const TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> Bus = GetBusIfEnabled())
+		{
+			Bus->Unconflate(FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE));
+		}
+	}
+
+	/**
+	 * Retains the latest messages of the specified type on the bus, so that late subscribers receive them.
+	 *
+	 * @param HistorySize The number of messages to retain.
+	 * @see ISGMessageBus::Retain, Unretain
+	 */
+	void Retain(MESSAGE_TAG_PARAM_SIGNATURE, const int32 HistorySize = 1)
+	{
+		if (const TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> Bus = GetBusIfEnabled())
+		{
+			Bus->Retain(FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE), HistorySize);
+		}
+	}
+
+	/**
+	 * Stops retaining the messages of the specified type on the bus, and drops the retained ones.
+	 *
+	 * @see Retain
+	 */
+	void Unretain(MESSAGE_TAG_PARAM_SIGNATURE)
+	{
+		if (const TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> Bus = GetBusIfEnabled())
+		{
+			Bus->Unretain(FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE));
+		}
+	}
+
 	/**
 	 * Subscribes a message handler.
 	 *
@@ -252,6 +321,8 @@ public:
 		{
 			const auto MessageTag = FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE);
 
+			FScopeLock Lock(&HandlersCS);
+
 			if (auto Handlers = HandlerMap.Find(MessageTag))
 			{
 				for (const auto Handler : *Handlers)
@@ -264,7 +335,11 @@ public:
 						{
 							HandlerMap.Remove(MessageTag);
 
-							Unsubscribe(MessageTag);
+							// waiters for messages still need the subscription
+							if (!WaiterSubscriptions.Contains(MessageTag))
+							{
+								Unsubscribe(MessageTag);
+							}
 						}
 
 						break;
@@ -350,10 +425,13 @@ public:
 	 */
 	void ProcessInbox()
 	{
+		SCOPE_CYCLE_COUNTER(STAT_SGMessaging_ProcessInbox);
+
 		TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Context;
 
 		while (Inbox.Dequeue(Context))
 		{
+			--NumInboxMessages;
 			ProcessMessage(Context.ToSharedRef());
 		}
 	}
@@ -371,7 +449,14 @@ public:
 	 */
 	bool ReceiveFromInbox(TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe>& OutContext)
 	{
-		return Inbox.Dequeue(OutContext);
+		if (!Inbox.Dequeue(OutContext))
+		{
+			return false;
+		}
+
+		--NumInboxMessages;
+
+		return true;
 	}
 
 public:
@@ -392,6 +477,11 @@ public:
 		return RecipientThread;
 	}
 
+	virtual int32 GetNumInboxMessages() const override
+	{
+		return NumInboxMessages.Load(EMemoryOrder::Relaxed);
+	}
+
 	virtual bool IsLocal() const override
 	{
 		return true;
@@ -399,13 +489,24 @@ public:
 
 	virtual void ReceiveMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context) override
 	{
+		if (CompleteRequest(Context))
+		{
+			return;
+		}
+
 		if (!Enabled)
 		{
 			return;
 		}
 
+		if (NumWaiters.Load(EMemoryOrder::Relaxed) > 0)
+		{
+			CompleteWaiters(Context);
+		}
+
 		if (InboxEnabled)
 		{
+			++NumInboxMessages;
 			Inbox.Enqueue(Context);
 		}
 		else
@@ -500,6 +601,8 @@ public:
 	{
 		if (const auto Bus = GetBusIfEnabled())
 		{
+			SnapshotMessage(Message, Bus->IsRetained(MessageTag));
+
 			Bus->Publish(MessageTag, Message, PUBLISH_PARAMETER_FORWARD, AsShared());
 		}
 	}
@@ -526,6 +629,8 @@ public:
 
 		if (Bus.IsValid())
 		{
+			SnapshotMessage(Message);
+
 			Bus->Send(MessageTag, Message, Recipients, SEND_PARAMETER_FORWARD, AsShared());
 		}
 	}
@@ -560,6 +665,300 @@ public:
 		Send(MESSAGE_TAG_PARAM_VALUE, TArrayBuilder<FSGMessageAddress>().Add(Recipient), MESSAGE_PARAMETER, Params...);
 	}
 
+	/**
+	 * Publishes a batch of messages, which the bus routes as a single command.
+	 *
+	 * @param Batch The messages to publish, which is left empty unless the endpoint is disabled.
+	 * @see SendBatch
+	 */
+	void PublishBatch(FSGMessageBatch& Batch, CONST_PUBLISH_PARAMETER_SIGNATURE)
+	{
+		if (Batch.IsEmpty())
+		{
+			return;
+		}
+
+		if (const auto Bus = GetBusIfEnabled())
+		{
+			for (const FSGMessageBatchEntry& Entry : Batch.GetEntries())
+			{
+				SnapshotMessage(static_cast<FSGMessage*>(Entry.Message), Bus->IsRetained(Entry.MessageTag));
+			}
+
+			Bus->PublishBatch(Batch.Release(), PUBLISH_PARAMETER_FORWARD, AsShared());
+		}
+	}
+
+	/**
+	 * Sends a batch of messages to the specified recipients, which the bus routes as a single command.
+	 *
+	 * Attachments are not supported in batches.
+	 *
+	 * @param Batch The messages to send, which is left empty unless the endpoint is disabled.
+	 * @param Recipients The addresses of the recipients.
+	 * @see PublishBatch
+	 */
+	void SendBatch(FSGMessageBatch& Batch, const TArray<FSGMessageAddress>& Recipients, CONST_SEND_PARAMETER_SIGNATURE)
+	{
+		if (Batch.IsEmpty())
+		{
+			return;
+		}
+
+		if (const auto Bus = GetBusIfEnabled())
+		{
+			for (const FSGMessageBatchEntry& Entry : Batch.GetEntries())
+			{
+				SnapshotMessage(static_cast<FSGMessage*>(Entry.Message));
+			}
+
+			Bus->SendBatch(Batch.Release(), Recipients, MESSAGE_PARAMETER.Flags, MESSAGE_PARAMETER.Annotations,
+			               MESSAGE_PARAMETER.Delay, MESSAGE_PARAMETER.Expiration, AsShared());
+		}
+	}
+
+	void SendBatch(FSGMessageBatch& Batch, const FSGMessageAddress& Recipient, CONST_SEND_PARAMETER_SIGNATURE)
+	{
+		SendBatch(Batch, TArrayBuilder<FSGMessageAddress>().Add(Recipient), MESSAGE_PARAMETER);
+	}
+
+	/**
+	 * Sends a request to the specified recipient and returns the future of its reply.
+	 *
+	 * The recipient answers with Reply(), which routes the reply straight back to this endpoint, so no
+	 * subscription to the reply is needed. The future completes on the thread that this endpoint receives
+	 * messages on, so it must not be waited for on that thread. A request times out if no reply arrived
+	 * within the timeout after it was sent, and the request message itself expires by then.
+	 *
+	 * @param Recipient The address of the recipient.
+	 * @param Timeout The time to wait for the reply (FTimespan::MaxValue() = forever).
+	 * @param Params The parameters of the request message.
+	 * @return The pending request, which is already cancelled if the endpoint is disabled.
+	 * @see CancelRequest, Reply
+	 */
+	template <typename ...Args>
+	FSGMessageRequest Request(MESSAGE_TAG_PARAM_SIGNATURE, const FSGMessageAddress& Recipient, const FTimespan& Timeout,
+	                          CONST_SEND_PARAMETER_SIGNATURE, Args&&... Params)
+	{
+		const auto Bus = GetBusIfEnabled();
+
+		if (!Bus.IsValid())
+		{
+			return FSGMessageRequest::Cancelled();
+		}
+
+		FSGMessageRequest Request;
+		Request.Id = PendingRequests.Add(Request.Future);
+
+		SendRequest(*Bus, Request.Id, FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE),
+		            FSGMessageBuilder::Builder<FSGMessage>(Params...), Recipient, Timeout, MESSAGE_PARAMETER);
+
+		return Request;
+	}
+
+	/**
+	 * Sends a request whose reply completes the given waiter.
+	 *
+	 * @param Waiter The waiter to complete, which must stay alive until completed or removed.
+	 * @param MessageTag The tag of the request message.
+	 * @param Message The request message, which the bus takes ownership of.
+	 * @param Recipient The address of the recipient.
+	 * @param Timeout The time to wait for the reply (FTimespan::MaxValue() = forever).
+	 * @return The identifier of the request, or 0 if the endpoint is disabled.
+	 * @see RemoveRequestWaiter
+	 */
+	uint64 Request(FSGMessageWaiter& Waiter, const FName& MessageTag, FSGMessage* Message,
+	               const FSGMessageAddress& Recipient, const FTimespan& Timeout, CONST_SEND_PARAMETER_SIGNATURE)
+	{
+		const auto Bus = GetBusIfEnabled();
+
+		if (!Bus.IsValid())
+		{
+			DestroyMessage(Message);
+
+			return 0;
+		}
+
+		const uint64 RequestId = PendingRequests.Add(Waiter);
+
+		SendRequest(*Bus, RequestId, MessageTag, Message, Recipient, Timeout, MESSAGE_PARAMETER);
+
+		return RequestId;
+	}
+
+	/**
+	 * Completes the given waiter after a delay, using the router's queue of delayed messages.
+	 *
+	 * The waiter completes as timed out once the delay elapsed.
+	 *
+	 * @param Waiter The waiter to complete, which must stay alive until completed or removed.
+	 * @param InDelay The time delay.
+	 * @return The identifier of the wait, or 0 if the endpoint is disabled.
+	 * @see RemoveRequestWaiter
+	 */
+	uint64 Delay(FSGMessageWaiter& Waiter, const FTimespan& InDelay)
+	{
+		const auto Bus = GetBusIfEnabled();
+
+		if (!Bus.IsValid())
+		{
+			return 0;
+		}
+
+		const uint64 RequestId = PendingRequests.Add(Waiter);
+
+		SendTimeout(*Bus, RequestId, InDelay);
+
+		return RequestId;
+	}
+
+	/**
+	 * Removes the waiter of a request or delay without completing it.
+	 *
+	 * @param RequestId The identifier of the request or delay.
+	 * @return true if the waiter was still waiting, false otherwise.
+	 */
+	bool RemoveRequestWaiter(const uint64 RequestId)
+	{
+		return PendingRequests.RemoveWaiter(RequestId);
+	}
+
+	/**
+	 * Completes the given waiter with the next message of its message tag that this endpoint receives.
+	 *
+	 * The endpoint subscribes to the message tag if it did not already, and unsubscribes again once the last
+	 * waiter that needed the subscription completed or was removed. Message handlers and the inbox still receive
+	 * the message.
+	 *
+	 * @param Waiter The waiter to complete, which must stay alive until completed or removed.
+	 * @param ScopeRange The range of message scopes to include in a new subscription.
+	 * @return true if the waiter waits, false if the endpoint is disabled.
+	 * @see RemoveMessageWaiter
+	 */
+	bool WaitForMessage(FSGMessageWaiter& Waiter, const FSGMessageScopeRange& ScopeRange)
+	{
+		const auto Bus = GetBusIfEnabled();
+
+		if (!Bus.IsValid())
+		{
+			return false;
+		}
+
+		{
+			FScopeLock Lock(&HandlersCS);
+
+			if (int32* NumSubscribedWaiters = WaiterSubscriptions.Find(Waiter.MessageTag))
+			{
+				++*NumSubscribedWaiters;
+				Waiter.bSubscribed = true;
+			}
+			else if (!IsSubscribed(Waiter.MessageTag))
+			{
+				WaiterSubscriptions.Add(Waiter.MessageTag, 1);
+				Waiter.bSubscribed = true;
+
+				Bus->Subscribe(AsShared(), Waiter.MessageTag, ScopeRange);
+			}
+		}
+
+		FScopeLock Lock(&WaitersCS);
+
+		Waiter.NextWaiter = Waiters;
+		Waiters = &Waiter;
+		++NumWaiters;
+
+		return true;
+	}
+
+	/**
+	 * Removes a waiter for a message without completing it.
+	 *
+	 * @param Waiter The waiter to remove.
+	 * @return true if the waiter was still waiting, false otherwise.
+	 */
+	bool RemoveMessageWaiter(FSGMessageWaiter& Waiter)
+	{
+		{
+			FScopeLock Lock(&WaitersCS);
+
+			FSGMessageWaiter** Link = &Waiters;
+
+			while ((*Link != nullptr) && (*Link != &Waiter))
+			{
+				Link = &(*Link)->NextWaiter;
+			}
+
+			if (*Link == nullptr)
+			{
+				return false;
+			}
+
+			*Link = Waiter.NextWaiter;
+			Waiter.NextWaiter = nullptr;
+			--NumWaiters;
+		}
+
+		if (Waiter.bSubscribed)
+		{
+			ReleaseWaiterSubscription(Waiter.MessageTag);
+		}
+
+		return true;
+	}
+
+	/**
+	 * Replies to a request.
+	 *
+	 * The reply is sent to the sender of the request. If the request came from Request(), the reply carries
+	 * its identifier and completes its future; otherwise it is delivered like any other sent message.
+	 *
+	 * @param RequestContext The context of the request.
+	 * @param Params The parameters of the reply message.
+	 * @see Request
+	 */
+	template <typename ...Args>
+	void Reply(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& RequestContext, MESSAGE_TAG_PARAM_SIGNATURE,
+	           CONST_SEND_PARAMETER_SIGNATURE, Args&&... Params)
+	{
+		const FString* RequestId = RequestContext->GetAnnotations().Find(FSGMessageRequestTable::RequestIdKey);
+
+		if (RequestId == nullptr)
+		{
+			Send(MESSAGE_TAG_PARAM_VALUE, RequestContext->GetSender(), MESSAGE_PARAMETER, Params...);
+
+			return;
+		}
+
+		FSGMessageParameter::FSendParameter Parameter = MESSAGE_PARAMETER;
+		Parameter.Annotations.Add(FSGMessageRequestTable::ReplyIdKey, *RequestId);
+
+		Send(MESSAGE_TAG_PARAM_VALUE, RequestContext->GetSender(), Parameter, Params...);
+	}
+
+	/**
+	 * Cancels a pending request.
+	 *
+	 * The future of the request completes as cancelled, and a late reply is dropped.
+	 *
+	 * @param RequestId The identifier of the request.
+	 * @return true if the request was pending, false otherwise.
+	 * @see Request
+	 */
+	bool CancelRequest(const uint64 RequestId)
+	{
+		return PendingRequests.Complete(RequestId, ESGMessageRequestResult::Cancelled);
+	}
+
+	/**
+	 * Gets the number of requests that wait for a reply.
+	 *
+	 * @return Number of requests.
+	 */
+	int32 GetNumPendingRequests() const
+	{
+		return PendingRequests.Num();
+	}
+
 	template <typename HandlerType>
 	void Subscribe(MESSAGE_TAG_PARAM_SIGNATURE, HandlerType* Handler,
 	               typename TSGRawMessageHandler<FSGMessage, HandlerType>::FuncType HandlerFunc,
@@ -567,9 +966,20 @@ public:
 	{
 		const auto MessageTag = FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE);
 
-		Subscribe(MessageTag, FSGMessageScopeRange::AtLeast(InScope));
+		FScopeLock Lock(&HandlersCS);
+
+		const bool bSubscribed = IsSubscribed(MessageTag);
 
+		// the handler must be in place before the bus dispatches the retained messages
 		WithRawMessageHandler(MessageTag, Handler, HandlerFunc);
+
+		if (!bSubscribed)
+		{
+			if (const TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> Bus = GetBusIfEnabled())
+			{
+				Bus->Subscribe(AsShared(), MessageTag, FSGMessageScopeRange::AtLeast(InScope));
+			}
+		}
 	}
 
 	template <typename MessageType, typename ContextType>
@@ -578,9 +988,20 @@ public:
 	{
 		const auto MessageTag = FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE);
 
-		Subscribe(MessageTag, FSGMessageScopeRange::AtLeast(InScope));
+		FScopeLock Lock(&HandlersCS);
+
+		const bool bSubscribed = IsSubscribed(MessageTag);
 
+		// the handler must be in place before the bus dispatches the retained messages
 		WithDelegateMessageHandler<MessageType, ContextType>(MessageTag, Object, FunctionName);
+
+		if (!bSubscribed)
+		{
+			if (const TSharedPtr<ISGMessageBus, ESPMode::ThreadSafe> Bus = GetBusIfEnabled())
+			{
+				Bus->Subscribe(AsShared(), MessageTag, FSGMessageScopeRange::AtLeast(InScope));
+			}
+		}
 	}
 
 	/**
@@ -692,6 +1113,49 @@ protected:
 		Handlers.Add(InHandler);
 	}
 
+	/**
+	 * Checks whether this endpoint is subscribed to the given message tag (the handlers lock must be held).
+	 *
+	 * @param MessageTag The message tag to check.
+	 * @return true if a message handler or a waiter for a message holds a subscription, false otherwise.
+	 */
+	bool IsSubscribed(const FName& MessageTag) const
+	{
+		const auto Handlers = HandlerMap.Find(MessageTag);
+
+		return ((Handlers != nullptr) && !Handlers->IsEmpty()) || WaiterSubscriptions.Contains(MessageTag);
+	}
+
+	/**
+	 * Releases the subscription of a waiter for a message, and unsubscribes once no waiter or handler needs it.
+	 *
+	 * @param MessageTag The message tag of the waiter.
+	 */
+	void ReleaseWaiterSubscription(const FName& MessageTag)
+	{
+		FScopeLock Lock(&HandlersCS);
+
+		int32* NumSubscribedWaiters = WaiterSubscriptions.Find(MessageTag);
+
+		if ((NumSubscribedWaiters == nullptr) || (--*NumSubscribedWaiters > 0))
+		{
+			return;
+		}
+
+		WaiterSubscriptions.Remove(MessageTag);
+
+		const auto Handlers = HandlerMap.Find(MessageTag);
+
+		// destroyed endpoints were unregistered already
+		if (((Handlers == nullptr) || Handlers->IsEmpty()) && DoesSharedInstanceExist())
+		{
+			if (const auto Bus = BusPtr.Pin())
+			{
+				Bus->Unsubscribe(AsShared(), MessageTag);
+			}
+		}
+	}
+
 	/**
 	 * Clears all handlers in a way that guarantees it won't overlap with message processing. This preserves internal integrity
 	 * of the array and cases where our owner may be shutting down while receiving messages.
@@ -717,6 +1181,182 @@ protected:
 		return nullptr;
 	}
 
+	/**
+	 * Copies the script data referenced by an outgoing message, if enabled in the messaging settings.
+	 *
+	 * @param Message The message about to be handed to the bus.
+	 * @param bForce Whether to copy regardless of the settings, such as for messages that the bus retains.
+	 * @see FSGMessage::Snapshot
+	 */
+	static void SnapshotMessage(FSGMessage* Message, const bool bForce = false)
+	{
+		if (Message != nullptr && (bForce || GetDefault<USGMessagingSettings>()->bSnapshotScriptContainers))
+		{
+			Message->Snapshot();
+		}
+	}
+
+	/**
+	 * Sends a request message and schedules its timeout.
+	 *
+	 * @param Bus The bus to send on.
+	 * @param RequestId The identifier of the pending request.
+	 * @param MessageTag The tag of the request message.
+	 * @param Message The request message, which the bus takes ownership of.
+	 * @param Recipient The address of the recipient.
+	 * @param Timeout The time to wait for the reply.
+	 */
+	void SendRequest(ISGMessageBus& Bus, const uint64 RequestId, const FName& MessageTag, FSGMessage* Message,
+	                 const FSGMessageAddress& Recipient, const FTimespan& Timeout, CONST_SEND_PARAMETER_SIGNATURE)
+	{
+		const bool bTimeout = Timeout < FTimespan::MaxValue();
+
+		FSGMessageParameter::FSendParameter Parameter = MESSAGE_PARAMETER;
+		Parameter.Annotations.Add(FSGMessageRequestTable::RequestIdKey, FSGMessageRequestTable::ToAnnotation(RequestId));
+
+		if (bTimeout)
+		{
+			Parameter.Expiration = FMath::Min(Parameter.Expiration,
+			                                  FDateTime::UtcNow() + Parameter.Delay + Timeout);
+		}
+
+		SnapshotMessage(Message);
+
+		Bus.Send(MessageTag, Message, TArrayBuilder<FSGMessageAddress>().Add(Recipient), Parameter.Flags,
+		         Parameter.Annotations, Parameter.Attachment, Parameter.Delay, Parameter.Expiration, AsShared());
+
+		if (bTimeout)
+		{
+			SendTimeout(Bus, RequestId, Parameter.Delay + Timeout);
+		}
+	}
+
+	/**
+	 * Schedules the timeout of a pending request.
+	 *
+	 * The router's queue of delayed messages doubles as the timer of the request: a message is sent to this
+	 * endpoint after the delay, and times the request out unless it completed by then.
+	 *
+	 * @param Bus The bus to send on.
+	 * @param RequestId The identifier of the pending request.
+	 * @param Delay The time after which the request times out.
+	 */
+	void SendTimeout(ISGMessageBus& Bus, const uint64 RequestId, const FTimespan& Delay)
+	{
+		Bus.Send(FSGMessageRequestTable::TimeoutTag, FSGMessageBuilder::Builder<FSGMessage>(),
+		         TArrayBuilder<FSGMessageAddress>().Add(Address), ESGMessageFlags::None,
+		         TMapBuilder<FName, FString>().Add(FSGMessageRequestTable::RequestIdKey,
+		                                           FSGMessageRequestTable::ToAnnotation(RequestId)), nullptr, Delay,
+		         FDateTime::MaxValue(), AsShared());
+	}
+
+	/**
+	 * Destroys a message that was never handed to the bus.
+	 *
+	 * @param Message The message to destroy.
+	 */
+	static void DestroyMessage(FSGMessage* Message)
+	{
+		if (Message != nullptr)
+		{
+			Message->~FSGMessage();
+			FMemory::Free(Message);
+		}
+	}
+
+	/**
+	 * Completes the waiters for the message tag of the given message.
+	 *
+	 * @param Context The context of the received message, or nullptr to cancel all waiters.
+	 */
+	void CompleteWaiters(const TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+	{
+		FSGMessageWaiter* Completed = nullptr;
+		TArray<FName, TInlineAllocator<4>> SubscribedTags;
+		{
+			FScopeLock Lock(&WaitersCS);
+
+			for (FSGMessageWaiter** Link = &Waiters; *Link != nullptr;)
+			{
+				FSGMessageWaiter* Waiter = *Link;
+
+				if (Context.IsValid() && (Waiter->MessageTag != Context->GetMessageTag()))
+				{
+					Link = &Waiter->NextWaiter;
+
+					continue;
+				}
+
+				*Link = Waiter->NextWaiter;
+				Waiter->NextWaiter = Completed;
+				Completed = Waiter;
+				--NumWaiters;
+
+				if (Waiter->bSubscribed)
+				{
+					SubscribedTags.Add(Waiter->MessageTag);
+				}
+			}
+		}
+
+		// unsubscribe before resuming, so that a waiter that waits again subscribes after this
+		for (const FName& MessageTag : SubscribedTags)
+		{
+			ReleaseWaiterSubscription(MessageTag);
+		}
+
+		// a completed waiter may be gone as soon as it resumed
+		while (Completed != nullptr)
+		{
+			FSGMessageWaiter* Waiter = Completed;
+			Completed = Waiter->NextWaiter;
+			Waiter->NextWaiter = nullptr;
+
+			Waiter->Complete(FSGMessageReply(
+				Context.IsValid() ? ESGMessageRequestResult::Replied : ESGMessageRequestResult::Cancelled, Context));
+		}
+	}
+
+	/**
+	 * Completes the pending request that the given message replies to or times out.
+	 *
+	 * Replies and timeouts are consumed even if their request already completed, so that they never
+	 * reach the message handlers or the inbox.
+	 *
+	 * @param Context The context of the received message.
+	 * @return true if the message was a reply or a timeout, false otherwise.
+	 */
+	bool CompleteRequest(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+	{
+		const TMap<FName, FString>& Annotations = Context->GetAnnotations();
+
+		if (Annotations.Num() == 0)
+		{
+			return false;
+		}
+
+		if (const FString* ReplyId = Annotations.Find(FSGMessageRequestTable::ReplyIdKey))
+		{
+			PendingRequests.Complete(FSGMessageRequestTable::FromAnnotation(*ReplyId),
+			                         ESGMessageRequestResult::Replied, Context);
+
+			return true;
+		}
+
+		if ((Context->GetMessageTag() == FSGMessageRequestTable::TimeoutTag) && (Context->GetSender() == Address))
+		{
+			if (const FString* RequestId = Annotations.Find(FSGMessageRequestTable::RequestIdKey))
+			{
+				PendingRequests.Complete(FSGMessageRequestTable::FromAnnotation(*RequestId),
+				                         ESGMessageRequestResult::TimedOut);
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
 	/**
 	 * Forwards the given message context to matching message handlers.
 	 *
@@ -753,6 +1393,9 @@ private:
 	/** Holds the registered message handlers. */
 	TMap<FName, TArray<TSharedPtr<ISGMessageHandler, ESPMode::ThreadSafe>>> HandlerMap;
 
+	/** Holds the number of waiters for messages that share a subscription, per message tag. */
+	TMap<FName, int32> WaiterSubscriptions;
+
 	/** Holds a delegate that is invoked on disconnection events. */
 	FOnBusNotification NotificationDelegate;
 
@@ -765,16 +1408,31 @@ private:
 	/** Holds a flag indicating whether the inbox is enabled. */
 	bool InboxEnabled;
 
+	/** Holds the number of messages in the inbox. */
+	TAtomic<int32> NumInboxMessages;
+
 	/** Holds the endpoint's name (for debugging purposes). */
 	const FName Name;
 
 	/** Holds the name of the thread on which to receive messages. */
 	ENamedThreads::Type RecipientThread;
 
+	/** Holds the requests that wait for a reply. */
+	FSGMessageRequestTable PendingRequests;
+
+	/** Holds the list of waiters for messages. */
+	FSGMessageWaiter* Waiters;
+
+	/** Holds the number of waiters for messages. */
+	TAtomic<int32> NumWaiters;
+
 private:
 	/** Holds a delegate that is invoked in case of messaging errors. */
 	FOnMessageEndpointError ErrorDelegate;
 
 	/** Signifies that the handler array is being accessed and other threads should wait or skip */
 	FCriticalSection HandlersCS;
+
+	/** Guards the list of waiters for messages. */
+	FCriticalSection WaitersCS;
 };
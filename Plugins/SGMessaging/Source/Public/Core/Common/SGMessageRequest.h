@@ -0,0 +1,305 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Templates/Atomic.h"
+#include "Core/Interface/ISGMessageContext.h"
+#include "Core/Message/SGMessage.h"
+
+/**
+ * Enumerates the ways in which a request can complete.
+ */
+enum class ESGMessageRequestResult : uint8
+{
+	/** The recipient replied. */
+	Replied,
+
+	/** No reply arrived in time. */
+	TimedOut,
+
+	/** The request was cancelled, or its endpoint went away. */
+	Cancelled
+};
+
+
+/**
+ * Holds the outcome of a request.
+ */
+struct FSGMessageReply
+{
+	/** Holds the way in which the request completed. */
+	ESGMessageRequestResult Result;
+
+	/** Holds the context of the reply (only valid if replied). */
+	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Context;
+
+	/** Default constructor. */
+	FSGMessageReply()
+		: Result(ESGMessageRequestResult::Cancelled)
+	{
+	}
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InResult The way in which the request completed.
+	 * @param InContext The context of the reply, if any.
+	 */
+	explicit FSGMessageReply(const ESGMessageRequestResult InResult,
+	                         const TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe>& InContext = nullptr)
+		: Result(InResult)
+		  , Context(InContext)
+	{
+	}
+
+	/**
+	 * Checks whether the recipient replied.
+	 *
+	 * @return true if replied, false if the request timed out or was cancelled.
+	 */
+	bool IsReplied() const
+	{
+		return (Result == ESGMessageRequestResult::Replied) && Context.IsValid() && Context->IsValid();
+	}
+
+	/**
+	 * Gets the reply message.
+	 *
+	 * @return The message, or nullptr if the request was not replied.
+	 */
+	const FSGMessage* GetMessage() const
+	{
+		return IsReplied() ? static_cast<const FSGMessage*>(Context->GetMessage()) : nullptr;
+	}
+};
+
+
+/**
+ * Holds a pending request.
+ *
+ * The identifier can be used to cancel the request, and the future completes with the reply.
+ *
+ * @see FSGMessageEndpoint::Request
+ */
+struct FSGMessageRequest
+{
+	/** Holds the identifier of the request (0 = not sent). */
+	uint64 Id = 0;
+
+	/** Holds the future of the reply. */
+	TFuture<FSGMessageReply> Future;
+
+	/**
+	 * Creates a request that was never sent, such as when the endpoint is disabled.
+	 *
+	 * @return The request, already cancelled.
+	 */
+	static FSGMessageRequest Cancelled()
+	{
+		FSGMessageRequest Request;
+		Request.Future = MakeFulfilledPromise<FSGMessageReply>(FSGMessageReply(ESGMessageRequestResult::Cancelled)).
+			GetFuture();
+
+		return Request;
+	}
+};
+
+
+/**
+ * Implements a waiter that an endpoint completes in place of a promise.
+ *
+ * Waiters are owned by the code that waits, usually as part of a coroutine frame (see SGMessageAwaitables.h),
+ * and are linked into their endpoint while they wait, so that waiting does not allocate. A waiter is completed
+ * exactly once, outside of any lock, and must not be touched by the endpoint afterwards.
+ *
+ * @see FSGMessageEndpoint::WaitForMessage, FSGMessageRequestTable::Add
+ */
+class FSGMessageWaiter
+{
+public:
+	/** Virtual destructor. */
+	virtual ~FSGMessageWaiter() = default;
+
+	/**
+	 * Completes the wait.
+	 *
+	 * Waiters for a message tag complete as replied with the received message.
+	 *
+	 * @param Reply The outcome of the wait.
+	 */
+	virtual void Complete(FSGMessageReply&& Reply) = 0;
+
+public:
+	/** Holds the message tag to wait for (waits for messages only). */
+	FName MessageTag;
+
+	/** Holds the next waiter of the endpoint (waits for messages only). */
+	FSGMessageWaiter* NextWaiter = nullptr;
+
+	/** Holds a flag indicating whether the waiter shares a subscription of its endpoint (waits for messages only). */
+	bool bSubscribed = false;
+
+	/** Holds the identifier of the request, which is assigned before it is sent (waits for requests only). */
+	uint64 RequestId = 0;
+};
+
+
+/**
+ * Implements the table of the pending requests of an endpoint.
+ *
+ * Requests occupy slots that are reused once they complete, so that the table grows to the largest number of
+ * requests in flight and stays there. A request identifier combines the slot index with a serial number that
+ * changes whenever the slot is reused, so that a late reply or timeout never completes a later request. The
+ * table is thread-safe, and futures are completed outside of its lock, so that their continuations may send
+ * new requests.
+ *
+ * Requests are correlated through message annotations: the request carries its identifier in RequestIdKey, and
+ * the reply echoes it in ReplyIdKey.
+ */
+class SGMESSAGING_API FSGMessageRequestTable
+{
+public:
+	/** The annotation of a request that holds its identifier. */
+	static const FName RequestIdKey;
+
+	/** The annotation of a reply that holds the identifier of its request. */
+	static const FName ReplyIdKey;
+
+	/** The message tag of the delayed messages that time out requests. */
+	static const FName TimeoutTag;
+
+public:
+	/** Default constructor. */
+	FSGMessageRequestTable();
+
+	/** Destructor. */
+	~FSGMessageRequestTable();
+
+public:
+	/**
+	 * Adds a pending request.
+	 *
+	 * @param OutFuture Will hold the future of the reply.
+	 * @return The identifier of the request.
+	 */
+	uint64 Add(TFuture<FSGMessageReply>& OutFuture);
+
+	/**
+	 * Adds a pending request that completes a waiter.
+	 *
+	 * @param Waiter The waiter to complete, which must stay alive until completed or removed.
+	 * @return The identifier of the request, which is also assigned to the waiter.
+	 * @see RemoveWaiter
+	 */
+	uint64 Add(FSGMessageWaiter& Waiter);
+
+	/**
+	 * Completes a pending request.
+	 *
+	 * @param RequestId The identifier of the request.
+	 * @param Result The way in which the request completed.
+	 * @param Context The context of the reply, if any.
+	 * @return true if the request was pending, false if it was unknown or already completed.
+	 */
+	bool Complete(uint64 RequestId, ESGMessageRequestResult Result,
+	              const TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe>& Context = nullptr);
+
+	/**
+	 * Completes all pending requests.
+	 *
+	 * @param Result The way in which the requests completed.
+	 */
+	void CompleteAll(ESGMessageRequestResult Result);
+
+	/**
+	 * Removes a pending request that completes a waiter, without completing it.
+	 *
+	 * @param RequestId The identifier of the request.
+	 * @return true if the request was pending, false otherwise.
+	 */
+	bool RemoveWaiter(uint64 RequestId);
+
+	/**
+	 * Gets the number of pending requests.
+	 *
+	 * @return Number of requests.
+	 */
+	int32 Num() const
+	{
+		return NumPending.Load(EMemoryOrder::Relaxed);
+	}
+
+public:
+	/**
+	 * Converts a request identifier to its annotation.
+	 *
+	 * @param RequestId The identifier to convert.
+	 * @return The annotation value.
+	 */
+	static FString ToAnnotation(uint64 RequestId)
+	{
+		return LexToString(RequestId);
+	}
+
+	/**
+	 * Parses a request identifier from its annotation.
+	 *
+	 * @param Annotation The annotation value.
+	 * @return The identifier, or 0 if the annotation is malformed.
+	 */
+	static uint64 FromAnnotation(const FString& Annotation);
+
+private:
+	/** A slot of the table. */
+	struct FSlot
+	{
+		/** Holds the promise of the pending request (unless it completes a waiter). */
+		TPromise<FSGMessageReply> Promise;
+
+		/** Holds the waiter of the pending request, if any. */
+		FSGMessageWaiter* Waiter = nullptr;
+
+		/** Holds the serial number of the current or last request in this slot. */
+		uint32 Serial = 0;
+
+		/** Holds a flag indicating whether the slot holds a pending request. */
+		bool bPending = false;
+	};
+
+	/**
+	 * Occupies a free slot (the lock must be held).
+	 *
+	 * @return The identifier of the request in the slot.
+	 */
+	uint64 AddSlot();
+
+	/**
+	 * Finds the slot of a pending request (the lock must be held).
+	 *
+	 * @param RequestId The identifier of the request.
+	 * @return The slot, or nullptr if the request is not pending.
+	 */
+	FSlot* FindSlot(uint64 RequestId);
+
+	/**
+	 * Frees the slot of a pending request (the lock must be held).
+	 *
+	 * @param RequestId The identifier of the request.
+	 */
+	void FreeSlot(uint64 RequestId);
+
+private:
+	/** Holds the slots. */
+	TArray<FSlot> Slots;
+
+	/** Holds the indices of the free slots. */
+	TArray<int32> FreeSlots;
+
+	/** Holds the number of pending requests. */
+	TAtomic<int32> NumPending;
+
+	/** Guards the slots. */
+	mutable FCriticalSection CriticalSection;
+};
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Memory/CompositeBuffer.h"
+#include "Memory/SharedBuffer.h"
+#include "Core/Interface/ISGMessageAttachment.h"
+
+/**
+ * Implements a message attachment whose data is held in reference-counted memory buffers.
+ *
+ * The attachment shares its buffers instead of copying them: recipients in the same process see the very
+ * same memory, bridges encode the data straight from the buffers, and the memory is released when the last
+ * message context that references the attachment goes away. Buffers that do not own their memory are copied
+ * once when the attachment is created, so that the data remains valid for as long as the attachment.
+ *
+ * Small attachments are encoded together with their message when they are sent to other processes, larger
+ * ones are streamed in chunks that reference the buffers.
+ */
+class SGMESSAGING_API FSGSharedBufferMessageAttachment final
+	: public ISGMessageAttachment
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InBuffer The buffer that holds the data.
+	 */
+	explicit FSGSharedBufferMessageAttachment(const FSharedBuffer& InBuffer)
+		: Buffer(InBuffer.MakeOwned())
+	{
+	}
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InBuffer The buffers that hold the data.
+	 */
+	explicit FSGSharedBufferMessageAttachment(const FCompositeBuffer& InBuffer)
+		: Buffer(InBuffer.MakeOwned())
+	{
+	}
+
+public:
+	/**
+	 * Gets the buffers that hold the data.
+	 *
+	 * @return The buffers.
+	 */
+	const FCompositeBuffer& GetBuffer() const
+	{
+		return Buffer;
+	}
+
+public:
+	//~ ISGMessageAttachment interface
+
+	virtual FArchive* CreateReader() override;
+	virtual TUniquePtr<ISGMessageAttachmentReader> CreateChunkReader() override;
+
+	virtual FCompositeBuffer GetMemoryBuffer() const override
+	{
+		return Buffer;
+	}
+
+private:
+	/** Holds the data. */
+	FCompositeBuffer Buffer;
+};
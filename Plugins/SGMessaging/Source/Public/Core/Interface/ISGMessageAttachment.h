@@ -2,9 +2,64 @@
 
 #pragma once
 
+#include "CoreTypes.h"
+#include "Memory/CompositeBuffer.h"
+#include "Memory/MemoryView.h"
+#include "Templates/UniquePtr.h"
+
 class FArchive;
 
 
+/**
+ * Interface for chunked readers of message attachment data.
+ *
+ * Chunk readers give random access to the data without loading all of it, which allows large attachments
+ * to be streamed with a bounded amount of memory.
+ *
+ * @see ISGMessageAttachment
+ */
+class ISGMessageAttachmentReader
+{
+public:
+	/**
+	 * Gets the size of the data.
+	 *
+	 * @return Size in bytes.
+	 */
+	virtual int64 GetSize() const = 0;
+
+	/**
+	 * Reads a chunk of the data.
+	 *
+	 * The returned view remains valid until the next call to ReadChunk or until the reader is destroyed.
+	 *
+	 * @param Offset The offset of the chunk.
+	 * @param Size The size of the chunk, which is clamped to the end of the data.
+	 * @return A view of the chunk, or an empty view if the chunk could not be read.
+	 * @note The returned chunk may be shorter than requested, and callers continue at the end of it.
+	 * @see Prefetch
+	 */
+	virtual FMemoryView ReadChunk(int64 Offset, int64 Size) = 0;
+
+	/**
+	 * Hints that a chunk is going to be read soon.
+	 *
+	 * @param Offset The offset of the chunk.
+	 * @param Size The size of the chunk.
+	 * @see ReadChunk
+	 */
+	virtual void Prefetch(int64 Offset, int64 Size)
+	{
+	}
+
+public:
+	/** Virtual destructor. */
+	virtual ~ISGMessageAttachmentReader()
+	{
+	}
+};
+
+
 /**
  * Interface for message attachments.
  *
@@ -13,12 +68,10 @@ class FArchive;
  * amounts to copying a pointer to the data. On the other hand, sending message attachments to
  * applications running in other processes or on other computers may - depending on their size -
  * take a considerable amount of time, because they need to be serialized and transferred. For this
- * reason, attachments are transferred separately from messages in such cases.
- *
- * NOTE: Message attachments are not fully implemented yet. In particular, transferring attachments
- * over a network does not work yet. This API may change in the near future, so please use with care.
+ * reason, message bridges stream attachments separately from their messages in chunks, and deliver
+ * the messages once their attachments arrived.
  *
- * @see ISGMessageContext
+ * @see ISGMessageAttachmentReader, ISGMessageContext
  */
 class ISGMessageAttachment
 {
@@ -32,6 +85,28 @@ public:
 	 */
 	virtual FArchive* CreateReader() = 0;
 
+	/**
+	 * Creates a reader that reads the data in chunks.
+	 *
+	 * The default implementation reads through the archive returned by CreateReader.
+	 *
+	 * @return A chunk reader, or nullptr if the data cannot be read.
+	 */
+	SGMESSAGING_API virtual TUniquePtr<ISGMessageAttachmentReader> CreateChunkReader();
+
+	/**
+	 * Gets the data if the attachment holds all of it in shared memory buffers.
+	 *
+	 * Bridges encode such attachments directly from the buffers. Small ones are sent together with their
+	 * message instead of being streamed.
+	 *
+	 * @return The buffers, or a null buffer if the data is not held in memory.
+	 */
+	virtual FCompositeBuffer GetMemoryBuffer() const
+	{
+		return FCompositeBuffer();
+	}
+
 public:
 	/** Virtual destructor. */
 	virtual ~ISGMessageAttachment()
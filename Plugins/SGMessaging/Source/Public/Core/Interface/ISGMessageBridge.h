@@ -2,6 +2,83 @@
 
 #pragma once
 
+#include "CoreTypes.h"
+
+
+/**
+ * Structure for the statistics of a bridge's reliable messaging.
+ *
+ * @see ISGMessageBridge::GetReliabilityStats
+ */
+struct FSGMessageReliabilityStats
+{
+	/** Holds the number of reliable messages sent, counted once per remote node. */
+	int64 NumSent = 0;
+
+	/** Holds the number of retransmissions. */
+	int64 NumRetransmitted = 0;
+
+	/** Holds the number of retransmissions that later acknowledgements caused before the timeout (fast retransmits). */
+	int64 NumFastRetransmitted = 0;
+
+	/** Holds the number of messages that were acknowledged. */
+	int64 NumAcknowledged = 0;
+
+	/** Holds the number of messages that were given up after too many retransmissions or expiration. */
+	int64 NumFailed = 0;
+
+	/** Holds the number of received messages that arrived out of order, leaving a gap. */
+	int64 NumOutOfOrder = 0;
+
+	/** Holds the number of received duplicates that were suppressed. */
+	int64 NumDuplicates = 0;
+
+	/** Holds the number of received ordered messages that were held back until a gap was filled. */
+	int64 NumHeldBack = 0;
+
+	/** Holds the number of acknowledgements sent. */
+	int64 NumAcksSent = 0;
+
+	/** Holds the smoothed round-trip time in seconds. */
+	double SmoothedRtt = 0.0;
+
+	/** Holds the smallest round-trip time observed in seconds. */
+	double MinRtt = 0.0;
+};
+
+
+/**
+ * Structure for the statistics of a bridge's attachment streaming.
+ *
+ * @see ISGMessageBridge::GetAttachmentStats
+ */
+struct FSGMessageAttachmentStats
+{
+	/** Holds the number of attachments streamed, counted once per remote node. */
+	int64 NumSent = 0;
+
+	/** Holds the number of chunks sent, including the ones that were sent again after a resumption. */
+	int64 NumChunksSent = 0;
+
+	/** Holds the number of times that a transfer was resumed from the acknowledged offset. */
+	int64 NumResumed = 0;
+
+	/** Holds the number of attachments that the remote node acknowledged completely. */
+	int64 NumCompleted = 0;
+
+	/** Holds the number of attachments that were given up, because they stalled, expired or could not be read. */
+	int64 NumFailed = 0;
+
+	/** Holds the number of received chunks that were dropped because they did not continue the received data. */
+	int64 NumChunksDropped = 0;
+
+	/** Holds the number of attachments that were received completely. */
+	int64 NumReceived = 0;
+
+	/** Holds the number of incomplete received attachments whose data was discarded. */
+	int64 NumDiscarded = 0;
+};
+
 
 /**
  * Interface for message bridges.
@@ -48,6 +125,22 @@ public:
 	 */
 	virtual bool IsEnabled() const = 0;
 
+	/**
+	 * Gets the statistics of reliable messaging over this bridge.
+	 *
+	 * The statistics remain zero if the bridge's transport delivers reliable messages itself.
+	 *
+	 * @return The statistics.
+	 */
+	virtual FSGMessageReliabilityStats GetReliabilityStats() const = 0;
+
+	/**
+	 * Gets the statistics of the attachments streamed over this bridge.
+	 *
+	 * @return The statistics.
+	 */
+	virtual FSGMessageAttachmentStats GetAttachmentStats() const = 0;
+
 public:
 	/** Virtual destructor. */
 	virtual ~ISGMessageBridge()
@@ -2,10 +2,12 @@
 
 #pragma once
 
+#include "Async/Future.h"
 #include "Containers/Array.h"
 #include "Templates/SharedPointer.h"
+#include "UObject/NameTypes.h"
+#include "Core/Common/SGMessageAddress.h"
 
-class FName;
 class ISGMessageAttachment;
 class ISGMessageContext;
 class ISGMessageInterceptor;
@@ -20,10 +22,197 @@ enum class ESGMessageScope : uint8;
 enum class ESGMessageFlags : uint32;
 
 struct FDateTime;
-struct FSGMessageAddress;
 struct FTimespan;
 
 
+/**
+ * Structure for the statistics of a message bus.
+ *
+ * Counters only ever grow, so that rates can be computed from the difference of two samples.
+ *
+ * @see ISGMessageBus::GetStats
+ */
+struct FSGMessageBusStats
+{
+	/** Holds the number of messages sent and forwarded. */
+	int64 NumSent = 0;
+
+	/** Holds the number of messages routed. */
+	int64 NumRouted = 0;
+
+	/** Holds the number of messages that were intercepted. */
+	int64 NumIntercepted = 0;
+
+	/** Holds the number of messages that were replaced by a newer message of a conflated tag before delivery. */
+	int64 NumConflated = 0;
+
+	/** Holds the number of messages that recipients handled, counted once per recipient. */
+	int64 NumHandled = 0;
+
+	/** Holds the sum of the latencies from routing to the start of the handlers, in microseconds. */
+	int64 TotalDispatchLatency = 0;
+
+	/** Holds the number of router commands that were queued up, but not processed yet. */
+	int32 NumQueuedCommands = 0;
+
+	/** Holds the number of delayed messages waiting for dispatch. */
+	int32 NumDelayed = 0;
+};
+
+
+/**
+ * Structure for the routing state of a message tag in a bus snapshot.
+ *
+ * @see FSGMessageBusSnapshot
+ */
+struct FSGMessageBusTagSnapshot
+{
+	/** Holds the message tag. */
+	FName MessageTag;
+
+	/** Holds the number of subscriptions whose subscriber is alive. */
+	int32 NumSubscriptions = 0;
+
+	/** Holds the number of subscriptions whose subscriber is gone, but that were not cleaned up yet. */
+	int32 NumStaleSubscriptions = 0;
+
+	/** Holds the number of interceptors. */
+	int32 NumInterceptors = 0;
+
+	/** Holds the number of subscriptions of local endpoints at network scope. */
+	int32 NumNetworkSubscriptions = 0;
+
+	/** Holds the number of retained messages. */
+	int32 NumRetained = 0;
+};
+
+
+/**
+ * Structure for a registered recipient in a bus snapshot.
+ *
+ * @see FSGMessageBusSnapshot
+ */
+struct FSGMessageBusRecipientSnapshot
+{
+	/** Holds the address of the recipient. */
+	FSGMessageAddress Address;
+
+	/** Holds the debug name of the recipient. */
+	FName DebugName;
+
+	/** Holds a flag indicating whether the recipient is local. */
+	bool bLocal = true;
+
+	/** Holds the number of subscriptions of the recipient. */
+	int32 NumSubscriptions = 0;
+
+	/** Holds the number of messages queued up in the inbox of the recipient. */
+	int32 NumInboxMessages = 0;
+};
+
+
+/**
+ * Structure for a consistent snapshot of the routing tables of a message bus.
+ *
+ * @see ISGMessageBus::TakeSnapshot
+ */
+struct FSGMessageBusSnapshot
+{
+	/** Holds the statistics of the bus at the time of the snapshot. */
+	FSGMessageBusStats Stats;
+
+	/** Holds the message tags that have subscriptions or interceptors. */
+	TArray<FSGMessageBusTagSnapshot> Tags;
+
+	/** Holds the registered recipients. */
+	TArray<FSGMessageBusRecipientSnapshot> Recipients;
+
+	/** Holds the number of registration listeners. */
+	int32 NumListeners = 0;
+};
+
+
+/**
+ * Structure for a message in a batch that is handed to the message bus.
+ *
+ * The bus takes ownership of the message.
+ *
+ * @see ISGMessageBus::PublishBatch, ISGMessageBus::SendBatch
+ */
+struct FSGMessageBatchEntry
+{
+	/** Holds the message tag. */
+	FName MessageTag;
+
+	/** Holds the message. */
+	void* Message = nullptr;
+};
+
+
+/**
+ * Enumerates the keys by which the messages of a conflated tag replace each other.
+ *
+ * @see FSGMessageConflation
+ */
+enum class ESGMessageConflationKey : uint8
+{
+	/** Every message of the tag replaces the previous one. */
+	Tag,
+
+	/** Messages replace the previous one with the same value of an annotation. */
+	Annotation,
+
+	/** Messages replace the previous one of the same sender. */
+	Sender
+};
+
+
+/**
+ * Structure for the conflation mode of a message tag.
+ *
+ * Messages of conflated tags carry state of which only the latest value matters. A message that is still waiting
+ * for delivery to a recipient, or in the queue of delayed messages, is replaced by a newer message with the same
+ * conflation key, so that slow recipients only handle the latest state.
+ *
+ * @see ISGMessageBus::Conflate
+ */
+struct FSGMessageConflation
+{
+	/** Holds the key by which messages replace each other. */
+	ESGMessageConflationKey Key = ESGMessageConflationKey::Tag;
+
+	/** Holds the name of the annotation that holds the key (annotation keys only). */
+	FName AnnotationKey;
+
+	/** Creates a conflation mode in which every message of the tag replaces the previous one. */
+	static FSGMessageConflation ByTag()
+	{
+		return FSGMessageConflation();
+	}
+
+	/** Creates a conflation mode in which messages replace the previous one with the same annotation value. */
+	static FSGMessageConflation ByAnnotation(const FName& InAnnotationKey)
+	{
+		FSGMessageConflation Conflation;
+		{
+			Conflation.Key = ESGMessageConflationKey::Annotation;
+			Conflation.AnnotationKey = InAnnotationKey;
+		}
+
+		return Conflation;
+	}
+
+	/** Creates a conflation mode in which messages replace the previous one of the same sender. */
+	static FSGMessageConflation BySender()
+	{
+		FSGMessageConflation Conflation;
+		Conflation.Key = ESGMessageConflationKey::Sender;
+
+		return Conflation;
+	}
+};
+
+
 /** Delegate type for message bus shutdowns. */
 DECLARE_MULTICAST_DELEGATE(FOnMessageBusShutdown);
 
@@ -110,6 +299,18 @@ DECLARE_MULTICAST_DELEGATE(FOnMessageBusShutdown);
 class ISGMessageBus
 {
 public:
+	/**
+	 * Conflates the messages of the specified type, so that newer messages replace pending ones.
+	 *
+	 * Recipients that receive on any thread handle every message as it is routed, so conflation only affects
+	 * recipients on named threads and delayed messages.
+	 *
+	 * @param MessageTag The type of messages to conflate.
+	 * @param Conflation The conflation mode.
+	 * @see Unconflate
+	 */
+	virtual void Conflate(const FName& MessageTag, const FSGMessageConflation& Conflation) = 0;
+
 	/**
 	 * Forwards a previously received message.
 	 *
@@ -125,6 +326,17 @@ public:
 	                     const TArray<FSGMessageAddress>& Recipients, const FTimespan& Delay,
 	                     const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Forwarder) = 0;
 
+	/**
+	 * Routes a message context as it is.
+	 *
+	 * Unlike forwarded messages, injected messages keep their sender, recipients, scope and times. This is used
+	 * to route messages that were not sent through this bus, such as replayed recordings.
+	 *
+	 * @param Context The context of the message to route.
+	 * @see Forward, StartRecording
+	 */
+	virtual void Inject(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context) = 0;
+
 	/**
 	 * Gets the message bus tracer.
 	 *
@@ -146,6 +358,25 @@ public:
 	                     const TMap<FName, FString>& Annotations, const FTimespan& Delay, const FDateTime& Expiration,
 	                     const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Publisher) = 0;
 
+	/**
+	 * Publishes a batch of messages to all subscribed recipients.
+	 *
+	 * The batch is routed as a single command: recipients are resolved once per distinct message tag, and the
+	 * messages for recipients on the same thread are delivered together, in the order of the batch.
+	 *
+	 * @param Messages The messages to publish, which the bus takes ownership of.
+	 * @param Scope The message scope.
+	 * @param Annotations An optional message annotations header, shared by all messages.
+	 * @param Delay The delay after which to publish the messages.
+	 * @param Expiration The time at which the messages expire.
+	 * @param Publisher The message publisher.
+	 * @see Publish, SendBatch
+	 */
+	virtual void PublishBatch(const TArray<FSGMessageBatchEntry>& Messages, ESGMessageScope Scope,
+	                          const TMap<FName, FString>& Annotations, const FTimespan& Delay,
+	                          const FDateTime& Expiration,
+	                          const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Publisher) = 0;
+
 	/**
 	 * Registers a message recipient with the message bus.
 	 *
@@ -156,6 +387,18 @@ public:
 	virtual void Register(const FSGMessageAddress& Address,
 	                      const TSharedRef<ISGMessageReceiver, ESPMode::ThreadSafe>& Recipient) = 0;
 
+	/**
+	 * Retains the latest published messages of the specified type for subscribers that join later.
+	 *
+	 * New subscriptions to the type receive the retained messages, oldest first, when they are added. Expired
+	 * messages are dropped. Messages that were sent to specific recipients are not retained.
+	 *
+	 * @param MessageTag The type of messages to retain.
+	 * @param HistorySize The maximum number of messages to retain.
+	 * @see Unretain
+	 */
+	virtual void Retain(const FName& MessageTag, int32 HistorySize) = 0;
+
 	virtual void Send(const FName& MessageTag,
 	                  void* Message,
 	                  const TArray<FSGMessageAddress>& Recipients,
@@ -166,6 +409,47 @@ public:
 	                  const FDateTime& Expiration,
 	                  const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Sender) = 0;
 
+	/**
+	 * Sends a batch of messages to the specified recipients.
+	 *
+	 * The batch is routed as a single command, and the messages for recipients on the same thread are
+	 * delivered together, in the order of the batch.
+	 *
+	 * @param Messages The messages to send, which the bus takes ownership of.
+	 * @param Recipients The message recipients.
+	 * @param Flags The message flags.
+	 * @param Annotations An optional message annotations header, shared by all messages.
+	 * @param Delay The delay after which to send the messages.
+	 * @param Expiration The time at which the messages expire.
+	 * @param Sender The message sender.
+	 * @see Send, PublishBatch
+	 */
+	virtual void SendBatch(const TArray<FSGMessageBatchEntry>& Messages,
+	                       const TArray<FSGMessageAddress>& Recipients,
+	                       ESGMessageFlags Flags,
+	                       const TMap<FName, FString>& Annotations,
+	                       const FTimespan& Delay,
+	                       const FDateTime& Expiration,
+	                       const TSharedRef<ISGMessageSender, ESPMode::ThreadSafe>& Sender) = 0;
+
+	/**
+	 * Starts recording all messages that are routed by this message bus.
+	 *
+	 * A running recording is completed and replaced.
+	 *
+	 * @param Filename The name of the file to record to.
+	 * @return true if the recording started, false if the file could not be created.
+	 * @see FSGMessageRecorder, FSGMessageReplayer, StopRecording
+	 */
+	virtual bool StartRecording(const FString& Filename) = 0;
+
+	/**
+	 * Stops recording messages and completes the recording.
+	 *
+	 * @see StartRecording
+	 */
+	virtual void StopRecording() = 0;
+
 	/**
 	 * Shuts down the message bus.
 	 *
@@ -189,6 +473,22 @@ public:
 		const TSharedRef<ISGMessageReceiver, ESPMode::ThreadSafe>& Subscriber, const FName& MessageTag,
 		const TRange<ESGMessageScope>& ScopeRange) = 0;
 
+	/**
+	 * Stops retaining the messages of the specified type, and drops the retained ones.
+	 *
+	 * @param MessageTag The type of messages to stop retaining.
+	 * @see Retain
+	 */
+	virtual void Unretain(const FName& MessageTag) = 0;
+
+	/**
+	 * Stops conflating the messages of the specified type.
+	 *
+	 * @param MessageTag The type of messages to stop conflating.
+	 * @see Conflate
+	 */
+	virtual void Unconflate(const FName& MessageTag) = 0;
+
 	/**
 	 * Removes an interceptor for messages of the specified type.
 	 *
@@ -234,6 +534,34 @@ public:
 	 */
 	virtual const FString& GetName() const = 0;
 
+	/**
+	 * Gets the statistics of this message bus.
+	 *
+	 * @return The statistics.
+	 */
+	virtual FSGMessageBusStats GetStats() const = 0;
+
+	/**
+	 * Checks whether the messages of the specified type are retained.
+	 *
+	 * Retained messages outlive the code that published them, so endpoints snapshot them before publishing.
+	 *
+	 * @param MessageTag The type of messages to check.
+	 * @return true if the messages are retained, false otherwise.
+	 * @see Retain
+	 */
+	virtual bool IsRetained(const FName& MessageTag) const = 0;
+
+	/**
+	 * Takes a snapshot of the routing tables of this message bus.
+	 *
+	 * The snapshot is taken on the routing thread in between two commands, so it is consistent without
+	 * stopping the bus. The future is fulfilled once all commands queued up before this call were processed.
+	 *
+	 * @return The future snapshot.
+	 */
+	virtual TFuture<FSGMessageBusSnapshot> TakeSnapshot() = 0;
+
 public:
 	/**
 	 * Returns a delegate that is executed when the message bus is shutting down.
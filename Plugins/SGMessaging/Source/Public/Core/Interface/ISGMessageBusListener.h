@@ -45,4 +45,18 @@ public:
 	 * @param Notification The even type, either `Registered` or `Unregistered`
 	 */
 	virtual void NotifyRegistration(const FSGMessageAddress& Address, ESGMessageBusNotification Notification) = 0;
+
+	/**
+	 * Notify a change of the message tags that local endpoints subscribed to at network scope.
+	 *
+	 * This is called with `Registered` when a tag gains its first such subscriber and with `Unregistered` when it
+	 * loses its last one. Subscriptions to NAME_All are reported as NAME_All. When the listener is added, it is
+	 * called once for every tag that already has subscribers.
+	 *
+	 * @param MessageTag The message tag whose subscriptions changed.
+	 * @param Notification The event type, either `Registered` or `Unregistered`
+	 */
+	virtual void NotifySubscription(const FName& MessageTag, ESGMessageBusNotification Notification)
+	{
+	}
 };
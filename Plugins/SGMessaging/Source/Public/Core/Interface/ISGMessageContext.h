@@ -4,6 +4,7 @@
 
 #include "Async/TaskGraphInterfaces.h"
 #include "Containers/Array.h"
+#include "Core/Common/SGMessageAddress.h"
 #include "Misc/Crc.h"
 #include "Misc/Guid.h"
 #include "Templates/SharedPointer.h"
@@ -14,131 +15,6 @@ class ISGMessageAttachment;
 struct FDateTime;
 
 
-/**
- * Structure for message endpoint addresses.
- */
-struct FSGMessageAddress
-{
-public:
-	/** Default constructor (no initialization). */
-	FSGMessageAddress()
-	{
-	}
-
-public:
-	/**
-	 * Compares two message addresses for equality.
-	 *
-	 * @param X The first address to compare.
-	 * @param Y The second address to compare.
-	 * @return true if the addresses are equal, false otherwise.
-	 */
-	friend bool operator==(const FSGMessageAddress& X, const FSGMessageAddress& Y)
-	{
-		return (X.UniqueId == Y.UniqueId);
-	}
-
-	/**
-	 * Compares two message addresses for inequality.
-	 *
-	 * @param X The first address to compare.
-	 * @param Y The second address to compare.
-	 * @return true if the addresses are not equal, false otherwise.
-	 */
-	friend bool operator!=(const FSGMessageAddress& X, const FSGMessageAddress& Y)
-	{
-		return (X.UniqueId != Y.UniqueId);
-	}
-
-	/**
-	 * Serializes a message address from or into an archive.
-	 *
-	 * @param Ar The archive to serialize from or into.
-	 * @param A The address to serialize.
-	 */
-	friend FArchive& operator<<(FArchive& Ar, FSGMessageAddress& A)
-	{
-		return Ar << A.UniqueId;
-	}
-
-public:
-	/**
-	 * Invalidates the GUID.
-	 *
-	 * @see IsValid
-	 */
-	void Invalidate()
-	{
-		UniqueId.Invalidate();
-	}
-
-	/**
-	 * Checks whether this message address is valid or not.
-	 *
-	 * @return true if valid, false otherwise.
-	 * @see Invalidate
-	 */
-	bool IsValid() const
-	{
-		return UniqueId.IsValid();
-	}
-
-	/**
-	 * Converts this GUID to its string representation.
-	 *
-	 * @return The string representation.
-	 * @see Parse
-	 */
-	FString ToString() const
-	{
-		return UniqueId.ToString();
-	}
-
-public:
-	/**
-	 * Calculates the hash for a message address.
-	 *
-	 * @param Address The address to calculate the hash for.
-	 * @return The hash.
-	 */
-	friend uint32 GetTypeHash(const FSGMessageAddress& Address)
-	{
-		return FCrc::MemCrc_DEPRECATED(&Address.UniqueId, sizeof(FGuid));
-	}
-
-public:
-	/**
-	 * Returns a new message address.
-	 *
-	 * @return A new address.
-	 */
-	static FSGMessageAddress NewAddress()
-	{
-		FSGMessageAddress Result;
-		Result.UniqueId = FGuid::NewGuid();
-
-		return Result;
-	}
-
-	/**
-	 * Converts a string to a message address.
-	 *
-	 * @param String The string to convert.
-	 * @param OutAddress Will contain the parsed address.
-	 * @return true if the string was converted successfully, false otherwise.
-	 * @see ToString
-	 */
-	static bool Parse(const FString& String, FSGMessageAddress& OutAddress)
-	{
-		return FGuid::Parse(String, OutAddress.UniqueId);
-	}
-
-private:
-	/** Holds a unique identifier. */
-	FGuid UniqueId;
-};
-
-
 /**
  * Enumerates scopes for published messages.
  *
@@ -179,6 +55,8 @@ enum class ESGMessageFlags : uint32
 	None = 0,
 	/** Guarantee that this message is delivered */
 	Reliable = 1 << 0,
+	/** Deliver this reliable message only after the reliable messages that were sent before it to the same node */
+	Ordered = 1 << 1,
 };
 
 ENUM_CLASS_FLAGS(ESGMessageFlags);
@@ -70,6 +70,16 @@ public:
 	virtual void ReceiveMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context) = 0;
 
 public:
+	/**
+	 * Gets the number of messages that were received, but not handled yet (for debugging purposes).
+	 *
+	 * @return The number of queued up messages.
+	 */
+	virtual int32 GetNumInboxMessages() const
+	{
+		return 0;
+	}
+
 	/**
 	 * Checks whether this recipient represents a remote endpoint.
 	 *
@@ -156,9 +156,6 @@ struct FSGMessageTracerInterceptorInfo
  */
 struct FSGMessageTracerMessageInfo
 {
-	/** Holds a pointer to the message context. */
-	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Context;
-
 	/** Holds the message's dispatch states per endpoint. */
 	TMap<TSharedPtr<FSGMessageTracerEndpointInfo>, TSharedPtr<FSGMessageTracerDispatchState>> DispatchStates;
 
@@ -179,6 +176,65 @@ struct FSGMessageTracerMessageInfo
 };
 
 
+/**
+ * Structure for a summary of a latency distribution.
+ *
+ * All latencies are in microseconds.
+ */
+struct FSGMessageTracerLatencySummary
+{
+	/** Holds the number of recorded latencies. */
+	uint64 Count = 0;
+
+	/** Holds the mean latency. */
+	double Mean = 0.0;
+
+	/** Holds the largest latency. */
+	uint64 Max = 0;
+
+	/** Holds the median latency. */
+	uint64 P50 = 0;
+
+	/** Holds the 99th percentile. */
+	uint64 P99 = 0;
+
+	/** Holds the 99.9th percentile. */
+	uint64 P999 = 0;
+};
+
+
+/**
+ * Structure for the latencies of messages that were handled on a particular thread.
+ */
+struct FSGMessageTracerThreadLatencyInfo
+{
+	/** Holds the thread on which the recipients handled the messages. */
+	ENamedThreads::Type RecipientThread = ENamedThreads::AnyThread;
+
+	/** Holds the latencies from routing to the start of the handlers. */
+	FSGMessageTracerLatencySummary RouteToDispatch;
+
+	/** Holds the times that the handlers took. */
+	FSGMessageTracerLatencySummary DispatchToHandled;
+};
+
+
+/**
+ * Structure for the latencies of a message type.
+ */
+struct FSGMessageTracerLatencyInfo
+{
+	/** Holds the name of the message type. */
+	FName MessageTag;
+
+	/** Holds the latencies from sending to routing. */
+	FSGMessageTracerLatencySummary SendToRoute;
+
+	/** Holds the dispatch latencies per recipient thread. */
+	TArray<FSGMessageTracerThreadLatencyInfo> Threads;
+};
+
+
 /**
  * Structure for message type debug information.
  */
@@ -235,6 +291,13 @@ public:
 	/** Resets the tracer. */
 	virtual void Reset() = 0;
 
+	/**
+	 * Removes all recorded latencies.
+	 *
+	 * @see GetLatencies
+	 */
+	virtual void ResetLatencies() = 0;
+
 	/**
 	 * Steps the tracer to the next message.
 	 *
@@ -252,6 +315,8 @@ public:
 	/**
 	 * Ticks the tracer.
 	 *
+	 * Tracers process their events on a thread of their own, ticking merges pending events right away.
+	 *
 	 * @param DeltaTime The time in seconds since the last tick.
 	 * @return true if any events were processed.
 	 */
@@ -266,6 +331,18 @@ public:
 	 */
 	virtual int32 GetEndpoints(TArray<TSharedPtr<FSGMessageTracerEndpointInfo>>& OutEndpoints) const = 0;
 
+	/**
+	 * Gets the latency distributions of all message types.
+	 *
+	 * Latencies are always recorded, even if the tracer is not running, and cover all messages since the bus was
+	 * created or the latencies were last reset.
+	 *
+	 * @param OutLatencies Will contain the latencies, sorted by message type.
+	 * @return The number of message types returned.
+	 * @see ResetLatencies
+	 */
+	virtual int32 GetLatencies(TArray<FSGMessageTracerLatencyInfo>& OutLatencies) const = 0;
+
 	/**
 	 * Gets the collection of known messages.
 	 *
@@ -295,6 +372,8 @@ public:
 	/**
 	 * A delegate that is executed when the collection of known messages has changed.
 	 *
+	 * The delegate is executed on the tracer thread.
+	 *
 	 * @return The delegate.
 	 */
 	DECLARE_EVENT_OneParam(ISGMessageTracer, FOnMessageAdded, FSGMessageTracerMessageInfoRef)
@@ -304,6 +383,8 @@ public:
 	/**
 	 * A delegate that is executed when the message history has been reset.
 	 *
+	 * The delegate is executed on the tracer thread.
+	 *
 	 * @return The delegate.
 	 */
 	DECLARE_EVENT(ISGMessageTracer, FOnMessagesReset)
@@ -313,6 +394,8 @@ public:
 	/**
 	 * A delegate that is executed when the collection of known messages types has changed.
 	 *
+	 * The delegate is executed on the tracer thread.
+	 *
 	 * @return The delegate.
 	 */
 	DECLARE_EVENT_OneParam(ISGMessageTracer, FOnTypeAdded, FSGMessageTracerTypeInfoRef)
@@ -35,6 +35,19 @@ public:
 	 */
 	virtual bool StartTransport(ISGMessageTransportHandler& Handler) = 0;
 
+	/**
+	 * Checks whether this transport delivers every message that it accepts.
+	 *
+	 * Bridges acknowledge and retransmit messages that are flagged as reliable if their transport may
+	 * lose messages.
+	 *
+	 * @return true if messages are never lost, false otherwise.
+	 */
+	virtual bool IsReliable() const
+	{
+		return false;
+	}
+
 	/**
 	 * Shuts down the message transport.
 	 *
@@ -45,12 +58,16 @@ public:
 	/**
 	 * Transports the given message data to the specified network nodes.
 	 *
+	 * The message and its attachment must be encoded before this method returns. Bridges stream large attachments
+	 * in chunks whose attachment views the sender's current chunk, and that view is only valid until the sender
+	 * reads the next chunk, so transports must neither keep the context for later encoding nor keep the view.
+	 *
 	 * @param Context The context of the message to transport.
 	 * @param Recipients The transport nodes to send the message to.
 	 * @return true if the message is being transported, false otherwise.
 	 */
 	virtual bool TransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
-	                              const TArray<FGuid>& Recipients) = 0;
+	                              TArrayView<const FGuid> Recipients) = 0;
 
 protected:
 	/** Virtual destructor. */
@@ -21,6 +21,8 @@ struct FGuid;
  *
  * Each transport node gets a globally unique identifier that can be used by a
  * message bridge to translate local message addresses to remote message endpoints.
+ * Transports create their identifiers with FSGMessageAddress::NewNodeId(), so that
+ * the addresses of a discovered node can be resolved from their GUID form.
  * When a message endpoint on the message bus sends a message to a specific message
  * address that represents a remote endpoint, the message bridge maps the address
  * to a transport identifier, which is then mapped again to the corresponding
@@ -2,23 +2,31 @@
 
 #include "CoreMinimal.h"
 #include "SGAnyType.h"
+#include "Core/Serialization/SGWireTraits.h"
 
 struct FSGAny
 {
 	FSGAny()
-		: ScriptArray(nullptr)
+		: ScriptArray(nullptr),
+		  ScriptProperty(nullptr)
 	{
 	}
 
 	FSGAny(const FSGAny& That)
 		: ScriptArray(That.ScriptArray),
+		  ScriptProperty(That.ScriptProperty),
 		  Pointer(That.Clone()),
 		  AnyType(That.AnyType)
 	{
+		if (Pointer.IsValid() && That.ScriptStruct == That.GetData())
+		{
+			ScriptStruct = GetData();
+		}
 	}
 
 	FSGAny(FSGAny&& That) noexcept
 		: ScriptArray(MoveTemp(That.ScriptArray)),
+		  ScriptProperty(MoveTemp(That.ScriptProperty)),
 		  Pointer(MoveTemp(That.Pointer)),
 		  AnyType(MoveTemp(That.AnyType))
 	{
@@ -27,6 +35,7 @@ struct FSGAny
 	template <typename T, class = TEnableIf<TNot<TIsSame<TDecay<T>, FSGAny>>::Value, T>>
 	explicit FSGAny(T&& Value)
 		: ScriptArray(nullptr),
+		  ScriptProperty(nullptr),
 		  Pointer(new TDerived<typename TDecay<T>::Type>(Forward<T>(Value))),
 		  AnyType(TSGAnyTraits<typename TRemoveReference<decltype(Value)>::Type>::GetType())
 	{
@@ -56,6 +65,76 @@ struct FSGAny
 		return Derived->Value;
 	}
 
+	/**
+	 * Gets the address of the held value.
+	 *
+	 * @return The value's address, or nullptr if empty.
+	 */
+	void* GetData() const
+	{
+		return Pointer.IsValid() ? Pointer->GetData() : nullptr;
+	}
+
+	/**
+	 * Replaces the held value while keeping the script bindings.
+	 *
+	 * @param Value The new value.
+	 */
+	template <typename T>
+	void Emplace(T&& Value)
+	{
+		Pointer = MakeUnique<TDerived<typename TDecay<T>::Type>>(Forward<T>(Value));
+
+		AnyType = TSGAnyTraits<typename TDecay<T>::Type>::GetType();
+	}
+
+	/**
+	 * Gets the type that the held value is encoded as on the wire.
+	 *
+	 * @return The wire type, or Empty if the value cannot be encoded.
+	 * @see WriteWire
+	 */
+	ESGAnyTypes GetWireType() const
+	{
+		if (IsScriptBound())
+		{
+			return FSGWireProperty::GetType(ScriptProperty);
+		}
+
+		if (AnyType == ESGAnyTypes::Wire)
+		{
+			return Cast<FSGWireValue>().Type;
+		}
+
+		return Pointer.IsValid() ? Pointer->GetWireType() : ESGAnyTypes::Empty;
+	}
+
+	/**
+	 * Writes the held value in the wire format.
+	 *
+	 * @param Writer The writer to write to.
+	 * @see GetWireType
+	 */
+	void WriteWire(FSGWireWriter& Writer) const
+	{
+		if (IsScriptBound())
+		{
+			FSGWireProperty::Write(Writer, ScriptProperty, ScriptStruct);
+		}
+		else if (AnyType == ESGAnyTypes::Wire)
+		{
+			const auto& Value = Cast<FSGWireValue>();
+
+			auto Reader = Value.CreateReader();
+
+			Writer.Transcode(Reader, Value.Type);
+		}
+		else if (Pointer.IsValid())
+		{
+			Pointer->WriteWire(Writer);
+		}
+	}
+
 	FSGAny& operator=(const FSGAny& Other)
 	{
 		if (Pointer == Other.Pointer)
@@ -67,6 +146,12 @@ struct FSGAny
 
 		AnyType = Other.AnyType;
 
+		ScriptArray = Other.Pointer.IsValid() && Other.ScriptStruct == Other.GetData()
+			              ? static_cast<FScriptArray*>(GetData())
+			              : Other.ScriptArray;
+
+		ScriptProperty = Other.ScriptProperty;
+
 		return *this;
 	}
 
@@ -82,6 +167,12 @@ private:
 		}
 
 		virtual FBasePtr Clone() const = 0;
+
+		virtual void* GetData() = 0;
+
+		virtual ESGAnyTypes GetWireType() const = 0;
+
+		virtual void WriteWire(FSGWireWriter& Writer) const = 0;
 	};
 
 	template <typename T>
@@ -98,6 +189,21 @@ private:
 			return MakeUnique<TDerived<T>>(Value);
 		}
 
+		virtual void* GetData() override
+		{
+			return &Value;
+		}
+
+		virtual ESGAnyTypes GetWireType() const override
+		{
+			return TSGWireTraits<T>::GetType();
+		}
+
+		virtual void WriteWire(FSGWireWriter& Writer) const override
+		{
+			TSGWireTraits<T>::Write(Writer, Value);
+		}
+
 		T Value;
 	};
 
@@ -107,6 +213,13 @@ private:
 		return Pointer != nullptr ? Pointer->Clone() : nullptr;
 	}
 
+	/** Checks whether the value refers to script data that was set from Blueprint and not snapshot yet. */
+	bool IsScriptBound() const
+	{
+		return ScriptProperty != nullptr && ScriptStruct != nullptr && (AnyType == ESGAnyTypes::FScriptArray ||
+			AnyType == ESGAnyTypes::FScriptMap || AnyType == ESGAnyTypes::FScriptSet || AnyType == ESGAnyTypes::Empty);
+	}
+
 public:
 	union
 	{
@@ -119,6 +232,9 @@ public:
 		void* ScriptStruct;
 	};
 
+	/** Holds the property describing the script data referenced above, if it was set from Blueprint. */
+	const FProperty* ScriptProperty;
+
 private:
 	FBasePtr Pointer;
 
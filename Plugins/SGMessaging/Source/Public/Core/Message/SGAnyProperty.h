@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "SGAny.h"
+#include "SGMessageArena.h"
 
 struct FSGAnyProperty
 {
@@ -237,13 +238,22 @@ struct TSGAnyProperty<TArray<T>> : FSGAnyProperty
 	{
 		if (const auto Value = Params.Find(Key))
 		{
-			ensure(Value->GetType() == ESGAnyTypes::TArray || Value->GetType() == ESGAnyTypes::FScriptArray);
+			ensure(
+				Value->GetType() == ESGAnyTypes::TArray || Value->GetType() == ESGAnyTypes::FScriptArray || Value->
+				GetType() == ESGAnyTypes::FScriptArraySnapshot);
 
 			if (Value->GetType() == ESGAnyTypes::TArray)
 			{
 				return Value->template Cast<TArray<T>>();
 			}
 
+			if (Value->GetType() == ESGAnyTypes::FScriptArraySnapshot)
+			{
+				const auto& Snapshot = Value->template Cast<FSGScriptArraySnapshot>();
+
+				return TArray<T>(reinterpret_cast<const T*>(Snapshot.Data), Snapshot.Num);
+			}
+
 			if (Value->GetType() == ESGAnyTypes::FScriptArray)
 			{
 				auto ScriptArrayHelper = Value->template Cast<FScriptArrayHelper>();
@@ -275,14 +285,40 @@ struct TSGAnyProperty<FScriptArrayHelper, T> : FSGAnyProperty
 
 	void operator()(const FArrayProperty* ArrayProperty, const void* PropertyAddress) const
 	{
-		Params.Add(Key, FSGAny(FScriptArrayHelper(ArrayProperty, PropertyAddress)));
+		auto Any = FSGAny(FScriptArrayHelper(ArrayProperty, PropertyAddress));
+
+		Any.ScriptArray = static_cast<FScriptArray*>(const_cast<void*>(PropertyAddress));
+
+		Any.ScriptProperty = ArrayProperty;
+
+		Params.Add(Key, MoveTemp(Any));
 	}
 
 	void operator()(const void* PropertyAddress, const FArrayProperty* ArrayProperty) const
 	{
 		if (const auto Value = Params.Find(Key))
 		{
-			ensure(Value->GetType() == ESGAnyTypes::FScriptArray|| Value->GetType() == ESGAnyTypes::TArray);
+			ensure(
+				Value->GetType() == ESGAnyTypes::FScriptArray|| Value->GetType() == ESGAnyTypes::TArray || Value->
+				GetType() == ESGAnyTypes::FScriptArraySnapshot);
+
+			if (Value->GetType() == ESGAnyTypes::FScriptArraySnapshot)
+			{
+				const auto& Snapshot = Value->template Cast<FSGScriptArraySnapshot>();
+
+				const auto Inner = ArrayProperty->Inner;
+
+				auto DestHelper = FScriptArrayHelper::CreateHelperFormInnerProperty(Inner, PropertyAddress);
+
+				DestHelper.Resize(Snapshot.Num);
+
+				for (auto i = 0; i < Snapshot.Num; ++i)
+				{
+					Inner->CopySingleValue(DestHelper.GetRawPtr(i), Snapshot.GetElementPtr(i));
+				}
+
+				return;
+			}
 
 			auto SrcHelper = Value->GetType() == ESGAnyTypes::FScriptArray
 				                 ? Value->template Cast<FScriptArrayHelper>()
@@ -329,13 +365,32 @@ struct TSGAnyProperty<TMap<K, V>> : FSGAnyProperty
 	{
 		if (const auto Value = Params.Find(Key))
 		{
-			ensure(Value->GetType() == ESGAnyTypes::TMap||Value->GetType() == ESGAnyTypes::FScriptMap);
+			ensure(
+				Value->GetType() == ESGAnyTypes::TMap||Value->GetType() == ESGAnyTypes::FScriptMap || Value->GetType()
+				== ESGAnyTypes::FScriptMapSnapshot);
 
 			if (Value->GetType() == ESGAnyTypes::TMap)
 			{
 				return Value->template Cast<TMap<K, V>>();
 			}
 
+			if (Value->GetType() == ESGAnyTypes::FScriptMapSnapshot)
+			{
+				const auto& Snapshot = Value->template Cast<FSGScriptMapSnapshot>();
+
+				TMap<K, V> ScriptMap;
+
+				ScriptMap.Reserve(Snapshot.Num);
+
+				for (auto i = 0; i < Snapshot.Num; ++i)
+				{
+					ScriptMap.Add(*reinterpret_cast<const K*>(Snapshot.GetKeyPtr(i)),
+					              *reinterpret_cast<const V*>(Snapshot.GetValuePtr(i)));
+				}
+
+				return MoveTemp(ScriptMap);
+			}
+
 			if (Value->GetType() == ESGAnyTypes::FScriptMap)
 			{
 				TMap<K, V> ScriptMap;
@@ -372,14 +427,37 @@ struct TSGAnyProperty<FScriptMapHelper, T> : FSGAnyProperty
 
 	void operator()(const FMapProperty* MapProperty, const void* PropertyAddress) const
 	{
-		Params.Add(Key, FSGAny(FScriptMapHelper(MapProperty, PropertyAddress)));
+		auto Any = FSGAny(FScriptMapHelper(MapProperty, PropertyAddress));
+
+		Any.ScriptMap = static_cast<FScriptMap*>(const_cast<void*>(PropertyAddress));
+
+		Any.ScriptProperty = MapProperty;
+
+		Params.Add(Key, MoveTemp(Any));
 	}
 
 	void operator()(const void* PropertyAddress, const FMapProperty* MapProperty) const
 	{
 		if (const auto Value = Params.Find(Key))
 		{
-			ensure(Value->GetType() == ESGAnyTypes::FScriptMap || Value->GetType() == ESGAnyTypes::TMap);
+			ensure(
+				Value->GetType() == ESGAnyTypes::FScriptMap || Value->GetType() == ESGAnyTypes::TMap || Value->GetType()
+				== ESGAnyTypes::FScriptMapSnapshot);
+
+			if (Value->GetType() == ESGAnyTypes::FScriptMapSnapshot)
+			{
+				const auto& Snapshot = Value->template Cast<FSGScriptMapSnapshot>();
+
+				auto DestHelper = FScriptMapHelper::CreateHelperFormInnerProperties(
+					MapProperty->KeyProp, MapProperty->ValueProp, PropertyAddress);
+
+				for (auto i = 0; i < Snapshot.Num; ++i)
+				{
+					DestHelper.AddPair(Snapshot.GetKeyPtr(i), Snapshot.GetValuePtr(i));
+				}
+
+				return;
+			}
 
 			auto SrcHelper = Value->GetType() == ESGAnyTypes::FScriptMap
 				                 ? Value->template Cast<FScriptMapHelper>()
@@ -418,13 +496,31 @@ struct TSGAnyProperty<TSet<T>> : FSGAnyProperty
 	{
 		if (const auto Value = Params.Find(Key))
 		{
-			ensure(Value->GetType() == ESGAnyTypes::TSet || Value->GetType() == ESGAnyTypes::FScriptSet);
+			ensure(
+				Value->GetType() == ESGAnyTypes::TSet || Value->GetType() == ESGAnyTypes::FScriptSet || Value->GetType()
+				== ESGAnyTypes::FScriptSetSnapshot);
 
 			if (Value->GetType() == ESGAnyTypes::TSet)
 			{
 				return Value->template Cast<TSet<T>>();
 			}
 
+			if (Value->GetType() == ESGAnyTypes::FScriptSetSnapshot)
+			{
+				const auto& Snapshot = Value->template Cast<FSGScriptSetSnapshot>();
+
+				TSet<T> ScriptSet;
+
+				ScriptSet.Reserve(Snapshot.Num);
+
+				for (auto i = 0; i < Snapshot.Num; ++i)
+				{
+					ScriptSet.Add(*reinterpret_cast<const T*>(Snapshot.GetElementPtr(i)));
+				}
+
+				return MoveTemp(ScriptSet);
+			}
+
 			if (Value->GetType() == ESGAnyTypes::FScriptSet)
 			{
 				TSet<T> ScriptSet;
@@ -459,14 +555,39 @@ struct TSGAnyProperty<FScriptSetHelper, T> : FSGAnyProperty
 
 	void operator()(const FSetProperty* SetProperty, const void* PropertyAddress) const
 	{
-		Params.Add(Key, FSGAny(FScriptSetHelper(SetProperty, PropertyAddress)));
+		auto Any = FSGAny(FScriptSetHelper(SetProperty, PropertyAddress));
+
+		Any.ScriptSet = static_cast<FScriptSet*>(const_cast<void*>(PropertyAddress));
+
+		Any.ScriptProperty = SetProperty;
+
+		Params.Add(Key, MoveTemp(Any));
 	}
 
 	void operator()(const void* PropertyAddress, const FSetProperty* SetProperty) const
 	{
 		if (const auto Value = Params.Find(Key))
 		{
-			ensure(Value->GetType() == ESGAnyTypes::FScriptSet || Value->GetType() == ESGAnyTypes::TSet);
+			ensure(
+				Value->GetType() == ESGAnyTypes::FScriptSet || Value->GetType() == ESGAnyTypes::TSet || Value->GetType()
+				== ESGAnyTypes::FScriptSetSnapshot);
+
+			if (Value->GetType() == ESGAnyTypes::FScriptSetSnapshot)
+			{
+				const auto& Snapshot = Value->template Cast<FSGScriptSetSnapshot>();
+
+				auto DestHelper = FScriptSetHelper::CreateHelperFormElementProperty(
+					SetProperty->ElementProp, PropertyAddress);
+
+				DestHelper.EmptyElements(Snapshot.Num);
+
+				for (auto i = 0; i < Snapshot.Num; ++i)
+				{
+					DestHelper.AddElement(Snapshot.GetElementPtr(i));
+				}
+
+				return;
+			}
 
 			auto SrcHelper = Value->GetType() == ESGAnyTypes::FScriptSet
 				                 ? Value->template Cast<FScriptSetHelper>()
@@ -530,7 +651,13 @@ struct TSGAnyProperty<void*, T> : FSGAnyProperty
 
 	void operator()(const FStructProperty* StructProperty, const void* PropertyAddress) const
 	{
-		Params.Add(Key, FSGAny(PropertyAddress));
+		auto Any = FSGAny(PropertyAddress);
+
+		Any.ScriptStruct = const_cast<void*>(PropertyAddress);
+
+		Any.ScriptProperty = StructProperty;
+
+		Params.Add(Key, MoveTemp(Any));
 	}
 
 	void* operator()() const
@@ -2,6 +2,11 @@
 
 #include "SGAnyTypeTemplate.h"
 
+struct FSGScriptArraySnapshot;
+struct FSGScriptMapSnapshot;
+struct FSGScriptSetSnapshot;
+struct FSGWireValue;
+
 /**
  * Enumerates the built-in types that can be stored in instances of ESGAnyTypes.
  */
@@ -45,7 +50,11 @@ enum class ESGAnyTypes : int32
 	FMulticastSparseDelegate,
 	Char,
 	Ansichar,
-	Class
+	Class,
+	FScriptArraySnapshot,
+	FScriptMapSnapshot,
+	FScriptSetSnapshot,
+	Wire
 };
 
 
@@ -117,6 +126,17 @@ public:
 		return Type != Other.Type;
 	}
 
+public:
+	/**
+	 * Gets the stored type.
+	 *
+	 * @return The type.
+	 */
+	ESGAnyTypes GetType() const
+	{
+		return Type;
+	}
+
 private:
 	/** Holds the type of the variant. */
 	ESGAnyTypes Type;
@@ -308,6 +328,12 @@ struct TSGAnyTraits<FScriptArrayHelper, T>
 	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FScriptArray; }
 };
 
+template <typename T>
+struct TSGAnyTraits<FSGScriptArraySnapshot, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FScriptArraySnapshot; }
+};
+
 template <typename K, typename V>
 struct TSGAnyTraits<TMap<K, V>>
 {
@@ -320,6 +346,12 @@ struct TSGAnyTraits<FScriptMapHelper, T>
 	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FScriptMap; }
 };
 
+template <typename T>
+struct TSGAnyTraits<FSGScriptMapSnapshot, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FScriptMapSnapshot; }
+};
+
 template <typename T>
 struct TSGAnyTraits<TSet<T>>
 {
@@ -332,6 +364,12 @@ struct TSGAnyTraits<FScriptSetHelper, T>
 	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FScriptSet; }
 };
 
+template <typename T>
+struct TSGAnyTraits<FSGScriptSetSnapshot, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FScriptSetSnapshot; }
+};
+
 template <typename T>
 struct TSGAnyTraits<T, typename TEnableIf<TSGIsUStruct<T>::Value>::Type>
 {
@@ -367,3 +405,9 @@ struct TSGAnyTraits<ANSICHAR*, T>
 {
 	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::Ansichar; }
 };
+
+template <typename T>
+struct TSGAnyTraits<FSGWireValue, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::Wire; }
+};
@@ -3,6 +3,8 @@
 #include "CoreMinimal.h"
 #include "Core/Interface/ISGMessage.h"
 #include "SGAnyProperty.h"
+#include "SGMessageArena.h"
+#include "Memory/SharedBuffer.h"
 
 class FSGMessage final
 	: public ISGMessage
@@ -33,27 +35,46 @@ public:
 	template <typename T>
 	T Get(const FString& Key) const
 	{
+		if (const auto Value = FindWireValue(Key))
+		{
+			auto Reader = Value->CreateReader();
+
+			return TSGWireTraits<T>::Read(Reader, Value->Type);
+		}
+
 		return TSGAnyProperty<T>(Params, Key)();
 	}
 
 	void Get(const FString& Key, const FArrayProperty* ArrayProperty, const void* PropertyAddress) const
 	{
-		TSGAnyProperty<FScriptArrayHelper>(Params, Key)(PropertyAddress, ArrayProperty);
+		if (!GetWire(Key, ArrayProperty, PropertyAddress))
+		{
+			TSGAnyProperty<FScriptArrayHelper>(Params, Key)(PropertyAddress, ArrayProperty);
+		}
 	}
 
 	void Get(const FString& Key, const FMapProperty* MapProperty, const void* PropertyAddress) const
 	{
-		TSGAnyProperty<FScriptMapHelper>(Params, Key)(PropertyAddress, MapProperty);
+		if (!GetWire(Key, MapProperty, PropertyAddress))
+		{
+			TSGAnyProperty<FScriptMapHelper>(Params, Key)(PropertyAddress, MapProperty);
+		}
 	}
 
 	void Get(const FString& Key, const FSetProperty* SetProperty, const void* PropertyAddress) const
 	{
-		TSGAnyProperty<FScriptSetHelper>(Params, Key)(PropertyAddress, SetProperty);
+		if (!GetWire(Key, SetProperty, PropertyAddress))
+		{
+			TSGAnyProperty<FScriptSetHelper>(Params, Key)(PropertyAddress, SetProperty);
+		}
 	}
 
 	void Get(const FString& Key, const FStructProperty* StructProperty, void* PropertyAddress) const
 	{
-		TSGAnyProperty<void*>(Params, Key)(PropertyAddress, StructProperty);
+		if (!GetWire(Key, StructProperty, PropertyAddress))
+		{
+			TSGAnyProperty<void*>(Params, Key)(PropertyAddress, StructProperty);
+		}
 	}
 
 	template <typename T>
@@ -99,6 +120,90 @@ public:
 		TSGAnyProperty<FSparseDelegate*>(Params, Key)(MulticastSparseDelegateProperty, PropertyAddress);
 	}
 
+public:
+	/**
+	 * Copies all script containers and structs referenced by this message into its arena.
+	 *
+	 * After a snapshot the message no longer refers to memory owned by the caller that set the parameters, so it
+	 * can safely be delayed or handled on other threads. Parameters must not be added after taking a snapshot.
+	 *
+	 * @see IsSnapshot
+	 */
+	void Snapshot()
+	{
+		if (Arena.IsCommitted())
+		{
+			return;
+		}
+
+		for (const auto& Param : Params)
+		{
+			Arena.Reserve(Param.Value);
+		}
+
+		Arena.Commit();
+
+		for (auto& Param : Params)
+		{
+			Arena.Snapshot(Param.Value);
+		}
+	}
+
+	/**
+	 * Checks whether this message has been snapshot.
+	 *
+	 * @return true if the message owns all of its data, false otherwise.
+	 * @see Snapshot
+	 */
+	bool IsSnapshot() const
+	{
+		return Arena.IsCommitted();
+	}
+
+	/**
+	 * Checks whether this message was decoded from the wire format.
+	 *
+	 * Decoded messages keep their parameters encoded in the received buffer until they are read.
+	 *
+	 * @return true if decoded, false otherwise.
+	 * @see FSGMessageWireFormat::Decode
+	 */
+	bool IsWire() const
+	{
+		return !WireBuffer.IsNull();
+	}
+
+private:
+	const FSGWireValue* FindWireValue(const FString& Key) const
+	{
+		if (IsWire())
+		{
+			if (const auto Value = Params.Find(Key))
+			{
+				if (Value->IsA<FSGWireValue>())
+				{
+					return &Value->Cast<FSGWireValue>();
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+	bool GetWire(const FString& Key, const FProperty* Property, const void* PropertyAddress) const
+	{
+		if (const auto Value = FindWireValue(Key))
+		{
+			auto Reader = Value->CreateReader();
+
+			FSGWireProperty::Read(Reader, Value->Type, Property, const_cast<void*>(PropertyAddress));
+
+			return true;
+		}
+
+		return false;
+	}
+
 private:
 	template <typename T>
 	void AddImplementation(const FString& Key, T&& Value)
@@ -122,4 +227,12 @@ private:
 
 private:
 	TMap<FString, FSGAny> Params;
+
+	/** Holds the copies of script data taken by Snapshot(). */
+	FSGMessageArena Arena;
+
+	/** Holds the buffer that a decoded message's parameters are encoded in. */
+	FSharedBuffer WireBuffer;
+
+	friend class FSGMessageWireFormat;
 };
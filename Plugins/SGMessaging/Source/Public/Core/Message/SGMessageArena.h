@@ -0,0 +1,537 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGAny.h"
+#include "UObject/UnrealType.h"
+
+/**
+ * Read-only view of script array elements that were copied into a message arena.
+ */
+struct FSGScriptArraySnapshot
+{
+	/** Holds the property describing the array elements. */
+	const FProperty* Inner;
+
+	/** Holds the first element. */
+	const uint8* Data;
+
+	/** Holds the number of elements. */
+	int32 Num;
+
+	const uint8* GetElementPtr(const int32 Index) const
+	{
+		return Data + Index * Inner->ElementSize;
+	}
+};
+
+
+/**
+ * Read-only view of script map pairs that were copied into a message arena.
+ */
+struct FSGScriptMapSnapshot
+{
+	/** Holds the property describing the keys. */
+	const FProperty* KeyProp;
+
+	/** Holds the property describing the values. */
+	const FProperty* ValueProp;
+
+	/** Holds the first pair. */
+	const uint8* Data;
+
+	/** Holds the number of pairs. */
+	int32 Num;
+
+	/** Holds the offset of the value within a pair. */
+	int32 ValueOffset;
+
+	/** Holds the distance between two pairs. */
+	int32 Stride;
+
+	const uint8* GetKeyPtr(const int32 Index) const
+	{
+		return Data + Index * Stride;
+	}
+
+	const uint8* GetValuePtr(const int32 Index) const
+	{
+		return Data + Index * Stride + ValueOffset;
+	}
+};
+
+
+/**
+ * Read-only view of script set elements that were copied into a message arena.
+ */
+struct FSGScriptSetSnapshot
+{
+	/** Holds the property describing the elements. */
+	const FProperty* ElementProp;
+
+	/** Holds the first element. */
+	const uint8* Data;
+
+	/** Holds the number of elements. */
+	int32 Num;
+
+	/** Holds the distance between two elements. */
+	int32 Stride;
+
+	const uint8* GetElementPtr(const int32 Index) const
+	{
+		return Data + Index * Stride;
+	}
+};
+
+
+/* Wire traits for script data snapshots
+ *****************************************************************************/
+
+template <typename T>
+struct TSGWireTraits<FSGScriptArraySnapshot, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TArray; }
+
+	static void Write(FSGWireWriter& Writer, const FSGScriptArraySnapshot& Value)
+	{
+		const auto ElementType = FSGWireProperty::GetType(Value.Inner);
+
+		const auto Num = ElementType != ESGAnyTypes::Empty ? Value.Num : 0;
+
+		Writer.WriteVarint(Num);
+
+		Writer.WriteType(ElementType);
+
+		for (auto i = 0; i < Num; ++i)
+		{
+			FSGWireProperty::Write(Writer, Value.Inner, Value.GetElementPtr(i));
+		}
+	}
+
+	static FSGScriptArraySnapshot Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		Reader.Skip(Type);
+
+		return FSGScriptArraySnapshot();
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<FSGScriptMapSnapshot, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TMap; }
+
+	static void Write(FSGWireWriter& Writer, const FSGScriptMapSnapshot& Value)
+	{
+		const auto KeyType = FSGWireProperty::GetType(Value.KeyProp);
+
+		const auto ValueType = FSGWireProperty::GetType(Value.ValueProp);
+
+		const auto Num = KeyType != ESGAnyTypes::Empty && ValueType != ESGAnyTypes::Empty ? Value.Num : 0;
+
+		Writer.WriteVarint(Num);
+
+		Writer.WriteType(KeyType);
+
+		Writer.WriteType(ValueType);
+
+		for (auto i = 0; i < Num; ++i)
+		{
+			FSGWireProperty::Write(Writer, Value.KeyProp, Value.GetKeyPtr(i));
+
+			FSGWireProperty::Write(Writer, Value.ValueProp, Value.GetValuePtr(i));
+		}
+	}
+
+	static FSGScriptMapSnapshot Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		Reader.Skip(Type);
+
+		return FSGScriptMapSnapshot();
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<FSGScriptSetSnapshot, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TSet; }
+
+	static void Write(FSGWireWriter& Writer, const FSGScriptSetSnapshot& Value)
+	{
+		const auto ElementType = FSGWireProperty::GetType(Value.ElementProp);
+
+		const auto Num = ElementType != ESGAnyTypes::Empty ? Value.Num : 0;
+
+		Writer.WriteVarint(Num);
+
+		Writer.WriteType(ElementType);
+
+		for (auto i = 0; i < Num; ++i)
+		{
+			FSGWireProperty::Write(Writer, Value.ElementProp, Value.GetElementPtr(i));
+		}
+	}
+
+	static FSGScriptSetSnapshot Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		Reader.Skip(Type);
+
+		return FSGScriptSetSnapshot();
+	}
+};
+
+
+/**
+ * Implements a per-message arena that owns copies of the script data referenced by message parameters.
+ *
+ * Blueprint containers and structs are stored in messages by reference, which is only safe as long as the
+ * caller's frame outlives the message. Snapshotting a message copies all referenced data exactly once into a
+ * single contiguous allocation that is released together with the message. The arena is filled in two passes:
+ * Reserve() is called for every parameter to compute the layout, then Commit() allocates the block and
+ * Snapshot() is called for every parameter in the same order to copy the data and repoint the parameter.
+ *
+ * @see FSGMessage::Snapshot
+ */
+class FSGMessageArena
+{
+public:
+	/** Default constructor. */
+	FSGMessageArena()
+		: Data(nullptr)
+		  , Size(0)
+		  , Offset(0)
+		  , Alignment(1)
+	{
+	}
+
+	/** Destructor. */
+	~FSGMessageArena()
+	{
+		Release();
+	}
+
+	FSGMessageArena(const FSGMessageArena&) = delete;
+
+	FSGMessageArena& operator=(const FSGMessageArena&) = delete;
+
+public:
+	/**
+	 * Checks whether the arena's memory has been allocated.
+	 *
+	 * @return true if committed, false otherwise.
+	 */
+	bool IsCommitted() const
+	{
+		return Data != nullptr;
+	}
+
+	/**
+	 * Gets the number of bytes reserved so far.
+	 *
+	 * @return Arena size.
+	 */
+	int32 GetSize() const
+	{
+		return IsCommitted() ? Size : Offset;
+	}
+
+	/**
+	 * Accounts for the storage that the script data referenced by the given value requires.
+	 *
+	 * @param Value The message parameter to reserve storage for.
+	 * @see Commit, Snapshot
+	 */
+	void Reserve(const FSGAny& Value)
+	{
+		check(!IsCommitted());
+
+		if (Value.ScriptProperty == nullptr || Value.ScriptArray == nullptr)
+		{
+			return;
+		}
+
+		if (const auto ArrayProperty = CastField<FArrayProperty>(Value.ScriptProperty))
+		{
+			const FScriptArrayHelper Helper(ArrayProperty, Value.ScriptArray);
+
+			Advance(Helper.Num() * ArrayProperty->Inner->ElementSize, ArrayProperty->Inner->GetMinAlignment());
+		}
+		else if (const auto MapProperty = CastField<FMapProperty>(Value.ScriptProperty))
+		{
+			const FScriptMapHelper Helper(MapProperty, Value.ScriptMap);
+
+			int32 ValueOffset, Stride, PairAlignment;
+
+			GetPairLayout(MapProperty->KeyProp, MapProperty->ValueProp, ValueOffset, Stride, PairAlignment);
+
+			Advance(Helper.Num() * Stride, PairAlignment);
+		}
+		else if (const auto SetProperty = CastField<FSetProperty>(Value.ScriptProperty))
+		{
+			const FScriptSetHelper Helper(SetProperty, Value.ScriptSet);
+
+			const auto ElementProp = SetProperty->ElementProp;
+
+			Advance(Helper.Num() * Align(ElementProp->ElementSize, ElementProp->GetMinAlignment()),
+			        ElementProp->GetMinAlignment());
+		}
+		else if (const auto StructProperty = CastField<FStructProperty>(Value.ScriptProperty))
+		{
+			Advance(StructProperty->ElementSize, StructProperty->GetMinAlignment());
+		}
+	}
+
+	/**
+	 * Allocates the reserved storage as one contiguous block.
+	 *
+	 * @see Reserve, Snapshot
+	 */
+	void Commit()
+	{
+		check(!IsCommitted());
+
+		Size = FMath::Max(Offset, 1);
+
+		Data = static_cast<uint8*>(FMemory::Malloc(Size, Alignment));
+
+		Offset = 0;
+	}
+
+	/**
+	 * Copies the script data referenced by the given value into the arena and repoints the value at the copy.
+	 *
+	 * Values that own their data (i.e. those set from native C++ types) only have their script pointers
+	 * redirected to their own storage, so that Blueprint getters never read from the caller's memory.
+	 *
+	 * @param Value The message parameter to snapshot.
+	 * @see Commit, Reserve
+	 */
+	void Snapshot(FSGAny& Value)
+	{
+		check(IsCommitted());
+
+		if (Value.ScriptProperty == nullptr)
+		{
+			if (Value.GetType() == ESGAnyTypes::TArray || Value.GetType() == ESGAnyTypes::TMap ||
+				Value.GetType() == ESGAnyTypes::TSet || Value.GetType() == ESGAnyTypes::UStruct)
+			{
+				Value.ScriptStruct = Value.GetData();
+			}
+
+			return;
+		}
+
+		if (Value.ScriptArray == nullptr)
+		{
+			return;
+		}
+
+		if (const auto ArrayProperty = CastField<FArrayProperty>(Value.ScriptProperty))
+		{
+			const FScriptArrayHelper Helper(ArrayProperty, Value.ScriptArray);
+
+			const auto Inner = ArrayProperty->Inner;
+
+			const auto Dest = Allocate(Helper.Num() * Inner->ElementSize, Inner->GetMinAlignment());
+
+			CopyValues(Inner, Dest, Helper.GetRawPtr(), Helper.Num());
+
+			AddDestructor(Inner, Dest, Helper.Num(), Inner->ElementSize);
+
+			Value.Emplace(FSGScriptArraySnapshot{Inner, Dest, Helper.Num()});
+
+			Value.ScriptArray = nullptr;
+		}
+		else if (const auto MapProperty = CastField<FMapProperty>(Value.ScriptProperty))
+		{
+			const FScriptMapHelper Helper(MapProperty, Value.ScriptMap);
+
+			int32 ValueOffset, Stride, PairAlignment;
+
+			GetPairLayout(MapProperty->KeyProp, MapProperty->ValueProp, ValueOffset, Stride, PairAlignment);
+
+			const auto Dest = Allocate(Helper.Num() * Stride, PairAlignment);
+
+			auto Pair = Dest;
+
+			for (auto Index = 0; Index < Helper.GetMaxIndex(); ++Index)
+			{
+				if (Helper.IsValidIndex(Index))
+				{
+					CopyValues(MapProperty->KeyProp, Pair, Helper.GetKeyPtr(Index), 1);
+
+					CopyValues(MapProperty->ValueProp, Pair + ValueOffset, Helper.GetValuePtr(Index), 1);
+
+					Pair += Stride;
+				}
+			}
+
+			AddDestructor(MapProperty->KeyProp, Dest, Helper.Num(), Stride);
+
+			AddDestructor(MapProperty->ValueProp, Dest + ValueOffset, Helper.Num(), Stride);
+
+			Value.Emplace(FSGScriptMapSnapshot{
+				MapProperty->KeyProp, MapProperty->ValueProp, Dest, Helper.Num(), ValueOffset, Stride
+			});
+
+			Value.ScriptMap = nullptr;
+		}
+		else if (const auto SetProperty = CastField<FSetProperty>(Value.ScriptProperty))
+		{
+			const FScriptSetHelper Helper(SetProperty, Value.ScriptSet);
+
+			const auto ElementProp = SetProperty->ElementProp;
+
+			const auto Stride = Align(ElementProp->ElementSize, ElementProp->GetMinAlignment());
+
+			const auto Dest = Allocate(Helper.Num() * Stride, ElementProp->GetMinAlignment());
+
+			auto Element = Dest;
+
+			for (auto Index = 0; Index < Helper.GetMaxIndex(); ++Index)
+			{
+				if (Helper.IsValidIndex(Index))
+				{
+					CopyValues(ElementProp, Element, Helper.GetElementPtr(Index), 1);
+
+					Element += Stride;
+				}
+			}
+
+			AddDestructor(ElementProp, Dest, Helper.Num(), Stride);
+
+			Value.Emplace(FSGScriptSetSnapshot{ElementProp, Dest, Helper.Num(), Stride});
+
+			Value.ScriptSet = nullptr;
+		}
+		else if (const auto StructProperty = CastField<FStructProperty>(Value.ScriptProperty))
+		{
+			const auto Dest = Allocate(StructProperty->ElementSize, StructProperty->GetMinAlignment());
+
+			CopyValues(StructProperty, Dest, static_cast<const uint8*>(Value.ScriptStruct), 1);
+
+			AddDestructor(StructProperty, Dest, 1, StructProperty->ElementSize);
+
+			Value.Cast<const void*>() = Dest;
+
+			Value.ScriptStruct = Dest;
+		}
+	}
+
+	/**
+	 * Destroys all copied values and frees the arena's memory.
+	 */
+	void Release()
+	{
+		for (const auto& Destructor : Destructors)
+		{
+			for (auto Index = 0; Index < Destructor.Num; ++Index)
+			{
+				Destructor.Property->DestroyValue(Destructor.Data + Index * Destructor.Stride);
+			}
+		}
+
+		Destructors.Reset();
+
+		if (Data != nullptr)
+		{
+			FMemory::Free(Data);
+
+			Data = nullptr;
+		}
+
+		Size = 0;
+
+		Offset = 0;
+
+		Alignment = 1;
+	}
+
+private:
+	/** Computes where the value of a map pair lives and how far apart pairs are. */
+	static void GetPairLayout(const FProperty* KeyProp, const FProperty* ValueProp, int32& OutValueOffset,
+	                          int32& OutStride, int32& OutAlignment)
+	{
+		OutAlignment = FMath::Max(KeyProp->GetMinAlignment(), ValueProp->GetMinAlignment());
+
+		OutValueOffset = Align(KeyProp->ElementSize, ValueProp->GetMinAlignment());
+
+		OutStride = Align(OutValueOffset + ValueProp->ElementSize, OutAlignment);
+	}
+
+	/** Advances the reservation cursor by the given number of bytes. */
+	void Advance(const int32 InSize, const int32 InAlignment)
+	{
+		Offset = Align(Offset, InAlignment) + InSize;
+
+		Alignment = FMath::Max(Alignment, InAlignment);
+	}
+
+	/** Carves the given number of bytes out of the committed block. */
+	uint8* Allocate(const int32 InSize, const int32 InAlignment)
+	{
+		Offset = Align(Offset, InAlignment);
+
+		check(Offset + InSize <= Size || InSize == 0);
+
+		const auto Result = Data + Offset;
+
+		Offset += InSize;
+
+		return Result;
+	}
+
+	/** Copies a run of contiguous values into uninitialized memory. */
+	static void CopyValues(const FProperty* Property, uint8* Dest, const uint8* Src, const int32 Num)
+	{
+		if (Property->HasAnyPropertyFlags(CPF_IsPlainOldData))
+		{
+			FMemory::Memcpy(Dest, Src, Num * Property->ElementSize);
+
+			return;
+		}
+
+		for (auto Index = 0; Index < Num; ++Index)
+		{
+			Property->InitializeValue(Dest + Index * Property->ElementSize);
+
+			Property->CopySingleValue(Dest + Index * Property->ElementSize, Src + Index * Property->ElementSize);
+		}
+	}
+
+	/** Registers a run of values that must be destroyed when the arena is released. */
+	void AddDestructor(const FProperty* Property, uint8* InData, const int32 Num, const int32 Stride)
+	{
+		if (Num > 0 && !Property->HasAnyPropertyFlags(CPF_IsPlainOldData | CPF_NoDestructor))
+		{
+			Destructors.Add(FDestructor{Property, InData, Num, Stride});
+		}
+	}
+
+private:
+	struct FDestructor
+	{
+		const FProperty* Property;
+
+		uint8* Data;
+
+		int32 Num;
+
+		int32 Stride;
+	};
+
+	/** Holds the arena's memory block. */
+	uint8* Data;
+
+	/** Holds the size of the memory block. */
+	int32 Size;
+
+	/** Holds the reservation or allocation cursor. */
+	int32 Offset;
+
+	/** Holds the largest alignment requested. */
+	int32 Alignment;
+
+	/** Holds the values that need to be destroyed on release. */
+	TArray<FDestructor, TInlineAllocator<4>> Destructors;
+};
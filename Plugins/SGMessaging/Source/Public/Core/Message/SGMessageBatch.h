@@ -0,0 +1,145 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Interface/ISGMessageBus.h"
+#include "SGMessage.h"
+#include "SGMessageBuilder.h"
+#include "SGMessageTagBuilder.h"
+
+/**
+ * Implements a batch of messages that are published or sent together.
+ *
+ * The batch owns its messages until it is handed to an endpoint, and destroys the messages that were never
+ * handed over, such as when the endpoint was disabled.
+ *
+ * @see FSGMessageEndpoint::PublishBatch, FSGMessageEndpoint::SendBatch
+ */
+class FSGMessageBatch
+{
+public:
+	/** Default constructor. */
+	FSGMessageBatch() = default;
+
+	/** Move constructor. */
+	FSGMessageBatch(FSGMessageBatch&& Other)
+		: Entries(MoveTemp(Other.Entries))
+	{
+	}
+
+	/** Move assignment operator. */
+	FSGMessageBatch& operator=(FSGMessageBatch&& Other)
+	{
+		if (this != &Other)
+		{
+			Reset();
+			Entries = MoveTemp(Other.Entries);
+		}
+
+		return *this;
+	}
+
+	/** Destructor. */
+	~FSGMessageBatch()
+	{
+		Reset();
+	}
+
+	FSGMessageBatch(const FSGMessageBatch&) = delete;
+	FSGMessageBatch& operator=(const FSGMessageBatch&) = delete;
+
+public:
+	/**
+	 * Adds a message.
+	 *
+	 * @param MessageTag The tag of the message.
+	 * @param Message The message, which the batch takes ownership of.
+	 */
+	void Add(const FName& MessageTag, FSGMessage* Message)
+	{
+		FSGMessageBatchEntry& Entry = Entries.AddDefaulted_GetRef();
+		{
+			Entry.MessageTag = MessageTag;
+			Entry.Message = Message;
+		}
+	}
+
+	/**
+	 * Builds and adds a message.
+	 *
+	 * @param Params The parameters of the message.
+	 */
+	template <typename ...Args>
+	void Add(MESSAGE_TAG_PARAM_SIGNATURE, Args&&... Params)
+	{
+		Add(FSGMessageTagBuilder::Builder(MESSAGE_TAG_PARAM_VALUE), FSGMessageBuilder::Builder<FSGMessage>(Params...));
+	}
+
+	/**
+	 * Gets the messages of the batch.
+	 *
+	 * @return The messages, which are still owned by the batch.
+	 */
+	const TArray<FSGMessageBatchEntry>& GetEntries() const
+	{
+		return Entries;
+	}
+
+	/**
+	 * Checks whether the batch holds no messages.
+	 *
+	 * @return true if empty, false otherwise.
+	 */
+	bool IsEmpty() const
+	{
+		return Entries.Num() == 0;
+	}
+
+	/**
+	 * Gets the number of messages in the batch.
+	 *
+	 * @return Number of messages.
+	 */
+	int32 Num() const
+	{
+		return Entries.Num();
+	}
+
+	/**
+	 * Releases the ownership of the messages, which leaves the batch empty.
+	 *
+	 * @return The messages, which the caller takes ownership of.
+	 */
+	TArray<FSGMessageBatchEntry> Release()
+	{
+		return MoveTemp(Entries);
+	}
+
+	/**
+	 * Reserves memory for the specified number of messages.
+	 *
+	 * @param Number The number of messages.
+	 */
+	void Reserve(const int32 Number)
+	{
+		Entries.Reserve(Number);
+	}
+
+	/** Destroys all messages of the batch. */
+	void Reset()
+	{
+		for (const FSGMessageBatchEntry& Entry : Entries)
+		{
+			if (FSGMessage* Message = static_cast<FSGMessage*>(Entry.Message))
+			{
+				Message->~FSGMessage();
+				FMemory::Free(Message);
+			}
+		}
+
+		Entries.Reset();
+	}
+
+private:
+	/** Holds the messages. */
+	TArray<FSGMessageBatchEntry> Entries;
+};
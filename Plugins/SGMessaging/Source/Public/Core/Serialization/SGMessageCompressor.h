@@ -0,0 +1,159 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Interface/ISGMessageContext.h"
+#include "Memory/SharedBuffer.h"
+#include "Templates/Atomic.h"
+
+
+/**
+ * Structure for the statistics of a message compressor.
+ */
+struct FSGMessageCompressionStats
+{
+	/** Holds the number of messages that were compressed. */
+	int64 NumCompressed = 0;
+
+	/** Holds the number of messages that were sent uncompressed, because they were too small or incompressible. */
+	int64 NumUncompressed = 0;
+
+	/** Holds the number of messages that were decompressed. */
+	int64 NumDecompressed = 0;
+
+	/** Holds the size of the compressed messages before compression. */
+	int64 BytesBeforeCompression = 0;
+
+	/** Holds the size of the compressed messages after compression. */
+	int64 BytesAfterCompression = 0;
+
+	/** Holds the time spent compressing, in seconds. */
+	double CompressSeconds = 0.0;
+
+	/** Holds the time spent decompressing, in seconds. */
+	double DecompressSeconds = 0.0;
+
+	/**
+	 * Gets the compression ratio of the compressed messages.
+	 *
+	 * @return Uncompressed size divided by compressed size, or 1 if nothing was compressed.
+	 */
+	double GetRatio() const
+	{
+		return BytesAfterCompression > 0
+			       ? static_cast<double>(BytesBeforeCompression) / static_cast<double>(BytesAfterCompression)
+			       : 1.0;
+	}
+};
+
+
+/**
+ * Encodes and decodes messages for a transport, compressing those that exceed a size threshold.
+ *
+ * A compressed message replaces the encoded message with an envelope that has the same header layout, with
+ * the compressed flag set, the uncompressed size in place of the dictionary offset, followed by the
+ * compression format and the compressed bytes. Messages that do not get smaller are sent uncompressed.
+ *
+ * Received messages are decompressed (or copied) into buffers from a process-wide pool, which are returned to
+ * the pool when the last decoded message referencing them is released.
+ *
+ * The format and threshold default to the project settings. All methods are thread-safe.
+ *
+ * @see FSGMessageWireFormat, USGMessagingSettings
+ */
+class SGMESSAGING_API FSGMessageCompressor
+{
+public:
+	/** Creates a compressor that uses the format and threshold from the project settings. */
+	FSGMessageCompressor();
+
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InFormat The compression format (NAME_None disables compression).
+	 * @param InThreshold The encoded size in bytes above which messages are compressed.
+	 */
+	FSGMessageCompressor(const FName& InFormat, int32 InThreshold);
+
+public:
+	/**
+	 * Changes the compression format and threshold.
+	 *
+	 * Formats that are not available on this platform fall back to LZ4. Must not be called while messages are
+	 * being encoded.
+	 *
+	 * @param InFormat The compression format (NAME_None disables compression).
+	 * @param InThreshold The encoded size in bytes above which messages are compressed.
+	 */
+	void Configure(const FName& InFormat, int32 InThreshold);
+
+	/**
+	 * Encodes a message context and appends it to an array, compressing it if it exceeds the threshold.
+	 *
+	 * @param Context The context to encode.
+	 * @param OutBuffer The array to append to.
+	 * @return true if the message was encoded, false if it cannot be encoded.
+	 */
+	bool Encode(const ISGMessageContext& Context, TArray<uint8>& OutBuffer);
+
+	/**
+	 * Decodes a message that may be compressed.
+	 *
+	 * The data is copied, so it does not have to outlive the call.
+	 *
+	 * @param Data The received message.
+	 * @param Size The size of the received message.
+	 * @return The message context, or nullptr if the data does not hold a valid message.
+	 */
+	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Decode(const uint8* Data, int32 Size);
+
+	/**
+	 * Decodes a message that may be compressed.
+	 *
+	 * Uncompressed messages keep a reference to the buffer instead of copying it.
+	 *
+	 * @param Buffer The buffer holding the received message.
+	 * @return The message context, or nullptr if the buffer does not hold a valid message.
+	 */
+	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Decode(const FSharedBuffer& Buffer);
+
+	/**
+	 * Gets a snapshot of the compression statistics.
+	 *
+	 * @return The statistics.
+	 */
+	FSGMessageCompressionStats GetStats() const;
+
+private:
+	/** Decompresses a compressed message into a pooled buffer and decodes it. */
+	TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> DecodeCompressed(const uint8* Data, int32 Size);
+
+private:
+	/** Holds the compression format. */
+	FName Format;
+
+	/** Holds the size threshold. */
+	int32 Threshold;
+
+	/** Holds the number of compressed messages. */
+	TAtomic<int64> NumCompressed;
+
+	/** Holds the number of messages that were not compressed. */
+	TAtomic<int64> NumUncompressed;
+
+	/** Holds the number of decompressed messages. */
+	TAtomic<int64> NumDecompressed;
+
+	/** Holds the number of bytes before compression. */
+	TAtomic<int64> BytesBeforeCompression;
+
+	/** Holds the number of bytes after compression. */
+	TAtomic<int64> BytesAfterCompression;
+
+	/** Holds the cycles spent compressing. */
+	TAtomic<uint64> CompressCycles;
+
+	/** Holds the cycles spent decompressing. */
+	TAtomic<uint64> DecompressCycles;
+};
@@ -0,0 +1,358 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Interface/ISGMessageContext.h"
+#include "Core/Serialization/SGWireTraits.h"
+#include "Memory/SharedBuffer.h"
+#include "Templates/Function.h"
+
+/**
+ * Provides read access to an encoded message without decoding or copying it.
+ *
+ * The reader validates the header and the layout of the message when it is created, after which all
+ * fields are read straight from the encoded data. Only the name dictionary is materialized, because
+ * names need to be resolved against the name table. The data must outlive the reader.
+ *
+ * @see FSGMessageWireFormat
+ */
+class SGMESSAGING_API FSGMessageWireReader
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InData The encoded message.
+	 * @param InSize The size of the encoded message.
+	 */
+	FSGMessageWireReader(const uint8* InData, int32 InSize);
+
+public:
+	/**
+	 * Checks whether the data holds a well-formed message of a supported version.
+	 *
+	 * @return true if valid, false otherwise.
+	 */
+	bool IsValid() const
+	{
+		return bValid;
+	}
+
+	/**
+	 * Gets the number of bytes that the message occupies.
+	 *
+	 * @return Message size.
+	 */
+	int32 GetSize() const
+	{
+		return Size;
+	}
+
+	FName GetMessageTag() const;
+
+	FSGMessageAddress GetSender() const;
+
+	/**
+	 * Gets the GUID form of the sender's address, which is resolved by GetSender.
+	 *
+	 * @return The identifier.
+	 */
+	FGuid GetSenderGuid() const;
+
+	int32 GetNumRecipients() const
+	{
+		return NumRecipients;
+	}
+
+	FSGMessageAddress GetRecipient(int32 Index) const;
+
+	/**
+	 * Gets the GUID form of a recipient's address, which is resolved by GetRecipient.
+	 *
+	 * @param Index The index of the recipient.
+	 * @return The identifier.
+	 */
+	FGuid GetRecipientGuid(int32 Index) const;
+
+	ESGMessageScope GetScope() const;
+
+	ESGMessageFlags GetFlags() const;
+
+	FDateTime GetTimeSent() const;
+
+	FDateTime GetExpiration() const;
+
+	int32 GetNumAnnotations() const
+	{
+		return NumAnnotations;
+	}
+
+	/**
+	 * Finds an annotation.
+	 *
+	 * @param Key The name of the annotation.
+	 * @param OutValue Will hold the annotation's value.
+	 * @return true if the annotation was found, false otherwise.
+	 */
+	bool FindAnnotation(const FName& Key, FString& OutValue) const;
+
+	/**
+	 * Calls the given function for each annotation.
+	 *
+	 * @param Visitor The function to call with the name and the value of each annotation.
+	 */
+	template <typename VisitorType>
+	void ForEachAnnotation(VisitorType&& Visitor) const
+	{
+		auto Reader = CreateReader(AnnotationsOffset);
+
+		for (auto i = 0; i < NumAnnotations; ++i)
+		{
+			const auto Key = Reader.ReadName();
+
+			Visitor(Key, Reader.ReadString());
+		}
+	}
+
+	int32 GetNumParameters() const
+	{
+		return NumParams;
+	}
+
+	/**
+	 * Finds a message parameter.
+	 *
+	 * @param Key The key of the parameter.
+	 * @param OutValue Will hold the encoded parameter.
+	 * @return true if the parameter was found, false otherwise.
+	 */
+	bool FindParameter(const FString& Key, FSGWireValue& OutValue) const;
+
+	/**
+	 * Reads a message parameter.
+	 *
+	 * @param Key The key of the parameter.
+	 * @return The parameter value, or a default value if the parameter was not found.
+	 */
+	template <typename T>
+	T Get(const FString& Key) const
+	{
+		FSGWireValue Value;
+
+		if (FindParameter(Key, Value))
+		{
+			auto Reader = Value.CreateReader();
+
+			return TSGWireTraits<T>::Read(Reader, Value.Type);
+		}
+
+		return T();
+	}
+
+	/**
+	 * Calls the given function for each message parameter.
+	 *
+	 * @param Visitor The function to call with the UTF-8 encoded key and the encoded value of each parameter.
+	 */
+	template <typename VisitorType>
+	void ForEachParameter(VisitorType&& Visitor) const
+	{
+		auto Reader = CreateReader(ParamsOffset);
+
+		for (auto i = 0; i < NumParams; ++i)
+		{
+			const auto Key = Reader.ReadUtf8();
+
+			const auto Value = ReadParameterValue(Reader);
+
+			Visitor(Key, Value);
+		}
+	}
+
+	/**
+	 * Gets the attachment data that is encoded with the message.
+	 *
+	 * @return The attachment data, or an empty view if the message has none.
+	 */
+	TArrayView<const uint8> GetPayload() const
+	{
+		return TArrayView<const uint8>(Data + PayloadOffset, Size - PayloadOffset);
+	}
+
+	/**
+	 * Gets the name dictionary of the message.
+	 *
+	 * @return The names.
+	 */
+	TArrayView<const FName> GetNames() const
+	{
+		return Names;
+	}
+
+private:
+	FSGWireReader CreateReader(const int32 Offset) const
+	{
+		auto Reader = FSGWireReader(Data, DictionaryOffset, Names);
+
+		Reader.Seek(Offset);
+
+		return Reader;
+	}
+
+	FSGWireValue ReadParameterValue(FSGWireReader& Reader) const;
+
+	bool Parse();
+
+private:
+	/** Holds the encoded message. */
+	const uint8* Data;
+
+	/** Holds the size of the encoded message. */
+	int32 Size;
+
+	/** Holds a flag indicating whether the message is well-formed. */
+	bool bValid;
+
+	/** Holds the offset of the name dictionary. */
+	int32 DictionaryOffset;
+
+	/** Holds the offset of the first recipient. */
+	int32 RecipientsOffset;
+
+	/** Holds the number of recipients. */
+	int32 NumRecipients;
+
+	/** Holds the offset of the scope, flags and times. */
+	int32 ScalarsOffset;
+
+	/** Holds the offset of the first annotation. */
+	int32 AnnotationsOffset;
+
+	/** Holds the number of annotations. */
+	int32 NumAnnotations;
+
+	/** Holds the offset of the first message parameter. */
+	int32 ParamsOffset;
+
+	/** Holds the number of message parameters. */
+	int32 NumParams;
+
+	/** Holds the offset of the attachment data. */
+	int32 PayloadOffset;
+
+	/** Holds the name dictionary. */
+	TArray<FName, TInlineAllocator<16>> Names;
+};
+
+
+/**
+ * Implements the binary wire format for message contexts.
+ *
+ * An encoded message consists of a fixed header, the body and a name dictionary:
+ *
+ *		Header      'S' 'G' Version Flags DictionaryOffset:uint32 Size:uint32
+ *		Body        Tag:name Sender:guid Recipients:count,guid* Scope:uint8 Flags:varint
+ *		            TimeSent:int64 Expiration:int64 Annotations:count,(name,string)*
+ *		            Parameters:count,(key:string,type:uint8,size:varint,value)*
+ *		Dictionary  count,string*
+ *		Payload     byte*
+ *
+ * Multi-byte values are little-endian, integers are varints and names are indices into the dictionary,
+ * so that each distinct name is only transferred once per message. Every parameter value is prefixed
+ * with its size, which allows readers to skip parameters without understanding their types, and to
+ * decode them lazily. The version is incremented whenever the layout changes incompatibly.
+ *
+ * If the compressed flag is set, the header is followed by a compressed message instead of the body,
+ * and the dictionary offset holds the uncompressed size. Such messages are produced and consumed by
+ * FSGMessageCompressor, and are rejected by the reader.
+ *
+ * The payload is only present if the payload flag is set, and holds the data of an attachment that is kept in
+ * memory (see ISGMessageAttachment::GetMemoryBuffer). It extends to the end of the message and is decoded
+ * into an attachment that references the receive buffer. Other attachments are not part of the encoding.
+ *
+ * Only messages of type FSGMessage can be encoded.
+ *
+ * @see FSGMessageWireReader
+ */
+class SGMESSAGING_API FSGMessageWireFormat
+{
+public:
+	/** Type definition for functions that convert the GUID form of addresses to addresses. */
+	typedef TFunctionRef<FSGMessageAddress(const FGuid&)> FResolveAddress;
+
+	/** The version of the format that is written. */
+	static constexpr uint8 Version = 1;
+
+	/** The size of the message header. */
+	static constexpr int32 HeaderSize = 12;
+
+	/** The header flag of compressed messages. */
+	static constexpr uint8 CompressedFlag = 1 << 0;
+
+	/** The header flag of messages that are followed by attachment data. */
+	static constexpr uint8 PayloadFlag = 1 << 1;
+
+public:
+	/**
+	 * Encodes a message context into a preallocated buffer.
+	 *
+	 * @param Context The context to encode.
+	 * @param Buffer The buffer to encode into.
+	 * @param Capacity The size of the buffer.
+	 * @return The number of bytes written, or INDEX_NONE if the buffer was too small or the message cannot be encoded.
+	 */
+	static int32 Encode(const ISGMessageContext& Context, uint8* Buffer, int32 Capacity);
+
+	/**
+	 * Encodes a message context and appends it to an array.
+	 *
+	 * @param Context The context to encode.
+	 * @param OutBuffer The array to append to.
+	 * @return true if the message was encoded, false if it cannot be encoded.
+	 */
+	static bool Encode(const ISGMessageContext& Context, TArray<uint8>& OutBuffer);
+
+	/**
+	 * Decodes a message context.
+	 *
+	 * The decoded message keeps a reference to the buffer, and its parameters are only decoded when they are read.
+	 * Buffers that do not own their memory are copied.
+	 *
+	 * @param Buffer The buffer holding the encoded message.
+	 * @return The message context, or nullptr if the buffer does not hold a valid message.
+	 */
+	static TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Decode(const FSharedBuffer& Buffer);
+
+	/**
+	 * Decodes a message context and moves its times.
+	 *
+	 * The send time and the expiration (unless the message never expires) are moved by the same amount, so that
+	 * a message that is decoded long after it was encoded, such as a recorded message, keeps its delay and its
+	 * time to live.
+	 *
+	 * @param Buffer The buffer holding the encoded message.
+	 * @param TimeShift The amount of time to move the times by.
+	 * @return The message context, or nullptr if the buffer does not hold a valid message.
+	 */
+	static TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Decode(const FSharedBuffer& Buffer,
+	                                                                  const FTimespan& TimeShift);
+
+	/**
+	 * Decodes a message context, moves its times and resolves its addresses with the given function.
+	 *
+	 * This allows decoding messages whose addresses belong to nodes that are not added, such as recorded messages
+	 * of another process (see FSGMessageAddress::AddNode).
+	 *
+	 * @param Buffer The buffer holding the encoded message.
+	 * @param TimeShift The amount of time to move the times by.
+	 * @param ResolveAddress The function that converts the sender's and the recipients' GUIDs to addresses.
+	 * @return The message context, or nullptr if the buffer does not hold a valid message.
+	 */
+	static TSharedPtr<ISGMessageContext, ESPMode::ThreadSafe> Decode(const FSharedBuffer& Buffer,
+	                                                                  const FTimespan& TimeShift,
+	                                                                  FResolveAddress ResolveAddress);
+
+private:
+	static bool Encode(const ISGMessageContext& Context, FSGWireWriter& Writer);
+};
@@ -0,0 +1,772 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Message/SGAnyType.h"
+#include "Memory/SharedBuffer.h"
+
+/**
+ * Writes values in the message wire format.
+ *
+ * The wire format is a compact little-endian encoding: integers are LEB128 varints (zigzag encoded if
+ * signed), strings are length-prefixed UTF-8 and names are indices into a per-message name dictionary
+ * that is appended after the body by WriteDictionary(). The writer either encodes into a caller-provided
+ * buffer of fixed capacity, or appends to an array that grows as needed. Writing past the end of a fixed
+ * buffer does not fail immediately; it sets the overflow flag, which callers check once at the end. Values
+ * that cannot be encoded at all set the error flag in the same way.
+ *
+ * @see FSGWireReader, FSGMessageWireFormat
+ */
+class SGMESSAGING_API FSGWireWriter
+{
+public:
+	/**
+	 * Creates and initializes a writer that encodes into a preallocated buffer.
+	 *
+	 * @param InData The buffer to write to.
+	 * @param InCapacity The size of the buffer.
+	 */
+	FSGWireWriter(uint8* InData, const int32 InCapacity)
+		: Buffer(nullptr)
+		  , Data(InData)
+		  , Capacity(InCapacity)
+		  , Offset(0)
+		  , bOverflowed(false)
+		  , bError(false)
+	{
+	}
+
+	/**
+	 * Creates and initializes a writer that appends to an array.
+	 *
+	 * @param InBuffer The array to append to.
+	 */
+	explicit FSGWireWriter(TArray<uint8>& InBuffer)
+		: Buffer(&InBuffer)
+		  , Data(InBuffer.GetData())
+		  , Capacity(InBuffer.Max())
+		  , Offset(InBuffer.Num())
+		  , bOverflowed(false)
+		  , bError(false)
+	{
+	}
+
+	/** Destructor. */
+	~FSGWireWriter()
+	{
+		if (Buffer != nullptr)
+		{
+			Buffer->SetNumUninitialized(Offset, false);
+		}
+	}
+
+public:
+	/**
+	 * Gets the number of bytes written so far.
+	 *
+	 * @return Write offset.
+	 */
+	int32 Tell() const
+	{
+		return Offset;
+	}
+
+	/**
+	 * Checks whether a fixed buffer was too small for the data written to it.
+	 *
+	 * @return true if bytes were dropped, false otherwise.
+	 */
+	bool IsOverflowed() const
+	{
+		return bOverflowed;
+	}
+
+	/**
+	 * Checks whether a value could not be encoded.
+	 *
+	 * @return true if the written data is unusable, false otherwise.
+	 */
+	bool IsError() const
+	{
+		return bError;
+	}
+
+	void WriteByte(const uint8 Value)
+	{
+		if (Reserve(1))
+		{
+			Data[Offset] = Value;
+		}
+
+		++Offset;
+	}
+
+	void Write(const void* Src, const int32 Num)
+	{
+		if (Num > 0 && Reserve(Num))
+		{
+			FMemory::Memcpy(Data + Offset, Src, Num);
+		}
+
+		Offset += Num;
+	}
+
+	void WriteVarint(uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			WriteByte(static_cast<uint8>(Value) | 0x80);
+
+			Value >>= 7;
+		}
+
+		WriteByte(static_cast<uint8>(Value));
+	}
+
+	void WriteSignedVarint(const int64 Value)
+	{
+		WriteVarint((static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63));
+	}
+
+	void WriteFloat(const float Value)
+	{
+		Write(&Value, sizeof(float));
+	}
+
+	void WriteDouble(const double Value)
+	{
+		Write(&Value, sizeof(double));
+	}
+
+	void WriteInt64(const int64 Value)
+	{
+		Write(&Value, sizeof(int64));
+	}
+
+	void WriteType(const ESGAnyTypes Type)
+	{
+		WriteByte(static_cast<uint8>(Type));
+	}
+
+	void WriteGuid(const FGuid& Value)
+	{
+		Write(&Value, sizeof(FGuid));
+	}
+
+	void WriteUtf8(const uint8* Utf8, const int32 Num)
+	{
+		WriteVarint(Num);
+
+		Write(Utf8, Num);
+	}
+
+	void WriteString(const TCHAR* String, const int32 Len)
+	{
+		const FTCHARToUTF8 Converter(String, Len);
+
+		WriteUtf8(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	}
+
+	void WriteString(const FString& Value)
+	{
+		WriteString(*Value, Value.Len());
+	}
+
+	/**
+	 * Writes a name as an index into the message's name dictionary.
+	 *
+	 * @param Value The name to write.
+	 * @see WriteDictionary
+	 */
+	void WriteName(const FName& Value)
+	{
+		auto Index = Names.IndexOfByKey(Value);
+
+		if (Index == INDEX_NONE)
+		{
+			Index = Names.Add(Value);
+		}
+
+		WriteVarint(Index);
+	}
+
+	/**
+	 * Writes all names referenced so far.
+	 *
+	 * @see WriteName
+	 */
+	void WriteDictionary();
+
+	/**
+	 * Begins a size-prefixed region.
+	 *
+	 * The size is stored as a padded four byte varint, so regions larger than 256 MiB cannot be encoded.
+	 *
+	 * @return A marker to pass to EndSize().
+	 */
+	int32 BeginSize()
+	{
+		const auto Marker = Offset;
+
+		// the prefix is patched later, but must already be part of the buffer
+		Reserve(4);
+
+		Offset += 4;
+
+		return Marker;
+	}
+
+	/**
+	 * Ends a size-prefixed region.
+	 *
+	 * Regions that are too large for their size prefix set the error flag.
+	 *
+	 * @param Marker The marker returned by the matching BeginSize().
+	 */
+	void EndSize(const int32 Marker)
+	{
+		const auto Size = static_cast<uint32>(Offset - Marker - 4);
+
+		if (Size >= (1u << 28))
+		{
+			bError = true;
+
+			return;
+		}
+
+		PatchBytes(Marker, {
+			           static_cast<uint8>(Size | 0x80), static_cast<uint8>(Size >> 7 | 0x80),
+			           static_cast<uint8>(Size >> 14 | 0x80), static_cast<uint8>(Size >> 21)
+		           });
+	}
+
+	/**
+	 * Overwrites a byte written earlier.
+	 *
+	 * @param Position The offset of the byte.
+	 * @param Value The new value.
+	 */
+	void PatchByte(const int32 Position, const uint8 Value)
+	{
+		PatchBytes(Position, {Value});
+	}
+
+	/**
+	 * Overwrites a little-endian 32-bit value written earlier.
+	 *
+	 * @param Position The offset of the value.
+	 * @param Value The new value.
+	 */
+	void PatchUInt32(const int32 Position, const uint32 Value)
+	{
+		PatchBytes(Position, {
+			           static_cast<uint8>(Value), static_cast<uint8>(Value >> 8),
+			           static_cast<uint8>(Value >> 16), static_cast<uint8>(Value >> 24)
+		           });
+	}
+
+	/**
+	 * Copies a value of the given type from a reader, rewriting its names into this writer's dictionary.
+	 *
+	 * Malformed values set the error flag.
+	 *
+	 * @param Reader The reader positioned at the value.
+	 * @param Type The wire type of the value.
+	 */
+	void Transcode(class FSGWireReader& Reader, ESGAnyTypes Type);
+
+private:
+	/** Makes room for the given number of bytes at the current offset. */
+	bool Reserve(const int32 Num)
+	{
+		if (Offset + Num <= Capacity)
+		{
+			return true;
+		}
+
+		if (Buffer != nullptr)
+		{
+			Buffer->Reserve(FMath::Max(Capacity * 2, Offset + Num));
+
+			Data = Buffer->GetData();
+
+			Capacity = Buffer->Max();
+
+			return true;
+		}
+
+		bOverflowed = true;
+
+		return false;
+	}
+
+	/** Overwrites bytes written earlier; positions that were never written set the error flag. */
+	void PatchBytes(const int32 Position, std::initializer_list<uint8> Bytes)
+	{
+		if ((Position < 0) || (Position + static_cast<int32>(Bytes.size()) > FMath::Min(Offset, Capacity)))
+		{
+			bError = true;
+
+			return;
+		}
+
+		FMemory::Memcpy(Data + Position, Bytes.begin(), Bytes.size());
+	}
+
+private:
+	/** Holds the array to append to, if any. */
+	TArray<uint8>* Buffer;
+
+	/** Holds the memory being written to. */
+	uint8* Data;
+
+	/** Holds the size of the memory being written to. */
+	int32 Capacity;
+
+	/** Holds the write offset. */
+	int32 Offset;
+
+	/** Holds a flag indicating whether a fixed buffer was too small. */
+	bool bOverflowed;
+
+	/** Holds a flag indicating whether a value could not be encoded. */
+	bool bError;
+
+	/** Holds the names referenced by the encoded data. */
+	TArray<FName, TInlineAllocator<16>> Names;
+};
+
+
+/**
+ * Reads values in the message wire format.
+ *
+ * Readers never copy the underlying memory. Reading past the end of the data sets the error flag and
+ * returns default values from then on, so callers check IsError() once after decoding.
+ *
+ * @see FSGWireWriter
+ */
+class SGMESSAGING_API FSGWireReader
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InData The encoded data.
+	 * @param InSize The size of the encoded data.
+	 * @param InNames The name dictionary of the message the data belongs to.
+	 */
+	FSGWireReader(const uint8* InData, const int32 InSize, const TArrayView<const FName> InNames = TArrayView<const FName>())
+		: Data(InData)
+		  , Size(InSize)
+		  , Offset(0)
+		  , Depth(0)
+		  , bError(false)
+		  , Names(InNames)
+	{
+	}
+
+public:
+	bool IsError() const
+	{
+		return bError;
+	}
+
+	void SetError()
+	{
+		bError = true;
+	}
+
+	int32 Tell() const
+	{
+		return Offset;
+	}
+
+	int32 GetRemaining() const
+	{
+		return Size - Offset;
+	}
+
+	void Seek(const int32 Position)
+	{
+		if (Position < 0 || Position > Size)
+		{
+			bError = true;
+		}
+		else
+		{
+			Offset = Position;
+		}
+	}
+
+	uint8 ReadByte()
+	{
+		if (Offset >= Size)
+		{
+			bError = true;
+
+			return 0;
+		}
+
+		return Data[Offset++];
+	}
+
+	/**
+	 * Reads a number of bytes without copying them.
+	 *
+	 * @param Num The number of bytes.
+	 * @return A view into the encoded data.
+	 */
+	TArrayView<const uint8> ReadBytes(const int32 Num)
+	{
+		if (Num < 0 || Num > Size - Offset)
+		{
+			bError = true;
+
+			return TArrayView<const uint8>();
+		}
+
+		const auto Result = TArrayView<const uint8>(Data + Offset, Num);
+
+		Offset += Num;
+
+		return Result;
+	}
+
+	uint64 ReadVarint()
+	{
+		uint64 Result = 0;
+
+		for (auto Shift = 0; Shift < 64; Shift += 7)
+		{
+			const auto Byte = ReadByte();
+
+			Result |= static_cast<uint64>(Byte & 0x7f) << Shift;
+
+			if ((Byte & 0x80) == 0)
+			{
+				return Result;
+			}
+		}
+
+		bError = true;
+
+		return 0;
+	}
+
+	int64 ReadSignedVarint()
+	{
+		const auto Value = ReadVarint();
+
+		return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1);
+	}
+
+	float ReadFloat()
+	{
+		float Value = 0.f;
+
+		const auto Bytes = ReadBytes(sizeof(float));
+
+		if (Bytes.Num() == sizeof(float))
+		{
+			FMemory::Memcpy(&Value, Bytes.GetData(), sizeof(float));
+		}
+
+		return Value;
+	}
+
+	double ReadDouble()
+	{
+		double Value = 0.0;
+
+		const auto Bytes = ReadBytes(sizeof(double));
+
+		if (Bytes.Num() == sizeof(double))
+		{
+			FMemory::Memcpy(&Value, Bytes.GetData(), sizeof(double));
+		}
+
+		return Value;
+	}
+
+	/**
+	 * Reads a wire type.
+	 *
+	 * @return The type, or Empty if the stored value is not a valid wire type.
+	 */
+	ESGAnyTypes ReadType()
+	{
+		const auto Value = ReadByte();
+
+		if (Value >= static_cast<uint8>(ESGAnyTypes::Wire))
+		{
+			bError = true;
+
+			return ESGAnyTypes::Empty;
+		}
+
+		return static_cast<ESGAnyTypes>(Value);
+	}
+
+	/**
+	 * Reads the number of elements of a container.
+	 *
+	 * Every encoded element takes at least one byte, which bounds the count by the remaining data.
+	 *
+	 * @return The number of elements.
+	 */
+	int32 ReadCount()
+	{
+		const auto Value = ReadVarint();
+
+		if (Value > static_cast<uint64>(GetRemaining()))
+		{
+			bError = true;
+
+			return 0;
+		}
+
+		return static_cast<int32>(Value);
+	}
+
+	int64 ReadInt64()
+	{
+		int64 Value = 0;
+
+		const auto Bytes = ReadBytes(sizeof(int64));
+
+		if (Bytes.Num() == sizeof(int64))
+		{
+			FMemory::Memcpy(&Value, Bytes.GetData(), sizeof(int64));
+		}
+
+		return Value;
+	}
+
+	FGuid ReadGuid()
+	{
+		FGuid Value;
+
+		const auto Bytes = ReadBytes(sizeof(FGuid));
+
+		if (Bytes.Num() == sizeof(FGuid))
+		{
+			FMemory::Memcpy(&Value, Bytes.GetData(), sizeof(FGuid));
+		}
+
+		return Value;
+	}
+
+	/**
+	 * Reads the UTF-8 bytes of a string without converting or copying them.
+	 *
+	 * @return A view into the encoded data.
+	 */
+	TArrayView<const uint8> ReadUtf8()
+	{
+		return ReadBytes(static_cast<int32>(ReadVarint()));
+	}
+
+	FString ReadString();
+
+	FName ReadName()
+	{
+		const auto Index = ReadVarint();
+
+		if (Index >= static_cast<uint64>(Names.Num()))
+		{
+			bError = true;
+
+			return NAME_None;
+		}
+
+		return Names[Index];
+	}
+
+	/**
+	 * Reads a size-prefixed region and returns a reader that is limited to it.
+	 *
+	 * @return The reader for the region.
+	 * @see FSGWireWriter::BeginSize
+	 */
+	FSGWireReader ReadSized()
+	{
+		const auto Bytes = ReadBytes(static_cast<int32>(ReadVarint()));
+
+		FSGWireReader Result(Bytes.GetData(), Bytes.Num(), Names);
+
+		Result.Depth = Depth;
+
+		Result.bError = bError;
+
+		return Result;
+	}
+
+	/**
+	 * Enters a nested value, such as the elements of a container or the fields of a struct.
+	 *
+	 * Values that are nested more than MaxDepth levels deep are treated as malformed, so that hostile
+	 * data cannot exhaust the stack of code that recurses once per level.
+	 *
+	 * @return true if the value may be read, false if it is nested too deeply.
+	 * @see LeaveNested
+	 */
+	bool EnterNested()
+	{
+		if (Depth >= MaxDepth)
+		{
+			bError = true;
+
+			return false;
+		}
+
+		++Depth;
+
+		return true;
+	}
+
+	/**
+	 * Leaves a nested value.
+	 *
+	 * @see EnterNested
+	 */
+	void LeaveNested()
+	{
+		--Depth;
+	}
+
+public:
+	/**
+	 * Reads a number of any numeric wire type as a signed integer.
+	 *
+	 * @param Type The wire type of the value.
+	 * @return The converted value, or zero if the value is not numeric.
+	 */
+	int64 ReadInteger(ESGAnyTypes Type);
+
+	/**
+	 * Reads a number of any numeric wire type as an unsigned integer.
+	 *
+	 * @param Type The wire type of the value.
+	 * @return The converted value, or zero if the value is not numeric.
+	 */
+	uint64 ReadUnsignedInteger(ESGAnyTypes Type);
+
+	/**
+	 * Reads a number of any numeric wire type as a floating point value.
+	 *
+	 * @param Type The wire type of the value.
+	 * @return The converted value, or zero if the value is not numeric.
+	 */
+	double ReadReal(ESGAnyTypes Type);
+
+	/**
+	 * Skips a value of the given wire type.
+	 *
+	 * @param Type The wire type of the value.
+	 */
+	void Skip(ESGAnyTypes Type);
+
+public:
+	/**
+	 * Checks whether the given type is encoded as a zigzag varint.
+	 *
+	 * @param Type The wire type to check.
+	 * @return true if signed, false otherwise.
+	 */
+	static bool IsSignedType(const ESGAnyTypes Type)
+	{
+		return Type == ESGAnyTypes::Int8 || Type == ESGAnyTypes::Int16 || Type == ESGAnyTypes::Int32 ||
+			Type == ESGAnyTypes::Int64 || Type == ESGAnyTypes::Enum || Type == ESGAnyTypes::EnumClass;
+	}
+
+	/**
+	 * Checks whether the given type is encoded as a plain varint.
+	 *
+	 * @param Type The wire type to check.
+	 * @return true if unsigned, false otherwise.
+	 */
+	static bool IsUnsignedType(const ESGAnyTypes Type)
+	{
+		return Type == ESGAnyTypes::UInt8 || Type == ESGAnyTypes::UInt16 || Type == ESGAnyTypes::UInt32 ||
+			Type == ESGAnyTypes::UInt64 || Type == ESGAnyTypes::TEnumAsByte;
+	}
+
+	/**
+	 * Checks whether the given type is encoded as an object path.
+	 *
+	 * @param Type The wire type to check.
+	 * @return true if the type refers to an object, false otherwise.
+	 */
+	static bool IsObjectType(const ESGAnyTypes Type)
+	{
+		return Type == ESGAnyTypes::UObject || Type == ESGAnyTypes::TObjectPtr || Type == ESGAnyTypes::TWeakObject ||
+			Type == ESGAnyTypes::TLazyObject || Type == ESGAnyTypes::TSoftObject || Type == ESGAnyTypes::TSoftClass ||
+			Type == ESGAnyTypes::TSubclassOf || Type == ESGAnyTypes::TScriptInterface || Type == ESGAnyTypes::Class;
+	}
+
+public:
+	/** The maximum number of nested containers and structs that readers accept. */
+	static constexpr int32 MaxDepth = 64;
+
+private:
+	/** Holds the encoded data. */
+	const uint8* Data;
+
+	/** Holds the size of the encoded data. */
+	int32 Size;
+
+	/** Holds the read offset. */
+	int32 Offset;
+
+	/** Holds the number of nested values that are being read. */
+	int32 Depth;
+
+	/** Holds a flag indicating whether the data was malformed. */
+	bool bError;
+
+	/** Holds the name dictionary. */
+	TArrayView<const FName> Names;
+};
+
+
+/**
+ * Holds a message parameter that is still encoded in the buffer it was received in.
+ *
+ * Decoded messages keep their parameters in this form, so that values are only decoded when (and into
+ * whichever type) they are read. Values that are taken from a decoded message share ownership of the
+ * received buffer and the name dictionary, so that copies stay valid after the message is released.
+ * Values without owners only live as long as the reader they were read from.
+ *
+ * @see FSGMessage::Get, FSGMessageWireFormat::Decode
+ */
+struct FSGWireValue
+{
+	/** Holds the wire type of the value. */
+	ESGAnyTypes Type;
+
+	/** Holds the encoded value. */
+	const uint8* Data;
+
+	/** Holds the size of the encoded value. */
+	int32 Size;
+
+	/** Holds the name dictionary of the message. */
+	TArrayView<const FName> Names;
+
+	/** Holds the buffer that the encoded value points into, if the value keeps it alive. */
+	FSharedBuffer Buffer;
+
+	/** Holds the name dictionary that Names refers to, if the value keeps it alive. */
+	TSharedPtr<const TArray<FName>, ESPMode::ThreadSafe> NameTable;
+
+	/**
+	 * Creates a reader positioned at the value.
+	 *
+	 * @return The reader.
+	 */
+	FSGWireReader CreateReader() const
+	{
+		return FSGWireReader(Data, Size, Names);
+	}
+};
@@ -0,0 +1,708 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/Message/SGAnyTypeTemplate.h"
+#include "Core/Serialization/SGWireArchive.h"
+#include "Templates/SubclassOf.h"
+#include "UObject/LazyObjectPtr.h"
+#include "UObject/ScriptInterface.h"
+#include "UObject/SoftObjectPtr.h"
+
+class FProperty;
+class UObject;
+class UStruct;
+
+
+/**
+ * Implements the wire encoding of values that are described by reflection data.
+ *
+ * This is used for parameters that were set from Blueprint, for snapshots of those, and for native
+ * USTRUCTs, whose fields are written by name so that both sides may add or remove fields independently.
+ * Reading is tolerant: values are converted between numeric types where possible, and values of
+ * mismatching types are skipped, leaving the destination at its default.
+ */
+struct SGMESSAGING_API FSGWireProperty
+{
+	/**
+	 * Gets the wire type that values of the given property are encoded as.
+	 *
+	 * @param Property The property.
+	 * @return The wire type, or Empty if the property cannot be encoded.
+	 */
+	static ESGAnyTypes GetType(const FProperty* Property);
+
+	/**
+	 * Writes the value of a property.
+	 *
+	 * @param Writer The writer to write to.
+	 * @param Property The property describing the value.
+	 * @param Address The address of the value.
+	 */
+	static void Write(FSGWireWriter& Writer, const FProperty* Property, const void* Address);
+
+	/**
+	 * Reads the value of a property.
+	 *
+	 * @param Reader The reader positioned at the value.
+	 * @param Type The wire type of the encoded value.
+	 * @param Property The property describing the destination.
+	 * @param Address The address of the initialized destination.
+	 */
+	static void Read(FSGWireReader& Reader, ESGAnyTypes Type, const FProperty* Property, void* Address);
+
+	/**
+	 * Writes all fields of a struct.
+	 *
+	 * @param Writer The writer to write to.
+	 * @param Struct The type of the struct.
+	 * @param Address The address of the struct.
+	 */
+	static void WriteStruct(FSGWireWriter& Writer, const UStruct* Struct, const void* Address);
+
+	/**
+	 * Reads all fields of a struct that exist in the given type.
+	 *
+	 * @param Reader The reader positioned at the struct.
+	 * @param Struct The type of the struct.
+	 * @param Address The address of the initialized struct.
+	 */
+	static void ReadStruct(FSGWireReader& Reader, const UStruct* Struct, void* Address);
+
+	static void WriteObject(FSGWireWriter& Writer, const UObject* Object);
+
+	/**
+	 * Reads an object reference.
+	 *
+	 * Objects are only looked up, never loaded, as messages may be received on any thread.
+	 *
+	 * @param Reader The reader positioned at the value.
+	 * @param Type The wire type of the encoded value.
+	 * @return The object, or nullptr if it is not loaded.
+	 */
+	static UObject* ReadObject(FSGWireReader& Reader, ESGAnyTypes Type);
+
+	static FSoftObjectPath ReadObjectPath(FSGWireReader& Reader, ESGAnyTypes Type);
+
+	static void WriteText(FSGWireWriter& Writer, const FText& Text);
+
+	static FText ReadText(FSGWireReader& Reader, ESGAnyTypes Type);
+};
+
+
+/**
+ * Stub for wire encoding traits.
+ *
+ * Wire traits map a native type to the canonical type it is encoded as, and implement writing and reading
+ * it. Types without traits are encoded as Empty, i.e. their values are not transferred. This applies to
+ * delegates and raw struct pointers, which have no meaning outside of the sending process.
+ *
+ * @param T The type to encode.
+ * @see TSGAnyTraits
+ */
+template <typename T, typename Enable = void>
+struct TSGWireTraits
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::Empty; }
+
+	static void Write(FSGWireWriter& Writer, const T& Value)
+	{
+	}
+
+	static T Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		Reader.Skip(Type);
+
+		return T();
+	}
+};
+
+
+/* Wire traits for numeric types
+ *****************************************************************************/
+
+template <typename T>
+struct TSGWireSignedTraits
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return TSGAnyTraits<T>::GetType(); }
+
+	static void Write(FSGWireWriter& Writer, const T& Value)
+	{
+		Writer.WriteSignedVarint(static_cast<int64>(Value));
+	}
+
+	static T Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return static_cast<T>(Reader.ReadInteger(Type));
+	}
+};
+
+template <typename T>
+struct TSGWireUnsignedTraits
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return TSGAnyTraits<T>::GetType(); }
+
+	static void Write(FSGWireWriter& Writer, const T& Value)
+	{
+		Writer.WriteVarint(static_cast<uint64>(Value));
+	}
+
+	static T Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return static_cast<T>(Reader.ReadUnsignedInteger(Type));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<int8, T> : TSGWireSignedTraits<int8>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<uint8, T> : TSGWireUnsignedTraits<uint8>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<int16, T> : TSGWireSignedTraits<int16>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<uint16, T> : TSGWireUnsignedTraits<uint16>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<int32, T> : TSGWireSignedTraits<int32>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<uint32, T> : TSGWireUnsignedTraits<uint32>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<int64, T> : TSGWireSignedTraits<int64>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<uint64, T> : TSGWireUnsignedTraits<uint64>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<T, typename TEnableIf<TSGIsEnum<T>::Value>::type> : TSGWireSignedTraits<T>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<T, typename TEnableIf<TSGIsEnumClass<T>::Value>::type> : TSGWireSignedTraits<T>
+{
+};
+
+template <typename T>
+struct TSGWireTraits<TEnumAsByte<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TEnumAsByte; }
+
+	static void Write(FSGWireWriter& Writer, const TEnumAsByte<T>& Value)
+	{
+		Writer.WriteVarint(Value.GetIntValue());
+	}
+
+	static TEnumAsByte<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return TEnumAsByte<T>(static_cast<uint8>(Reader.ReadUnsignedInteger(Type)));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<float, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::Float; }
+
+	static void Write(FSGWireWriter& Writer, const float& Value)
+	{
+		Writer.WriteFloat(Value);
+	}
+
+	static float Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return Type == ESGAnyTypes::Float ? Reader.ReadFloat() : static_cast<float>(Reader.ReadReal(Type));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<double, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::Double; }
+
+	static void Write(FSGWireWriter& Writer, const double& Value)
+	{
+		Writer.WriteDouble(Value);
+	}
+
+	static double Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return Reader.ReadReal(Type);
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<bool, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::Bool; }
+
+	static void Write(FSGWireWriter& Writer, const bool& Value)
+	{
+		Writer.WriteByte(Value ? 1 : 0);
+	}
+
+	static bool Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return Reader.ReadInteger(Type) != 0;
+	}
+};
+
+
+/* Wire traits for object references
+ *****************************************************************************/
+
+template <typename T>
+struct TSGWireTraits<T*, typename TEnableIf<TSGIsUObject<T>::Value>::Type>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::UObject; }
+
+	static void Write(FSGWireWriter& Writer, const T* Value)
+	{
+		FSGWireProperty::WriteObject(Writer, Value);
+	}
+
+	static T* Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return Cast<T>(FSGWireProperty::ReadObject(Reader, Type));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<TObjectPtr<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TObjectPtr; }
+
+	static void Write(FSGWireWriter& Writer, const TObjectPtr<T>& Value)
+	{
+		FSGWireProperty::WriteObject(Writer, Value.Get());
+	}
+
+	static TObjectPtr<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return TObjectPtr<T>(Cast<T>(FSGWireProperty::ReadObject(Reader, Type)));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<TWeakObjectPtr<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TWeakObject; }
+
+	static void Write(FSGWireWriter& Writer, const TWeakObjectPtr<T>& Value)
+	{
+		FSGWireProperty::WriteObject(Writer, Value.Get());
+	}
+
+	static TWeakObjectPtr<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return TWeakObjectPtr<T>(Cast<T>(FSGWireProperty::ReadObject(Reader, Type)));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<TLazyObjectPtr<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TLazyObject; }
+
+	static void Write(FSGWireWriter& Writer, const TLazyObjectPtr<T>& Value)
+	{
+		FSGWireProperty::WriteObject(Writer, Value.Get());
+	}
+
+	static TLazyObjectPtr<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return TLazyObjectPtr<T>(Cast<T>(FSGWireProperty::ReadObject(Reader, Type)));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<TSoftObjectPtr<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TSoftObject; }
+
+	static void Write(FSGWireWriter& Writer, const TSoftObjectPtr<T>& Value)
+	{
+		Writer.WriteString(Value.ToString());
+	}
+
+	static TSoftObjectPtr<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return TSoftObjectPtr<T>(FSGWireProperty::ReadObjectPath(Reader, Type));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<TSoftClassPtr<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TSoftClass; }
+
+	static void Write(FSGWireWriter& Writer, const TSoftClassPtr<T>& Value)
+	{
+		Writer.WriteString(Value.ToString());
+	}
+
+	static TSoftClassPtr<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return TSoftClassPtr<T>(FSGWireProperty::ReadObjectPath(Reader, Type));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<TSubclassOf<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TSubclassOf; }
+
+	static void Write(FSGWireWriter& Writer, const TSubclassOf<T>& Value)
+	{
+		FSGWireProperty::WriteObject(Writer, Value.Get());
+	}
+
+	static TSubclassOf<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return TSubclassOf<T>(Cast<UClass>(FSGWireProperty::ReadObject(Reader, Type)));
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<TScriptInterface<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TScriptInterface; }
+
+	static void Write(FSGWireWriter& Writer, const TScriptInterface<T>& Value)
+	{
+		FSGWireProperty::WriteObject(Writer, Value.GetObject());
+	}
+
+	static TScriptInterface<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return TScriptInterface<T>(FSGWireProperty::ReadObject(Reader, Type));
+	}
+};
+
+
+/* Wire traits for strings
+ *****************************************************************************/
+
+template <typename T>
+struct TSGWireTraits<FName, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FName; }
+
+	static void Write(FSGWireWriter& Writer, const FName& Value)
+	{
+		Writer.WriteName(Value);
+	}
+
+	static FName Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		if (Type == ESGAnyTypes::FString)
+		{
+			return FName(*Reader.ReadString());
+		}
+
+		if (Type != ESGAnyTypes::FName)
+		{
+			Reader.Skip(Type);
+
+			return NAME_None;
+		}
+
+		return Reader.ReadName();
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<FString, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FString; }
+
+	static void Write(FSGWireWriter& Writer, const FString& Value)
+	{
+		Writer.WriteString(Value);
+	}
+
+	static FString Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		if (Type == ESGAnyTypes::FName)
+		{
+			return Reader.ReadName().ToString();
+		}
+
+		if (Type != ESGAnyTypes::FString)
+		{
+			Reader.Skip(Type);
+
+			return FString();
+		}
+
+		return Reader.ReadString();
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<FText, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FText; }
+
+	static void Write(FSGWireWriter& Writer, const FText& Value)
+	{
+		FSGWireProperty::WriteText(Writer, Value);
+	}
+
+	static FText Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		return FSGWireProperty::ReadText(Reader, Type);
+	}
+};
+
+/**
+ * Character pointers are encoded as strings. They cannot be read back as pointers, because the
+ * receiver has no storage to point into; use FString to read them instead.
+ */
+template <typename T>
+struct TSGWireTraits<const char*, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FString; }
+
+	static void Write(FSGWireWriter& Writer, const char* Value)
+	{
+		Writer.WriteString(FString(Value));
+	}
+
+	static const char* Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		Reader.Skip(Type);
+
+		return nullptr;
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<ANSICHAR*, T>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::FString; }
+
+	static void Write(FSGWireWriter& Writer, const ANSICHAR* Value)
+	{
+		Writer.WriteString(FString(Value));
+	}
+
+	static ANSICHAR* Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		Reader.Skip(Type);
+
+		return nullptr;
+	}
+};
+
+
+/* Wire traits for containers and structs
+ *****************************************************************************/
+
+/**
+ * Containers are encoded as their element count and element type, followed by the elements.
+ * Containers of types that cannot be encoded are written empty.
+ */
+template <typename T>
+struct TSGWireTraits<TArray<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TArray; }
+
+	static void Write(FSGWireWriter& Writer, const TArray<T>& Value)
+	{
+		const auto ElementType = TSGWireTraits<T>::GetType();
+
+		Writer.WriteVarint(ElementType != ESGAnyTypes::Empty ? Value.Num() : 0);
+
+		Writer.WriteType(ElementType);
+
+		if (ElementType != ESGAnyTypes::Empty)
+		{
+			for (const auto& Element : Value)
+			{
+				TSGWireTraits<T>::Write(Writer, Element);
+			}
+		}
+	}
+
+	static TArray<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		TArray<T> Result;
+
+		if (Type != ESGAnyTypes::TArray && Type != ESGAnyTypes::TSet)
+		{
+			Reader.Skip(Type);
+
+			return Result;
+		}
+
+		const auto Num = Reader.ReadCount();
+
+		const auto ElementType = Reader.ReadType();
+
+		Result.Reserve(Num);
+
+		for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+		{
+			Result.Add(TSGWireTraits<T>::Read(Reader, ElementType));
+		}
+
+		return Result;
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<TSet<T>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TSet; }
+
+	static void Write(FSGWireWriter& Writer, const TSet<T>& Value)
+	{
+		const auto ElementType = TSGWireTraits<T>::GetType();
+
+		Writer.WriteVarint(ElementType != ESGAnyTypes::Empty ? Value.Num() : 0);
+
+		Writer.WriteType(ElementType);
+
+		if (ElementType != ESGAnyTypes::Empty)
+		{
+			for (const auto& Element : Value)
+			{
+				TSGWireTraits<T>::Write(Writer, Element);
+			}
+		}
+	}
+
+	static TSet<T> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		TSet<T> Result;
+
+		if (Type != ESGAnyTypes::TSet && Type != ESGAnyTypes::TArray)
+		{
+			Reader.Skip(Type);
+
+			return Result;
+		}
+
+		const auto Num = Reader.ReadCount();
+
+		const auto ElementType = Reader.ReadType();
+
+		Result.Reserve(Num);
+
+		for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+		{
+			Result.Add(TSGWireTraits<T>::Read(Reader, ElementType));
+		}
+
+		return Result;
+	}
+};
+
+template <typename K, typename V>
+struct TSGWireTraits<TMap<K, V>>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::TMap; }
+
+	static void Write(FSGWireWriter& Writer, const TMap<K, V>& Value)
+	{
+		const auto KeyType = TSGWireTraits<K>::GetType();
+
+		const auto ValueType = TSGWireTraits<V>::GetType();
+
+		const auto bSupported = KeyType != ESGAnyTypes::Empty && ValueType != ESGAnyTypes::Empty;
+
+		Writer.WriteVarint(bSupported ? Value.Num() : 0);
+
+		Writer.WriteType(KeyType);
+
+		Writer.WriteType(ValueType);
+
+		if (bSupported)
+		{
+			for (const auto& Pair : Value)
+			{
+				TSGWireTraits<K>::Write(Writer, Pair.Key);
+
+				TSGWireTraits<V>::Write(Writer, Pair.Value);
+			}
+		}
+	}
+
+	static TMap<K, V> Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		TMap<K, V> Result;
+
+		if (Type != ESGAnyTypes::TMap)
+		{
+			Reader.Skip(Type);
+
+			return Result;
+		}
+
+		const auto Num = Reader.ReadCount();
+
+		const auto KeyType = Reader.ReadType();
+
+		const auto ValueType = Reader.ReadType();
+
+		Result.Reserve(Num);
+
+		for (auto i = 0; i < Num && !Reader.IsError(); ++i)
+		{
+			auto Key = TSGWireTraits<K>::Read(Reader, KeyType);
+
+			Result.Add(MoveTemp(Key), TSGWireTraits<V>::Read(Reader, ValueType));
+		}
+
+		return Result;
+	}
+};
+
+template <typename T>
+struct TSGWireTraits<T, typename TEnableIf<TSGIsUStruct<T>::Value>::Type>
+{
+	static CONSTEXPR ESGAnyTypes GetType() { return ESGAnyTypes::UStruct; }
+
+	static void Write(FSGWireWriter& Writer, const T& Value)
+	{
+		FSGWireProperty::WriteStruct(Writer, T::StaticStruct(), &Value);
+	}
+
+	static T Read(FSGWireReader& Reader, const ESGAnyTypes Type)
+	{
+		T Result;
+
+		if (Type != ESGAnyTypes::UStruct)
+		{
+			Reader.Skip(Type);
+		}
+		else
+		{
+			FSGWireProperty::ReadStruct(Reader, T::StaticStruct(), &Result);
+		}
+
+		return Result;
+	}
+};
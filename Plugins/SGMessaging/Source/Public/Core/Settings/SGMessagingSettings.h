@@ -17,4 +17,32 @@ class SGMESSAGING_API USGMessagingSettings final : public UObject
 public:
 	UPROPERTY(Config, EditAnywhere)
 	bool bAllowDelayedMessaging = false;
+
+	/** Whether outgoing messages copy the Blueprint containers and structs they reference into a per-message arena. */
+	UPROPERTY(Config, EditAnywhere)
+	bool bSnapshotScriptContainers = false;
+
+	/** The compression format that transports use for large messages (None disables compression). */
+	UPROPERTY(Config, EditAnywhere)
+	FName CompressionFormat = NAME_LZ4;
+
+	/** The encoded size in bytes above which transports compress messages. */
+	UPROPERTY(Config, EditAnywhere, meta = (ClampMin = "0"))
+	int32 CompressionThreshold = 1024;
+
+	/** The size in bytes of the chunks that bridges stream message attachments in. */
+	UPROPERTY(Config, EditAnywhere, meta = (ClampMin = "1024"))
+	int32 AttachmentChunkSize = 32 * 1024;
+
+	/** The number of attachment chunks that may be in flight per transfer. */
+	UPROPERTY(Config, EditAnywhere, meta = (ClampMin = "1"))
+	int32 AttachmentWindowSize = 16;
+
+	/** The number of events that each thread can buffer for the message tracer before events are dropped. */
+	UPROPERTY(Config, EditAnywhere, meta = (ClampMin = "64"))
+	int32 TracerRingCapacity = 4096;
+
+	/** The time in seconds for which the message tracer keeps traced messages. */
+	UPROPERTY(Config, EditAnywhere, meta = (ClampMin = "1.0"))
+	float TracerRetentionTime = 30.0f;
 };
@@ -0,0 +1,260 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include "Math/RandomStream.h"
+#include "Templates/Atomic.h"
+#include "Core/Interface/ISGMessageTransport.h"
+#include "Core/Serialization/SGMessageCompressor.h"
+
+class FEvent;
+class FRunnableThread;
+class ISGMessageTransportHandler;
+
+
+/**
+ * Structure for the faults that a loopback transport injects into the packets it receives.
+ *
+ * @see FSGLoopbackTransport::SetFaults
+ */
+struct FSGLoopbackFaults
+{
+	/** Holds the probability that a packet is lost. */
+	float DropRate = 0.0f;
+
+	/** Holds the probability that a packet is received twice. */
+	float DuplicateRate = 0.0f;
+
+	/** Holds the probability that a packet is held back, so that later packets overtake it. */
+	float ReorderRate = 0.0f;
+
+	/** Holds the time by which held back packets are delayed. */
+	FTimespan ReorderDelay = FTimespan::FromMilliseconds(5.0);
+
+	/** Holds the seed of the random stream that picks the faulty packets. */
+	int32 Seed = 0;
+};
+
+
+/**
+ * Implements a message transport that connects two message bridges in the same process.
+ *
+ * Loopback transports are created in pairs. Messages take the same path as over a real network: they are
+ * encoded by the sending transport, handed to the other transport, and decoded and passed to its bridge on
+ * the other transport's delivery thread. The link between the two can simulate latency and bandwidth, so that
+ * the costs of the bridge, the address book and serialization can be measured without a network. The link can
+ * also lose, duplicate and reorder packets, so that the reliability of the bridge can be tested.
+ *
+ * @see FSGMessageWireFormat, ISGMessageTransport
+ */
+class SGMESSAGING_API FSGLoopbackTransport final
+	: public ISGMessageTransport
+	  , FRunnable
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * Use CreatePair to create connected transports.
+	 *
+	 * @param InLatency The one-way latency of the link.
+	 * @param InBandwidth The bandwidth of the link in bytes per second (0 = unlimited).
+	 * @see CreatePair
+	 */
+	FSGLoopbackTransport(const FTimespan& InLatency, double InBandwidth);
+
+	/** Virtual destructor. */
+	virtual ~FSGLoopbackTransport() override;
+
+public:
+	/**
+	 * Creates two connected transports.
+	 *
+	 * @param Latency The one-way latency of the link.
+	 * @param Bandwidth The bandwidth of the link in bytes per second (0 = unlimited).
+	 * @param OutFirst Will hold the first transport.
+	 * @param OutSecond Will hold the second transport.
+	 */
+	static void CreatePair(const FTimespan& Latency, double Bandwidth,
+	                       TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe>& OutFirst,
+	                       TSharedPtr<FSGLoopbackTransport, ESPMode::ThreadSafe>& OutSecond);
+
+	/**
+	 * Gets the transport node identifier of this transport.
+	 *
+	 * @return Node identifier.
+	 */
+	const FGuid& GetNodeId() const
+	{
+		return NodeId;
+	}
+
+	/**
+	 * Gets the number of messages that this transport sent.
+	 *
+	 * @return Number of messages.
+	 * @see GetNumBytesTransported
+	 */
+	int64 GetNumMessagesTransported() const
+	{
+		return NumMessagesTransported;
+	}
+
+	/**
+	 * Gets the number of encoded bytes that this transport sent.
+	 *
+	 * @return Number of bytes.
+	 * @see GetNumMessagesTransported
+	 */
+	int64 GetNumBytesTransported() const
+	{
+		return NumBytesTransported;
+	}
+
+	/**
+	 * Changes the compression of outbound messages.
+	 *
+	 * Must be called before the transport is started.
+	 *
+	 * @param Format The compression format (NAME_None disables compression).
+	 * @param Threshold The encoded size in bytes above which messages are compressed.
+	 * @see GetCompressionStats
+	 */
+	void SetCompression(const FName& Format, const int32 Threshold)
+	{
+		Compressor.Configure(Format, Threshold);
+	}
+
+	/**
+	 * Gets the compression statistics of this transport.
+	 *
+	 * @return The statistics.
+	 * @see SetCompression
+	 */
+	FSGMessageCompressionStats GetCompressionStats() const
+	{
+		return Compressor.GetStats();
+	}
+
+	/**
+	 * Changes the faults that are injected into the packets that this transport receives.
+	 *
+	 * Once faults were set, the transport reports itself as unreliable, so that bridges that are created
+	 * afterwards acknowledge and retransmit reliable messages. The faults may be changed at any time.
+	 *
+	 * @param InFaults The faults to inject.
+	 * @see IsReliable
+	 */
+	void SetFaults(const FSGLoopbackFaults& InFaults);
+
+public:
+	//~ ISGMessageTransport interface
+
+	virtual FName GetDebugName() const override;
+	virtual bool StartTransport(ISGMessageTransportHandler& Handler) override;
+	virtual bool IsReliable() const override;
+	virtual void StopTransport() override;
+	virtual bool TransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	                              TArrayView<const FGuid> Recipients) override;
+
+protected:
+	//~ FRunnable interface
+
+	virtual bool Init() override;
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/** Structure for an encoded message in transit. */
+	struct FPacket
+	{
+		/** Holds the time at which the packet arrives. */
+		double DeliveryTime;
+
+		/** Holds the encoded message. */
+		TArray<uint8> Data;
+	};
+
+private:
+	/** Injects faults into a packet that is due, and passes it on. */
+	void ReceivePacket(FPacket&& Packet);
+
+	/** Decodes a packet and passes it to the handler. */
+	void DeliverPacket(TArray<uint8>&& Data);
+
+	/** Notifies this transport's handler that the other transport started. */
+	void HandlePeerStarted();
+
+	/** Notifies this transport's handler that the other transport stopped. */
+	void HandlePeerStopped();
+
+private:
+	/** Holds the one-way latency of the link. */
+	FTimespan Latency;
+
+	/** Holds the bandwidth of the link in bytes per second. */
+	double Bandwidth;
+
+	/** Holds this transport's node identifier. */
+	FGuid NodeId;
+
+	/** Holds the other transport of the pair. */
+	TWeakPtr<FSGLoopbackTransport, ESPMode::ThreadSafe> Peer;
+
+	/** Holds the node identifier of the other transport. */
+	FGuid PeerNodeId;
+
+	/** Holds the time at which the outbound link finishes sending the last packet. */
+	double LinkFreeTime;
+
+	/** Serializes senders on the outbound link. */
+	FCriticalSection LinkLock;
+
+	/** Holds the packets sent by the other transport. */
+	TQueue<FPacket, EQueueMode::Mpsc> Inbound;
+
+	/** Holds the packets that were held back to reorder them (delivery thread only). */
+	TArray<FPacket> HeldPackets;
+
+	/** Holds the faults to inject. */
+	FSGLoopbackFaults Faults;
+
+	/** Holds the random stream that picks the faulty packets. */
+	FRandomStream FaultStream;
+
+	/** Holds a flag indicating whether faults were set. */
+	TAtomic<bool> bFaulty;
+
+	/** Protects the faults and their random stream. */
+	FCriticalSection FaultsLock;
+
+	/** Holds the handler of inbound messages and node events. */
+	ISGMessageTransportHandler* TransportHandler;
+
+	/** Protects the handler against concurrent starts and stops of the pair. */
+	FCriticalSection HandlerLock;
+
+	/** Holds a flag indicating whether the transport was started. */
+	TAtomic<bool> Started;
+
+	/** Holds the number of messages sent. */
+	TAtomic<int64> NumMessagesTransported;
+
+	/** Holds the number of encoded bytes sent. */
+	TAtomic<int64> NumBytesTransported;
+
+	/** Holds an event signaling that packets arrived. */
+	FEvent* WorkEvent;
+
+	/** Holds the delivery thread. */
+	FRunnableThread* Thread;
+
+	/** Holds a flag indicating that the thread is stopping. */
+	TAtomic<bool> Stopping;
+
+	/** Holds the compressor that encodes and decodes messages. */
+	FSGMessageCompressor Compressor;
+};
@@ -0,0 +1,299 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformMemory.h"
+
+/**
+ * Implements a single-producer single-consumer ring buffer in a named shared memory region.
+ *
+ * Records are stored as a 32-bit size followed by the payload, aligned to eight bytes. Records never wrap
+ * around the end of the buffer; if a record does not fit into the remaining space, the producer writes a
+ * wrap marker and continues at the beginning. The producer only ever writes the head, the consumer only ever
+ * writes the tail, so the ring needs no locks as long as each side is used by one thread at a time.
+ *
+ * Both sides map the region; whichever maps it first creates it zero-initialized, which is a valid empty
+ * ring. Ring names are never reused, so either side unlinks the name when it unmaps the ring, while the
+ * other side keeps its mapping.
+ */
+class FSGSharedMemoryRing
+{
+public:
+	/** Default constructor. */
+	FSGSharedMemoryRing()
+		: Region(nullptr)
+		  , Header(nullptr)
+		  , Data(nullptr)
+		  , Capacity(0)
+		  , bCorrupt(false)
+	{
+	}
+
+	/** Destructor. */
+	~FSGSharedMemoryRing()
+	{
+		Unmap();
+	}
+
+	FSGSharedMemoryRing(const FSGSharedMemoryRing&) = delete;
+
+	FSGSharedMemoryRing& operator=(const FSGSharedMemoryRing&) = delete;
+
+public:
+	/**
+	 * Maps the ring's shared memory region, creating it if necessary.
+	 *
+	 * @param Name The name of the region.
+	 * @param InCapacity The size of the ring's data area (must be a power of two).
+	 * @return true if the ring was mapped, false otherwise.
+	 */
+	bool Map(const FString& Name, const uint32 InCapacity)
+	{
+		check(FMath::IsPowerOfTwo(InCapacity));
+
+		Unmap();
+
+		Region = MapRegion(Name, sizeof(FHeader) + InCapacity);
+
+		if (Region == nullptr)
+		{
+			return false;
+		}
+
+		RegionName = Name;
+		Header = static_cast<FHeader*>(Region->GetAddress());
+		Data = static_cast<uint8*>(Region->GetAddress()) + sizeof(FHeader);
+		Capacity = InCapacity;
+
+		return true;
+	}
+
+	/** Unmaps the ring's shared memory region. */
+	void Unmap()
+	{
+		if (Region != nullptr)
+		{
+			FPlatformMemory::UnmapNamedSharedMemoryRegion(Region);
+			UnlinkRegion(RegionName);
+
+			Region = nullptr;
+			Header = nullptr;
+			Data = nullptr;
+			Capacity = 0;
+		}
+
+		bCorrupt = false;
+	}
+
+	/**
+	 * Checks whether the ring is mapped.
+	 *
+	 * @return true if mapped, false otherwise.
+	 */
+	bool IsMapped() const
+	{
+		return Region != nullptr;
+	}
+
+	/**
+	 * Checks whether the consumer found records that the producer cannot have written.
+	 *
+	 * Corrupt rings are not read any further.
+	 *
+	 * @return true if the ring is corrupt, false otherwise.
+	 * @see Read
+	 */
+	bool IsCorrupt() const
+	{
+		return bCorrupt;
+	}
+
+	/**
+	 * Checks whether the consumer has records to read.
+	 *
+	 * @return true if the ring is empty, false otherwise.
+	 */
+	bool IsEmpty() const
+	{
+		return Header == nullptr || FPlatformAtomics::AtomicRead(&Header->Head) == Header->Tail;
+	}
+
+	/**
+	 * Gets the largest record that can be written.
+	 *
+	 * @return Maximum payload size.
+	 */
+	int32 GetMaxRecordSize() const
+	{
+		return static_cast<int32>(Capacity / 2) - sizeof(uint32);
+	}
+
+public:
+	/**
+	 * Writes a record (producer side).
+	 *
+	 * @param Src The payload to write.
+	 * @param Size The size of the payload.
+	 * @return true if the record was written, false if the ring is full or the record is too large.
+	 */
+	bool Write(const void* Src, const int32 Size)
+	{
+		if (Header == nullptr || Size > GetMaxRecordSize())
+		{
+			return false;
+		}
+
+		const auto Needed = static_cast<int64>(Align(sizeof(uint32) + Size, RecordAlignment));
+		const auto Head = Header->Head;
+		const auto Tail = FPlatformAtomics::AtomicRead(&Header->Tail);
+
+		auto Offset = static_cast<int64>(Head & (Capacity - 1));
+		const auto Contiguous = static_cast<int64>(Capacity) - Offset;
+		const auto Total = Needed + (Contiguous < Needed ? Contiguous : 0);
+
+		if (Head + Total - Tail > static_cast<int64>(Capacity))
+		{
+			return false;
+		}
+
+		if (Contiguous < Needed)
+		{
+			*reinterpret_cast<uint32*>(Data + Offset) = WrapMarker;
+			Offset = 0;
+		}
+
+		*reinterpret_cast<uint32*>(Data + Offset) = static_cast<uint32>(Size);
+		FMemory::Memcpy(Data + Offset + sizeof(uint32), Src, Size);
+
+		FPlatformAtomics::AtomicStore(&Header->Head, Head + Total);
+
+		return true;
+	}
+
+	/**
+	 * Reads all available records (consumer side).
+	 *
+	 * Each record is released as soon as the visitor returns, so the visitor must copy any data it keeps.
+	 * The control block and the record sizes are written by another process, so they are validated before
+	 * any record is passed on. Records that the producer cannot have written mark the ring corrupt.
+	 *
+	 * @param Visitor The function to call with the address and size of each record.
+	 * @return The number of records read.
+	 * @see IsCorrupt
+	 */
+	template <typename VisitorType>
+	int32 Read(VisitorType&& Visitor)
+	{
+		if (Header == nullptr || bCorrupt)
+		{
+			return 0;
+		}
+
+		auto NumRecords = 0;
+		auto Tail = Header->Tail;
+		const auto Head = FPlatformAtomics::AtomicRead(&Header->Head);
+
+		if (Head - Tail > static_cast<int64>(Capacity))
+		{
+			bCorrupt = true;
+
+			return 0;
+		}
+
+		while (Tail < Head)
+		{
+			const auto Offset = static_cast<int64>(Tail & (Capacity - 1));
+			const auto Size = *reinterpret_cast<const uint32*>(Data + Offset);
+
+			if (Size == WrapMarker)
+			{
+				Tail += static_cast<int64>(Capacity) - Offset;
+
+				continue;
+			}
+
+			const auto Advance = static_cast<int64>(Align(sizeof(uint32) + static_cast<uint64>(Size), RecordAlignment));
+
+			if (Size > static_cast<uint32>(GetMaxRecordSize()) ||
+				sizeof(uint32) + Size > static_cast<uint64>(Capacity - Offset) || Tail + Advance > Head)
+			{
+				bCorrupt = true;
+
+				break;
+			}
+
+			Visitor(Data + Offset + sizeof(uint32), static_cast<int32>(Size));
+
+			Tail += Advance;
+			++NumRecords;
+
+			FPlatformAtomics::AtomicStore(&Header->Tail, Tail);
+		}
+
+		FPlatformAtomics::AtomicStore(&Header->Tail, Tail);
+
+		return NumRecords;
+	}
+
+public:
+	/**
+	 * Maps a named shared memory region, creating it only if it does not exist yet.
+	 *
+	 * On Unix, the engine unlinks regions that were mapped with its create flag as soon as they are unmapped,
+	 * even while other processes still use them. Regions are therefore created here and only ever opened
+	 * through the engine, and their names stay linked until UnlinkRegion() is called.
+	 *
+	 * @param Name The name of the region.
+	 * @param Size The size of the region.
+	 * @return The region, or nullptr if it could not be mapped.
+	 * @see UnlinkRegion
+	 */
+	static FPlatformMemory::FSharedMemoryRegion* MapRegion(const FString& Name, SIZE_T Size);
+
+	/**
+	 * Removes the name of a shared memory region, so that processes that map it later get a new region.
+	 *
+	 * Existing mappings stay valid. Does nothing on platforms that release named regions with their last mapping.
+	 *
+	 * @param Name The name of the region.
+	 * @see MapRegion
+	 */
+	static void UnlinkRegion(const FString& Name);
+
+private:
+	/** Structure for the ring's control block, which precedes the data area. */
+	struct FHeader
+	{
+		/** Holds the number of bytes ever written (producer owned). */
+		alignas(PLATFORM_CACHE_LINE_SIZE) volatile int64 Head;
+
+		/** Holds the number of bytes ever read (consumer owned). */
+		alignas(PLATFORM_CACHE_LINE_SIZE) volatile int64 Tail;
+	};
+
+	/** The alignment of records. */
+	static constexpr uint32 RecordAlignment = 8;
+
+	/** The size value that marks the end of the usable space before a wrap. */
+	static constexpr uint32 WrapMarker = MAX_uint32;
+
+private:
+	/** Holds the shared memory region. */
+	FPlatformMemory::FSharedMemoryRegion* Region;
+
+	/** Holds the name of the shared memory region. */
+	FString RegionName;
+
+	/** Holds the control block. */
+	FHeader* Header;
+
+	/** Holds the data area. */
+	uint8* Data;
+
+	/** Holds the size of the data area. */
+	uint32 Capacity;
+
+	/** Holds a flag indicating whether the consumer found invalid records. */
+	bool bCorrupt;
+};
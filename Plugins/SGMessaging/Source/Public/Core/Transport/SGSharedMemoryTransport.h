@@ -0,0 +1,260 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Runnable.h"
+#include "Templates/Atomic.h"
+#include "Core/Interface/ISGMessageTransport.h"
+#include "Core/Serialization/SGMessageCompressor.h"
+#include "Core/Transport/SGSharedMemoryRing.h"
+
+class FRunnableThread;
+class ISGMessageTransportHandler;
+
+
+/**
+ * Implements a message transport between processes on the same host.
+ *
+ * All processes that use the same channel share a registry region with one slot per process, which
+ * holds the process's node identifier, a heartbeat and a doorbell. Each ordered pair of processes gets
+ * its own single-producer single-consumer ring, so messages are encoded once and copied straight into
+ * the recipient's memory without any system calls on the send path. Recipients are woken through the
+ * doorbell, using a futex on Linux and a named semaphore elsewhere, and only if they are actually waiting.
+ *
+ * Nodes are discovered when they claim a registry slot and forgotten when they release it, or when
+ * their heartbeat stops and their process is no longer running. The registry outlives the processes that
+ * created it, and is removed by the last process that leaves the channel.
+ *
+ * @see FSGWireWriter, ISGMessageTransport
+ */
+class SGMESSAGING_API FSGSharedMemoryTransport final
+	: public ISGMessageTransport
+	  , FRunnable
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InChannel The name of the channel to join; only processes on the same channel see each other.
+	 * @param InRingSize The size of each inbound ring in bytes (rounded up to a power of two).
+	 */
+	explicit FSGSharedMemoryTransport(const FString& InChannel = TEXT("Default"), uint32 InRingSize = 1024 * 1024);
+
+	/** Virtual destructor. */
+	virtual ~FSGSharedMemoryTransport() override;
+
+public:
+	/**
+	 * Changes the compression of outbound messages.
+	 *
+	 * Must be called before the transport is started.
+	 *
+	 * @param Format The compression format (NAME_None disables compression).
+	 * @param Threshold The encoded size in bytes above which messages are compressed.
+	 * @see GetCompressionStats
+	 */
+	void SetCompression(const FName& Format, const int32 Threshold)
+	{
+		Compressor.Configure(Format, Threshold);
+	}
+
+	/**
+	 * Gets the compression statistics of this transport.
+	 *
+	 * @return The statistics.
+	 * @see SetCompression
+	 */
+	FSGMessageCompressionStats GetCompressionStats() const
+	{
+		return Compressor.GetStats();
+	}
+
+public:
+	//~ ISGMessageTransport interface
+
+	virtual FName GetDebugName() const override;
+	virtual bool StartTransport(ISGMessageTransportHandler& Handler) override;
+	virtual void StopTransport() override;
+	virtual bool TransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	                              TArrayView<const FGuid> Recipients) override;
+
+protected:
+	//~ FRunnable interface
+
+	virtual bool Init() override;
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/** Structure for a process's entry in the registry. */
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FSlot
+	{
+		/** Holds the slot state (see ESlotState). */
+		volatile int32 State;
+
+		/** Holds a counter that is incremented whenever data was written to the slot owner's rings. */
+		volatile int32 Doorbell;
+
+		/** Holds a flag indicating whether the slot owner is waiting on the doorbell. */
+		volatile int32 Waiting;
+
+		/** Holds the size of the slot owner's inbound rings. */
+		uint32 RingSize;
+
+		/** Holds the identifier of the owning process. */
+		uint32 ProcessId;
+
+		/** Holds the transport node identifier of the owning process. */
+		FGuid NodeId;
+
+		/** Holds a counter that the owner increments while it is alive. */
+		volatile int64 Heartbeat;
+	};
+
+	/** Structure for the registry's control block, which precedes the slots. */
+	struct alignas(PLATFORM_CACHE_LINE_SIZE) FRegistryHeader
+	{
+		/** Holds the registry layout identifier. */
+		volatile int32 Magic;
+	};
+
+	/** Structure for a connected process. */
+	struct FPeer
+	{
+		/** Default constructor. */
+		FPeer()
+			: Wakeup(nullptr)
+		{
+		}
+
+		/** Destructor. */
+		~FPeer()
+		{
+			// senders may still ring the doorbell after the peer was forgotten
+			if (Wakeup != nullptr)
+			{
+				FPlatformProcess::DeleteInterprocessSynchObject(Wakeup);
+			}
+		}
+
+		/** Holds the peer's transport node identifier. */
+		FGuid NodeId;
+
+		/** Holds the peer's registry slot. */
+		int32 Slot;
+
+		/** Holds the peer's process identifier. */
+		uint32 ProcessId;
+
+		/** Holds the ring that this process writes to. */
+		FSGSharedMemoryRing Outbound;
+
+		/** Holds the ring that the peer writes to. */
+		FSGSharedMemoryRing Inbound;
+
+		/** Serializes writers of the outbound ring. */
+		FCriticalSection OutboundLock;
+
+		/** Holds the semaphore that wakes the peer, if futexes are not available. */
+		FPlatformProcess::FSemaphore* Wakeup;
+
+		/** Holds the last heartbeat value that was observed. */
+		int64 LastHeartbeat;
+
+		/** Holds the time at which the heartbeat last changed. */
+		double LastHeartbeatTime;
+	};
+
+	/** Enumerates registry slot states. */
+	enum ESlotState : int32
+	{
+		Free = 0,
+		Claiming = 1,
+		Active = 2
+	};
+
+private:
+	/** Claims a registry slot for this process. */
+	bool ClaimSlot();
+
+	/** Releases this process's registry slot. */
+	void ReleaseSlot();
+
+	/** Checks whether any live process holds a registry slot. */
+	bool IsRegistryInUse() const;
+
+	/** Discovers new peers and forgets lost ones. */
+	void UpdatePeers();
+
+	/** Reads all messages from the inbound rings. */
+	bool ReceiveMessages();
+
+	/** Waits until the doorbell rings or the timeout expires. */
+	void WaitForDoorbell(int32 Doorbell, uint32 TimeoutMs);
+
+	/** Wakes up the given peer. */
+	void RingDoorbell(FPeer& Peer);
+
+	/** Gets the registry slot at the given index. */
+	FSlot& GetSlot(int32 Index) const;
+
+	/** Gets the name of the channel's registry region. */
+	FString GetRegistryName() const;
+
+	/** Gets the name of the ring that carries messages from one node to another. */
+	FString GetRingName(const FGuid& From, const FGuid& To) const;
+
+	/** Gets the name of the semaphore that wakes up a node. */
+	FString GetWakeupName(const FGuid& InNodeId) const;
+
+private:
+	/** The maximum number of processes per channel. */
+	static constexpr int32 MaxSlots = 32;
+
+	/** The time after which a peer with a stopped heartbeat is checked for liveness. */
+	static constexpr double HeartbeatTimeout = 3.0;
+
+	/** Holds the channel name. */
+	FString Channel;
+
+	/** Holds the size of the inbound rings. */
+	uint32 RingSize;
+
+	/** Holds this process's transport node identifier. */
+	FGuid NodeId;
+
+	/** Holds the registry region. */
+	FPlatformMemory::FSharedMemoryRegion* Registry;
+
+	/** Holds this process's registry slot. */
+	int32 SlotIndex;
+
+	/** Holds the semaphore that wakes up this process, if futexes are not available. */
+	FPlatformProcess::FSemaphore* Wakeup;
+
+	/** Holds the connected peers. */
+	TArray<TSharedPtr<FPeer, ESPMode::ThreadSafe>> Peers;
+
+	/** Protects the peer list. */
+	mutable FCriticalSection PeersLock;
+
+	/** Holds the nodes whose rings were corrupt, which are not discovered again. */
+	TSet<FGuid> CorruptNodes;
+
+	/** Holds the handler of inbound messages and node events. */
+	ISGMessageTransportHandler* TransportHandler;
+
+	/** Holds the receive thread. */
+	FRunnableThread* Thread;
+
+	/** Holds a flag indicating that the thread is stopping. */
+	TAtomic<bool> Stopping;
+
+	/** Holds the time at which peers were last updated. */
+	double LastPeerUpdateTime;
+
+	/** Holds the compressor that encodes and decodes messages. */
+	FSGMessageCompressor Compressor;
+};
@@ -0,0 +1,288 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Templates/Atomic.h"
+#include "Core/Interface/ISGMessageTransport.h"
+#include "Core/Serialization/SGMessageCompressor.h"
+
+class FEvent;
+class FInternetAddr;
+class FRunnableThread;
+class FSocket;
+class ISGMessageTransportHandler;
+
+
+/**
+ * Implements a message transport over TCP and UDP sockets.
+ *
+ * Every node listens for stream connections and receives datagrams on its listen endpoint, and connects to
+ * a list of static endpoints. After a connection has been established, both sides exchange a hello frame
+ * carrying their node identifier and datagram port, after which the peer is discovered. Messages that are
+ * too large for a datagram are sent over the stream connection, all other messages are sent as datagrams
+ * and may be lost. Bridges acknowledge and retransmit reliable messages themselves, so that they do not
+ * suffer from the head-of-line blocking of the stream.
+ *
+ * Messages are encoded once on the sending thread and queued for each peer as length-prefixed frames. A
+ * dedicated I/O thread coalesces the queued datagram frames of a peer into as few datagrams as possible,
+ * sends streamed frames straight from their encoded buffers, and reads and decodes inbound frames. Frames
+ * for a peer whose queues hold more than a limit are dropped, so that a slow peer cannot make the queues
+ * grow without bounds. Sending fails if a message was dropped for all of its recipients, which attachment
+ * transfers take as a signal to back off, and bridges retransmit reliable messages that were dropped.
+ *
+ *		Frame       Size:uint32 Type:uint8 Payload
+ *		Hello       Magic:uint32 NodeId:guid DatagramPort:uint16
+ *		Datagram    Magic:uint32 NodeId:guid Frame*
+ *
+ * @see FSGMessageWireFormat, ISGMessageTransport
+ */
+class SGMESSAGING_API FSGSocketTransport final
+	: public ISGMessageTransport
+	  , FRunnable
+{
+public:
+	/**
+	 * Creates and initializes a new instance.
+	 *
+	 * @param InListenEndpoint The endpoint to listen on; port 0 picks a free port.
+	 * @param InStaticEndpoints The endpoints of the nodes to connect to.
+	 */
+	FSGSocketTransport(const FIPv4Endpoint& InListenEndpoint, const TArray<FIPv4Endpoint>& InStaticEndpoints);
+
+	/** Virtual destructor. */
+	virtual ~FSGSocketTransport() override;
+
+public:
+	/**
+	 * Gets the endpoint that this transport listens on.
+	 *
+	 * @return The listen endpoint, including the actual port if port 0 was requested.
+	 */
+	FIPv4Endpoint GetListenEndpoint() const;
+
+	/**
+	 * Gets the number of peers that completed the handshake.
+	 *
+	 * @return Number of connected peers.
+	 */
+	int32 GetNumPeers() const;
+
+	/**
+	 * Changes the compression of outbound messages.
+	 *
+	 * Must be called before the transport is started.
+	 *
+	 * @param Format The compression format (NAME_None disables compression).
+	 * @param Threshold The encoded size in bytes above which messages are compressed.
+	 * @see GetCompressionStats
+	 */
+	void SetCompression(const FName& Format, const int32 Threshold)
+	{
+		Compressor.Configure(Format, Threshold);
+	}
+
+	/**
+	 * Gets the compression statistics of this transport.
+	 *
+	 * @return The statistics.
+	 * @see SetCompression
+	 */
+	FSGMessageCompressionStats GetCompressionStats() const
+	{
+		return Compressor.GetStats();
+	}
+
+	/**
+	 * Gets the number of messages that were dropped because the queues of a peer were full.
+	 *
+	 * A message that is sent to several peers is counted once for every peer that it was dropped for.
+	 *
+	 * @return Number of dropped messages.
+	 */
+	int64 GetNumMessagesDropped() const
+	{
+		return NumMessagesDropped.Load(EMemoryOrder::Relaxed);
+	}
+
+public:
+	//~ ISGMessageTransport interface
+
+	virtual FName GetDebugName() const override;
+	virtual bool StartTransport(ISGMessageTransportHandler& Handler) override;
+	virtual void StopTransport() override;
+	virtual bool TransportMessage(const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context,
+	                              TArrayView<const FGuid> Recipients) override;
+
+protected:
+	//~ FRunnable interface
+
+	virtual bool Init() override;
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	/** Type definition for shared pointers to encoded frames. */
+	typedef TSharedPtr<TArray<uint8>, ESPMode::ThreadSafe> FFramePtr;
+
+	/** Structure for a stream connection to a peer. */
+	struct FConnection
+	{
+		/** Holds the connection's socket. */
+		FSocket* Socket;
+
+		/** Holds the endpoint that was connected to, if the connection is outbound. */
+		FIPv4Endpoint Endpoint;
+
+		/** Holds a flag indicating whether this node initiated the connection. */
+		bool bOutbound;
+
+		/** Holds a flag indicating whether the connection has been established. */
+		bool bConnected;
+
+		/** Holds a flag indicating whether the connection was superseded and should be closed. */
+		bool bClose;
+
+		/** Holds the time at which the connection was initiated. */
+		double ConnectTime;
+
+		/** Holds the peer's transport node identifier, once the peer's hello was received. */
+		FGuid NodeId;
+
+		/** Holds the address that datagrams for the peer are sent to. */
+		TSharedPtr<FInternetAddr> DatagramAddress;
+
+		/** Holds received bytes that do not form a complete frame yet. */
+		TArray<uint8> ReceiveBuffer;
+
+		/** Holds the stream frame that is being sent. */
+		FFramePtr SendFrame;
+
+		/** Holds the number of bytes of the stream frame that were already sent. */
+		int32 SendOffset;
+
+		/** Holds the number of bytes of the frames that are queued but not sent yet. */
+		TAtomic<int64> QueuedBytes{0};
+
+		/** Holds frames to be sent over the stream. */
+		TQueue<FFramePtr, EQueueMode::Mpsc> StreamFrames;
+
+		/** Holds frames to be sent as datagrams. */
+		TQueue<FFramePtr, EQueueMode::Mpsc> DatagramFrames;
+	};
+
+	/** Type definition for shared pointers to connections. */
+	typedef TSharedPtr<FConnection, ESPMode::ThreadSafe> FConnectionPtr;
+
+	/** Structure for a configured endpoint that this node keeps a connection to. */
+	struct FStaticEndpoint
+	{
+		/** Holds the endpoint. */
+		FIPv4Endpoint Endpoint;
+
+		/** Holds the current connection, if any. */
+		FConnectionPtr Connection;
+
+		/** Holds the identifier of the node at the endpoint, once known. */
+		FGuid NodeId;
+
+		/** Holds the time of the next connection attempt. */
+		double NextConnectTime;
+	};
+
+	/** Enumerates frame types. */
+	enum class EFrameType : uint8
+	{
+		Hello = 0,
+		Message = 1
+	};
+
+private:
+	/** Accepts pending inbound connections. */
+	void AcceptConnections();
+
+	/** Connects to static endpoints that are not connected. */
+	void ConnectStaticEndpoints(double Now);
+
+	/** Adds a connection and queues the hello frame. */
+	void AddConnection(const FConnectionPtr& Connection);
+
+	/** Closes a connection and forgets its peer. */
+	void CloseConnection(const FConnectionPtr& Connection);
+
+	/** Reads and handles frames from all stream connections. */
+	bool ReceiveStreams();
+
+	/** Reads and handles all pending datagrams. */
+	bool ReceiveDatagrams();
+
+	/** Sends the queued frames of all connections. */
+	bool SendFrames();
+
+	/** Sends the queued stream frames of a connection. */
+	bool SendStreamFrames(FConnection& Connection, bool& bOutActive);
+
+	/** Coalesces and sends the queued datagram frames of a connection. */
+	bool SendDatagramFrames(FConnection& Connection);
+
+	/** Handles the frames in a buffer and returns the number of bytes consumed, or INDEX_NONE on protocol errors. */
+	int32 HandleFrames(const FConnectionPtr& Connection, const uint8* Data, int32 Size);
+
+	/** Handles a peer's hello frame. */
+	bool HandleHello(const FConnectionPtr& Connection, const uint8* Data, int32 Size);
+
+	/** Decodes a message frame and passes it to the transport handler. */
+	void HandleMessage(const FGuid& InNodeId, const uint8* Data, int32 Size);
+
+private:
+	/** Holds the endpoint to listen on. */
+	FIPv4Endpoint ListenEndpoint;
+
+	/** Holds the endpoints to connect to. */
+	TArray<FStaticEndpoint> StaticEndpoints;
+
+	/** Holds this node's transport node identifier. */
+	FGuid NodeId;
+
+	/** Holds the socket that accepts stream connections. */
+	FSocket* ListenSocket;
+
+	/** Holds the socket that sends and receives datagrams. */
+	FSocket* DatagramSocket;
+
+	/** Holds all stream connections (I/O thread only). */
+	TArray<FConnectionPtr> Connections;
+
+	/** Holds the connections of peers that completed the handshake. */
+	TMap<FGuid, FConnectionPtr> Nodes;
+
+	/** Protects the node table; the I/O thread is the only writer. */
+	mutable FCriticalSection NodesLock;
+
+	/** Holds a scratch buffer for receiving. */
+	TArray<uint8> ReceiveScratch;
+
+	/** Holds a scratch buffer for coalescing datagrams. */
+	TArray<uint8> DatagramScratch;
+
+	/** Holds the handler of inbound messages and node events. */
+	ISGMessageTransportHandler* TransportHandler;
+
+	/** Holds an event signaling that frames were queued. */
+	FEvent* WorkEvent;
+
+	/** Holds the I/O thread. */
+	FRunnableThread* Thread;
+
+	/** Holds a flag indicating that the thread is stopping. */
+	TAtomic<bool> Stopping;
+
+	/** Holds the number of messages that were dropped because the queues of a peer were full. */
+	TAtomic<int64> NumMessagesDropped;
+
+	/** Holds the compressor that encodes and decodes messages. */
+	FSGMessageCompressor Compressor;
+};
@@ -11,7 +11,16 @@ namespace UnrealBuildTool.Rules
 				{
 					"Core",
 					"CoreUObject",
-					"Engine"
+					"Engine",
+					"Networking",
+					"Sockets",
+					"TraceLog"
+				});
+
+			PrivateDependencyModuleNames.AddRange(
+				new string[]
+				{
+					"Json"
 				});
 		}
 	}
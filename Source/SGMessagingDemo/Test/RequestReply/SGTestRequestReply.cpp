@@ -33,9 +33,6 @@ void ASGTestRequestReply::BeginPlay()
 	{
 		MessageEndpointComponent->Subscribe(Topic_RequestReply, TopicRequestReply_Request, this,
 		                                    &ASGTestRequestReply::OnRequest);
-
-		MessageEndpointComponent->Subscribe(Topic_RequestReply, TopicRequestReply_Reply, this,
-		                                    &ASGTestRequestReply::OnReply);
 	}
 }
 
@@ -47,22 +44,28 @@ void ASGTestRequestReply::Tick(float DeltaTime)
 
 void ASGTestRequestReply::OnDelegateBroadcast()
 {
-	TArray<FSGMessageAddress> Recipients;
+	if (MessageEndpointComponent == nullptr)
+	{
+		return;
+	}
 
 	for (TActorIterator<ASGTestRequestReply> Iterator(GetWorld()); Iterator; ++Iterator)
 	{
 		if (const auto Component = Cast<USGMessageEndpointComponent>(
 			Iterator->GetComponentByClass(USGMessageEndpointComponent::StaticClass())))
 		{
-			Recipients.Add(Component->GetAddress());
-		}
-	}
+			FSGMessageRequest Request = MessageEndpointComponent->Request(
+				Topic_RequestReply, TopicRequestReply_Request, Component->GetAddress(), FTimespan::FromSeconds(1.0),
+				DEFAULT_SEND_PARAMETER, "Val", FString("Request-Reply Request"));
 
-	if (MessageEndpointComponent != nullptr)
-	{
-		MessageEndpointComponent->Send(Topic_RequestReply, TopicRequestReply_Request, Recipients,
-		                               DEFAULT_SEND_PARAMETER, "Val",
-		                               FString("Request-Reply Request"));
+			Request.Future.Next([WeakThis = TWeakObjectPtr<ASGTestRequestReply>(this)](const FSGMessageReply& Reply)
+			{
+				if (WeakThis.IsValid())
+				{
+					WeakThis->OnReply(Reply);
+				}
+			});
+		}
 	}
 }
 
@@ -75,16 +78,22 @@ void ASGTestRequestReply::OnRequest(const FSGMessage& Message,
 
 	if (MessageEndpointComponent != nullptr)
 	{
-		MessageEndpointComponent->Send(Topic_RequestReply, TopicRequestReply_Reply, Context->GetSender(),
-		                               DEFAULT_SEND_PARAMETER,
-		                               "Val", FString("Request-Reply Reply"));
+		MessageEndpointComponent->Reply(Context, Topic_RequestReply, TopicRequestReply_Reply, DEFAULT_SEND_PARAMETER,
+		                                "Val", FString("Request-Reply Reply"));
 	}
 }
 
-void ASGTestRequestReply::OnReply(const FSGMessage& Message,
-                                  const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+void ASGTestRequestReply::OnReply(const FSGMessageReply& Reply)
 {
-	UE_LOG(LogTemp, Log, TEXT("ASGTestRequestReply::OnReply IsDedicatedServer:%s Name:%s => %s"),
-	       *UKismetStringLibrary::Conv_BoolToString(UKismetSystemLibrary::IsDedicatedServer(GetWorld())), *GetName(),
-	       *Message.Get<FString>("Val"));
+	if (const FSGMessage* Message = Reply.GetMessage())
+	{
+		UE_LOG(LogTemp, Log, TEXT("ASGTestRequestReply::OnReply IsDedicatedServer:%s Name:%s => %s"),
+		       *UKismetStringLibrary::Conv_BoolToString(UKismetSystemLibrary::IsDedicatedServer(GetWorld())),
+		       *GetName(), *Message->Get<FString>("Val"));
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ASGTestRequestReply::OnReply Name:%s => %s"), *GetName(),
+		       Reply.Result == ESGMessageRequestResult::TimedOut ? TEXT("timed out") : TEXT("cancelled"));
+	}
 }
@@ -31,7 +31,7 @@ private:
 private:
 	void OnRequest(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context);
 
-	void OnReply(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context);
+	void OnReply(const FSGMessageReply& Reply);
 
 private:
 	UPROPERTY()
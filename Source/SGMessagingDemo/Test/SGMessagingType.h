@@ -21,7 +21,8 @@ enum ETopicID
 	Topic_BlueprintDelayRequestReply,
 	Topic_BlueprintDelayForwardReply,
 	Topic_Parameter,
-	Topic_Unsubscribe
+	Topic_Unsubscribe,
+	Topic_Soak
 };
 
 UENUM(BlueprintType)
@@ -119,3 +120,13 @@ enum ETopicUnsubscribe_MessageID
 	TopicUnsubscribe_Cpp,
 	TopicUnsubscribe_BP,
 };
+
+UENUM(BlueprintType)
+enum ETopicSoak_MessageID
+{
+	TopicSoak_Broadcast,
+	TopicSoak_Request,
+	TopicSoak_Reply,
+	// group message identifiers follow, one per group
+	TopicSoak_Group
+};
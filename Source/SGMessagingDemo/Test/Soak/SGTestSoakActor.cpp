@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SGTestSoakActor.h"
+#include "SGMessagingDemo/Test/SGMessagingType.h"
+
+// Sets default values
+ASGTestSoakActor::ASGTestSoakActor()
+	: Stats(nullptr)
+	  , Group(INDEX_NONE)
+{
+	// Soak actors only react to messages, thousands of them must not tick.
+	PrimaryActorTick.bCanEverTick = false;
+
+	MessageEndpointComponent = CreateDefaultSubobject<USGMessageEndpointComponent>(TEXT("MessageEndpointComponent"));
+}
+
+void ASGTestSoakActor::Setup(FSGTestSoakStats* InStats, const int32 InGroup)
+{
+	Stats = InStats;
+	Group = InGroup;
+}
+
+void ASGTestSoakActor::Subscribe()
+{
+	if (MessageEndpointComponent != nullptr)
+	{
+		MessageEndpointComponent->Subscribe(Topic_Soak, GetSampleId(), this, &ASGTestSoakActor::OnSample);
+
+		MessageEndpointComponent->Subscribe(Topic_Soak, TopicSoak_Request, this, &ASGTestSoakActor::OnRequest);
+	}
+}
+
+void ASGTestSoakActor::Unsubscribe()
+{
+	if (MessageEndpointComponent != nullptr)
+	{
+		MessageEndpointComponent->Unsubscribe(Topic_Soak, GetSampleId(), this, &ASGTestSoakActor::OnSample);
+
+		MessageEndpointComponent->Unsubscribe(Topic_Soak, TopicSoak_Request, this, &ASGTestSoakActor::OnRequest);
+	}
+}
+
+FSGMessageAddress ASGTestSoakActor::GetAddress() const
+{
+	return MessageEndpointComponent != nullptr ? MessageEndpointComponent->GetAddress() : FSGMessageAddress();
+}
+
+// Called when the game starts or when spawned
+void ASGTestSoakActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Subscribe();
+}
+
+void ASGTestSoakActor::OnSample(const FSGMessage& Message,
+                                const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+{
+	if (Stats != nullptr)
+	{
+		Stats->RecordDelivery(FPlatformTime::Seconds() - Message.Get<double>("Time"));
+	}
+}
+
+void ASGTestSoakActor::OnRequest(const FSGMessage& Message,
+                                 const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+{
+	if (MessageEndpointComponent != nullptr)
+	{
+		MessageEndpointComponent->Send(Topic_Soak, TopicSoak_Reply, Context->GetSender(), DEFAULT_SEND_PARAMETER,
+		                               "Time", Message.Get<double>("Time"));
+	}
+}
+
+int32 ASGTestSoakActor::GetSampleId() const
+{
+	return Group == INDEX_NONE ? static_cast<int32>(TopicSoak_Broadcast) : TopicSoak_Group + Group;
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Core/Bus/SGMessageLatencyHistogram.h"
+#include "MessagingFramework/Components/SGMessageEndpointComponent.h"
+#include "SGTestSoakActor.generated.h"
+
+/**
+ * Collects the deliveries and latencies of a soak run.
+ *
+ * Deliveries are recorded on the game thread by soak actors and on any thread by producers. Latencies are counted in
+ * a lock-free histogram, so recording takes neither a lock nor memory that grows with the length of the run.
+ */
+struct FSGTestSoakStats
+{
+	/** Holds the number of deliveries that producers expect. */
+	TAtomic<int64> NumExpected{0};
+
+	/** Holds the number of deliveries. */
+	TAtomic<int64> NumDelivered{0};
+
+	/** Records a delivery and its latency in seconds. */
+	void RecordDelivery(const double Latency)
+	{
+		++NumDelivered;
+
+		Latencies.Record(static_cast<uint64>(FMath::Max(Latency, 0.0) * 1000000.0));
+	}
+
+	/** Gets a summary of the latencies recorded so far, in microseconds. */
+	FSGMessageTracerLatencySummary GetLatencySummary() const
+	{
+		return Latencies.GetSummary();
+	}
+
+	/** Resets the counters and the latencies. */
+	void Reset()
+	{
+		NumExpected = 0;
+		NumDelivered = 0;
+
+		Latencies.Reset();
+	}
+
+private:
+	/** Holds the latencies in microseconds. */
+	FSGMessageLatencyHistogram Latencies;
+};
+
+
+/**
+ * Actor with a message endpoint component that takes part in soak runs.
+ *
+ * Like ASGTestPublishSubscribe it handles published samples, either of all producers or of its group, and like
+ * ASGTestRequestReply it replies to requests that are sent to it directly.
+ */
+UCLASS()
+class SGMESSAGINGDEMO_API ASGTestSoakActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ASGTestSoakActor();
+
+public:
+	/**
+	 * Sets up the actor before it finishes spawning.
+	 *
+	 * @param InStats The statistics to record deliveries in.
+	 * @param InGroup The group to subscribe to, or INDEX_NONE to subscribe to broadcasts.
+	 */
+	void Setup(FSGTestSoakStats* InStats, int32 InGroup);
+
+	/** Subscribes to the samples of the actor's group and to requests. */
+	void Subscribe();
+
+	/** Cancels the subscriptions. */
+	void Unsubscribe();
+
+	/** Gets the address of the actor's endpoint. */
+	FSGMessageAddress GetAddress() const;
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+private:
+	void OnSample(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context);
+
+	void OnRequest(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context);
+
+	/** Gets the message identifier of the actor's samples. */
+	int32 GetSampleId() const;
+
+private:
+	UPROPERTY()
+	USGMessageEndpointComponent* MessageEndpointComponent;
+
+	/** Holds the statistics of the run, which outlive the actor. */
+	FSGTestSoakStats* Stats;
+
+	/** Holds the group, or INDEX_NONE for broadcasts. */
+	int32 Group;
+};
@@ -0,0 +1,563 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SGTestSoakCommandlet.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "MessagingFramework/Kismet/SGMessageFunctionLibrary.h"
+#include "SGMessagingDemo/Test/SGMessagingType.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSGTestSoak, Log, All);
+
+namespace SGTestSoakCommandlet
+{
+	/** The number of seconds to wait for the router to take the subscriptions of all actors. */
+	constexpr double SubscribeTimeout = 60.0;
+
+	/** The number of seconds to wait for outstanding deliveries after the producers stopped. */
+	constexpr double DrainTimeout = 10.0;
+
+	/** The number of seconds a producer backs off at most, so that deliveries lost to churn cannot stall it. */
+	constexpr double BackoffTimeout = 0.1;
+
+	/** The traffic patterns. */
+	enum class EPattern : uint8
+	{
+		Broadcast,
+		Group,
+		Direct
+	};
+
+	/** Parses the name of a traffic pattern. */
+	bool ParsePattern(const FString& Name, EPattern& OutPattern)
+	{
+		if (Name == TEXT("Broadcast"))
+		{
+			OutPattern = EPattern::Broadcast;
+		}
+		else if (Name == TEXT("Group"))
+		{
+			OutPattern = EPattern::Group;
+		}
+		else if (Name == TEXT("Direct"))
+		{
+			OutPattern = EPattern::Direct;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	/** Parses a comma separated list of positive counts. */
+	TArray<int32> ParseCounts(const FString& List)
+	{
+		TArray<FString> Items;
+		List.ParseIntoArray(Items, TEXT(","));
+
+		TArray<int32> Counts;
+
+		for (const FString& Item : Items)
+		{
+			const int32 Count = FCString::Atoi(*Item);
+
+			if (Count > 0)
+			{
+				Counts.Add(Count);
+			}
+		}
+
+		return Counts;
+	}
+
+	/**
+	 * Implements a producer thread with its own endpoint.
+	 *
+	 * The producer sends as fast as it can, but backs off while more deliveries are outstanding than allowed, so
+	 * that the measured latencies are not dominated by an ever growing queue on the game thread.
+	 */
+	class FProducer
+		: public FRunnable
+	{
+	public:
+		/** Creates and initializes a new instance, which starts producing right away. */
+		FProducer(const int32 InIndex, const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& Bus,
+		          const EPattern InPattern, const TArray<FSGMessageAddress>& InRecipients,
+		          const TArray<int32>& InGroupSizes, const int64 InMaxInFlight, FSGTestSoakStats& InStats)
+			: Index(InIndex)
+			  , Pattern(InPattern)
+			  , Recipients(InRecipients)
+			  , GroupSizes(InGroupSizes)
+			  , MaxInFlight(InMaxInFlight)
+			  , Stats(InStats)
+			  , NumSent(0)
+			  , Stopping(false)
+		{
+			const FString Name = FString::Printf(TEXT("SGTestSoak.Producer%d"), Index);
+
+			Endpoint = MakeShared<FSGMessageEndpoint, ESPMode::ThreadSafe>(*Name, Bus, FOnBusNotification());
+			Bus->Register(Endpoint->GetAddress(), Endpoint.ToSharedRef());
+
+			Endpoint->SetRecipientThread(ENamedThreads::AnyThread);
+			Endpoint->Subscribe(Topic_Soak, TopicSoak_Reply, this, &FProducer::HandleReply, ESGMessageScope::Process);
+
+			Thread = FRunnableThread::Create(this, *Name, 128 * 1024, TPri_Normal);
+		}
+
+		/** Destructor. */
+		virtual ~FProducer() override
+		{
+			if (Thread != nullptr)
+			{
+				Thread->Kill(true);
+				delete Thread;
+				Thread = nullptr;
+			}
+
+			FSGMessageEndpoint::SafeRelease(Endpoint);
+		}
+
+	public:
+		/** Gets the number of messages sent. */
+		int64 GetNumSent() const
+		{
+			return NumSent.Load(EMemoryOrder::Relaxed);
+		}
+
+	public:
+		//~ FRunnable interface
+
+		virtual uint32 Run() override
+		{
+			int64 Counter = Index;
+
+			while (!Stopping)
+			{
+				const double BackoffTime = FPlatformTime::Seconds();
+
+				while (!Stopping && (Stats.NumExpected.Load(EMemoryOrder::Relaxed) - Stats.NumDelivered.Load(
+					EMemoryOrder::Relaxed) > MaxInFlight) && (FPlatformTime::Seconds() - BackoffTime < BackoffTimeout))
+				{
+					FPlatformProcess::SleepNoStats(0.0001f);
+				}
+
+				// count the deliveries first, so that outstanding deliveries never go negative
+				switch (Pattern)
+				{
+				case EPattern::Broadcast:
+					Stats.NumExpected += Recipients.Num();
+					Endpoint->Publish(Topic_Soak, TopicSoak_Broadcast, DEFAULT_PUBLISH_PARAMETER, "Time",
+					                  FPlatformTime::Seconds());
+					break;
+
+				case EPattern::Group:
+					{
+						const int32 Group = Counter % GroupSizes.Num();
+
+						Stats.NumExpected += GroupSizes[Group];
+						Endpoint->Publish(Topic_Soak, TopicSoak_Group + Group, DEFAULT_PUBLISH_PARAMETER, "Time",
+						                  FPlatformTime::Seconds());
+					}
+					break;
+
+				case EPattern::Direct:
+					Stats.NumExpected += 1;
+					Endpoint->Send(Topic_Soak, TopicSoak_Request, Recipients[Counter % Recipients.Num()],
+					               DEFAULT_SEND_PARAMETER, "Time", FPlatformTime::Seconds());
+					break;
+				}
+
+				++Counter;
+				++NumSent;
+			}
+
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			Stopping = true;
+		}
+
+	private:
+		/** Handles a reply, whose latency is the round trip of the request. */
+		void HandleReply(const FSGMessage& Message, const TSharedRef<ISGMessageContext, ESPMode::ThreadSafe>& Context)
+		{
+			Stats.RecordDelivery(FPlatformTime::Seconds() - Message.Get<double>("Time"));
+		}
+
+	private:
+		/** Holds the index of the producer. */
+		int32 Index;
+
+		/** Holds the traffic pattern. */
+		EPattern Pattern;
+
+		/** Holds the addresses of the actors. */
+		TArray<FSGMessageAddress> Recipients;
+
+		/** Holds the number of actors in each group. */
+		TArray<int32> GroupSizes;
+
+		/** Holds the number of outstanding deliveries at which to back off. */
+		int64 MaxInFlight;
+
+		/** Holds the statistics of the run. */
+		FSGTestSoakStats& Stats;
+
+		/** Holds the number of messages sent. */
+		TAtomic<int64> NumSent;
+
+		/** Holds a flag indicating that the producer is stopping. */
+		TAtomic<bool> Stopping;
+
+		/** Holds the endpoint. */
+		TSharedPtr<FSGMessageEndpoint, ESPMode::ThreadSafe> Endpoint;
+
+		/** Holds the thread. */
+		FRunnableThread* Thread = nullptr;
+	};
+}
+
+
+/* USGTestSoakCommandlet structors
+ *****************************************************************************/
+
+USGTestSoakCommandlet::USGTestSoakCommandlet()
+	: Pattern(TEXT("Broadcast"))
+	  , NumGroups(16)
+	  , Seconds(5.0)
+	  , Churn(0.0)
+	  , MaxInFlight(100000)
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+/* UCommandlet interface
+ *****************************************************************************/
+
+int32 USGTestSoakCommandlet::Main(const FString& Params)
+{
+	using namespace SGTestSoakCommandlet;
+
+	FString EndpointsParam = TEXT("100,1000,10000");
+	FString ThreadsParam = TEXT("1,2,4,8");
+
+	FParse::Value(*Params, TEXT("Endpoints="), EndpointsParam);
+	FParse::Value(*Params, TEXT("Threads="), ThreadsParam);
+	FParse::Value(*Params, TEXT("Pattern="), Pattern);
+	FParse::Value(*Params, TEXT("Groups="), NumGroups);
+	FParse::Value(*Params, TEXT("Seconds="), Seconds);
+	FParse::Value(*Params, TEXT("Churn="), Churn);
+	FParse::Value(*Params, TEXT("MaxInFlight="), MaxInFlight);
+	FParse::Value(*Params, TEXT("Report="), ReportFilename);
+
+	EndpointCounts = ParseCounts(EndpointsParam);
+	ThreadCounts = ParseCounts(ThreadsParam);
+	NumGroups = FMath::Max(1, NumGroups);
+
+	EPattern ParsedPattern;
+
+	if (!ParsePattern(Pattern, ParsedPattern) || (EndpointCounts.Num() == 0) || (ThreadCounts.Num() == 0) || (Seconds
+		<= 0.0))
+	{
+		UE_LOG(LogSGTestSoak, Error,
+		       TEXT("Usage: -run=SGTestSoak [Endpoints=100,1000,10000] [Threads=1,2,4,8] [Pattern=Broadcast|Group|Direct] [Groups=16] [Seconds=5] [Churn=0] [MaxInFlight=100000] [Report=Filename]"
+		       ));
+
+		return 1;
+	}
+
+	if (ReportFilename.IsEmpty())
+	{
+		ReportFilename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Soak"),
+		                                 FString::Printf(TEXT("SGTestSoak-%s.csv"), *Pattern));
+	}
+	else if (FPaths::IsRelative(ReportFilename))
+	{
+		ReportFilename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Soak"), ReportFilename);
+	}
+
+	UWorld* World = CreateSoakWorld();
+	const USGBlueprintMessageBus* DefaultBus = USGMessageFunctionLibrary::GetDefaultBus(World);
+
+	if (DefaultBus == nullptr)
+	{
+		UE_LOG(LogSGTestSoak, Error, TEXT("The soak world has no default message bus"));
+
+		DestroySoakWorld(World);
+
+		return 1;
+	}
+
+	const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe> Bus = *DefaultBus;
+	TArray<FRunResult> Results;
+
+	for (const int32 NumEndpoints : EndpointCounts)
+	{
+		FRunResult Storm;
+		Storm.NumEndpoints = NumEndpoints;
+
+		double StartTime = FPlatformTime::Seconds();
+		SpawnActors(World, NumEndpoints);
+		Storm.SpawnTime = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		StartTime = FPlatformTime::Seconds();
+
+		if (!WaitForSubscriptions(Bus))
+		{
+			UE_LOG(LogSGTestSoak, Warning, TEXT("The router did not take all subscriptions of %d actors within %.0f s"),
+			       NumEndpoints, SubscribeTimeout);
+		}
+
+		Storm.SubscribeTime = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		UE_LOG(LogSGTestSoak, Display, TEXT("Spawned %d actors in %.1f ms, subscribed in %.1f ms"), NumEndpoints,
+		       Storm.SpawnTime, Storm.SubscribeTime);
+
+		const int32 FirstResult = Results.Num();
+
+		for (const int32 NumThreads : ThreadCounts)
+		{
+			FRunResult& Result = Results.Add_GetRef(Storm);
+			Result.NumThreads = NumThreads;
+
+			Run(World, Bus, NumThreads, Result);
+		}
+
+		StartTime = FPlatformTime::Seconds();
+		DespawnActors();
+		const double DespawnTime = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+		for (int32 ResultIndex = FirstResult; ResultIndex < Results.Num(); ++ResultIndex)
+		{
+			Results[ResultIndex].DespawnTime = DespawnTime;
+		}
+	}
+
+	DestroySoakWorld(World);
+
+	Report(Results);
+
+	return 0;
+}
+
+
+/* USGTestSoakCommandlet implementation
+ *****************************************************************************/
+
+UWorld* USGTestSoakCommandlet::CreateSoakWorld() const
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SGTestSoak"));
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	return World;
+}
+
+void USGTestSoakCommandlet::DestroySoakWorld(UWorld* World) const
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void USGTestSoakCommandlet::SpawnActors(UWorld* World, const int32 NumEndpoints)
+{
+	Actors.Reserve(NumEndpoints);
+
+	for (int32 Index = 0; Index < NumEndpoints; ++Index)
+	{
+		// actors must know their group before they subscribe in BeginPlay
+		ASGTestSoakActor* Actor = World->SpawnActorDeferred<ASGTestSoakActor>(
+			ASGTestSoakActor::StaticClass(), FTransform::Identity);
+
+		Actor->Setup(&Stats, Pattern == TEXT("Group") ? Index % NumGroups : INDEX_NONE);
+		Actor->FinishSpawning(FTransform::Identity);
+
+		Actors.Add(Actor);
+	}
+}
+
+void USGTestSoakCommandlet::DespawnActors()
+{
+	for (ASGTestSoakActor* Actor : Actors)
+	{
+		Actor->Destroy();
+	}
+
+	Actors.Reset();
+
+	// the endpoints unregister when their components are collected
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+bool USGTestSoakCommandlet::WaitForSubscriptions(const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& Bus) const
+{
+	using namespace SGTestSoakCommandlet;
+
+	// every actor subscribes to requests last
+	const FName RequestTag = FSGMessageTagBuilder::Builder(Topic_Soak, TopicSoak_Request);
+	const double StartTime = FPlatformTime::Seconds();
+
+	while (FPlatformTime::Seconds() - StartTime < SubscribeTimeout)
+	{
+		TFuture<FSGMessageBusSnapshot> Future = Bus->TakeSnapshot();
+
+		if (Future.WaitFor(FTimespan::FromSeconds(SubscribeTimeout)))
+		{
+			for (const FSGMessageBusTagSnapshot& Tag : Future.Get().Tags)
+			{
+				if ((Tag.MessageTag == RequestTag) && (Tag.NumSubscriptions - Tag.NumStaleSubscriptions >= Actors.
+					Num()))
+				{
+					return true;
+				}
+			}
+		}
+
+		FPlatformProcess::Sleep(0.01f);
+	}
+
+	return false;
+}
+
+void USGTestSoakCommandlet::Run(UWorld* World, const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& Bus,
+                                const int32 NumThreads, FRunResult& Result)
+{
+	using namespace SGTestSoakCommandlet;
+
+	EPattern ParsedPattern = EPattern::Broadcast;
+	ParsePattern(Pattern, ParsedPattern);
+
+	TArray<FSGMessageAddress> Recipients;
+	TArray<int32> GroupSizes;
+
+	Recipients.Reserve(Actors.Num());
+	GroupSizes.SetNumZeroed(ParsedPattern == EPattern::Group ? NumGroups : 1);
+
+	for (int32 Index = 0; Index < Actors.Num(); ++Index)
+	{
+		Recipients.Add(Actors[Index]->GetAddress());
+		++GroupSizes[Index % GroupSizes.Num()];
+	}
+
+	Stats.Reset();
+
+	TArray<TUniquePtr<FProducer>> Producers;
+
+	for (int32 Index = 0; Index < NumThreads; ++Index)
+	{
+		Producers.Add(MakeUnique<FProducer>(Index, Bus, ParsedPattern, Recipients, GroupSizes, MaxInFlight, Stats));
+	}
+
+	// the game thread dispatches the deliveries to the actors and churns their subscriptions
+	const double StartTime = FPlatformTime::Seconds();
+	double LastTime = StartTime;
+	double PendingChurn = 0.0;
+	int32 ChurnIndex = 0;
+
+	for (double CurrentTime = StartTime; CurrentTime - StartTime < Seconds; CurrentTime = FPlatformTime::Seconds())
+	{
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		World->Tick(LEVELTICK_All, static_cast<float>(CurrentTime - LastTime));
+
+		PendingChurn += Churn * (CurrentTime - LastTime);
+		LastTime = CurrentTime;
+
+		for (; PendingChurn >= 1.0; PendingChurn -= 1.0)
+		{
+			ASGTestSoakActor* Actor = Actors[ChurnIndex++ % Actors.Num()];
+
+			Actor->Unsubscribe();
+			Actor->Subscribe();
+		}
+	}
+
+	const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+	for (const auto& Producer : Producers)
+	{
+		Result.NumSent += Producer->GetNumSent();
+	}
+
+	Producers.Reset();
+
+	// deliveries lost to churn are never drained
+	const double DrainTime = FPlatformTime::Seconds();
+
+	while ((Stats.NumDelivered.Load() < Stats.NumExpected.Load()) && (FPlatformTime::Seconds() - DrainTime <
+		DrainTimeout))
+	{
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FPlatformProcess::SleepNoStats(0.001f);
+	}
+
+	Result.NumDelivered = Stats.NumDelivered.Load();
+	Result.Throughput = Result.NumDelivered / (ElapsedTime + FPlatformTime::Seconds() - DrainTime);
+
+	// the histogram reports microseconds
+	const FSGMessageTracerLatencySummary Latencies = Stats.GetLatencySummary();
+	Stats.Reset();
+
+	Result.P50 = Latencies.P50 / 1000.0;
+	Result.P99 = Latencies.P99 / 1000.0;
+	Result.Max = Latencies.Max / 1000.0;
+
+	UE_LOG(LogSGTestSoak, Display,
+	       TEXT("%d actors, %d threads: sent %lld, delivered %lld, %.0f/s, p50 %.3f ms, p99 %.3f ms, max %.3f ms"),
+	       Result.NumEndpoints, Result.NumThreads, Result.NumSent, Result.NumDelivered, Result.Throughput, Result.P50,
+	       Result.P99, Result.Max);
+}
+
+void USGTestSoakCommandlet::Report(const TArray<FRunResult>& Results) const
+{
+	const int32 NumCores = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+
+	TArray<FString> Lines;
+	Lines.Add(TEXT(
+		"Pattern,Cores,Endpoints,Threads,SpawnMs,SubscribeMs,DespawnMs,Sent,Delivered,PerSecond,P50Ms,P99Ms,MaxMs"));
+
+	UE_LOG(LogSGTestSoak, Display, TEXT("Soak report: %s on %d cores (%s)"), *Pattern, NumCores,
+	       *FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+	UE_LOG(LogSGTestSoak, Display, TEXT("%9s %7s %10s %12s %10s %12s %12s %10s %10s %10s"), TEXT("Endpoints"),
+	       TEXT("Threads"), TEXT("Spawn ms"), TEXT("Subscribe ms"), TEXT("Despawn ms"), TEXT("Delivered"),
+	       TEXT("Per second"), TEXT("p50 ms"), TEXT("p99 ms"), TEXT("max ms"));
+
+	for (const FRunResult& Result : Results)
+	{
+		UE_LOG(LogSGTestSoak, Display, TEXT("%9d %7d %10.1f %12.1f %10.1f %12lld %12.0f %10.3f %10.3f %10.3f"),
+		       Result.NumEndpoints, Result.NumThreads, Result.SpawnTime, Result.SubscribeTime, Result.DespawnTime,
+		       Result.NumDelivered, Result.Throughput, Result.P50, Result.P99, Result.Max);
+
+		Lines.Add(FString::Printf(TEXT("%s,%d,%d,%d,%.1f,%.1f,%.1f,%lld,%lld,%.0f,%.3f,%.3f,%.3f"), *Pattern, NumCores,
+		                          Result.NumEndpoints, Result.NumThreads, Result.SpawnTime, Result.SubscribeTime,
+		                          Result.DespawnTime, Result.NumSent, Result.NumDelivered, Result.Throughput,
+		                          Result.P50, Result.P99, Result.Max));
+	}
+
+	if (FFileHelper::SaveStringArrayToFile(Lines, *ReportFilename))
+	{
+		UE_LOG(LogSGTestSoak, Display, TEXT("Wrote the soak report to %s"), *ReportFilename);
+	}
+	else
+	{
+		UE_LOG(LogSGTestSoak, Warning, TEXT("Failed to write the soak report to %s"), *ReportFilename);
+	}
+}
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SGTestSoakActor.h"
+#include "SGTestSoakCommandlet.generated.h"
+
+/**
+ * Soaks the default message bus of a headless game world with thousands of endpoint actors.
+ *
+ * For every endpoint count the commandlet spawns the actors at once, waits for the router to take all of their
+ * subscriptions, and then runs the traffic pattern with every number of producer threads while the game thread
+ * dispatches the deliveries and churns subscriptions. Finally the actors are destroyed at once. The spawn, subscribe
+ * and despawn times, the throughput and the delivery latencies of every run are logged as a scaling report and
+ * written to a CSV file.
+ *
+ * Usage: UnrealEditor-Cmd <Project> -run=SGTestSoak -nullrhi -unattended [Endpoints=100,1000,10000]
+ *        [Threads=1,2,4,8] [Pattern=Broadcast|Group|Direct] [Groups=16] [Seconds=5] [Churn=0] [MaxInFlight=100000]
+ *        [Report=Filename]
+ *
+ * Broadcast publishes samples that every actor subscribed to, Group publishes samples of one group of actors in
+ * turn, and Direct sends requests to single actors and measures the round trip of their replies. Churn is the
+ * number of actors per second that cancel and renew their subscriptions during a run.
+ */
+UCLASS()
+class SGMESSAGINGDEMO_API USGTestSoakCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USGTestSoakCommandlet();
+
+public:
+	//~ UCommandlet interface
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Structure for the results of a run. */
+	struct FRunResult
+	{
+		/** Holds the number of endpoint actors. */
+		int32 NumEndpoints = 0;
+
+		/** Holds the number of producer threads. */
+		int32 NumThreads = 0;
+
+		/** Holds the time it took to spawn the actors, in milliseconds. */
+		double SpawnTime = 0.0;
+
+		/** Holds the time it took the router to take the subscriptions of the actors, in milliseconds. */
+		double SubscribeTime = 0.0;
+
+		/** Holds the time it took to destroy the actors and collect them, in milliseconds. */
+		double DespawnTime = 0.0;
+
+		/** Holds the number of messages sent by the producers. */
+		int64 NumSent = 0;
+
+		/** Holds the number of deliveries. */
+		int64 NumDelivered = 0;
+
+		/** Holds the number of deliveries per second. */
+		double Throughput = 0.0;
+
+		/** Holds the delivery latency percentiles, in milliseconds. */
+		double P50 = 0.0;
+		double P99 = 0.0;
+		double Max = 0.0;
+	};
+
+private:
+	/** Creates the headless game world, which starts playing right away. */
+	UWorld* CreateSoakWorld() const;
+
+	/** Destroys the game world. */
+	void DestroySoakWorld(UWorld* World) const;
+
+	/** Spawns the given number of actors and assigns them to groups round robin. */
+	void SpawnActors(UWorld* World, int32 NumEndpoints);
+
+	/** Destroys all actors and collects them. */
+	void DespawnActors();
+
+	/** Waits until the router of the bus took the subscriptions of all actors. */
+	bool WaitForSubscriptions(const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& Bus) const;
+
+	/** Runs the traffic pattern with the given number of producer threads. */
+	void Run(UWorld* World, const TSharedRef<ISGMessageBus, ESPMode::ThreadSafe>& Bus, int32 NumThreads,
+	         FRunResult& Result);
+
+	/** Logs the report and writes it to the CSV file. */
+	void Report(const TArray<FRunResult>& Results) const;
+
+private:
+	/** Holds the endpoint counts to soak. */
+	TArray<int32> EndpointCounts;
+
+	/** Holds the producer thread counts to soak. */
+	TArray<int32> ThreadCounts;
+
+	/** Holds the traffic pattern. */
+	FString Pattern;
+
+	/** Holds the number of groups of the Group pattern. */
+	int32 NumGroups;
+
+	/** Holds the duration of every run, in seconds. */
+	double Seconds;
+
+	/** Holds the number of actors per second that renew their subscriptions. */
+	double Churn;
+
+	/** Holds the number of outstanding deliveries at which producers back off. */
+	int64 MaxInFlight;
+
+	/** Holds the name of the CSV report file. */
+	FString ReportFilename;
+
+	/** Holds the spawned actors. */
+	UPROPERTY()
+	TArray<ASGTestSoakActor*> Actors;
+
+	/** Holds the statistics of the current run. */
+	FSGTestSoakStats Stats;
+};